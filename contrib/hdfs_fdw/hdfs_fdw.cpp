@@ -74,7 +74,8 @@ static const HdfsValidOption ValidDFSOptionArray[] = {{OPTION_NAME_LOCATION, T_F
 
 /* Array of options that are valid for server type. */
 static const HdfsValidOption ValidServerTypeOptionArray[] = {
-    {OBS_SERVER, T_SERVER_TYPE_OPTION}, {HDFS_SERVER, T_SERVER_TYPE_OPTION}, {DUMMY_SERVER, T_SERVER_TYPE_OPTION}};
+    {OBS_SERVER, T_SERVER_TYPE_OPTION}, {HDFS_SERVER, T_SERVER_TYPE_OPTION}, {DUMMY_SERVER, T_SERVER_TYPE_OPTION},
+    {LOCAL_SERVER, T_SERVER_TYPE_OPTION}};
 
 #define HDFS_FORMAT_ORC "orc"
 #define HDFS_FORMAT_TEXT "text"
@@ -204,7 +205,7 @@ Datum hdfs_fdw_handler(PG_FUNCTION_ARGS)
 /**
  * @Description:
  * @in ServerOptionList: Find the server type from ServerOptionList, and then check the validity of
- * the server type. Currently, the "OBS" and the "HDFS" server type are supported for DFS server.
+ * the server type. Currently, the "OBS", "HDFS" and "local" server type are supported for DFS server.
  * @in ServerOptionList: The server option list given by user.
  * @return Return T_OBS_SERVER if the server type is "OBS", otherwise return T_HDFS_SERVER.
  */
@@ -229,6 +230,9 @@ ServerTypeOption foundAndGetServerType(List* ServerOptionList)
             } else if (0 == pg_strcasecmp(typeValue, DUMMY_SERVER)) {
                 serverType = T_DUMMY_SERVER;
                 break;
+            } else if (0 == pg_strcasecmp(typeValue, LOCAL_SERVER)) {
+                serverType = T_LOCAL_SERVER;
+                break;
             } else {
                 ereport(ERROR,
                     (errcode(ERRCODE_FDW_INVALID_OPTION_NAME),
@@ -350,6 +354,17 @@ void serverOptionValidator(List* ServerOptionList)
             checkOptionNameValidity(ServerOptionList, DUMMY_SERVER_OPTION);
             break;
         }
+        case T_LOCAL_SERVER: {
+            /* The foreign tables of the server can read any file the database server can. */
+            if (!superuser()) {
+                ereport(ERROR,
+                    (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                        errmodule(MOD_HDFS),
+                        errmsg("must be system admin to create a local server.")));
+            }
+            checkOptionNameValidity(ServerOptionList, LOCAL_SERVER_OPTION);
+            break;
+        }
         default: {
             /*
              * Do not occur here.
@@ -548,6 +563,9 @@ void foreignTableOptionValidator(List* tabelOptionList, uint32 whichOption)
     /* option bit for option name validity */
     uint32 name_validity_option = whichOption;
 
+    /* the hdfs and local foreign tables name their files by absolute paths */
+    bool isLocalPath = (whichOption == HDFS_FOREIGN_TABLE_OPTION || whichOption == LOCAL_FOREIGN_TABLE_OPTION);
+
 #ifndef ENABLE_MULTIPLE_NODES
     if (whichOption == HDFS_FOREIGN_TABLE_OPTION) {
         ereport(ERROR,
@@ -595,7 +613,7 @@ void foreignTableOptionValidator(List* tabelOptionList, uint32 whichOption)
             CheckFoldernameOrFilenamesOrCfgPtah(defGetString(optionDef), OPTION_NAME_FILENAMES);
         } else if (0 == pg_strcasecmp(optionName, OPTION_NAME_FOLDERNAME)) {
             foldernameFound = true;
-            if (whichOption == HDFS_FOREIGN_TABLE_OPTION) {
+            if (isLocalPath) {
                 CheckFoldernameOrFilenamesOrCfgPtah(defGetString(optionDef), OPTION_NAME_FOLDERNAME);
             } else {
                 checkObsPath(defGetString(optionDef), OPTION_NAME_FOLDERNAME, ",");
@@ -620,7 +638,7 @@ void foreignTableOptionValidator(List* tabelOptionList, uint32 whichOption)
         CheckTextCsvOptions(&textOptionsFoundDetail, checkEncodingLevel, formatType);
     }
 
-    if (whichOption == HDFS_FOREIGN_TABLE_OPTION) {
+    if (isLocalPath) {
         if ((filenameFound && foldernameFound) || (!filenameFound && !foldernameFound)) {
             ereport(ERROR,
                 (errcode(ERRCODE_FDW_DYNAMIC_PARAMETER_VALUE_NEEDED),
@@ -681,6 +699,8 @@ Datum hdfs_fdw_validator(PG_FUNCTION_ARGS)
             foreignTableOptionValidator(checkedList, HDFS_FOREIGN_TABLE_OPTION);
         } else if (0 == pg_strcasecmp(typeValue, OBS)) {
             foreignTableOptionValidator(checkedList, OBS_FOREIGN_TABLE_OPTION);
+        } else if (0 == pg_strcasecmp(typeValue, LOCAL_SERVER)) {
+            foreignTableOptionValidator(checkedList, LOCAL_FOREIGN_TABLE_OPTION);
         }
         list_free(checkedList);
         checkedList = NIL;
@@ -1010,12 +1030,9 @@ static void HdfsExplainForeignScan(ForeignScanState* scanState, ExplainState* ex
     List* prunningResult = ((ForeignScan*)scanState->ss.ps.plan)->prunningResult;
 
     ServerTypeOption srvType = getServerType(foreignTableId);
+    const char* srvTypeName = (T_OBS_SERVER == srvType) ? OBS : ((T_LOCAL_SERVER == srvType) ? LOCAL_SERVER : HDFS);
     if (t_thrd.explain_cxt.explain_perf_mode == EXPLAIN_NORMAL) {
-        if (T_OBS_SERVER == srvType) {
-            ExplainPropertyText("Server Type", OBS, explainState);
-        } else {
-            ExplainPropertyText("Server Type", HDFS, explainState);
-        }
+        ExplainPropertyText("Server Type", srvTypeName, explainState);
     }
 
     const char* fileFormant = "File";
@@ -1041,13 +1058,8 @@ static void HdfsExplainForeignScan(ForeignScanState* scanState, ExplainState* ex
         ExplainPropertyText(fileFormant, hdfsFdwOptions->location, explainState);
 
     if (t_thrd.explain_cxt.explain_perf_mode != EXPLAIN_NORMAL && explainState->planinfo->m_detailInfo) {
-        if (T_OBS_SERVER == srvType) {
-            explainState->planinfo->m_detailInfo->set_plan_name<true, true>();
-            appendStringInfo(explainState->planinfo->m_detailInfo->info_str, "%s: %s\n", "Server Type", OBS);
-        } else {
-            explainState->planinfo->m_detailInfo->set_plan_name<true, true>();
-            appendStringInfo(explainState->planinfo->m_detailInfo->info_str, "%s: %s\n", "Server Type", HDFS);
-        }
+        explainState->planinfo->m_detailInfo->set_plan_name<true, true>();
+        appendStringInfo(explainState->planinfo->m_detailInfo->info_str, "%s: %s\n", "Server Type", srvTypeName);
     }
 
     /* Explain verbose the info of partition prunning result. */
@@ -20,7 +20,8 @@ typedef enum OptionType {
     T_FOREIGN_TABLE_TEXT_OPTION = 0x0001 << 9,
     T_FOREIGN_TABLE_CSV_OPTION = 0x0001 << 10,
     T_FOREIGN_TABLE_HDFS_ORC_OPTION = 0x0001 << 11,
-    T_FOREIGN_TABLE_HDFS_PARQUET_OPTION = 0x0001 << 12
+    T_FOREIGN_TABLE_HDFS_PARQUET_OPTION = 0x0001 << 12,
+    T_FOREIGN_TABLE_LOCAL_OPTION = 0x0001 << 13
 } OptionType;
 
 #define OBS_SERVER_OPTION (T_SERVER_COMMON_OPTION | T_OBS_SERVER_OPTION)
@@ -34,6 +35,10 @@ typedef enum OptionType {
     (T_FOREIGN_TABLE_COMMON_OPTION | T_FOREIGN_TABLE_HDFS_OPTION | T_FOREIGN_TABLE_CSV_OPTION | \
         T_FOREIGN_TABLE_TEXT_OPTION | T_FOREIGN_TABLE_HDFS_ORC_OPTION | T_FOREIGN_TABLE_HDFS_PARQUET_OPTION)
 
+/* The local foreign tables take the same options as the hdfs ones. */
+#define LOCAL_SERVER_OPTION (T_SERVER_COMMON_OPTION)
+#define LOCAL_FOREIGN_TABLE_OPTION (HDFS_FOREIGN_TABLE_OPTION | T_FOREIGN_TABLE_LOCAL_OPTION)
+
 #define SERVER_TYPE_OPTION (T_SERVER_TYPE_OPTION)
 
 #define DFS_OPTION_ARRAY                                                                           \
@@ -152,7 +152,8 @@ List* CNScheduling(Oid foreignTableId, Index relId, List* columnList, List* scan
         *fileNum = list_length(FileList);
     }
     switch (srvType) {
-        case T_OBS_SERVER: {
+        case T_OBS_SERVER:
+        case T_LOCAL_SERVER: {
             /* Check if the file list is empty again after the partition prunning. */
             if (0 == list_length(FileList)) {
                 delete (conn);
@@ -218,8 +219,8 @@ List* CNScheduling(Oid foreignTableId, Index relId, List* columnList, List* scan
 
     Assert(allTask != NIL);
 
-    /* check the allTask, If the size of splits */
-    if ((!t_thrd.postgres_cxt.mark_explain_only && !isAnalyze) &&
+    /* check the allTask, If the size of splits. The local file system is read only, so never spill there. */
+    if ((!t_thrd.postgres_cxt.mark_explain_only && !isAnalyze) && T_LOCAL_SERVER != srvType &&
         list_length(FileList) >= u_sess->attr.attr_sql.schedule_splits_threshold) {
         SpillToDisk(relId, allTask, conn);
     }
@@ -1622,6 +1623,58 @@ static List* GetAllFiles(
             }
             break;
         }
+        case T_LOCAL_SERVER: {
+            HdfsFdwOptions* options = HdfsGetOptions(foreignTableId);
+            if (options->foldername) {
+                if (conn->isDfsFile(options->foldername)) {
+                    delete (conn);
+                    conn = NULL;
+                    ereport(ERROR,
+                        (errcode(ERRCODE_FDW_INVALID_OPTOIN_DATA),
+                            errmodule(MOD_DFS),
+                            errmsg("The foldername option cannot be a file path.")));
+                }
+
+                /* The partition directories are appended to the folder, so it must end with a slash. */
+                StringInfo folder = makeStringInfo();
+                appendStringInfoString(folder, options->foldername);
+                if (folder->data[folder->len - 1] != '/') {
+                    appendStringInfoChar(folder, '/');
+                }
+
+                List* fixedPathList = NIL;
+                if (u_sess->attr.attr_sql.enable_valuepartition_pruning) {
+                    fixedPathList = addPartitionPath(foreignTableId, scanClauseList, folder->data);
+                }
+
+                if (0 == list_length(fixedPathList)) {
+                    fileList = conn->listObjectsStat(folder->data, folder->data);
+                } else {
+                    ListCell* cell = NULL;
+                    foreach (cell, fixedPathList) {
+                        StringInfo fixedPath = (StringInfo)lfirst(cell);
+                        fileList = list_concat(fileList, conn->listObjectsStat(fixedPath->data, folder->data));
+                    }
+                }
+            } else {
+                while (NULL != options->filename) {
+                    currentFile = parseMultiFileNames(&options->filename, true, ',');
+
+                    /* If the option use filenames, then all the entries defined must be file. */
+                    if (!conn->isDfsFile(currentFile)) {
+                        delete (conn);
+                        conn = NULL;
+                        ereport(ERROR,
+                            (errcode(ERRCODE_FDW_INVALID_OPTOIN_DATA),
+                                errmodule(MOD_DFS),
+                                errmsg("The entries in the options fileNames must be file!")));
+                    }
+
+                    fileList = list_concat(fileList, conn->listObjectsStat(currentFile));
+                }
+            }
+            break;
+        }
         default: {
             Assert(0);
             break;
@@ -1863,7 +1916,7 @@ static List* PartitionPruneProcess(dfs::DFSConnector* conn, List* partitionRelat
                 /* next cell */
                 next = lnext(fileCell);
 
-                if (T_OBS_SERVER == srvType) {
+                if (T_HDFS_SERVER != srvType) {
                     fillPartitionValueInSplitInfo(conn, split, i + split->prefixSlashNum);
                 }
 
@@ -1887,7 +1940,7 @@ static List* PartitionPruneProcess(dfs::DFSConnector* conn, List* partitionRelat
                     /* prev cell */
                     prev = fileCell;
                 } else {
-                    if (T_OBS_SERVER == srvType) {
+                    if (T_HDFS_SERVER != srvType) {
                         pfree_ext(split->fileName);
                         pfree_ext(split->filePath);
                         pfree_ext(split);
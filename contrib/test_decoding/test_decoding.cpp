@@ -56,6 +56,12 @@ static void pg_decode_commit_txn(LogicalDecodingContext* ctx, ReorderBufferTXN*
 static void pg_decode_change(
     LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation rel, ReorderBufferChange* change);
 static bool pg_decode_filter(LogicalDecodingContext* ctx, RepOriginId origin_id);
+static void pg_decode_stream_start(LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+static void pg_decode_stream_stop(LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+static void pg_decode_stream_change(
+    LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation rel, ReorderBufferChange* change);
+static void pg_decode_stream_abort(LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr abort_lsn);
+static void pg_decode_stream_commit(LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr commit_lsn);
 
 void _PG_init(void)
 {
@@ -73,6 +79,11 @@ void _PG_output_plugin_init(OutputPluginCallbacks* cb)
     cb->commit_cb = pg_decode_commit_txn;
     cb->filter_by_origin_cb = pg_decode_filter;
     cb->shutdown_cb = pg_decode_shutdown;
+    cb->stream_start_cb = pg_decode_stream_start;
+    cb->stream_stop_cb = pg_decode_stream_stop;
+    cb->stream_change_cb = pg_decode_stream_change;
+    cb->stream_abort_cb = pg_decode_stream_abort;
+    cb->stream_commit_cb = pg_decode_stream_commit;
 }
 
 /* initialize this plugin */
@@ -80,6 +91,7 @@ static void pg_decode_startup(LogicalDecodingContext* ctx, OutputPluginOptions*
 {
     ListCell* option = NULL;
     TestDecodingData* data = NULL;
+    bool stream_changes = false; /* large transactions are streamed on request only */
 
     data = (TestDecodingData*)palloc0(sizeof(TestDecodingData));
     data->context = AllocSetContextCreate(ctx->context,
@@ -144,6 +156,13 @@ static void pg_decode_startup(LogicalDecodingContext* ctx, OutputPluginOptions*
                 ereport(ERROR,
                     (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                         errmsg("could not parse value \"%s\" for parameter \"%s\"", strVal(elem->arg), elem->defname)));
+        } else if (strcmp(elem->defname, "stream-changes") == 0) {
+            if (elem->arg == NULL)
+                stream_changes = true;
+            else if (!parse_bool(strVal(elem->arg), &stream_changes))
+                ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("could not parse value \"%s\" for parameter \"%s\"", strVal(elem->arg), elem->defname)));
         } else {
             ereport(ERROR,
                 (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -151,6 +170,8 @@ static void pg_decode_startup(LogicalDecodingContext* ctx, OutputPluginOptions*
                         "option \"%s\" = \"%s\" is unknown", elem->defname, elem->arg ? strVal(elem->arg) : "(null)")));
         }
     }
+
+    ctx->streaming = ctx->streaming && stream_changes;
 }
 
 /* cleanup this plugin's resources */
@@ -342,24 +363,15 @@ static void tuple_to_stringinfo(StringInfo s, TupleDesc tupdesc, HeapTuple tuple
     }
 }
 /*
- * callback for individual changed tuples
+ * print a changed tuple into ctx->out and write it
  */
-static void pg_decode_change(
-    LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation relation, ReorderBufferChange* change)
+static void pg_output_change(LogicalDecodingContext* ctx, Relation relation, ReorderBufferChange* change)
 {
-    TestDecodingData* data = NULL;
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
     Form_pg_class class_form;
     TupleDesc tupdesc;
     MemoryContext old;
 
-    data = (TestDecodingData*)ctx->output_plugin_private;
-
-    /* output BEGIN if we haven't yet */
-    if (data->skip_empty_xacts && !data->xact_wrote_changes) {
-        pg_output_begin(ctx, data, txn, false);
-    }
-    data->xact_wrote_changes = true;
-
     class_form = RelationGetForm(relation);
     tupdesc = RelationGetDescr(relation);
 
@@ -414,3 +426,84 @@ static void pg_decode_change(
 
     OutputPluginWrite(ctx, true);
 }
+
+/*
+ * callback for individual changed tuples
+ */
+static void pg_decode_change(
+    LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation relation, ReorderBufferChange* change)
+{
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
+
+    /* output BEGIN if we haven't yet */
+    if (data->skip_empty_xacts && !data->xact_wrote_changes) {
+        pg_output_begin(ctx, data, txn, false);
+    }
+    data->xact_wrote_changes = true;
+
+    pg_output_change(ctx, relation, change);
+}
+
+/* STREAM START callback, a block of an in-progress transaction follows */
+static void pg_decode_stream_start(LogicalDecodingContext* ctx, ReorderBufferTXN* txn)
+{
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
+
+    OutputPluginPrepareWrite(ctx, true);
+    if (data->include_xids)
+        appendStringInfo(ctx->out, "opening a streamed block for transaction TXN %lu", txn->xid);
+    else
+        appendStringInfoString(ctx->out, "opening a streamed block for transaction");
+    OutputPluginWrite(ctx, true);
+}
+
+/* STREAM STOP callback */
+static void pg_decode_stream_stop(LogicalDecodingContext* ctx, ReorderBufferTXN* txn)
+{
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
+
+    OutputPluginPrepareWrite(ctx, true);
+    if (data->include_xids)
+        appendStringInfo(ctx->out, "closing a streamed block for transaction TXN %lu", txn->xid);
+    else
+        appendStringInfoString(ctx->out, "closing a streamed block for transaction");
+    OutputPluginWrite(ctx, true);
+}
+
+/* STREAM CHANGE callback, txn is the subtransaction the change belongs to */
+static void pg_decode_stream_change(
+    LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation relation, ReorderBufferChange* change)
+{
+    pg_output_change(ctx, relation, change);
+}
+
+/* STREAM ABORT callback */
+static void pg_decode_stream_abort(LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr abort_lsn)
+{
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
+
+    OutputPluginPrepareWrite(ctx, true);
+    if (data->include_xids)
+        appendStringInfo(ctx->out, "aborting streamed (sub)transaction TXN %lu", txn->xid);
+    else
+        appendStringInfoString(ctx->out, "aborting streamed (sub)transaction");
+    OutputPluginWrite(ctx, true);
+}
+
+/* STREAM COMMIT callback */
+static void pg_decode_stream_commit(LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr commit_lsn)
+{
+    TestDecodingData* data = (TestDecodingData*)ctx->output_plugin_private;
+
+    OutputPluginPrepareWrite(ctx, true);
+    if (data->include_xids)
+        appendStringInfo(ctx->out, "committing streamed transaction TXN %lu", txn->xid);
+    else
+        appendStringInfoString(ctx->out, "committing streamed transaction");
+
+    if (data->include_timestamp)
+        appendStringInfo(ctx->out, " (at %s)", timestamptz_to_str(txn->commit_time));
+    appendStringInfo(ctx->out, " CSN %lu", txn->csn);
+
+    OutputPluginWrite(ctx, true);
+}
@@ -30,6 +30,8 @@
 #endif
 
 #include <locale.h>
+#include <float.h>
+#include <arpa/inet.h>
 
 #include "catalog/pg_type.h"
 #include "pqsignal.h"
@@ -234,6 +236,110 @@ static char* format_numeric_locale(const char* my_str)
     return new_str;
 }
 
+/* read a network-order integer of a binary-format value */
+static uint32 binary_uint32(const char* value)
+{
+    uint32 n32;
+
+    check_memcpy_s(memcpy_s(&n32, sizeof(n32), value, sizeof(n32)));
+    return ntohl(n32);
+}
+
+static uint64 binary_uint64(const char* value)
+{
+    return ((uint64)binary_uint32(value) << 32) | binary_uint32(value + 4);
+}
+
+/* the extra_float_digits of the session, which the server reports */
+static int binary_extra_float_digits(void)
+{
+    const char* value = (pset.db != NULL) ? PQparameterStatus(pset.db, "extra_float_digits") : NULL;
+
+    return (value != NULL) ? atoi(value) : 0;
+}
+
+/*
+ * format_binary_value: render a binary-format value as its text output.
+ *
+ * Results of vectorized plans may arrive as ColumnBatch messages, which
+ * libpq stores in binary format; the server only sends them for the types
+ * handled here.  Returns NULL if the value is to be shown as is.
+ */
+static char* format_binary_value(const char* value, int len, Oid ftype)
+{
+    char buf[64];
+    uint16 n16;
+    union {
+        uint32 i;
+        float4 f;
+    } f4;
+    union {
+        uint64 i;
+        float8 f;
+    } f8;
+    double dval = 0;
+    int digits = 0;
+
+    switch (ftype) {
+        case BOOLOID:
+            if (len != 1)
+                return NULL;
+            check_sprintf_s(sprintf_s(buf, sizeof(buf), "%s", value[0] ? "t" : "f"));
+            break;
+        case INT2OID:
+            if (len != 2)
+                return NULL;
+            check_memcpy_s(memcpy_s(&n16, sizeof(n16), value, sizeof(n16)));
+            check_sprintf_s(sprintf_s(buf, sizeof(buf), "%d", (int)(int16)ntohs(n16)));
+            break;
+        case INT4OID:
+            if (len != 4)
+                return NULL;
+            check_sprintf_s(sprintf_s(buf, sizeof(buf), "%d", (int32)binary_uint32(value)));
+            break;
+        case OIDOID:
+            if (len != 4)
+                return NULL;
+            check_sprintf_s(sprintf_s(buf, sizeof(buf), "%u", binary_uint32(value)));
+            break;
+        case INT8OID:
+            if (len != 8)
+                return NULL;
+            check_sprintf_s(sprintf_s(buf, sizeof(buf), INT64_FORMAT, (int64)binary_uint64(value)));
+            break;
+        case FLOAT4OID:
+        case FLOAT8OID:
+            if (ftype == FLOAT4OID) {
+                if (len != 4)
+                    return NULL;
+                f4.i = binary_uint32(value);
+                dval = f4.f;
+                digits = FLT_DIG + binary_extra_float_digits();
+            } else {
+                if (len != 8)
+                    return NULL;
+                f8.i = binary_uint64(value);
+                dval = f8.f;
+                digits = DBL_DIG + binary_extra_float_digits();
+            }
+            if (digits < 1)
+                digits = 1;
+            /* same spelling as float4out and float8out */
+            if (isnan(dval))
+                check_sprintf_s(sprintf_s(buf, sizeof(buf), "NaN"));
+            else if (isinf(dval))
+                check_sprintf_s(sprintf_s(buf, sizeof(buf), "%s", dval > 0 ? "Infinity" : "-Infinity"));
+            else
+                check_sprintf_s(sprintf_s(buf, sizeof(buf), "%.*g", digits, dval));
+            break;
+        default:
+            /* text types are sent as they are */
+            return NULL;
+    }
+
+    return pg_strdup(buf);
+}
+
 /*
  * fputnbytes: print exactly N bytes to a file
  *
@@ -2290,8 +2396,20 @@ void printQuery(const PGresult* result, const printQueryOpt* opt, FILE* fout, FI
                 cell = (char*)(opt->nullPrint != NULL ? opt->nullPrint : "");
             else {
                 cell = PQgetvalue(result, r, c);
+                if (PQfformat(result, c) == 1) {
+                    char* text = format_binary_value(cell, PQgetlength(result, r, c), PQftype(result, c));
+
+                    if (text != NULL) {
+                        cell = text;
+                        mustfree = true;
+                    }
+                }
                 if (cont.aligns[c] == 'r' && opt->topt.numericLocale) {
-                    cell = format_numeric_locale(cell);
+                    char* localized = format_numeric_locale(cell);
+
+                    if (mustfree)
+                        free(cell);
+                    cell = localized;
                     mustfree = true;
                 }
             }
@@ -31,6 +31,7 @@
 #include "postgres.h"
 #include "knl/knl_variable.h"
 
+#include "access/reloptions.h"
 #include "access/sysattr.h"
 #include "access/transam.h"
 #include "access/xact.h"
@@ -78,6 +79,7 @@
 #include "storage/predicate.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
+#include "storage/page_compression.h"
 #include "storage/smgr.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -405,7 +407,8 @@ Form_pg_attribute SystemAttributeByName(const char* attname, bool relhasoids)
  */
 Relation heap_create(const char* relname, Oid relnamespace, Oid reltablespace, Oid relid, Oid relfilenode,
     Oid bucketOid, TupleDesc tupDesc, char relkind, char relpersistence, bool partitioned_relation, bool rowMovement,
-    bool shared_relation, bool mapped_relation, bool allow_system_table_mods, int8 row_compress, Oid ownerid)
+    bool shared_relation, bool mapped_relation, bool allow_system_table_mods, int8 row_compress, Oid ownerid,
+    uint32 compressOpt)
 {
     bool create_storage = false;
     Relation rel;
@@ -519,7 +522,7 @@ Relation heap_create(const char* relname, Oid relnamespace, Oid reltablespace, O
      */
     if (create_storage) {
         RelationOpenSmgr(rel);
-        RelationCreateStorage(rel->rd_node, relpersistence, ownerid, bucketOid);
+        RelationCreateStorage(rel->rd_node, relpersistence, ownerid, bucketOid, compressOpt);
     }
 
     if (RelationUsesSpaceType(rel->rd_rel->relpersistence) == SP_TEMP) {
@@ -1757,6 +1760,7 @@ Oid heap_create_with_catalog(const char* relname, Oid relnamespace, Oid reltable
     Oid relbucketOid = InvalidOid;
     int2vector* bucketcol = NULL;
     bool relhasbucket = false;
+    uint32 compressOpt = 0;
 
     pg_class_desc = heap_open(RelationRelationId, RowExclusiveLock);
 
@@ -1906,6 +1910,13 @@ Oid heap_create_with_catalog(const char* relname, Oid relnamespace, Oid reltable
 	relhasbucket = true;
     }
 
+    /* Page compression of the main fork comes from the reloptions */
+    if (relkind == RELKIND_RELATION && reloptions != (Datum)0) {
+        bytea* options = heap_reloptions(relkind, reloptions, false);
+        compressOpt = PageCompressOptFromReloptions(options);
+        pfree_ext(options);
+    }
+
     /*
      * Create the relcache entry (mostly dummy at this point) and the physical
      * disk file.  (If we fail further down, it's the smgr's responsibility to
@@ -1927,7 +1938,8 @@ Oid heap_create_with_catalog(const char* relname, Oid relnamespace, Oid reltable
         mapped_relation,
         allow_system_table_mods,
         row_compress,
-        ownerid);
+        ownerid,
+        compressOpt);
 
     /* Recode the table or other object in pg_class create time. */
     PgObjectType objectType = GetPgObjectTypePgClass(relkind);
@@ -4323,7 +4335,7 @@ void dropDeltaTableOnPartition(Oid partId)
  *
  */
 Partition heapCreatePartition(const char* part_name, bool for_partitioned_table, Oid part_tablespace, Oid part_id,
-    Oid partFileNode, Oid bucketOid, Oid ownerid)
+    Oid partFileNode, Oid bucketOid, Oid ownerid, uint32 compressOpt)
 {
     Partition new_part_desc = NULL;
     bool createStorage = false;
@@ -4366,7 +4378,8 @@ Partition heapCreatePartition(const char* part_name, bool for_partitioned_table,
         RelationCreateStorage(new_part_desc->pd_node,
             RELPERSISTENCE_PERMANENT, /* partition table's persitence MUST be 'p'(permanent table)*/
             ownerid,
-            bucketOid);
+            bucketOid,
+            compressOpt);
     }
 
     return new_part_desc;
@@ -4725,7 +4738,8 @@ Oid heapAddRangePartition(Relation pgPartRel, Oid partTableOid, Oid partrelfileO
         newPartitionOid,                                          /* partition's oid*/
         partrelfileOid,
         bucketOid,
-        ownerid);
+        ownerid,
+        PageCompressOptFromReloptions(heap_reloptions(RELKIND_RELATION, reloptions, false)));
 
     Assert(newPartitionOid == PartitionGetPartid(newPartition));
     newPartition->pd_part->parttype = PART_OBJ_TYPE_TABLE_PARTITION;
@@ -56,6 +56,7 @@
 #include "parser/parser.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
+#include "storage/page_compression.h"
 #include "storage/predicate.h"
 #include "storage/procarray.h"
 #include "storage/smgr.h"
@@ -828,7 +829,10 @@ Oid index_create(Relation heapRelation, const char* indexRelationName, Oid index
         mapped_relation,
         allow_system_table_mods,
         REL_CMPRS_NOT_SUPPORT,
-        heapRelation->rd_rel->relowner);
+        heapRelation->rd_rel->relowner,
+        (accessMethodObjectId == BTREE_AM_OID && reloptions != (Datum)0)
+            ? PageCompressOptFromReloptions(default_reloptions(reloptions, false, RELOPT_KIND_BTREE))
+            : 0);
 
     Assert(indexRelationId == RelationGetRelid(indexRelation));
 
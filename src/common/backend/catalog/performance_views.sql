@@ -4159,7 +4159,7 @@ CREATE VIEW DBE_PERF.global_ckpt_status AS
 CREATE OR REPLACE VIEW DBE_PERF.global_double_write_status AS
     SELECT node_name, curr_dwn, curr_start_page, file_trunc_num, file_reset_num,
            total_writes, low_threshold_writes, high_threshold_writes,
-           total_pages, low_threshold_pages, high_threshold_pages
+           total_pages, low_threshold_pages, high_threshold_pages, skipped_pages
     FROM pg_catalog.local_double_write_stat();
 
 CREATE VIEW DBE_PERF.global_pagewriter_status AS
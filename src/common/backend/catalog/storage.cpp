@@ -175,7 +175,7 @@ static void InsertStorageIntoPendingList(_in_ RelFileNode* rnode, _in_ AttrNumbe
     LockRelFileNode(*rnode, AccessExclusiveLock);
 }
 
-void RelationCreateStorageInternal(RelFileNode rnode, char relpersistence, Oid ownerid)
+void RelationCreateStorageInternal(RelFileNode rnode, char relpersistence, Oid ownerid, uint32 compressOpt)
 {
     SMgrRelation srel;
     BackendId backend;
@@ -184,10 +184,12 @@ void RelationCreateStorageInternal(RelFileNode rnode, char relpersistence, Oid o
     StorageSetBackendAndLogged(relpersistence, &backend, &needs_wal);
 
     srel = smgropen(rnode, backend);
+    srel->smgr_compress = compressOpt;
     smgrcreate(srel, MAIN_FORKNUM, false);
+    srel->smgr_compress = 0;
 
     if (needs_wal)
-        log_smgrcreate(&srel->smgr_rnode.node, MAIN_FORKNUM);
+        log_smgrcreate(&srel->smgr_rnode.node, MAIN_FORKNUM, compressOpt);
 
     /* Add the relation to the list of stuff to delete at abort */
     InsertStorageIntoPendingList(&rnode, InvalidAttrNumber, backend, ownerid, false);
@@ -203,13 +205,16 @@ void RelationCreateStorageInternal(RelFileNode rnode, char relpersistence, Oid o
  *
  * This function is transactional. The creation is WAL-logged, and if the
  * transaction aborts later on, the storage will be destroyed.
+ *
+ * compressOpt asks for page compression of the main fork, see
+ * storage/page_compression.h.  Hash bucket relations are never compressed.
  */
-void RelationCreateStorage(RelFileNode rnode, char relpersistence, Oid ownerid, Oid bucketOid)
+void RelationCreateStorage(RelFileNode rnode, char relpersistence, Oid ownerid, Oid bucketOid, uint32 compressOpt)
 {
     if (OidIsValid(bucketOid) && (bucketOid != VirtualBktOid)) {
         BucketCreateStorage(rnode, bucketOid, ownerid);
     } else {
-        RelationCreateStorageInternal(rnode, relpersistence, ownerid);
+        RelationCreateStorageInternal(rnode, relpersistence, ownerid, compressOpt);
     }
 }
 
@@ -240,21 +245,24 @@ void BucketCreateStorage(RelFileNode rnode, Oid bucketOid, Oid ownerid)
     /* create dummy file for parent relation */
     newrnode.node = rnode;
     newrnode.backend = InvalidBackendId;
-    RelationCreateStorageInternal(newrnode.node, RELPERSISTENCE_PERMANENT, ownerid);
+    RelationCreateStorageInternal(newrnode.node, RELPERSISTENCE_PERMANENT, ownerid, 0);
     smgrclosenode(newrnode);
 
     /* create file storage for each bucket relation */
     for (int i = 0; i < bucketlist->dim1; i++) {
         newrnode.node.bucketNode = bucketlist->values[i];
-        RelationCreateStorageInternal(newrnode.node, RELPERSISTENCE_PERMANENT, ownerid);
+        RelationCreateStorageInternal(newrnode.node, RELPERSISTENCE_PERMANENT, ownerid, 0);
         smgrclosenode(newrnode);
     }
 }
 
 /*
  * Perform XLogInsert of a XLOG_SMGR_CREATE record to WAL.
+ *
+ * Page compression settings are appended only when set, so records of
+ * uncompressed relations keep their old layout.
  */
-void log_smgrcreate(RelFileNode* rnode, ForkNumber forkNum)
+void log_smgrcreate(RelFileNode* rnode, ForkNumber forkNum, uint32 compressOpt)
 {
     xl_smgr_create xlrec;
 
@@ -266,6 +274,9 @@ void log_smgrcreate(RelFileNode* rnode, ForkNumber forkNum)
 
     XLogBeginInsert();
     XLogRegisterData((char*)&xlrec, sizeof(xlrec));
+    if (compressOpt != 0) {
+        XLogRegisterData((char*)&compressOpt, sizeof(compressOpt));
+    }
     XLogInsert(RM_SMGR_ID, XLOG_SMGR_CREATE | XLR_SPECIAL_REL_UPDATE, false, rnode->bucketNode);
 }
 
@@ -831,11 +842,13 @@ void AtSubAbort_smgr(void)
 }
 
 
-void smgr_redo_create(RelFileNode rnode, ForkNumber forkNum)
+void smgr_redo_create(RelFileNode rnode, ForkNumber forkNum, uint32 compressOpt)
 {
     if (!IsValidColForkNum(forkNum)) {   
         SMgrRelation reln = smgropen(rnode, InvalidBackendId);
+        reln->smgr_compress = compressOpt;
         smgrcreate(reln, forkNum, true);
+        reln->smgr_compress = 0;
     } else {
         CFileNode cFileNode(rnode, ColForkNum2ColumnId(forkNum), MAIN_FORKNUM);
         CUStorage* cuStorage = New(CurrentMemoryContext) CUStorage(cFileNode);
@@ -905,8 +918,14 @@ void smgr_redo(XLogReaderState* record)
     if (info == XLOG_SMGR_CREATE) {
         xl_smgr_create* xlrec = (xl_smgr_create*)XLogRecGetData(record);
         RelFileNode rnode;
+        uint32 compressOpt = 0;
         RelFileNodeCopy(rnode, xlrec->rnode, XLogRecGetBucketId(record));
-        smgr_redo_create(rnode, xlrec->forkNum);
+        if (XLogRecGetDataLen(record) >= sizeof(xl_smgr_create) + sizeof(uint32)) {
+            errno_t rc = memcpy_s(&compressOpt, sizeof(uint32), XLogRecGetData(record) + sizeof(xl_smgr_create),
+                sizeof(uint32));
+            securec_check(rc, "", "");
+        }
+        smgr_redo_create(rnode, xlrec->forkNum, compressOpt);
         
     } else if (info == XLOG_SMGR_TRUNCATE) {
         xl_smgr_truncate* xlrec = (xl_smgr_truncate*)XLogRecGetData(record);
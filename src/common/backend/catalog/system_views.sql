@@ -2949,6 +2949,28 @@ LANGUAGE 'plpgsql' NOT FENCED;
 CREATE VIEW pg_catalog.pg_stat_bad_block AS
 	SELECT DISTINCT * from pg_stat_bad_block();
 
+CREATE VIEW pg_catalog.pg_buffer_replacement_stats AS
+	SELECT * FROM pg_buffer_replacement_stats();
+
+CREATE VIEW pg_catalog.pg_cardinality_feedback AS
+	SELECT f.databaseid, f.relid, c.relname, f.signature, f.estimated_rows,
+		f.actual_rows, f.correction, f.samples, f.last_update
+	FROM pg_cardinality_feedback() f
+		LEFT JOIN pg_class c ON (c.oid = f.relid AND
+			f.databaseid = (SELECT oid FROM pg_database WHERE datname = current_database()));
+
+CREATE VIEW pg_catalog.pg_plpgsql_compiled_functions AS
+	SELECT * FROM pg_plpgsql_compiled_functions();
+
+CREATE VIEW pg_catalog.pg_lwlock_tranche_stats AS
+	SELECT * FROM pg_lwlock_tranche_stats();
+
+CREATE VIEW pg_catalog.gs_session_io_throttle AS
+	SELECT S.pid, S.sessionid, S.query_id, T.throttle_count, T.throttle_time,
+		T.last_throttle_count, T.last_throttle_time, S.query
+	FROM pg_stat_activity AS S, pg_stat_get_wlm_io_throttle_info() AS T
+	WHERE S.pid = T.pid AND S.sessionid = T.sessionid;
+
 CREATE OR REPLACE FUNCTION gs_get_stat_db_cu(OUT node_name1 text, OUT db_name text, OUT mem_hit bigint, OUT hdd_sync_read bigint, OUT hdd_asyn_read bigint)
 RETURNS setof record
 AS $$
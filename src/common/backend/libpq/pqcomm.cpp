@@ -85,6 +85,7 @@
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
+#include "access/xact.h"
 #include "pgxc/pgxc.h"
 #include "libpq/ip.h"
 #include "libpq/libpq.h"
@@ -1250,6 +1251,16 @@ static int pq_recvbuf(void)
         }
     }
 
+    /*
+     * ReadyForQuery leaves output unflushed while pipelined input is still
+     * buffered, or while a commit reply waits for its WAL flush; push it out
+     * now, before we may block waiting on the client.
+     */
+    if (pq_is_send_pending()) {
+        WaitDeferredCommitAck();
+        (void)pq_flush();
+    }
+
     /* Ensure that we're in blocking mode */
     pq_set_nonblocking(false);
 
@@ -1873,6 +1884,18 @@ bool pq_is_send_pending(void)
     return (t_thrd.libpq_cxt.PqSendStart < t_thrd.libpq_cxt.PqSendPointer);
 }
 
+/* --------------------------------
+ *		pq_is_recv_pending	- is there any unread data in the input buffer?
+ *
+ *		A client pipelining extended-protocol messages usually has the next
+ *		ones already buffered when we reach a Sync.
+ * --------------------------------
+ */
+bool pq_is_recv_pending(void)
+{
+    return (t_thrd.libpq_cxt.PqRecvPointer < t_thrd.libpq_cxt.PqRecvLength);
+}
+
 /* --------------------------------
  * Message-level I/O routines begin here.
  *
@@ -1911,6 +1934,29 @@ int pq_putmessage(char msgtype, const char* s, size_t len)
         return 0;
     }
     t_thrd.libpq_cxt.PqCommBusy = true;
+
+    /*
+     * Fast path: a 3.0 message that fits in the remaining send buffer is
+     * copied in one go, which is the common case for streams of DataRow.
+     */
+    if (msgtype && PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3 &&
+        (size_t)(t_thrd.libpq_cxt.PqSendBufferSize - t_thrd.libpq_cxt.PqSendPointer) >= len + 5) {
+        char* dest = t_thrd.libpq_cxt.PqSendBuffer + t_thrd.libpq_cxt.PqSendPointer;
+        uint32 n32 = htonl((uint32)(len + 4));
+        errno_t rc;
+
+        dest[0] = msgtype;
+        rc = memcpy_s(dest + 1, sizeof(n32), &n32, sizeof(n32));
+        securec_check(rc, "\0", "\0");
+        if (len > 0) {
+            rc = memcpy_s(dest + 5, len, s, len);
+            securec_check(rc, "\0", "\0");
+        }
+        t_thrd.libpq_cxt.PqSendPointer += (int)(len + 5);
+        t_thrd.libpq_cxt.PqCommBusy = false;
+        return 0;
+    }
+
     if (msgtype) {
         if (internal_putbytes(&msgtype, 1)) {
             goto fail;
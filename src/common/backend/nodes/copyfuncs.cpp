@@ -351,6 +351,7 @@ static PartIterator* _copyPartIterator(const PartIterator* from)
     COPY_SCALAR_FIELD(itrs);
     COPY_SCALAR_FIELD(direction);
     COPY_NODE_FIELD(param);
+    COPY_NODE_FIELD(pruningQuals);
 
     return newnode;
 }
@@ -512,6 +513,8 @@ static void CopyScanFields(const Scan* from, Scan* newnode)
     /* copy remainder of node.*/
     COPY_NODE_FIELD(tablesample);
     CopyMemInfoFields(&from->mem_info, &newnode->mem_info);
+    COPY_SCALAR_FIELD(feedbackSignature);
+    COPY_SCALAR_FIELD(feedbackRows);
 }
 
 /*
@@ -1681,6 +1684,7 @@ static VecPartIterator* _copyVecPartIterator(const VecPartIterator* from)
     COPY_SCALAR_FIELD(itrs);
     COPY_SCALAR_FIELD(direction);
     COPY_NODE_FIELD(param);
+    COPY_NODE_FIELD(pruningQuals);
 
     return newnode;
 }
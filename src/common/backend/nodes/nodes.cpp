@@ -265,6 +265,7 @@ static const TagStr g_tagStrArr[] = {{T_Invalid, "Invalid"},
     {T_SharedAllocSetContext, "SharedAllocSetContext"},
     {T_MemalignAllocSetContext, "MemalignAllocSetContext"},
     {T_MemalignSharedAllocSetContext, "MemalignSharedAllocSetContext"},
+    {T_SlabAllocSetContext, "SlabAllocSetContext"},
     {T_MemoryTracking, "MemoryTracking"},
     {T_Value, "Value"},
     {T_Integer, "Integer"},
@@ -675,6 +675,8 @@ static void _outScanInfo(StringInfo str, Scan* node)
     WRITE_NODE_FIELD(tablesample);
 
     out_mem_info(str, &node->mem_info);
+    WRITE_UINT_FIELD(feedbackSignature);
+    WRITE_FLOAT_FIELD(feedbackRows, "%.0f");
 }
 
 /*
@@ -1216,6 +1218,7 @@ static void _outPartIterator(StringInfo str, PartIterator* node)
     WRITE_INT_FIELD(itrs);
     WRITE_ENUM_FIELD(direction, ScanDirection);
     WRITE_NODE_FIELD(param);
+    WRITE_NODE_FIELD(pruningQuals);
 }
 
 static void _outSubqueryScan(StringInfo str, SubqueryScan* node)
@@ -4493,6 +4496,7 @@ static void _outVecPartIterator(StringInfo str, VecPartIterator* node)
     WRITE_INT_FIELD(itrs);
     WRITE_ENUM_FIELD(direction, ScanDirection);
     WRITE_NODE_FIELD(param);
+    WRITE_NODE_FIELD(pruningQuals);
 }
 
 static void _outVecLimit(StringInfo str, VecLimit* node)
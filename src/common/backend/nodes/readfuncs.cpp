@@ -2905,6 +2905,10 @@ static Scan* _readScan(Scan* local_node)
         READ_NODE_FIELD(tablesample);
     }
     read_mem_info(&local_node->mem_info);
+    IF_EXIST(feedbackSignature) {
+        READ_UINT_FIELD(feedbackSignature);
+        READ_FLOAT_FIELD(feedbackRows);
+    }
     READ_DONE();
 }
 
@@ -2919,6 +2923,9 @@ static PartIterator* _readPartIterator(PartIterator* local_node)
     READ_INT_FIELD(itrs);
     READ_ENUM_FIELD(direction, ScanDirection);
     READ_NODE_FIELD(param);
+    IF_EXIST(pruningQuals) {
+        READ_NODE_FIELD(pruningQuals);
+    }
 
     READ_DONE();
 }
@@ -4207,6 +4214,9 @@ static VecPartIterator* _readVecPartIterator(VecPartIterator* local_node)
     READ_INT_FIELD(itrs);
     READ_ENUM_FIELD(direction, ScanDirection);
     READ_NODE_FIELD(param);
+    IF_EXIST(pruningQuals) {
+        READ_NODE_FIELD(pruningQuals);
+    }
 
     READ_DONE();
 }
@@ -346,6 +346,10 @@ Datum date_sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = date_fastcmp;
+    ssup->comparator_threadsafe = true;
+    ssup->radix_width = sizeof(DateADT);
+    ssup->radix_mask = 0x80000000;
+    ssup->radix_exact = true;
     PG_RETURN_VOID();
 }
 
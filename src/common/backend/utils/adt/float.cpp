@@ -966,6 +966,7 @@ Datum btfloat4sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btfloat4fastcmp;
+    ssup->comparator_threadsafe = true;
     PG_RETURN_VOID();
 }
 
@@ -1067,6 +1068,7 @@ Datum btfloat8sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btfloat8fastcmp;
+    ssup->comparator_threadsafe = true;
     PG_RETURN_VOID();
 }
 
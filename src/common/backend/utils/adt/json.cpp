@@ -73,7 +73,6 @@ typedef enum                         /* required operations on state stack */
     JSON_STACKOP_POP                 /* pop, or expect end of input if no stack */
 } JsonStackOp;
 
-static void json_validate_cstring(char* input);
 static void json_lex(JsonLexContext* lex);
 static void json_lex_string(JsonLexContext* lex);
 static void json_lex_number(JsonLexContext* lex, char* s);
@@ -163,9 +162,10 @@ Datum json_recv(PG_FUNCTION_ARGS)
 }
 
 /*
- * Check whether supplied input is valid JSON.
+ * Check whether supplied input is valid JSON.  jsonb_in relies on it to
+ * report syntax errors before converting the text.
  */
-static void json_validate_cstring(char* input)
+void json_validate_cstring(char* input)
 {
     JsonLexContext lex;
     JsonParseStack *stack = NULL;
@@ -0,0 +1,1299 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * jsonb.cpp
+ *        Binary JSON data type: I/O, key lookup and containment.
+ *
+ * The text is validated by the json parser and converted once, at input
+ * time, into the format described in utils/jsonb.h, so the operators never
+ * parse JSON again.  The lookup operators (->, ->>, #>, #>>, ?, ?| and ?&)
+ * walk the containers through a JsonbReader.  When the datum is stored out
+ * of line without compression (STORAGE EXTERNAL) the reader fetches only
+ * the slices it needs from the toast table: the header and the entries of
+ * each container on the path, the keys of the objects, and finally the
+ * value found, instead of detoasting the whole document.
+ *
+ * IDENTIFICATION
+ *        src/common/backend/utils/adt/jsonb.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <limits.h>
+
+#include "access/tuptoaster.h"
+#include "catalog/pg_type.h"
+#include "libpq/pqformat.h"
+#include "mb/pg_wchar.h"
+#include "miscadmin.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/json.h"
+#include "utils/jsonb.h"
+
+/* version of the binary send/recv format */
+#define JSONB_SEND_VERSION 1
+
+/* number of JEntries of a container, an object has one for each key and value */
+#define JB_NENTRIES(header) (((header) & JB_FOBJECT) ? 2 * ((header) & JB_CMASK) : ((header) & JB_CMASK))
+#define JB_DATA_OFFSET(header) (sizeof(uint32) + JB_NENTRIES(header) * sizeof(JEntry))
+
+/*
+ * Reads the containers of a jsonb datum, either in memory or by toast slices.
+ * All the offsets are counted from the root container, i.e. from VARDATA.
+ */
+typedef struct JsonbReader {
+    struct varlena* toasted; /* uncompressed external datum, read by slices */
+    char* root;              /* root container of the detoasted datum otherwise */
+} JsonbReader;
+
+/* a container whose header and entries have been fetched */
+typedef struct JsonbReaderContainer {
+    uint32 header;
+    const JEntry* entries;
+    uint32 dataoff; /* offset of the data area */
+} JsonbReaderContainer;
+
+/* a child located by the reader, its data is fetched on demand */
+typedef struct JsonbChildRef {
+    JEntry entry;
+    uint32 offset;
+    uint32 len;
+} JsonbChildRef;
+
+static void jb_parse_value(char** p, JsonbValue* result);
+static void jb_put_value(StringInfo out, const JsonbValue* val);
+static void jb_convert_container(StringInfo buf, const JsonbValue* val);
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Container access
+ * ---------------------------------------------------------------------------------------
+ */
+
+/* offset of the data of the index-th child, from the start of the data area */
+static inline uint32 jb_child_start(const JEntry* entries, uint32 index)
+{
+    uint32 start = (index == 0) ? 0 : JBE_ENDPOS(entries[index - 1]);
+    JEntry type = JBE_TYPE(entries[index]);
+
+    if (type == JENTRY_ISNUMERIC || type == JENTRY_ISCONTAINER) {
+        start = INTALIGN(start);
+    }
+    return start;
+}
+
+static void jb_fill_value(JEntry entry, const char* data, uint32 len, JsonbValue* result)
+{
+    switch (JBE_TYPE(entry)) {
+        case JENTRY_ISSTRING:
+            result->type = jbvString;
+            result->val.string.val = (char*)data;
+            result->val.string.len = (int)len;
+            break;
+        case JENTRY_ISNUMERIC:
+            result->type = jbvNumeric;
+            result->val.numeric = (Numeric)data;
+            break;
+        case JENTRY_ISBOOL_FALSE:
+            result->type = jbvBool;
+            result->val.boolean = false;
+            break;
+        case JENTRY_ISBOOL_TRUE:
+            result->type = jbvBool;
+            result->val.boolean = true;
+            break;
+        case JENTRY_ISNULL:
+            result->type = jbvNull;
+            break;
+        case JENTRY_ISCONTAINER:
+            result->type = jbvBinary;
+            result->val.binary.data = (char*)data;
+            result->val.binary.len = (int)len;
+            break;
+        default:
+            ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("unrecognized jsonb entry type: %u", entry)));
+    }
+}
+
+/* object keys are ordered by length first, which makes the comparison cheap */
+static inline int jb_key_cmp(const char* a, int alen, const char* b, int blen)
+{
+    if (alen != blen) {
+        return (alen < blen) ? -1 : 1;
+    }
+    return memcmp(a, b, alen);
+}
+
+/*
+ * Binary search of a key among the count keys of an object.  keys points
+ * to the data area, only its key part is needed.  Returns the index of the
+ * key, or -1.
+ */
+static int jb_search_key(const JEntry* entries, const char* keys, uint32 count, const char* key, int keylen)
+{
+    uint32 lo = 0;
+    uint32 hi = count;
+
+    while (lo < hi) {
+        uint32 mid = lo + (hi - lo) / 2;
+        uint32 start = jb_child_start(entries, mid);
+        int cmp = jb_key_cmp(keys + start, (int)(JBE_ENDPOS(entries[mid]) - start), key, keylen);
+
+        if (cmp == 0) {
+            return (int)mid;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Get the index-th child of a container in memory.  The keys of an object
+ * are its children 0..n-1 and the values the children n..2n-1.
+ */
+void JsonbContainerChild(const char* container, uint32 index, JsonbValue* result)
+{
+    uint32 header = JBC_HEADER(container);
+    const JEntry* entries = (const JEntry*)(container + sizeof(uint32));
+    const char* data = container + JB_DATA_OFFSET(header);
+    uint32 start = jb_child_start(entries, index);
+
+    Assert(index < JB_NENTRIES(header));
+    jb_fill_value(entries[index], data + start, JBE_ENDPOS(entries[index]) - start, result);
+}
+
+/* Find the value of a key in an object in memory. */
+bool JsonbFindKey(const char* container, const char* key, int keylen, JsonbValue* result)
+{
+    uint32 header = JBC_HEADER(container);
+    uint32 count = header & JB_CMASK;
+    const JEntry* entries = (const JEntry*)(container + sizeof(uint32));
+    int index;
+
+    if ((header & JB_FOBJECT) == 0 || count == 0) {
+        return false;
+    }
+
+    index = jb_search_key(entries, container + JB_DATA_OFFSET(header), count, key, keylen);
+    if (index < 0) {
+        return false;
+    }
+
+    JsonbContainerChild(container, count + (uint32)index, result);
+    return true;
+}
+
+static void jsonb_reader_init(JsonbReader* reader, Datum d)
+{
+    struct varlena* raw = (struct varlena*)DatumGetPointer(d);
+
+    if (VARATT_IS_EXTERNAL_ONDISK_B(raw)) {
+        struct varatt_external toast_pointer;
+
+        VARATT_EXTERNAL_GET_POINTER(toast_pointer, raw);
+        if (!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer)) {
+            reader->toasted = raw;
+            reader->root = NULL;
+            return;
+        }
+    }
+
+    reader->toasted = NULL;
+    reader->root = JB_ROOT(DatumGetJsonb(d));
+}
+
+static const char* jsonb_reader_fetch(JsonbReader* reader, uint32 offset, uint32 length)
+{
+    struct varlena* slice = NULL;
+
+    if (reader->toasted == NULL) {
+        return reader->root + offset;
+    }
+    if (length == 0) {
+        return "";
+    }
+
+    slice = heap_tuple_untoast_attr_slice(reader->toasted, (int32)offset, (int32)length);
+    if (VARSIZE(slice) - VARHDRSZ < length) {
+        ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("jsonb value is truncated")));
+    }
+    return VARDATA(slice);
+}
+
+static void jsonb_reader_open(JsonbReader* reader, uint32 offset, JsonbReaderContainer* container)
+{
+    const char* header = jsonb_reader_fetch(reader, offset, sizeof(uint32));
+
+    container->header = JBC_HEADER(header);
+    container->entries =
+        (const JEntry*)jsonb_reader_fetch(reader, offset + sizeof(uint32), JB_NENTRIES(container->header) * sizeof(JEntry));
+    container->dataoff = offset + JB_DATA_OFFSET(container->header);
+}
+
+static void jsonb_reader_child(const JsonbReaderContainer* container, uint32 index, JsonbChildRef* child)
+{
+    uint32 start = jb_child_start(container->entries, index);
+
+    child->entry = container->entries[index];
+    child->offset = container->dataoff + start;
+    child->len = JBE_ENDPOS(child->entry) - start;
+}
+
+/*
+ * Fetch the first count children of a container: the keys of an object, or
+ * all the elements of an array.
+ */
+static const char* jsonb_reader_keys(JsonbReader* reader, const JsonbReaderContainer* container)
+{
+    uint32 count = container->header & JB_CMASK;
+
+    return jsonb_reader_fetch(reader, container->dataoff, JBE_ENDPOS(container->entries[count - 1]));
+}
+
+static bool jsonb_reader_key(JsonbReader* reader, const JsonbReaderContainer* container, const char* key, int keylen,
+    JsonbChildRef* child)
+{
+    uint32 count = container->header & JB_CMASK;
+    int index;
+
+    if ((container->header & JB_FOBJECT) == 0 || count == 0) {
+        return false;
+    }
+
+    index = jb_search_key(container->entries, jsonb_reader_keys(reader, container), count, key, keylen);
+    if (index < 0) {
+        return false;
+    }
+
+    jsonb_reader_child(container, count + (uint32)index, child);
+    return true;
+}
+
+/* a negative subscript counts from the end of the array */
+static bool jsonb_reader_element(const JsonbReaderContainer* container, int32 subscript, JsonbChildRef* child)
+{
+    int64 count = (int64)(container->header & JB_CMASK);
+    int64 index = subscript;
+
+    if ((container->header & JB_FARRAY) == 0 || (container->header & JB_FSCALAR) != 0) {
+        return false;
+    }
+
+    if (index < 0) {
+        index += count;
+    }
+    if (index < 0 || index >= count) {
+        return false;
+    }
+
+    jsonb_reader_child(container, (uint32)index, child);
+    return true;
+}
+
+static void jsonb_reader_value(JsonbReader* reader, const JsonbChildRef* child, JsonbValue* result)
+{
+    const char* data = NULL;
+    JEntry type = JBE_TYPE(child->entry);
+
+    if (type == JENTRY_ISSTRING || type == JENTRY_ISNUMERIC || type == JENTRY_ISCONTAINER) {
+        data = jsonb_reader_fetch(reader, child->offset, child->len);
+    }
+    jb_fill_value(child->entry, data, child->len, result);
+}
+
+/* the whole document as a value, a top level scalar is unwrapped */
+static void jsonb_whole_value(Datum d, JsonbValue* result)
+{
+    Jsonb* jb = DatumGetJsonb(d);
+
+    if (JB_ROOT_IS_SCALAR(jb)) {
+        JsonbContainerChild(JB_ROOT(jb), 0, result);
+    } else {
+        result->type = jbvBinary;
+        result->val.binary.data = JB_ROOT(jb);
+        result->val.binary.len = (int)(VARSIZE(jb) - VARHDRSZ);
+    }
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Containment
+ * ---------------------------------------------------------------------------------------
+ */
+static bool jb_scalar_equal(const JsonbValue* a, const JsonbValue* b)
+{
+    if (a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+        case jbvNull:
+            return true;
+        case jbvBool:
+            return a->val.boolean == b->val.boolean;
+        case jbvString:
+            return jb_key_cmp(a->val.string.val, a->val.string.len, b->val.string.val, b->val.string.len) == 0;
+        case jbvNumeric:
+            return DatumGetBool(
+                DirectFunctionCall2(numeric_eq, NumericGetDatum(a->val.numeric), NumericGetDatum(b->val.numeric)));
+        default:
+            return false;
+    }
+}
+
+static bool jb_value_contains(const JsonbValue* val, const JsonbValue* contained)
+{
+    if (contained->type == jbvBinary) {
+        return val->type == jbvBinary && JsonbDeepContains(val->val.binary.data, contained->val.binary.data);
+    }
+    return jb_scalar_equal(val, contained);
+}
+
+/*
+ * Does the container contain the other one?  Every member of a contained
+ * object must be in the object with a value containing the contained value,
+ * every element of a contained array must be contained in some element of
+ * the array.  An array contains a top level scalar, not the reverse.
+ */
+bool JsonbDeepContains(const char* container, const char* contained)
+{
+    uint32 header = JBC_HEADER(container);
+    uint32 cheader = JBC_HEADER(contained);
+    uint32 count = header & JB_CMASK;
+    uint32 ccount = cheader & JB_CMASK;
+    JsonbValue val;
+    JsonbValue cval;
+
+    check_stack_depth();
+
+    if ((header & JB_FOBJECT) != (cheader & JB_FOBJECT)) {
+        return false;
+    }
+
+    if (cheader & JB_FOBJECT) {
+        /* the keys are unique, the contained object cannot have more */
+        if (ccount > count) {
+            return false;
+        }
+
+        for (uint32 i = 0; i < ccount; i++) {
+            JsonbValue ckey;
+
+            JsonbContainerChild(contained, i, &ckey);
+            if (!JsonbFindKey(container, ckey.val.string.val, ckey.val.string.len, &val)) {
+                return false;
+            }
+            JsonbContainerChild(contained, ccount + i, &cval);
+            if (!jb_value_contains(&val, &cval)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if ((header & JB_FSCALAR) && !(cheader & JB_FSCALAR)) {
+        return false;
+    }
+
+    for (uint32 i = 0; i < ccount; i++) {
+        bool found = false;
+
+        JsonbContainerChild(contained, i, &cval);
+        for (uint32 j = 0; j < count && !found; j++) {
+            JsonbContainerChild(container, j, &val);
+            found = jb_value_contains(&val, &cval);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Conversion to the binary format
+ * ---------------------------------------------------------------------------------------
+ */
+
+/* numerics and containers start INTALIGN'd from the data area */
+static void jb_pad(StringInfo buf, int dataStart)
+{
+    int len = buf->len - dataStart;
+    int padlen = INTALIGN(len) - len;
+
+    while (padlen-- > 0) {
+        appendStringInfoCharMacro(buf, '\0');
+    }
+}
+
+static JEntry jb_convert_child(StringInfo buf, int dataStart, const JsonbValue* val)
+{
+    JEntry type;
+    uint32 end;
+
+    switch (val->type) {
+        case jbvNull:
+            type = JENTRY_ISNULL;
+            break;
+        case jbvBool:
+            type = val->val.boolean ? JENTRY_ISBOOL_TRUE : JENTRY_ISBOOL_FALSE;
+            break;
+        case jbvString:
+            appendBinaryStringInfo(buf, val->val.string.val, val->val.string.len);
+            type = JENTRY_ISSTRING;
+            break;
+        case jbvNumeric:
+            jb_pad(buf, dataStart);
+            appendBinaryStringInfo(buf, (const char*)val->val.numeric, VARSIZE(val->val.numeric));
+            type = JENTRY_ISNUMERIC;
+            break;
+        case jbvBinary:
+            jb_pad(buf, dataStart);
+            appendBinaryStringInfo(buf, val->val.binary.data, val->val.binary.len);
+            type = JENTRY_ISCONTAINER;
+            break;
+        case jbvArray:
+        case jbvObject:
+            jb_pad(buf, dataStart);
+            jb_convert_container(buf, val);
+            type = JENTRY_ISCONTAINER;
+            break;
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unknown type of jsonb value: %d", (int)val->type)));
+            type = JENTRY_ISNULL; /* keep compiler quiet */
+    }
+
+    end = (uint32)(buf->len - dataStart);
+    if (end > JENTRY_ENDPOSMASK) {
+        ereport(ERROR,
+            (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                errmsg("total size of jsonb array or object elements exceeds the maximum of %u bytes",
+                    JENTRY_ENDPOSMASK)));
+    }
+    return type | end;
+}
+
+static void jb_convert_container(StringInfo buf, const JsonbValue* val)
+{
+    uint32 count;
+    uint32 header;
+    uint32 nentries;
+    int headerOff;
+    int dataStart;
+    JEntry* entries = NULL;
+    errno_t rc;
+
+    check_stack_depth();
+
+    if (val->type == jbvObject) {
+        count = (uint32)val->val.object.nPairs;
+        header = JB_FOBJECT;
+    } else {
+        count = (uint32)val->val.array.nElems;
+        header = JB_FARRAY | (val->val.array.rawScalar ? JB_FSCALAR : 0);
+    }
+    if (count > JB_CMASK) {
+        ereport(ERROR,
+            (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                errmsg("number of jsonb array elements or object pairs exceeds the maximum allowed (%u)", JB_CMASK)));
+    }
+    header |= count;
+    nentries = JB_NENTRIES(header);
+
+    /* reserve the header and the entries, they are written at the end */
+    headerOff = buf->len;
+    enlargeStringInfo(buf, (int)JB_DATA_OFFSET(header));
+    buf->len += (int)JB_DATA_OFFSET(header);
+    dataStart = buf->len;
+
+    entries = (JEntry*)palloc(Max(nentries, 1) * sizeof(JEntry));
+    if (val->type == jbvObject) {
+        for (uint32 i = 0; i < count; i++) {
+            entries[i] = jb_convert_child(buf, dataStart, &val->val.object.pairs[i].key);
+        }
+        for (uint32 i = 0; i < count; i++) {
+            entries[count + i] = jb_convert_child(buf, dataStart, &val->val.object.pairs[i].value);
+        }
+    } else {
+        for (uint32 i = 0; i < count; i++) {
+            entries[i] = jb_convert_child(buf, dataStart, &val->val.array.elems[i]);
+        }
+    }
+
+    rc = memcpy_s(buf->data + headerOff, sizeof(uint32), &header, sizeof(uint32));
+    securec_check(rc, "\0", "\0");
+    if (nentries > 0) {
+        rc = memcpy_s(buf->data + headerOff + sizeof(uint32), nentries * sizeof(JEntry), entries,
+            nentries * sizeof(JEntry));
+        securec_check(rc, "\0", "\0");
+    }
+    pfree(entries);
+}
+
+/* Serialize a value, a scalar becomes a one element array flagged JB_FSCALAR. */
+Jsonb* JsonbValueToJsonb(JsonbValue* val)
+{
+    StringInfoData buf;
+    JsonbValue wrapper;
+    Jsonb* result = NULL;
+
+    if (val->type == jbvBinary) {
+        result = (Jsonb*)palloc(VARHDRSZ + val->val.binary.len);
+        SET_VARSIZE(result, VARHDRSZ + val->val.binary.len);
+        errno_t rc = memcpy_s(JB_ROOT(result), val->val.binary.len, val->val.binary.data, val->val.binary.len);
+        securec_check(rc, "\0", "\0");
+        return result;
+    }
+
+    if (val->type != jbvArray && val->type != jbvObject) {
+        wrapper.type = jbvArray;
+        wrapper.val.array.nElems = 1;
+        wrapper.val.array.elems = val;
+        wrapper.val.array.rawScalar = true;
+        val = &wrapper;
+    }
+
+    initStringInfo(&buf);
+    buf.len = VARHDRSZ;
+    jb_convert_container(&buf, val);
+
+    result = (Jsonb*)buf.data;
+    SET_VARSIZE(result, buf.len);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Parsing, on text already validated by json_validate_cstring
+ * ---------------------------------------------------------------------------------------
+ */
+static inline void jb_skip_space(char** p)
+{
+    while (**p == ' ' || **p == '\t' || **p == '\n' || **p == '\r') {
+        (*p)++;
+    }
+}
+
+static int jb_hex4(const char* s)
+{
+    int ch = 0;
+
+    for (int i = 0; i < 4; i++) {
+        char c = s[i];
+
+        if (c >= '0' && c <= '9') {
+            ch = (ch * 16) + (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            ch = (ch * 16) + (c - 'a') + 10;
+        } else {
+            ch = (ch * 16) + (c - 'A') + 10;
+        }
+    }
+    return ch;
+}
+
+static void jb_append_unicode(StringInfo buf, pg_wchar ch)
+{
+    if (ch == 0) {
+        ereport(ERROR,
+            (errcode(ERRCODE_UNTRANSLATABLE_CHARACTER),
+                errmsg("unsupported Unicode escape sequence"),
+                errdetail("\\u0000 cannot be converted to text.")));
+    }
+
+    if (GetDatabaseEncoding() == PG_UTF8) {
+        unsigned char utf8[5];
+
+        (void)unicode_to_utf8(ch, utf8);
+        appendBinaryStringInfo(buf, (const char*)utf8, pg_utf_mblen(utf8));
+    } else if (ch <= 0x007f) {
+        appendStringInfoChar(buf, (char)ch);
+    } else {
+        ereport(ERROR,
+            (errcode(ERRCODE_UNTRANSLATABLE_CHARACTER),
+                errmsg("unsupported Unicode escape sequence"),
+                errdetail("Unicode escape values cannot be used for code point values above 007F "
+                          "when the server encoding is not UTF8.")));
+    }
+}
+
+static void jb_parse_string(char** p, JsonbValue* result)
+{
+    StringInfoData buf;
+    char* s = *p + 1;
+
+    initStringInfo(&buf);
+    while (*s != '"') {
+        if (*s != '\\') {
+            char* start = s;
+
+            while (*s != '"' && *s != '\\') {
+                s += pg_mblen(s);
+            }
+            appendBinaryStringInfo(&buf, start, (int)(s - start));
+            continue;
+        }
+
+        s++;
+        switch (*s) {
+            case 'b':
+                appendStringInfoChar(&buf, '\b');
+                break;
+            case 'f':
+                appendStringInfoChar(&buf, '\f');
+                break;
+            case 'n':
+                appendStringInfoChar(&buf, '\n');
+                break;
+            case 'r':
+                appendStringInfoChar(&buf, '\r');
+                break;
+            case 't':
+                appendStringInfoChar(&buf, '\t');
+                break;
+            case 'u': {
+                pg_wchar ch = (pg_wchar)jb_hex4(s + 1);
+
+                s += 4;
+                if (ch >= 0xdc00 && ch <= 0xdfff) {
+                    ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                            errmsg("invalid input syntax for type jsonb"),
+                            errdetail("Unicode low surrogate must follow a high surrogate.")));
+                }
+                if (ch >= 0xd800 && ch <= 0xdbff) {
+                    pg_wchar lo = 0;
+
+                    if (s[1] == '\\' && s[2] == 'u') {
+                        lo = (pg_wchar)jb_hex4(s + 3);
+                    }
+                    if (lo < 0xdc00 || lo > 0xdfff) {
+                        ereport(ERROR,
+                            (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                                errmsg("invalid input syntax for type jsonb"),
+                                errdetail("Unicode high surrogate must be followed by a low surrogate.")));
+                    }
+                    ch = 0x10000 + ((ch & 0x3ff) << 10) + (lo & 0x3ff);
+                    s += 6;
+                }
+                jb_append_unicode(&buf, ch);
+                break;
+            }
+            default:
+                /* '"', '\\' or '/' */
+                appendStringInfoChar(&buf, *s);
+                break;
+        }
+        s++;
+    }
+
+    result->type = jbvString;
+    result->val.string.val = buf.data;
+    result->val.string.len = buf.len;
+    *p = s + 1;
+}
+
+static void jb_parse_number(char** p, JsonbValue* result)
+{
+    char* start = *p;
+    char* str = NULL;
+
+    while ((**p >= '0' && **p <= '9') || **p == '-' || **p == '+' || **p == '.' || **p == 'e' || **p == 'E') {
+        (*p)++;
+    }
+
+    str = pnstrdup(start, *p - start);
+    result->type = jbvNumeric;
+    result->val.numeric = DatumGetNumeric(
+        DirectFunctionCall3(numeric_in, CStringGetDatum(str), ObjectIdGetDatum(InvalidOid), Int32GetDatum(-1)));
+    pfree(str);
+}
+
+static void jb_parse_array(char** p, JsonbValue* result)
+{
+    int size = 4;
+    int nelems = 0;
+    JsonbValue* elems = (JsonbValue*)palloc(sizeof(JsonbValue) * size);
+
+    check_stack_depth();
+
+    (*p)++;
+    jb_skip_space(p);
+    if (**p != ']') {
+        for (;;) {
+            if (nelems >= size) {
+                size *= 2;
+                elems = (JsonbValue*)repalloc(elems, sizeof(JsonbValue) * size);
+            }
+            jb_parse_value(p, &elems[nelems++]);
+            jb_skip_space(p);
+            if (**p != ',') {
+                break;
+            }
+            (*p)++;
+        }
+    }
+    (*p)++;
+
+    result->type = jbvArray;
+    result->val.array.nElems = nelems;
+    result->val.array.elems = elems;
+    result->val.array.rawScalar = false;
+}
+
+static int jb_pair_cmp(const void* a, const void* b)
+{
+    const JsonbPair* pa = (const JsonbPair*)a;
+    const JsonbPair* pb = (const JsonbPair*)b;
+    int res = jb_key_cmp(pa->key.val.string.val, pa->key.val.string.len, pb->key.val.string.val,
+        pb->key.val.string.len);
+
+    /* the duplicates stay in input order */
+    if (res == 0) {
+        res = (pa->order > pb->order) ? 1 : -1;
+    }
+    return res;
+}
+
+/* Sort the pairs of an object by key and keep the last of the duplicate keys. */
+static void jb_unique_pairs(JsonbValue* object)
+{
+    JsonbPair* pairs = object->val.object.pairs;
+    JsonbPair* res = pairs;
+
+    if (object->val.object.nPairs <= 1) {
+        return;
+    }
+
+    qsort(pairs, object->val.object.nPairs, sizeof(JsonbPair), jb_pair_cmp);
+    for (JsonbPair* ptr = pairs + 1; ptr < pairs + object->val.object.nPairs; ptr++) {
+        if (jb_key_cmp(ptr->key.val.string.val, ptr->key.val.string.len, res->key.val.string.val,
+            res->key.val.string.len) != 0) {
+            res++;
+        }
+        if (res != ptr) {
+            *res = *ptr;
+        }
+    }
+    object->val.object.nPairs = (int)(res - pairs) + 1;
+}
+
+static void jb_parse_object(char** p, JsonbValue* result)
+{
+    int size = 4;
+    int npairs = 0;
+    JsonbPair* pairs = (JsonbPair*)palloc(sizeof(JsonbPair) * size);
+
+    check_stack_depth();
+
+    (*p)++;
+    jb_skip_space(p);
+    if (**p != '}') {
+        for (;;) {
+            if (npairs >= size) {
+                size *= 2;
+                pairs = (JsonbPair*)repalloc(pairs, sizeof(JsonbPair) * size);
+            }
+            jb_skip_space(p);
+            jb_parse_string(p, &pairs[npairs].key);
+            jb_skip_space(p);
+            (*p)++; /* ':' */
+            jb_parse_value(p, &pairs[npairs].value);
+            pairs[npairs].order = (uint32)npairs;
+            npairs++;
+            jb_skip_space(p);
+            if (**p != ',') {
+                break;
+            }
+            (*p)++;
+        }
+    }
+    (*p)++;
+
+    result->type = jbvObject;
+    result->val.object.nPairs = npairs;
+    result->val.object.pairs = pairs;
+    jb_unique_pairs(result);
+}
+
+static void jb_parse_value(char** p, JsonbValue* result)
+{
+    jb_skip_space(p);
+    switch (**p) {
+        case '{':
+            jb_parse_object(p, result);
+            break;
+        case '[':
+            jb_parse_array(p, result);
+            break;
+        case '"':
+            jb_parse_string(p, result);
+            break;
+        case 't':
+            result->type = jbvBool;
+            result->val.boolean = true;
+            *p += strlen("true");
+            break;
+        case 'f':
+            result->type = jbvBool;
+            result->val.boolean = false;
+            *p += strlen("false");
+            break;
+        case 'n':
+            result->type = jbvNull;
+            *p += strlen("null");
+            break;
+        default:
+            jb_parse_number(p, result);
+            break;
+    }
+}
+
+static Jsonb* jsonb_from_cstring(char* json)
+{
+    JsonbValue val;
+    char* p = json;
+
+    json_validate_cstring(json);
+    jb_parse_value(&p, &val);
+    return JsonbValueToJsonb(&val);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Output
+ * ---------------------------------------------------------------------------------------
+ */
+static void jb_put_container(StringInfo out, const char* container)
+{
+    uint32 header = JBC_HEADER(container);
+    uint32 count = header & JB_CMASK;
+    JsonbValue val;
+
+    check_stack_depth();
+
+    if (header & JB_FSCALAR) {
+        JsonbContainerChild(container, 0, &val);
+        jb_put_value(out, &val);
+        return;
+    }
+
+    appendStringInfoChar(out, (header & JB_FOBJECT) ? '{' : '[');
+    for (uint32 i = 0; i < count; i++) {
+        if (i > 0) {
+            appendBinaryStringInfo(out, ", ", 2);
+        }
+        JsonbContainerChild(container, i, &val);
+        jb_put_value(out, &val);
+        if (header & JB_FOBJECT) {
+            appendBinaryStringInfo(out, ": ", 2);
+            JsonbContainerChild(container, count + i, &val);
+            jb_put_value(out, &val);
+        }
+    }
+    appendStringInfoChar(out, (header & JB_FOBJECT) ? '}' : ']');
+}
+
+static void jb_put_value(StringInfo out, const JsonbValue* val)
+{
+    switch (val->type) {
+        case jbvNull:
+            appendBinaryStringInfo(out, "null", 4);
+            break;
+        case jbvBool:
+            if (val->val.boolean) {
+                appendBinaryStringInfo(out, "true", 4);
+            } else {
+                appendBinaryStringInfo(out, "false", 5);
+            }
+            break;
+        case jbvString: {
+            char* str = pnstrdup(val->val.string.val, val->val.string.len);
+
+            escape_json(out, str);
+            pfree(str);
+            break;
+        }
+        case jbvNumeric: {
+            char* str = DatumGetCString(DirectFunctionCall1(numeric_out, NumericGetDatum(val->val.numeric)));
+
+            appendStringInfoString(out, str);
+            pfree(str);
+            break;
+        }
+        case jbvBinary:
+            jb_put_container(out, val->val.binary.data);
+            break;
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unknown type of jsonb value: %d", (int)val->type)));
+    }
+}
+
+/* Convert a container to its text form, appending it to out if given. */
+char* JsonbToCString(StringInfo out, const char* container, int estimatedLen)
+{
+    if (out == NULL) {
+        out = makeStringInfo();
+    }
+    enlargeStringInfo(out, (estimatedLen >= 0) ? estimatedLen : 64);
+    jb_put_container(out, container);
+    return out->data;
+}
+
+/* The text form of a value for the ->> operators, NULL for a json null. */
+static text* jb_value_to_text(const JsonbValue* val)
+{
+    StringInfoData buf;
+
+    if (val->type == jbvNull) {
+        return NULL;
+    }
+    if (val->type == jbvString) {
+        return cstring_to_text_with_len(val->val.string.val, val->val.string.len);
+    }
+
+    initStringInfo(&buf);
+    jb_put_value(&buf, val);
+    return cstring_to_text_with_len(buf.data, buf.len);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * I/O routines
+ * ---------------------------------------------------------------------------------------
+ */
+Datum jsonb_in(PG_FUNCTION_ARGS)
+{
+    char* json = PG_GETARG_CSTRING(0);
+
+    PG_RETURN_JSONB(jsonb_from_cstring(json));
+}
+
+Datum jsonb_out(PG_FUNCTION_ARGS)
+{
+    Jsonb* jb = PG_GETARG_JSONB(0);
+
+    PG_RETURN_CSTRING(JsonbToCString(NULL, JB_ROOT(jb), VARSIZE(jb)));
+}
+
+/*
+ * The binary format is a version byte followed by the text form, so that
+ * the clients do not depend on the on-disk format.
+ */
+Datum jsonb_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo)PG_GETARG_POINTER(0);
+    int version = pq_getmsgint(buf, 1);
+    char* str = NULL;
+    int nbytes;
+
+    if (version != JSONB_SEND_VERSION) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION), errmsg("unsupported jsonb version number %d", version)));
+    }
+
+    str = pq_getmsgtext(buf, buf->len - buf->cursor, &nbytes);
+    PG_RETURN_JSONB(jsonb_from_cstring(str));
+}
+
+Datum jsonb_send(PG_FUNCTION_ARGS)
+{
+    Jsonb* jb = PG_GETARG_JSONB(0);
+    StringInfoData buf;
+    StringInfoData jtext;
+
+    initStringInfo(&jtext);
+    (void)JsonbToCString(&jtext, JB_ROOT(jb), VARSIZE(jb));
+
+    pq_begintypsend(&buf);
+    pq_sendint(&buf, JSONB_SEND_VERSION, 1);
+    pq_sendtext(&buf, jtext.data, jtext.len);
+    pfree(jtext.data);
+
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * ---------------------------------------------------------------------------------------
+ * Operators
+ * ---------------------------------------------------------------------------------------
+ */
+static bool jsonb_get_field(Datum d, text* key, JsonbValue* result)
+{
+    JsonbReader reader;
+    JsonbReaderContainer root;
+    JsonbChildRef child;
+
+    jsonb_reader_init(&reader, d);
+    jsonb_reader_open(&reader, 0, &root);
+    if (!jsonb_reader_key(&reader, &root, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key), &child)) {
+        return false;
+    }
+    jsonb_reader_value(&reader, &child, result);
+    return true;
+}
+
+static bool jsonb_get_element(Datum d, int32 subscript, JsonbValue* result)
+{
+    JsonbReader reader;
+    JsonbReaderContainer root;
+    JsonbChildRef child;
+
+    jsonb_reader_init(&reader, d);
+    jsonb_reader_open(&reader, 0, &root);
+    if (!jsonb_reader_element(&root, subscript, &child)) {
+        return false;
+    }
+    jsonb_reader_value(&reader, &child, result);
+    return true;
+}
+
+/* a path element used on an array must be an integer */
+static bool jb_parse_subscript(text* elem, int32* subscript)
+{
+    char* str = text_to_cstring(elem);
+    char* end = NULL;
+    long val;
+
+    errno = 0;
+    val = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || errno != 0 || val > INT_MAX || val < INT_MIN) {
+        pfree(str);
+        return false;
+    }
+    pfree(str);
+    *subscript = (int32)val;
+    return true;
+}
+
+/*
+ * Follow a path of keys and subscripts.  Only the containers on the path
+ * are read, an empty path selects the whole document.
+ */
+static bool jsonb_get_path(Datum d, ArrayType* path, JsonbValue* result)
+{
+    JsonbReader reader;
+    JsonbReaderContainer container;
+    JsonbChildRef child;
+    Datum* elems = NULL;
+    bool* nulls = NULL;
+    int npath;
+
+    deconstruct_array(path, TEXTOID, -1, false, 'i', &elems, &nulls, &npath);
+    if (npath == 0) {
+        jsonb_whole_value(d, result);
+        return true;
+    }
+
+    jsonb_reader_init(&reader, d);
+    child.entry = JENTRY_ISCONTAINER;
+    child.offset = 0;
+    child.len = 0;
+    for (int i = 0; i < npath; i++) {
+        text* elem = NULL;
+        bool found = false;
+
+        if (nulls[i] || JBE_TYPE(child.entry) != JENTRY_ISCONTAINER) {
+            return false;
+        }
+
+        elem = DatumGetTextPP(elems[i]);
+        jsonb_reader_open(&reader, child.offset, &container);
+        if (container.header & JB_FOBJECT) {
+            found = jsonb_reader_key(&reader, &container, VARDATA_ANY(elem), VARSIZE_ANY_EXHDR(elem), &child);
+        } else {
+            int32 subscript;
+
+            found = jb_parse_subscript(elem, &subscript) && jsonb_reader_element(&container, subscript, &child);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    jsonb_reader_value(&reader, &child, result);
+    return true;
+}
+
+Datum jsonb_object_field(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+
+    if (!jsonb_get_field(PG_GETARG_DATUM(0), PG_GETARG_TEXT_PP(1), &val)) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_JSONB(JsonbValueToJsonb(&val));
+}
+
+Datum jsonb_object_field_text(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+    text* result = NULL;
+
+    if (!jsonb_get_field(PG_GETARG_DATUM(0), PG_GETARG_TEXT_PP(1), &val) || (result = jb_value_to_text(&val)) == NULL) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_TEXT_P(result);
+}
+
+Datum jsonb_array_element(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+
+    if (!jsonb_get_element(PG_GETARG_DATUM(0), PG_GETARG_INT32(1), &val)) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_JSONB(JsonbValueToJsonb(&val));
+}
+
+Datum jsonb_array_element_text(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+    text* result = NULL;
+
+    if (!jsonb_get_element(PG_GETARG_DATUM(0), PG_GETARG_INT32(1), &val) || (result = jb_value_to_text(&val)) == NULL) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_TEXT_P(result);
+}
+
+Datum jsonb_extract_path(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+
+    if (!jsonb_get_path(PG_GETARG_DATUM(0), PG_GETARG_ARRAYTYPE_P(1), &val)) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_JSONB(JsonbValueToJsonb(&val));
+}
+
+Datum jsonb_extract_path_text(PG_FUNCTION_ARGS)
+{
+    JsonbValue val;
+    text* result = NULL;
+
+    if (!jsonb_get_path(PG_GETARG_DATUM(0), PG_GETARG_ARRAYTYPE_P(1), &val) || (result = jb_value_to_text(&val)) == NULL) {
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_TEXT_P(result);
+}
+
+/*
+ * Is the string a key of the root object, or a string element of the root
+ * array?  data holds the first children of the root, see jsonb_reader_keys.
+ */
+static bool jb_exists(const JsonbReaderContainer* root, const char* data, const char* key, int keylen)
+{
+    uint32 count = root->header & JB_CMASK;
+
+    if (root->header & JB_FOBJECT) {
+        return jb_search_key(root->entries, data, count, key, keylen) >= 0;
+    }
+
+    for (uint32 i = 0; i < count; i++) {
+        if (JBE_TYPE(root->entries[i]) == JENTRY_ISSTRING) {
+            uint32 start = jb_child_start(root->entries, i);
+
+            if (jb_key_cmp(data + start, (int)(JBE_ENDPOS(root->entries[i]) - start), key, keylen) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+Datum jsonb_exists(PG_FUNCTION_ARGS)
+{
+    text* key = PG_GETARG_TEXT_PP(1);
+    JsonbReader reader;
+    JsonbReaderContainer root;
+
+    jsonb_reader_init(&reader, PG_GETARG_DATUM(0));
+    jsonb_reader_open(&reader, 0, &root);
+    if ((root.header & JB_CMASK) == 0) {
+        PG_RETURN_BOOL(false);
+    }
+
+    PG_RETURN_BOOL(jb_exists(&root, jsonb_reader_keys(&reader, &root), VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key)));
+}
+
+/* ?| and ?&, the null elements of the array are ignored */
+static bool jsonb_exists_array(Datum d, ArrayType* keys, bool any)
+{
+    JsonbReader reader;
+    JsonbReaderContainer root;
+    const char* data = NULL;
+    Datum* elems = NULL;
+    bool* nulls = NULL;
+    int nelems;
+
+    deconstruct_array(keys, TEXTOID, -1, false, 'i', &elems, &nulls, &nelems);
+
+    jsonb_reader_init(&reader, d);
+    jsonb_reader_open(&reader, 0, &root);
+    if ((root.header & JB_CMASK) > 0) {
+        data = jsonb_reader_keys(&reader, &root);
+    }
+
+    for (int i = 0; i < nelems; i++) {
+        text* key = NULL;
+        bool found = false;
+
+        if (nulls[i]) {
+            continue;
+        }
+        key = DatumGetTextPP(elems[i]);
+        found = (data != NULL) && jb_exists(&root, data, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key));
+        if (found == any) {
+            return any;
+        }
+    }
+    return !any;
+}
+
+Datum jsonb_exists_any(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(jsonb_exists_array(PG_GETARG_DATUM(0), PG_GETARG_ARRAYTYPE_P(1), true));
+}
+
+Datum jsonb_exists_all(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(jsonb_exists_array(PG_GETARG_DATUM(0), PG_GETARG_ARRAYTYPE_P(1), false));
+}
+
+Datum jsonb_contains(PG_FUNCTION_ARGS)
+{
+    Jsonb* val = PG_GETARG_JSONB(0);
+    Jsonb* tmpl = PG_GETARG_JSONB(1);
+
+    PG_RETURN_BOOL(JsonbDeepContains(JB_ROOT(val), JB_ROOT(tmpl)));
+}
+
+Datum jsonb_contained(PG_FUNCTION_ARGS)
+{
+    Jsonb* tmpl = PG_GETARG_JSONB(0);
+    Jsonb* val = PG_GETARG_JSONB(1);
+
+    PG_RETURN_BOOL(JsonbDeepContains(JB_ROOT(val), JB_ROOT(tmpl)));
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * jsonb_gin.cpp
+ *        GIN support functions for jsonb_ops
+ *
+ * Every key and every scalar of a document, at any depth, becomes a text
+ * entry made of a flag byte and the key bytes.  Object keys and the string
+ * elements of arrays share the JGINFLAG_KEY flag so that the existence
+ * operators find both, like the operators themselves do.  Numerics are
+ * indexed by their hash, which is the same for equal values written
+ * differently (1.0 and 1), and long strings by the hash of their bytes.
+ * The entries only say that the pieces are present somewhere in the
+ * document, so every match is rechecked.
+ *
+ * IDENTIFICATION
+ *        src/common/backend/utils/adt/jsonb_gin.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/gin.h"
+#include "access/hash.h"
+#include "access/skey.h"
+#include "catalog/pg_type.h"
+#include "miscadmin.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/jsonb.h"
+
+typedef struct GinEntries {
+    Datum* buf;
+    int32 count;
+    int32 allocated;
+} GinEntries;
+
+static void gin_entries_add(GinEntries* entries, Datum entry)
+{
+    if (entries->count >= entries->allocated) {
+        entries->allocated = (entries->allocated > 0) ? entries->allocated * 2 : 16;
+        if (entries->buf == NULL) {
+            entries->buf = (Datum*)palloc(sizeof(Datum) * entries->allocated);
+        } else {
+            entries->buf = (Datum*)repalloc(entries->buf, sizeof(Datum) * entries->allocated);
+        }
+    }
+    entries->buf[entries->count++] = entry;
+}
+
+static Datum jb_gin_key(char flag, const char* str, int len)
+{
+    char hashbuf[9];
+    text* item = NULL;
+    errno_t rc;
+
+    if (len > JGIN_MAXLENGTH) {
+        uint32 hash = DatumGetUInt32(hash_any((const unsigned char*)str, len));
+
+        rc = snprintf_s(hashbuf, sizeof(hashbuf), sizeof(hashbuf) - 1, "%08x", hash);
+        securec_check_ss(rc, "\0", "\0");
+        flag |= JGINFLAG_HASHED;
+        str = hashbuf;
+        len = 8;
+    }
+
+    item = (text*)palloc(VARHDRSZ + 1 + len);
+    SET_VARSIZE(item, VARHDRSZ + 1 + len);
+    *VARDATA(item) = flag;
+    if (len > 0) {
+        rc = memcpy_s(VARDATA(item) + 1, len, str, len);
+        securec_check(rc, "\0", "\0");
+    }
+    return PointerGetDatum(item);
+}
+
+static Datum jb_gin_scalar_key(const JsonbValue* val, bool isKey)
+{
+    char hashbuf[9];
+    errno_t rc;
+
+    switch (val->type) {
+        case jbvNull:
+            return jb_gin_key(JGINFLAG_NULL, "", 0);
+        case jbvBool:
+            return jb_gin_key(JGINFLAG_BOOL, val->val.boolean ? "t" : "f", 1);
+        case jbvNumeric: {
+            uint32 hash = DatumGetUInt32(DirectFunctionCall1(hash_numeric, NumericGetDatum(val->val.numeric)));
+
+            rc = snprintf_s(hashbuf, sizeof(hashbuf), sizeof(hashbuf) - 1, "%08x", hash);
+            securec_check_ss(rc, "\0", "\0");
+            return jb_gin_key(JGINFLAG_NUM, hashbuf, 8);
+        }
+        case jbvString:
+            return jb_gin_key(isKey ? JGINFLAG_KEY : JGINFLAG_STR, val->val.string.val, val->val.string.len);
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unexpected jsonb value type: %d", (int)val->type)));
+            return (Datum)0; /* keep compiler quiet */
+    }
+}
+
+static void jb_gin_extract(GinEntries* entries, const char* container)
+{
+    uint32 count = JBC_COUNT(container);
+    bool isObject = JBC_IS_OBJECT(container);
+    JsonbValue val;
+
+    check_stack_depth();
+
+    for (uint32 i = 0; i < count; i++) {
+        JsonbContainerChild(container, i, &val);
+        if (isObject) {
+            gin_entries_add(entries, jb_gin_scalar_key(&val, true));
+            JsonbContainerChild(container, count + i, &val);
+        }
+
+        if (val.type == jbvBinary) {
+            jb_gin_extract(entries, val.val.binary.data);
+        } else {
+            gin_entries_add(entries, jb_gin_scalar_key(&val, !isObject));
+        }
+    }
+}
+
+static Datum* jb_gin_extract_jsonb(Jsonb* jb, int32* nentries)
+{
+    GinEntries entries = {NULL, 0, 0};
+
+    jb_gin_extract(&entries, JB_ROOT(jb));
+    *nentries = entries.count;
+    return entries.buf;
+}
+
+/* The entries are compared bytewise, they only need a consistent order. */
+Datum gin_compare_jsonb(PG_FUNCTION_ARGS)
+{
+    text* a = PG_GETARG_TEXT_PP(0);
+    text* b = PG_GETARG_TEXT_PP(1);
+    int lena = VARSIZE_ANY_EXHDR(a);
+    int lenb = VARSIZE_ANY_EXHDR(b);
+    int cmp;
+
+    cmp = memcmp(VARDATA_ANY(a), VARDATA_ANY(b), Min(lena, lenb));
+    if (cmp == 0 && lena != lenb) {
+        cmp = (lena < lenb) ? -1 : 1;
+    }
+
+    PG_FREE_IF_COPY(a, 0);
+    PG_FREE_IF_COPY(b, 1);
+    PG_RETURN_INT32(cmp);
+}
+
+Datum gin_extract_jsonb(PG_FUNCTION_ARGS)
+{
+    Jsonb* jb = PG_GETARG_JSONB(0);
+    int32* nentries = (int32*)PG_GETARG_POINTER(1);
+
+    PG_RETURN_POINTER(jb_gin_extract_jsonb(jb, nentries));
+}
+
+Datum gin_extract_jsonb_query(PG_FUNCTION_ARGS)
+{
+    int32* nentries = (int32*)PG_GETARG_POINTER(1);
+    StrategyNumber strategy = PG_GETARG_UINT16(2);
+    int32* searchMode = (int32*)PG_GETARG_POINTER(6);
+    Datum* entries = NULL;
+
+    switch (strategy) {
+        case JsonbContainsStrategyNumber:
+            entries = jb_gin_extract_jsonb(PG_GETARG_JSONB(0), nentries);
+            /* '{}' and '[]' are contained in every document of the same kind */
+            if (*nentries == 0) {
+                *searchMode = GIN_SEARCH_MODE_ALL;
+            }
+            break;
+        case JsonbExistsStrategyNumber: {
+            text* key = PG_GETARG_TEXT_PP(0);
+
+            entries = (Datum*)palloc(sizeof(Datum));
+            entries[0] = jb_gin_key(JGINFLAG_KEY, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key));
+            *nentries = 1;
+            break;
+        }
+        case JsonbExistsAnyStrategyNumber:
+        case JsonbExistsAllStrategyNumber: {
+            ArrayType* query = PG_GETARG_ARRAYTYPE_P(0);
+            Datum* keys = NULL;
+            bool* nulls = NULL;
+            int nkeys;
+            int j = 0;
+
+            deconstruct_array(query, TEXTOID, -1, false, 'i', &keys, &nulls, &nkeys);
+            entries = (Datum*)palloc(sizeof(Datum) * Max(nkeys, 1));
+            for (int i = 0; i < nkeys; i++) {
+                text* key = NULL;
+
+                /* the operators ignore the null keys */
+                if (nulls[i]) {
+                    continue;
+                }
+                key = DatumGetTextPP(keys[i]);
+                entries[j++] = jb_gin_key(JGINFLAG_KEY, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key));
+            }
+            *nentries = j;
+
+            /* ?& with no key matches everything, ?| with no key nothing */
+            if (j == 0 && strategy == JsonbExistsAllStrategyNumber) {
+                *searchMode = GIN_SEARCH_MODE_ALL;
+            }
+            break;
+        }
+        default:
+            ereport(ERROR, (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unrecognized strategy number: %d", strategy)));
+            break;
+    }
+
+    PG_RETURN_POINTER(entries);
+}
+
+Datum gin_consistent_jsonb(PG_FUNCTION_ARGS)
+{
+    bool* check = (bool*)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    bool* recheck = (bool*)PG_GETARG_POINTER(5);
+    bool res = true;
+
+    /* the entries do not record where the pieces are in the document */
+    *recheck = true;
+
+    switch (strategy) {
+        case JsonbContainsStrategyNumber:
+        case JsonbExistsAllStrategyNumber:
+            for (int32 i = 0; i < nkeys; i++) {
+                if (!check[i]) {
+                    res = false;
+                    break;
+                }
+            }
+            break;
+        case JsonbExistsStrategyNumber:
+        case JsonbExistsAnyStrategyNumber:
+            res = false;
+            for (int32 i = 0; i < nkeys; i++) {
+                if (check[i]) {
+                    res = true;
+                    break;
+                }
+            }
+            break;
+        default:
+            ereport(ERROR, (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unrecognized strategy number: %d", strategy)));
+    }
+
+    PG_RETURN_BOOL(res);
+}
+
+Datum gin_triconsistent_jsonb(PG_FUNCTION_ARGS)
+{
+    GinTernaryValue* check = (GinTernaryValue*)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    GinTernaryValue res = GIN_MAYBE;
+
+    /* never GIN_TRUE, every match is rechecked */
+    switch (strategy) {
+        case JsonbContainsStrategyNumber:
+        case JsonbExistsAllStrategyNumber:
+            for (int32 i = 0; i < nkeys; i++) {
+                if (check[i] == GIN_FALSE) {
+                    res = GIN_FALSE;
+                    break;
+                }
+            }
+            break;
+        case JsonbExistsStrategyNumber:
+        case JsonbExistsAnyStrategyNumber:
+            res = GIN_FALSE;
+            for (int32 i = 0; i < nkeys; i++) {
+                if (check[i] != GIN_FALSE) {
+                    res = GIN_MAYBE;
+                    break;
+                }
+            }
+            break;
+        default:
+            ereport(ERROR, (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE), errmsg("unrecognized strategy number: %d", strategy)));
+    }
+
+    PG_RETURN_GIN_TERNARY_VALUE(res);
+}
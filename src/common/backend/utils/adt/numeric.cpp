@@ -1322,6 +1322,14 @@ Datum numeric_sortsupport(PG_FUNCTION_ARGS)
         ssup->abbrev_converter = numeric_abbrev_convert;
         ssup->abbrev_abort = numeric_abbrev_abort;
 
+        /*
+         * The abbreviated keys are signed integers in descending order:
+         * flipping all bits but the sign bit makes them unsigned ascending.
+         */
+        ssup->radix_width = SIZEOF_DATUM;
+        ssup->radix_mask = ~((Datum)1 << (SIZEOF_DATUM * BITS_PER_BYTE - 1));
+        ssup->radix_exact = false;
+
         MemoryContextSwitchTo(oldcontext);
     }
 
@@ -119,7 +119,9 @@ extern Datum pg_stat_get_status(PG_FUNCTION_ARGS);
 extern Datum pgxc_stat_get_status(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_sql_count(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_thread(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_wlm_io_throttle_info(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_env(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_column_batches(PG_FUNCTION_ARGS);
 extern Datum pg_backend_pid(PG_FUNCTION_ARGS);
 extern Datum pg_current_userid(PG_FUNCTION_ARGS);
 extern Datum pg_current_sessionid(PG_FUNCTION_ARGS);
@@ -2859,6 +2861,12 @@ Datum pg_backend_pid(PG_FUNCTION_ARGS)
     PG_RETURN_INT64(t_thrd.proc_cxt.MyProcPid);
 }
 
+/* ColumnBatch messages this session has sent, see printColumnBatch */
+Datum pg_stat_get_column_batches(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64(u_sess->libpq_cxt.column_batches_sent);
+}
+
 Datum pg_current_userid(PG_FUNCTION_ARGS)
 {
     PG_RETURN_OID(GetCurrentUserId());
@@ -4700,6 +4708,78 @@ Datum pg_stat_get_wlm_session_iostat_info(PG_FUNCTION_ARGS)
     SRF_RETURN_DONE(func_ctx);
 }
 
+/*
+ * function name: pg_stat_get_wlm_io_throttle_info
+ * description  : the view will show how long the current and the previous query
+ *                of each session have been delayed by the io token bucket of
+ *                its resource pool.
+ */
+Datum pg_stat_get_wlm_io_throttle_info(PG_FUNCTION_ARGS)
+{
+#define WLM_IO_THROTTLE_ATTRNUM 7
+    FuncCallContext* func_ctx = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        MemoryContext old_context;
+        TupleDesc tupdesc;
+        int i = 0;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(WLM_IO_THROTTLE_ATTRNUM, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "pid", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "sessionid", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "query_id", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "throttle_count", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "throttle_time", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "last_throttle_count", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)++i, "last_throttle_time", INT8OID, -1, 0);
+
+        func_ctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        /* Get all backends */
+        func_ctx->max_calls = pgstat_fetch_stat_numbackends();
+
+        MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    while (func_ctx->call_cntr < func_ctx->max_calls) {
+        Datum values[WLM_IO_THROTTLE_ATTRNUM];
+        bool nulls[WLM_IO_THROTTLE_ATTRNUM] = {false};
+        HeapTuple tuple = NULL;
+        PgBackendStatus* beentry = NULL;
+        int i = -1;
+
+        beentry = pgstat_fetch_stat_beentry(func_ctx->call_cntr + 1); /* 1-based index */
+
+        /* skip the slots without a thread and the sessions of other users */
+        if (beentry == NULL || beentry->st_procpid == 0 ||
+            (!superuser() && beentry->st_userid != GetUserId())) {
+            func_ctx->call_cntr++;
+            continue;
+        }
+
+        errno_t rc = memset_s(values, sizeof(values), 0, sizeof(values));
+        securec_check(rc, "\0", "\0");
+
+        values[++i] = Int64GetDatum(beentry->st_procpid);
+        values[++i] = Int64GetDatum(beentry->st_sessionid);
+        values[++i] = Int64GetDatum(beentry->st_queryid);
+        values[++i] = Int64GetDatum(beentry->st_io_throttle_count);
+        values[++i] = Int64GetDatum(beentry->st_io_throttle_time);
+        values[++i] = Int64GetDatum(beentry->st_last_io_throttle_count);
+        values[++i] = Int64GetDatum(beentry->st_last_io_throttle_time);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(func_ctx);
+}
+
 /*
  * function name: pg_stat_get_wlm_node_resource_info
  * description  : the view will show node resource info.
@@ -12451,6 +12531,83 @@ Datum gs_globalplancache_prepare_status(PG_FUNCTION_ARGS)
     }
 }
 
+Datum gs_globalplancache_variant_status(PG_FUNCTION_ARGS)
+{
+#ifndef ENABLE_MULTIPLE_NODES
+    DISTRIBUTED_FEATURE_NOT_SUPPORTED();
+#endif
+
+    FuncCallContext *func_ctx = NULL;
+    MemoryContext old_context;
+
+    /* stuff done only on the first call of the function */
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc;
+
+        /* create a function context for cross-call persistence */
+        func_ctx = SRF_FIRSTCALL_INIT();
+
+        /*
+         * switch to memory context appropriate for multiple function
+         * calls
+         */
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+#define GPC_VARIANT_TUPLES_ATTR_NUM 5
+
+        tup_desc = CreateTemplateTupleDesc(GPC_VARIANT_TUPLES_ATTR_NUM, false);
+
+        TupleDescInitEntry(tup_desc, (AttrNumber) 1, "nodename", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 2, "query", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 3, "variant", INT4OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 4, "signature", INT4OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 5, "hits", INT8OID, -1, 0);
+
+        /* complete descriptor of the tupledesc */
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+
+        /* total number of tuples to be returned */
+        if (ENABLE_THREAD_POOL && ENABLE_DN_GPC) {
+            func_ctx->user_fctx = (void *)GPC->GetVariantStatus(&(func_ctx->max_calls));
+        } else {
+            func_ctx->max_calls = 0;
+        }
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    /* stuff done on every call of the function */
+    func_ctx = SRF_PERCALL_SETUP();
+    GPCVariantStatus *entry = (GPCVariantStatus *)func_ctx->user_fctx;
+
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        /* do when there is more left to send */
+        Datum values[GPC_VARIANT_TUPLES_ATTR_NUM];
+        bool nulls[GPC_VARIANT_TUPLES_ATTR_NUM];
+        HeapTuple tuple;
+
+        errno_t rc = 0;
+        rc = memset_s(values, sizeof(values), 0, sizeof(values));
+        securec_check(rc, "\0", "\0");
+        rc = memset_s(nulls, sizeof(nulls), 0, sizeof(nulls));
+        securec_check(rc, "\0", "\0");
+
+        entry += func_ctx->call_cntr;
+
+        values[0] = CStringGetTextDatum(g_instance.attr.attr_common.PGXCNodeName);
+        values[1] = CStringGetTextDatum(entry->query);
+        values[2] = Int32GetDatum(entry->variant);
+        values[3] = Int32GetDatum((int32)entry->signature);
+        values[4] = Int64GetDatum(entry->hits);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        /* do when there is no more left */
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
 Datum local_rto_stat(PG_FUNCTION_ARGS)
 {
     TupleDesc tup_desc = NULL;
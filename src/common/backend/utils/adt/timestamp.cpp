@@ -2112,6 +2112,12 @@ Datum timestamp_sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = timestamp_fastcmp;
+    ssup->comparator_threadsafe = true;
+#ifdef HAVE_INT64_TIMESTAMP
+    ssup->radix_width = sizeof(Timestamp);
+    ssup->radix_mask = UINT64CONST(0x8000000000000000);
+    ssup->radix_exact = true;
+#endif
     PG_RETURN_VOID();
 }
 
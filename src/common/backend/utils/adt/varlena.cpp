@@ -2124,6 +2124,10 @@ void varstr_sortsupport(SortSupport ssup, Oid collid, bool bpchar)
             ssup->comparator = varstrcmp_abbrev;
             ssup->abbrev_converter = varstr_abbrev_convert;
             ssup->abbrev_abort = varstr_abbrev_abort;
+            /* abbreviated keys compare as unsigned integers */
+            ssup->radix_width = SIZEOF_DATUM;
+            ssup->radix_mask = 0;
+            ssup->radix_exact = false;
         }
     }
 }
@@ -4850,6 +4854,45 @@ Datum pg_column_size(PG_FUNCTION_ARGS)
     PG_RETURN_INT32(result);
 }
 
+/*
+ * Return the compression method of a datum, NULL if it is not compressed
+ *
+ * Works on any data type
+ */
+Datum pg_column_compression(PG_FUNCTION_ARGS)
+{
+    int typlen;
+    int cmethod;
+
+    /* On first call, get the input type's typlen, and save at *fn_extra */
+    if (fcinfo->flinfo->fn_extra == NULL) {
+        /* Lookup the datatype of the supplied argument */
+        Oid argtypeid = get_fn_expr_argtype(fcinfo->flinfo, 0);
+
+        typlen = get_typlen(argtypeid);
+        if (typlen == 0) {  /* should not happen */
+            ereport(
+                ERROR, (errcode(ERRCODE_CACHE_LOOKUP_FAILED), errmsg("cache lookup failed for type %u", argtypeid)));
+        }
+        fcinfo->flinfo->fn_extra = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(int));
+        *((int*)fcinfo->flinfo->fn_extra) = typlen;
+    } else {
+        typlen = *((int*)fcinfo->flinfo->fn_extra);
+    }
+
+    /* only varlena types can be compressed */
+    if (typlen != -1) {
+        PG_RETURN_NULL();
+    }
+
+    cmethod = toast_get_compression_id((struct varlena*)DatumGetPointer(PG_GETARG_DATUM(0)));
+    if (cmethod == TOAST_INVALID_COMPRESSION_ID) {
+        PG_RETURN_NULL();
+    }
+
+    PG_RETURN_TEXT_P(cstring_to_text(toast_compression_id_to_name(cmethod)));
+}
+
 /*
  * @Description: This function is used to calculate the size of a datum
  *
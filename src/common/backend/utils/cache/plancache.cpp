@@ -231,6 +231,7 @@ CachedPlanSource* CreateCachedPlan(Node* rawParseTree, const char* queryString,
     planSource->gpc.is_valid = true;
     planSource->gpc.query_hash_code = 0;
     planSource->gpc.env = NULL;
+    planSource->gpc.variants = NULL;
     planSource->gpc.refcount = 1;
     planSource->gpc.in_revalidate = false;
 
@@ -1286,6 +1287,36 @@ static double CachedPlanCost(CachedPlan* plan)
     return result;
 }
 
+/*
+ * GPCChooseVariantPlan: pick the plan of a shared CachedPlanSource for the
+ * given parameter values, building and sharing a new variant if needed.
+ *
+ * The variant is planned with the values as estimates only (no
+ * PARAM_FLAG_CONST), so it stays usable for the other values that fall in
+ * the same selectivity buckets.
+ */
+static CachedPlan* GPCChooseVariantPlan(CachedPlanSource* planSource, ParamListInfo boundParams)
+{
+    uint32 signature = GPC->VariantSignature(planSource, boundParams);
+    CachedPlan* plan = GPC->VariantFetch(planSource, signature);
+
+    if (plan == NULL) {
+        ParamListInfo estimateParams = copyParamList(boundParams);
+        CachedPlan* localPlan = NULL;
+
+        for (int i = 0; i < estimateParams->numParams; i++) {
+            estimateParams->params[i].pflags &= ~PARAM_FLAG_CONST;
+        }
+
+        localPlan = BuildCachedPlan(planSource, NIL, estimateParams);
+        plan = GPC->VariantStore(planSource, signature, localPlan);
+        MemoryContextDelete(localPlan->context);
+    }
+
+    Assert(plan->magic == CACHEDPLAN_MAGIC);
+    return plan;
+}
+
 /*
  * GetCachedPlan: get a cached plan from a CachedPlanSource.
  *
@@ -1330,6 +1361,11 @@ CachedPlan* GetCachedPlan(CachedPlanSource* planSource, ParamListInfo boundParam
             plan = planSource->gplan;
             Assert(plan->magic == CACHEDPLAN_MAGIC);
 
+            /* A shared plan source may have a better plan for these values */
+            if (ENABLE_DN_GPC && planSource->gpc.is_share == true) {
+                plan = GPCChooseVariantPlan(planSource, boundParams);
+            }
+
             /* Update soft parse counter for Unique SQL */
             UniqueSQLStatCountSoftParse(1);
         } else {
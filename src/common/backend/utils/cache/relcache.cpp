@@ -131,6 +131,7 @@
 #include "rewrite/rewriteDefine.h"
 #include "rewrite/rewriteRlsPolicy.h"
 #include "storage/lmgr.h"
+#include "storage/page_compression.h"
 #include "storage/smgr.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
@@ -3879,8 +3880,11 @@ void RelationSetNewRelfilenode(Relation relation, TransactionId freezeXid, bool
     newrnode.node = relation->rd_node;
     newrnode.node.relNode = newrelfilenode;
     newrnode.backend = relation->rd_backend;
-    RelationCreateStorage(
-        newrnode.node, relation->rd_rel->relpersistence, relation->rd_rel->relowner, relation->rd_bucketoid);
+    RelationCreateStorage(newrnode.node,
+        relation->rd_rel->relpersistence,
+        relation->rd_rel->relowner,
+        relation->rd_bucketoid,
+        RelationGetPageCompressOpt(relation));
     smgrclosenode(newrnode);
 
     /*
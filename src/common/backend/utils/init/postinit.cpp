@@ -1278,6 +1278,36 @@ void PostgresInitializer::InitAutoVacWorker()
     AuditUserLogin();
 }
 
+void PostgresInitializer::InitVacuumIndexWorker()
+{
+    InitThread();
+
+    InitSysCache();
+
+    /* Initialize stats collection --- must happen before first xact */
+    pgstat_initialize();
+
+    SetProcessExitCallback();
+
+    StartXact();
+
+    SetSuperUserStandalone();
+
+    CheckConnPermission();
+
+    SetDatabase();
+
+    LoadSysCache();
+
+    CheckDatabaseAuth();
+
+    InitPGXCPort();
+
+    InitSettings();
+
+    FinishInit();
+}
+
 void PostgresInitializer::InitCatchupWorker()
 {
     InitThread();
@@ -28,12 +28,14 @@
 #endif
 
 #include "access/cbmparsexlog.h"
+#include "access/double_write_basic.h"
 #include "access/gin.h"
 #ifdef PGXC
 #include "access/gtm.h"
 #include "pgxc/pgxc.h"
 #endif
 #include "access/transam.h"
+#include "access/tuptoaster.h"
 #include "access/twophase.h"
 #include "access/xact.h"
 #include "access/xlog.h"
@@ -253,6 +255,7 @@ const char* sync_guc_variable_namelist[] = {"work_mem",
     "wdr_snapshot_query_timeout",
     "track_counts",
     "track_io_timing",
+    "track_lwlock_timing",
     "track_functions",
     "update_process_title",
     "log_statement_stats",
@@ -324,6 +327,7 @@ const char* sync_guc_variable_namelist[] = {"work_mem",
     "enable_codegen_print",
     "codegen_cost_threshold",
     "codegen_strategy",
+    "plpgsql_codegen_threshold",
     "max_query_retry_times",
     "convert_string_to_digit",
 #ifdef ENABLE_MULTIPLE_NODES
@@ -334,6 +338,7 @@ const char* sync_guc_variable_namelist[] = {"work_mem",
     "max_loaded_cudesc",
     "partition_mem_batch",
     "partition_max_cache_size",
+    "default_toast_compression",
     "memory_tracking_mode",
     "enable_early_free",
     "cstore_backwrite_quantity",
@@ -412,6 +417,7 @@ static void assign_syslog_ident(const char* newval, void* extra);
 static void assign_session_replication_role(int newval, void* extra);
 static bool check_client_min_messages(int* newval, void** extra, GucSource source);
 static bool check_temp_buffers(int* newval, void** extra, GucSource source);
+static bool check_shared_buffers_huge_page_size(int* newval, void** extra, GucSource source);
 static bool check_fencedUDFMemoryLimit(int* newval, void** extra, GucSource source);
 static bool check_udf_memory_limit(int* newval, void** extra, GucSource source);
 static bool check_phony_autocommit(bool* newval, void** extra, GucSource source);
@@ -919,6 +925,29 @@ static const struct config_enum_entry opfusion_debug_level_options[] = {
 static const struct config_enum_entry unique_sql_track_option[] = {
     {"top", UNIQUE_SQL_TRACK_TOP, false}, {"all", UNIQUE_SQL_TRACK_ALL, true}, {NULL, 0, false}};
 
+/*
+ * Although only "on", "off", and "try" are documented, we accept all the
+ * likely variants of "on" and "off".
+ */
+static const struct config_enum_entry shared_buffers_huge_pages_options[] = {{"off", BUFFER_HUGE_PAGES_OFF, false},
+    {"on", BUFFER_HUGE_PAGES_ON, false},
+    {"try", BUFFER_HUGE_PAGES_TRY, false},
+    {"true", BUFFER_HUGE_PAGES_ON, true},
+    {"false", BUFFER_HUGE_PAGES_OFF, true},
+    {"yes", BUFFER_HUGE_PAGES_ON, true},
+    {"no", BUFFER_HUGE_PAGES_OFF, true},
+    {"1", BUFFER_HUGE_PAGES_ON, true},
+    {"0", BUFFER_HUGE_PAGES_OFF, true},
+    {NULL, 0, false}};
+
+static const struct config_enum_entry buffer_replacement_policy_options[] = {
+    {"clock", BUFFER_REPLACEMENT_CLOCK, false}, {"2q", BUFFER_REPLACEMENT_2Q, false}, {NULL, 0, false}};
+
+static const struct config_enum_entry torn_page_protection_options[] = {
+    {"double_write", TORN_PAGE_DOUBLE_WRITE, false}, {"page_image", TORN_PAGE_PAGE_IMAGE, false}, {NULL, 0, false}};
+static const struct config_enum_entry default_toast_compression_options[] = {
+    {"pglz", TOAST_PGLZ_COMPRESSION_ID, false}, {"lz4", TOAST_LZ4_COMPRESSION_ID, false}, {NULL, 0, false}};
+
 /*
  * Options for enum values stored in other modules
  */
@@ -1524,6 +1553,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_radix_sort",
+                PGC_USERSET,
+                QUERY_TUNING_METHOD,
+                gettext_noop("Enables radix sorting of in-memory sorts on integer-like leading keys."),
+                NULL
+            },
+            &u_sess->attr.attr_sql.enable_radix_sort,
+            true,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "enable_compress_spill",
@@ -2086,6 +2129,22 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "thread_pool_defer_commit_ack",
+                PGC_USERSET,
+                WAL_SETTINGS,
+                gettext_noop("Lets thread pool workers serve other sessions while a commit waits for WAL flush."),
+                gettext_noop("The committing session is parked in the thread pool listener until its "
+                    "commit record is flushed and, if required, confirmed by synchronous standbys. "
+                    "Other sessions may see the transaction before it is durable.")
+            },
+            &u_sess->attr.attr_storage.thread_pool_defer_commit_ack,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "wal_log_hints",
@@ -2544,6 +2603,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "track_lwlock_timing",
+                PGC_SUSET,
+                STATS_COLLECTOR,
+                gettext_noop("Collects wait and hold time histograms of lightweight locks per tranche."),
+                NULL
+            },
+            &u_sess->attr.attr_common.track_lwlock_timing,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "update_process_title",
@@ -2847,6 +2920,23 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "columnar_result_transfer",
+                PGC_BACKEND,
+                CLIENT_CONN_STATEMENT,
+                gettext_noop("Sends results of vectorized plans to the client in column batches."),
+                gettext_noop("Only for clients that understand ColumnBatch messages, so it can only be "
+                             "set in the startup packet; libpq asks for it with the columnar_result "
+                             "connection option."),
+                GUC_NOT_IN_SAMPLE | GUC_DISALLOW_IN_FILE
+            },
+            &u_sess->attr.attr_sql.columnar_result_transfer,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "array_nulls",
@@ -4102,6 +4192,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_cardinality_feedback",
+                PGC_USERSET,
+                QUERY_TUNING_OTHER,
+                gettext_noop("Corrects row estimates of table scans with the rows earlier executions returned."),
+                NULL
+            },
+            &u_sess->attr.attr_sql.enable_cardinality_feedback,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "td_compatible_truncation",
@@ -4347,6 +4451,22 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_io_token_bucket",
+                PGC_SIGHUP,
+                RESOURCES_WORKLOAD,
+                gettext_noop("Limits the block IO of resource pools with token buckets."),
+                gettext_noop("Each resource pool with iops_limits may read or write that many blocks "
+                             "per second. Scans using a bulk strategy, temp files, column store CUs and "
+                             "relation copies wait for tokens, other reads only use them up.")
+            },
+            &u_sess->attr.attr_resource.enable_io_token_bucket,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "enable_access_server_directory",
@@ -4768,6 +4888,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "sort_parallel_workers",
+                PGC_USERSET,
+                QUERY_TUNING_OTHER,
+                gettext_noop("Sets the maximum number of threads used to sort the tuples of an in-memory sort."),
+                gettext_noop("Zero or one disables parallel in-memory sorting.")
+            },
+            &u_sess->attr.attr_sql.sort_parallel_workers,
+            0,
+            0,
+            32,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "wait_dummy_time",
@@ -5093,6 +5229,23 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "shared_buffers_huge_page_size",
+                PGC_POSTMASTER,
+                RESOURCES_MEM,
+                gettext_noop("Sets the size of the huge pages backing shared buffers."),
+                gettext_noop("0 means the default huge page size of the system."),
+                GUC_UNIT_KB
+            },
+            &g_instance.attr.attr_storage.shared_buffers_huge_page_size,
+            0,
+            0,
+            1024 * 1024,
+            check_shared_buffers_huge_page_size,
+            NULL,
+            NULL
+        },
         {
             {
                 "hashagg_table_size",
@@ -5802,6 +5955,24 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "toast_cache_size",
+                PGC_SIGHUP,
+                RESOURCES_MEM,
+                gettext_noop("Sets the size of the shared cache of detoasted values."),
+                gettext_noop("Large out-of-line values read again are served from the cache instead of "
+                    "being fetched and decompressed again. 0 disables the cache."),
+                GUC_UNIT_KB
+            },
+            &u_sess->attr.attr_storage.toast_cache_size,
+            65536,
+            0,
+            INT_MAX / 2,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "walsender_max_send_size",
@@ -5940,6 +6111,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "vacuum_index_parallel_workers",
+                PGC_USERSET,
+                RESOURCES_ASYNCHRONOUS,
+                gettext_noop("Sets the maximum number of worker threads vacuuming the indexes of one table."),
+                gettext_noop("Zero disables parallel index vacuuming.")
+            },
+            &u_sess->attr.attr_storage.vacuum_index_parallel_workers,
+            0,
+            0,
+            32,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "vacuum_cost_delay",
@@ -6645,7 +6832,8 @@ static void init_configure_names_int()
                 gettext_noop("Sets the number of digits displayed for floating-point values."),
                 gettext_noop("This affects real, double precision, and geometric data types. "
                     "The parameter value is added to the standard number of digits "
-                    "(FLT_DIG or DBL_DIG as appropriate).")
+                    "(FLT_DIG or DBL_DIG as appropriate)."),
+                GUC_REPORT
             },
             &u_sess->attr.attr_common.extra_float_digits,
             0,
@@ -8662,6 +8850,26 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        /*
+         * number of interpreted calls after which a PL/pgSQL function is
+         * compiled by LLVM, -1 never compiles.
+         */
+        {
+            {
+                "plpgsql_codegen_threshold",
+                PGC_USERSET,
+                QUERY_TUNING_COST,
+                gettext_noop("Sets the number of calls after which a PL/pgSQL function is compiled by LLVM."),
+                gettext_noop("-1 disables the compilation, 0 compiles the function after its first call.")
+            },
+            &u_sess->attr.attr_sql.plpgsql_codegen_threshold,
+            1000,
+            -1,
+            INT_MAX,
+            NULL,
+            NULL,
+            NULL
+        },
 #ifdef ENABLE_MULTIPLE_NODES
         {
             {
@@ -11517,6 +11725,67 @@ static void init_configure_names_enum()
             NULL,
             NULL
         },
+        {
+            {
+                "shared_buffers_huge_pages",
+                PGC_POSTMASTER,
+                RESOURCES_MEM,
+                gettext_noop("Use of huge pages for shared buffers."),
+                NULL
+            },
+            &g_instance.attr.attr_storage.shared_buffers_huge_pages,
+            BUFFER_HUGE_PAGES_OFF,
+            shared_buffers_huge_pages_options,
+            NULL,
+            NULL,
+            NULL
+        },
+        {
+            {
+                "buffer_replacement_policy",
+                PGC_POSTMASTER,
+                RESOURCES_MEM,
+                gettext_noop("Selects the replacement policy of shared buffers."),
+                gettext_noop("2q keeps pages read only once from evicting pages that are used repeatedly.")
+            },
+            &g_instance.attr.attr_storage.buffer_replacement_policy,
+            BUFFER_REPLACEMENT_CLOCK,
+            buffer_replacement_policy_options,
+            NULL,
+            NULL,
+            NULL
+        },
+        {
+            {
+                "torn_page_protection",
+                PGC_POSTMASTER,
+                WAL_CHECKPOINTS,
+                gettext_noop("Selects how pages are protected from partial writes when double write is enabled."),
+                gettext_noop("double_write copies every flushed page to the double write file, page_image only the "
+                             "first flush of a page after each checkpoint.")
+            },
+            &g_instance.attr.attr_storage.torn_page_protection,
+            TORN_PAGE_DOUBLE_WRITE,
+            torn_page_protection_options,
+            NULL,
+            NULL,
+            NULL
+        },
+        {
+            {
+                "default_toast_compression",
+                PGC_USERSET,
+                CLIENT_CONN_STATEMENT,
+                gettext_noop("Sets the default compression method for compressible values."),
+                gettext_noop("Used for the columns without a toast_compression option.")
+            },
+            &u_sess->attr.attr_storage.default_toast_compression,
+            TOAST_PGLZ_COMPRESSION_ID,
+            default_toast_compression_options,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "wal_level",
@@ -17877,6 +18146,18 @@ static bool check_temp_buffers(int* newval, void** extra, GucSource source)
     return true;
 }
 
+static bool check_shared_buffers_huge_page_size(int* newval, void** extra, GucSource source)
+{
+    /* huge pages come in power-of-two sizes, each a multiple of the block size */
+    if (*newval != 0 && ((*newval & (*newval - 1)) != 0 || (Size)*newval * 1024 < BLCKSZ)) {
+        GUC_check_errdetail("\"shared_buffers_huge_page_size\" must be 0 or a power of two of at least %d kB.",
+            BLCKSZ / 1024);
+        return false;
+    }
+
+    return true;
+}
+
 static bool check_fencedUDFMemoryLimit(int* newval, void** extra, GucSource source)
 {
     if (*newval > g_instance.attr.attr_sql.UDFWorkerMemHardLimit) {
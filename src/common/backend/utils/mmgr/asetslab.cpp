@@ -0,0 +1,646 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * asetslab.cpp
+ *    Slab allocator for objects of one fixed size.
+ *
+ * A slab context carves chunks of a single size out of blocks of a single
+ * size.  Every block keeps a bitmap of its free chunks, so allocation is a
+ * find-first-set over the bitmap of the first block having free space and
+ * freeing is a single bit flip.  Unlike the generic allocator, a block whose
+ * chunks have all been freed is given back to the system at once, so a
+ * long-lived context holding objects that come and go in waves (hash join
+ * chunks, reorder buffer changes) does not stay at its high-water mark.
+ *
+ * Every chunk is still preceded by a StandardChunkHeader, so pfree(),
+ * GetMemoryChunkSpace() and GetMemoryChunkContext() work unchanged.
+ *
+ * IDENTIFICATION
+ *    src/common/backend/utils/mmgr/asetslab.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "utils/memutils.h"
+#include "utils/aset.h"
+#include "gs_register/gs_malloc.h"
+#include "pgstat.h"
+#include "miscadmin.h"
+#include "utils/memprot.h"
+#include "utils/memtrack.h"
+
+typedef SlabSetContext* SlabSet;
+
+extern void MemoryContextControlSet(AllocSet context, const char* name);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+const uint32 SlabBlkMagicNum = 0xDBDBDBDB;
+#endif
+
+#define SLAB_BITMAP_WORD_BITS 64
+
+/*
+ * SlabBlockData is the header of a block obtained from malloc().  The chunks
+ * start at blockHeaderSize; bit i of freemap is set while chunk i is free.
+ */
+typedef struct SlabBlockData {
+    SlabSet slab;         /* slab that owns this block */
+    SlabBlock prev;       /* prev block in slab's blocks list */
+    SlabBlock next;       /* next block in slab's blocks list */
+    SlabBlock prevFree;   /* prev block in slab's freeBlocks list */
+    SlabBlock nextFree;   /* next block in slab's freeBlocks list */
+    int nfree;            /* number of free chunks in this block */
+    bool onFreeList;      /* is this block linked into freeBlocks? */
+#ifdef MEMORY_CONTEXT_CHECKING
+    uint32 magicNum; /* DBDB */
+#endif
+    uint64 freemap[FLEXIBLE_ARRAY_MEMBER]; /* free chunk bitmap */
+} SlabBlockData;
+
+/*
+ * Each chunk starts with a back pointer to its block, followed by the
+ * standard chunk header which must end exactly where the user data begins.
+ */
+#define SLAB_BLOCKPTRSZ MAXALIGN(sizeof(SlabBlock))
+#define SLAB_CHUNKHDRSZ (SLAB_BLOCKPTRSZ + STANDARDCHUNKHEADERSIZE)
+
+#define SlabPointerGetHeader(ptr) ((StandardChunkHeader*)(((char*)(ptr)) - STANDARDCHUNKHEADERSIZE))
+#define SlabPointerGetBlock(ptr) (*(SlabBlock*)(((char*)(ptr)) - SLAB_CHUNKHDRSZ))
+#define SlabBlockGetChunk(slab, block, idx) \
+    (((char*)(block)) + (slab)->blockHeaderSize + (Size)(idx) * (slab)->fullChunkSize)
+#define SlabChunkGetPointer(chk) ((void*)(((char*)(chk)) + SLAB_CHUNKHDRSZ))
+#define SlabBitmapWords(nchunks) (((nchunks) + SLAB_BITMAP_WORD_BITS - 1) / SLAB_BITMAP_WORD_BITS)
+#define SlabBlockHeaderSize(nchunks) \
+    MAXALIGN(offsetof(SlabBlockData, freemap) + SlabBitmapWords(nchunks) * sizeof(uint64))
+
+#define SlabIsValid(set) PointerIsValid(set)
+
+/*
+ * AllocSetMethodDefinition
+ *      Define the method functions based on the templated value
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+void SlabMemoryAllocator::AllocSetMethodDefinition(MemoryContextMethods* method)
+{
+    method->alloc = &SlabMemoryAllocator::AllocSetAlloc<enable_memoryprotect, is_tracked>;
+    method->free_p = &SlabMemoryAllocator::AllocSetFree<enable_memoryprotect, is_tracked>;
+    method->realloc = &SlabMemoryAllocator::AllocSetRealloc;
+    method->init = &SlabMemoryAllocator::AllocSetInit;
+    method->reset = &SlabMemoryAllocator::AllocSetReset<enable_memoryprotect, is_tracked>;
+    method->delete_context = &SlabMemoryAllocator::AllocSetDelete<enable_memoryprotect, is_tracked>;
+    method->get_chunk_space = &SlabMemoryAllocator::AllocSetGetChunkSpace;
+    method->is_empty = &SlabMemoryAllocator::AllocSetIsEmpty;
+    method->stats = &SlabMemoryAllocator::AllocSetStats;
+#ifdef MEMORY_CONTEXT_CHECKING
+    method->check = &SlabMemoryAllocator::AllocSetCheck;
+#endif
+}
+
+/*
+ * AllocSetContextSetMethods
+ *		set the method functions
+ */
+void SlabMemoryAllocator::AllocSetContextSetMethods(unsigned long value, MemoryContextMethods* method)
+{
+    bool isProt = (value & IS_PROTECT) ? true : false;
+    bool isTracked = (value & IS_TRACKED) ? true : false;
+
+    if (isProt) {
+        if (isTracked)
+            AllocSetMethodDefinition<true, true>(method);
+        else
+            AllocSetMethodDefinition<true, false>(method);
+    } else {
+        if (isTracked)
+            AllocSetMethodDefinition<false, true>(method);
+        else
+            AllocSetMethodDefinition<false, false>(method);
+    }
+}
+
+/*
+ * SlabContextCreate
+ *		Create a new slab context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * blockSize: allocation block size
+ * chunkSize: size of every chunk allocated from the context
+ */
+MemoryContext SlabMemoryAllocator::SlabContextCreate(
+    MemoryContext parent, const char* name, Size blockSize, Size chunkSize)
+{
+    SlabSet context = NULL;
+    bool isTracked = false;
+    unsigned long value = t_thrd.utils_cxt.gs_mp_inited ? IS_PROTECT : 0;
+    Size fullChunkSize;
+    Size nchunks;
+
+    /* only track the memory context after t_thrd.mem_cxt.mem_track_mem_cxt is created */
+    if (parent && parent->session_id == 0 && u_sess->attr.attr_memory.memory_tracking_mode &&
+        t_thrd.mem_cxt.mem_track_mem_cxt &&
+        (t_thrd.utils_cxt.ExecutorMemoryTrack == NULL || ((AllocSet)parent)->track)) {
+        isTracked = true;
+        value |= IS_TRACKED;
+    }
+
+    /* Make sure the block can hold at least one chunk, and work out how many */
+    fullChunkSize = SLAB_CHUNKHDRSZ + MAXALIGN(chunkSize);
+    blockSize = MAXALIGN(blockSize);
+    if (blockSize < SlabBlockHeaderSize(1) + fullChunkSize) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("block size %lu for slab \"%s\" is too small for %lu-byte chunks",
+                    (unsigned long)blockSize,
+                    name,
+                    (unsigned long)chunkSize)));
+    }
+
+    nchunks = (blockSize - SlabBlockHeaderSize(1)) / fullChunkSize;
+    while (SlabBlockHeaderSize(nchunks) + nchunks * fullChunkSize > blockSize)
+        nchunks--;
+
+    // Do the type-independent part of context creation
+    //
+    context = (SlabSet)MemoryContextCreate(
+        T_SlabAllocSetContext, sizeof(SlabSetContext), parent, name, __FILE__, __LINE__);
+
+    context->maxSpaceSize = DEFAULT_MEMORY_CONTEXT_MAX_SIZE + SELF_GENRIC_MEMCTX_LIMITATION;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    MemoryContextControlSet((AllocSet)context, name);
+#endif
+
+    /* assign the method function with specified templated to the context */
+    AllocSetContextSetMethods(value, ((MemoryContext)context)->methods);
+
+    context->initBlockSize = blockSize;
+    context->maxBlockSize = blockSize;
+    context->nextBlockSize = blockSize;
+    context->allocChunkLimit = chunkSize;
+    context->keeper = NULL;
+    context->fullChunkSize = fullChunkSize;
+    context->blockHeaderSize = SlabBlockHeaderSize(nchunks);
+    context->chunksPerBlock = (int)nchunks;
+    context->nblocks = 0;
+    context->blocks = NULL;
+    context->freeBlocks = NULL;
+
+    // create the memory tracking structure
+    if (isTracked)
+        MemoryTrackingCreate((MemoryContext)context, parent);
+
+    return (MemoryContext)context;
+}
+
+/*
+ * SlabFreeListRemove / SlabFreeListPush
+ *		Maintain the list of blocks that have at least one free chunk.
+ */
+static inline void SlabFreeListRemove(SlabSet set, SlabBlock block)
+{
+    if (block->prevFree)
+        block->prevFree->nextFree = block->nextFree;
+    else
+        set->freeBlocks = block->nextFree;
+    if (block->nextFree)
+        block->nextFree->prevFree = block->prevFree;
+    block->prevFree = NULL;
+    block->nextFree = NULL;
+    block->onFreeList = false;
+}
+
+static inline void SlabFreeListPush(SlabSet set, SlabBlock block)
+{
+    block->prevFree = NULL;
+    block->nextFree = set->freeBlocks;
+    if (set->freeBlocks)
+        set->freeBlocks->prevFree = block;
+    set->freeBlocks = block;
+    block->onFreeList = true;
+}
+
+/*
+ * SlabReleaseBlock
+ *		Unlink a block from the slab and give it back to the system.
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+static void SlabReleaseBlock(SlabSet set, SlabBlock block)
+{
+    MemoryProtectFuncDef* func = NULL;
+    Size blksize = set->initBlockSize;
+
+    if (set->header.session_id > 0)
+        func = &SessionFunctions;
+    else
+        func = &GenericFunctions;
+
+    if (block->onFreeList)
+        SlabFreeListRemove(set, block);
+
+    if (block->prev)
+        block->prev->next = block->next;
+    else
+        set->blocks = block->next;
+    if (block->next)
+        block->next->prev = block->prev;
+
+    set->totalSpace -= blksize;
+    set->freeSpace -= (Size)block->nfree * set->fullChunkSize;
+    set->nblocks--;
+
+    block->slab = NULL;
+
+    if (is_tracked)
+        MemoryTrackingFreeInfo((MemoryContext)set, blksize);
+
+    if (enable_memoryprotect)
+        (*func->free)(block, blksize);
+    else
+        gs_free(block, blksize);
+}
+
+/*
+ * AllocSetAlloc
+ *		Returns pointer to a free chunk of the slab; a new block is obtained
+ *		from the system when no block has a free chunk left.
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+void* SlabMemoryAllocator::AllocSetAlloc(MemoryContext context, Size align, Size size, const char* file, int line)
+{
+    SlabSet set = (SlabSet)context;
+    SlabBlock block;
+    StandardChunkHeader* header = NULL;
+    char* chunk = NULL;
+    int idx;
+    int word;
+    MemoryProtectFuncDef* func = NULL;
+
+    AssertArg(SlabIsValid(set));
+    AssertArg(align == 0);
+
+    if (size > set->allocChunkLimit) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("unexpected alloc chunk size %lu (expected at most %lu) in slab \"%s\"",
+                    (unsigned long)size,
+                    (unsigned long)set->allocChunkLimit,
+                    context->name)));
+    }
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    /* memory enjection */
+    if (gs_memory_enjection())
+        return NULL;
+#endif
+
+    block = set->freeBlocks;
+    if (block == NULL) {
+        Size blksize = set->initBlockSize;
+        int nwords = SlabBitmapWords(set->chunksPerBlock);
+
+        if (context->session_id > 0)
+            func = &SessionFunctions;
+        else
+            func = &GenericFunctions;
+
+        if (enable_memoryprotect)
+            block = (SlabBlock)(*func->malloc)(blksize);
+        else
+            gs_malloc(blksize, block, SlabBlock);
+
+        if (block == NULL)
+            return NULL;
+
+        block->slab = set;
+        block->nfree = set->chunksPerBlock;
+        block->onFreeList = false;
+#ifdef MEMORY_CONTEXT_CHECKING
+        block->magicNum = SlabBlkMagicNum;
+#endif
+        /* all chunks start out free; clear the bits past the last chunk */
+        for (word = 0; word < nwords; word++)
+            block->freemap[word] = ~UINT64CONST(0);
+        if (set->chunksPerBlock % SLAB_BITMAP_WORD_BITS != 0)
+            block->freemap[nwords - 1] = (UINT64CONST(1) << (set->chunksPerBlock % SLAB_BITMAP_WORD_BITS)) - 1;
+
+        block->prev = NULL;
+        block->next = set->blocks;
+        if (set->blocks)
+            set->blocks->prev = block;
+        set->blocks = block;
+        SlabFreeListPush(set, block);
+
+        set->nblocks++;
+        set->totalSpace += blksize;
+        set->freeSpace += (Size)set->chunksPerBlock * set->fullChunkSize;
+
+        /* update the memory tracking information when allocating memory */
+        if (is_tracked)
+            MemoryTrackingAllocInfo(context, blksize);
+    }
+
+    /* take the lowest free chunk of the block */
+    word = 0;
+    while (block->freemap[word] == 0)
+        word++;
+    idx = word * SLAB_BITMAP_WORD_BITS + __builtin_ctzll(block->freemap[word]);
+    Assert(idx < set->chunksPerBlock);
+    block->freemap[word] &= ~(UINT64CONST(1) << (idx % SLAB_BITMAP_WORD_BITS));
+
+    /* a full block leaves the free list until one of its chunks comes back */
+    if (--block->nfree == 0)
+        SlabFreeListRemove(set, block);
+
+    set->freeSpace -= set->fullChunkSize;
+
+    chunk = SlabBlockGetChunk(set, block, idx);
+    *(SlabBlock*)chunk = block;
+    header = (StandardChunkHeader*)(chunk + SLAB_BLOCKPTRSZ);
+    header->context = context;
+    header->size = MAXALIGN(set->allocChunkLimit);
+#ifdef MEMORY_CONTEXT_CHECKING
+    header->requested_size = size;
+    header->file = file;
+    header->line = line;
+
+    /* track the detail allocation information */
+    MemoryTrackingDetailInfo(context, size, header->size, file, line);
+#endif
+
+    return SlabChunkGetPointer(chunk);
+}
+
+/*
+ * AllocSetFree
+ *		Marks the chunk free; the whole block is released once every chunk
+ *		in it is free, unless it is the only block with free space left.
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+void SlabMemoryAllocator::AllocSetFree(MemoryContext context, void* pointer)
+{
+    SlabSet set = (SlabSet)context;
+    SlabBlock block = SlabPointerGetBlock(pointer);
+    int idx;
+
+    AssertArg(SlabIsValid(set));
+
+    if (block == NULL || block->slab != set) {
+        ereport(ERROR,
+            (errcode(ERRCODE_OPERATE_RESULT_NOT_EXPECTED),
+                errmsg("%s Memory Context could not find block containing chunk", context->name)));
+    }
+
+    idx = (int)(((char*)pointer - SLAB_CHUNKHDRSZ - ((char*)block + set->blockHeaderSize)) / set->fullChunkSize);
+    Assert(idx >= 0 && idx < set->chunksPerBlock);
+    Assert((block->freemap[idx / SLAB_BITMAP_WORD_BITS] & (UINT64CONST(1) << (idx % SLAB_BITMAP_WORD_BITS))) == 0);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    SlabPointerGetHeader(pointer)->requested_size = 0;
+    /* Wipe freed memory for debugging purposes */
+    errno_t rc = memset_s(pointer, set->fullChunkSize - SLAB_CHUNKHDRSZ, 0x7F, set->fullChunkSize - SLAB_CHUNKHDRSZ);
+    securec_check(rc, "\0", "\0");
+#endif
+
+    block->freemap[idx / SLAB_BITMAP_WORD_BITS] |= (UINT64CONST(1) << (idx % SLAB_BITMAP_WORD_BITS));
+    block->nfree++;
+    set->freeSpace += set->fullChunkSize;
+
+    if (block->nfree == set->chunksPerBlock && set->freeBlocks != NULL &&
+        (set->freeBlocks != block || block->nextFree != NULL)) {
+        /*
+         * The block is empty and some other block can serve the next
+         * allocation, so hand this one back to the system right away.
+         */
+        SlabReleaseBlock<enable_memoryprotect, is_tracked>(set, block);
+    } else if (!block->onFreeList) {
+        SlabFreeListPush(set, block);
+    }
+}
+
+/*
+ * AllocSetRealloc
+ *		All chunks of a slab have the same size, so a request that still fits
+ *		keeps the chunk and anything larger is an error.
+ */
+void* SlabMemoryAllocator::AllocSetRealloc(
+    MemoryContext context, void* pointer, Size align, Size size, const char* file, int line)
+{
+    SlabSet set = (SlabSet)context;
+
+    AssertArg(align == 0);
+
+    if (size > set->allocChunkLimit) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_OPERATION),
+                errmsg("unsupport to enlarge memory under slab memory allocator \"%s\"", context->name)));
+    }
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    SlabPointerGetHeader(pointer)->requested_size = size;
+    SlabPointerGetHeader(pointer)->file = file;
+    SlabPointerGetHeader(pointer)->line = line;
+#endif
+
+    return pointer;
+}
+
+void SlabMemoryAllocator::AllocSetInit(MemoryContext context)
+{
+    //
+    // we don't
+    // have to do anything here: it's already OK.
+    //
+}
+
+/*
+ * AllocSetReset
+ *		Frees all memory which is allocated in the given slab.
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+void SlabMemoryAllocator::AllocSetReset(MemoryContext context)
+{
+    SlabSet set = (SlabSet)context;
+    SlabBlock block = set->blocks;
+    MemoryProtectFuncDef* func = NULL;
+
+    if (context->session_id > 0)
+        func = &SessionFunctions;
+    else
+        func = &GenericFunctions;
+
+    AssertArg(SlabIsValid(set));
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    /* Check for corruption and leaks before freeing */
+    AllocSetCheck(context);
+#endif
+
+    set->blocks = NULL;
+    set->freeBlocks = NULL;
+
+    while (block != NULL) {
+        SlabBlock next = block->next;
+
+        if (is_tracked)
+            MemoryTrackingFreeInfo(context, set->initBlockSize);
+
+        if (enable_memoryprotect)
+            (*func->free)(block, set->initBlockSize);
+        else
+            gs_free(block, set->initBlockSize);
+        block = next;
+    }
+
+    set->nblocks = 0;
+    set->totalSpace = 0;
+    set->freeSpace = 0;
+}
+
+/*
+ * AllocSetDelete
+ *		Frees all memory which is allocated in the given slab,
+ *		in preparation for deletion of the slab.
+ */
+template <bool enable_memoryprotect, bool is_tracked>
+void SlabMemoryAllocator::AllocSetDelete(MemoryContext context)
+{
+    /* slab keeps no block over resets, so deletion is just a reset */
+    AllocSetReset<enable_memoryprotect, is_tracked>(context);
+}
+
+Size SlabMemoryAllocator::AllocSetGetChunkSpace(MemoryContext context, void* pointer)
+{
+    SlabSet set = (SlabSet)context;
+
+    return set->fullChunkSize;
+}
+
+bool SlabMemoryAllocator::AllocSetIsEmpty(MemoryContext context)
+{
+    SlabSet set = (SlabSet)context;
+
+    /* unlike the generic allocator, slab knows when every chunk is free */
+    if (context->isReset || set->nblocks == 0)
+        return true;
+
+    return set->nblocks == 1 && set->blocks->nfree == set->chunksPerBlock;
+}
+
+/*
+ * AllocSetStats
+ *		Displays stats about memory consumption of a slab.
+ */
+void SlabMemoryAllocator::AllocSetStats(MemoryContext context, int level)
+{
+    SlabSet set = (SlabSet)context;
+    long nblocks = 0;
+    long nchunks = 0;
+    long freechunks = 0;
+    long totalspace = 0;
+    long freespace = 0;
+    SlabBlock block;
+    int i;
+
+    for (block = set->blocks; block != NULL; block = block->next) {
+        nblocks++;
+        nchunks += set->chunksPerBlock;
+        freechunks += block->nfree;
+        totalspace += set->initBlockSize;
+        freespace += (long)block->nfree * set->fullChunkSize;
+    }
+
+    for (i = 0; i < level; i++)
+        fprintf(stderr, "  ");
+
+    fprintf(stderr,
+        "  %s: %ld total in %ld blocks; %ld free (%ld of %ld chunks); %ld used\n",
+        set->header.name,
+        totalspace,
+        nblocks,
+        freespace,
+        freechunks,
+        nchunks,
+        totalspace - freespace);
+}
+
+/*
+ * AllocSetCheck
+ *		Walk through blocks and check that the free bitmaps, the free counts
+ *		and the free block list agree with each other.
+ */
+#ifdef MEMORY_CONTEXT_CHECKING
+void SlabMemoryAllocator::AllocSetCheck(MemoryContext context)
+{
+    SlabSet set = (SlabSet)context;
+    const char* name = set->header.name;
+    SlabBlock block;
+    int nblocks = 0;
+
+    for (block = set->blocks; block != NULL; block = block->next) {
+        int nfree = 0;
+        int idx;
+
+        nblocks++;
+        if (block->slab != set || block->magicNum != SlabBlkMagicNum)
+            elog(WARNING, "problem in slab %s: bogus slab link in block %p", name, block);
+
+        for (idx = 0; idx < set->chunksPerBlock; idx++) {
+            if (block->freemap[idx / SLAB_BITMAP_WORD_BITS] & (UINT64CONST(1) << (idx % SLAB_BITMAP_WORD_BITS))) {
+                nfree++;
+            } else {
+                char* chunk = SlabBlockGetChunk(set, block, idx);
+                StandardChunkHeader* header = (StandardChunkHeader*)(chunk + SLAB_BLOCKPTRSZ);
+
+                if (*(SlabBlock*)chunk != block || header->context != context)
+                    elog(WARNING, "problem in slab %s: bogus chunk %p in block %p", name, chunk, block);
+            }
+        }
+
+        if (nfree != block->nfree)
+            elog(WARNING,
+                "problem in slab %s: block %p has %d free chunks, bitmap says %d",
+                name,
+                block,
+                block->nfree,
+                nfree);
+
+        if ((nfree > 0) != block->onFreeList)
+            elog(WARNING, "problem in slab %s: block %p is misplaced on the free list", name, block);
+    }
+
+    if (nblocks != set->nblocks)
+        elog(WARNING, "problem in slab %s: found %d blocks, expected %d", name, nblocks, set->nblocks);
+}
+#endif
+
+/*
+ * SlabContextCreate
+ *		Public entry of the slab allocator.
+ *
+ * The address sanitizer build puts its own header in front of every chunk,
+ * so there it falls back to an ordinary context with the same lifetime.
+ */
+MemoryContext SlabContextCreate(MemoryContext parent, const char* name, Size blockSize, Size chunkSize)
+{
+#ifndef ENABLE_MEMORY_CHECK
+    return SlabMemoryAllocator::SlabContextCreate(parent, name, blockSize, chunkSize);
+#else
+    return AllocSetContextCreate(parent, name, ALLOCSET_DEFAULT_MINSIZE, ALLOCSET_DEFAULT_INITSIZE, blockSize);
+#endif
+}
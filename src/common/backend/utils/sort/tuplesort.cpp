@@ -100,6 +100,8 @@
 #include "knl/knl_variable.h"
 
 #include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 
 #include "access/nbtree.h"
 #include "catalog/index.h"
@@ -112,6 +114,8 @@
 #include "pgxc/execRemote.h"
 #include "catalog/pgxc_node.h"
 #endif
+#include "utils/builtins.h"
+#include "utils/date.h"
 #include "utils/datum.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
@@ -121,6 +125,7 @@
 #include "utils/rel_gs.h"
 #include "utils/sortsupport.h"
 #include "utils/sortsupport_gs.h"
+#include "utils/timestamp.h"
 #include "utils/tuplesort.h"
 #include "utils/memprot.h"
 #include "pgstat.h"
@@ -207,6 +212,39 @@ typedef enum {
 
 typedef int (*SortTupleComparator)(const SortTuple* a, const SortTuple* b, Tuplesortstate* state);
 
+/*
+ * Parameters of the parallel in-memory sort (see tuplesort_sort_parallel).
+ * A sort uses at most one thread per PARALLEL_SORT_MIN_TUPLES tuples, and
+ * PARALLEL_SORT_SAMPLES splitter candidates are taken from each sorted run.
+ */
+#define PARALLEL_SORT_MAX_WORKERS 32
+#define PARALLEL_SORT_MIN_TUPLES 65536
+#define PARALLEL_SORT_SAMPLES 64
+
+/*
+ * Work item of one thread of a parallel in-memory sort: either quicksort
+ * input[0..ninput), or merge the sorted runs[i][0..runlen[i]) into output.
+ */
+typedef struct ParallelSortTask {
+    Tuplesortstate* state;
+    SortTuple* input;
+    int ninput;
+    int nruns;
+    SortTuple* runs[PARALLEL_SORT_MAX_WORKERS];
+    int runlen[PARALLEL_SORT_MAX_WORKERS];
+    SortTuple* output;
+} ParallelSortTask;
+
+/*
+ * Parameters of the radix sort (see tuplesort_sort_radix).  Smaller sorts
+ * are left to qsort, and radix buckets holding no more than
+ * RADIX_SORT_INSERTION_TUPLES tuples are finished by insertion sort.
+ */
+#define RADIX_SORT_MIN_TUPLES 1024
+#define RADIX_SORT_INSERTION_TUPLES 32
+#define RADIX_SORT_BUCKETS 256
+#define RADIX_SORT_BYTE(datum, shift) ((int)(((datum) >> (shift)) & 0xFF))
+
 /*
  * Private state of a Tuplesort operation.
  */
@@ -217,6 +255,7 @@ struct Tuplesortstate {
     bool bounded;              /* did caller specify a maximum number of
                                 * tuples to return? */
     bool boundUsed;            /* true if we made use of a bounded heap */
+    bool parallelUsed;         /* true if several threads sorted memtuples */
     int bound;                 /* if bounded, the maximum number of tuples */
     int64 availMem;            /* remaining memory available, in bytes */
     int64 allowedMem;          /* total memory allowed, in bytes */
@@ -591,6 +630,8 @@ static void writetup_datum(Tuplesortstate* state, int tapenum, SortTuple* stup);
 static void readtup_datum(Tuplesortstate* state, SortTuple* stup, int tapenum, unsigned int len);
 static void reversedirection_datum(Tuplesortstate* state);
 static void free_sort_tuple(Tuplesortstate* state, SortTuple* stup);
+static bool tuplesort_sort_parallel(Tuplesortstate* state);
+static bool tuplesort_sort_radix(Tuplesortstate* state);
 
 /*
  * Special versions of qsort just for SortTuple objects.  qsort_tuple() sorts
@@ -676,6 +717,7 @@ static Tuplesortstate* tuplesort_begin_common(int64 workMem, bool randomAccess)
     state->randomAccess = randomAccess;
     state->bounded = false;
     state->boundUsed = false;
+    state->parallelUsed = false;
     state->allowedMem = workMem * 1024L;
     state->availMem = state->allowedMem;
     state->sortcontext = sortcontext;
@@ -1035,8 +1077,10 @@ void tuplesort_set_bound(Tuplesortstate* state, int64 bound)
      * abbreviation support.
      */
     state->sortKeys->abbrev_converter = NULL;
-    if (state->sortKeys->abbrev_full_comparator)
+    if (state->sortKeys->abbrev_full_comparator) {
         state->sortKeys->comparator = state->sortKeys->abbrev_full_comparator;
+        state->sortKeys->radix_width = 0;
+    }
 
     /* Not strictly necessary, but be tidy */
     state->sortKeys->abbrev_abort = NULL;
@@ -1590,6 +1634,7 @@ static bool consider_abort_common(Tuplesortstate* state)
          */
         state->sortKeys[0].comparator = state->sortKeys[0].abbrev_full_comparator;
         state->sortKeys[0].abbrev_converter = NULL;
+        state->sortKeys[0].radix_width = 0;
         /* Not strictly necessary, but be tidy */
         state->sortKeys[0].abbrev_abort = NULL;
         state->sortKeys[0].abbrev_full_comparator = NULL;
@@ -1601,6 +1646,522 @@ static bool consider_abort_common(Tuplesortstate* state)
     return false;
 }
 
+/*
+ * Parallel in-memory sort.
+ *
+ * When all the input fits in memory and there is a lot of it, performsort
+ * cuts the memtuples array into one segment per worker, has the workers
+ * quicksort their segments, and then merges the sorted segments in parallel
+ * as well: splitters sampled from the sorted segments divide the key space
+ * into one range per worker, and each worker does a k-way merge of its range
+ * of every segment into its own slice of a second array.
+ *
+ * The workers are plain pthreads without any backend context, so all they
+ * ever run are the comparators.  This is only done when every comparator
+ * involved is known to be free of palloc, ereport and catalog access (see
+ * tuplesort_parallel_safe), and the session thread does not look for
+ * interrupts while workers are running, since an error would free the
+ * array under their feet.  (heap_getattr and index_getattr may fill in
+ * attcacheoff of the shared tuple descriptor, but all threads store the
+ * same values there.)
+ */
+static bool sort_function_threadsafe(const FmgrInfo* flinfo)
+{
+    PGFunction fn = flinfo->fn_addr;
+
+    return (fn == btint2cmp || fn == btint4cmp || fn == btint8cmp || fn == btoidcmp || fn == btfloat4cmp ||
+            fn == btfloat8cmp || fn == date_cmp || fn == timestamp_cmp);
+}
+
+static bool tuplesort_parallel_safe(Tuplesortstate* state)
+{
+    int i;
+
+    if (state->comparetup == comparetup_datum) {
+        return state->onlyKey->comparator_threadsafe && state->onlyKey->abbrev_converter == NULL;
+    }
+
+    if (state->comparetup == comparetup_heap) {
+        for (i = 0; i < state->nKeys; i++) {
+            SortSupport sortKey = state->sortKeys + i;
+
+            if (!sortKey->comparator_threadsafe || sortKey->abbrev_converter != NULL) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (state->comparetup == comparetup_index_hash) {
+        return true;
+    }
+
+    if (state->comparetup == comparetup_index_btree || state->comparetup == comparetup_cluster) {
+        /* a duplicate key in a unique index build raises an error from the comparator */
+        if (state->comparetup == comparetup_index_btree && state->enforceUnique) {
+            return false;
+        }
+        /* index expressions are evaluated by the executor */
+        if (state->comparetup == comparetup_cluster && state->indexInfo->ii_Expressions != NIL) {
+            return false;
+        }
+        for (i = 0; i < state->nKeys; i++) {
+            if (!sort_function_threadsafe(&state->indexScanKey[i].sk_func)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+static int parallel_sort_compare(const void* a, const void* b, void* arg)
+{
+    Tuplesortstate* state = (Tuplesortstate*)arg;
+    const SortTuple* x = (const SortTuple*)a;
+    const SortTuple* y = (const SortTuple*)b;
+
+    if (state->onlyKey != NULL) {
+        return ApplySortComparator(x->datum1, x->isnull1, y->datum1, y->isnull1, state->onlyKey);
+    }
+    return COMPARETUP(state, x, y);
+}
+
+static void* parallel_sort_worker(void* arg)
+{
+    ParallelSortTask* task = (ParallelSortTask*)arg;
+
+    qsort_arg(task->input, task->ninput, sizeof(SortTuple), parallel_sort_compare, task->state);
+    return NULL;
+}
+
+/*
+ * Is the head of run i smaller than the head of run j?  Ties go to the lower
+ * run number so that the merge result does not depend on thread timing.
+ */
+static inline bool parallel_merge_less(ParallelSortTask* task, const int* pos, int i, int j)
+{
+    int compare = parallel_sort_compare(&task->runs[i][pos[i]], &task->runs[j][pos[j]], task->state);
+
+    return compare < 0 || (compare == 0 && i < j);
+}
+
+static void parallel_merge_siftdown(ParallelSortTask* task, int* heap, int nheap, const int* pos, int i)
+{
+    for (;;) {
+        int child = 2 * i + 1;
+
+        if (child >= nheap) {
+            break;
+        }
+        if (child + 1 < nheap && parallel_merge_less(task, pos, heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!parallel_merge_less(task, pos, heap[child], heap[i])) {
+            break;
+        }
+        int tmp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = tmp;
+        i = child;
+    }
+}
+
+static void* parallel_merge_worker(void* arg)
+{
+    ParallelSortTask* task = (ParallelSortTask*)arg;
+    SortTuple* output = task->output;
+    int heap[PARALLEL_SORT_MAX_WORKERS];
+    int pos[PARALLEL_SORT_MAX_WORKERS];
+    int nheap = 0;
+    int i;
+
+    for (i = 0; i < task->nruns; i++) {
+        pos[i] = 0;
+        if (task->runlen[i] > 0) {
+            heap[nheap++] = i;
+        }
+    }
+    for (i = nheap / 2 - 1; i >= 0; i--) {
+        parallel_merge_siftdown(task, heap, nheap, pos, i);
+    }
+
+    while (nheap > 0) {
+        int run = heap[0];
+
+        *output++ = task->runs[run][pos[run]++];
+        if (pos[run] == task->runlen[run]) {
+            heap[0] = heap[--nheap];
+        }
+        parallel_merge_siftdown(task, heap, nheap, pos, 0);
+    }
+    return NULL;
+}
+
+/*
+ * Run tasks[0] on the calling thread and every other task on a thread of its
+ * own, and wait for all of them.  A task whose thread cannot be started is
+ * run on the calling thread instead.
+ */
+static void parallel_sort_run_tasks(ParallelSortTask* tasks, int ntasks, void* (*worker)(void*))
+{
+    pthread_t threads[PARALLEL_SORT_MAX_WORKERS];
+    bool started[PARALLEL_SORT_MAX_WORKERS];
+    sigset_t blockAll;
+    sigset_t oldMask;
+    int i;
+
+    /* signals are for the session thread only */
+    (void)sigfillset(&blockAll);
+    (void)pthread_sigmask(SIG_SETMASK, &blockAll, &oldMask);
+    for (i = 1; i < ntasks; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, worker, &tasks[i]) == 0);
+    }
+    (void)pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+
+    (void)worker(&tasks[0]);
+    for (i = 1; i < ntasks; i++) {
+        if (started[i]) {
+            (void)pthread_join(threads[i], NULL);
+        } else {
+            (void)worker(&tasks[i]);
+        }
+    }
+}
+
+/* first position in the sorted run whose tuple is not less than *key */
+static int parallel_sort_lower_bound(Tuplesortstate* state, const SortTuple* run, int len, const SortTuple* key)
+{
+    int lo = 0;
+    int hi = len;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (parallel_sort_compare(&run[mid], key, state) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * Sort state->memtuples using several threads.  Returns false, leaving the
+ * array untouched, if the sort is too small, its comparators cannot run in
+ * helper threads, or there is no room for the merge output array; the
+ * caller then does a plain qsort.
+ */
+static bool tuplesort_sort_parallel(Tuplesortstate* state)
+{
+    int nworkers = u_sess->attr.attr_sql.sort_parallel_workers;
+    int n = state->memtupcount;
+    ParallelSortTask tasks[PARALLEL_SORT_MAX_WORKERS];
+    SortTuple* runs[PARALLEL_SORT_MAX_WORKERS];
+    int runlen[PARALLEL_SORT_MAX_WORKERS];
+    SortTuple* samples = NULL;
+    SortTuple* output = NULL;
+    int nsamples = 0;
+    int offset = 0;
+    int i;
+    int j;
+    errno_t rc = EOK;
+
+    nworkers = Min(nworkers, n / PARALLEL_SORT_MIN_TUPLES);
+    if (nworkers < 2 || !tuplesort_parallel_safe(state)) {
+        return false;
+    }
+    if (state->availMem < (int64)n * (int64)sizeof(SortTuple)) {
+        return false;
+    }
+
+    output = (SortTuple*)palloc(n * sizeof(SortTuple));
+    USEMEM(state, GetMemoryChunkSpace(output));
+
+    /* Phase 1: quicksort one segment per worker */
+    rc = memset_s(tasks, sizeof(tasks), 0, sizeof(tasks));
+    securec_check(rc, "\0", "\0");
+    for (i = 0; i < nworkers; i++) {
+        int start = (int)((int64)n * i / nworkers);
+        int end = (int)((int64)n * (i + 1) / nworkers);
+
+        runs[i] = state->memtuples + start;
+        runlen[i] = end - start;
+        tasks[i].state = state;
+        tasks[i].input = runs[i];
+        tasks[i].ninput = runlen[i];
+    }
+    parallel_sort_run_tasks(tasks, nworkers, parallel_sort_worker);
+
+    /*
+     * Phase 2: pick nworkers - 1 splitters out of evenly spaced samples of
+     * the sorted runs, and let worker j merge the part of every run that
+     * lies between splitters j - 1 and j.
+     */
+    samples = (SortTuple*)palloc(nworkers * PARALLEL_SORT_SAMPLES * sizeof(SortTuple));
+    for (i = 0; i < nworkers; i++) {
+        for (j = 1; j <= PARALLEL_SORT_SAMPLES; j++) {
+            samples[nsamples++] = runs[i][(int)((int64)runlen[i] * j / (PARALLEL_SORT_SAMPLES + 1))];
+        }
+    }
+    qsort_arg(samples, nsamples, sizeof(SortTuple), parallel_sort_compare, state);
+
+    for (i = 0; i < nworkers; i++) {
+        tasks[i].nruns = nworkers;
+        for (j = 0; j < nworkers; j++) {
+            int lo = 0;
+            int hi = runlen[j];
+
+            if (i > 0) {
+                lo = parallel_sort_lower_bound(state, runs[j], runlen[j], &samples[i * PARALLEL_SORT_SAMPLES]);
+            }
+            if (i < nworkers - 1) {
+                hi = parallel_sort_lower_bound(state, runs[j], runlen[j], &samples[(i + 1) * PARALLEL_SORT_SAMPLES]);
+            }
+            tasks[i].runs[j] = runs[j] + lo;
+            tasks[i].runlen[j] = hi - lo;
+        }
+        tasks[i].output = output + offset;
+        for (j = 0; j < nworkers; j++) {
+            offset += tasks[i].runlen[j];
+        }
+    }
+    Assert(offset == n);
+    pfree_ext(samples);
+
+    parallel_sort_run_tasks(tasks, nworkers, parallel_merge_worker);
+
+    FREEMEM(state, GetMemoryChunkSpace(state->memtuples));
+    pfree_ext(state->memtuples);
+    state->memtuples = output;
+    state->memtupsize = n;
+    state->growmemtuples = false;
+    state->parallelUsed = true;
+
+#ifdef TRACE_SORT
+    if (u_sess->attr.attr_common.trace_sort) {
+        elog(LOG, "sorted %d tuples with %d threads: %s", n, nworkers, pg_rusage_show(&state->ru_start));
+    }
+#endif
+
+    return true;
+}
+
+/*
+ * Radix sort.
+ *
+ * If the SortSupport of the leading key says (through radix_width and
+ * radix_mask) that its comparator orders Datums like plain integers, the
+ * in-memory sort uses an in-place MSD radix sort on datum1 instead of qsort.
+ * NULLs are first moved to the end they sort to; every other datum1 is then
+ * XOR'ed with a mask that turns it into an unsigned ascending key (folding
+ * in DESC as well), radix sorted byte by byte starting with the most
+ * significant byte that differs, and XOR'ed back.  Comparators are only
+ * called to order runs of equal datum1 values, which is needed when there
+ * are more sort keys or when datum1 is an abbreviated key.
+ */
+static void radix_insertion_sort(SortTuple* tuples, int n)
+{
+    int i;
+    int j;
+
+    for (i = 1; i < n; i++) {
+        SortTuple tmp = tuples[i];
+
+        for (j = i; j > 0 && tuples[j - 1].datum1 > tmp.datum1; j--) {
+            tuples[j] = tuples[j - 1];
+        }
+        tuples[j] = tmp;
+    }
+}
+
+static void radix_sort_tuples(SortTuple* tuples, int n, int shift)
+{
+    int count[RADIX_SORT_BUCKETS];
+    int next[RADIX_SORT_BUCKETS];
+    int end[RADIX_SORT_BUCKETS];
+    int start;
+    int b;
+    int i;
+    errno_t rc = EOK;
+
+    /* skip the bytes in which all the keys agree */
+    for (;;) {
+        if (n <= RADIX_SORT_INSERTION_TUPLES) {
+            radix_insertion_sort(tuples, n);
+            return;
+        }
+
+        rc = memset_s(count, sizeof(count), 0, sizeof(count));
+        securec_check(rc, "\0", "\0");
+        for (i = 0; i < n; i++) {
+            count[RADIX_SORT_BYTE(tuples[i].datum1, shift)]++;
+        }
+        if (count[RADIX_SORT_BYTE(tuples[0].datum1, shift)] < n) {
+            break;
+        }
+        if (shift == 0) {
+            return;
+        }
+        shift -= BITS_PER_BYTE;
+    }
+
+    CHECK_FOR_INTERRUPTS();
+
+    start = 0;
+    for (b = 0; b < RADIX_SORT_BUCKETS; b++) {
+        next[b] = start;
+        start += count[b];
+        end[b] = start;
+    }
+
+    /* move every tuple into its bucket, following cycles of displaced tuples */
+    for (b = 0; b < RADIX_SORT_BUCKETS; b++) {
+        while (next[b] < end[b]) {
+            SortTuple tmp = tuples[next[b]];
+            int tb = RADIX_SORT_BYTE(tmp.datum1, shift);
+
+            while (tb != b) {
+                SortTuple displaced = tuples[next[tb]];
+
+                tuples[next[tb]++] = tmp;
+                tmp = displaced;
+                tb = RADIX_SORT_BYTE(tmp.datum1, shift);
+            }
+            tuples[next[b]++] = tmp;
+        }
+    }
+
+    if (shift == 0) {
+        return;
+    }
+
+    start = 0;
+    for (b = 0; b < RADIX_SORT_BUCKETS; b++) {
+        if (count[b] > 1) {
+            radix_sort_tuples(tuples + start, count[b], shift - BITS_PER_BYTE);
+        }
+        start += count[b];
+    }
+}
+
+/*
+ * Sort state->memtuples with a radix sort on the leading key.  Returns false,
+ * leaving the array as it was, if radix sorting is disabled, the sort is too
+ * small or its leading key does not support it; the caller then does a
+ * plain qsort.
+ */
+static bool tuplesort_sort_radix(Tuplesortstate* state)
+{
+    SortSupport sortKey = (state->onlyKey != NULL) ? state->onlyKey : state->sortKeys;
+    SortTuple* tuples = state->memtuples;
+    SortTuple* nulls = NULL;
+    int n = state->memtupcount;
+    int nnulls = 0;
+    Datum widthmask;
+    Datum mask;
+    Datum diff = 0;
+    int shift;
+    int i;
+    int j;
+
+    if (!u_sess->attr.attr_sql.enable_radix_sort || n < RADIX_SORT_MIN_TUPLES) {
+        return false;
+    }
+    if (state->comparetup != comparetup_heap && state->comparetup != comparetup_datum) {
+        return false;
+    }
+    if (sortKey == NULL || sortKey->radix_width <= 0 || sortKey->radix_width > SIZEOF_DATUM) {
+        return false;
+    }
+
+    if (sortKey->radix_width == SIZEOF_DATUM) {
+        widthmask = ~(Datum)0;
+    } else {
+        widthmask = ((Datum)1 << (sortKey->radix_width * BITS_PER_BYTE)) - 1;
+    }
+    mask = sortKey->radix_mask;
+    if (sortKey->ssup_reverse) {
+        mask ^= widthmask;
+    }
+
+    /* all keys must fit in radix_width bytes, else fall back to qsort */
+    for (i = 0; i < n; i++) {
+        if (!tuples[i].isnull1 && (tuples[i].datum1 & ~widthmask) != 0) {
+            return false;
+        }
+    }
+
+    /* move the NULLs to the end of the array they sort to */
+    if (sortKey->ssup_nulls_first) {
+        for (i = 0, j = 0; i < n; i++) {
+            if (tuples[i].isnull1) {
+                SortTuple tmp = tuples[i];
+
+                tuples[i] = tuples[j];
+                tuples[j++] = tmp;
+            }
+        }
+        nulls = tuples;
+        nnulls = j;
+        tuples += nnulls;
+    } else {
+        for (i = n - 1, j = n; i >= 0; i--) {
+            if (tuples[i].isnull1) {
+                SortTuple tmp = tuples[i];
+
+                tuples[i] = tuples[--j];
+                tuples[j] = tmp;
+            }
+        }
+        nulls = tuples + j;
+        nnulls = n - j;
+    }
+    n -= nnulls;
+
+    if (n > 1) {
+        for (i = 0; i < n; i++) {
+            tuples[i].datum1 ^= mask;
+            diff |= tuples[i].datum1 ^ tuples[0].datum1;
+        }
+        if (diff != 0) {
+            for (shift = (SIZEOF_DATUM - 1) * BITS_PER_BYTE; (diff >> shift) == 0; shift -= BITS_PER_BYTE) {
+                ;
+            }
+            radix_sort_tuples(tuples, n, shift);
+        }
+        for (i = 0; i < n; i++) {
+            tuples[i].datum1 ^= mask;
+        }
+
+        /* order runs of equal keys by the rest of the sort keys */
+        if (state->nKeys > 1 || !sortKey->radix_exact) {
+            for (i = 0; i < n; i = j) {
+                for (j = i + 1; j < n && tuples[j].datum1 == tuples[i].datum1; j++) {
+                    ;
+                }
+                if (j - i > 1) {
+                    qsort_tuple(tuples + i, j - i, state->comparetup, state);
+                }
+            }
+        }
+    }
+
+    if (nnulls > 1 && state->nKeys > 1) {
+        qsort_tuple(nulls, nnulls, state->comparetup, state);
+    }
+
+#ifdef TRACE_SORT
+    if (u_sess->attr.attr_common.trace_sort) {
+        elog(LOG, "radix sorted %d tuples: %s", state->memtupcount, pg_rusage_show(&state->ru_start));
+    }
+#endif
+
+    return true;
+}
+
 /*
  * All tuples have been provided; finish the sort.
  */
@@ -1619,11 +2180,13 @@ void tuplesort_performsort(Tuplesortstate* state)
 
             /*
              * We were able to accumulate all the tuples within the allowed
-             * amount of memory.  Just qsort 'em and we're done.
+             * amount of memory.  Just sort 'em and we're done: with several
+             * threads if sort_parallel_workers allows, with a radix sort if
+             * the leading key supports one, else with qsort.
              */
             if (state->memtupcount > 0)
                 state->width = state->width / state->memtupcount;
-            if (state->memtupcount > 1) {
+            if (state->memtupcount > 1 && !tuplesort_sort_parallel(state) && !tuplesort_sort_radix(state)) {
                 /* Can we use the single-key sort function? */
                 if (state->onlyKey != NULL)
                     qsort_ssup(state->memtuples, state->memtupcount, state->onlyKey);
@@ -2277,6 +2840,7 @@ static void mergeruns(Tuplesortstate* state)
          */
         state->sortKeys->abbrev_converter = NULL;
         state->sortKeys->comparator = state->sortKeys->abbrev_full_comparator;
+        state->sortKeys->radix_width = 0;
 
         /* Not strictly necessary, but be tidy */
         state->sortKeys->abbrev_abort = NULL;
@@ -2877,6 +3441,8 @@ void tuplesort_get_stats(Tuplesortstate* state, int* sortMethodId, int* spaceTyp
         case TSS_SORTEDINMEM:
             if (state->boundUsed) {
                 *sortMethodId = (int)HEAPSORT;
+            } else if (state->parallelUsed) {
+                *sortMethodId = (int)PARALLELQUICKSORT;
             } else {
                 *sortMethodId = (int)QUICKSORT;
             }
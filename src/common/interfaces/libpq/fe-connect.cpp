@@ -212,6 +212,9 @@ static const PQconninfoOption PQconninfoOptions[] = {
     /* should be just '0' or '1' */
     {"fencedUdfRPCMode", NULL, NULL, NULL, "fencedUdfRPCMode", "", 1, 0},
 
+    /* should be just '0' or '1' */
+    {"columnar_result", "PGCOLUMNARRESULT", NULL, NULL, "Columnar-Result", "", 1, 0},
+
     /* should be just '0' or '1' */
     {"keepalives", NULL, NULL, NULL, "TCP-Keepalives", "", 1, 0},
     {"keepalives_idle", NULL, NULL, NULL, "TCP-Keepalives-Idle", "", 10, 0},
@@ -919,6 +922,8 @@ static void fillPGconn(PGconn* conn, PQconninfoOption* connOptions)
     conn->replication = (tmp != NULL) ? strdup(tmp) : NULL;
     tmp = conninfo_getval(connOptions, "backend_version");
     conn->backend_version = (tmp != NULL) ? strdup(tmp) : NULL;
+    tmp = conninfo_getval(connOptions, "columnar_result");
+    conn->columnar_result = (tmp != NULL) ? strdup(tmp) : NULL;
 
     tmp = conninfo_getval(connOptions, "fencedUdfRPCMode");
     conn->fencedUdfRPCMode = (tmp != NULL) ? true : false;
@@ -3211,6 +3216,7 @@ void freePGconn(PGconn* conn)
     libpq_free(conn->dbName);
     libpq_free(conn->replication);
     libpq_free(conn->backend_version);
+    libpq_free(conn->columnar_result);
     libpq_free(conn->pguser);
     if (conn->pgpass != NULL) {
         erase_string(conn->pgpass);
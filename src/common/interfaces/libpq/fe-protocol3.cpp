@@ -40,13 +40,16 @@
  * than a couple of kilobytes).
  */
 #define VALID_LONG_MESSAGE_TYPE(id) \
-    ((id) == 'T' || (id) == 'D' || (id) == 'd' || (id) == 'V' || (id) == 'E' || (id) == 'N' || (id) == 'A')
+    ((id) == 'T' || (id) == 'D' || (id) == 'J' || (id) == 'd' || (id) == 'V' || (id) == 'E' || (id) == 'N' || \
+        (id) == 'A')
 
 THR_LOCAL uint32 *g_workingVersionNum = NULL;
 static void handleSyncLoss(PGconn* conn, char id, int msgLength);
 static int getRowDescriptions(PGconn* conn, int msgLength);
 static int getParamDescriptions(PGconn* conn);
 static int getAnotherTuple(PGconn* conn, int msgLength);
+static int getColumnBatch(PGconn* conn, int msgLength);
+static bool columnarResultRequested(const PGconn* conn);
 static int getParameterStatus(PGconn* conn);
 static int getNotify(PGconn* conn);
 static int getCopyStart(PGconn* conn, ExecStatusType copytype);
@@ -303,6 +306,34 @@ void pqParseInput3(PGconn* conn)
                         conn->inCursor += msgLength;
                     }
                     break;
+                case 'J': /* Column Batch */
+                    if (!columnarResultRequested(conn)) {
+                        /* only sent to a connection that asked for it, so this is a protocol error */
+                        printfPQExpBuffer(&conn->errorMessage,
+                            libpq_gettext("server sent data (\"J\" message) that was not requested by the "
+                            "columnar_result connection option\n"));
+                        pqSaveErrorResult(conn);
+                        conn->asyncStatus = PGASYNC_READY;
+                        /* Discard the unexpected message */
+                        conn->inCursor += msgLength;
+                    } else if (conn->result != NULL && conn->result->resultStatus == PGRES_TUPLES_OK) {
+                        /* Read the rows of a batch sent column by column */
+                        if (getColumnBatch(conn, msgLength))
+                            return;
+                        /* getColumnBatch() moves inStart itself */
+                        continue;
+                    } else if (conn->result != NULL && conn->result->resultStatus == PGRES_FATAL_ERROR) {
+                        /* Discard batches till the end of the query, as for 'D' */
+                        conn->inCursor += msgLength;
+                    } else {
+                        printfPQExpBuffer(&conn->errorMessage,
+                            libpq_gettext("server sent data (\"J\" message) without prior row description "
+                            "(\"T\" message)\n"));
+                        pqSaveErrorResult(conn);
+                        /* Discard the unexpected message */
+                        conn->inCursor += msgLength;
+                    }
+                    break;
                 case 'G': /* Start Copy In */
                     if (getCopyStart(conn, PGRES_COPY_IN))
                         return;
@@ -732,6 +763,131 @@ set_error_result:
     return 0;
 }
 
+/* did the connection ask the server for ColumnBatch messages? */
+static bool columnarResultRequested(const PGconn* conn)
+{
+    return conn->columnar_result != NULL && strcmp(conn->columnar_result, "1") == 0;
+}
+
+/*
+ * parseInput subroutine to read a 'J' (column batch) message.
+ *
+ * The message carries the values of many rows column by column, each in the
+ * binary format of its type and preceded by its length like in a DataRow.
+ * We gather the field pointers row by row and hand every row to the row
+ * processor, so the PGresult looks as if it had been sent in binary format.
+ * Returns: 0 if processed message successfully, EOF to suspend parsing
+ * (the latter case is not actually used currently).
+ * In either case, conn->inStart has been advanced past the message.
+ */
+static int getColumnBatch(PGconn* conn, int msgLength)
+{
+    PGresult* result = conn->result;
+    int nfields = result->numAttributes;
+    const char* errmsg = NULL;
+    PGdataValue* batchbuf = NULL;
+    PGdataValue* rowbuf = NULL;
+    int batchnfields; /* # fields from batch */
+    int nrows;        /* # rows in batch */
+    int vlen;         /* length of the current field value */
+    int i;
+    int j;
+
+    if (pqGetInt(&batchnfields, 2, conn) || pqGetInt(&nrows, 4, conn)) {
+        errmsg = libpq_gettext("insufficient data in \"J\" message");
+        goto advance_and_error;
+    }
+
+    if (batchnfields != nfields || nrows < 0) {
+        errmsg = libpq_gettext("unexpected field count in \"J\" message");
+        goto advance_and_error;
+    }
+
+    /* Each row would have to be a PGresult of its own */
+    if (conn->singleRowMode) {
+        errmsg = libpq_gettext("\"J\" message is not supported in single-row mode");
+        goto advance_and_error;
+    }
+
+    if (nrows == 0 || nfields == 0) {
+        conn->inCursor = conn->inStart + 5 + msgLength;
+        conn->inStart = conn->inCursor;
+        return 0;
+    }
+
+    batchbuf = (PGdataValue*)malloc((size_t)nrows * nfields * sizeof(PGdataValue));
+    if (batchbuf == NULL) {
+        errmsg = NULL; /* means "out of memory", see below */
+        goto advance_and_error;
+    }
+
+    /* Scan the fields, column by column */
+    for (i = 0; i < nfields; i++) {
+        for (j = 0; j < nrows; j++) {
+            PGdataValue* field = batchbuf + (size_t)j * nfields + i;
+
+            if (pqGetInt(&vlen, 4, conn)) {
+                errmsg = libpq_gettext("insufficient data in \"J\" message");
+                goto advance_and_error;
+            }
+            field->len = vlen;
+            field->value = conn->inBuffer + conn->inCursor;
+
+            if (vlen > 0 && pqSkipnchar(vlen, conn)) {
+                errmsg = libpq_gettext("insufficient data in \"J\" message");
+                goto advance_and_error;
+            }
+        }
+    }
+
+    /* Sanity check that we absorbed all the data */
+    if (conn->inCursor != conn->inStart + 5 + msgLength) {
+        errmsg = libpq_gettext("extraneous data in \"J\" message");
+        goto advance_and_error;
+    }
+
+    /* Advance inStart to show that the "J" message has been processed. */
+    conn->inStart = conn->inCursor;
+
+    /* Values arrive in the binary format of their types */
+    for (i = 0; i < nfields; i++)
+        result->attDescs[i].format = 1;
+    result->binary = 1;
+
+    /* Process the collected rows, pointing the row buffer at each in turn */
+    rowbuf = conn->rowBuf;
+    for (j = 0; j < nrows; j++) {
+        conn->rowBuf = batchbuf + (size_t)j * nfields;
+        errmsg = NULL;
+        if (!pqRowProcessor(conn, &errmsg)) {
+            conn->rowBuf = rowbuf;
+            free(batchbuf);
+            goto set_error_result;
+        }
+    }
+    conn->rowBuf = rowbuf;
+    free(batchbuf);
+    return 0; /* normal, successful exit */
+
+advance_and_error:
+    /* Discard the failed message by pretending we read it */
+    conn->inStart += 5 + msgLength;
+    if (batchbuf != NULL)
+        free(batchbuf);
+
+set_error_result:
+    pqClearAsyncResult(conn);
+
+    if (errmsg == NULL)
+        errmsg = libpq_gettext("out of memory for query result");
+
+    printfPQExpBuffer(&conn->errorMessage, "%s\n", errmsg);
+    pqSaveErrorResult(conn);
+
+    /* Return zero to allow input parsing to continue, as getAnotherTuple does */
+    return 0;
+}
+
 /*
  * Attempt to read an Error or Notice response message.
  * This is possible in several places, so we break it out as a subroutine.
@@ -1866,6 +2022,11 @@ static bool add_options_to_package(const PGconn* conn, char* packet, int *packet
         return false;
     }
 
+    /* We can read ColumnBatch messages, let the server send them */
+    if (columnarResultRequested(conn) && !ADD_STARTUP_OPTION("columnar_result_transfer", "on", packet, packet_len)) {
+        return false;
+    }
+
     if (g_workingVersionNum && *g_workingVersionNum >= 92060) {
         return ADD_STARTUP_OPTION("connect_timeout", conn->connect_timeout, packet, packet_len);
     }
@@ -38,6 +38,7 @@
 #include "utils/rel.h"
 #include "utils/rel_gs.h"
 #include "utils/syscache.h"
+#include "utils/tuplestore.h"
 #include "miscadmin.h"
 
 /* functions reference other modules */
@@ -2862,6 +2863,127 @@ static void plpgsql_HashTableDelete(PLpgSQL_function* func)
     func->fn_hashkey = NULL;
 }
 
+#ifdef ENABLE_LLVM_COMPILE
+/*
+ * Release the native code of the compiled functions when the session ends,
+ * LLVM does not allocate it in the memory contexts of the session.
+ */
+void plpgsql_codegen_cleanup_session(int code, Datum arg)
+{
+    HASH_SEQ_STATUS hash_seq;
+    plpgsql_HashEnt* hentry = NULL;
+
+    if (u_sess->plsql_cxt.plpgsql_HashTable == NULL) {
+        return;
+    }
+
+    hash_seq_init(&hash_seq, u_sess->plsql_cxt.plpgsql_HashTable);
+    while ((hentry = (plpgsql_HashEnt*)hash_seq_search(&hash_seq)) != NULL) {
+        PLpgSQLFunctionCodeGenRelease(hentry->function);
+    }
+}
+#endif
+
+static const char* plpgsql_codegen_status_name(PLpgSQL_codegen_status status)
+{
+    switch (status) {
+        case PLPGSQL_CODEGEN_COMPILED:
+            return "compiled";
+        case PLPGSQL_CODEGEN_UNSUPPORTED:
+            return "unsupported";
+        case PLPGSQL_CODEGEN_FAILED:
+            return "failed";
+        default:
+            return "interpreted";
+    }
+}
+
+/*
+ * pg_plpgsql_compiled_functions
+ *		The functions in the PL/pgSQL function cache of the session, with
+ *		their native compilation status and their call counts.
+ */
+Datum pg_plpgsql_compiled_functions(PG_FUNCTION_ARGS)
+{
+#define PLPGSQL_COMPILED_FUNCTIONS_COLS 7
+    ReturnSetInfo* rsinfo = (ReturnSetInfo*)fcinfo->resultinfo;
+    TupleDesc tupdesc;
+    Tuplestorestate* tupstore = NULL;
+    MemoryContext per_query_ctx;
+    MemoryContext oldcontext;
+
+    /* check to see if caller supports us returning a tuplestore */
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("set-valued function called in context that cannot accept a set")));
+    }
+    if (!(rsinfo->allowedModes & SFRM_Materialize)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("materialize mode required, but it is not allowed in this context")));
+    }
+
+    /* need to build tuplestore in query context */
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    /* This must match the definition of the pg_plpgsql_compiled_functions view in system_views.sql */
+    tupdesc = CreateTemplateTupleDesc(PLPGSQL_COMPILED_FUNCTIONS_COLS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber)1, "funcoid", OIDOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)2, "signature", TEXTOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)3, "status", TEXTOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)4, "reason", TEXTOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)5, "calls", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)6, "native_calls", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)7, "fallbacks", INT8OID, -1, 0);
+
+    tupstore =
+        tuplestore_begin_heap(rsinfo->allowedModes & SFRM_Materialize_Random, false, u_sess->attr.attr_memory.work_mem);
+
+    /* generate junk in short-term context */
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    /* hash table might be uninitialized */
+    if (u_sess->plsql_cxt.plpgsql_HashTable != NULL) {
+        HASH_SEQ_STATUS hash_seq;
+        plpgsql_HashEnt* hentry = NULL;
+
+        hash_seq_init(&hash_seq, u_sess->plsql_cxt.plpgsql_HashTable);
+        while ((hentry = (plpgsql_HashEnt*)hash_seq_search(&hash_seq)) != NULL) {
+            PLpgSQL_function* func = hentry->function;
+            Datum values[PLPGSQL_COMPILED_FUNCTIONS_COLS];
+            bool nulls[PLPGSQL_COMPILED_FUNCTIONS_COLS];
+
+            errno_t rc = memset_s(nulls, sizeof(nulls), 0, sizeof(nulls));
+            securec_check(rc, "\0", "\0");
+
+            values[0] = ObjectIdGetDatum(func->fn_oid);
+            values[1] = CStringGetTextDatum(func->fn_signature);
+            values[2] = CStringGetTextDatum(plpgsql_codegen_status_name(func->fn_codegen_status));
+            if (func->fn_codegen_reason != NULL) {
+                values[3] = CStringGetTextDatum(func->fn_codegen_reason);
+            } else {
+                nulls[3] = true;
+            }
+            values[4] = Int64GetDatum((int64)func->fn_calls);
+            values[5] = Int64GetDatum((int64)func->fn_native_calls);
+            values[6] = Int64GetDatum((int64)func->fn_native_fallbacks);
+
+            tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+        }
+    }
+
+    /* clean up and return the tuplestore */
+    tuplestore_donestoring(tupstore);
+
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    return (Datum)0;
+}
+
 /*
  * get a custom error code for a new user defined exceprtion.
  */
@@ -280,6 +280,35 @@ static int check_line_validity(List* stmts, int linenum, int prevValidLine)
     return valid_line;
 }
 
+#ifdef ENABLE_LLVM_COMPILE
+/*
+ * Run the native code of a compiled function.  Returns false when the
+ * interpreter has to run the call, because the native code cannot take it
+ * or handed it back.
+ */
+static bool plpgsql_exec_native(PLpgSQL_function* func, FunctionCallInfo fcinfo, Datum* result)
+{
+    /* the plugins see the statements, which the native code does not run */
+    if (func->fn_native == NULL || *u_sess->plsql_cxt.plugin_ptr != NULL) {
+        return false;
+    }
+    for (int i = 0; i < func->fn_nargs; i++) {
+        if (fcinfo->argnull[i]) {
+            return false;
+        }
+    }
+
+    CHECK_FOR_INTERRUPTS();
+    if (func->fn_native(fcinfo->arg, result, &InterruptPending) != 0) {
+        func->fn_native_fallbacks++;
+        return false;
+    }
+    func->fn_native_calls++;
+    fcinfo->isnull = false;
+    return true;
+}
+#endif
+
 /* ----------
  * plpgsql_exec_function	Called by the call handler for
  *				function execution.
@@ -292,6 +321,15 @@ Datum plpgsql_exec_function(PLpgSQL_function* func, FunctionCallInfo fcinfo, boo
     int i;
     int rc;
 
+    func->fn_calls++;
+#ifdef ENABLE_LLVM_COMPILE
+    Datum native_result;
+
+    if (plpgsql_exec_native(func, fcinfo, &native_result)) {
+        return native_result;
+    }
+#endif
+
     /*
      * Setup the execution state
      */
@@ -600,6 +638,20 @@ Datum plpgsql_exec_function(PLpgSQL_function* func, FunctionCallInfo fcinfo, boo
         }
     }
 
+#ifdef ENABLE_LLVM_COMPILE
+    /*
+     * Compile the function once it is hot.  A function whose expressions have
+     * not all been planned yet is checked again every threshold calls.
+     */
+    if (func->fn_codegen_status == PLPGSQL_CODEGEN_NONE && func->fn_hashkey != NULL &&
+        u_sess->attr.attr_sql.plpgsql_codegen_threshold >= 0 &&
+        func->fn_calls >= (uint64)u_sess->attr.attr_sql.plpgsql_codegen_threshold &&
+        (func->fn_calls - u_sess->attr.attr_sql.plpgsql_codegen_threshold) %
+                Max(u_sess->attr.attr_sql.plpgsql_codegen_threshold, 1) == 0) {
+        PLpgSQLFunctionCodeGen(func);
+    }
+#endif
+
     estate.cursor_return_data = NULL;
     /* Clean up any leftover temporary memory */
     plpgsql_destroy_econtext(&estate);
@@ -645,6 +645,13 @@ void plpgsql_free_function_memory(PLpgSQL_function* func)
         pfree_ext(func->fn_searchpath);
     }
 
+#ifdef ENABLE_LLVM_COMPILE
+    /* Release the native code, the reason may live in fn_cxt */
+    PLpgSQLFunctionCodeGenRelease(func);
+#endif
+    func->fn_native = NULL;
+    func->fn_codegen_reason = NULL;
+
     /*
      * And finally, release all memory except the PLpgSQL_function struct
      * itself (which has to be kept around because there may be multiple
@@ -982,6 +982,8 @@ ServerTypeOption getServerType(Oid foreignTableId)
             srvType = T_HDFS_SERVER;
         } else if (0 == pg_strcasecmp(optionValue, DUMMY_SERVER)) {
             srvType = T_DUMMY_SERVER;
+        } else if (0 == pg_strcasecmp(optionValue, LOCAL_SERVER)) {
+            srvType = T_LOCAL_SERVER;
         }
     } else if (IsSpecifiedFDWFromRelid(foreignTableId, DIST_FDW) &&
                (is_obs_protocol(HdfsGetOptionValue(foreignTableId, optLocation)))) {
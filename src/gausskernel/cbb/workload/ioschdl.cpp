@@ -36,6 +36,7 @@
 #include "pgxc/execRemote.h"
 #include "storage/ipc.h"
 #include "storage/pmsignal.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/atomic.h"
 #include "utils/lsyscache.h"
@@ -1721,6 +1722,13 @@ int IsIOAvail(int count)
         WLMDNodeIOInfo* info = (WLMDNodeIOInfo*)u_sess->wlm_cxt->wlm_params.ioptr;
         UserData* userdata = (UserData*)info->userptr;
 
+        /*
+         * The token bucket holds the resource pool to its iops_limits at the block IO
+         * already, only a stricter io_limits of the query is left to check here.
+         */
+        bool pool_bucket = u_sess->attr.attr_resource.enable_io_token_bucket && userdata != NULL &&
+                           userdata->respool != NULL && userdata->respool->iops_limits;
+
         /*
          * check order:
          * 1. whether query has reached io_limits
@@ -1728,11 +1736,11 @@ int IsIOAvail(int count)
          * 3. whether query has reached io_limits calculated from io_priority
          * 4. whether user has reached io_limits calculated from io_priority
          */
-        if (info->iops_limits) {
+        if (info->iops_limits && !(pool_bucket && info->iops_limits >= userdata->respool->iops_limits)) {
             if (!IsIoLimitAvail(info->io_geninfo.io_count_persec, count, info->iops_limits)) {
                 return info->io_geninfo.tick_count_down;
             }
-        } else if (userdata != NULL && userdata->respool != NULL && userdata->respool->iops_limits) {
+        } else if (!pool_bucket && userdata != NULL && userdata->respool != NULL && userdata->respool->iops_limits) {
             if (!IsIoLimitAvail(userdata->ioinfo.io_count_persec, count, userdata->respool->iops_limits)) {
                 return userdata->ioinfo.tick_count_down;
             }
@@ -1879,6 +1887,114 @@ void IOSchedulerAndUpdate(int type, int count, int store_type)
     }
 }
 
+/*
+ * @Description: find the token bucket of a resource pool, taking a free one if needed.
+ *               The buckets are never released, dropped resource pools are few.
+ * @IN         : rpoid: resource pool oid
+ * @RETURN     : the bucket, NULL if all the buckets are taken by other resource pools
+ * @See also:
+ */
+static WLMIoBucket* WLMGetIoBucket(Oid rpoid)
+{
+    WLMIoBucket* buckets = g_instance.wlm_cxt->io_context.io_buckets;
+    int start = (int)(rpoid % WLM_IO_BUCKET_NUM);
+
+    for (int i = 0; i < WLM_IO_BUCKET_NUM; i++) {
+        WLMIoBucket* bucket = &buckets[(start + i) % WLM_IO_BUCKET_NUM];
+        Oid owner = *(volatile Oid*)&bucket->rpoid;
+
+        if (owner == rpoid) {
+            return bucket;
+        }
+
+        if (owner == InvalidOid) {
+            (void)gs_compare_and_swap_32((int32*)&bucket->rpoid, (int32)InvalidOid, (int32)rpoid);
+            if (*(volatile Oid*)&bucket->rpoid == rpoid) {
+                return bucket;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * @Description: take tokens from the bucket of the resource pool for the block IOs
+ *               of the buffer manager, temp files, column store CUs and relation
+ *               copies.  Bulk IO waits while the bucket is empty; interactive IO never
+ *               waits, it only leaves the bucket in debt so that bulk IO of the same
+ *               pool yields to it.  Bulk IO doesn't wait either while it holds LWLocks
+ *               or can't be interrupted.
+ * @IN         : type: IO type --- for extension and debug.
+ *             : ioclass: IO_CLASS_INTERACTIVE or IO_CLASS_BULK
+ *             : count: count of blocks
+ * @RETURN     : void
+ * @See also:
+ */
+void IOSchedulerConsumeTokens(int type, int ioclass, int count)
+{
+    RespoolData* rpdata = &u_sess->wlm_cxt->wlm_params.rpdata;
+    int64 limit = rpdata->iops_limits;
+    WLMIoBucket* bucket = NULL;
+    TimestampTz wait_start = 0;
+    bool can_wait = false;
+
+    if (!u_sess->attr.attr_resource.enable_io_token_bucket || !OidIsValid(rpdata->rpoid) || limit <= 0) {
+        return;
+    }
+
+    bucket = WLMGetIoBucket(rpdata->rpoid);
+    if (bucket == NULL) {
+        return;
+    }
+
+    can_wait = (ioclass == IO_CLASS_BULK && t_thrd.storage_cxt.num_held_lwlocks == 0 &&
+                t_thrd.int_cxt.CritSectionCount == 0 && t_thrd.int_cxt.InterruptHoldoffCount == 0);
+
+    for (;;) {
+        TimestampTz now = GetCurrentTimestamp();
+        int64 need = Min((int64)count, limit);
+        int64 wait = 0;
+
+        SpinLockAcquire(&bucket->mutex);
+
+        /* refill, keeping the time of the fraction of token not earned yet */
+        if (now - bucket->refill_time >= USECS_PER_SEC) {
+            bucket->tokens = limit;
+            bucket->refill_time = now;
+        } else if (now > bucket->refill_time) {
+            int64 earned = (now - bucket->refill_time) * limit / USECS_PER_SEC;
+
+            bucket->tokens = Min(bucket->tokens + earned, limit);
+            bucket->refill_time += earned * USECS_PER_SEC / limit;
+        }
+
+        if (!can_wait || bucket->tokens >= need) {
+            bucket->tokens = Max(bucket->tokens - count, -limit);
+        } else {
+            wait = (need - bucket->tokens) * USECS_PER_SEC / limit + 1;
+        }
+
+        SpinLockRelease(&bucket->mutex);
+
+        if (wait == 0) {
+            break;
+        }
+
+        if (wait_start == 0) {
+            wait_start = now;
+        }
+
+        CHECK_FOR_INTERRUPTS();
+        pg_usleep(Min(wait, WLM_IO_BUCKET_MAX_SLEEP));
+    }
+
+    /* report the time the query was held back */
+    if (wait_start != 0) {
+        pgstat_report_io_throttle(GetCurrentTimestamp() - wait_start);
+    }
+}
+
 /*
  * @Description: update IO read/write bytes for statistics
  * @IN         : type: read/write operation
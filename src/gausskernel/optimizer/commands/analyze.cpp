@@ -47,6 +47,7 @@
 #include "nodes/nodeFuncs.h"
 #include "nodes/plannodes.h"
 #include "nodes/print.h"
+#include "optimizer/cardfeedback.h"
 #include "parser/parse_oper.h"
 #include "parser/parse_relation.h"
 #include "parser/parse_type.h"
@@ -1605,6 +1606,9 @@ static void do_analyze_rel(Relation onerel, VacuumStmt* vacstmt, BlockNumber rel
         pgstat_report_analyze(onerel, totalrows, totaldeadrows);
     }
 
+    /* Corrections learnt against the old statistics no longer apply */
+    cardinality_feedback_expire(RelationGetRelid(onerel));
+
     /* If this isn't part of VACUUM ANALYZE, let index AMs do cleanup */
     if (!(vacstmt->options & VACOPT_VACUUM)) {
         for (ind = 0; ind < nindexes; ind++) {
@@ -35,6 +35,7 @@
 #include "catalog/pg_trigger.h"
 #endif
 #include "commands/copy.h"
+#include "commands/copy_parallel.h"
 #include "commands/defrem.h"
 #include "commands/trigger.h"
 #include "executor/executor.h"
@@ -1278,6 +1279,7 @@ void ProcessCopyOptions(CopyState cstate, bool is_from, List* options)
     bool ignore_extra_data_specified = false;
     bool compatible_illegal_chars_specified = false;
     bool rejectLimitSpecified = false;
+    bool parallel_specified = false;
 
     /* OBS copy options */
     bool obs_chunksize = false;
@@ -1520,6 +1522,16 @@ void ProcessCopyOptions(CopyState cstate, bool is_from, List* options)
             }
 
             rejectLimitSpecified = true;
+        } else if (strcmp(defel->defname, "parallel") == 0) {
+            if (parallel_specified)
+                ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("conflicting or redundant options")));
+            parallel_specified = true;
+            int64 workers = defGetInt64(defel);
+            if (workers < 0 || workers > COPY_PARALLEL_MAX_WORKERS)
+                ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("PARALLEL must be between 0 and %d", COPY_PARALLEL_MAX_WORKERS)));
+            cstate->parallel_workers = (int)workers;
         } else if (pg_strcasecmp(defel->defname, optChunkSize) == 0) {
             if (obs_chunksize) {
                 ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("conflicting or redundant options")));
@@ -1714,6 +1726,11 @@ void ProcessCopyOptions(CopyState cstate, bool is_from, List* options)
         ereport(ERROR,
             (errcode(ERRCODE_SYNTAX_ERROR),
                 errmsg("IGNORE_EXTRA_DATA specification only available using COPY FROM or READ ONLY foreign table")));
+    if (!is_from && parallel_specified)
+        ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("PARALLEL specification only available using COPY FROM")));
+    if (cstate->parallel_workers > 0 && !IS_TEXT(cstate) && !IS_CSV(cstate))
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("PARALLEL is only available for TEXT and CSV format")));
     if (!is_from && compatible_illegal_chars_specified)
         ereport(ERROR,
             (errcode(ERRCODE_SYNTAX_ERROR),
@@ -4893,6 +4910,10 @@ CopyState BeginCopyFrom(Relation rel, const char* filename, List* attnamelist, L
         cstate_fields_buffer_init(cstate);
     }
 
+    /* hand line splitting and field parsing over to helper threads if asked */
+    if (CopyParallelIsSupported(cstate))
+        CopyParallelBegin(cstate);
+
     (void)MemoryContextSwitchTo(oldcontext);
 
     /* workload client manager */
@@ -4931,6 +4952,9 @@ bool NextCopyFromRawFields(CopyState cstate, char*** fields, int* nfields)
     /* only available for text or csv input */
     Assert(!IS_BINARY(cstate));
 
+    if (cstate->parallel != NULL)
+        return CopyParallelNextRawFields(cstate, fields, nfields);
+
     /* on input just throw the header line away */
     if (cstate->cur_lineno == 0 && cstate->header_line) {
         cstate->cur_lineno++;
@@ -5489,6 +5513,9 @@ void EndCopyFrom(CopyState cstate)
         FreeRemoteCopyData(cstate->remoteCopyState);
 #endif
 
+    /* stop the parser threads before the input file goes away */
+    CopyParallelEnd(cstate);
+
     /* No COPY FROM related resources except memory. */
     EndCopy(cstate);
     cstate = NULL;
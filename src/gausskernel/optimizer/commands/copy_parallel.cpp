@@ -0,0 +1,1184 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * copy_parallel.cpp
+ *	  Parallel input parsing for COPY FROM a server side file.
+ *
+ * With COPY ... FROM 'file' (PARALLEL n) the input is handled by a small
+ * pipeline of helper threads:
+ *
+ *	- one reader thread reads the file in large blocks and cuts them into
+ *	  chunks that always end on a line (record) boundary;
+ *	- n parser threads split the chunks into lines, validate the encoding,
+ *	  split the lines into fields and de-escape them;
+ *	- the session thread consumes the parsed chunks strictly in input order,
+ *	  runs the type input functions and inserts the tuples through the
+ *	  usual CopyFrom() bulk insert buffers (heap_multi_insert).
+ *
+ * The helper threads are plain pthreads without any backend context, so
+ * they must never palloc, ereport or touch t_thrd/u_sess.  Everything they
+ * produce goes to malloc'd chunk buffers, and problems found on a line are
+ * only recorded there; the session thread raises the error when it reaches
+ * that line, so error messages carry the right line number and context and
+ * COPY error logging (log_errors/reject_limit) keeps working.
+ *
+ * IDENTIFICATION
+ *	  src/gausskernel/optimizer/commands/copy_parallel.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "access/xact.h"
+#include "commands/copy.h"
+#include "commands/copy_parallel.h"
+#include "mb/pg_wchar.h"
+#include "miscadmin.h"
+#include "pgxc/pgxc.h"
+
+/* bytes requested from the file per read call of the reader thread */
+#define COPY_PARALLEL_READ_SIZE (1024 * 1024)
+/* how long the session thread sleeps before re-checking for interrupts */
+#define COPY_PARALLEL_WAIT_MS 100
+
+#define ISOCTAL(c) (((c) >= '0') && ((c) <= '7'))
+#define OCTVALUE(c) ((c) - '0')
+
+typedef enum CopyChunkStatus {
+    COPY_CHUNK_FREE,    /* may be filled by the reader */
+    COPY_CHUNK_FILLED,  /* holds raw input, waiting for a parser */
+    COPY_CHUNK_PARSING, /* claimed by a parser thread */
+    COPY_CHUNK_PARSED   /* ready to be consumed by the session thread */
+} CopyChunkStatus;
+
+/* per-line problems detected by the parser threads, raised by the consumer */
+typedef enum CopyLineError {
+    COPY_LINE_OK,
+    COPY_LINE_BAD_ENCODING,       /* raw line is not valid in the server encoding */
+    COPY_LINE_BAD_FIELD_ENCODING, /* de-escaped field is not valid in the server encoding */
+    COPY_LINE_UNTERMINATED_QUOTE, /* CSV quoted field runs past end of line */
+    COPY_LINE_LITERAL_CR,         /* carriage return inside the data */
+    COPY_LINE_LITERAL_NL,         /* bare newline while lines end with \r\n or \r */
+    COPY_LINE_EXTRA_DATA          /* data for a table without columns */
+} CopyLineError;
+
+typedef struct CopyParsedLine {
+    uint32 lineno;       /* physical line (relative to chunk) the record ends on */
+    int rawOffset;       /* record start in chunk->data */
+    int rawLen;          /* record length without the terminator */
+    int firstField;      /* index of the first field in chunk->fields */
+    int nfields;         /* number of fields found */
+    CopyLineError error; /* problem found on the line, if any */
+    int errField;        /* field the error refers to */
+} CopyParsedLine;
+
+typedef struct CopyChunk {
+    CopyChunkStatus status;
+    uint64 seqno; /* position of the chunk in the input */
+    bool eof;     /* last chunk of the input */
+    bool oom;     /* parser could not get memory */
+
+    /* raw input, whole lines only */
+    char* data;
+    int len;
+    int cap;
+
+    /* parsed output */
+    uint32 newlines; /* line terminators seen in the chunk */
+    char* out;       /* de-escaped, NUL terminated field values */
+    int outLen;
+    int outCap;
+    int* fields; /* offsets into out, -1 for NULL */
+    int nfields;
+    int fieldsCap;
+    CopyParsedLine* lines;
+    int nlines;
+    int linesCap;
+} CopyChunk;
+
+typedef struct CopyParallelState {
+    /* parse parameters, read-only once the threads run */
+    FILE* file;
+    bool csvMode;
+    char delimc;
+    char* delim; /* private copies, the CopyState may die before the threads */
+    int delimLen;
+    char* nullPrint;
+    int nullPrintLen;
+    char quotec;
+    char escapec;
+    bool withoutEscaping;
+    int encoding;
+    bool verifyEncoding;
+    bool zeroColumns;
+    EolType eolType; /* decided by the reader before the first chunk is published */
+
+    /* pipeline */
+    int nworkers;
+    int nchunks;
+    CopyChunk* chunks;
+    pthread_t reader;
+    bool readerStarted;
+    pthread_t* workers;
+    int nworkersStarted;
+    pthread_mutex_t mutex;
+    pthread_cond_t readerCv;   /* a chunk became free */
+    pthread_cond_t workerCv;   /* a chunk was filled */
+    pthread_cond_t consumerCv; /* a chunk was parsed, or the reader stopped */
+    volatile bool shutdown;
+    uint64 nextFill;  /* next chunk the reader publishes */
+    uint64 nextParse; /* next chunk a parser may claim */
+    bool readFailed;
+    int readErrno;
+    bool readerOom;
+
+    /* consumer side, only touched by the session thread */
+    uint64 nextConsume;
+    CopyChunk* current;
+    int currentLine;
+    uint32 linenoBase;
+    bool headerPending;
+    bool done;
+
+    SubTransactionId subid;
+    struct CopyParallelState* next; /* session list, see AtEOXact_CopyParallel */
+} CopyParallelState;
+
+static void* CopyParallelReaderMain(void* arg);
+static void* CopyParallelWorkerMain(void* arg);
+static void CopyParallelShutdown(CopyParallelState* ps);
+
+/*
+ * @Description: check whether the COPY FROM described by cstate can run with
+ *    parallel parsing.  Anything that needs per-line state of the session
+ *    (protocol input, transcoding, illegal chars tolerance, user defined EOL,
+ *    coordinator redistribution) stays on the serial path.  Protocol input
+ *    is also the only one where the serial reader honors the \. end marker
+ *    and backslash escaped line ends, which the line cutting here ignores.
+ * @in cstate: COPY FROM state after the input file has been opened.
+ * @return: true if CopyParallelBegin() may be called.
+ */
+bool CopyParallelIsSupported(CopyState cstate)
+{
+    if (cstate->parallel_workers <= 0 || !cstate->is_from)
+        return false;
+    if (cstate->copy_dest != COPY_FILE || cstate->filename == NULL || cstate->copy_file == NULL)
+        return false;
+    if (!IS_TEXT(cstate) && !IS_CSV(cstate))
+        return false;
+    if (cstate->eol_type == EOL_UD || cstate->compatible_illegal_chars)
+        return false;
+    if (cstate->file_encoding != GetDatabaseEncoding() || cstate->encoding_embeds_ascii)
+        return false;
+    if (IS_PGXC_COORDINATOR)
+        return false;
+    return true;
+}
+
+static void CopyParallelWakeAll(CopyParallelState* ps)
+{
+    (void)pthread_cond_broadcast(&ps->readerCv);
+    (void)pthread_cond_broadcast(&ps->workerCv);
+    (void)pthread_cond_broadcast(&ps->consumerCv);
+}
+
+/*
+ * @Description: start the reader and parser threads for cstate.  The state
+ *    is malloc'd, not palloc'd, so that it stays valid until transaction
+ *    abort has stopped the threads no matter which memory context dies first.
+ * @in cstate: COPY FROM state accepted by CopyParallelIsSupported().
+ */
+void CopyParallelBegin(CopyState cstate)
+{
+    CopyParallelState* ps = NULL;
+    sigset_t blockAll;
+    sigset_t oldMask;
+    int rc;
+
+    ps = (CopyParallelState*)calloc(1, sizeof(CopyParallelState));
+    if (ps == NULL)
+        ereport(ERROR, (errcode(ERRCODE_OUT_OF_MEMORY), errmsg("out of memory")));
+
+    ps->file = cstate->copy_file;
+    ps->csvMode = IS_CSV(cstate);
+    ps->delimc = cstate->delim[0];
+    ps->delimLen = cstate->delim_len;
+    ps->nullPrintLen = cstate->null_print_len;
+    if (ps->csvMode) {
+        ps->quotec = cstate->quote[0];
+        ps->escapec = cstate->escape[0];
+    }
+    ps->withoutEscaping = cstate->without_escaping;
+    ps->encoding = GetDatabaseEncoding();
+    ps->verifyEncoding = (ps->encoding != PG_SQL_ASCII);
+    ps->zeroColumns = (cstate->max_fields <= 0);
+    ps->eolType = EOL_UNKNOWN;
+
+    ps->nworkers = Min(cstate->parallel_workers, COPY_PARALLEL_MAX_WORKERS);
+    ps->nchunks = 2 * ps->nworkers + 2;
+    ps->chunks = (CopyChunk*)calloc(ps->nchunks, sizeof(CopyChunk));
+    ps->workers = (pthread_t*)calloc(ps->nworkers, sizeof(pthread_t));
+    ps->delim = strdup(cstate->delim);
+    ps->nullPrint = strdup(cstate->null_print);
+    if (ps->chunks == NULL || ps->workers == NULL || ps->delim == NULL || ps->nullPrint == NULL) {
+        free(ps->chunks);
+        free(ps->workers);
+        free(ps->delim);
+        free(ps->nullPrint);
+        free(ps);
+        ereport(ERROR, (errcode(ERRCODE_OUT_OF_MEMORY), errmsg("out of memory")));
+    }
+
+    (void)pthread_mutex_init(&ps->mutex, NULL);
+    (void)pthread_cond_init(&ps->readerCv, NULL);
+    (void)pthread_cond_init(&ps->workerCv, NULL);
+    (void)pthread_cond_init(&ps->consumerCv, NULL);
+
+    ps->headerPending = cstate->header_line;
+    ps->linenoBase = 1;
+    ps->subid = GetCurrentSubTransactionId();
+    cstate->parallel = ps;
+
+    /* link it first, so an error below still gets the threads cleaned up */
+    ps->next = u_sess->cmd_cxt.copy_parallel_states;
+    u_sess->cmd_cxt.copy_parallel_states = ps;
+
+    /* helper threads must not take any of the signals meant for the session */
+    (void)sigfillset(&blockAll);
+    (void)pthread_sigmask(SIG_SETMASK, &blockAll, &oldMask);
+
+    rc = pthread_create(&ps->reader, NULL, CopyParallelReaderMain, ps);
+    ps->readerStarted = (rc == 0);
+    for (int i = 0; rc == 0 && i < ps->nworkers; i++) {
+        rc = pthread_create(&ps->workers[i], NULL, CopyParallelWorkerMain, ps);
+        if (rc == 0)
+            ps->nworkersStarted++;
+    }
+
+    (void)pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+
+    if (rc != 0) {
+        cstate->parallel = NULL;
+        CopyParallelShutdown(ps);
+        ereport(ERROR,
+            (errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+                errmsg("could not create parallel COPY thread: %s", gs_strerror(rc))));
+    }
+
+    ereport(DEBUG1,
+        (errmsg("COPY FROM \"%s\" uses %d parser threads", cstate->filename, ps->nworkers)));
+}
+
+/*
+ * @Description: stop the helper threads and release everything they own.
+ *    Must run in the session thread, with ps->mutex not held.  It does not
+ *    look at the CopyState, which may already be gone at transaction abort.
+ */
+static void CopyParallelShutdown(CopyParallelState* ps)
+{
+    CopyParallelState** link = NULL;
+
+    (void)pthread_mutex_lock(&ps->mutex);
+    ps->shutdown = true;
+    CopyParallelWakeAll(ps);
+    (void)pthread_mutex_unlock(&ps->mutex);
+
+    if (ps->readerStarted)
+        (void)pthread_join(ps->reader, NULL);
+    for (int i = 0; i < ps->nworkersStarted; i++)
+        (void)pthread_join(ps->workers[i], NULL);
+
+    for (int i = 0; i < ps->nchunks; i++) {
+        CopyChunk* chunk = &ps->chunks[i];
+
+        free(chunk->data);
+        free(chunk->out);
+        free(chunk->fields);
+        free(chunk->lines);
+    }
+
+    (void)pthread_cond_destroy(&ps->readerCv);
+    (void)pthread_cond_destroy(&ps->workerCv);
+    (void)pthread_cond_destroy(&ps->consumerCv);
+    (void)pthread_mutex_destroy(&ps->mutex);
+
+    for (link = &u_sess->cmd_cxt.copy_parallel_states; *link != NULL; link = &(*link)->next) {
+        if (*link == ps) {
+            *link = ps->next;
+            break;
+        }
+    }
+
+    free(ps->chunks);
+    free(ps->workers);
+    free(ps->delim);
+    free(ps->nullPrint);
+    free(ps);
+}
+
+/*
+ * @Description: normal end of a parallel COPY FROM, called before the input
+ *    file is closed.
+ */
+void CopyParallelEnd(CopyState cstate)
+{
+    if (cstate->parallel != NULL) {
+        CopyParallelShutdown(cstate->parallel);
+        cstate->parallel = NULL;
+    }
+}
+
+/*
+ * Transaction end: a still running pipeline means the COPY failed, so just
+ * stop the threads before AtEOXact_Files() closes the input file under them.
+ */
+void AtEOXact_CopyParallel(bool isCommit)
+{
+    while (u_sess->cmd_cxt.copy_parallel_states != NULL) {
+        CopyParallelState* ps = u_sess->cmd_cxt.copy_parallel_states;
+
+        if (isCommit)
+            ereport(WARNING, (errmsg("parallel COPY threads not stopped at commit")));
+        CopyParallelShutdown(ps);
+    }
+}
+
+void AtEOSubXact_CopyParallel(bool isCommit, SubTransactionId mySubid, SubTransactionId parentSubid)
+{
+    CopyParallelState* ps = u_sess->cmd_cxt.copy_parallel_states;
+
+    while (ps != NULL) {
+        CopyParallelState* next = ps->next;
+
+        if (ps->subid == mySubid) {
+            /* on subcommit the pipeline just belongs to the parent now */
+            if (isCommit)
+                ps->subid = parentSubid;
+            else
+                CopyParallelShutdown(ps);
+        }
+        ps = next;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Reader thread
+ * --------------------------------------------------------------------------
+ */
+
+static bool CopyChunkReserve(char** buf, int* cap, int need)
+{
+    char* newbuf = NULL;
+    int newcap;
+
+    if (need <= *cap)
+        return true;
+    newcap = Max(*cap, COPY_PARALLEL_READ_SIZE);
+    while (newcap < need) {
+        if (newcap > (INT_MAX / 2))
+            return false;
+        newcap *= 2;
+    }
+    newbuf = (char*)realloc(*buf, newcap);
+    if (newbuf == NULL)
+        return false;
+    *buf = newbuf;
+    *cap = newcap;
+    return true;
+}
+
+/*
+ * Scan data[*scanned, len) for record terminators.  Returns the offset just
+ * past the last complete record, or -1 when there is none, and advances
+ * *scanned to where the next call has to resume.
+ *
+ * As in CopyReadLineTextTemplate, the first unquoted \r or \n of the input
+ * decides whether records end with \n, \r\n or \r; a \r at the very end
+ * of the data is left for the next call, unless at eof, since it may be the
+ * first half of \r\n.  In CSV mode the quote state in *inQuote/*lastWasEsc
+ * carries over between calls; it is clean at every returned cut point, since
+ * cuts are only made outside quotes.
+ *
+ * Like the serial reader does for file input, text format gives backslashes
+ * no meaning here: a backslash before a line end does not continue the
+ * record and \. is ordinary data.  CopyParallelIsSupported() keeps the
+ * protocol input, where both are special, on the serial path.
+ */
+static int CopyParallelFindCut(CopyParallelState* ps, const char* data, int* scanned, int len, bool eof,
+    bool* inQuote, bool* lastWasEsc)
+{
+    char quotec = ps->quotec;
+    char escapec = (ps->escapec == ps->quotec) ? '\0' : ps->escapec;
+    bool inq = *inQuote;
+    bool esc = *lastWasEsc;
+    int cut = -1;
+    int i;
+
+    for (i = *scanned; i < len; i++) {
+        char c = data[i];
+
+        if (ps->csvMode) {
+            /* same state machine as CopyReadLineTextTemplate<true> */
+            if (inq && c == escapec)
+                esc = !esc;
+            if (c == quotec && !esc)
+                inq = !inq;
+            if (c != escapec)
+                esc = false;
+            if (inq)
+                continue;
+        }
+
+        if (ps->eolType == EOL_UNKNOWN) {
+            if (c == '\n') {
+                ps->eolType = EOL_NL;
+            } else if (c == '\r') {
+                if (i + 1 >= len && !eof)
+                    break;
+                ps->eolType = (i + 1 < len && data[i + 1] == '\n') ? EOL_CRNL : EOL_CR;
+            } else {
+                continue;
+            }
+        }
+
+        if (!ps->csvMode) {
+            /* nothing can hide a terminator in text format, take the last one */
+            char term = (ps->eolType == EOL_CR) ? '\r' : '\n';
+
+            for (int j = len - 1; j >= i; j--) {
+                if (data[j] == term) {
+                    cut = j + 1;
+                    break;
+                }
+            }
+            i = len;
+            break;
+        }
+
+        if (c == ((ps->eolType == EOL_CR) ? '\r' : '\n'))
+            cut = i + 1;
+    }
+    *scanned = i;
+    *inQuote = inq;
+    *lastWasEsc = esc;
+    return cut;
+}
+
+static void CopyParallelReaderFail(CopyParallelState* ps, int err, bool oom)
+{
+    (void)pthread_mutex_lock(&ps->mutex);
+    ps->readFailed = true;
+    ps->readErrno = err;
+    ps->readerOom = oom;
+    (void)pthread_cond_broadcast(&ps->consumerCv);
+    (void)pthread_mutex_unlock(&ps->mutex);
+}
+
+static void* CopyParallelReaderMain(void* arg)
+{
+    CopyParallelState* ps = (CopyParallelState*)arg;
+    char* carry = NULL;
+    int carryLen = 0;
+    int carryCap = 0;
+    uint64 seqno = 0;
+    bool eof = false;
+
+    while (!eof) {
+        CopyChunk* chunk = &ps->chunks[seqno % ps->nchunks];
+        bool inQuote = false;
+        bool lastWasEsc = false;
+        int scanned = 0;
+        int cut = -1;
+
+        (void)pthread_mutex_lock(&ps->mutex);
+        while (!ps->shutdown && chunk->status != COPY_CHUNK_FREE)
+            (void)pthread_cond_wait(&ps->readerCv, &ps->mutex);
+        (void)pthread_mutex_unlock(&ps->mutex);
+        if (ps->shutdown)
+            break;
+
+        /* start with whatever the previous chunk left over */
+        chunk->len = 0;
+        if (carryLen > 0) {
+            if (!CopyChunkReserve(&chunk->data, &chunk->cap, carryLen + 1)) {
+                CopyParallelReaderFail(ps, 0, true);
+                break;
+            }
+            memcpy(chunk->data, carry, carryLen);
+            chunk->len = carryLen;
+            carryLen = 0;
+        }
+
+        for (;;) {
+            size_t nread;
+
+            cut = CopyParallelFindCut(ps, chunk->data, &scanned, chunk->len, eof, &inQuote, &lastWasEsc);
+            if (cut > 0 || eof)
+                break;
+
+            if (!CopyChunkReserve(&chunk->data, &chunk->cap, chunk->len + COPY_PARALLEL_READ_SIZE + 1)) {
+                CopyParallelReaderFail(ps, 0, true);
+                goto done;
+            }
+            nread = fread(chunk->data + chunk->len, 1, COPY_PARALLEL_READ_SIZE, ps->file);
+            if (nread == 0) {
+                if (ferror(ps->file)) {
+                    CopyParallelReaderFail(ps, errno, false);
+                    goto done;
+                }
+                eof = true;
+            }
+            chunk->len += (int)nread;
+            if (ps->shutdown)
+                goto done;
+        }
+
+        /* keep the partial last record for the next chunk */
+        if (!eof && cut < chunk->len) {
+            carryLen = chunk->len - cut;
+            if (!CopyChunkReserve(&carry, &carryCap, carryLen)) {
+                CopyParallelReaderFail(ps, 0, true);
+                break;
+            }
+            memcpy(carry, chunk->data + cut, carryLen);
+            chunk->len = cut;
+        }
+        chunk->data[chunk->len] = '\0';
+
+        /* input without any line end is a single record */
+        if (ps->eolType == EOL_UNKNOWN)
+            ps->eolType = EOL_NL;
+
+        (void)pthread_mutex_lock(&ps->mutex);
+        chunk->seqno = seqno++;
+        chunk->eof = eof;
+        chunk->status = COPY_CHUNK_FILLED;
+        ps->nextFill = seqno;
+        (void)pthread_cond_broadcast(&ps->workerCv);
+        (void)pthread_mutex_unlock(&ps->mutex);
+    }
+
+done:
+    free(carry);
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * Parser threads
+ * --------------------------------------------------------------------------
+ */
+
+/* pg_verify_mbstr() without the session state; no ereport, no palloc */
+static bool CopyParallelVerifyMb(const CopyParallelState* ps, const char* s, int len)
+{
+    if (pg_encoding_max_length(ps->encoding) <= 1)
+        return memchr(s, '\0', len) == NULL;
+
+    while (len > 0) {
+        int l;
+
+        if (!IS_HIGHBIT_SET(*s)) {
+            if (*s == '\0')
+                return false;
+            s++;
+            len--;
+            continue;
+        }
+        l = pg_encoding_verifymb(ps->encoding, s, len);
+        if (l < 0)
+            return false;
+        s += l;
+        len -= l;
+    }
+    return true;
+}
+
+static bool CopyChunkAddField(CopyChunk* chunk, int offset)
+{
+    if (chunk->nfields >= chunk->fieldsCap) {
+        int newcap = Max(chunk->fieldsCap * 2, 1024);
+        int* fields = (int*)realloc(chunk->fields, newcap * sizeof(int));
+
+        if (fields == NULL)
+            return false;
+        chunk->fields = fields;
+        chunk->fieldsCap = newcap;
+    }
+    chunk->fields[chunk->nfields++] = offset;
+    return true;
+}
+
+static inline bool CopyParallelIsDelim(const CopyParallelState* ps, const char* p, const char* end)
+{
+    if (*p != ps->delimc)
+        return false;
+    if (ps->delimLen == 1)
+        return true;
+    return (end - p) >= ps->delimLen && strncmp(p, ps->delim, ps->delimLen) == 0;
+}
+
+/*
+ * Split one text format line into fields; the same rules as
+ * CopyReadAttributesTextT.  Returns false only when out of memory.
+ */
+static bool CopyParallelSplitText(CopyParallelState* ps, CopyChunk* chunk, const char* line, int len,
+    CopyParsedLine* pl)
+{
+    const char* cur = line;
+    const char* end = line + len;
+    char* out = chunk->out + chunk->outLen;
+    bool isGbk = (ps->encoding == PG_GBK);
+
+    for (;;) {
+        const char* start = cur;
+        const char* fend = NULL;
+        char* fieldStart = out;
+        bool foundDelim = false;
+        bool sawNonAscii = false;
+
+        for (;;) {
+            char c;
+
+            fend = cur;
+            if (cur >= end)
+                break;
+            if (CopyParallelIsDelim(ps, cur, end)) {
+                cur += ps->delimLen;
+                foundDelim = true;
+                break;
+            }
+            c = *cur++;
+            if (c == '\\' && !ps->withoutEscaping) {
+                if (cur >= end)
+                    break;
+                c = *cur++;
+                switch (c) {
+                    case '0':
+                    case '1':
+                    case '2':
+                    case '3':
+                    case '4':
+                    case '5':
+                    case '6':
+                    case '7': {
+                        int val = OCTVALUE(c);
+
+                        if (cur < end && ISOCTAL(*cur)) {
+                            val = (val << 3) + OCTVALUE(*cur++);
+                            if (cur < end && ISOCTAL(*cur))
+                                val = (val << 3) + OCTVALUE(*cur++);
+                        }
+                        c = val & 0377;
+                        if (c == '\0' || IS_HIGHBIT_SET(c))
+                            sawNonAscii = true;
+                    } break;
+                    case 'x':
+                        if (cur < end && isxdigit((unsigned char)*cur)) {
+                            int val = GetDecimalFromHex(*cur++);
+
+                            if (cur < end && isxdigit((unsigned char)*cur))
+                                val = (val << 4) + GetDecimalFromHex(*cur++);
+                            c = val & 0xff;
+                            if (c == '\0' || IS_HIGHBIT_SET(c))
+                                sawNonAscii = true;
+                        }
+                        break;
+                    case 'b':
+                        c = '\b';
+                        break;
+                    case 'f':
+                        c = '\f';
+                        break;
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    case 'v':
+                        c = '\v';
+                        break;
+                    default:
+                        break;
+                }
+            }
+            *out++ = c;
+            /* second byte of a GBK character may look like a delimiter */
+            if (isGbk && IS_HIGHBIT_SET(c) && cur < end)
+                *out++ = *cur++;
+        }
+
+        if ((int)(fend - start) == ps->nullPrintLen && strncmp(start, ps->nullPrint, ps->nullPrintLen) == 0) {
+            out = fieldStart;
+            if (!CopyChunkAddField(chunk, -1))
+                return false;
+        } else {
+            if (sawNonAscii && pl->error == COPY_LINE_OK && ps->verifyEncoding &&
+                !CopyParallelVerifyMb(ps, fieldStart, (int)(out - fieldStart))) {
+                pl->error = COPY_LINE_BAD_FIELD_ENCODING;
+                pl->errField = pl->nfields;
+            }
+            *out++ = '\0';
+            if (!CopyChunkAddField(chunk, (int)(fieldStart - chunk->out)))
+                return false;
+        }
+        pl->nfields++;
+
+        if (!foundDelim)
+            break;
+    }
+
+    chunk->outLen = (int)(out - chunk->out);
+    return true;
+}
+
+/*
+ * Split one CSV record into fields; the same rules as CopyReadAttributesCSVT.
+ * Returns false only when out of memory.
+ */
+static bool CopyParallelSplitCSV(CopyParallelState* ps, CopyChunk* chunk, const char* line, int len,
+    CopyParsedLine* pl)
+{
+    const char* cur = line;
+    const char* end = line + len;
+    char* out = chunk->out + chunk->outLen;
+    char quotec = ps->quotec;
+    char escapec = ps->escapec;
+
+    for (;;) {
+        const char* start = cur;
+        const char* fend = NULL;
+        char* fieldStart = out;
+        bool foundDelim = false;
+        bool sawQuote = false;
+
+        for (;;) {
+            char c;
+
+            /* not in quote */
+            for (;;) {
+                fend = cur;
+                if (cur >= end)
+                    goto endfield;
+                if (CopyParallelIsDelim(ps, cur, end)) {
+                    cur += ps->delimLen;
+                    foundDelim = true;
+                    goto endfield;
+                }
+                c = *cur++;
+                if (c == quotec) {
+                    sawQuote = true;
+                    break;
+                }
+                *out++ = c;
+            }
+
+            /* in quote */
+            for (;;) {
+                fend = cur;
+                if (cur >= end) {
+                    if (pl->error == COPY_LINE_OK)
+                        pl->error = COPY_LINE_UNTERMINATED_QUOTE;
+                    goto endfield;
+                }
+                c = *cur++;
+                if (c == escapec && cur < end && (*cur == escapec || *cur == quotec)) {
+                    *out++ = *cur++;
+                    continue;
+                }
+                if (c == quotec)
+                    break;
+                *out++ = c;
+            }
+        }
+    endfield:
+        *out++ = '\0';
+        if (!sawQuote && (int)(fend - start) == ps->nullPrintLen &&
+            strncmp(start, ps->nullPrint, ps->nullPrintLen) == 0) {
+            if (!CopyChunkAddField(chunk, -1))
+                return false;
+        } else {
+            if (!CopyChunkAddField(chunk, (int)(fieldStart - chunk->out)))
+                return false;
+        }
+        pl->nfields++;
+
+        if (!foundDelim || pl->error == COPY_LINE_UNTERMINATED_QUOTE)
+            break;
+    }
+
+    chunk->outLen = (int)(out - chunk->out);
+    return true;
+}
+
+/*
+ * Find the end of the record starting at data[pos].  Sets *recEnd to the
+ * offset of the terminating '\n' ('\r' for EOL_CR input, or len), and returns
+ * the number of line ends embedded in quoted CSV fields.  *eolError reports
+ * an unquoted carriage return or newline that is not part of the line end
+ * style of the input.
+ */
+static uint32 CopyParallelRecordEnd(const CopyParallelState* ps, const char* data, int pos, int len, int* recEnd,
+    CopyLineError* eolError)
+{
+    uint32 embedded = 0;
+    bool crlf = (ps->eolType == EOL_CRNL);
+    char term = (ps->eolType == EOL_CR) ? '\r' : '\n';
+    char stray = (ps->eolType == EOL_CR) ? '\n' : '\r';
+    CopyLineError strayError = (ps->eolType == EOL_CR) ? COPY_LINE_LITERAL_NL : COPY_LINE_LITERAL_CR;
+
+    *eolError = COPY_LINE_OK;
+    if (!ps->csvMode) {
+        const char* nl = (const char*)memchr(data + pos, term, len - pos);
+        int e = (nl != NULL) ? (int)(nl - data) : len;
+        int scanLen = e - pos;
+
+        if (crlf && nl != NULL && scanLen > 0 && data[e - 1] == '\r')
+            scanLen--;
+        if (memchr(data + pos, stray, scanLen) != NULL)
+            *eolError = strayError;
+        *recEnd = e;
+        return 0;
+    }
+
+    char quotec = ps->quotec;
+    char escapec = (ps->escapec == ps->quotec) ? '\0' : ps->escapec;
+    bool inQuote = false;
+    bool lastWasEsc = false;
+    int i;
+
+    for (i = pos; i < len; i++) {
+        char c = data[i];
+
+        if (inQuote && c == escapec)
+            lastWasEsc = !lastWasEsc;
+        if (c == quotec && !lastWasEsc)
+            inQuote = !inQuote;
+        if (c != escapec)
+            lastWasEsc = false;
+
+        if (c == term) {
+            if (!inQuote)
+                break;
+            embedded++;
+        } else if (c == stray && !inQuote) {
+            if (!(crlf && i + 1 < len && data[i + 1] == '\n'))
+                *eolError = strayError;
+        }
+    }
+    *recEnd = i;
+    return embedded;
+}
+
+/* parse every record in the chunk; returns false when out of memory */
+static bool CopyParallelParseChunk(CopyParallelState* ps, CopyChunk* chunk)
+{
+    int pos = 0;
+    uint32 newlines = 0;
+    int needOut = 2 * chunk->len + 2;
+
+    chunk->nlines = 0;
+    chunk->nfields = 0;
+    chunk->outLen = 0;
+
+    /* de-escaped data plus one terminator per field never exceeds this */
+    if (!CopyChunkReserve(&chunk->out, &chunk->outCap, needOut))
+        return false;
+
+    while (pos < chunk->len) {
+        CopyParsedLine* pl = NULL;
+        int recEnd;
+        int rawLen;
+        CopyLineError eolError = COPY_LINE_OK;
+        uint32 embedded;
+
+        if (chunk->nlines >= chunk->linesCap) {
+            int newcap = Max(chunk->linesCap * 2, 256);
+            CopyParsedLine* lines = (CopyParsedLine*)realloc(chunk->lines, newcap * sizeof(CopyParsedLine));
+
+            if (lines == NULL)
+                return false;
+            chunk->lines = lines;
+            chunk->linesCap = newcap;
+        }
+
+        embedded = CopyParallelRecordEnd(ps, chunk->data, pos, chunk->len, &recEnd, &eolError);
+        rawLen = recEnd - pos;
+        pl = &chunk->lines[chunk->nlines++];
+        pl->lineno = newlines + embedded;
+        pl->rawOffset = pos;
+        pl->firstField = chunk->nfields;
+        pl->nfields = 0;
+        pl->error = COPY_LINE_OK;
+        pl->errField = -1;
+
+        if (recEnd < chunk->len && ps->eolType == EOL_CRNL) {
+            if (rawLen > 0 && chunk->data[recEnd - 1] == '\r')
+                rawLen--;
+            else
+                pl->error = COPY_LINE_LITERAL_NL;
+        }
+        pl->rawLen = rawLen;
+
+        if (pl->error == COPY_LINE_OK)
+            pl->error = eolError;
+        if (pl->error == COPY_LINE_OK && ps->verifyEncoding &&
+            !CopyParallelVerifyMb(ps, chunk->data + pos, rawLen))
+            pl->error = COPY_LINE_BAD_ENCODING;
+
+        if (pl->error == COPY_LINE_OK) {
+            if (ps->zeroColumns) {
+                if (rawLen != 0)
+                    pl->error = COPY_LINE_EXTRA_DATA;
+            } else if (ps->csvMode) {
+                if (!CopyParallelSplitCSV(ps, chunk, chunk->data + pos, rawLen, pl))
+                    return false;
+            } else {
+                if (!CopyParallelSplitText(ps, chunk, chunk->data + pos, rawLen, pl))
+                    return false;
+            }
+        }
+
+        newlines += embedded + 1;
+        pos = recEnd + 1;
+    }
+
+    chunk->newlines = newlines;
+    return true;
+}
+
+static void* CopyParallelWorkerMain(void* arg)
+{
+    CopyParallelState* ps = (CopyParallelState*)arg;
+
+    for (;;) {
+        CopyChunk* chunk = NULL;
+        bool ok = false;
+
+        (void)pthread_mutex_lock(&ps->mutex);
+        for (;;) {
+            if (ps->shutdown)
+                break;
+            chunk = &ps->chunks[ps->nextParse % ps->nchunks];
+            if (chunk->status == COPY_CHUNK_FILLED && chunk->seqno == ps->nextParse) {
+                chunk->status = COPY_CHUNK_PARSING;
+                ps->nextParse++;
+                break;
+            }
+            chunk = NULL;
+            (void)pthread_cond_wait(&ps->workerCv, &ps->mutex);
+        }
+        (void)pthread_mutex_unlock(&ps->mutex);
+        if (chunk == NULL)
+            break;
+
+        ok = CopyParallelParseChunk(ps, chunk);
+
+        (void)pthread_mutex_lock(&ps->mutex);
+        chunk->oom = !ok;
+        chunk->status = COPY_CHUNK_PARSED;
+        (void)pthread_cond_broadcast(&ps->consumerCv);
+        (void)pthread_mutex_unlock(&ps->mutex);
+    }
+
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * Consumer side (session thread)
+ * --------------------------------------------------------------------------
+ */
+
+/*
+ * Give the current chunk back to the reader and wait for the next one in
+ * input order.  Returns false at the end of the input.
+ */
+static bool CopyParallelNextChunk(CopyParallelState* ps)
+{
+    CopyChunk* chunk = NULL;
+    bool readFailed = false;
+
+    if (ps->current != NULL) {
+        bool wasLast = ps->current->eof;
+
+        ps->linenoBase += ps->current->newlines;
+        (void)pthread_mutex_lock(&ps->mutex);
+        ps->current->status = COPY_CHUNK_FREE;
+        (void)pthread_cond_signal(&ps->readerCv);
+        (void)pthread_mutex_unlock(&ps->mutex);
+        ps->current = NULL;
+        if (wasLast)
+            ps->done = true;
+    }
+    if (ps->done)
+        return false;
+
+    chunk = &ps->chunks[ps->nextConsume % ps->nchunks];
+    (void)pthread_mutex_lock(&ps->mutex);
+    while (!(chunk->status == COPY_CHUNK_PARSED && chunk->seqno == ps->nextConsume)) {
+        struct timeval now;
+        struct timespec deadline;
+
+        if (ps->readFailed && ps->nextFill <= ps->nextConsume) {
+            readFailed = true;
+            break;
+        }
+
+        (void)gettimeofday(&now, NULL);
+        deadline.tv_sec = now.tv_sec;
+        deadline.tv_nsec = (now.tv_usec + COPY_PARALLEL_WAIT_MS * 1000L) * 1000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        (void)pthread_cond_timedwait(&ps->consumerCv, &ps->mutex, &deadline);
+
+        /* never take an interrupt while holding the mutex */
+        (void)pthread_mutex_unlock(&ps->mutex);
+        CHECK_FOR_INTERRUPTS();
+        (void)pthread_mutex_lock(&ps->mutex);
+    }
+    (void)pthread_mutex_unlock(&ps->mutex);
+
+    if (readFailed) {
+        if (ps->readerOom)
+            ereport(ERROR, (errcode(ERRCODE_OUT_OF_MEMORY), errmsg("out of memory"),
+                    errdetail("Failed on reading COPY file in parallel mode.")));
+        errno = ps->readErrno;
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not read from COPY file: %m")));
+    }
+    if (chunk->oom)
+        ereport(ERROR, (errcode(ERRCODE_OUT_OF_MEMORY), errmsg("out of memory"),
+                errdetail("Failed on parsing COPY file in parallel mode.")));
+
+    ps->nextConsume++;
+    ps->current = chunk;
+    ps->currentLine = 0;
+    return true;
+}
+
+/* raise the error the parser thread recorded for this line */
+static void CopyParallelReportLineError(CopyState cstate, const CopyChunk* chunk, const CopyParsedLine* pl)
+{
+    switch (pl->error) {
+        case COPY_LINE_OK:
+            break;
+        case COPY_LINE_BAD_ENCODING:
+            /* produces the standard message for the offending byte sequence */
+            (void)pg_verifymbstr(cstate->line_buf.data, cstate->line_buf.len, false);
+            break;
+        case COPY_LINE_BAD_FIELD_ENCODING: {
+            const char* fld = chunk->out + chunk->fields[pl->firstField + pl->errField];
+
+            (void)pg_verifymbstr(fld, strlen(fld), false);
+            break;
+        }
+        case COPY_LINE_UNTERMINATED_QUOTE:
+            ereport(ERROR, (errcode(ERRCODE_BAD_COPY_FILE_FORMAT), errmsg("unterminated CSV quoted field")));
+            break;
+        case COPY_LINE_LITERAL_CR:
+            /* the line boundaries can't be trusted any more, never log this one as a bad line */
+            cstate->log_errors = false;
+            cstate->logErrorsData = false;
+            ereport(ERROR,
+                (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                    !IS_CSV(cstate) ? errmsg("literal carriage return found in data")
+                                    : errmsg("unquoted carriage return found in data"),
+                    !IS_CSV(cstate) ? errhint("Use \"\\r\" to represent carriage return.")
+                                    : errhint("Use quoted CSV field to represent carriage return.")));
+            break;
+        case COPY_LINE_LITERAL_NL:
+            cstate->log_errors = false;
+            cstate->logErrorsData = false;
+            ereport(ERROR,
+                (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                    !IS_CSV(cstate) ? errmsg("literal newline found in data")
+                                    : errmsg("unquoted newline found in data"),
+                    !IS_CSV(cstate) ? errhint("Use \"\\n\" to represent newline.")
+                                    : errhint("Use quoted CSV field to represent newline.")));
+            break;
+        case COPY_LINE_EXTRA_DATA:
+            ereport(ERROR, (errcode(ERRCODE_BAD_COPY_FILE_FORMAT), errmsg("extra data after last expected column")));
+            break;
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR), errmsg("unrecognized parallel COPY line state %d", pl->error)));
+            break;
+    }
+}
+
+/*
+ * @Description: parallel counterpart of reading a line and running
+ *    readAttrsFunc; the API is that of NextCopyFromRawFields().  The line is
+ *    consumed before any error for it is raised, so a caller that tolerates
+ *    the error continues with the next line.
+ * @in cstate: COPY FROM state with a running pipeline.
+ * @out fields: raw field values, NULL for the null marker.
+ * @out nfields: number of fields found on the line.
+ * @return: false at the end of the input.
+ */
+bool CopyParallelNextRawFields(CopyState cstate, char*** fields, int* nfields)
+{
+    CopyParallelState* ps = cstate->parallel;
+
+    for (;;) {
+        const CopyChunk* chunk = NULL;
+        const CopyParsedLine* pl = NULL;
+
+        if (ps->current == NULL || ps->currentLine >= ps->current->nlines) {
+            if (!CopyParallelNextChunk(ps))
+                return false;
+            continue;
+        }
+
+        chunk = ps->current;
+        pl = &chunk->lines[ps->currentLine++];
+
+        cstate->cur_lineno = ps->linenoBase + pl->lineno;
+        resetStringInfo(&cstate->line_buf);
+        appendBinaryStringInfo(&cstate->line_buf, chunk->data + pl->rawOffset, pl->rawLen);
+        cstate->line_buf_converted = (pl->error != COPY_LINE_BAD_ENCODING);
+
+        /* on input just throw the header line away */
+        if (ps->headerPending) {
+            ps->headerPending = false;
+            continue;
+        }
+
+        CopyParallelReportLineError(cstate, chunk, pl);
+
+        if (pl->nfields > cstate->max_fields) {
+            cstate->max_fields = pl->nfields;
+            cstate->raw_fields = (char**)repalloc(cstate->raw_fields, cstate->max_fields * sizeof(char*));
+        }
+        for (int i = 0; i < pl->nfields; i++) {
+            int offset = chunk->fields[pl->firstField + i];
+
+            cstate->raw_fields[i] = (offset < 0) ? NULL : (chunk->out + offset);
+        }
+
+        *fields = cstate->raw_fields;
+        *nfields = pl->nfields;
+        return true;
+    }
+}
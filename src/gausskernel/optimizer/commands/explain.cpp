@@ -1643,6 +1643,47 @@ static void show_pruning_info(PlanState* planstate, ExplainState* es, bool is_pr
     }
 }
 
+/*
+ * Show how many partitions the PartIterator pruned at execution: the number
+ * pruned at executor start for extern params, or the average per scan for
+ * exec params, which is known only after the query ran.
+ */
+static void show_runtime_pruning_info(PartIteratorState* planstate, ExplainState* es, bool is_pretty)
+{
+    PartIterator* plan = (PartIterator*)planstate->ps.plan;
+    double pruned;
+
+    if (plan->pruningQuals == NIL || planstate->activeItrIndexes == NULL) {
+        return;
+    }
+
+    if (!planstate->pruneOnScan) {
+        pruned = planstate->nprunedItrs;
+    } else if (es->analyze && planstate->ps.instrument != NULL && planstate->ps.instrument->nloops > 0) {
+        pruned = planstate->nprunedItrs / planstate->ps.instrument->nloops;
+    } else {
+        return;
+    }
+
+    if (es->format == EXPLAIN_FORMAT_TEXT) {
+        if (is_pretty == false) {
+            if (es->wlm_statistics_plan_max_digit) {
+                appendStringInfoSpaces(es->str, *es->wlm_statistics_plan_max_digit);
+                appendStringInfoString(es->str, " | ");
+                appendStringInfoSpaces(es->str, es->indent);
+            } else {
+                appendStringInfoSpaces(es->str, es->indent * 2);
+            }
+            appendStringInfo(es->str, "Partitions Pruned at Runtime: %.0f\n", pruned);
+        } else {
+            es->planinfo->m_detailInfo->set_plan_name<true, true>();
+            appendStringInfo(es->planinfo->m_detailInfo->info_str, "Partitions Pruned at Runtime: %.0f\n", pruned);
+        }
+    } else {
+        ExplainPropertyFloat("Partitions Pruned at Runtime", pruned, 0, es);
+    }
+}
+
 #ifndef ENABLE_MULTIPLE_NODES
  static inline void PredAppendInfo(Plan* plan, StringInfoData buf, ExplainState* es)
  {
@@ -2732,6 +2773,10 @@ static void ExplainNode(
             } else {
                 ExplainPropertyInteger("Iterations", ((PartIterator*)plan)->itrs, es);
             }
+
+            if (IsA(plan, PartIterator)) {
+                show_runtime_pruning_info((PartIteratorState*)planstate, es, is_pretty);
+            }
             break;
 
         default:
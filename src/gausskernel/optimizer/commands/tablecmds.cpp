@@ -101,6 +101,7 @@
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
 #include "storage/lock.h"
+#include "storage/page_compression.h"
 #include "storage/predicate.h"
 #include "storage/remote_read.h"
 #include "storage/smgr.h"
@@ -12614,7 +12615,11 @@ static void atexecset_table_space_internal(Relation rel, Oid newTableSpace, Oid
      * NOTE: any conflict in relfilenode value will be caught in
      * RelationCreateStorage function.
      */
-    RelationCreateStorage(newrnode, rel->rd_rel->relpersistence, rel->rd_rel->relowner, rel->rd_bucketoid);
+    RelationCreateStorage(newrnode,
+        rel->rd_rel->relpersistence,
+        rel->rd_rel->relowner,
+        rel->rd_bucketoid,
+        RelationGetPageCompressOpt(rel));
 
     /* copy main fork */
     copy_relation_data(rel, &dstrel, MAIN_FORKNUM, rel->rd_rel->relpersistence);
@@ -12854,6 +12859,7 @@ static void copy_relation_data(Relation rel, SMgrRelation* dstptr, ForkNumber fo
         /* If we got a cancel signal during the copy of the data, quit */
         CHECK_FOR_INTERRUPTS();
 
+        IOSchedulerConsumeTokens(IO_TYPE_READ, IO_CLASS_BULK, 1);
         smgrread(src, forkNum, blkno, buf);
 
         if (!PageIsVerified(page, blkno)) {
@@ -12898,6 +12904,7 @@ static void copy_relation_data(Relation rel, SMgrRelation* dstptr, ForkNumber fo
 
         PageSetChecksumInplace((Page)bufToWrite, blkno);
 
+        IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, 1);
         smgrextend(dst, forkNum, blkno, bufToWrite, true);
     }
 
@@ -12981,6 +12988,7 @@ static void mergeHeapBlock(Relation src, Relation dest, ForkNumber forkNum, char
         CHECK_FOR_INTERRUPTS();
 
         RelationOpenSmgr(src);
+        IOSchedulerConsumeTokens(IO_TYPE_READ, IO_CLASS_BULK, 1);
         smgrread(src->rd_smgr, forkNum, src_blkno, buf);
 
         if (!PageIsVerified(page, src_blkno)) {
@@ -13106,6 +13114,7 @@ static void mergeHeapBlock(Relation src, Relation dest, ForkNumber forkNum, char
         /* heap block mix in the block number to checksum. need recalculate */
         PageSetChecksumInplace((Page)bufToWrite, dest_blkno);
 
+        IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, 1);
         smgrextend(dest->rd_smgr, forkNum, dest_blkno, bufToWrite, true);
     }
 
@@ -11,17 +11,20 @@
  * on the number of tuples and pages we will keep track of at once.
  *
  * We are willing to use at most maintenance_work_mem memory space to keep
- * track of dead tuples.  We initially allocate an array of TIDs of that size,
- * with an upper limit that depends on table size (this limit ensures we don't
- * allocate a huge area uselessly for vacuuming small tables).	If the array
- * threatens to overflow, we suspend the heap scan phase and perform a pass of
- * index cleanup and page compaction, then resume the heap scan with an empty
- * TID array.
+ * track of dead tuples.  The TIDs are kept in a store keyed by heap block,
+ * holding a bitmap of dead line pointers per block, which grows as blocks
+ * with dead tuples are found.  If the store threatens to overflow, we suspend
+ * the heap scan phase and perform a pass of index cleanup and page
+ * compaction, then resume the heap scan with an empty store.
  *
  * If we're processing a table with no indexes, we can just vacuum each page
  * as we go; there's no need to save up multiple tuples to minimize the number
  * of index scans performed.  So we don't use maintenance_work_mem memory for
- * the TID array, just enough to hold as many heap tuples as fit on one page.
+ * the store, just enough to hold the dead tuples of one page.
+ *
+ * When vacuum_index_parallel_workers allows it, the indexes of a relation
+ * are vacuumed by worker threads alongside the vacuum itself; see
+ * lazy_vacuum_indexes().
  *
  *
  * Portions Copyright (c) 2020 Huawei Technologies Co.,Ltd.
@@ -45,23 +48,39 @@
 #include "access/heapam.h"
 #include "access/transam.h"
 #include "access/visibilitymap.h"
+#include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/catalog.h"
 #include "catalog/storage.h"
+#include "catalog/pg_am.h"
 #include "catalog/pg_hashbucket_fn.h"
 #include "commands/dbcommands.h"
 #include "commands/vacuum.h"
+#include "gssignal/gs_signal.h"
+#include "libpq/pqsignal.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "portability/instr_time.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgwriter.h"
+#include "postmaster/postmaster.h"
 #include "storage/bufmgr.h"
 #include "storage/freespace.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
 #include "storage/lmgr.h"
+#include "storage/pmsignal.h"
+#include "storage/proc.h"
+#include "storage/procarray.h"
+#include "storage/procsignal.h"
+#include "tcop/tcopprot.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/pg_rusage.h"
+#include "utils/postinit.h"
+#include "utils/ps_status.h"
+#include "utils/rel_gs.h"
 #include "utils/snapmgr.h"
 #include "utils/timestamp.h"
 #include "utils/tqual.h"
@@ -73,13 +92,6 @@
 #include "pgxc/pgxc.h"
 #endif
 
-/*
- * Guesstimation of number of dead tuples per page.  This is used to
- * provide an upper limit to memory allocated when vacuuming small
- * tables.
- */
-#define LAZY_ALLOC_TUPLES MaxHeapTuplesPerPage
-
 /*
  * Before we consider skipping a page that's marked as clean in
  * visibility map, we must've seen at least this many clean pages.
@@ -87,6 +99,46 @@
 #define SKIP_PAGES_THRESHOLD ((BlockNumber)32)
 
 #define CHANGE_XID_BASE (MaxShortTransactionId * 0.1)
+
+/*
+ * Dead tuple TIDs are remembered per heap block: every block with dead
+ * tuples has an LVDeadBlock entry pointing at a bitmap of its dead line
+ * pointers, and a directory indexed by block number leads from a TID to the
+ * entry of its block.  The directory is split in segments of
+ * DEADTID_SEGMENT_BLOCKS blocks, only allocated where there are dead tuples.
+ * Heap blocks are scanned in physical order, so entries and bitmaps are
+ * simply appended and stay sorted.
+ */
+#define DEADTID_SEGMENT_SHIFT 10
+#define DEADTID_SEGMENT_BLOCKS (1 << DEADTID_SEGMENT_SHIFT)
+#define DEADTID_SEGMENT_SIZE (DEADTID_SEGMENT_BLOCKS * sizeof(uint32))
+#define DEADTID_WORD_BITS 64
+#define DEADTID_MAX_WORDS ((MaxHeapTuplesPerPage + DEADTID_WORD_BITS - 1) / DEADTID_WORD_BITS)
+
+typedef struct LVDeadBlock {
+    BlockNumber blkno;
+    uint32 firstword; /* first bitmap word of the block in words[] */
+    uint16 nwords;    /* bitmap words, covering offsets 1 .. nwords * 64 */
+    uint16 ntuples;   /* dead tuples on the block */
+} LVDeadBlock;
+
+/* the most the dead tuples of one heap page can add to the store */
+#define DEADTID_PAGE_SPACE (sizeof(LVDeadBlock) + DEADTID_MAX_WORDS * sizeof(uint64) + DEADTID_SEGMENT_SIZE)
+
+typedef struct LVDeadTidStore {
+    BlockNumber rel_pages; /* blocks covered by the directory */
+    uint32** directory;    /* per segment: entry number + 1 for each block, or 0 */
+    LVDeadBlock* blocks;   /* entries of blocks with dead tuples, by block number */
+    int nblocks;
+    int max_blocks;
+    uint64* words; /* bitmaps of all entries */
+    uint32 nwords;
+    uint32 max_words;
+    int num_tuples;   /* dead tuples stored */
+    Size space_used;  /* bytes of entries, bitmaps and segments in use */
+    Size space_limit; /* at most this many */
+} LVDeadTidStore;
+
 typedef struct LVRelStats {
     /* hasindex = true means two-pass strategy; false means one-pass */
     bool hasindex;
@@ -100,11 +152,8 @@ typedef struct LVRelStats {
     BlockNumber pages_removed;
     double tuples_deleted;
     BlockNumber nonempty_pages; /* actually, last nonempty page + 1 */
-    /* List of TIDs of tuples we intend to delete */
-    /* NB: this list is ordered by TID address */
-    int num_dead_tuples;     /* current # of entries */
-    int max_dead_tuples;     /* # slots allocated in array */
-    ItemPointer dead_tuples; /* array of ItemPointerData */
+    /* TIDs of tuples we intend to delete */
+    LVDeadTidStore* dead_tids;
     int num_index_scans;
     TransactionId latestRemovedXid;
     bool lock_waiter_detected;
@@ -126,11 +175,41 @@ typedef struct ValPrefetch {
     bool init; /* whether the prefetch list inited done or not */
 } ValPrefetch;
 
+/*
+ * State shared by the vacuum and the worker threads vacuuming its indexes.
+ * It lives in the vacuum's memory, and the vacuum does not go past
+ * lazy_parallel_vacuum_indexes() before all workers have exited.  Workers
+ * take indexes by bumping next_task, and only ever write the result of the
+ * index they took, its task_skipped flag and the error fields.
+ */
+typedef struct LVParallelState {
+    PGPROC* leader; /* whose latch to set when a worker exits */
+    Oid dbid;
+    LVRelStats* vacrelstats;
+    int elevel;
+    int cost_delay;
+    int cost_limit;
+    int ntasks;                          /* indexes workers may take */
+    Oid* task_oids;                      /* their OIDs */
+    IndexBulkDeleteResult** task_stats;  /* and their results, allocated by the vacuum */
+    bool* task_skipped;                  /* taken, but left to the vacuum as the lock was busy */
+    volatile bool abort;                 /* stop taking indexes */
+    pg_atomic_uint32 next_task;          /* next index to take */
+    pg_atomic_uint32 nworkers;           /* workers that have not exited yet */
+    slock_t mutex;                       /* protects the fields below */
+    int failed_task;                     /* index a worker failed on, or -1 */
+    int error_code;
+    char error_message[256];
+} LVParallelState;
+
 /* A few variables that don't seem worth passing around as parameters */
 static THR_LOCAL int elevel = -1;
 
 static THR_LOCAL BufferAccessStrategy vac_strategy;
 
+/* index a vacuum index worker is working on, or -1 */
+static THR_LOCAL int parallel_current_task = -1;
+
 /* non-export function prototypes */
 static IndexBulkDeleteResult** lazy_scan_heap(
     Relation onerel, LVRelStats* vacrelstats, Relation* Irel, int nindexes, bool scan_all, double* ptrDeleteTupleNum);
@@ -140,14 +219,28 @@ static void lazy_scan_rel(Relation onerel, LVRelStats* vacrelstats, VacuumStmt*
     bool scan_all, double* deleteTupleNum);
 static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats);
 static bool lazy_check_needs_freeze(Buffer buf);
-static void lazy_vacuum_index(Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats);
+static void lazy_vacuum_indexes(
+    Relation* Irel, int nindexes, IndexBulkDeleteResult** indstats, LVRelStats* vacrelstats);
+static void lazy_parallel_vacuum_indexes(Relation* Irel, int nindexes, IndexBulkDeleteResult** indstats,
+    LVRelStats* vacrelstats, const int* tasks, int ntasks, int nworkers);
+static bool lazy_index_parallel_safe(Relation indrel);
+static void lazy_parallel_wait(LVParallelState* lps, bool interruptible);
+static void lazy_parallel_worker_run(LVParallelState* lps);
+static void lazy_parallel_worker_save_error(LVParallelState* lps);
+static void lazy_parallel_worker_exit(int code, Datum arg);
+static void lazy_vacuum_index(
+    Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats, bool report = true);
 static IndexBulkDeleteResult* lazy_cleanup_index(
     Relation indrel, IndexBulkDeleteResult* stats, LVRelStats* vacrelstats);
-static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, int tupindex, LVRelStats* vacrelstats);
+static int lazy_vacuum_page(
+    Relation onerel, BlockNumber blkno, Buffer buffer, int blockindex, LVRelStats* vacrelstats);
 static void lazy_space_alloc(LVRelStats* vacrelstats, BlockNumber relblocks);
 static void lazy_record_dead_tuple(LVRelStats* vacrelstats, ItemPointer itemptr);
 static bool lazy_tid_reaped(ItemPointer itemptr, void* state);
-static int vac_cmp_itemptr(const void* left, const void* right);
+static LVDeadTidStore* dead_tid_store_create(BlockNumber rel_pages, Size space_limit);
+static void dead_tid_store_add(LVDeadTidStore* store, ItemPointer itemptr);
+static void dead_tid_store_reset(LVDeadTidStore* store);
+static bool dead_tid_store_is_full(const LVDeadTidStore* store);
 
 /*
  *	lazy_vacuum_rel() -- perform LAZY VACUUM for one heap relation
@@ -914,8 +1007,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
          * If we are close to overrunning the available space for dead-tuple
          * TIDs, pause and do a cycle of vacuuming before we tackle this page.
          */
-        if ((vacrelstats->max_dead_tuples - vacrelstats->num_dead_tuples) < MaxHeapTuplesPerPage &&
-            vacrelstats->num_dead_tuples > 0) {
+        if (dead_tid_store_is_full(vacrelstats->dead_tids) && vacrelstats->dead_tids->num_tuples > 0) {
             /*
              * Before beginning index vacuuming, we release any pin we may
              * hold on the visibility map page.  This isn't necessary for
@@ -931,8 +1023,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
             vacuum_log_cleanup_info(onerel, vacrelstats);
 
             /* Remove index entries */
-            for (i = 0; i < nindexes; i++)
-                lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+            lazy_vacuum_indexes(Irel, nindexes, indstats, vacrelstats);
             /* Remove tuples from heap */
             lazy_vacuum_heap(onerel, vacrelstats);
 
@@ -941,7 +1032,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
              * not to reset latestRemovedXid since we want that value to be
              * valid.
              */
-            vacrelstats->num_dead_tuples = 0;
+            dead_tid_store_reset(vacrelstats->dead_tids);
             vacrelstats->num_index_scans++;
         }
 
@@ -1093,7 +1184,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
         has_dead_tuples = false;
         nfrozen = 0;
         hastup = false;
-        prev_dead_count = vacrelstats->num_dead_tuples;
+        prev_dead_count = vacrelstats->dead_tids->num_tuples;
         maxoff = PageGetMaxOffsetNumber(page);
         for (offnum = FirstOffsetNumber; offnum <= maxoff; offnum = OffsetNumberNext(offnum)) {
             ItemId itemid;
@@ -1271,7 +1362,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
          * If there are no indexes then we can vacuum the page right now
          * instead of doing a second scan.
          */
-        if (nindexes == 0 && vacrelstats->num_dead_tuples > 0) {
+        if (nindexes == 0 && vacrelstats->dead_tids->num_tuples > 0) {
             /* Remove tuples from heap */
             lazy_vacuum_page(onerel, blkno, buf, 0, vacrelstats);
             has_dead_tuples = false;
@@ -1281,7 +1372,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
              * not to reset latestRemovedXid since we want that value to be
              * valid.
              */
-            vacrelstats->num_dead_tuples = 0;
+            dead_tid_store_reset(vacrelstats->dead_tids);
             vacuumed_pages++;
         }
 
@@ -1357,7 +1448,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
          * page, so remember its free space as-is.	(This path will always be
          * taken if there are no indexes.)
          */
-        if (vacrelstats->num_dead_tuples == prev_dead_count)
+        if (vacrelstats->dead_tids->num_tuples == prev_dead_count)
             RecordPageWithFreeSpace(onerel, blkno, freespace);
     }
 
@@ -1378,13 +1469,12 @@ static IndexBulkDeleteResult** lazy_scan_heap(
 
     /* If any tuples need to be deleted, perform final vacuum cycle */
     /* XXX put a threshold on min number of tuples here? */
-    if (vacrelstats->num_dead_tuples > 0) {
+    if (vacrelstats->dead_tids->num_tuples > 0) {
         /* Log cleanup info before we touch indexes */
         vacuum_log_cleanup_info(onerel, vacrelstats);
 
         /* Remove index entries */
-        for (i = 0; i < nindexes; i++)
-            lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+        lazy_vacuum_indexes(Irel, nindexes, indstats, vacrelstats);
         /* Remove tuples from heap */
         lazy_vacuum_heap(onerel, vacrelstats);
         vacrelstats->num_index_scans++;
@@ -1442,7 +1532,9 @@ static IndexBulkDeleteResult** lazy_scan_heap(
  */
 static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
 {
-    int tupindex;
+    LVDeadTidStore* store = vacrelstats->dead_tids;
+    int blockindex;
+    int tuples_removed;
     int npages;
     PGRUsage ru0;
 
@@ -1450,9 +1542,10 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
 
     pg_rusage_init(&ru0);
     npages = 0;
+    tuples_removed = 0;
 
-    tupindex = 0;
-    while (tupindex < vacrelstats->num_dead_tuples) {
+    blockindex = 0;
+    while (blockindex < store->nblocks) {
         BlockNumber tblk;
         Buffer buf;
         Page page;
@@ -1460,14 +1553,15 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
 
         vacuum_delay_point();
 
-        tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
+        tblk = store->blocks[blockindex].blkno;
         buf = ReadBufferExtended(onerel, MAIN_FORKNUM, tblk, RBM_NORMAL, vac_strategy);
         if (!ConditionalLockBufferForCleanup(buf)) {
             ReleaseBuffer(buf);
-            ++tupindex;
+            ++blockindex;
             continue;
         }
-        tupindex = lazy_vacuum_page(onerel, tblk, buf, tupindex, vacrelstats);
+        tuples_removed += store->blocks[blockindex].ntuples;
+        blockindex = lazy_vacuum_page(onerel, tblk, buf, blockindex, vacrelstats);
 
         /* Now that we've compacted the page, record its available space */
         page = BufferGetPage(buf);
@@ -1479,7 +1573,10 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
     }
 
     ereport(elevel,
-        (errmsg("\"%s\": removed %d row versions in %d pages", RelationGetRelationName(onerel), tupindex, npages),
+        (errmsg("\"%s\": removed %d row versions in %d pages",
+             RelationGetRelationName(onerel),
+             tuples_removed,
+             npages),
             errdetail("%s.", pg_rusage_show(&ru0))));
     gstrace_exit(GS_TRC_ID_lazy_vacuum_heap);
 }
@@ -1490,30 +1587,33 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
  *
  * Caller must hold pin and buffer cleanup lock on the buffer.
  *
- * tupindex is the index in vacrelstats->dead_tuples of the first dead
- * tuple for this page.  We assume the rest follow sequentially.
- * The return value is the first tupindex after the tuples of this page.
+ * blockindex is the index in vacrelstats->dead_tids of the entry for this
+ * page.  The return value is the index of the next entry.
  */
-static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, int tupindex, LVRelStats* vacrelstats)
+static int lazy_vacuum_page(
+    Relation onerel, BlockNumber blkno, Buffer buffer, int blockindex, LVRelStats* vacrelstats)
 {
     Page page = BufferGetPage(buffer);
+    LVDeadBlock* block = &vacrelstats->dead_tids->blocks[blockindex];
+    const uint64* words = &vacrelstats->dead_tids->words[block->firstword];
     OffsetNumber unused[MaxOffsetNumber];
     int uncnt = 0;
 
+    Assert(block->blkno == blkno);
+
     START_CRIT_SECTION();
 
-    for (; tupindex < vacrelstats->num_dead_tuples; tupindex++) {
-        BlockNumber tblk;
-        OffsetNumber toff;
-        ItemId itemid;
+    for (int i = 0; i < block->nwords; i++) {
+        uint64 bits = words[i];
+
+        while (bits != 0) {
+            OffsetNumber toff = (OffsetNumber)(i * DEADTID_WORD_BITS + __builtin_ctzll(bits) + 1);
+            ItemId itemid = PageGetItemId(page, toff);
 
-        tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
-        if (tblk != blkno)
-            break; /* past end of tuples for this block */
-        toff = ItemPointerGetOffsetNumber(&vacrelstats->dead_tuples[tupindex]);
-        itemid = PageGetItemId(page, toff);
-        ItemIdSetUnused(itemid);
-        unused[uncnt++] = toff;
+            ItemIdSetUnused(itemid);
+            unused[uncnt++] = toff;
+            bits &= bits - 1;
+        }
     }
 
     PageRepairFragmentation(page);
@@ -1530,7 +1630,7 @@ static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, i
 
     END_CRIT_SECTION();
 
-    return tupindex;
+    return blockindex + 1;
 }
 
 /*
@@ -1568,13 +1668,377 @@ static bool lazy_check_needs_freeze(Buffer buf)
     return false;
 }
 
+/*
+ *	lazy_vacuum_indexes() -- vacuum all index relations of a heap.
+ *
+ *		Delete the index entries pointing to tuples listed in
+ *		vacrelstats->dead_tids from every index, in worker threads when
+ *		vacuum_index_parallel_workers allows it and at least two indexes
+ *		can be handed out to them.
+ */
+static void lazy_vacuum_indexes(
+    Relation* Irel, int nindexes, IndexBulkDeleteResult** indstats, LVRelStats* vacrelstats)
+{
+    int nworkers = u_sess->attr.attr_storage.vacuum_index_parallel_workers;
+    int* tasks = NULL;
+    int ntasks = 0;
+    int i;
+
+    /* workers are threads of a running server; autovacuum has its own worker budget */
+    if (nworkers > 0 && nindexes > 1 && IsUnderPostmaster && !IsAutoVacuumWorkerProcess()) {
+        tasks = (int*)palloc(nindexes * sizeof(int));
+        for (i = 0; i < nindexes; i++) {
+            if (lazy_index_parallel_safe(Irel[i]))
+                tasks[ntasks++] = i;
+        }
+    }
+
+    if (ntasks < 2) {
+        for (i = 0; i < nindexes; i++)
+            lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+    } else {
+        lazy_parallel_vacuum_indexes(Irel, nindexes, indstats, vacrelstats, tasks, ntasks, Min(nworkers, ntasks - 1));
+    }
+
+    pfree_ext(tasks);
+}
+
+/*
+ * lazy_index_parallel_safe - can a worker thread vacuum this index?
+ *
+ * A worker opens the index by OID, so it must be a real catalog relation and
+ * not one built for a partition or bucket, nor live in local buffers.  Only
+ * btree is accepted, as its bulk delete is known to fill in the plain result
+ * struct the vacuum hands over rather than allocate one of its own.
+ */
+static bool lazy_index_parallel_safe(Relation indrel)
+{
+    return indrel->rd_rel->relam == BTREE_AM_OID && !RelationIsPartition(indrel) && !RelationIsBucket(indrel) &&
+           !RelationUsesLocalBuffers(indrel);
+}
+
+/*
+ * lazy_parallel_vacuum_indexes - vacuum indexes with the help of workers
+ *
+ * tasks lists the positions in Irel of the indexes workers may take.  The
+ * vacuum itself first does the others, then takes its share of the tasks,
+ * waits for the workers and finally does the tasks a worker could not lock
+ * without waiting.  Whatever happens, it does not leave before every worker
+ * it started is gone, as they use its memory.
+ */
+static void lazy_parallel_vacuum_indexes(Relation* Irel, int nindexes, IndexBulkDeleteResult** indstats,
+    LVRelStats* vacrelstats, const int* tasks, int ntasks, int nworkers)
+{
+    LVParallelState* lps = (LVParallelState*)palloc0(sizeof(LVParallelState));
+    ThreadId* workers = (ThreadId*)palloc0(nworkers * sizeof(ThreadId));
+    bool* is_task = (bool*)palloc0(nindexes * sizeof(bool));
+    volatile int nlaunched = 0;
+    PGRUsage ru0;
+    int i;
+
+    lps->leader = t_thrd.proc;
+    lps->dbid = u_sess->proc_cxt.MyDatabaseId;
+    lps->vacrelstats = vacrelstats;
+    lps->elevel = elevel;
+    lps->cost_delay = u_sess->attr.attr_storage.VacuumCostDelay;
+    lps->cost_limit = u_sess->attr.attr_storage.VacuumCostLimit;
+    lps->ntasks = ntasks;
+    lps->task_oids = (Oid*)palloc(ntasks * sizeof(Oid));
+    lps->task_stats = (IndexBulkDeleteResult**)palloc(ntasks * sizeof(IndexBulkDeleteResult*));
+    lps->task_skipped = (bool*)palloc0(ntasks * sizeof(bool));
+    for (i = 0; i < ntasks; i++) {
+        /* workers must not allocate the result in their own memory */
+        if (indstats[tasks[i]] == NULL)
+            indstats[tasks[i]] = (IndexBulkDeleteResult*)palloc0(sizeof(IndexBulkDeleteResult));
+        lps->task_oids[i] = RelationGetRelid(Irel[tasks[i]]);
+        lps->task_stats[i] = indstats[tasks[i]];
+        is_task[tasks[i]] = true;
+    }
+    lps->abort = false;
+    pg_atomic_init_u32(&lps->next_task, 0);
+    pg_atomic_init_u32(&lps->nworkers, 0);
+    SpinLockInit(&lps->mutex);
+    lps->failed_task = -1;
+    pg_rusage_init(&ru0);
+
+    PG_TRY();
+    {
+        for (i = 0; i < nworkers; i++) {
+            (void)pg_atomic_fetch_add_u32(&lps->nworkers, 1);
+            workers[i] = initialize_util_thread(VACUUM_INDEX_WORKER, lps);
+            if (workers[i] == 0) {
+                /* carry on with the workers we have, if any */
+                (void)pg_atomic_fetch_sub_u32(&lps->nworkers, 1);
+                break;
+            }
+            nlaunched++;
+        }
+
+        ereport(elevel, (errmsg("vacuuming %d of %d indexes with %d worker threads", ntasks, nindexes, nlaunched)));
+
+        for (i = 0; i < nindexes; i++) {
+            if (!is_task[i])
+                lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+        }
+
+        for (;;) {
+            uint32 task = pg_atomic_fetch_add_u32(&lps->next_task, 1);
+
+            if (task >= (uint32)ntasks)
+                break;
+            lazy_vacuum_index(Irel[tasks[task]], &lps->task_stats[task], vacrelstats, false);
+        }
+
+        lazy_parallel_wait(lps, true);
+
+        /* indexes a worker could not lock without waiting are ours */
+        for (i = 0; i < ntasks && lps->failed_task < 0; i++) {
+            if (lps->task_skipped[i])
+                lazy_vacuum_index(Irel[tasks[i]], &lps->task_stats[i], vacrelstats, false);
+        }
+    }
+    PG_CATCH();
+    {
+        lps->abort = true;
+        for (i = 0; i < nlaunched; i++)
+            (void)gs_signal_send(workers[i], SIGINT);
+        lazy_parallel_wait(lps, false);
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+
+    if (lps->failed_task >= 0) {
+        ereport(ERROR,
+            (errcode(lps->error_code),
+                errmsg("could not vacuum index \"%s\" in a worker thread: %s",
+                    RelationGetRelationName(Irel[tasks[lps->failed_task]]),
+                    lps->error_message)));
+    }
+
+    /* report in index order, whoever did the work */
+    for (i = 0; i < ntasks; i++) {
+        ereport(elevel,
+            (errmsg("scanned index \"%s\" to remove %d row versions",
+                RelationGetRelationName(Irel[tasks[i]]),
+                vacrelstats->dead_tids->num_tuples),
+                errdetail("%s.", pg_rusage_show(&ru0))));
+    }
+
+    pfree(lps->task_oids);
+    pfree(lps->task_stats);
+    pfree(lps->task_skipped);
+    pfree(lps);
+    pfree(workers);
+    pfree(is_task);
+}
+
+/*
+ * lazy_parallel_wait - wait until all vacuum index workers have exited
+ */
+static void lazy_parallel_wait(LVParallelState* lps, bool interruptible)
+{
+    for (;;) {
+        ResetLatch(&t_thrd.proc->procLatch);
+        if (pg_atomic_read_u32(&lps->nworkers) == 0)
+            break;
+        if (interruptible)
+            CHECK_FOR_INTERRUPTS();
+        (void)WaitLatch(&t_thrd.proc->procLatch, WL_LATCH_SET | WL_TIMEOUT, 1000L);
+    }
+}
+
+/*
+ *	VacuumIndexWorkerMain() -- main entry of a vacuum index worker thread.
+ *
+ *		The thread connects to the database of the vacuum that started it,
+ *		takes indexes from the shared list until there are none left, and
+ *		exits.  Its exit is reported to the vacuum by an on_proc_exit
+ *		callback, so that a worker failing to start up does not leave the
+ *		vacuum waiting.
+ */
+void VacuumIndexWorkerMain(void* arg)
+{
+    sigjmp_buf local_sigjmp_buf;
+    LVParallelState* lps = (LVParallelState*)arg;
+    char dbname[NAMEDATALEN];
+
+    on_proc_exit(lazy_parallel_worker_exit, PointerGetDatum(lps));
+
+    t_thrd.proc_cxt.MyProgName = "VacuumIndexWorker";
+    t_thrd.proc_cxt.MyPMChildSlot = AssignPostmasterChildSlot();
+    InitProcessAndShareMemory();
+
+    /* Identify myself via ps */
+    init_ps_display("vacuum index worker process", "", "", "");
+
+    SetProcessingMode(InitProcessing);
+
+    /* Same signal handling as an autovacuum worker */
+    (void)gspqsignal(SIGINT, StatementCancelHandler);
+    (void)gspqsignal(SIGTERM, die);
+    (void)gspqsignal(SIGQUIT, quickdie);
+    (void)gspqsignal(SIGALRM, handle_sig_alarm);
+
+    (void)gspqsignal(SIGPIPE, SIG_IGN);
+    (void)gspqsignal(SIGUSR1, procsignal_sigusr1_handler);
+    (void)gspqsignal(SIGUSR2, SIG_IGN);
+    (void)gspqsignal(SIGFPE, FloatExceptionHandler);
+    (void)gspqsignal(SIGCHLD, SIG_DFL);
+    (void)gspqsignal(SIGHUP, SIG_IGN);
+
+    /* Early initialization */
+    BaseInit();
+
+    int curTryCounter;
+    int* oldTryCounter = NULL;
+    if (sigsetjmp(local_sigjmp_buf, 1) != 0) {
+        gstrace_tryblock_exit(true, oldTryCounter);
+        /* Prevents interrupts while cleaning up */
+        HOLD_INTERRUPTS();
+
+        lazy_parallel_worker_save_error(lps);
+
+        /* Report the error to the server log */
+        EmitErrorReport();
+
+        proc_exit(1);
+    }
+    oldTryCounter = gstrace_tryblock_entry(&curTryCounter);
+
+    /* We can now handle ereport(ERROR) */
+    t_thrd.log_cxt.PG_exception_stack = &local_sigjmp_buf;
+
+    gs_signal_setmask(&t_thrd.libpq_cxt.UnBlockSig, NULL);
+    (void)gs_signal_unblock_sigusr2();
+
+    SetConfigOption("zero_damaged_pages", "false", PGC_SUSET, PGC_S_OVERRIDE);
+
+    /* the vacuum that started us decides when to give up */
+    SetConfigOption("statement_timeout", "0", PGC_SUSET, PGC_S_OVERRIDE);
+
+    t_thrd.proc_cxt.PostInit->SetDatabaseAndUser(NULL, lps->dbid, NULL);
+    t_thrd.proc_cxt.PostInit->InitVacuumIndexWorker();
+    t_thrd.proc_cxt.PostInit->GetDatabaseName(dbname);
+
+    SetProcessingMode(NormalProcessing);
+    set_ps_display(dbname, false);
+
+    lazy_parallel_worker_run(lps);
+}
+
+/*
+ * lazy_parallel_worker_run - vacuum indexes until none are left
+ */
+static void lazy_parallel_worker_run(LVParallelState* lps)
+{
+    elevel = lps->elevel;
+
+    /* throttle like the vacuum itself */
+    u_sess->attr.attr_storage.VacuumCostDelay = lps->cost_delay;
+    u_sess->attr.attr_storage.VacuumCostLimit = lps->cost_limit;
+    t_thrd.vacuum_cxt.VacuumCostActive = (lps->cost_delay > 0);
+    t_thrd.vacuum_cxt.VacuumCostBalance = 0;
+
+    StartTransactionCommand();
+
+    /* like the vacuum, let others ignore us when computing their OldestXmin */
+    (void)LWLockAcquire(ProcArrayLock, LW_EXCLUSIVE);
+    t_thrd.pgxact->vacuumFlags |= PROC_IN_VACUUM;
+    LWLockRelease(ProcArrayLock);
+
+    vac_strategy = GetAccessStrategy(BAS_VACUUM);
+
+    while (!lps->abort) {
+        uint32 task = pg_atomic_fetch_add_u32(&lps->next_task, 1);
+        Relation indrel;
+
+        if (task >= (uint32)lps->ntasks)
+            break;
+        parallel_current_task = (int)task;
+
+        /*
+         * The vacuum holds the same lock, but a conflicting request queued
+         * behind it would still make us wait, while the vacuum waits for us
+         * on its latch, where the deadlock detector cannot see it.  So never
+         * wait: leave the index and the rest of the list to the vacuum.
+         */
+        if (!ConditionalLockRelationOid(lps->task_oids[task], RowExclusiveLock)) {
+            lps->task_skipped[task] = true;
+            parallel_current_task = -1;
+            break;
+        }
+        indrel = index_open(lps->task_oids[task], NoLock);
+        lazy_vacuum_index(indrel, &lps->task_stats[task], lps->vacrelstats, false);
+        index_close(indrel, RowExclusiveLock);
+
+        parallel_current_task = -1;
+    }
+
+    CommitTransactionCommand();
+}
+
+/*
+ * lazy_parallel_worker_save_error - pass the error at hand on to the vacuum
+ */
+static void lazy_parallel_worker_save_error(LVParallelState* lps)
+{
+    ErrorData* edata = NULL;
+    errno_t rc = EOK;
+
+    /* an error outside of any index is the vacuum's business only if it loses an index */
+    if (parallel_current_task < 0)
+        return;
+
+    (void)MemoryContextSwitchTo(t_thrd.top_mem_cxt);
+    edata = CopyErrorData();
+
+    SpinLockAcquire(&lps->mutex);
+    if (lps->failed_task < 0) {
+        lps->failed_task = parallel_current_task;
+        lps->error_code = edata->sqlerrcode;
+        rc = strncpy_s(lps->error_message,
+            sizeof(lps->error_message),
+            edata->message != NULL ? edata->message : "",
+            sizeof(lps->error_message) - 1);
+    }
+    SpinLockRelease(&lps->mutex);
+    securec_check(rc, "\0", "\0");
+}
+
+/*
+ * lazy_parallel_worker_exit - on_proc_exit callback of a vacuum index worker
+ *
+ * By now the worker's transaction is aborted or committed and its locks are
+ * released.  Telling the vacuum we are gone is the last use of its memory.
+ */
+static void lazy_parallel_worker_exit(int code, Datum arg)
+{
+    LVParallelState* lps = (LVParallelState*)DatumGetPointer(arg);
+    PGPROC* leader = lps->leader;
+
+    if (parallel_current_task >= 0) {
+        SpinLockAcquire(&lps->mutex);
+        if (lps->failed_task < 0) {
+            lps->failed_task = parallel_current_task;
+            lps->error_code = ERRCODE_INTERNAL_ERROR;
+            lps->error_message[0] = '\0';
+        }
+        SpinLockRelease(&lps->mutex);
+        parallel_current_task = -1;
+    }
+
+    (void)pg_atomic_fetch_sub_u32(&lps->nworkers, 1);
+    SetLatch(&leader->procLatch);
+}
+
 /*
  *	lazy_vacuum_index() -- vacuum one index relation.
  *
  *		Delete all the index entries pointing to tuples listed in
- *		vacrelstats->dead_tuples, and update running statistics.
+ *		vacrelstats->dead_tuples, and update running statistics.  The
+ *		parallel path passes report = false and reports the indexes itself.
  */
-static void lazy_vacuum_index(Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats)
+static void lazy_vacuum_index(Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats, bool report)
 {
     IndexVacuumInfo ivinfo;
     PGRUsage ru0;
@@ -1590,13 +2054,15 @@ static void lazy_vacuum_index(Relation indrel, IndexBulkDeleteResult** stats, LV
     ivinfo.strategy = vac_strategy;
 
     /* Do bulk deletion */
-    *stats = index_bulk_delete(&ivinfo, *stats, lazy_tid_reaped, (void*)vacrelstats);
+    *stats = index_bulk_delete(&ivinfo, *stats, lazy_tid_reaped, (void*)vacrelstats->dead_tids);
 
-    ereport(elevel,
-        (errmsg("scanned index \"%s\" to remove %d row versions",
-            RelationGetRelationName(indrel),
-            vacrelstats->num_dead_tuples),
-            errdetail("%s.", pg_rusage_show(&ru0))));
+    if (report) {
+        ereport(elevel,
+            (errmsg("scanned index \"%s\" to remove %d row versions",
+                RelationGetRelationName(indrel),
+                vacrelstats->dead_tids->num_tuples),
+                errdetail("%s.", pg_rusage_show(&ru0))));
+    }
     gstrace_exit(GS_TRC_ID_lazy_vacuum_index);
 }
 
@@ -1644,24 +2110,17 @@ static IndexBulkDeleteResult* lazy_cleanup_index(Relation indrel, IndexBulkDelet
  */
 static void lazy_space_alloc(LVRelStats* vacrelstats, BlockNumber relblocks)
 {
-    unsigned long maxtuples;
+    Size space_limit;
 
     if (vacrelstats->hasindex) {
-        maxtuples = (u_sess->attr.attr_memory.maintenance_work_mem * 1024L) / sizeof(ItemPointerData);
-        maxtuples = Min(maxtuples, INT_MAX);
-        maxtuples = Min(maxtuples, (int)(MaxAllocSize / sizeof(ItemPointerData)));
-        /* curious coding here to ensure the multiplication can't overflow */
-        if ((BlockNumber)(maxtuples / LAZY_ALLOC_TUPLES) > relblocks)
-            maxtuples = relblocks * LAZY_ALLOC_TUPLES;
-        /* stay sane if small maintenance_work_mem */
-        maxtuples = Max(maxtuples, MaxHeapTuplesPerPage);
+        space_limit = (Size)u_sess->attr.attr_memory.maintenance_work_mem * 1024L;
+        space_limit = Min(space_limit, MaxAllocSize);
     } else {
-        maxtuples = MaxHeapTuplesPerPage;
+        /* the store is emptied after every page */
+        space_limit = DEADTID_PAGE_SPACE;
     }
 
-    vacrelstats->num_dead_tuples = 0;
-    vacrelstats->max_dead_tuples = (int)maxtuples;
-    vacrelstats->dead_tuples = (ItemPointer)palloc(maxtuples * sizeof(ItemPointerData));
+    vacrelstats->dead_tids = dead_tid_store_create(relblocks, space_limit);
 }
 
 /*
@@ -1670,14 +2129,10 @@ static void lazy_space_alloc(LVRelStats* vacrelstats, BlockNumber relblocks)
 static void lazy_record_dead_tuple(LVRelStats* vacrelstats, ItemPointer itemptr)
 {
     /*
-     * The array shouldn't overflow under normal behavior, but perhaps it
-     * could if we are given a really small maintenance_work_mem. In that
-     * case, just forget the last few tuples (we'll get 'em next time).
+     * There is always room for the tuples of the page at hand: lazy_scan_heap
+     * vacuums the indexes before a page if the store might not hold it.
      */
-    if (vacrelstats->num_dead_tuples < vacrelstats->max_dead_tuples) {
-        vacrelstats->dead_tuples[vacrelstats->num_dead_tuples] = *itemptr;
-        vacrelstats->num_dead_tuples++;
-    }
+    dead_tid_store_add(vacrelstats->dead_tids, itemptr);
 }
 
 /*
@@ -1685,42 +2140,158 @@ static void lazy_record_dead_tuple(LVRelStats* vacrelstats, ItemPointer itemptr)
  *
  *		This has the right signature to be an IndexBulkDeleteCallback.
  *
- *		Assumes dead_tuples array is in sorted order.
+ *		The store is only read here, so vacuum index workers may call this
+ *		concurrently.
  */
 static bool lazy_tid_reaped(ItemPointer itemptr, void* state)
 {
-    LVRelStats* vacrelstats = (LVRelStats*)state;
-    ItemPointer res;
+    LVDeadTidStore* store = (LVDeadTidStore*)state;
+    BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+    OffsetNumber offnum = ItemPointerGetOffsetNumber(itemptr);
+    const uint32* segment = NULL;
+    const LVDeadBlock* block = NULL;
+    uint32 entry;
+    uint32 word;
+
+    if (blkno >= store->rel_pages || offnum < FirstOffsetNumber)
+        return false;
+
+    segment = store->directory[blkno >> DEADTID_SEGMENT_SHIFT];
+    if (segment == NULL)
+        return false;
+
+    entry = segment[blkno & (DEADTID_SEGMENT_BLOCKS - 1)];
+    if (entry == 0)
+        return false;
+
+    block = &store->blocks[entry - 1];
+    word = (uint32)(offnum - 1) / DEADTID_WORD_BITS;
+    if (word >= block->nwords)
+        return false;
+
+    return (store->words[block->firstword + word] >> ((offnum - 1) % DEADTID_WORD_BITS)) & 1;
+}
+
+/*
+ * dead_tid_store_create - set up an empty dead TID store
+ *
+ * The directory covers rel_pages blocks; the rest is allocated as dead
+ * tuples come in, up to space_limit bytes.
+ */
+static LVDeadTidStore* dead_tid_store_create(BlockNumber rel_pages, Size space_limit)
+{
+    LVDeadTidStore* store = (LVDeadTidStore*)palloc0(sizeof(LVDeadTidStore));
+    Size nsegments = ((Size)rel_pages + DEADTID_SEGMENT_BLOCKS - 1) >> DEADTID_SEGMENT_SHIFT;
+
+    store->rel_pages = rel_pages;
+    store->directory = (uint32**)palloc0(Max(nsegments, 1) * sizeof(uint32*));
+    store->space_limit = Max(space_limit, DEADTID_PAGE_SPACE);
+
+    return store;
+}
+
+/*
+ * dead_tid_store_add - remember one dead tuple
+ *
+ * Blocks must come in increasing order, each with all its dead tuples at
+ * once, as lazy_scan_heap delivers them.
+ */
+static void dead_tid_store_add(LVDeadTidStore* store, ItemPointer itemptr)
+{
+    BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+    OffsetNumber offnum = ItemPointerGetOffsetNumber(itemptr);
+    uint32 word = (uint32)(offnum - 1) / DEADTID_WORD_BITS;
+    uint64 bit = (uint64)1 << ((offnum - 1) % DEADTID_WORD_BITS);
+    LVDeadBlock* block = NULL;
+
+    Assert(blkno < store->rel_pages);
+    Assert(offnum >= FirstOffsetNumber && offnum <= MaxHeapTuplesPerPage);
+
+    if (store->nblocks > 0 && store->blocks[store->nblocks - 1].blkno == blkno) {
+        block = &store->blocks[store->nblocks - 1];
+    } else {
+        uint32** segment = &store->directory[blkno >> DEADTID_SEGMENT_SHIFT];
+
+        Assert(store->nblocks == 0 || store->blocks[store->nblocks - 1].blkno < blkno);
+
+        if (*segment == NULL) {
+            *segment = (uint32*)palloc0(DEADTID_SEGMENT_SIZE);
+            store->space_used += DEADTID_SEGMENT_SIZE;
+        }
+
+        if (store->nblocks == store->max_blocks) {
+            int max_blocks = Max(store->max_blocks * 2, 64);
+
+            max_blocks = (int)Min((Size)max_blocks, store->space_limit / sizeof(LVDeadBlock) + 1);
+            if (store->blocks == NULL)
+                store->blocks = (LVDeadBlock*)palloc(max_blocks * sizeof(LVDeadBlock));
+            else
+                store->blocks = (LVDeadBlock*)repalloc(store->blocks, max_blocks * sizeof(LVDeadBlock));
+            store->max_blocks = max_blocks;
+        }
+
+        block = &store->blocks[store->nblocks++];
+        block->blkno = blkno;
+        block->firstword = store->nwords;
+        block->nwords = 0;
+        block->ntuples = 0;
+        (*segment)[blkno & (DEADTID_SEGMENT_BLOCKS - 1)] = (uint32)store->nblocks;
+        store->space_used += sizeof(LVDeadBlock);
+    }
+
+    /* the block is the last one, so its bitmap can grow at the end of words[] */
+    while (block->nwords <= word) {
+        if (store->nwords == store->max_words) {
+            uint32 max_words = Max(store->max_words * 2, 256);
+
+            max_words = (uint32)Min((Size)max_words, store->space_limit / sizeof(uint64) + DEADTID_MAX_WORDS);
+            if (store->words == NULL)
+                store->words = (uint64*)palloc(max_words * sizeof(uint64));
+            else
+                store->words = (uint64*)repalloc(store->words, max_words * sizeof(uint64));
+            store->max_words = max_words;
+        }
+        store->words[store->nwords++] = 0;
+        block->nwords++;
+        store->space_used += sizeof(uint64);
+    }
+
+    if ((store->words[block->firstword + word] & bit) == 0) {
+        store->words[block->firstword + word] |= bit;
+        block->ntuples++;
+        store->num_tuples++;
+    }
+}
+
+/*
+ * dead_tid_store_reset - forget all dead tuples
+ *
+ * The entry and bitmap arrays are kept for reuse; directory segments are
+ * freed, as the next round is going to need different ones.
+ */
+static void dead_tid_store_reset(LVDeadTidStore* store)
+{
+    for (int i = 0; i < store->nblocks; i++) {
+        uint32** segment = &store->directory[store->blocks[i].blkno >> DEADTID_SEGMENT_SHIFT];
 
-    res = (ItemPointer)bsearch((void*)itemptr,
-        (void*)vacrelstats->dead_tuples,
-        vacrelstats->num_dead_tuples,
-        sizeof(ItemPointerData),
-        vac_cmp_itemptr);
+        if (*segment != NULL) {
+            pfree(*segment);
+            *segment = NULL;
+        }
+    }
 
-    return (res != NULL);
+    store->nblocks = 0;
+    store->nwords = 0;
+    store->num_tuples = 0;
+    store->space_used = 0;
 }
 
 /*
- * Comparator routines for use with qsort() and bsearch().
+ * dead_tid_store_is_full - might the dead tuples of one more page not fit?
  */
-static int vac_cmp_itemptr(const void* left, const void* right)
+static bool dead_tid_store_is_full(const LVDeadTidStore* store)
 {
-    BlockNumber lblk, rblk;
-    OffsetNumber loff, roff;
-    lblk = ItemPointerGetBlockNumber((ItemPointer)left);
-    rblk = ItemPointerGetBlockNumber((ItemPointer)right);
-    if (lblk < rblk)
-        return -1;
-    if (lblk > rblk)
-        return 1;
-    loff = ItemPointerGetOffsetNumber((ItemPointer)left);
-    roff = ItemPointerGetOffsetNumber((ItemPointer)right);
-    if (loff < roff)
-        return -1;
-    if (loff > roff)
-        return 1;
-    return 0;
+    return store->space_used + DEADTID_PAGE_SPACE > store->space_limit;
 }
 
 void elogVacuumInfo(Relation rel, HeapTuple tuple, char* funcName, TransactionId oldestxmin)
@@ -77,6 +77,7 @@
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/bucketpruning.h"
+#include "optimizer/cardfeedback.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/optimizerdebug.h"
@@ -4905,12 +4906,20 @@ double approx_tuple_count(PlannerInfo* root, JoinPath* path, List* quals)
 void set_baserel_size_estimates(PlannerInfo* root, RelOptInfo* rel)
 {
     double nrows;
+    Selectivity selec;
 
     /* Should only be applied to base relations */
     AssertEreport(
         rel->relid > 0, MOD_OPT, "The relid is invalid when set the size estimates for the given base relation.");
 
-    nrows = rel->tuples * clauselist_selectivity(root, rel->baserestrictinfo, 0, JOIN_INNER, NULL);
+    selec = clauselist_selectivity(root, rel->baserestrictinfo, 0, JOIN_INNER, NULL);
+
+    /* Correct it with the rows that earlier scans of the same predicate returned */
+    if (u_sess->attr.attr_sql.enable_cardinality_feedback) {
+        selec = cardinality_feedback_adjust(root, rel, selec);
+    }
+
+    nrows = rel->tuples * selec;
 
     rel->rows = clamp_row_est(nrows);
 
@@ -36,6 +36,7 @@
 #include "nodes/nodeFuncs.h"
 #include "nodes/plannodes.h"
 #include "nodes/primnodes.h"
+#include "optimizer/cardfeedback.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/dataskew.h"
@@ -126,6 +127,7 @@ static DfsScan* make_dfsscan(List* qptlist, List* qpqual, Index scanrelid, List*
 
 static PartIterator* create_partIterator_plan(
     PlannerInfo* root, PartIteratorPath* pIterpath, GlobalPartIterator* gpIter);
+static List* build_partition_pruning_quals(PlannerInfo* root, Path* scanpath, Plan* scanplan);
 static Plan* setPartitionParam(PlannerInfo* root, Plan* plan, RelOptInfo* rel);
 static Plan* setBucketInfoParam(PlannerInfo* root, Plan* plan, RelOptInfo* rel);
 Plan* create_globalpartInterator_plan(PlannerInfo* root, PartIteratorPath* pIterpath);
@@ -680,6 +682,11 @@ static Plan* create_scan_plan(PlannerInfo* root, Path* best_path)
     (void*)setPartitionParam(root, plan, best_path->parent);
     (void*)setBucketInfoParam(root, plan, best_path->parent);
 
+    /* Have the executor report the rows the scan returns, see cardfeedback.cpp */
+    if (rel->feedbackSignature != 0 && best_path->param_info == NULL) {
+        cardinality_feedback_mark_scan(rel, plan);
+    }
+
     /*
      * If there are any pseudoconstant clauses attached to this node, insert a
      * gating Result node that evaluates the pseudoconstants as one-time
@@ -5738,6 +5745,11 @@ static PartIterator* create_partIterator_plan(
     /* construct sub plan */
     partItr->plan.lefttree = create_plan_recurse(root, pIterpath->subPath);
 
+    /* partition wise join iterates over several relations, it can't prune */
+    if (gpIter != NULL) {
+        partItr->pruningQuals = build_partition_pruning_quals(root, pIterpath->subPath, partItr->plan.lefttree);
+    }
+
     /* constrcut PartIterator attributes */
     partItr->plan.targetlist = partItr->plan.lefttree->targetlist;
 
@@ -5775,6 +5787,43 @@ static PartIterator* create_partIterator_plan(
     return partItr;
 }
 
+/*
+ * build_partition_pruning_quals
+ *	  Collect the quals which allow the PartIterator to prune partitions at execution:
+ *	  quals on the partition key holding params of a generic plan, or params set by a
+ *	  nestloop for each outer row.  Must be called while the scan's nestloop params
+ *	  are still being assigned, so that the same params are used as in the scan.
+ */
+static List* build_partition_pruning_quals(PlannerInfo* root, Path* scanpath, Plan* scanplan)
+{
+    RelOptInfo* rel = scanpath->parent;
+    List* clauses = NIL;
+
+    switch (nodeTag(scanplan)) {
+        case T_SeqScan:
+        case T_IndexScan:
+        case T_IndexOnlyScan:
+        case T_BitmapHeapScan:
+        case T_TidScan:
+            break;
+        default:
+            /* column stores have their own iterator */
+            return NIL;
+    }
+
+    if (!((Scan*)scanplan)->isPartTbl || ((Scan*)scanplan)->itrs == 0 || rel->reloptkind != RELOPT_BASEREL) {
+        return NIL;
+    }
+
+    clauses = extract_actual_clauses(rel->baserestrictinfo, false);
+    if (scanpath->param_info != NULL) {
+        clauses = list_concat(clauses, extract_actual_clauses(scanpath->param_info->ppi_clauses, false));
+        clauses = (List*)replace_nestloop_params(root, (Node*)clauses);
+    }
+
+    return getPartitionPruningParamQuals(root, rel->relid, clauses);
+}
+
 static FunctionScan* make_functionscan(List* qptlist, List* qpqual, Index scanrelid, Node* funcexpr, List* funccolnames,
     List* funccoltypes, List* funccoltypmods, List* funccolcollations)
 {
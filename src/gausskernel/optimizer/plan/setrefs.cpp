@@ -563,6 +563,7 @@ static Plan* set_plan_refs(PlannerInfo* root, Plan* plan, int rtoffset)
                 case T_CStoreIndexCtidScan:
                 case T_CStoreIndexHeapScan:
                     splan->plan.targetlist = fix_scan_list(root, splan->plan.targetlist, rtoffset);
+                    splan->pruningQuals = fix_scan_list(root, splan->pruningQuals, rtoffset);
                     if (splan->plan.distributed_keys != NIL) {
                         splan->plan.distributed_keys = fix_scan_list(root, splan->plan.distributed_keys, rtoffset);
                     }
@@ -0,0 +1,624 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ *  cardfeedback.cpp
+ *        Cardinality feedback between the executor and the planner.
+ *
+ *  When enable_cardinality_feedback is on, the planner tags every plain scan
+ *  of an ordinary table with a signature of its restriction clauses and the
+ *  row estimate it made for them.  The executor counts the rows those scans
+ *  really return, and at executor end the ratio between the two is kept in
+ *  an instance-wide hash table keyed by (database, relation, signature).
+ *  Later plans of the same predicate multiply its selectivity by that ratio.
+ *
+ *  The signature is built from operators, functions, columns, constants and
+ *  parameter numbers, so it is independent of the range table index of the
+ *  relation and of the order of the clauses.  Corrections of a relation are
+ *  dropped when it is analyzed, since they were learnt against the old
+ *  statistics.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/optimizer/util/cardfeedback.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <math.h>
+
+#include "access/hash.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/cardfeedback.h"
+#include "optimizer/cost.h"
+#include "parser/parsetree.h"
+#include "storage/lwlock.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/selfuncs.h"
+#include "utils/timestamp.h"
+
+/* Estimates within this factor of the actual rows are not worth remembering */
+#define CARD_FEEDBACK_MIN_ERROR 2.0
+
+/* The correction follows roughly the latest this many executions */
+#define CARD_FEEDBACK_MAX_WEIGHT 8
+
+#define CARD_FEEDBACK_NATTS 8
+
+typedef struct CardFeedbackKey {
+    Oid dbid;         /* database of the relation */
+    Oid relid;        /* scanned relation */
+    uint32 signature; /* signature of its restriction clauses */
+} CardFeedbackKey;
+
+typedef struct CardFeedbackEntry {
+    CardFeedbackKey key;
+    double estimated;        /* uncorrected estimate of the latest execution */
+    double actual;           /* rows returned by the latest execution */
+    double correction;       /* factor applied to the selectivity */
+    int64 samples;           /* # of executions the correction comes from */
+    TimestampTz last_update; /* time of the latest execution */
+} CardFeedbackEntry;
+
+/* instance-wide corrections, in g_instance.instance_context */
+static MemoryContext card_feedback_mcxt = NULL;
+static HTAB* card_feedback_hash = NULL;
+
+static inline void signature_mix(uint32* hash, uint32 value)
+{
+    *hash = DatumGetUInt32(hash_uint32(((*hash << 5) | (*hash >> 27)) ^ value));
+}
+
+/*
+ * Hash one restriction clause.  Vars are hashed by attribute number only,
+ * the relation being part of the key already.
+ */
+static bool feedback_signature_walker(Node* node, uint32* hash)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    signature_mix(hash, (uint32)nodeTag(node));
+
+    switch (nodeTag(node)) {
+        case T_Var: {
+            Var* var = (Var*)node;
+
+            signature_mix(hash, (uint32)var->varattno);
+            signature_mix(hash, var->varlevelsup);
+            return false;
+        }
+        case T_Const: {
+            Const* con = (Const*)node;
+            unsigned char* data = NULL;
+            Size len;
+
+            signature_mix(hash, con->consttype);
+            if (con->constisnull) {
+                return false;
+            }
+
+            if (con->constbyval) {
+                data = (unsigned char*)&con->constvalue;
+                len = sizeof(Datum);
+            } else {
+                data = (unsigned char*)DatumGetPointer(con->constvalue);
+                len = datumGetSize(con->constvalue, false, con->constlen);
+            }
+            signature_mix(hash, DatumGetUInt32(hash_any(data, (int)len)));
+            return false;
+        }
+        case T_Param: {
+            Param* param = (Param*)node;
+
+            signature_mix(hash, (uint32)param->paramkind);
+            signature_mix(hash, (uint32)param->paramid);
+            return false;
+        }
+        case T_OpExpr:
+        case T_DistinctExpr:
+        case T_NullIfExpr:
+            signature_mix(hash, ((OpExpr*)node)->opno);
+            break;
+        case T_ScalarArrayOpExpr:
+            signature_mix(hash, ((ScalarArrayOpExpr*)node)->opno);
+            signature_mix(hash, (uint32)((ScalarArrayOpExpr*)node)->useOr);
+            break;
+        case T_FuncExpr:
+            signature_mix(hash, ((FuncExpr*)node)->funcid);
+            break;
+        case T_BoolExpr:
+            signature_mix(hash, (uint32)((BoolExpr*)node)->boolop);
+            break;
+        case T_NullTest:
+            signature_mix(hash, (uint32)((NullTest*)node)->nulltesttype);
+            break;
+        case T_BooleanTest:
+            signature_mix(hash, (uint32)((BooleanTest*)node)->booltesttype);
+            break;
+        default:
+            break;
+    }
+
+    return expression_tree_walker(node, (bool (*)())feedback_signature_walker, (void*)hash);
+}
+
+/*
+ * Build the signature of a restriction clause list.  The clause hashes are
+ * summed up so that the order of the clauses does not matter.  Zero is
+ * reserved for scans that are not tracked.
+ */
+static uint32 feedback_signature(List* restrictinfo_list)
+{
+    uint32 signature = 0;
+    ListCell* lc = NULL;
+
+    foreach (lc, restrictinfo_list) {
+        Node* clause = (Node*)lfirst(lc);
+        uint32 hash = 0;
+
+        if (IsA(clause, RestrictInfo)) {
+            clause = (Node*)((RestrictInfo*)clause)->clause;
+        }
+
+        (void)feedback_signature_walker(clause, &hash);
+        signature += hash;
+    }
+    signature_mix(&signature, (uint32)list_length(restrictinfo_list));
+
+    return (signature != 0) ? signature : 1;
+}
+
+static void feedback_key_init(CardFeedbackKey* key, Oid dbid, Oid relid, uint32 signature)
+{
+    errno_t rc = memset_s(key, sizeof(CardFeedbackKey), 0, sizeof(CardFeedbackKey));
+    securec_check(rc, "\0", "\0");
+
+    key->dbid = dbid;
+    key->relid = relid;
+    key->signature = signature;
+}
+
+/* Get the hash table of corrections, creating it on first use */
+static HTAB* get_card_feedback_hash(void)
+{
+    if (card_feedback_hash != NULL) {
+        return card_feedback_hash;
+    }
+
+    LWLockAcquire(CardFeedbackLock, LW_EXCLUSIVE);
+
+    if (card_feedback_hash == NULL) {
+        HASHCTL hash_ctl;
+        errno_t rc;
+
+        if (card_feedback_mcxt == NULL) {
+            card_feedback_mcxt = AllocSetContextCreate((MemoryContext)g_instance.instance_context,
+                "cardinality feedback memory context",
+                ALLOCSET_DEFAULT_MINSIZE,
+                ALLOCSET_DEFAULT_INITSIZE,
+                ALLOCSET_DEFAULT_MAXSIZE,
+                SHARED_CONTEXT);
+        }
+
+        rc = memset_s(&hash_ctl, sizeof(hash_ctl), 0, sizeof(hash_ctl));
+        securec_check(rc, "\0", "\0");
+        hash_ctl.hcxt = card_feedback_mcxt;
+        hash_ctl.keysize = sizeof(CardFeedbackKey);
+        hash_ctl.entrysize = sizeof(CardFeedbackEntry);
+        hash_ctl.hash = tag_hash;
+
+        card_feedback_hash =
+            hash_create("cardinality feedback hash table", 256, &hash_ctl, HASH_ELEM | HASH_SHRCTX | HASH_FUNCTION);
+    }
+
+    LWLockRelease(CardFeedbackLock);
+
+    return card_feedback_hash;
+}
+
+/*
+ * Remove the corrections of a relation, or of every relation of a database
+ * if relid is invalid, or all of them if dbid is invalid too.  The caller
+ * holds CardFeedbackLock exclusively.
+ */
+static void feedback_remove(Oid dbid, Oid relid)
+{
+    HASH_SEQ_STATUS hash_seq;
+    CardFeedbackEntry* entry = NULL;
+
+    hash_seq_init(&hash_seq, card_feedback_hash);
+    while ((entry = (CardFeedbackEntry*)hash_seq_search(&hash_seq)) != NULL) {
+        if (OidIsValid(dbid) && entry->key.dbid != dbid) {
+            continue;
+        }
+        if (OidIsValid(relid) && entry->key.relid != relid) {
+            continue;
+        }
+        (void)hash_search(card_feedback_hash, &entry->key, HASH_REMOVE, NULL);
+    }
+}
+
+/* Make room for a new correction by dropping the least recently updated one */
+static void feedback_evict_oldest(void)
+{
+    HASH_SEQ_STATUS hash_seq;
+    CardFeedbackEntry* entry = NULL;
+    CardFeedbackKey oldest_key;
+    TimestampTz oldest = 0;
+    bool found = false;
+
+    hash_seq_init(&hash_seq, card_feedback_hash);
+    while ((entry = (CardFeedbackEntry*)hash_seq_search(&hash_seq)) != NULL) {
+        if (!found || entry->last_update < oldest) {
+            oldest_key = entry->key;
+            oldest = entry->last_update;
+            found = true;
+        }
+    }
+
+    if (found) {
+        (void)hash_search(card_feedback_hash, &oldest_key, HASH_REMOVE, NULL);
+    }
+}
+
+/*
+ * Fold the outcome of one execution into the correction of its predicate.
+ * The corrections are averaged in log space, and the history is weighted as
+ * at most CARD_FEEDBACK_MAX_WEIGHT executions so that it keeps following the
+ * data.
+ */
+static void feedback_store(Oid relid, uint32 signature, double estimated, double actual)
+{
+    double error = actual / estimated;
+    bool significant = (error >= CARD_FEEDBACK_MIN_ERROR || error <= 1.0 / CARD_FEEDBACK_MIN_ERROR);
+    CardFeedbackKey key;
+    CardFeedbackEntry* entry = NULL;
+    double weight;
+
+    /* Don't fill up the table with estimates that were good enough already */
+    if (!significant && card_feedback_hash == NULL) {
+        return;
+    }
+
+    HTAB* hash = get_card_feedback_hash();
+    feedback_key_init(&key, u_sess->proc_cxt.MyDatabaseId, relid, signature);
+
+    LWLockAcquire(CardFeedbackLock, LW_EXCLUSIVE);
+
+    entry = (CardFeedbackEntry*)hash_search(hash, &key, HASH_FIND, NULL);
+    if (entry == NULL) {
+        if (!significant) {
+            LWLockRelease(CardFeedbackLock);
+            return;
+        }
+
+        if (hash_get_num_entries(hash) >= CARD_FEEDBACK_MAX_ENTRIES) {
+            feedback_evict_oldest();
+        }
+
+        entry = (CardFeedbackEntry*)hash_search(hash, &key, HASH_ENTER, NULL);
+        entry->correction = 1.0;
+        entry->samples = 0;
+    }
+
+    weight = (double)Min(entry->samples, CARD_FEEDBACK_MAX_WEIGHT);
+    entry->correction = exp((log(entry->correction) * weight + log(error)) / (weight + 1));
+    entry->estimated = estimated;
+    entry->actual = actual;
+    entry->samples++;
+    entry->last_update = GetCurrentTimestamp();
+
+    LWLockRelease(CardFeedbackLock);
+}
+
+/*
+ * cardinality_feedback_adjust
+ *	  Correct the selectivity of the restriction clauses of a base relation
+ *	  with what earlier executions of the same predicate returned, and
+ *	  remember the signature and uncorrected rows for the scan plans.
+ */
+Selectivity cardinality_feedback_adjust(PlannerInfo* root, RelOptInfo* rel, Selectivity selec)
+{
+    RangeTblEntry* rte = planner_rt_fetch(rel->relid, root);
+    CardFeedbackKey key;
+    CardFeedbackEntry* entry = NULL;
+
+    rel->feedbackSignature = 0;
+
+    /* Only plain scans of ordinary tables are fed back */
+    if (rte->rtekind != RTE_RELATION || rte->relkind != RELKIND_RELATION || rel->isPartitionedTable ||
+        rte->tablesample != NULL) {
+        return selec;
+    }
+
+    rel->feedbackSignature = feedback_signature(rel->baserestrictinfo);
+    rel->feedbackRows = clamp_row_est(rel->tuples * selec);
+
+    if (card_feedback_hash == NULL) {
+        return selec;
+    }
+
+    feedback_key_init(&key, u_sess->proc_cxt.MyDatabaseId, rte->relid, rel->feedbackSignature);
+
+    LWLockAcquire(CardFeedbackLock, LW_SHARED);
+    entry = (CardFeedbackEntry*)hash_search(card_feedback_hash, &key, HASH_FIND, NULL);
+    if (entry != NULL) {
+        selec *= entry->correction;
+    }
+    LWLockRelease(CardFeedbackLock);
+
+    CLAMP_PROBABILITY(selec);
+
+    return selec;
+}
+
+/*
+ * cardinality_feedback_mark_scan
+ *	  Copy the feedback signature of a base relation to an unparameterized
+ *	  scan plan of it, so that the executor reports the rows it returns.
+ */
+void cardinality_feedback_mark_scan(RelOptInfo* rel, Plan* plan)
+{
+    Scan* scan = NULL;
+
+    switch (nodeTag(plan)) {
+        case T_SeqScan:
+        case T_IndexScan:
+        case T_IndexOnlyScan:
+        case T_BitmapHeapScan:
+        case T_TidScan:
+            break;
+        default:
+            return;
+    }
+
+    scan = (Scan*)plan;
+    if (scan->isPartTbl) {
+        return;
+    }
+
+    scan->feedbackSignature = rel->feedbackSignature;
+    scan->feedbackRows = rel->feedbackRows;
+}
+
+/*
+ * cardinality_feedback_tracked
+ *	  Does the executor need to count the rows of this plan node?
+ */
+bool cardinality_feedback_tracked(Plan* plan, EState* estate)
+{
+    switch (nodeTag(plan)) {
+        case T_SeqScan:
+        case T_IndexScan:
+        case T_IndexOnlyScan:
+        case T_BitmapHeapScan:
+        case T_TidScan:
+            break;
+        default:
+            return false;
+    }
+
+    /* A scan split among parallel workers only sees its share of the rows */
+    if (((Scan*)plan)->feedbackSignature == 0 || plan->dop > 1) {
+        return false;
+    }
+
+    return (estate->es_top_eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0;
+}
+
+static void feedback_record_node(PlanState* node)
+{
+    CardCounter* counter = node->cardcounter;
+    Scan* scan = (Scan*)node->plan;
+    double actual;
+
+    CardCounterEndLoop(counter);
+
+    /* A scan that was stopped early says nothing about its total rows */
+    if (counter->nloops == 0 || counter->nabandoned > 0) {
+        return;
+    }
+
+    actual = clamp_row_est(counter->ntuples / counter->nloops);
+    feedback_store(getrelid(scan->scanrelid, node->state->es_range_table),
+        scan->feedbackSignature, scan->feedbackRows, actual);
+}
+
+static void feedback_record_list(List* subplans)
+{
+    ListCell* lc = NULL;
+
+    foreach (lc, subplans) {
+        SubPlanState* sstate = (SubPlanState*)lfirst(lc);
+
+        cardinality_feedback_record(sstate->planstate);
+    }
+}
+
+/*
+ * cardinality_feedback_record
+ *	  Store the actual rows of the counted scans of a finished plan tree.
+ */
+void cardinality_feedback_record(PlanState* planstate)
+{
+    int i;
+
+    if (planstate == NULL) {
+        return;
+    }
+
+    if (planstate->cardcounter != NULL) {
+        feedback_record_node(planstate);
+    }
+
+    feedback_record_list(planstate->initPlan);
+    feedback_record_list(planstate->subPlan);
+
+    switch (nodeTag(planstate)) {
+        case T_AppendState: {
+            AppendState* append = (AppendState*)planstate;
+
+            for (i = 0; i < append->as_nplans; i++) {
+                cardinality_feedback_record(append->appendplans[i]);
+            }
+        } break;
+        case T_MergeAppendState: {
+            MergeAppendState* ma = (MergeAppendState*)planstate;
+
+            for (i = 0; i < ma->ms_nplans; i++) {
+                cardinality_feedback_record(ma->mergeplans[i]);
+            }
+        } break;
+        case T_ModifyTableState: {
+            ModifyTableState* mt = (ModifyTableState*)planstate;
+
+            for (i = 0; i < mt->mt_nplans; i++) {
+                cardinality_feedback_record(mt->mt_plans[i]);
+            }
+        } break;
+        case T_SubqueryScanState:
+            cardinality_feedback_record(((SubqueryScanState*)planstate)->subplan);
+            break;
+        default:
+            break;
+    }
+
+    cardinality_feedback_record(planstate->lefttree);
+    cardinality_feedback_record(planstate->righttree);
+}
+
+/*
+ * cardinality_feedback_expire
+ *	  Forget the corrections of a relation of the current database, once its
+ *	  statistics have been refreshed.
+ */
+void cardinality_feedback_expire(Oid relid)
+{
+    if (card_feedback_hash == NULL) {
+        return;
+    }
+
+    LWLockAcquire(CardFeedbackLock, LW_EXCLUSIVE);
+    feedback_remove(u_sess->proc_cxt.MyDatabaseId, relid);
+    LWLockRelease(CardFeedbackLock);
+}
+
+/*
+ * pg_cardinality_feedback
+ *	  List the corrections learnt by cardinality feedback.
+ */
+Datum pg_cardinality_feedback(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    CardFeedbackEntry* entries = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc = NULL;
+        MemoryContext old_context = NULL;
+        uint32 nentries = 0;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tup_desc = CreateTemplateTupleDesc(CARD_FEEDBACK_NATTS, false);
+        TupleDescInitEntry(tup_desc, (AttrNumber)1, "databaseid", OIDOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)2, "relid", OIDOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)3, "signature", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)4, "estimated_rows", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)5, "actual_rows", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)6, "correction", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)7, "samples", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)8, "last_update", TIMESTAMPTZOID, -1, 0);
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+
+        /* Take a copy so that the lock is not held across calls */
+        if (card_feedback_hash != NULL) {
+            HASH_SEQ_STATUS hash_seq;
+            CardFeedbackEntry* entry = NULL;
+
+            LWLockAcquire(CardFeedbackLock, LW_SHARED);
+
+            entries = (CardFeedbackEntry*)palloc(
+                Max(hash_get_num_entries(card_feedback_hash), 1) * sizeof(CardFeedbackEntry));
+            hash_seq_init(&hash_seq, card_feedback_hash);
+            while ((entry = (CardFeedbackEntry*)hash_seq_search(&hash_seq)) != NULL) {
+                entries[nentries++] = *entry;
+            }
+
+            LWLockRelease(CardFeedbackLock);
+        }
+
+        func_ctx->user_fctx = (void*)entries;
+        func_ctx->max_calls = nentries;
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    entries = (CardFeedbackEntry*)func_ctx->user_fctx;
+
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        CardFeedbackEntry* entry = &entries[func_ctx->call_cntr];
+        Datum values[CARD_FEEDBACK_NATTS];
+        bool nulls[CARD_FEEDBACK_NATTS] = {false};
+        HeapTuple tuple = NULL;
+        int i = 0;
+
+        values[i++] = ObjectIdGetDatum(entry->key.dbid);
+        values[i++] = ObjectIdGetDatum(entry->key.relid);
+        values[i++] = Int64GetDatum((int64)entry->key.signature);
+        values[i++] = Float8GetDatum(entry->estimated);
+        values[i++] = Float8GetDatum(entry->actual);
+        values[i++] = Float8GetDatum(entry->correction);
+        values[i++] = Int64GetDatum(entry->samples);
+        values[i++] = TimestampTzGetDatum(entry->last_update);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(func_ctx);
+}
+
+/*
+ * pg_cardinality_feedback_reset
+ *	  Forget all the corrections learnt by cardinality feedback.
+ */
+Datum pg_cardinality_feedback_reset(PG_FUNCTION_ARGS)
+{
+    if (!superuser()) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                errmsg("must be system admin to reset cardinality feedback")));
+    }
+
+    if (card_feedback_hash != NULL) {
+        LWLockAcquire(CardFeedbackLock, LW_EXCLUSIVE);
+        feedback_remove(InvalidOid, InvalidOid);
+        LWLockRelease(CardFeedbackLock);
+    }
+
+    PG_RETURN_VOID();
+}
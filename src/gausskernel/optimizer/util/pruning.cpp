@@ -23,6 +23,7 @@
  */
 #include "postgres.h"
 #include "knl/knl_variable.h"
+#include "access/heapam.h"
 #include "catalog/pg_type.h"
 #include "catalog/index.h"
 #include "nodes/makefuncs.h"
@@ -30,6 +31,7 @@
 #include "nodes/relation.h"
 #include "optimizer/clauses.h"
 #include "optimizer/pruning.h"
+#include "optimizer/var.h"
 #include "utils/array.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
@@ -57,6 +59,7 @@ static void destroyPruningResultList(List* resultList);
 static PruningBoundary* makePruningBoundary(int partKeyNum);
 static PruningBoundary* copyBoundary(PruningBoundary* boundary);
 static void generateListFromPruningBM(PruningResult* result);
+static bool pruningParamWalker(Node* node, void* context);
 
 PruningResult* getFullPruningResult(Relation relation)
 {
@@ -475,6 +478,7 @@ PruningResult* singlePartitionPruningForRestrictInfo(Oid partitionOid, Relation
  * @@GaussDB@@
  * Brief
  * Description	: eliminate partitions which don't contain those tuple satisfy expression.
+ *                root may be NULL when the executor prunes with the params already replaced by consts.
  * return value:  non-eliminated partitions.
  */
 PruningResult* partitionPruningForExpr(PlannerInfo* root, RangeTblEntry* rte, Relation rel, Expr* expr)
@@ -1010,7 +1014,9 @@ static PruningResult* recordBoundaryFromOpExpr(const OpExpr* expr, PruningContex
                 errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                 (errmsg("Could not find enough valid args for Boundary From OpExpr"))));
 
-    if (IsA(leftArg, Var)) {
+    if (context->root == NULL) {
+        /* executor pruning, nothing is left to estimate */
+    } else if (IsA(leftArg, Var)) {
         node = estimate_expression_value(context->root, (Node*)rightArg);
         if (node != NULL)
             rightArg = (Expr*)node;
@@ -1120,6 +1126,85 @@ static PruningResult* recordBoundaryFromOpExpr(const OpExpr* expr, PruningContex
     return result;
 }
 
+/*
+ * @@GaussDB@@
+ * Brief
+ * Description	: pick the clauses of a scan on a range partitioned table which could prune
+ *                partitions once their params are known: clauses holding params and on
+ *                partition key columns of the scanned relation only. The executor
+ *                evaluates the params and prunes again, see nodePartIterator.cpp.
+ * return value:  the clauses, NIL if none.
+ */
+List* getPartitionPruningParamQuals(PlannerInfo* root, Index relid, List* clauses)
+{
+    RangeTblEntry* rte = planner_rt_fetch(relid, root);
+    RangePartitionMap* partMap = NULL;
+    Relation rel = NULL;
+    ListCell* cell = NULL;
+    List* result = NIL;
+
+    if (clauses == NIL || rte->rtekind != RTE_RELATION) {
+        return NIL;
+    }
+
+    /* the planner holds a lock on it already */
+    rel = heap_open(rte->relid, NoLock);
+    if (!PointerIsValid(rel->partMap) || rel->partMap->type != PART_TYPE_RANGE) {
+        heap_close(rel, NoLock);
+        return NIL;
+    }
+    partMap = (RangePartitionMap*)rel->partMap;
+
+    foreach (cell, clauses) {
+        Node* clause = (Node*)lfirst(cell);
+        List* vars = NIL;
+        ListCell* lc = NULL;
+        bool onPartKey = false;
+        bool onOtherRel = false;
+
+        if (!pruningParamWalker(clause, NULL) || contain_volatile_functions(clause) || contain_subplans(clause)) {
+            continue;
+        }
+
+        vars = pull_var_clause(clause, PVC_RECURSE_AGGREGATES, PVC_RECURSE_PLACEHOLDERS);
+        foreach (lc, vars) {
+            Var* var = (Var*)lfirst(lc);
+
+            if (!IsA(var, Var) || var->varno != relid || var->varlevelsup != 0) {
+                onOtherRel = true;
+                break;
+            }
+            if (varIsInPartitionKey(var->varattno, partMap->partitionKey, partMap->partitionKey->dim1) >= 0) {
+                onPartKey = true;
+            }
+        }
+        list_free_ext(vars);
+
+        if (onPartKey && !onOtherRel) {
+            result = lappend(result, copyObject(clause));
+        }
+    }
+
+    heap_close(rel, NoLock);
+    return result;
+}
+
+/*
+ * does the clause hold a param, which the executor knows but the planner does not?
+ */
+static bool pruningParamWalker(Node* node, void* context)
+{
+    if (node == NULL) {
+        return false;
+    }
+    if (IsA(node, Param)) {
+        Param* param = (Param*)node;
+
+        return param->paramkind == PARAM_EXTERN || param->paramkind == PARAM_EXEC;
+    }
+    return expression_tree_walker(node, (bool (*)())pruningParamWalker, context);
+}
+
 int varIsInPartitionKey(int attrNo, int2vector* partKeyAttrs, int partKeyNum)
 {
     int i = 0;
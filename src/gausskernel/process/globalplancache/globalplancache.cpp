@@ -458,6 +458,8 @@ void GlobalPlanCache::PlanStore(CachedPlanSource *plansource)
     Assert (plansource->magic == CACHEDPLANSOURCE_MAGIC);
     Assert (plansource->gpc.is_insert == true);
 
+    VariantsInit(plansource);
+
     GPCKey key;
     key.query_string = plansource->query_string;
     key.query_length = strlen(plansource->query_string);
@@ -0,0 +1,425 @@
+/*
+* Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+*
+* openGauss is licensed under Mulan PSL v2.
+* You can use this software according to the terms and conditions of the Mulan PSL v2.
+* You may obtain a copy of Mulan PSL v2 at:
+*
+*          http://license.coscl.org.cn/MulanPSL2
+*
+* THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+* EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+* MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+* See the Mulan PSL v2 for more details.
+* -------------------------------------------------------------------------
+*
+* globalplancache_variant.cpp
+*    parameter sensitive plan variants of the global plan cache
+*
+* A shared plan source only has a generic plan, which is estimated with the
+* average selectivity of its parameters.  When a parameter compared with "="
+* to a column hits one of the most common values of that column, the generic
+* plan can be far off, so such bindings get a plan of their own: the values
+* are bucketed by their MCV frequency and every combination of buckets keeps
+* one plan, built with the values as estimates only, so that it stays valid
+* for the other values of the same buckets.  The most common values that
+* fall beyond the lowest bucket are copied into the plan source when its
+* deciding parameters are found, so a binding only compares its values with
+* them and never reads the statistics again.
+*
+* IDENTIFICATION
+*     src/gausskernel/process/globalplancache/globalplancache_variant.cpp
+*
+* -------------------------------------------------------------------------
+*/
+
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "catalog/pg_proc.h"
+#include "catalog/pg_statistic.h"
+#include "nodes/nodeFuncs.h"
+#include "parser/parsetree.h"
+#include "utils/datum.h"
+#include "utils/globalplancache.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/plancache.h"
+#include "utils/syscache.h"
+
+/* MCV frequencies starting the selectivity buckets 1, 2 and 3 */
+#define GPC_SELEC_BUCKET1 (0.01)
+#define GPC_SELEC_BUCKET2 (0.1)
+#define GPC_SELEC_BUCKET3 (0.5)
+
+typedef struct GPCDecidingParamContext
+{
+    Query *query;
+    int num_params;
+    GPCDecidingParam params[GPC_MAX_DECIDING_PARAMS];
+} GPCDecidingParamContext;
+
+static bool GPCFindDecidingParams(Node *node, GPCDecidingParamContext *context)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    /* sub-queries have range tables of their own */
+    if (IsA(node, Query) || IsA(node, SubLink)) {
+        return false;
+    }
+
+    if (IsA(node, OpExpr) && list_length(((OpExpr *)node)->args) == 2 &&
+        context->num_params < GPC_MAX_DECIDING_PARAMS) {
+        OpExpr *op = (OpExpr *)node;
+        Node *left = (Node *)linitial(op->args);
+        Node *right = (Node *)lsecond(op->args);
+        bool varonleft = IsA(left, Var);
+        Var *var = (Var *)(varonleft ? left : right);
+        Param *param = (Param *)(varonleft ? right : left);
+
+        if (IsA(var, Var) && IsA(param, Param) && param->paramkind == PARAM_EXTERN &&
+            var->varlevelsup == 0 && var->varattno > 0 &&
+            get_oprrest(op->opno) == EQSELRETURNOID) {
+            RangeTblEntry *rte = rt_fetch(var->varno, context->query->rtable);
+
+            if (rte->rtekind == RTE_RELATION) {
+                GPCDecidingParam *dp = &context->params[context->num_params++];
+
+                dp->paramid = param->paramid;
+                dp->relid = rte->relid;
+                dp->attnum = var->varattno;
+                dp->vartype = var->vartype;
+                dp->vartypmod = var->vartypmod;
+                dp->collid = var->varcollid;
+                dp->opfuncid = get_opcode(op->opno);
+                dp->varonleft = varonleft;
+            }
+        }
+        return false;
+    }
+
+    return expression_tree_walker(node, (bool (*)())GPCFindDecidingParams, (void *)context);
+}
+
+static uint32 GPCSelecBucket(double selec)
+{
+    if (selec < GPC_SELEC_BUCKET1) {
+        return 0;
+    } else if (selec < GPC_SELEC_BUCKET2) {
+        return 1;
+    } else if (selec < GPC_SELEC_BUCKET3) {
+        return 2;
+    }
+    return 3;
+}
+
+/*
+ * Copy the most common values of the column of a deciding param that are
+ * beyond the lowest selectivity bucket, with their buckets, into cxt.
+ */
+static void GPCLoadParamMCVs(GPCDecidingParam *dp, MemoryContext cxt)
+{
+    HeapTuple statsTuple = NULL;
+    Datum *values = NULL;
+    int nvalues = 0;
+    float4 *numbers = NULL;
+    int nnumbers = 0;
+
+    dp->num_mcvs = 0;
+    dp->mcv_values = NULL;
+    dp->mcv_buckets = NULL;
+
+    statsTuple = SearchSysCache4(STATRELKINDATTINH,
+                                 ObjectIdGetDatum(dp->relid),
+                                 CharGetDatum(STARELKIND_CLASS),
+                                 Int16GetDatum(dp->attnum),
+                                 BoolGetDatum(false));
+    if (!HeapTupleIsValid(statsTuple)) {
+        return;
+    }
+
+    if (get_attstatsslot(statsTuple, dp->vartype, dp->vartypmod, STATISTIC_KIND_MCV, InvalidOid, NULL,
+                         &values, &nvalues, &numbers, &nnumbers)) {
+        int16 typlen;
+        bool typbyval = false;
+        MemoryContext oldcxt = MemoryContextSwitchTo(cxt);
+
+        get_typlenbyval(dp->vartype, &typlen, &typbyval);
+        dp->mcv_values = (Datum *)palloc(sizeof(Datum) * Max(nvalues, 1));
+        dp->mcv_buckets = (uint8 *)palloc(sizeof(uint8) * Max(nvalues, 1));
+        for (int i = 0; i < nvalues && i < nnumbers; i++) {
+            uint32 bucket = GPCSelecBucket(numbers[i]);
+
+            /* the values of the lowest bucket are served by the generic plan like any other */
+            if (bucket != 0) {
+                dp->mcv_values[dp->num_mcvs] = datumCopy(values[i], typbyval, typlen);
+                dp->mcv_buckets[dp->num_mcvs++] = (uint8)bucket;
+            }
+        }
+
+        (void)MemoryContextSwitchTo(oldcxt);
+        free_attstatsslot(dp->vartype, values, nvalues, numbers, nnumbers);
+    }
+
+    ReleaseSysCache(statsTuple);
+}
+
+/*
+ * The deciding params are looked for at the first binding, inside a
+ * transaction, because the plan source is shared at commit time.
+ */
+static void GPCResolveDecidingParams(CachedPlanSource *plansource, GPCPlanVariants *variants)
+{
+    GPCDecidingParamContext context;
+    ListCell *lc = NULL;
+    MemoryContext stats_context = NULL;
+
+    context.query = NULL;
+    context.num_params = 0;
+    foreach (lc, plansource->query_list) {
+        Query *query = (Query *)lfirst(lc);
+
+        if (IsA(query, Query) && query->commandType != CMD_UTILITY && query->jointree != NULL) {
+            context.query = query;
+            (void)GPCFindDecidingParams((Node *)query->jointree, &context);
+            break;
+        }
+    }
+
+    /* read the statistics before taking the flag, it may fail */
+    if (context.num_params > 0) {
+        stats_context = AllocSetContextCreate(plansource->context,
+                                              "CachedPlanVariantStats",
+                                              ALLOCSET_SMALL_MINSIZE,
+                                              ALLOCSET_SMALL_INITSIZE,
+                                              ALLOCSET_DEFAULT_MAXSIZE,
+                                              SHARED_CONTEXT);
+        for (int i = 0; i < context.num_params; i++) {
+            GPCLoadParamMCVs(&context.params[i], stats_context);
+        }
+    }
+
+    while (!gs_compare_and_swap_32(&variants->CAS_flag, FALSE, TRUE))
+        pg_usleep(CAS_SLEEP_DURATION);
+
+    if (!variants->resolved) {
+        for (int i = 0; i < context.num_params; i++) {
+            variants->params[i] = context.params[i];
+        }
+        variants->num_params = context.num_params;
+        variants->stats_context = stats_context;
+        stats_context = NULL;
+        pg_write_barrier();
+        variants->resolved = true;
+    }
+
+    gs_compare_and_swap_32(&variants->CAS_flag, TRUE, FALSE);
+
+    /* another session has resolved them meanwhile */
+    if (stats_context != NULL) {
+        MemoryContextDelete(stats_context);
+    }
+}
+
+/*
+ * Bucket of the value of a deciding param, from the most common values kept
+ * with the param.  The other values are in the lowest bucket.
+ */
+static uint32 GPCParamBucket(const GPCDecidingParam *dp, Datum value)
+{
+    FmgrInfo eqproc;
+
+    if (dp->num_mcvs == 0) {
+        return 0;
+    }
+
+    fmgr_info(dp->opfuncid, &eqproc);
+    for (int i = 0; i < dp->num_mcvs; i++) {
+        bool match = false;
+
+        if (dp->varonleft) {
+            match = DatumGetBool(FunctionCall2Coll(&eqproc, dp->collid, dp->mcv_values[i], value));
+        } else {
+            match = DatumGetBool(FunctionCall2Coll(&eqproc, dp->collid, value, dp->mcv_values[i]));
+        }
+        if (match) {
+            return dp->mcv_buckets[i];
+        }
+    }
+
+    return 0;
+}
+
+/* Copy a plan built by this session into the shared memory of the plan source */
+static CachedPlan *GPCCopyCachedPlan(CachedPlanSource *plansource, CachedPlan *plan)
+{
+    MemoryContext plan_context = AllocSetContextCreate(plansource->context,
+                                                       "CachedPlanVariant",
+                                                       ALLOCSET_SMALL_MINSIZE,
+                                                       ALLOCSET_SMALL_INITSIZE,
+                                                       ALLOCSET_DEFAULT_MAXSIZE,
+                                                       SHARED_CONTEXT);
+    MemoryContext oldcxt = MemoryContextSwitchTo(plan_context);
+    CachedPlan *newplan = (CachedPlan *)palloc(sizeof(CachedPlan));
+
+    *newplan = *plan;
+    newplan->stmt_list = (List *)copyObject(plan->stmt_list);
+    newplan->context = plan_context;
+    newplan->is_saved = true;
+    newplan->is_share = true;
+    /* the reference of the variant array */
+    newplan->refcount = 1;
+
+    MemoryContextSwitchTo(oldcxt);
+    return newplan;
+}
+
+/*
+ * @Description: Prepare a plan source for variants, when it is shared.
+ * @in plansource: the plan source stored in the global plan cache
+ * @return - void
+ */
+void GlobalPlanCache::VariantsInit(CachedPlanSource *plansource)
+{
+    Assert(plansource->gpc.variants == NULL);
+
+    plansource->gpc.variants =
+        (GPCPlanVariants *)MemoryContextAllocZero(plansource->context, sizeof(GPCPlanVariants));
+}
+
+/*
+ * @Description: Compute the selectivity buckets of the deciding params of a binding.
+ * @in plansource: a shared plan source
+ * @in boundParams: the values of the binding
+ * @return - the signature of the variant to use, 0 for the generic plan
+ */
+uint32 GlobalPlanCache::VariantSignature(CachedPlanSource *plansource, ParamListInfo boundParams)
+{
+    GPCPlanVariants *variants = plansource->gpc.variants;
+    uint32 signature = 0;
+
+    if (variants == NULL || boundParams == NULL) {
+        return 0;
+    }
+
+    if (!variants->resolved) {
+        GPCResolveDecidingParams(plansource, variants);
+    }
+    pg_read_barrier();
+
+    for (int i = 0; i < variants->num_params; i++) {
+        const GPCDecidingParam *dp = &variants->params[i];
+        ParamExternData *prm = NULL;
+
+        if (dp->paramid <= 0 || dp->paramid > boundParams->numParams) {
+            continue;
+        }
+
+        prm = &boundParams->params[dp->paramid - 1];
+        if (!OidIsValid(prm->ptype) && boundParams->paramFetch != NULL) {
+            (*boundParams->paramFetch)(boundParams, dp->paramid);
+        }
+        if (prm->isnull || !OidIsValid(prm->ptype)) {
+            continue;
+        }
+
+        signature |= GPCParamBucket(dp, prm->value) << (uint32)(i * GPC_SELEC_BUCKET_BITS);
+    }
+
+    return signature;
+}
+
+/*
+ * @Description: Find the plan of a signature and count the hit.
+ * @in plansource: a shared plan source
+ * @in signature: the result of VariantSignature
+ * @return - the plan, NULL if the variant has not been built yet
+ */
+CachedPlan* GlobalPlanCache::VariantFetch(CachedPlanSource *plansource, uint32 signature)
+{
+    GPCPlanVariants *variants = plansource->gpc.variants;
+
+    if (variants == NULL || signature == 0) {
+        if (variants != NULL) {
+            (void)gs_atomic_add_64(&variants->generic_hits, 1);
+        }
+        return plansource->gplan;
+    }
+
+    int num_variants = gs_atomic_add_32(&variants->num_variants, 0);
+    pg_read_barrier();
+    for (int i = 0; i < num_variants; i++) {
+        GPCPlanVariant *variant = &variants->variants[i];
+
+        if (variant->signature == signature) {
+            (void)gs_atomic_add_64(&variant->hits, 1);
+            return variant->plan;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * @Description: Share the plan built for a signature.
+ * @in plansource: a shared plan source
+ * @in signature: the result of VariantSignature
+ * @in plan: a plan built by this session, left to the caller
+ * @return - the shared plan of the signature, or the generic plan when the
+ *           plan can not be shared or all the variants are taken
+ */
+CachedPlan* GlobalPlanCache::VariantStore(CachedPlanSource *plansource, uint32 signature, CachedPlan *plan)
+{
+    GPCPlanVariants *variants = plansource->gpc.variants;
+    CachedPlan *newplan = NULL;
+    CachedPlan *result = NULL;
+
+    Assert(variants != NULL && signature != 0);
+
+    /* such plans would have to be checked again by every session */
+    if (plan->dependsOnRole || TransactionIdIsValid(plan->saved_xmin) ||
+        gs_atomic_add_32(&variants->num_variants, 0) >= GPC_MAX_PLAN_VARIANTS) {
+        (void)gs_atomic_add_64(&variants->generic_hits, 1);
+        return plansource->gplan;
+    }
+
+    /* copy before taking the flag, the copy may fail */
+    newplan = GPCCopyCachedPlan(plansource, plan);
+
+    while (!gs_compare_and_swap_32(&variants->CAS_flag, FALSE, TRUE))
+        pg_usleep(CAS_SLEEP_DURATION);
+
+    /* another session may have stored the same variant meanwhile */
+    for (int i = 0; i < variants->num_variants; i++) {
+        if (variants->variants[i].signature == signature) {
+            result = variants->variants[i].plan;
+            (void)gs_atomic_add_64(&variants->variants[i].hits, 1);
+            break;
+        }
+    }
+
+    if (result == NULL && variants->num_variants < GPC_MAX_PLAN_VARIANTS) {
+        GPCPlanVariant *variant = &variants->variants[variants->num_variants];
+
+        variant->signature = signature;
+        variant->plan = newplan;
+        variant->hits = 1;
+        pg_write_barrier();
+        variants->num_variants++;
+        result = newplan;
+    }
+
+    gs_compare_and_swap_32(&variants->CAS_flag, TRUE, FALSE);
+
+    if (result != newplan) {
+        MemoryContextDelete(newplan->context);
+    }
+    if (result == NULL) {
+        (void)gs_atomic_add_64(&variants->generic_hits, 1);
+        result = plansource->gplan;
+    }
+
+    return result;
+}
@@ -213,6 +213,89 @@ void *GlobalPlanCache::GetPrepareStatus(uint32 *num)
     return stat_array;
 }
 
+/*
+* @Description: get the hit counts of the plan variants from hashtable
+* @in num: the number of variants, the generic plans included
+* @return - void
+*/
+void *GlobalPlanCache::GetVariantStatus(uint32 *num)
+{
+    int rc = EOK;
+    HASH_SEQ_STATUS hash_seq;
+    GPCEntry *entry = NULL;
+    GPCEnv *env = NULL;
+    GPCPlanVariants *variants = NULL;
+
+    for (int i = 0; i < NUM_GPC_PARTITIONS; i++) {
+        (void)LWLockAcquire(GetMainLWLockByIndex(FirstGPCMappingLock + i), LW_SHARED);
+    }
+
+    *num = 0;
+
+    hash_seq_init(&hash_seq, m_global_plan_cache);
+    while ((entry = (GPCEntry*)hash_seq_search(&hash_seq)) != NULL) {
+        for (DListCell *cell = entry->cachedPlans->head; cell != NULL; cell = cell->next) {
+            env = (GPCEnv *) cell->data.ptr_value;
+            variants = env->plansource->gpc.variants;
+            if (variants != NULL) {
+                *num = (*num) + 1 + (uint32)gs_atomic_add_32(&variants->num_variants, 0);
+            }
+        }
+    }
+
+    if ((*num) == 0) {
+        for (int i = NUM_GPC_PARTITIONS - 1; i >= 0; i--) {
+            LWLockRelease(GetMainLWLockByIndex(FirstGPCMappingLock + i));
+        }
+        return NULL;
+    }
+
+    GPCVariantStatus *stat_array = (GPCVariantStatus*) palloc0(*num * sizeof(GPCVariantStatus));
+
+    hash_seq_init(&hash_seq, m_global_plan_cache);
+
+    uint32 index = 0;
+    while ((entry = (GPCEntry*)hash_seq_search(&hash_seq)) != NULL) {
+        for (DListCell *cell = entry->cachedPlans->head; cell != NULL; cell = cell->next) {
+            env = (GPCEnv *) cell->data.ptr_value;
+            variants = env->plansource->gpc.variants;
+            if (variants == NULL || index >= *num) {
+                continue;
+            }
+
+            /* variants added since the count are left out */
+            int num_variants = gs_atomic_add_32(&variants->num_variants, 0);
+            num_variants = Min(num_variants, (int)(*num - index) - 1);
+            pg_read_barrier();
+
+            size_t len = strlen(env->plansource->query_string) + 1;
+            for (int i = 0; i <= num_variants; i++) {
+                stat_array[index].query = (char *)palloc0(sizeof(char) * len);
+                rc = memcpy_s(stat_array[index].query, len, env->plansource->query_string, len);
+                securec_check(rc, "\0", "\0");
+
+                /* variant 0 is the generic plan */
+                stat_array[index].variant = i;
+                if (i == 0) {
+                    stat_array[index].signature = 0;
+                    stat_array[index].hits = gs_atomic_add_64(&variants->generic_hits, 0);
+                } else {
+                    stat_array[index].signature = variants->variants[i - 1].signature;
+                    stat_array[index].hits = gs_atomic_add_64(&variants->variants[i - 1].hits, 0);
+                }
+                index++;
+            }
+        }
+    }
+
+    for (int i = NUM_GPC_PARTITIONS - 1; i >= 0; i--) {
+        LWLockRelease(GetMainLWLockByIndex(FirstGPCMappingLock + i));
+    }
+
+    *num = index;
+    return stat_array;
+}
+
 /*
  * @Description: Clean all the global plancaches which refcount is 0.
  * This function only be called when user call the global_plancache_clean() by themselves.
@@ -20,6 +20,10 @@
  * This thread will detect the occurrence of a lwlock deadlock,
  * and do the post-processing.
  *
+ * With track_lwlock_timing on, it also reports at every round the lwlock
+ * tranches waited for the longest since the previous round.  The same
+ * contention statistics are shown by pg_lwlock_tranche_stats().
+ *
  * IDENTIFICATION
  *	  src/gausskernel/process/postmaster/lwlockmonitor.cpp
  *
@@ -40,16 +44,26 @@
 #include "postmaster/autovacuum.h"
 #include "postmaster/postmaster.h"
 #include "access/hash.h"
+#include "catalog/pg_type.h"
+#include "funcapi.h"
 #include "storage/ipc.h"
 #include "storage/lmgr.h"
 #include "storage/lock.h"
 #include "storage/proc.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/timestamp.h"
+#include "utils/tuplestore.h"
 
 #define DEFAULT_HOLDERS_NUM 8
 
+/* number of tranches in a contention report */
+#define LWM_CONTENTION_REPORT_NUM 5
+
+#define LWLOCK_TRANCHE_STATS_COLS 8
+
 typedef struct {
     LWLockAddr lock_addr; // Use LWLockAddr instead of LWLock* to avoid misuse during key hash
     int holders_curnum;
@@ -575,6 +589,61 @@ static int choose_one_victim(lwm_deadlock* deadlock, int* out_idx)
     return ((backend_index >= 0) ? backend_index : ((auxproc_index >= MAX_BACKEND_SLOT) ? auxproc_index : -1));
 }
 
+/*
+ * Log the tranches waited for the longest since the previous report, last
+ * holds the statistics seen then and is updated.
+ */
+static void lwm_report_contention(LWLockTrancheStat* last)
+{
+    LWLockTrancheStat* delta = (LWLockTrancheStat*)palloc0(sizeof(LWLockTrancheStat) * LWTRANCHE_NATIVE_TRANCHE_NUM);
+    int top[LWM_CONTENTION_REPORT_NUM];
+    int ntop = 0;
+
+    for (int i = 0; i < LWTRANCHE_NATIVE_TRANCHE_NUM; i++) {
+        LWLockTrancheStat cur;
+        int pos;
+
+        LWLockGetTrancheStat(i, &cur);
+        delta[i].wait_count = cur.wait_count - last[i].wait_count;
+        delta[i].wait_time = cur.wait_time - last[i].wait_time;
+        delta[i].hold_count = cur.hold_count - last[i].hold_count;
+        delta[i].hold_time = cur.hold_time - last[i].hold_time;
+        delta[i].handoff_count = cur.handoff_count - last[i].handoff_count;
+        last[i] = cur;
+
+        if (delta[i].wait_count == 0) {
+            continue;
+        }
+
+        /* keep the top list sorted by wait time */
+        pos = Min(ntop, LWM_CONTENTION_REPORT_NUM - 1);
+        if (ntop == LWM_CONTENTION_REPORT_NUM && delta[top[pos]].wait_time >= delta[i].wait_time) {
+            continue;
+        }
+        while (pos > 0 && delta[top[pos - 1]].wait_time < delta[i].wait_time) {
+            top[pos] = top[pos - 1];
+            pos--;
+        }
+        top[pos] = i;
+        ntop = Min(ntop + 1, LWM_CONTENTION_REPORT_NUM);
+    }
+
+    for (int i = 0; i < ntop; i++) {
+        LWLockTrancheStat* stat = &delta[top[i]];
+
+        ereport(LOG,
+            (errmsg("lwlock contention on %s: %lu waits for %lu us, %lu holds for %lu us, %lu handoffs",
+                GetLWLockIdentifier(PG_WAIT_LWLOCK, (uint16)top[i]),
+                stat->wait_count,
+                stat->wait_time,
+                stat->hold_count,
+                stat->hold_time,
+                stat->handoff_count)));
+    }
+
+    pfree(delta);
+}
+
 void lw_deadlock_auto_healing(lwm_deadlock* deadlock)
 {
     /* choose one thread to be victim */
@@ -602,6 +671,7 @@ NON_EXEC_STATIC void FaultMonitorMain()
 
     lwm_light_detect* prev_snapshot = NULL;
     lwm_light_detect* curr_snapshot = NULL;
+    LWLockTrancheStat* last_contention = NULL;
     long cur_timeout = 0;
 
     /* we are a postmaster subprocess now */
@@ -643,6 +713,10 @@ NON_EXEC_STATIC void FaultMonitorMain()
         ALLOCSET_DEFAULT_MAXSIZE);
     (void)MemoryContextSwitchTo(lwm_context);
 
+    /* survives the resets of lwm_context */
+    last_contention = (LWLockTrancheStat*)MemoryContextAllocZero(
+        t_thrd.top_mem_cxt, sizeof(LWLockTrancheStat) * LWTRANCHE_NATIVE_TRANCHE_NUM);
+
 #ifdef ENABLE_UT
     /* unit testcase */
     ut_test_find_deadlock_cycle();
@@ -769,6 +843,10 @@ NON_EXEC_STATIC void FaultMonitorMain()
             cur_timeout = 10 * 60 * 1000;
         }
 
+        if (u_sess->attr.attr_common.track_lwlock_timing) {
+            lwm_report_contention(last_contention);
+        }
+
         pgstat_report_activity(STATE_IDLE, NULL);
         rc = WaitLatch(&t_thrd.proc->procLatch, WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH, cur_timeout);
 
@@ -782,6 +860,91 @@ NON_EXEC_STATIC void FaultMonitorMain()
     }
 }
 
+static Datum lwm_histogram_datum(const pg_atomic_uint64* hist)
+{
+    Datum buckets[LWLOCK_TIMING_BUCKETS];
+
+    for (int i = 0; i < LWLOCK_TIMING_BUCKETS; i++) {
+        buckets[i] = Int64GetDatum((int64)hist[i]);
+    }
+    return PointerGetDatum(construct_array(buckets, LWLOCK_TIMING_BUCKETS, INT8OID, sizeof(int64), FLOAT8PASSBYVAL, 'd'));
+}
+
+/*
+ * pg_lwlock_tranche_stats - contention statistics of every lwlock tranche
+ *
+ * The times are in microseconds and only counted while track_lwlock_timing
+ * is on.  Element i of the histograms counts the durations of at least
+ * 2^(i-1) and less than 2^i microseconds.
+ */
+Datum pg_lwlock_tranche_stats(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo* rsinfo = (ReturnSetInfo*)fcinfo->resultinfo;
+    TupleDesc tupdesc;
+    Tuplestorestate* tupstore = NULL;
+    MemoryContext per_query_ctx;
+    MemoryContext oldcontext;
+
+    /* check to see if caller supports us returning a tuplestore */
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("set-valued function called in context that cannot accept a set")));
+    }
+    if (!(rsinfo->allowedModes & SFRM_Materialize)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("materialize mode required, but it is not allowed in this context")));
+    }
+
+    /* need to build tuplestore in query context */
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    tupdesc = CreateTemplateTupleDesc(LWLOCK_TRANCHE_STATS_COLS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber)1, "tranche", TEXTOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)2, "wait_count", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)3, "wait_time", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)4, "wait_histogram", INT8ARRAYOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)5, "hold_count", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)6, "hold_time", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)7, "hold_histogram", INT8ARRAYOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber)8, "handoff_count", INT8OID, -1, 0);
+
+    tupstore =
+        tuplestore_begin_heap(rsinfo->allowedModes & SFRM_Materialize_Random, false, u_sess->attr.attr_memory.work_mem);
+
+    /* generate junk in short-term context */
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    for (int i = 0; i < LWTRANCHE_NATIVE_TRANCHE_NUM; i++) {
+        LWLockTrancheStat stat;
+        Datum values[LWLOCK_TRANCHE_STATS_COLS];
+        bool nulls[LWLOCK_TRANCHE_STATS_COLS] = {false};
+
+        LWLockGetTrancheStat(i, &stat);
+        values[0] = CStringGetTextDatum(GetLWLockIdentifier(PG_WAIT_LWLOCK, (uint16)i));
+        values[1] = Int64GetDatum((int64)stat.wait_count);
+        values[2] = Int64GetDatum((int64)stat.wait_time);
+        values[3] = lwm_histogram_datum(stat.wait_hist);
+        values[4] = Int64GetDatum((int64)stat.hold_count);
+        values[5] = Int64GetDatum((int64)stat.hold_time);
+        values[6] = lwm_histogram_datum(stat.hold_hist);
+        values[7] = Int64GetDatum((int64)stat.handoff_count);
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+
+    /* clean up and return the tuplestore */
+    tuplestore_donestoring(tupstore);
+
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    return (Datum)0;
+}
+
 /* SIGHUP: set flag to re-read config file at next convenient time */
 static void LWLockMonitorSigHupHandler(SIGNAL_ARGS)
 {
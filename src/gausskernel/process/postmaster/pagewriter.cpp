@@ -588,6 +588,7 @@ static void ckpt_pagewriter_main_thread_flush_dirty_page()
         smgrcloseall();
 
         actual_flushed = ckpt_move_queue_head_after_flush(try_move_head, offset_to_new_head);
+        dw_perform_end();
 
         if (u_sess->attr.attr_storage.log_pagewriter) {
             ereport(LOG,
@@ -779,6 +780,11 @@ static void ckpt_pagewriter_handle_exception(MemoryContext pagewriter_context)
      */
     pg_usleep(1000000L);
 
+    /* The batch is abandoned, do not let checkpoints wait for it */
+    if (t_thrd.pagewriter_cxt.pagewriter_id == 0) {
+        dw_perform_end();
+    }
+
     /*
      * Close all open files after any error.  This is helpful on Windows,
      * where holding deleted files open causes various strange errors.
@@ -2898,6 +2898,10 @@ void pgstat_bestart(void)
     beentry->st_activity[g_instance.attr.attr_common.pgstat_track_activity_query_size - 1] = '\0';
 
     beentry->st_queryid = 0;
+    beentry->st_io_throttle_count = 0;
+    beentry->st_io_throttle_time = 0;
+    beentry->st_last_io_throttle_count = 0;
+    beentry->st_last_io_throttle_time = 0;
     beentry->st_tid = gettid();
     beentry->st_parent_sessionid = 0;
     beentry->st_thread_level = 0;
@@ -3360,9 +3364,38 @@ void pgstat_report_queryid(uint64 queryid)
      * may modify, there seems no need to bother with the st_changecount
      * protocol.  The update must appear atomic in any case.
      */
+    if (queryid != 0 && queryid != beentry->st_queryid) {
+        /*
+         * IO throttling is reported for each query.  Keep the figures of the
+         * finished query, so that a later query of the session, such as one
+         * reading gs_session_io_throttle, can still see them.
+         */
+        pgstat_increment_changecount_before(beentry);
+        beentry->st_last_io_throttle_count = beentry->st_io_throttle_count;
+        beentry->st_last_io_throttle_time = beentry->st_io_throttle_time;
+        beentry->st_io_throttle_count = 0;
+        beentry->st_io_throttle_time = 0;
+        pgstat_increment_changecount_after(beentry);
+    }
     beentry->st_queryid = queryid;
 }
 
+/*
+ * Add a wait of the current query for IO tokens of its resource pool.
+ */
+void pgstat_report_io_throttle(int64 usecs)
+{
+    volatile PgBackendStatus* beentry = t_thrd.shemem_ptr_cxt.MyBEEntry;
+
+    if (IS_PGSTATE_TRACK_UNDEFINE)
+        return;
+
+    pgstat_increment_changecount_before(beentry);
+    beentry->st_io_throttle_count++;
+    beentry->st_io_throttle_time += usecs;
+    pgstat_increment_changecount_after(beentry);
+}
+
 void pgstat_report_jobid(uint64 jobid)
 {
     volatile PgBackendStatus* beentry = t_thrd.shemem_ptr_cxt.MyBEEntry;
@@ -8948,7 +8981,7 @@ TableDistributionInfo* get_remote_stat_double_write(TupleDesc tuple_desc)
     appendStringInfo(&buf,
         "SELECT node_name, curr_dwn, curr_start_page, file_trunc_num, file_reset_num, "
         "total_writes, low_threshold_writes, high_threshold_writes, "
-        "total_pages, low_threshold_pages, high_threshold_pages "
+        "total_pages, low_threshold_pages, high_threshold_pages, skipped_pages "
         "FROM local_double_write_stat();");
 
     /* send sql and parallel fetch distribution info from all data nodes */
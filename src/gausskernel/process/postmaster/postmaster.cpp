@@ -208,6 +208,7 @@ int bbox_handler_exit = 0;
 #include "utils/distribute_test.h"
 
 #include "commands/user.h"
+#include "commands/vacuum.h"
 
 extern int S3_init();
 extern void TermMOT();
@@ -9635,7 +9636,7 @@ int GaussDbThreadMain(knl_thread_arg* arg)
     if ((thread_role != WORKER && thread_role != THREADPOOL_WORKER && thread_role != STREAM_WORKER) &&
         u_sess->attr.attr_resource.use_workload_manager && g_instance.attr.attr_resource.enable_backend_control &&
         g_instance.wlm_cxt->gscgroup_init_done) {
-        if (thread_role == AUTOVACUUM_WORKER)
+        if (thread_role == AUTOVACUUM_WORKER || thread_role == VACUUM_INDEX_WORKER)
             (void)gscgroup_attach_backend_task(GSCGROUP_VACUUM, false);
         else
             (void)gscgroup_attach_backend_task(GSCGROUP_DEFAULT_BACKEND, false);
@@ -9769,6 +9770,12 @@ int GaussDbThreadMain(knl_thread_arg* arg)
             proc_exit(0);
         } break;
 
+        case VACUUM_INDEX_WORKER: {
+            /* attaches to shared memory itself, see there */
+            VacuumIndexWorkerMain(arg->payload);
+            proc_exit(0);
+        } break;
+
         case CATCHUP: {
             InitProcessAndShareMemory();
             CatchupMain();
@@ -10011,12 +10018,14 @@ static GaussdbThreadEntry GaussdbThreadEntryGate[] = {GaussDbThreadMain<MASTER>,
     GaussDbThreadMain<COMM_RECEIVERFLOWER>,
     GaussDbThreadMain<COMM_RECEIVER>,
     GaussDbThreadMain<COMM_AUXILIARY>,
-    GaussDbThreadMain<COMM_POOLER_CLEAN>};
+    GaussDbThreadMain<COMM_POOLER_CLEAN>,
+    GaussDbThreadMain<VACUUM_INDEX_WORKER>};
 
 const char* GaussdbThreadName[] = {"main",
     "worker",
     "thread pool worker",
     "thread pool listner",
+    "thread pool scheduler",
     "stream worker",
     "autovacuum launcher",
     "autovacuum worker",
@@ -10055,7 +10064,8 @@ const char* GaussdbThreadName[] = {"main",
     "communicator receiver flower",
     "communicator receiver loop",
     "communicator auxiliary",
-    "communicator pooler auto cleaner"};
+    "communicator pooler auto cleaner",
+    "vacuum index worker"};
 
 GaussdbThreadEntry GetThreadEntry(knl_thread_role role)
 {
@@ -39,6 +39,7 @@
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "utils/portal.h"
+#include "threadpool/threadpool.h"
 
 #include "tcop/stmt_retry.h"
 
@@ -294,8 +295,19 @@ void ReadyForQuery(CommandDest dest)
             } else if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 2)
                 pq_putemptymessage('Z');
 
-            /* Flush output at end of cycle in any case. */
-            pq_flush();
+            /*
+             * Flush output at end of cycle, unless the client has pipelined
+             * more messages that are already buffered: their results can go
+             * out in the same send, and pq_recvbuf flushes before it blocks.
+             * A pending Terminate ends the session, and thread pool workers
+             * may hand it over, so flush in those cases as before.  A commit
+             * reply whose acknowledgement is deferred is sent by the thread
+             * pool once the commit is durable.
+             */
+            if (CommitAckDeferred())
+                break;
+            if (!pq_is_recv_pending() || pq_peekbyte() == 'X' || IS_THREAD_POOL_WORKER)
+                pq_flush();
 
             break;
 
@@ -4916,6 +4916,9 @@ void start_xact_command(void)
             ereport(DEBUG3, (errmsg_internal("StartTransactionCommand")));
         }
 
+        /* Output of this command must not overtake a held back commit reply */
+        WaitDeferredCommitAck();
+
         StartTransactionCommand();
 
         /* Set statement timeout running, if any */
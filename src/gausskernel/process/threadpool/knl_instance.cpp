@@ -25,6 +25,7 @@
 
 #include "access/parallel_recovery/page_redo.h"
 #include "access/reloptions.h"
+#include "access/tuptoaster.h"
 #include "commands/prepare.h"
 #include "executor/instrument.h"
 #include "gssignal/gs_signal.h"
@@ -286,6 +287,10 @@ static void knl_g_wlm_init(knl_g_wlm_context* wlm_cxt)
     wlm_cxt->is_ccn = false;
     wlm_cxt->ccn_idx = -1;
     wlm_cxt->rp_number_in_dn = 0;
+
+    for (int i = 0; i < WLM_IO_BUCKET_NUM; i++) {
+        SpinLockInit(&wlm_cxt->io_context.io_buckets[i].mutex);
+    }
 }
 
 static void knl_g_shmem_init(knl_g_shmem_context* shmem_cxt)
@@ -367,6 +372,7 @@ void knl_instance_init()
     MemoryContextSwitchTo(old_cxt);
 
     GPC = New(g_instance.instance_context) GlobalPlanCache();
+    ToastCacheInit();
 }
 
 void add_numa_alloc_info(void* numaAddr, size_t length)
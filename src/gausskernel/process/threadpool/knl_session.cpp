@@ -476,6 +476,7 @@ void knl_u_commands_init(knl_u_commands_context* cmd_cxt)
     cmd_cxt->label_provider_list = NIL;
     cmd_cxt->bulkload_compatible_illegal_chars = false;
     cmd_cxt->bulkload_copy_state = NULL;
+    cmd_cxt->copy_parallel_states = NULL;
     cmd_cxt->dest_encoding_for_copytofile = -1;
     cmd_cxt->need_transcoding_for_copytofile = false;
     cmd_cxt->OBSParserContext = NULL;
@@ -743,6 +744,13 @@ static void knl_u_storage_init(knl_u_storage_context* storage_cxt)
     storage_cxt->twoPhaseCommitInProgress = false;
     storage_cxt->dumpHashbucketIdNum = 0;
     storage_cxt->dumpHashbucketIds = NULL;
+
+    /* var in buf_trace.cpp */
+    storage_cxt->bufferTraceFile = -1;
+    storage_cxt->bufferTraceOffset = 0;
+    storage_cxt->bufferTraceBuf = NULL;
+    storage_cxt->bufferTraceLen = 0;
+    storage_cxt->bufferTraceAccesses = 0;
 }
 
 static void knl_u_libpq_init(knl_u_libpq_context* libpq_cxt)
@@ -756,6 +764,7 @@ static void knl_u_libpq_init(knl_u_libpq_context* libpq_cxt)
     libpq_cxt->ident_line_nums = NIL;
     libpq_cxt->ident_context = NULL;
     libpq_cxt->IsConnFromCmAgent = false;
+    libpq_cxt->column_batches_sent = 0;
 #ifdef USE_SSL
     libpq_cxt->ssl_loaded_verify_locations = false;
     libpq_cxt->SSL_server_context = NULL;
@@ -978,6 +987,10 @@ static void knl_u_xact_init(knl_u_xact_context* xact_cxt)
     xact_cxt->savePrepareGID = NULL;
 
     xact_cxt->pbe_execute_complete = true;
+
+    xact_cxt->commitAckLsn = 0;
+    xact_cxt->commitAckSyncRepMode = -1;
+    xact_cxt->commitAckOutput = NULL;
 }
 
 static void knl_u_ps_init(knl_u_ps_context* ps_cxt)
@@ -31,6 +31,7 @@
 #include "threadpool/threadpool.h"
 
 #include "access/xact.h"
+#include "access/xlog.h"
 #include "gssignal/gs_signal.h"
 #include "libpq/libpq.h"
 #include "libpq/pqsignal.h"
@@ -46,10 +47,14 @@
 
 #include <poll.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 
 #define INVALID_FD (-1)
 
+/* how often parked commits are checked for WAL flush, in milliseconds */
+#define COMMIT_ACK_CHECK_INTERVAL 1
+
 static void t_pool_listener_loop(ThreadPoolListener* listener);
 
 static void listener_sigusrl_handler(SIGNAL_ARGS)
@@ -104,16 +109,22 @@ ThreadPoolListener::ThreadPoolListener(ThreadPoolGroup* group)
     m_freeWorkerList = New(CurrentMemoryContext) DllistWithLock();
     m_readySessionList = New(CurrentMemoryContext) DllistWithLock();
     m_idleSessionList = New(CurrentMemoryContext) DllistWithLock();
+    m_commitAckSessionList = New(CurrentMemoryContext) DllistWithLock();
+    m_wakeupFd = INVALID_FD;
 }
 
 ThreadPoolListener::~ThreadPoolListener()
 {
     close(m_epollFd);
+    if (m_wakeupFd != INVALID_FD) {
+        close(m_wakeupFd);
+    }
     m_group = NULL;
     m_epollEvents = NULL;
     m_freeWorkerList = NULL;
     m_readySessionList = NULL;
     m_idleSessionList = NULL;
+    m_commitAckSessionList = NULL;
 }
 
 int ThreadPoolListener::StartUp()
@@ -144,6 +155,18 @@ void ThreadPoolListener::CreateEpoll()
         elog(LOG, "Not enough memory for listener epoll");
         proc_exit(0);
     }
+
+    /* Workers parking a commit wake us through this fd, see AddCommitAckWait. */
+    m_wakeupFd = eventfd(0, EFD_NONBLOCK);
+    if (m_wakeupFd == INVALID_FD) {
+        ereport(LOG, (errmsg("Fail to create eventfd for thread pool listener.")));
+        proc_exit(0);
+    }
+
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeupFd, &ev);
 }
 
 void ThreadPoolListener::AddEpoll(knl_session_context* session)
@@ -165,6 +188,45 @@ void ThreadPoolListener::AddEpoll(knl_session_context* session)
     }
 }
 
+/*
+ * Park a session whose commit acknowledgement is deferred.  It stays out of
+ * epoll, so that no later input is served before the reply to its commit,
+ * until ReleaseCommitAckSessions finds the commit durable.
+ */
+void ThreadPoolListener::AddCommitAckWait(knl_session_context* session)
+{
+    uint64 one = 1;
+
+    m_commitAckSessionList->AddTail(&session->elem);
+    (void)write(m_wakeupFd, &one, sizeof(one));
+}
+
+/*
+ * Hand every parked session whose commit is now flushed, and confirmed by the
+ * sync standbys when required, back to the workers in one batch.
+ */
+void ThreadPoolListener::ReleaseCommitAckSessions()
+{
+    Dllist waiting;
+    Dlelem* elem = NULL;
+    knl_session_context* session = NULL;
+    XLogRecPtr flushPtr = GetFlushRecPtr();
+
+    DLInitList(&waiting);
+    while ((elem = m_commitAckSessionList->RemoveHead()) != NULL) {
+        DLAddTail(&waiting, elem);
+    }
+
+    while ((elem = DLRemHead(&waiting)) != NULL) {
+        session = (knl_session_context*)DLE_VAL(elem);
+        if (CommitAckConfirmed(session, flushPtr)) {
+            DispatchSession(session);
+        } else {
+            m_commitAckSessionList->AddTail(elem);
+        }
+    }
+}
+
 bool ThreadPoolListener::TryFeedWorker(ThreadPoolWorker* worker)
 {
     Dlelem* sc = m_readySessionList->RemoveHead();
@@ -219,6 +281,16 @@ void ThreadPoolListener::ReaperAllSession()
             DispatchSession(sess);
             elem = m_idleSessionList->RemoveHead();
         }
+
+        /* Commits still waiting for WAL flush are not acknowledged at shutdown. */
+        elem = m_commitAckSessionList->RemoveHead();
+        while (elem != NULL) {
+            sess = (knl_session_context*)DLE_VAL(elem);
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, sess->proc_cxt.MyProcPort->sock, NULL);
+            sess->status = KNL_SESS_CLOSE;
+            DispatchSession(sess);
+            elem = m_commitAckSessionList->RemoveHead();
+        }
         pg_usleep(100);
     }
     m_reaperAllSession = false;
@@ -227,15 +299,26 @@ void ThreadPoolListener::ReaperAllSession()
 void ThreadPoolListener::WaitTask()
 {
     int nevents = 0;
+    int timeout = -1;
+    bool commitAckWaiting = false;
 
     while (true) {
         if (m_reaperAllSession) {
             ReaperAllSession();
         }
 
-        /* as we specify timeout -1, so 0 will not be return, either > 0 or < 0 */
-        nevents = epoll_wait(m_epollFd, m_epollEvents, GLOBAL_MAX_SESSION_NUM, -1);
-        if (nevents > 0 && nevents <= GLOBAL_MAX_SESSION_NUM) {
+        /* poll for WAL flush progress while some session waits for its commit */
+        commitAckWaiting = !m_commitAckSessionList->IsEmpty();
+        timeout = commitAckWaiting ? COMMIT_ACK_CHECK_INTERVAL : -1;
+
+        /* without a timeout 0 will not be return, either > 0 or < 0 */
+        nevents = epoll_wait(m_epollFd, m_epollEvents, GLOBAL_MAX_SESSION_NUM, timeout);
+        if (commitAckWaiting) {
+            ReleaseCommitAckSessions();
+        }
+        if (nevents == 0) {
+            continue;
+        } else if (nevents > 0 && nevents <= GLOBAL_MAX_SESSION_NUM) {
             HandleConnEvent(nevents);
             continue;
         } else if (nevents > GLOBAL_MAX_SESSION_NUM) {
@@ -256,6 +339,12 @@ void ThreadPoolListener::HandleConnEvent(int nevets)
 
     for (int i = 0; i < nevets; i++) {
         tmp_event = &m_epollEvents[i];
+        if (tmp_event->data.ptr == NULL) {
+            /* a commit was parked, it is checked on the next round */
+            uint64 count = 0;
+            (void)read(m_wakeupFd, &count, sizeof(count));
+            continue;
+        }
         session = GetSessionBaseOnEvent(tmp_event);
         if (session == NULL) {
             continue;
@@ -36,6 +36,7 @@
 #include "threadpool/threadpool.h"
 
 #include "access/xact.h"
+#include "access/xlog.h"
 #include "commands/tablespace.h"
 #include "commands/vacuum.h"
 #include "gssignal/gs_signal.h"
@@ -48,6 +49,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "pgxc/pgxc.h"
+#include "replication/syncrep.h"
 #include "storage/ipc.h"
 #include "storage/fd.h"
 #include "storage/pmsignal.h"
@@ -164,6 +166,10 @@ void ThreadPoolWorker::WaitMission()
     bool is_raw_session = false;
 
     Assert(t_thrd.int_cxt.InterruptHoldoffCount == 0);
+
+    /* Keep the reply of a deferred commit until the listener finds it durable. */
+    HoldDeferredCommitAck();
+
     /*
      * prevent any signal execep siguit.
      * reset any pending signal and timer.
@@ -184,6 +190,11 @@ void ThreadPoolWorker::WaitMission()
                 Assert(t_thrd.libpq_cxt.PqRecvPointer == t_thrd.libpq_cxt.PqRecvLength);
                 continue;
             }
+            /* Released by the listener: send the commit reply and wait for input again. */
+            if (CommitAckDeferred()) {
+                SendDeferredCommitAck();
+                continue;
+            }
             Assert(m_currentSession != NULL);
             Assert(u_sess != NULL);
             break;
@@ -195,6 +206,53 @@ void ThreadPoolWorker::WaitMission()
     ShutDownIfNecessary();
 }
 
+/*
+ * Move the unsent output of a session whose commit acknowledgement is
+ * deferred into the session, as CleanThread drops the thread's send buffer.
+ * If the commit already became durable, just send it.
+ */
+void ThreadPoolWorker::HoldDeferredCommitAck()
+{
+    knl_u_xact_context* xact_cxt = &u_sess->xact_cxt;
+
+    if (!CommitAckDeferred()) {
+        return;
+    }
+
+    if (CommitAckConfirmed(u_sess, GetFlushRecPtr())) {
+        xact_cxt->commitAckLsn = InvalidXLogRecPtr;
+        xact_cxt->commitAckSyncRepMode = SYNC_REP_NO_WAIT;
+        (void)pq_flush();
+        return;
+    }
+
+    if (xact_cxt->commitAckOutput == NULL) {
+        MemoryContext oldcontext = MemoryContextSwitchTo(u_sess->top_mem_cxt);
+        xact_cxt->commitAckOutput = makeStringInfo();
+        (void)MemoryContextSwitchTo(oldcontext);
+    }
+    resetStringInfo(xact_cxt->commitAckOutput);
+    appendBinaryStringInfo(xact_cxt->commitAckOutput,
+        t_thrd.libpq_cxt.PqSendBuffer + t_thrd.libpq_cxt.PqSendStart,
+        t_thrd.libpq_cxt.PqSendPointer - t_thrd.libpq_cxt.PqSendStart);
+}
+
+/* Send the reply held back by HoldDeferredCommitAck once the commit is durable. */
+void ThreadPoolWorker::SendDeferredCommitAck()
+{
+    knl_u_xact_context* xact_cxt = &u_sess->xact_cxt;
+    StringInfo output = xact_cxt->commitAckOutput;
+
+    xact_cxt->commitAckLsn = InvalidXLogRecPtr;
+    xact_cxt->commitAckSyncRepMode = SYNC_REP_NO_WAIT;
+
+    if (output != NULL && output->len > 0) {
+        (void)pq_putbytes(output->data, output->len);
+        (void)pq_flush();
+        resetStringInfo(output);
+    }
+}
+
 bool ThreadPoolWorker::WakeUpToWork(knl_session_context* session)
 {
     bool succ = true;
@@ -449,7 +507,11 @@ void ThreadPoolWorker::DetachSessionFromThread()
     m_currentSession->attachPid = (ThreadId)-1;
 
     /* should restore the data before return to listener. */
-    m_group->GetListener()->AddEpoll(m_currentSession);
+    if (CommitAckDeferred()) {
+        m_group->GetListener()->AddCommitAckWait(m_currentSession);
+    } else {
+        m_group->GetListener()->AddEpoll(m_currentSession);
+    }
     m_currentSession = NULL;
     u_sess = NULL;
 }
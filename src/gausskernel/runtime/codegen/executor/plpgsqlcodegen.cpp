@@ -0,0 +1,1368 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * plpgsqlcodegen.cpp
+ *     native compilation of PL/pgSQL functions
+ *
+ * A function interpreted plpgsql_codegen_threshold times is compiled as a
+ * whole into one native function.  Its variables live in registers and its
+ * expressions are taken from the simple expression trees planned by the
+ * interpreter, so a function is only compiled once all its expressions have
+ * been run at least once.
+ *
+ * The native code never reports an error.  Wherever the interpreter would
+ * raise one, and wherever it meets a value it does not model, like a NULL
+ * variable, it returns non-zero and the interpreter runs the call again from
+ * the start.  This is safe because the statements that are compiled have no
+ * effect outside the variables of the call.
+ *
+ * IDENTIFICATION
+ *     Code/src/gausskernel/runtime/codegen/executor/plpgsqlcodegen.cpp
+ *
+ * -----------------------------------------------------------------------
+ */
+#include "codegen/gscodegen.h"
+#include "codegen/plpgsqlcodegen.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_proc.h"
+#include "catalog/pg_type.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+
+using namespace llvm;
+using namespace dorado;
+
+extern bool GlobalCodeGenEnvironmentSuccess;
+extern bool isCPUFeatureSupportCodegen();
+
+typedef enum {
+    PLCG_ADD,
+    PLCG_SUB,
+    PLCG_MUL,
+    PLCG_DIV,
+    PLCG_MOD,
+    PLCG_NEG,
+    PLCG_EQ,
+    PLCG_NE,
+    PLCG_LT,
+    PLCG_LE,
+    PLCG_GT,
+    PLCG_GE
+} PLpgSQLCgOpKind;
+
+typedef struct PLpgSQLCgOperator {
+    Oid opno;
+    Oid lefttype; /* InvalidOid for prefix operators */
+    Oid righttype;
+    PLpgSQLCgOpKind kind;
+} PLpgSQLCgOperator;
+
+/* The operators the native code implements, with the semantics of int.cpp, int8.cpp and float.cpp */
+static const PLpgSQLCgOperator plcg_operators[] = {
+    {INT4PLOID, INT4OID, INT4OID, PLCG_ADD},
+    {INT4MIOID, INT4OID, INT4OID, PLCG_SUB},
+    {INT4MULOID, INT4OID, INT4OID, PLCG_MUL},
+    {INT4DIVOID, INT4OID, INT4OID, PLCG_DIV},
+    {INT4MODOID, INT4OID, INT4OID, PLCG_MOD},
+    {INT4UMOID, InvalidOid, INT4OID, PLCG_NEG},
+    {INT4EQOID, INT4OID, INT4OID, PLCG_EQ},
+    {INT4NEOID, INT4OID, INT4OID, PLCG_NE},
+    {INT4LTOID, INT4OID, INT4OID, PLCG_LT},
+    {INT4LEOID, INT4OID, INT4OID, PLCG_LE},
+    {INT4GTOID, INT4OID, INT4OID, PLCG_GT},
+    {INT4GEOID, INT4OID, INT4OID, PLCG_GE},
+    {INT8PLOID, INT8OID, INT8OID, PLCG_ADD},
+    {INT8MIOID, INT8OID, INT8OID, PLCG_SUB},
+    {INT8MULOID, INT8OID, INT8OID, PLCG_MUL},
+    {INT8DIVOID, INT8OID, INT8OID, PLCG_DIV},
+    {INT8MODOID, INT8OID, INT8OID, PLCG_MOD},
+    {INT8UMOID, InvalidOid, INT8OID, PLCG_NEG},
+    {INT8EQOID, INT8OID, INT8OID, PLCG_EQ},
+    {INT8NEOID, INT8OID, INT8OID, PLCG_NE},
+    {INT8LTOID, INT8OID, INT8OID, PLCG_LT},
+    {INT8LEOID, INT8OID, INT8OID, PLCG_LE},
+    {INT8GTOID, INT8OID, INT8OID, PLCG_GT},
+    {INT8GEOID, INT8OID, INT8OID, PLCG_GE},
+    {INT84PLOID, INT8OID, INT4OID, PLCG_ADD},
+    {INT84MIOID, INT8OID, INT4OID, PLCG_SUB},
+    {INT84MULOID, INT8OID, INT4OID, PLCG_MUL},
+    {INT84DIVOID, INT8OID, INT4OID, PLCG_DIV},
+    {INT84EQOID, INT8OID, INT4OID, PLCG_EQ},
+    {INT84NEOID, INT8OID, INT4OID, PLCG_NE},
+    {INT84LTOID, INT8OID, INT4OID, PLCG_LT},
+    {INT84LEOID, INT8OID, INT4OID, PLCG_LE},
+    {INT84GTOID, INT8OID, INT4OID, PLCG_GT},
+    {INT84GEOID, INT8OID, INT4OID, PLCG_GE},
+    {INT48PLOID, INT4OID, INT8OID, PLCG_ADD},
+    {INT48MIOID, INT4OID, INT8OID, PLCG_SUB},
+    {INT48MULOID, INT4OID, INT8OID, PLCG_MUL},
+    {INT48DIVOID, INT4OID, INT8OID, PLCG_DIV},
+    {INT48EQOID, INT4OID, INT8OID, PLCG_EQ},
+    {INT48NEOID, INT4OID, INT8OID, PLCG_NE},
+    {INT48LTOID, INT4OID, INT8OID, PLCG_LT},
+    {INT48LEOID, INT4OID, INT8OID, PLCG_LE},
+    {INT48GTOID, INT4OID, INT8OID, PLCG_GT},
+    {INT48GEOID, INT4OID, INT8OID, PLCG_GE},
+    {FLOAT8PLOID, FLOAT8OID, FLOAT8OID, PLCG_ADD},
+    {FLOAT8MIOID, FLOAT8OID, FLOAT8OID, PLCG_SUB},
+    {FLOAT8MULOID, FLOAT8OID, FLOAT8OID, PLCG_MUL},
+    {FLOAT8DIVOID, FLOAT8OID, FLOAT8OID, PLCG_DIV},
+    {FLOAT8UMOID, InvalidOid, FLOAT8OID, PLCG_NEG},
+    {FLOAT8EQOID, FLOAT8OID, FLOAT8OID, PLCG_EQ},
+    {FLOAT8NEOID, FLOAT8OID, FLOAT8OID, PLCG_NE},
+    {FLOAT8LTOID, FLOAT8OID, FLOAT8OID, PLCG_LT},
+    {FLOAT8LEOID, FLOAT8OID, FLOAT8OID, PLCG_LE},
+    {FLOAT8GTOID, FLOAT8OID, FLOAT8OID, PLCG_GT},
+    {FLOAT8GEOID, FLOAT8OID, FLOAT8OID, PLCG_GE},
+    {BooleanEqualOperator, BOOLOID, BOOLOID, PLCG_EQ},
+    {BooleanNotEqualOperator, BOOLOID, BOOLOID, PLCG_NE}};
+
+/* The casts the native code implements, both as FuncExpr and as assignment casts */
+typedef struct PLpgSQLCgCast {
+    Oid funcid;
+    Oid source;
+    Oid target;
+} PLpgSQLCgCast;
+
+static const PLpgSQLCgCast plcg_casts[] = {{INT8TOINT4FUNCOID, INT8OID, INT4OID},
+    {INT4TOINT8FUNCOID, INT4OID, INT8OID},
+    {INT4TOFLOAT8FUNCOID, INT4OID, FLOAT8OID},
+    {INT8TOFLOAT8FUNCOID, INT8OID, FLOAT8OID}};
+
+/* Where an EXIT or a CONTINUE may go */
+typedef struct PLpgSQLCgTarget {
+    const char* label;
+    bool isLoop;                  /* false for a labeled block */
+    llvm::BasicBlock* exitBB;
+    llvm::BasicBlock* continueBB; /* NULL for a block */
+    llvm::Value* found;           /* FOR over integers: whether it looped */
+} PLpgSQLCgTarget;
+
+typedef struct PLpgSQLCgContext {
+    PLpgSQL_function* func;
+
+    /* check pass */
+    bool* tracked; /* by dno: the variable is set by the native code */
+    const char* reason;
+    bool retry;
+
+    /* code generation */
+    GsCodeGen* llvmCodeGen;
+    GsCodeGen::LlvmBuilder* builder;
+    llvm::Function* fn;
+    llvm::Value** values;  /* by dno: the value of the variable */
+    llvm::Value** isnulls; /* by dno: whether the variable is NULL */
+    llvm::Value* interrupt;
+    llvm::BasicBlock* fallbackBB;
+    List* targets; /* PLpgSQLCgTarget, innermost first */
+} PLpgSQLCgContext;
+
+static bool IsSupportedType(Oid typoid)
+{
+    switch (typoid) {
+        case INT4OID:
+        case INT8OID:
+        case BOOLOID:
+            return true;
+        case FLOAT8OID:
+#ifdef USE_FLOAT8_BYVAL
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+static bool IsSupportedVar(PLpgSQL_datum* datum)
+{
+    PLpgSQL_var* var = NULL;
+
+    if (datum->dtype != PLPGSQL_DTYPE_VAR) {
+        return false;
+    }
+    var = (PLpgSQL_var*)datum;
+    return IsSupportedType(var->datatype->typoid) && var->datatype->atttypmod == -1 && !var->is_cursor_var;
+}
+
+static Oid VarType(PLpgSQLCgContext* ctx, int dno)
+{
+    return ((PLpgSQL_var*)ctx->func->datums[dno])->datatype->typoid;
+}
+
+static const PLpgSQLCgOperator* LookupOperator(Oid opno)
+{
+    for (uint32 i = 0; i < lengthof(plcg_operators); i++) {
+        if (plcg_operators[i].opno == opno) {
+            return &plcg_operators[i];
+        }
+    }
+    return NULL;
+}
+
+static const PLpgSQLCgCast* LookupCast(Oid funcid)
+{
+    for (uint32 i = 0; i < lengthof(plcg_casts); i++) {
+        if (plcg_casts[i].funcid == funcid) {
+            return &plcg_casts[i];
+        }
+    }
+    return NULL;
+}
+
+static bool IsSupportedCast(Oid source, Oid target)
+{
+    if (source == target) {
+        return true;
+    }
+    for (uint32 i = 0; i < lengthof(plcg_casts); i++) {
+        if (plcg_casts[i].source == source && plcg_casts[i].target == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Remember the first reason why the function cannot be compiled */
+static bool Unsupported(PLpgSQLCgContext* ctx, const char* reason)
+{
+    if (ctx->reason == NULL) {
+        ctx->reason = reason;
+    }
+    return false;
+}
+
+static bool UnsupportedWith(PLpgSQLCgContext* ctx, const char* fmt, const char* arg)
+{
+    if (ctx->reason == NULL) {
+        MemoryContext oldcxt = MemoryContextSwitchTo(ctx->func->fn_cxt);
+        StringInfoData buf;
+
+        initStringInfo(&buf);
+        appendStringInfo(&buf, fmt, arg);
+        ctx->reason = buf.data;
+        (void)MemoryContextSwitchTo(oldcxt);
+    }
+    return false;
+}
+
+static bool UnsupportedVar(PLpgSQLCgContext* ctx, int dno)
+{
+    PLpgSQL_datum* datum = ctx->func->datums[dno];
+
+    switch (datum->dtype) {
+        case PLPGSQL_DTYPE_VAR: {
+            PLpgSQL_var* var = (PLpgSQL_var*)datum;
+
+            if (IsSupportedVar(datum)) {
+                return UnsupportedWith(ctx, "uses variable \"%s\" set outside the supported statements", var->refname);
+            }
+            return UnsupportedWith(ctx, "uses variable \"%s\" of another type than int4, int8, float8 or bool",
+                var->refname);
+        }
+        case PLPGSQL_DTYPE_ROW:
+        case PLPGSQL_DTYPE_REC:
+            return UnsupportedWith(ctx, "uses row variable \"%s\"", ((PLpgSQL_variable*)datum)->refname);
+        default:
+            return Unsupported(ctx, "uses a record field or an array element");
+    }
+}
+
+static bool CheckExpr(PLpgSQLCgContext* ctx, Node* node)
+{
+    ListCell* lc = NULL;
+
+    check_stack_depth();
+
+    switch (nodeTag(node)) {
+        case T_Const: {
+            Const* con = (Const*)node;
+
+            if (!IsSupportedType(con->consttype)) {
+                return UnsupportedWith(ctx, "uses a constant of type %s", format_type_be(con->consttype));
+            }
+            if (con->constisnull) {
+                return Unsupported(ctx, "uses a NULL constant");
+            }
+            return true;
+        }
+        case T_Param: {
+            Param* param = (Param*)node;
+            int dno = param->paramid - 1;
+
+            if (param->paramkind != PARAM_EXTERN || dno < 0 || dno >= ctx->func->ndatums) {
+                return Unsupported(ctx, "uses a parameter that is not a variable");
+            }
+            if (!ctx->tracked[dno] || param->paramtype != VarType(ctx, dno)) {
+                return UnsupportedVar(ctx, dno);
+            }
+            return true;
+        }
+        case T_OpExpr: {
+            OpExpr* opexpr = (OpExpr*)node;
+            const PLpgSQLCgOperator* op = LookupOperator(opexpr->opno);
+
+            if (op == NULL || list_length(opexpr->args) != (op->lefttype == InvalidOid ? 1 : 2)) {
+                return UnsupportedWith(ctx, "uses operator %s", format_operator(opexpr->opno));
+            }
+            foreach (lc, opexpr->args) {
+                if (!CheckExpr(ctx, (Node*)lfirst(lc))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case T_FuncExpr: {
+            FuncExpr* fexpr = (FuncExpr*)node;
+            const PLpgSQLCgCast* cast = LookupCast(fexpr->funcid);
+
+            if (cast == NULL || list_length(fexpr->args) != 1) {
+                return UnsupportedWith(ctx, "uses function %s", format_procedure(fexpr->funcid));
+            }
+            return CheckExpr(ctx, (Node*)linitial(fexpr->args));
+        }
+        case T_BoolExpr: {
+            BoolExpr* bexpr = (BoolExpr*)node;
+
+            foreach (lc, bexpr->args) {
+                if (!CheckExpr(ctx, (Node*)lfirst(lc))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return Unsupported(ctx, "uses an expression made of other things than constants, variables, "
+                                    "operators and casts");
+    }
+}
+
+/* The expression must have been planned as a simple expression castable to target */
+static bool CheckPLExpr(PLpgSQLCgContext* ctx, PLpgSQL_expr* expr, Oid target)
+{
+    Node* node = (Node*)expr->expr_simple_expr;
+
+    if (expr->plan == NULL) {
+        ctx->retry = true;
+        return UnsupportedWith(ctx, "has not run expression \"%s\" yet", expr->query);
+    }
+    if (node == NULL) {
+        return UnsupportedWith(ctx, "uses expression \"%s\", which is not simple", expr->query);
+    }
+    if (!CheckExpr(ctx, node)) {
+        return false;
+    }
+    if (!IsSupportedCast(exprType(node), target)) {
+        return UnsupportedWith(ctx, "casts expression \"%s\"", expr->query);
+    }
+    return true;
+}
+
+static bool CheckStmt(PLpgSQLCgContext* ctx, PLpgSQL_stmt* stmt);
+
+static bool CheckStmts(PLpgSQLCgContext* ctx, List* stmts)
+{
+    ListCell* lc = NULL;
+
+    foreach (lc, stmts) {
+        if (!CheckStmt(ctx, (PLpgSQL_stmt*)lfirst(lc))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckStmt(PLpgSQLCgContext* ctx, PLpgSQL_stmt* stmt)
+{
+    ListCell* lc = NULL;
+
+    check_stack_depth();
+
+    switch ((enum PLpgSQL_stmt_types)stmt->cmd_type) {
+        case PLPGSQL_STMT_BLOCK: {
+            PLpgSQL_stmt_block* block = (PLpgSQL_stmt_block*)stmt;
+
+            if (block->exceptions != NULL) {
+                return Unsupported(ctx, "uses an EXCEPTION clause");
+            }
+            for (int i = 0; i < block->n_initvars; i++) {
+                int dno = block->initvarnos[i];
+                PLpgSQL_datum* datum = ctx->func->datums[dno];
+                PLpgSQL_var* var = (PLpgSQL_var*)datum;
+
+                if (datum->dtype == PLPGSQL_DTYPE_RECFIELD || datum->dtype == PLPGSQL_DTYPE_ARRAYELEM) {
+                    continue;
+                }
+                if (!IsSupportedVar(datum)) {
+                    return UnsupportedVar(ctx, dno);
+                }
+                if (var->default_val == NULL && var->notnull) {
+                    return UnsupportedWith(ctx, "declares NOT NULL variable \"%s\" without default", var->refname);
+                }
+                if (var->default_val != NULL && !CheckPLExpr(ctx, var->default_val, var->datatype->typoid)) {
+                    return false;
+                }
+                ctx->tracked[dno] = true;
+            }
+            return CheckStmts(ctx, block->body);
+        }
+        case PLPGSQL_STMT_ASSIGN: {
+            PLpgSQL_stmt_assign* assign = (PLpgSQL_stmt_assign*)stmt;
+
+            if (!ctx->tracked[assign->varno]) {
+                return UnsupportedVar(ctx, assign->varno);
+            }
+            return CheckPLExpr(ctx, assign->expr, VarType(ctx, assign->varno));
+        }
+        case PLPGSQL_STMT_IF: {
+            PLpgSQL_stmt_if* ifstmt = (PLpgSQL_stmt_if*)stmt;
+
+            if (!CheckPLExpr(ctx, ifstmt->cond, BOOLOID) || !CheckStmts(ctx, ifstmt->then_body)) {
+                return false;
+            }
+            foreach (lc, ifstmt->elsif_list) {
+                PLpgSQL_if_elsif* elsif = (PLpgSQL_if_elsif*)lfirst(lc);
+
+                if (!CheckPLExpr(ctx, elsif->cond, BOOLOID) || !CheckStmts(ctx, elsif->stmts)) {
+                    return false;
+                }
+            }
+            return CheckStmts(ctx, ifstmt->else_body);
+        }
+        case PLPGSQL_STMT_LOOP:
+            return CheckStmts(ctx, ((PLpgSQL_stmt_loop*)stmt)->body);
+        case PLPGSQL_STMT_WHILE: {
+            PLpgSQL_stmt_while* whilestmt = (PLpgSQL_stmt_while*)stmt;
+
+            return CheckPLExpr(ctx, whilestmt->cond, BOOLOID) && CheckStmts(ctx, whilestmt->body);
+        }
+        case PLPGSQL_STMT_FORI: {
+            PLpgSQL_stmt_fori* fori = (PLpgSQL_stmt_fori*)stmt;
+
+            if (!IsSupportedVar((PLpgSQL_datum*)fori->var) || fori->var->datatype->typoid != INT4OID) {
+                return UnsupportedWith(ctx, "uses FOR loop variable \"%s\" of another type than int4",
+                    fori->var->refname);
+            }
+            if (!CheckPLExpr(ctx, fori->lower, INT4OID) || !CheckPLExpr(ctx, fori->upper, INT4OID)) {
+                return false;
+            }
+            if (fori->step != NULL && !CheckPLExpr(ctx, fori->step, INT4OID)) {
+                return false;
+            }
+            ctx->tracked[fori->var->dno] = true;
+            return CheckStmts(ctx, fori->body);
+        }
+        case PLPGSQL_STMT_EXIT: {
+            PLpgSQL_stmt_exit* exitstmt = (PLpgSQL_stmt_exit*)stmt;
+
+            return exitstmt->cond == NULL || CheckPLExpr(ctx, exitstmt->cond, BOOLOID);
+        }
+        case PLPGSQL_STMT_RETURN: {
+            PLpgSQL_stmt_return* ret = (PLpgSQL_stmt_return*)stmt;
+
+            if (ret->retvarno >= 0) {
+                if (!ctx->tracked[ret->retvarno]) {
+                    return UnsupportedVar(ctx, ret->retvarno);
+                }
+                if (!IsSupportedCast(VarType(ctx, ret->retvarno), ctx->func->fn_rettype)) {
+                    return Unsupported(ctx, "casts the return value");
+                }
+                return true;
+            }
+            if (ret->expr == NULL) {
+                return Unsupported(ctx, "uses RETURN without a value");
+            }
+            return CheckPLExpr(ctx, ret->expr, ctx->func->fn_rettype);
+        }
+        case PLPGSQL_STMT_NULL:
+            return true;
+        default:
+            return UnsupportedWith(ctx, "uses %s", plpgsql_stmt_typename(stmt));
+    }
+}
+
+static bool CheckSignature(PLpgSQLCgContext* ctx)
+{
+    PLpgSQL_function* func = ctx->func;
+
+    if (func->fn_is_trigger) {
+        return Unsupported(ctx, "is a trigger function");
+    }
+    if (func->fn_retset) {
+        return Unsupported(ctx, "returns a set");
+    }
+    if (func->fn_retistuple || func->out_param_varno >= 0) {
+        return Unsupported(ctx, "returns a row or has OUT parameters");
+    }
+    if (!IsSupportedType(func->fn_rettype)) {
+        return UnsupportedWith(ctx, "returns type %s", format_type_be(func->fn_rettype));
+    }
+    if (func->goto_labels != NIL) {
+        return Unsupported(ctx, "uses GOTO");
+    }
+    for (int i = 0; i < func->fn_nargs; i++) {
+        int dno = func->fn_argvarnos[i];
+
+        if (!IsSupportedVar(func->datums[dno])) {
+            return UnsupportedVar(ctx, dno);
+        }
+        ctx->tracked[dno] = true;
+    }
+    if (func->found_varno >= 0 && IsSupportedVar(func->datums[func->found_varno])) {
+        ctx->tracked[func->found_varno] = true;
+    }
+    return true;
+}
+
+static llvm::Type* LlvmType(PLpgSQLCgContext* ctx, Oid typoid)
+{
+    GsCodeGen* llvmCodeGen = ctx->llvmCodeGen;
+
+    /* the native code keeps the booleans as i1, not as the i8 of the executor */
+    return llvmCodeGen->getType(typoid == BOOLOID ? BITOID : typoid);
+}
+
+/* Allocas go to the entry block so that they become registers */
+static llvm::Value* EmitEntryAlloca(PLpgSQLCgContext* ctx, llvm::Type* type, const char* name)
+{
+    llvm::BasicBlock* entry = &ctx->fn->getEntryBlock();
+    GsCodeGen::LlvmBuilder builder(entry, entry->begin());
+
+    return builder.CreateAlloca(type, NULL, name);
+}
+
+/* Hand the call back to the interpreter when cond is true */
+static void EmitFallbackIf(PLpgSQLCgContext* ctx, llvm::Value* cond)
+{
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    DEFINE_BLOCK(next_bb, ctx->fn);
+
+    ctx->builder->CreateCondBr(cond, ctx->fallbackBB, next_bb);
+    ctx->builder->SetInsertPoint(next_bb);
+}
+
+/* Jump to bb, the code that follows in the statement list is unreachable */
+static void EmitJump(PLpgSQLCgContext* ctx, llvm::BasicBlock* bb)
+{
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    DEFINE_BLOCK(unreachable_bb, ctx->fn);
+
+    ctx->builder->CreateBr(bb);
+    ctx->builder->SetInsertPoint(unreachable_bb);
+}
+
+static void EmitInterruptCheck(PLpgSQLCgContext* ctx)
+{
+    GsCodeGen* llvmCodeGen = ctx->llvmCodeGen;
+    llvm::Value* pending = ctx->builder->CreateLoad(ctx->interrupt, true, "interrupt");
+
+    EmitFallbackIf(ctx, ctx->builder->CreateICmpNE(pending, llvmCodeGen->getIntConstant(CHAROID, 0)));
+}
+
+static llvm::Value* EmitVarLoad(PLpgSQLCgContext* ctx, int dno)
+{
+    EmitFallbackIf(ctx, ctx->builder->CreateLoad(ctx->isnulls[dno], "isnull"));
+    return ctx->builder->CreateLoad(ctx->values[dno], "value");
+}
+
+static void EmitVarStore(PLpgSQLCgContext* ctx, int dno, llvm::Value* value)
+{
+    ctx->builder->CreateStore(value, ctx->values[dno]);
+    ctx->builder->CreateStore(ctx->builder->getFalse(), ctx->isnulls[dno]);
+}
+
+static llvm::Value* EmitFromDatum(PLpgSQLCgContext* ctx, llvm::Value* datum, Oid typoid)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+
+    switch (typoid) {
+        case INT4OID:
+            return builder->CreateTrunc(datum, LlvmType(ctx, INT4OID));
+        case INT8OID:
+            return datum;
+        case FLOAT8OID:
+            return builder->CreateBitCast(datum, LlvmType(ctx, FLOAT8OID));
+        default:
+            return builder->CreateICmpNE(datum, ctx->llvmCodeGen->getIntConstant(INT8OID, 0));
+    }
+}
+
+static llvm::Value* EmitToDatum(PLpgSQLCgContext* ctx, llvm::Value* value, Oid typoid)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::Type* int64Type = LlvmType(ctx, INT8OID);
+
+    switch (typoid) {
+        case INT8OID:
+            return value;
+        case FLOAT8OID:
+            return builder->CreateBitCast(value, int64Type);
+        default:
+            /* Int32GetDatum and BoolGetDatum do not extend the sign */
+            return builder->CreateZExt(value, int64Type);
+    }
+}
+
+/* Call an llvm.*.with.overflow intrinsic, an overflow goes to the interpreter */
+static llvm::Value* EmitOverflowOp(PLpgSQLCgContext* ctx, llvm::Intrinsic::ID id, llvm::Value* lhs, llvm::Value* rhs)
+{
+    llvm::Type* Intrinsic_Tys[] = {lhs->getType()};
+    llvm::Function* func = llvm::Intrinsic::getDeclaration(ctx->llvmCodeGen->module(), id, Intrinsic_Tys);
+    llvm::Value* res = NULL;
+
+    if (func == NULL) {
+        ereport(ERROR,
+            (errcode(ERRCODE_LOAD_INTRINSIC_FUNCTION_FAILED),
+                errmodule(MOD_LLVM),
+                errmsg("Cannot get the llvm overflow intrinsic function!\n")));
+    }
+    res = ctx->builder->CreateCall(func, {lhs, rhs}, "ovfop");
+    EmitFallbackIf(ctx, ctx->builder->CreateExtractValue(res, 1));
+    return ctx->builder->CreateExtractValue(res, 0);
+}
+
+static llvm::Value* EmitCast(PLpgSQLCgContext* ctx, llvm::Value* value, Oid source, Oid target)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+
+    if (source == target) {
+        return value;
+    }
+    switch (target) {
+        case INT4OID: {
+            /* int84: out of the int4 range is an error */
+            llvm::Value* res = builder->CreateTrunc(value, LlvmType(ctx, INT4OID));
+
+            EmitFallbackIf(ctx, builder->CreateICmpNE(builder->CreateSExt(res, LlvmType(ctx, INT8OID)), value));
+            return res;
+        }
+        case INT8OID:
+            return builder->CreateSExt(value, LlvmType(ctx, INT8OID));
+        case FLOAT8OID:
+            return builder->CreateSIToFP(value, LlvmType(ctx, FLOAT8OID));
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_CODEGEN_ERROR),
+                    errmodule(MOD_LLVM),
+                    errmsg("unexpected cast from type %u to type %u", source, target)));
+            return NULL;
+    }
+}
+
+static llvm::Value* EmitIsInf(PLpgSQLCgContext* ctx, llvm::Value* value)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::Type* float8Type = LlvmType(ctx, FLOAT8OID);
+
+    return builder->CreateOr(builder->CreateFCmpOEQ(value, llvm::ConstantFP::getInfinity(float8Type, false)),
+        builder->CreateFCmpOEQ(value, llvm::ConstantFP::getInfinity(float8Type, true)));
+}
+
+/* float8pl, float8mi, ...: an overflow or an underflow goes to the interpreter */
+static llvm::Value* EmitFloatOp(PLpgSQLCgContext* ctx, PLpgSQLCgOpKind kind, llvm::Value* lhs, llvm::Value* rhs)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::Value* zero = llvm::ConstantFP::get(LlvmType(ctx, FLOAT8OID), 0.0);
+    llvm::Value* res = NULL;
+    llvm::Value* zeroarg = NULL;
+
+    switch (kind) {
+        case PLCG_ADD:
+        case PLCG_SUB:
+            res = (kind == PLCG_ADD) ? builder->CreateFAdd(lhs, rhs) : builder->CreateFSub(lhs, rhs);
+            EmitFallbackIf(ctx, EmitIsInf(ctx, res));
+            return res;
+        case PLCG_MUL:
+        case PLCG_DIV:
+            if (kind == PLCG_MUL) {
+                zeroarg = builder->CreateOr(builder->CreateFCmpOEQ(lhs, zero), builder->CreateFCmpOEQ(rhs, zero));
+                res = builder->CreateFMul(lhs, rhs);
+            } else {
+                EmitFallbackIf(ctx, builder->CreateFCmpOEQ(rhs, zero));
+                zeroarg = builder->CreateFCmpOEQ(lhs, zero);
+                res = builder->CreateFDiv(lhs, rhs);
+            }
+            EmitFallbackIf(ctx,
+                builder->CreateAnd(builder->CreateNot(zeroarg),
+                    builder->CreateOr(EmitIsInf(ctx, res), builder->CreateFCmpOEQ(res, zero))));
+            return builder->CreateSelect(zeroarg, zero, res);
+        case PLCG_NEG:
+            /* float8um returns 0, not -0 */
+            return builder->CreateSelect(builder->CreateFCmpOEQ(rhs, zero),
+                zero,
+                builder->CreateFSub(llvm::ConstantFP::get(LlvmType(ctx, FLOAT8OID), -0.0), rhs));
+        default:
+            break;
+    }
+
+    /* float8_cmp_internal sorts NaN after everything, leave it to the interpreter */
+    EmitFallbackIf(ctx, builder->CreateFCmpUNO(lhs, rhs));
+    switch (kind) {
+        case PLCG_EQ:
+            return builder->CreateFCmpOEQ(lhs, rhs);
+        case PLCG_NE:
+            return builder->CreateFCmpONE(lhs, rhs);
+        case PLCG_LT:
+            return builder->CreateFCmpOLT(lhs, rhs);
+        case PLCG_LE:
+            return builder->CreateFCmpOLE(lhs, rhs);
+        case PLCG_GT:
+            return builder->CreateFCmpOGT(lhs, rhs);
+        default:
+            return builder->CreateFCmpOGE(lhs, rhs);
+    }
+}
+
+/* int4pl, int8div, ...: the operations that raise an error go to the interpreter */
+static llvm::Value* EmitIntOp(PLpgSQLCgContext* ctx, PLpgSQLCgOpKind kind, llvm::Value* lhs, llvm::Value* rhs)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    llvm::Type* intType = rhs->getType();
+    llvm::Value* zero = llvm::ConstantInt::get(intType, 0);
+    llvm::Value* minusone = llvm::ConstantInt::get(intType, -1, true);
+
+    switch (kind) {
+        case PLCG_ADD:
+            return EmitOverflowOp(ctx, llvm::Intrinsic::sadd_with_overflow, lhs, rhs);
+        case PLCG_SUB:
+            return EmitOverflowOp(ctx, llvm::Intrinsic::ssub_with_overflow, lhs, rhs);
+        case PLCG_MUL:
+            return EmitOverflowOp(ctx, llvm::Intrinsic::smul_with_overflow, lhs, rhs);
+        case PLCG_NEG:
+            return EmitOverflowOp(ctx, llvm::Intrinsic::ssub_with_overflow, zero, rhs);
+        case PLCG_DIV: {
+            /* the A-compatible division returns float8, x / -1 is left to the interpreter */
+            llvm::Type* float8Type = LlvmType(ctx, FLOAT8OID);
+            llvm::Value* res = NULL;
+
+            EmitFallbackIf(ctx, builder->CreateOr(builder->CreateICmpEQ(rhs, zero), builder->CreateICmpEQ(rhs, minusone)));
+            res = builder->CreateFDiv(builder->CreateSIToFP(lhs, float8Type), builder->CreateSIToFP(rhs, float8Type));
+            return builder->CreateSelect(builder->CreateICmpEQ(lhs, zero), llvm::ConstantFP::get(float8Type, 0.0), res);
+        }
+        case PLCG_MOD: {
+            /* x % 0 is x and x % -1 is 0, srem must not see them */
+            DEFINE_BLOCK(mod_special, ctx->fn);
+            DEFINE_BLOCK(mod_rem, ctx->fn);
+            DEFINE_BLOCK(mod_done, ctx->fn);
+            llvm::Value* iszero = builder->CreateICmpEQ(rhs, zero);
+            llvm::Value* special = NULL;
+            llvm::Value* rem = NULL;
+            llvm::PHINode* phi = NULL;
+
+            builder->CreateCondBr(builder->CreateOr(iszero, builder->CreateICmpEQ(rhs, minusone)), mod_special, mod_rem);
+            builder->SetInsertPoint(mod_special);
+            special = builder->CreateSelect(iszero, lhs, zero);
+            builder->CreateBr(mod_done);
+            builder->SetInsertPoint(mod_rem);
+            rem = builder->CreateSRem(lhs, rhs);
+            builder->CreateBr(mod_done);
+            builder->SetInsertPoint(mod_done);
+            phi = builder->CreatePHI(intType, 2);
+            phi->addIncoming(special, mod_special);
+            phi->addIncoming(rem, mod_rem);
+            return phi;
+        }
+        case PLCG_EQ:
+            return builder->CreateICmpEQ(lhs, rhs);
+        case PLCG_NE:
+            return builder->CreateICmpNE(lhs, rhs);
+        case PLCG_LT:
+            return builder->CreateICmpSLT(lhs, rhs);
+        case PLCG_LE:
+            return builder->CreateICmpSLE(lhs, rhs);
+        case PLCG_GT:
+            return builder->CreateICmpSGT(lhs, rhs);
+        default:
+            return builder->CreateICmpSGE(lhs, rhs);
+    }
+}
+
+static llvm::Value* EmitExpr(PLpgSQLCgContext* ctx, Node* node);
+
+static llvm::Value* EmitOpExpr(PLpgSQLCgContext* ctx, OpExpr* opexpr)
+{
+    const PLpgSQLCgOperator* op = LookupOperator(opexpr->opno);
+    llvm::Value* lhs = NULL;
+    llvm::Value* rhs = NULL;
+    Oid type = op->righttype;
+
+    if (op->lefttype != InvalidOid) {
+        lhs = EmitExpr(ctx, (Node*)linitial(opexpr->args));
+        rhs = EmitExpr(ctx, (Node*)lsecond(opexpr->args));
+
+        /* int84 and int48 operators work on int8 */
+        if (op->lefttype != op->righttype) {
+            lhs = EmitCast(ctx, lhs, op->lefttype, INT8OID);
+            rhs = EmitCast(ctx, rhs, op->righttype, INT8OID);
+            type = INT8OID;
+        }
+    } else {
+        rhs = EmitExpr(ctx, (Node*)linitial(opexpr->args));
+    }
+
+    if (type == FLOAT8OID) {
+        return EmitFloatOp(ctx, op->kind, lhs, rhs);
+    }
+    return EmitIntOp(ctx, op->kind, lhs, rhs);
+}
+
+/* AND and OR stop at the first argument that decides, like ExecEvalAnd and ExecEvalOr */
+static llvm::Value* EmitBoolExpr(PLpgSQLCgContext* ctx, BoolExpr* bexpr)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    bool isand = (bexpr->boolop == AND_EXPR);
+    llvm::Value* value = NULL;
+    llvm::PHINode* phi = NULL;
+    ListCell* lc = NULL;
+
+    if (bexpr->boolop == NOT_EXPR) {
+        return builder->CreateNot(EmitExpr(ctx, (Node*)linitial(bexpr->args)));
+    }
+
+    DEFINE_BLOCK(bool_done, ctx->fn);
+    List* incoming = NIL;
+
+    foreach (lc, bexpr->args) {
+        value = EmitExpr(ctx, (Node*)lfirst(lc));
+        if (lnext(lc) != NULL) {
+            DEFINE_BLOCK(bool_next, ctx->fn);
+
+            if (isand) {
+                builder->CreateCondBr(value, bool_next, bool_done);
+            } else {
+                builder->CreateCondBr(value, bool_done, bool_next);
+            }
+            incoming = lappend(incoming, builder->GetInsertBlock());
+            builder->SetInsertPoint(bool_next);
+        }
+    }
+    builder->CreateBr(bool_done);
+    incoming = lappend(incoming, builder->GetInsertBlock());
+
+    builder->SetInsertPoint(bool_done);
+    phi = builder->CreatePHI(LlvmType(ctx, BOOLOID), list_length(incoming));
+    for (int i = 0; i < list_length(incoming) - 1; i++) {
+        phi->addIncoming(isand ? builder->getFalse() : builder->getTrue(), (llvm::BasicBlock*)list_nth(incoming, i));
+    }
+    phi->addIncoming(value, (llvm::BasicBlock*)llast(incoming));
+    list_free(incoming);
+    return phi;
+}
+
+static llvm::Value* EmitExpr(PLpgSQLCgContext* ctx, Node* node)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+
+    switch (nodeTag(node)) {
+        case T_Const: {
+            Const* con = (Const*)node;
+
+            switch (con->consttype) {
+                case INT4OID:
+                    return llvm::ConstantInt::get(LlvmType(ctx, INT4OID), DatumGetInt32(con->constvalue), true);
+                case INT8OID:
+                    return llvm::ConstantInt::get(LlvmType(ctx, INT8OID), DatumGetInt64(con->constvalue), true);
+                case FLOAT8OID:
+                    return llvm::ConstantFP::get(LlvmType(ctx, FLOAT8OID), DatumGetFloat8(con->constvalue));
+                default:
+                    return DatumGetBool(con->constvalue) ? builder->getTrue() : builder->getFalse();
+            }
+        }
+        case T_Param:
+            return EmitVarLoad(ctx, ((Param*)node)->paramid - 1);
+        case T_OpExpr:
+            return EmitOpExpr(ctx, (OpExpr*)node);
+        case T_FuncExpr: {
+            FuncExpr* fexpr = (FuncExpr*)node;
+            const PLpgSQLCgCast* cast = LookupCast(fexpr->funcid);
+
+            return EmitCast(ctx, EmitExpr(ctx, (Node*)linitial(fexpr->args)), cast->source, cast->target);
+        }
+        case T_BoolExpr:
+            return EmitBoolExpr(ctx, (BoolExpr*)node);
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE),
+                    errmodule(MOD_LLVM),
+                    errmsg("unrecognized node type: %d", (int)nodeTag(node))));
+            return NULL;
+    }
+}
+
+static llvm::Value* EmitPLExpr(PLpgSQLCgContext* ctx, PLpgSQL_expr* expr, Oid target)
+{
+    Node* node = (Node*)expr->expr_simple_expr;
+
+    return EmitCast(ctx, EmitExpr(ctx, node), exprType(node), target);
+}
+
+/*
+ * EXIT and CONTINUE.  Every FOR loop left on the way sets FOUND, like
+ * exec_stmt_fori does when an EXIT or a CONTINUE goes through it.
+ */
+static void EmitExitJump(PLpgSQLCgContext* ctx, PLpgSQL_stmt_exit* stmt)
+{
+    ListCell* lc = NULL;
+    int found_varno = ctx->func->found_varno;
+
+    foreach (lc, ctx->targets) {
+        PLpgSQLCgTarget* target = (PLpgSQLCgTarget*)lfirst(lc);
+        bool match = false;
+
+        if (stmt->label == NULL) {
+            match = target->isLoop;
+        } else {
+            match = (target->label != NULL && strcmp(target->label, stmt->label) == 0 &&
+                     (stmt->is_exit || target->isLoop));
+        }
+        if (match) {
+            ctx->builder->CreateBr(stmt->is_exit ? target->exitBB : target->continueBB);
+            return;
+        }
+        if (target->found != NULL && found_varno >= 0 && ctx->values[found_varno] != NULL) {
+            EmitVarStore(ctx, found_varno, ctx->builder->CreateLoad(target->found, "found"));
+        }
+    }
+    ereport(ERROR,
+        (errcode(ERRCODE_CODEGEN_ERROR),
+            errmodule(MOD_LLVM),
+            errmsg("target of %s not found", plpgsql_stmt_typename((PLpgSQL_stmt*)stmt))));
+}
+
+static void PushTarget(PLpgSQLCgContext* ctx, const char* label, bool isLoop, llvm::BasicBlock* exitBB,
+    llvm::BasicBlock* continueBB, llvm::Value* found)
+{
+    PLpgSQLCgTarget* target = (PLpgSQLCgTarget*)palloc0(sizeof(PLpgSQLCgTarget));
+
+    target->label = label;
+    target->isLoop = isLoop;
+    target->exitBB = exitBB;
+    target->continueBB = continueBB;
+    target->found = found;
+    ctx->targets = lcons(target, ctx->targets);
+}
+
+static void PopTarget(PLpgSQLCgContext* ctx)
+{
+    pfree(linitial(ctx->targets));
+    ctx->targets = list_delete_first(ctx->targets);
+}
+
+static void EmitStmt(PLpgSQLCgContext* ctx, PLpgSQL_stmt* stmt);
+
+static void EmitStmts(PLpgSQLCgContext* ctx, List* stmts)
+{
+    ListCell* lc = NULL;
+
+    foreach (lc, stmts) {
+        EmitStmt(ctx, (PLpgSQL_stmt*)lfirst(lc));
+    }
+}
+
+/* One IF or ELSIF arm, falls through to the next arm when cond is false */
+static void EmitIfArm(PLpgSQLCgContext* ctx, PLpgSQL_expr* cond, List* stmts, llvm::BasicBlock* done)
+{
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    llvm::Value* value = EmitPLExpr(ctx, cond, BOOLOID);
+    DEFINE_BLOCK(if_then, ctx->fn);
+    DEFINE_BLOCK(if_else, ctx->fn);
+
+    ctx->builder->CreateCondBr(value, if_then, if_else);
+    ctx->builder->SetInsertPoint(if_then);
+    EmitStmts(ctx, stmts);
+    ctx->builder->CreateBr(done);
+    ctx->builder->SetInsertPoint(if_else);
+}
+
+static void EmitFori(PLpgSQLCgContext* ctx, PLpgSQL_stmt_fori* stmt)
+{
+    GsCodeGen* llvmCodeGen = ctx->llvmCodeGen;
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::LLVMContext& context = llvmCodeGen->context();
+    llvm::Type* int32Type = LlvmType(ctx, INT4OID);
+    llvm::Value* counter = EmitEntryAlloca(ctx, int32Type, "fori_counter");
+    llvm::Value* found = EmitEntryAlloca(ctx, LlvmType(ctx, BOOLOID), "fori_found");
+    llvm::Value* lower = EmitPLExpr(ctx, stmt->lower, INT4OID);
+    llvm::Value* upper = EmitPLExpr(ctx, stmt->upper, INT4OID);
+    llvm::Value* step = llvmCodeGen->getIntConstant(INT4OID, 1);
+    llvm::Value* value = NULL;
+    llvm::Value* next = NULL;
+    llvm::Type* Intrinsic_Tys[] = {int32Type};
+    int found_varno = ctx->func->found_varno;
+
+    if (stmt->step != NULL) {
+        step = EmitPLExpr(ctx, stmt->step, INT4OID);
+        EmitFallbackIf(ctx, builder->CreateICmpSLE(step, llvmCodeGen->getIntConstant(INT4OID, 0)));
+    }
+
+    DEFINE_BLOCK(fori_cond, ctx->fn);
+    DEFINE_BLOCK(fori_body, ctx->fn);
+    DEFINE_BLOCK(fori_continue, ctx->fn);
+    DEFINE_BLOCK(fori_next, ctx->fn);
+    DEFINE_BLOCK(fori_exit, ctx->fn);
+
+    builder->CreateStore(lower, counter);
+    builder->CreateStore(builder->getFalse(), found);
+    builder->CreateBr(fori_cond);
+
+    builder->SetInsertPoint(fori_cond);
+    value = builder->CreateLoad(counter, "counter");
+    builder->CreateCondBr(stmt->reverse ? builder->CreateICmpSLT(value, upper) : builder->CreateICmpSGT(value, upper),
+        fori_exit,
+        fori_body);
+
+    builder->SetInsertPoint(fori_body);
+    builder->CreateStore(builder->getTrue(), found);
+    EmitVarStore(ctx, stmt->var->dno, value);
+    PushTarget(ctx, stmt->label, true, fori_exit, fori_continue, found);
+    EmitStmts(ctx, stmt->body);
+    PopTarget(ctx);
+    builder->CreateBr(fori_continue);
+
+    /* the loop ends, without error, when the counter would overflow */
+    builder->SetInsertPoint(fori_continue);
+    EmitInterruptCheck(ctx);
+    llvm::Function* func_overflow = llvm::Intrinsic::getDeclaration(llvmCodeGen->module(),
+        stmt->reverse ? llvm::Intrinsic::ssub_with_overflow : llvm::Intrinsic::sadd_with_overflow,
+        Intrinsic_Tys);
+    next = builder->CreateCall(func_overflow, {builder->CreateLoad(counter, "counter"), step}, "next");
+    builder->CreateCondBr(builder->CreateExtractValue(next, 1), fori_exit, fori_next);
+    builder->SetInsertPoint(fori_next);
+    builder->CreateStore(builder->CreateExtractValue(next, 0), counter);
+    builder->CreateBr(fori_cond);
+
+    builder->SetInsertPoint(fori_exit);
+    if (found_varno >= 0 && ctx->values[found_varno] != NULL) {
+        EmitVarStore(ctx, found_varno, builder->CreateLoad(found, "found"));
+    }
+}
+
+static void EmitStmt(PLpgSQLCgContext* ctx, PLpgSQL_stmt* stmt)
+{
+    GsCodeGen::LlvmBuilder* builder = ctx->builder;
+    llvm::LLVMContext& context = ctx->llvmCodeGen->context();
+    ListCell* lc = NULL;
+
+    switch ((enum PLpgSQL_stmt_types)stmt->cmd_type) {
+        case PLPGSQL_STMT_BLOCK: {
+            PLpgSQL_stmt_block* block = (PLpgSQL_stmt_block*)stmt;
+
+            for (int i = 0; i < block->n_initvars; i++) {
+                int dno = block->initvarnos[i];
+                PLpgSQL_var* var = (PLpgSQL_var*)ctx->func->datums[dno];
+
+                if (var->dtype != PLPGSQL_DTYPE_VAR) {
+                    continue;
+                }
+                if (var->default_val != NULL) {
+                    EmitVarStore(ctx, dno, EmitPLExpr(ctx, var->default_val, var->datatype->typoid));
+                } else {
+                    builder->CreateStore(builder->getTrue(), ctx->isnulls[dno]);
+                }
+            }
+            if (block->label == NULL) {
+                EmitStmts(ctx, block->body);
+            } else {
+                DEFINE_BLOCK(block_exit, ctx->fn);
+
+                PushTarget(ctx, block->label, false, block_exit, NULL, NULL);
+                EmitStmts(ctx, block->body);
+                PopTarget(ctx);
+                builder->CreateBr(block_exit);
+                builder->SetInsertPoint(block_exit);
+            }
+            break;
+        }
+        case PLPGSQL_STMT_ASSIGN: {
+            PLpgSQL_stmt_assign* assign = (PLpgSQL_stmt_assign*)stmt;
+
+            EmitVarStore(ctx, assign->varno, EmitPLExpr(ctx, assign->expr, VarType(ctx, assign->varno)));
+            break;
+        }
+        case PLPGSQL_STMT_IF: {
+            PLpgSQL_stmt_if* ifstmt = (PLpgSQL_stmt_if*)stmt;
+            DEFINE_BLOCK(if_done, ctx->fn);
+
+            EmitIfArm(ctx, ifstmt->cond, ifstmt->then_body, if_done);
+            foreach (lc, ifstmt->elsif_list) {
+                PLpgSQL_if_elsif* elsif = (PLpgSQL_if_elsif*)lfirst(lc);
+
+                EmitIfArm(ctx, elsif->cond, elsif->stmts, if_done);
+            }
+            EmitStmts(ctx, ifstmt->else_body);
+            builder->CreateBr(if_done);
+            builder->SetInsertPoint(if_done);
+            break;
+        }
+        case PLPGSQL_STMT_LOOP: {
+            PLpgSQL_stmt_loop* loop = (PLpgSQL_stmt_loop*)stmt;
+            DEFINE_BLOCK(loop_body, ctx->fn);
+            DEFINE_BLOCK(loop_continue, ctx->fn);
+            DEFINE_BLOCK(loop_exit, ctx->fn);
+
+            builder->CreateBr(loop_body);
+            builder->SetInsertPoint(loop_body);
+            PushTarget(ctx, loop->label, true, loop_exit, loop_continue, NULL);
+            EmitStmts(ctx, loop->body);
+            PopTarget(ctx);
+            builder->CreateBr(loop_continue);
+            builder->SetInsertPoint(loop_continue);
+            EmitInterruptCheck(ctx);
+            builder->CreateBr(loop_body);
+            builder->SetInsertPoint(loop_exit);
+            break;
+        }
+        case PLPGSQL_STMT_WHILE: {
+            PLpgSQL_stmt_while* whilestmt = (PLpgSQL_stmt_while*)stmt;
+            DEFINE_BLOCK(while_cond, ctx->fn);
+            DEFINE_BLOCK(while_body, ctx->fn);
+            DEFINE_BLOCK(while_continue, ctx->fn);
+            DEFINE_BLOCK(while_exit, ctx->fn);
+
+            builder->CreateBr(while_cond);
+            builder->SetInsertPoint(while_cond);
+            builder->CreateCondBr(EmitPLExpr(ctx, whilestmt->cond, BOOLOID), while_body, while_exit);
+            builder->SetInsertPoint(while_body);
+            PushTarget(ctx, whilestmt->label, true, while_exit, while_continue, NULL);
+            EmitStmts(ctx, whilestmt->body);
+            PopTarget(ctx);
+            builder->CreateBr(while_continue);
+            builder->SetInsertPoint(while_continue);
+            EmitInterruptCheck(ctx);
+            builder->CreateBr(while_cond);
+            builder->SetInsertPoint(while_exit);
+            break;
+        }
+        case PLPGSQL_STMT_FORI:
+            EmitFori(ctx, (PLpgSQL_stmt_fori*)stmt);
+            break;
+        case PLPGSQL_STMT_EXIT: {
+            PLpgSQL_stmt_exit* exitstmt = (PLpgSQL_stmt_exit*)stmt;
+
+            if (exitstmt->cond != NULL) {
+                DEFINE_BLOCK(exit_taken, ctx->fn);
+                DEFINE_BLOCK(exit_skipped, ctx->fn);
+
+                builder->CreateCondBr(EmitPLExpr(ctx, exitstmt->cond, BOOLOID), exit_taken, exit_skipped);
+                builder->SetInsertPoint(exit_taken);
+                EmitExitJump(ctx, exitstmt);
+                builder->SetInsertPoint(exit_skipped);
+            } else {
+                DEFINE_BLOCK(exit_unreachable, ctx->fn);
+
+                EmitExitJump(ctx, exitstmt);
+                builder->SetInsertPoint(exit_unreachable);
+            }
+            break;
+        }
+        case PLPGSQL_STMT_RETURN: {
+            PLpgSQL_stmt_return* ret = (PLpgSQL_stmt_return*)stmt;
+            Oid rettype = ctx->func->fn_rettype;
+            llvm::Value* value = NULL;
+            DEFINE_BLOCK(return_unreachable, ctx->fn);
+
+            if (ret->retvarno >= 0) {
+                value = EmitCast(ctx, EmitVarLoad(ctx, ret->retvarno), VarType(ctx, ret->retvarno), rettype);
+            } else {
+                value = EmitPLExpr(ctx, ret->expr, rettype);
+            }
+            builder->CreateStore(EmitToDatum(ctx, value, rettype), ctx->fn->arg_begin() + 1);
+            builder->CreateRet(ctx->llvmCodeGen->getIntConstant(INT4OID, 0));
+            builder->SetInsertPoint(return_unreachable);
+            break;
+        }
+        default:
+            /* PLPGSQL_STMT_NULL */
+            break;
+    }
+}
+
+namespace dorado {
+const char* PLpgSQLCodeGen::CheckFunction(PLpgSQL_function* func, bool* retry)
+{
+    PLpgSQLCgContext ctx;
+    errno_t rc = memset_s(&ctx, sizeof(ctx), 0, sizeof(ctx));
+    securec_check(rc, "\0", "\0");
+
+    ctx.func = func;
+    ctx.tracked = (bool*)palloc0(sizeof(bool) * Max(func->ndatums, 1));
+    if (CheckSignature(&ctx)) {
+        (void)CheckStmt(&ctx, (PLpgSQL_stmt*)func->action);
+    }
+    pfree(ctx.tracked);
+
+    *retry = ctx.retry;
+    return ctx.reason;
+}
+
+PLpgSQL_native_fn PLpgSQLCodeGen::CompileFunction(PLpgSQL_function* func, GsCodeGen* llvmCodeGen)
+{
+    llvm::LLVMContext& context = llvmCodeGen->context();
+    GsCodeGen::LlvmBuilder builder(context);
+    PLpgSQLCgContext ctx;
+    llvm::Value* llvmargs[3];
+    void* native = NULL;
+    errno_t rc = memset_s(&ctx, sizeof(ctx), 0, sizeof(ctx));
+    securec_check(rc, "\0", "\0");
+
+    /* int32 fn(Datum* args, Datum* result, volatile bool* interrupt) */
+    DEFINE_CG_TYPE(int32Type, INT4OID);
+    DEFINE_CG_PTRTYPE(int64PtrType, INT8OID);
+    DEFINE_CG_PTRTYPE(int8PtrType, CHAROID);
+
+    GsCodeGen::FnPrototype fn_prototype(llvmCodeGen, "Jitted_plpgsql", int32Type);
+    fn_prototype.addArgument(GsCodeGen::NamedVariable("args", int64PtrType));
+    fn_prototype.addArgument(GsCodeGen::NamedVariable("result", int64PtrType));
+    fn_prototype.addArgument(GsCodeGen::NamedVariable("interrupt", int8PtrType));
+    llvm::Function* jitted_plpgsql = fn_prototype.generatePrototype(&builder, &llvmargs[0]);
+
+    ctx.func = func;
+    ctx.llvmCodeGen = llvmCodeGen;
+    ctx.builder = &builder;
+    ctx.fn = jitted_plpgsql;
+    ctx.interrupt = llvmargs[2];
+    ctx.values = (llvm::Value**)palloc0(sizeof(llvm::Value*) * Max(func->ndatums, 1));
+    ctx.isnulls = (llvm::Value**)palloc0(sizeof(llvm::Value*) * Max(func->ndatums, 1));
+
+    DEFINE_BLOCK(fallback, jitted_plpgsql);
+    ctx.fallbackBB = fallback;
+
+    /* every variable the native code may touch starts NULL, like in the datums of the function */
+    for (int dno = 0; dno < func->ndatums; dno++) {
+        if (IsSupportedVar(func->datums[dno])) {
+            ctx.values[dno] = EmitEntryAlloca(&ctx, LlvmType(&ctx, VarType(&ctx, dno)), "var");
+            ctx.isnulls[dno] = EmitEntryAlloca(&ctx, LlvmType(&ctx, BOOLOID), "var_isnull");
+            builder.CreateStore(builder.getTrue(), ctx.isnulls[dno]);
+        }
+    }
+
+    /* the caller only runs the native code when no argument is NULL */
+    for (int i = 0; i < func->fn_nargs; i++) {
+        int dno = func->fn_argvarnos[i];
+        llvm::Value* arg = builder.CreateLoad(builder.CreateInBoundsGEP(llvmargs[0], builder.getInt64(i)), "arg");
+
+        EmitVarStore(&ctx, dno, EmitFromDatum(&ctx, arg, VarType(&ctx, dno)));
+    }
+    if (func->found_varno >= 0 && ctx.values[func->found_varno] != NULL) {
+        EmitVarStore(&ctx, func->found_varno, builder.getFalse());
+    }
+
+    EmitStmt(&ctx, (PLpgSQL_stmt*)func->action);
+
+    /* control reached end of function without RETURN */
+    builder.CreateBr(fallback);
+    builder.SetInsertPoint(fallback);
+    builder.CreateRet(llvmCodeGen->getIntConstant(INT4OID, 1));
+
+    pfree(ctx.values);
+    pfree(ctx.isnulls);
+
+    llvmCodeGen->FinalizeFunction(jitted_plpgsql);
+    llvmCodeGen->addFunctionToMCJit(jitted_plpgsql, &native);
+    llvmCodeGen->enableOptimizations(true);
+    llvmCodeGen->compileCurrentModule(false);
+
+    return (PLpgSQL_native_fn)native;
+}
+}  // namespace dorado
+
+static bool PLpgSQLCodeGenAvailable()
+{
+    if (!GlobalCodeGenEnvironmentSuccess || !u_sess->attr.attr_sql.enable_codegen) {
+        return false;
+    }
+#ifdef __aarch64__
+    return true;
+#else
+    return isCPUFeatureSupportCodegen();
+#endif
+}
+
+/*
+ * Compile func, called by the interpreter once func is hot.  The status is
+ * left to PLPGSQL_CODEGEN_NONE when a later call may succeed, and an error
+ * of LLVM only leaves the function interpreted.
+ */
+void PLpgSQLFunctionCodeGen(PLpgSQL_function* func)
+{
+    MemoryContext oldcxt = CurrentMemoryContext;
+    GsCodeGen* volatile llvmCodeGen = NULL;
+    PLpgSQL_native_fn volatile native = NULL;
+    bool retry = false;
+
+    func->fn_codegen_reason = PLpgSQLCodeGen::CheckFunction(func, &retry);
+    if (func->fn_codegen_reason != NULL) {
+        if (!retry) {
+            func->fn_codegen_status = PLPGSQL_CODEGEN_UNSUPPORTED;
+        }
+        return;
+    }
+    if (!PLpgSQLCodeGenAvailable()) {
+        func->fn_codegen_reason = "codegen is not available";
+        return;
+    }
+
+    PG_TRY();
+    {
+        /* the native code lives as long as the compiled function */
+        (void)MemoryContextSwitchTo(func->fn_cxt);
+        llvmCodeGen = New(func->fn_cxt) GsCodeGen();
+        llvmCodeGen->initialize();
+        llvmCodeGen->createNewModule();
+        native = PLpgSQLCodeGen::CompileFunction(func, llvmCodeGen);
+        (void)MemoryContextSwitchTo(oldcxt);
+    }
+    PG_CATCH();
+    {
+        (void)MemoryContextSwitchTo(oldcxt);
+        FlushErrorState();
+        native = NULL;
+    }
+    PG_END_TRY();
+
+    if (native == NULL) {
+        if (llvmCodeGen != NULL) {
+            llvmCodeGen->releaseEngine();
+            delete llvmCodeGen;
+        }
+        func->fn_codegen_status = PLPGSQL_CODEGEN_FAILED;
+        func->fn_codegen_reason = "LLVM failed to compile the function";
+        ereport(LOG,
+            (errmodule(MOD_LLVM), errmsg("Failed to compile PL/pgSQL function \"%s\".", func->fn_signature)));
+        return;
+    }
+
+    func->fn_codegen = llvmCodeGen;
+    func->fn_native = native;
+    func->fn_codegen_status = PLPGSQL_CODEGEN_COMPILED;
+}
+
+/* Free the native code of func, its memory is not in the context of the function */
+void PLpgSQLFunctionCodeGenRelease(PLpgSQL_function* func)
+{
+    GsCodeGen* llvmCodeGen = (GsCodeGen*)func->fn_codegen;
+
+    func->fn_native = NULL;
+    func->fn_codegen = NULL;
+    if (llvmCodeGen != NULL) {
+        llvmCodeGen->releaseEngine();
+        delete llvmCodeGen;
+    }
+}
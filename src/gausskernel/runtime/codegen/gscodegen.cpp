@@ -435,6 +435,13 @@ llvm::ExecutionEngine* GsCodeGen::compileModule(llvm::Module* module, bool enabl
 }
 
 void GsCodeGen::releaseResource()
+{
+    releaseEngine();
+    lock_codegen_process_sub(t_thrd.codegen_cxt.codegen_IRload_thr_count);
+    t_thrd.codegen_cxt.codegen_IRload_thr_count = 0;
+}
+
+void GsCodeGen::releaseEngine()
 {
     /* release codeGenContext, which contains IR function list */
     if (m_codeGenContext) {
@@ -467,8 +474,6 @@ void GsCodeGen::releaseResource()
         LLVM_CATCH("Failed to release LLVM module!");
         m_currentModule = NULL;
     }
-    lock_codegen_process_sub(t_thrd.codegen_cxt.codegen_IRload_thr_count);
-    t_thrd.codegen_cxt.codegen_IRload_thr_count = 0;
 }
 
 bool GsCodeGen::init()
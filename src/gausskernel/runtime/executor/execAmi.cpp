@@ -268,6 +268,9 @@ void ExecReScan(PlanState* node)
     if (node->instrument) {
         InstrEndLoop(node->instrument);
     }
+    if (node->cardcounter != NULL) {
+        CardCounterEndLoop(node->cardcounter);
+    }
 
     /*
      * If we have changed parameters, propagate that info.
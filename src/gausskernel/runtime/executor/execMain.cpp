@@ -42,6 +42,7 @@
 #include "knl/knl_variable.h"
 
 #include "access/htup.h"
+#include "access/printtup.h"
 #include "access/sysattr.h"
 #include "access/transam.h"
 #include "access/xact.h"
@@ -57,6 +58,7 @@
 #include "libpq/pqsignal.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
+#include "optimizer/cardfeedback.h"
 #include "optimizer/clauses.h"
 #include "parser/parsetree.h"
 #include "pgstat.h"
@@ -110,6 +112,7 @@ static void ExecutePlan(EState *estate, PlanState *planstate, CmdType operation,
     ScanDirection direction, DestReceiver *dest, JitExec::JitContext* mot_jit_context);
 static void ExecuteVectorizedPlan(EState *estate, PlanState *planstate, CmdType operation, bool sendTuples,
     long numberTuples, ScanDirection direction, DestReceiver *dest);
+static bool ExecColumnBatchResult(QueryDesc *queryDesc, DestReceiver *dest, long count);
 static bool ExecCheckRTEPerms(RangeTblEntry *rte);
 static bool ExecCheckRTEPermsModified(Oid relOid, Oid userid, Bitmapset *modifiedCols, AclMode requiredPerms);
 void ExecCheckXactReadOnly(PlannedStmt *plannedstmt);
@@ -570,6 +573,10 @@ void standard_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction, long co
     if (!ScanDirectionIsNoMovement(direction)) {
         if (queryDesc->planstate->vectorized) {
             ExecuteVectorizedPlan(estate, queryDesc->planstate, operation, send_tuples, count, direction, dest);
+        } else if (send_tuples && ExecColumnBatchResult(queryDesc, dest, count)) {
+            /* skip the VecToRow on top and send its input batches as they are */
+            ExecuteVectorizedPlan(estate, outerPlanState(queryDesc->planstate), operation, send_tuples, count,
+                direction, dest);
         } else {
             ExecutePlan(estate, queryDesc->planstate, operation, send_tuples,
                 count, direction, dest, queryDesc->mot_jit_context);
@@ -715,6 +722,12 @@ void standard_ExecutorEnd(QueryDesc *queryDesc)
      * Switch into per-query memory context to run ExecEndPlan
      */
     old_context = MemoryContextSwitchTo(estate->es_query_cxt);
+
+    /* Feed the rows the scans really returned back to the planner */
+    if (u_sess->attr.attr_sql.enable_cardinality_feedback) {
+        cardinality_feedback_record(queryDesc->planstate);
+    }
+
     EARLY_FREE_LOG(elog(LOG, "Early Free: Start to end plan, memory used %d MB.", getSessionMemoryUsageMB()));
     ExecEndPlan(queryDesc->planstate, estate);
 
@@ -2085,6 +2098,28 @@ static void ExecutePlan(EState *estate, PlanState *planstate, CmdType operation,
     }
 }
 
+/* ----------------------------------------------------------------
+ * 		ExecColumnBatchResult
+ *
+ * 		Decides whether a query whose plan is vectorized up to the VecToRow
+ * 		on top can send its batches as they are to a client that asked for
+ * 		columnar results: all rows must be wanted at once and no junk
+ * 		columns may need to be filtered out.
+ * ----------------------------------------------------------------
+ */
+static bool ExecColumnBatchResult(QueryDesc *queryDesc, DestReceiver *dest, long count)
+{
+    if (!u_sess->attr.attr_sql.columnar_result_transfer || count != 0 ||
+        queryDesc->operation != CMD_SELECT || !IsA(queryDesc->planstate, VecToRowState) ||
+        queryDesc->estate->es_junkFilter != NULL)
+        return false;
+
+    if (dest->mydest != DestRemote && dest->mydest != DestRemoteExecute)
+        return false;
+
+    return printtup_use_column_batch(dest, queryDesc->tupDesc);
+}
+
 /* ----------------------------------------------------------------
  * 		ExecutePlan
  *
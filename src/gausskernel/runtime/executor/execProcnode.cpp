@@ -116,6 +116,7 @@
 #include "executor/nodeWindowAgg.h"
 #include "executor/nodeWorktablescan.h"
 #include "executor/execStream.h"
+#include "optimizer/cardfeedback.h"
 #include "optimizer/clauses.h"
 #include "optimizer/encoding.h"
 #include "optimizer/ml_model.h"
@@ -554,6 +555,11 @@ PlanState* ExecInitNode(Plan* node, EState* e_state, int e_flags)
         }
     }
 
+    /* Count the rows of scans whose estimates are fed back to the planner */
+    if (u_sess->attr.attr_sql.enable_cardinality_feedback && cardinality_feedback_tracked(node, e_state)) {
+        result->cardcounter = CardCounterAlloc();
+    }
+
     /* Switch to OldContext */
     MemoryContextSwitchTo(old_context);
 
@@ -741,6 +747,10 @@ TupleTableSlot* ExecProcNode(PlanState* node)
         ExecProcNodeInstr(node, result);
     }
 
+    if (unlikely(node->cardcounter != NULL)) {
+        CardCounterCount(node->cardcounter, TupIsNull(result));
+    }
+
     MemoryContextSwitchTo(old_context);
 
     return result;
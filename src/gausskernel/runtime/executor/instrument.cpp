@@ -107,6 +107,7 @@ static inline uint64 rdtsc(void)
 sortMessage sortmessage[] = {
     {HEAPSORT, "top-N heapsort"},
     {QUICKSORT, "quicksort"},
+    {PARALLELQUICKSORT, "parallel quicksort"},
     {EXTERNALSORT, "external sort"},
     {EXTERNALMERGE, "external merge"},
     {STILLINPROGRESS, "still in progress"},
@@ -622,6 +623,47 @@ void InstrEndLoop(Instrumentation* instr)
     instr->tuplecount = 0;
 }
 
+/* Allocate a cardinality feedback row counter */
+CardCounter* CardCounterAlloc(void)
+{
+    return (CardCounter*)palloc0(sizeof(CardCounter));
+}
+
+/* Count one call of a plan node; done is TRUE when it returned no tuple */
+void CardCounterCount(CardCounter* counter, bool done)
+{
+    counter->running = true;
+
+    if (done)
+        counter->finished = true;
+    else
+        counter->tuplecount += 1;
+}
+
+/*
+ * Finish a run cycle of a plan node.  Only cycles that read their input to
+ * the end tell how many rows the node really produces; the ones cut short
+ * are just counted so that callers can ignore the node altogether.
+ */
+void CardCounterEndLoop(CardCounter* counter)
+{
+    /* Skip if nothing has happened, or already shut down */
+    if (!counter->running)
+        return;
+
+    if (counter->finished) {
+        counter->ntuples += counter->tuplecount;
+        counter->nloops += 1;
+    } else {
+        counter->nabandoned += 1;
+    }
+
+    /* Reset for next cycle (if any) */
+    counter->running = false;
+    counter->finished = false;
+    counter->tuplecount = 0;
+}
+
 void InstrStartStream(StreamTime* instr)
 {
     if (instr->need_timer) {
@@ -164,7 +164,15 @@ static TupleTableSlot* project_aggregates(AggState* aggstate);
 static Bitmapset* find_unaggregated_cols(AggState* aggstate);
 static bool find_unaggregated_cols_walker(Node* node, Bitmapset** colnos);
 static void build_hash_table(AggState* aggstate);
+static void agg_hash_alloc_slots(AggState* aggstate, uint32 nslots);
+static void agg_hash_grow(AggState* aggstate);
+static AggHashEntry agg_hash_lookup(AggState* aggstate, bool insert, bool* isnew, uint32* hashvalue);
+static AggHashEntry agg_hash_next(AggState* aggstate);
 static AggHashEntry lookup_hash_entry(AggState* aggstate, TupleTableSlot* inputslot);
+static long agg_spill_num_groups(AggState* aggstate);
+static void agg_respill_check(AggState* aggstate);
+static void agg_respill_tuple(AggState* aggstate, MinimalTuple tuple, uint32 hashvalue);
+static void agg_close_spill_files(AggWriteFileControl* TempFileControl);
 static TupleTableSlot* agg_retrieve_direct(AggState* aggstate);
 static void agg_fill_hash_table(AggState* aggstate);
 static TupleTableSlot* agg_retrieve_hash_table(AggState* aggstate);
@@ -1117,13 +1125,18 @@ static bool find_unaggregated_cols_walker(Node* node, Bitmapset** colnos)
 /*
  * Initialize the hash table to empty.
  *
- * The hash table always lives in the aggcontext memory context.
+ * The hash table always lives in the aggcontext memory context.  Only the
+ * key description of the TupleHashTable is used; the groups are kept in the
+ * open-addressing slot array of the AggState rather than in a dynahash.
  */
 static void build_hash_table(AggState* aggstate)
 {
     Agg* node = (Agg*)aggstate->ss.ps.plan;
     MemoryContext tmpmem = aggstate->tmpcontext->ecxt_per_tuple_memory;
+    TupleHashTable hashtable;
     Size entrysize;
+    long nbuckets;
+    uint32 nslots;
     int64 workMem = SET_NODEMEM(node->plan.operatorMemKB[0], node->plan.dop);
 
     Assert(node->aggstrategy == AGG_HASHED);
@@ -1138,15 +1151,170 @@ static void build_hash_table(AggState* aggstate)
 
     entrysize = offsetof(AggHashEntryData, pergroup) + (aggstate->numaggs) * sizeof(AggStatePerGroupData);
 
-    aggstate->hashtable = BuildTupleHashTable(node->numCols,
-        node->grpColIdx,
-        aggstate->phase->eqfunctions,
-        aggstate->hashfunctions,
-        node->numGroups,
-        entrysize,
-        aggstate->aggcontexts[0],
-        tmpmem,
-        workMem);
+    /* Limit initial table size request to not more than work_mem */
+    nbuckets = Min(node->numGroups, (long)((workMem * 1024L) / entrysize));
+    if (u_sess->attr.attr_sql.hashagg_table_size != 0)
+        nbuckets = Min(nbuckets, u_sess->attr.attr_sql.hashagg_table_size);
+
+    hashtable = (TupleHashTable)MemoryContextAllocZero(aggstate->aggcontexts[0], sizeof(TupleHashTableData));
+    hashtable->hashtab = NULL;
+    hashtable->numCols = node->numCols;
+    hashtable->keyColIdx = node->grpColIdx;
+    hashtable->tab_hash_funcs = aggstate->hashfunctions;
+    hashtable->tab_eq_funcs = aggstate->phase->eqfunctions;
+    hashtable->tablecxt = aggstate->aggcontexts[0];
+    hashtable->tempcxt = tmpmem;
+    hashtable->entrysize = entrysize;
+    hashtable->tableslot = NULL; /* will be made on first lookup */
+    hashtable->add_width = true;
+    aggstate->hashtable = hashtable;
+
+    /* The table grows as groups arrive, so don't start with all of work_mem */
+    nslots = AGG_HASH_MIN_SLOTS;
+    while (nslots < AGG_HASH_MAX_INIT_SLOTS && AGG_HASH_FULL(nbuckets, nslots))
+        nslots <<= 1;
+    agg_hash_alloc_slots(aggstate, nslots);
+    aggstate->hash_nused = 0;
+    aggstate->hash_scanpos = 0;
+}
+
+/*
+ * Allocate an empty slot array of nslots (a power of 2) for the hash table.
+ */
+static void agg_hash_alloc_slots(AggState* aggstate, uint32 nslots)
+{
+    AggHashSlot slots;
+
+    slots = (AggHashSlot)palloc_huge(aggstate->hashtable->tablecxt, (Size)nslots * sizeof(AggHashSlotData));
+    for (uint32 i = 0; i < nslots; i++) {
+        slots[i].hash = 0;
+        slots[i].entry = NULL;
+    }
+    aggstate->hash_slots = slots;
+    aggstate->hash_nslots = nslots;
+}
+
+/*
+ * Double the slot array and move the groups over using their saved hash
+ * values.
+ */
+static void agg_hash_grow(AggState* aggstate)
+{
+    AggHashSlot oldslots = aggstate->hash_slots;
+    uint32 oldnslots = aggstate->hash_nslots;
+    uint32 mask;
+
+    if (oldnslots > PG_UINT32_MAX / 2)
+        ereport(ERROR,
+            (errmodule(MOD_EXECUTOR),
+                errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                errmsg("too many groups in the hash table of HashAgg(%d)", aggstate->ss.ps.plan->plan_node_id)));
+
+    agg_hash_alloc_slots(aggstate, oldnslots * 2);
+    mask = aggstate->hash_nslots - 1;
+    for (uint32 i = 0; i < oldnslots; i++) {
+        uint32 pos;
+
+        if (oldslots[i].entry == NULL)
+            continue;
+        pos = oldslots[i].hash & mask;
+        while (aggstate->hash_slots[pos].entry != NULL)
+            pos = (pos + 1) & mask;
+        aggstate->hash_slots[pos] = oldslots[i];
+    }
+    pfree_ext(oldslots);
+}
+
+/*
+ * Find the group of the tuple in hashslot and create it when insert is true
+ * and it is missing.  *isnew is set if the group was not in the table, in
+ * which case NULL is returned unless it has been created; any extra space in
+ * a new entry is zeroed.  The hash value of the tuple is returned in
+ * *hashvalue so that a row sent to a temp file needn't be hashed again.
+ */
+static AggHashEntry agg_hash_lookup(AggState* aggstate, bool insert, bool* isnew, uint32* hashvalue)
+{
+    TupleHashTable hashtable = aggstate->hashtable;
+    TupleTableSlot* slot = aggstate->hashslot;
+    AggHashSlot hslot = NULL;
+    AggHashEntry entry = NULL;
+    MemoryContext oldContext;
+    uint32 hash;
+    uint32 mask;
+    uint32 pos;
+
+    /* If first time through, clone the input slot to make table slot */
+    if (hashtable->tableslot == NULL) {
+        TupleDesc tupdesc;
+
+        oldContext = MemoryContextSwitchTo(hashtable->tablecxt);
+        tupdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
+        hashtable->tableslot = MakeSingleTupleTableSlot(tupdesc);
+        MemoryContextSwitchTo(oldContext);
+    }
+
+    /* Need to run the hash and equality functions in short-lived context */
+    oldContext = MemoryContextSwitchTo(hashtable->tempcxt);
+
+    hashtable->inputslot = slot;
+    hashtable->in_hash_funcs = hashtable->tab_hash_funcs;
+    hashtable->cur_eq_funcs = hashtable->tab_eq_funcs;
+    hash = ComputeHashValue(hashtable);
+
+    mask = aggstate->hash_nslots - 1;
+    for (pos = hash & mask;; pos = (pos + 1) & mask) {
+        hslot = &aggstate->hash_slots[pos];
+        if (hslot->entry == NULL)
+            break;
+        if (hslot->hash != hash)
+            continue;
+
+        ExecStoreMinimalTuple(hslot->entry->shared.firstTuple, hashtable->tableslot, false);
+        if (execTuplesMatch(slot,
+                hashtable->tableslot,
+                hashtable->numCols,
+                hashtable->keyColIdx,
+                hashtable->cur_eq_funcs,
+                hashtable->tempcxt)) {
+            entry = hslot->entry;
+            break;
+        }
+    }
+
+    *isnew = (entry == NULL);
+    if (entry == NULL && insert) {
+        /* Copy the first tuple into the table context */
+        MemoryContextSwitchTo(hashtable->tablecxt);
+        entry = (AggHashEntry)palloc0(hashtable->entrysize);
+        entry->shared.firstTuple = ExecCopySlotMinimalTuple(slot);
+        if (hashtable->add_width)
+            hashtable->width += entry->shared.firstTuple->t_len;
+
+        hslot->hash = hash;
+        hslot->entry = entry;
+        aggstate->hash_nused++;
+        if (AGG_HASH_FULL(aggstate->hash_nused, aggstate->hash_nslots))
+            agg_hash_grow(aggstate);
+    }
+
+    MemoryContextSwitchTo(oldContext);
+
+    *hashvalue = hash;
+    return entry;
+}
+
+/*
+ * Return the next group of the hash table, or NULL once all were returned.
+ */
+static AggHashEntry agg_hash_next(AggState* aggstate)
+{
+    while (aggstate->hash_scanpos < aggstate->hash_nslots) {
+        AggHashEntry entry = aggstate->hash_slots[aggstate->hash_scanpos++].entry;
+
+        if (entry != NULL)
+            return entry;
+    }
+    return NULL;
 }
 
 /*
@@ -1209,7 +1377,7 @@ Size hash_agg_entry_size(int numAggs)
     /* This must match build_hash_table */
     entrysize = offsetof(AggHashEntryData, pergroup) + numAggs * sizeof(AggStatePerGroupData);
     entrysize = MAXALIGN(entrysize);
-    /* Account for hashtable overhead (assuming fill factor = 1) */
+    /* Account for the slot array, kept at most 3/4 full, and palloc overhead */
     entrysize += 3 * sizeof(void*);
     return entrysize;
 }
@@ -1267,6 +1435,7 @@ static AggHashEntry lookup_hash_entry(AggState* aggstate, TupleTableSlot* inputs
     ListCell* l = NULL;
     AggHashEntry entry;
     bool isnew = false;
+    uint32 hashvalue;
     AggWriteFileControl* TempFileControl = (AggWriteFileControl*)aggstate->aggTempFileControl;
 
     /* if first time through, initialize hashslot by cloning input slot */
@@ -1285,12 +1454,21 @@ static AggHashEntry lookup_hash_entry(AggState* aggstate, TupleTableSlot* inputs
         hashslot->tts_isnull[varNumber] = inputslot->tts_isnull[varNumber];
     }
 
-    if (TempFileControl->spillToDisk == false || TempFileControl->finishwrite == true) {
+    TempFileControl->inputRownum++;
+
+    /*
+     * New groups are only created while the hash table has room.  Once it is
+     * full, rows of groups missing from the table go to temp files, both on
+     * the first pass and while a spilled file is read back, so the memory
+     * stays bounded at every level.
+     */
+    if (TempFileControl->spillToDisk == false ||
+        (TempFileControl->finishwrite == true && TempFileControl->respill == false)) {
         /* find or create the hashtable entry using the filtered tuple */
-        entry = (AggHashEntry)LookupTupleHashEntry(aggstate->hashtable, hashslot, &isnew, true);
+        entry = agg_hash_lookup(aggstate, true, &isnew, &hashvalue);
     } else {
         /* this solt need be insert into temp file instead of hash table if it is not existed in hash table */
-        entry = (AggHashEntry)LookupTupleHashEntry(aggstate->hashtable, hashslot, &isnew, false);
+        entry = agg_hash_lookup(aggstate, false, &isnew, &hashvalue);
     }
 
     if (isnew) {
@@ -1298,10 +1476,14 @@ static AggHashEntry lookup_hash_entry(AggState* aggstate, TupleTableSlot* inputs
         if (entry) {
             /* initialize aggregates for new tuple group */
             initialize_aggregates(aggstate, aggstate->peragg, entry->pergroup);
+            if (TempFileControl->finishwrite) {
+                agg_respill_check(aggstate);
+                return entry;
+            }
             agg_spill_to_disk(TempFileControl,
                             aggstate->hashtable,
                             aggstate->hashslot,
-                            ((Agg*)aggstate->ss.ps.plan)->numGroups,
+                            agg_spill_num_groups(aggstate),
                             true,
                             aggstate->ss.ps.plan->plan_node_id,
                             SET_DOP(aggstate->ss.ps.plan->dop),
@@ -1311,23 +1493,129 @@ static AggHashEntry lookup_hash_entry(AggState* aggstate, TupleTableSlot* inputs
                 TempFileControl->filesource->m_spill_size = &aggstate->ss.ps.instrument->sorthashinfo.spill_size;
             }
         } else { /* this slot is new, it need be inserted to temp file */
-            Assert(TempFileControl->spillToDisk == true && TempFileControl->finishwrite == false);
-            uint32 hashvalue;
+            Assert(TempFileControl->spillToDisk == true);
             MinimalTuple tuple = ExecFetchSlotMinimalTuple(inputslot);
-            MemoryContext oldContext;
-            /*
-             * Here need switch memorycontext to ecxt_per_tuple_memory, so memory which be applyed in function
-             * ComputeHashValue is freed.
-             */
-            oldContext = MemoryContextSwitchTo(aggstate->tmpcontext->ecxt_per_tuple_memory);
-            hashvalue = ComputeHashValue(aggstate->hashtable);
-            MemoryContextSwitchTo(oldContext);
-            TempFileControl->filesource->writeTup(tuple, hashvalue & (TempFileControl->filenum - 1));
+            if (TempFileControl->finishwrite) {
+                agg_respill_tuple(aggstate, tuple, hashvalue);
+            } else {
+                TempFileControl->filesource->writeTup(tuple, hashvalue & (TempFileControl->filenum - 1));
+            }
         }
     }
     return entry;
 }
 
+/*
+ * Number of groups used to size the first level of spill files.  If nearly
+ * every row seen so far started a new group, the planner estimate is not
+ * trusted and the groups are assumed to follow the input rows instead.
+ */
+static long agg_spill_num_groups(AggState* aggstate)
+{
+    AggWriteFileControl* TempFileControl = (AggWriteFileControl*)aggstate->aggTempFileControl;
+    long numGroups = ((Agg*)aggstate->ss.ps.plan)->numGroups;
+    double ratio;
+    double inputRows;
+
+    if (TempFileControl->inputRownum <= 0) {
+        return numGroups;
+    }
+
+    ratio = (double)TempFileControl->inmemoryRownum / TempFileControl->inputRownum;
+    if (ratio < HASHAGG_HIGH_CARDINALITY_RATIO) {
+        return numGroups;
+    }
+
+    inputRows = outerPlan(aggstate->ss.ps.plan)->plan_rows * ratio;
+    if (inputRows > (double)numGroups) {
+        numGroups = (long)Min(inputRows, (double)INT_MAX);
+    }
+    return numGroups;
+}
+
+/*
+ * While a spilled file is read back, check whether the hash table built for
+ * it still has room for the group just added; if not, the rows of groups
+ * that are not in the table yet are partitioned again.
+ */
+static void agg_respill_check(AggState* aggstate)
+{
+    AggWriteFileControl* TempFileControl = (AggWriteFileControl*)aggstate->aggTempFileControl;
+    TupleHashTable hashtable = aggstate->hashtable;
+    AllocSetContext* set = (AllocSetContext*)(hashtable->tablecxt);
+    int64 usedSize;
+
+    TempFileControl->inmemoryRownum++;
+    usedSize = set->totalSpace + TempFileControl->inmemoryRownum * hashtable->entrysize;
+    if (usedSize >= TempFileControl->totalMem) {
+        TempFileControl->respill = true;
+    }
+}
+
+/*
+ * Write a row read back from a spilled file to the next level of temp
+ * files.  The fan-out follows how many times the current file exceeds what
+ * fit in memory, and each level partitions on different hash bits, as all
+ * rows of one file share the bits used to pick it.
+ */
+static void agg_respill_tuple(AggState* aggstate, MinimalTuple tuple, uint32 hashvalue)
+{
+    AggWriteFileControl* TempFileControl = (AggWriteFileControl*)aggstate->aggTempFileControl;
+    int level = TempFileControl->spillLevel + 1;
+    uint32 filevalue;
+
+    if (TempFileControl->overflowsource == NULL) {
+        int64 rows = TempFileControl->filesource->m_rownum[TempFileControl->curfile];
+        int64 fitRows = Max(TempFileControl->inmemoryRownum, 1);
+        int filenum = getPower2Num((int)Min(rows / fitRows + 1, (int64)HASH_MAX_FILENUMBER));
+
+        filenum = Max(2, filenum);
+        TempFileControl->overflowFileNum = filenum;
+        TempFileControl->overflowsource = New(CurrentMemoryContext) hashFileSource(aggstate->hashslot, filenum);
+        if (aggstate->ss.ps.instrument) {
+            TempFileControl->overflowsource->m_spill_size = &aggstate->ss.ps.instrument->sorthashinfo.spill_size;
+            aggstate->ss.ps.instrument->sorthashinfo.hash_spillNum++;
+            aggstate->ss.ps.instrument->sorthashinfo.hash_FileNum += filenum;
+        }
+
+        ereport(DEBUG2,
+            (errmodule(MOD_EXECUTOR),
+                errmsg("HashAgg(%d) respills temp file %d of level %d (%ld rows, %ld in memory) into %d files",
+                    aggstate->ss.ps.plan->plan_node_id,
+                    TempFileControl->curfile,
+                    TempFileControl->spillLevel,
+                    rows,
+                    TempFileControl->inmemoryRownum,
+                    filenum)));
+    }
+
+    filevalue = DatumGetUInt32(hash_uint32(hashvalue ^ (uint32)level));
+    TempFileControl->overflowsource->writeTup(tuple, filevalue & (TempFileControl->overflowFileNum - 1));
+}
+
+/* Close and release all temp files of a hash agg, including respilled ones. */
+static void agg_close_spill_files(AggWriteFileControl* TempFileControl)
+{
+    hashFileSource* file = TempFileControl->filesource;
+
+    if (file != NULL) {
+        for (int i = 0; i < TempFileControl->filenum; i++) {
+            file->close(i);
+        }
+        file->freeFileSource();
+    }
+
+    file = TempFileControl->overflowsource;
+    if (file != NULL) {
+        for (int i = 0; i < TempFileControl->overflowFileNum; i++) {
+            file->close(i);
+        }
+        file->freeFileSource();
+    }
+    TempFileControl->overflowsource = NULL;
+    TempFileControl->overflowFileNum = 0;
+}
+
 /* prepare_data_source
  * get next data source, if it has finished return false else return true
  */
@@ -1346,31 +1634,48 @@ static bool prepare_data_source(AggState* node)
         TempFileControl->m_hashAggSource = New(CurrentMemoryContext) hashOpSource(outerPlanState(node));
     /* get data from temp file */
     } else if (TempFileControl->strategy == DIST_HASHAGG) { 
-        TempFileControl->m_hashAggSource = TempFileControl->filesource;
         if (TempFileControl->curfile >= 0) {
             TempFileControl->filesource->close(TempFileControl->curfile);
         }
         TempFileControl->curfile++;
-        while (TempFileControl->curfile < TempFileControl->filenum) {
-            int currfileidx = TempFileControl->curfile;
-            if (TempFileControl->filesource->m_rownum[currfileidx] != 0) {
-                TempFileControl->filesource->setCurrentIdx(currfileidx);
-                MemoryContextResetAndDeleteChildren(node->aggcontexts[0]);
-                build_hash_table(node);
-
-                TempFileControl->filesource->rewind(currfileidx);
-                node->table_filled = false;
-                node->agg_done = false;
+        for (;;) {
+            while (TempFileControl->curfile < TempFileControl->filenum) {
+                int currfileidx = TempFileControl->curfile;
+                if (TempFileControl->filesource->m_rownum[currfileidx] != 0) {
+                    TempFileControl->filesource->setCurrentIdx(currfileidx);
+                    MemoryContextResetAndDeleteChildren(node->aggcontexts[0]);
+                    build_hash_table(node);
+
+                    TempFileControl->filesource->rewind(currfileidx);
+                    TempFileControl->inmemoryRownum = 0;
+                    TempFileControl->inputRownum = 0;
+                    TempFileControl->respill = false;
+                    node->table_filled = false;
+                    node->agg_done = false;
+                    break;
+                /* no data in this temp file */
+                } else {
+                    TempFileControl->filesource->close(currfileidx);
+                    TempFileControl->curfile++;
+                }
+            }
+            if (TempFileControl->curfile < TempFileControl->filenum) {
                 break;
-            /* no data in this temp file */
-            } else {
-                TempFileControl->filesource->close(currfileidx);
-                TempFileControl->curfile++;
             }
+            if (TempFileControl->overflowsource == NULL) {
+                return false;
+            }
+
+            /* all files of this level are done, go on with the rows they respilled */
+            TempFileControl->filesource->freeFileSource();
+            TempFileControl->filesource = TempFileControl->overflowsource;
+            TempFileControl->filenum = TempFileControl->overflowFileNum;
+            TempFileControl->overflowsource = NULL;
+            TempFileControl->overflowFileNum = 0;
+            TempFileControl->spillLevel++;
+            TempFileControl->curfile = 0;
         }
-        if (TempFileControl->curfile == TempFileControl->filenum) {
-            return false;
-        }
+        TempFileControl->m_hashAggSource = TempFileControl->filesource;
     } else {
         Assert(false);
     }
@@ -1826,7 +2131,7 @@ static void agg_fill_hash_table(AggState* aggstate)
         }
     }
     /* Initialize to walk the hash table */
-    ResetTupleHashIterator(aggstate->hashtable, &aggstate->hashiter);
+    aggstate->hash_scanpos = 0;
 }
 
 /*
@@ -1857,7 +2162,7 @@ static TupleTableSlot* agg_retrieve_hash_table(AggState* aggstate)
         /*
          * Find the next entry in the hash table
          */
-        entry = (AggHashEntry)ScanTupleHashTable(&aggstate->hashiter);
+        entry = agg_hash_next(aggstate);
         if (entry == NULL) {
             /* No more entries in hashtable, so done */
             aggstate->agg_done = TRUE;
@@ -1958,6 +2263,10 @@ AggState* ExecInitAgg(Agg* node, EState* estate, int eflags)
     aggstate->pergroup = NULL;
     aggstate->grp_firstTuple = NULL;
     aggstate->hashtable = NULL;
+    aggstate->hash_slots = NULL;
+    aggstate->hash_nslots = 0;
+    aggstate->hash_nused = 0;
+    aggstate->hash_scanpos = 0;
     aggstate->sort_in = NULL;
     aggstate->sort_out = NULL;
     aggstate->is_final = node->is_final;
@@ -2559,6 +2868,11 @@ AggState* ExecInitAgg(Agg* node, EState* estate, int eflags)
     TempFilePara->m_hashAggSource = NULL;
     TempFilePara->maxMem = maxMem * 1024L;
     TempFilePara->spreadNum = 0;
+    TempFilePara->inputRownum = 0;
+    TempFilePara->respill = false;
+    TempFilePara->spillLevel = 0;
+    TempFilePara->overflowsource = NULL;
+    TempFilePara->overflowFileNum = 0;
     aggstate->aggTempFileControl = TempFilePara;
     return aggstate;
 }
@@ -2581,15 +2895,8 @@ void ExecEndAgg(AggState* node)
     int aggno, setno;
     AggWriteFileControl* TempFileControl = (AggWriteFileControl*)node->aggTempFileControl;
     int numGroupingSets = Max(node->maxsets, 1);
-    int fileNum = TempFileControl->filenum;
-    hashFileSource* file = TempFileControl->filesource;
 
-    if (file != NULL) {
-        for (int i = 0; i < fileNum; i++) {
-            file->close(i);
-        }
-        file->freeFileSource();
-    }
+    agg_close_spill_files(TempFileControl);
 
     /*
      * Clean up sort_slot first before tuplesort_end(node->sort_in)
@@ -2685,7 +2992,7 @@ void ExecReScanAgg(AggState* node)
          */
         if (node->ss.ps.lefttree->chgParam == NULL && TempFilePara->spillToDisk == false &&
             aggnode->aggParams == NULL && !EXEC_IN_RECURSIVE_MODE(node->ss.ps.plan)) {
-            ResetTupleHashIterator(node->hashtable, &node->hashiter);
+            node->hash_scanpos = 0;
             return;
         }
     }
@@ -2740,19 +3047,11 @@ void ExecReScanAgg(AggState* node)
     if (aggnode->aggstrategy == AGG_HASHED) {
         AggWriteFileControl* TempFileControl = (AggWriteFileControl*)node->aggTempFileControl;
 
-        int fileNum = TempFileControl->filenum;
         int64 workMem = SET_NODEMEM(aggnode->plan.operatorMemKB[0], aggnode->plan.dop);
         int64 maxMem =
             (aggnode->plan.operatorMaxMem > 0) ? SET_NODEMEM(aggnode->plan.operatorMaxMem, aggnode->plan.dop) : 0;
 
-        hashFileSource* file = TempFileControl->filesource;
-
-        if (file != NULL) {
-            for (int i = 0; i < fileNum; i++) {
-                file->close(i);
-            }
-            file->freeFileSource();
-        }
+        agg_close_spill_files(TempFileControl);
 
         /*
          * After close the temp file and free the filesource, setting the filesource to NULL
@@ -2778,6 +3077,9 @@ void ExecReScanAgg(AggState* node)
         TempFilePara->filenum = 0;
         TempFilePara->maxMem = maxMem * 1024L;
         TempFilePara->spreadNum = 0;
+        TempFilePara->inputRownum = 0;
+        TempFilePara->respill = false;
+        TempFilePara->spillLevel = 0;
     } else {
         /*
          * Reset the per-group state (in particular, mark transvalues null)
@@ -2947,19 +3249,12 @@ void ExecEarlyFreeAggregation(AggState* node)
     int aggno, setno;
     AggWriteFileControl* TempFileControl = (AggWriteFileControl*)node->aggTempFileControl;
     int numGroupingSets = Max(node->maxsets, 1);
-    int fileNum = TempFileControl->filenum;
-    hashFileSource* file = TempFileControl->filesource;
     PlanState* plan_state = &node->ss.ps;
 
     if (plan_state->earlyFreed)
         return;
 
-    if (file != NULL) {
-        for (int i = 0; i < fileNum; i++) {
-            file->close(i);
-        }
-        file->freeFileSource();
-    }
+    agg_close_spill_files(TempFileControl);
 
     /*
      * Clean up sort_slot first before tuplesort_end(node->sort_in)
@@ -3093,18 +3388,11 @@ void ExecReSetAgg(AggState* node)
 
     if (aggnode->aggstrategy == AGG_HASHED) {
         AggWriteFileControl* TempFileControl = (AggWriteFileControl*)node->aggTempFileControl;
-        int fileNum = TempFileControl->filenum;
         int64 workMem = SET_NODEMEM(aggnode->plan.operatorMemKB[0], aggnode->plan.dop);
         int64 maxMem =
             (aggnode->plan.operatorMaxMem > 0) ? SET_NODEMEM(aggnode->plan.operatorMaxMem, aggnode->plan.dop) : 0;
-        hashFileSource* file = TempFileControl->filesource;
 
-        if (file != NULL) {
-            for (int i = 0; i < fileNum; i++) {
-                file->close(i);
-            }
-            file->freeFileSource();
-        }
+        agg_close_spill_files(TempFileControl);
 
         /*
          * After close the temp file and free the filesource, setting the filesource to NULL
@@ -3130,6 +3418,9 @@ void ExecReSetAgg(AggState* node)
         TempFilePara->filenum = 0;
         TempFilePara->maxMem = maxMem * 1024L;
         TempFilePara->spreadNum = 0;
+        TempFilePara->inputRownum = 0;
+        TempFilePara->respill = false;
+        TempFilePara->spillLevel = 0;
     } else {
         /*
          * Reset the per-group state (in particular, mark transvalues null)
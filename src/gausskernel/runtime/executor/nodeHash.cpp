@@ -382,6 +382,17 @@ HashJoinTable ExecHashTableCreate(Hash* node, List* hashOperators, bool keepNull
         STANDARD_CONTEXT,
         local_work_mem * 1024L);
 
+    /*
+     * Standard-size tuple chunks all have the same size and are freed one by
+     * one while the batch count grows, so they live in a slab whose blocks go
+     * back to the system as soon as all their chunks have been repartitioned.
+     */
+    hashtable->chunkCxt = SlabContextCreate(hashtable->batchCxt,
+        "HashChunkContext",
+        HASH_CHUNK_SLAB_BLOCK_SIZE,
+        offsetof(HashMemoryChunkData, data) + HASH_CHUNK_SIZE);
+    ((AllocSetContext*)hashtable->chunkCxt)->maxSpaceSize = ((AllocSetContext*)hashtable->batchCxt)->maxSpaceSize;
+
     /* Allocate data that will live for the life of the hashjoin */
     oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
 
@@ -1330,7 +1341,7 @@ void ExecHashTableReset(HashJoinTable hashtable)
 
     MemoryContextSwitchTo(oldcxt);
 
-    /* Forget the chunks (the memory was freed by the context reset above). */
+    /* Forget the chunks (the memory was freed by the context reset above, chunkCxt included). */
     hashtable->chunks = NULL;
 }
 
@@ -1907,7 +1918,7 @@ static void* dense_alloc(HashJoinTable hashtable, Size size)
     if ((hashtable->chunks == NULL) || (hashtable->chunks->maxlen - hashtable->chunks->used) < size) {
         /* allocate new chunk and put it at the beginning of the list */
         newChunk = (HashMemoryChunk)MemoryContextAlloc(
-            hashtable->batchCxt, offsetof(HashMemoryChunkData, data) + HASH_CHUNK_SIZE);
+            hashtable->chunkCxt, offsetof(HashMemoryChunkData, data) + HASH_CHUNK_SIZE);
 
         newChunk->maxlen = HASH_CHUNK_SIZE;
         newChunk->used = size;
@@ -25,13 +25,23 @@
 #include "knl/knl_variable.h"
 
 #include "executor/execdebug.h"
+#include "executor/executor.h"
 #include "executor/nodePartIterator.h"
 #include "executor/tuptable.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "nodes/execnodes.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
 #include "nodes/plannodes.h"
+#include "optimizer/var.h"
+#include "parser/parsetree.h"
 #include "vecexecutor/vecnodes.h"
 
+static void init_partition_pruning(PartIteratorState* state, PartIterator* node);
+static void prune_partitions(PartIteratorState* node);
+
 /*
  * @@GaussDB@@
  * Target		: data partition
@@ -55,10 +65,128 @@ PartIteratorState* ExecInitPartIterator(PartIterator* node, EState* estate, int
     state->ps.ps_TupFromTlist = false;
     state->ps.ps_ProjInfo = NULL;
     state->currentItr = -1;
+    state->activeItrs = node->itrs;
+
+    if (node->pruningQuals != NIL) {
+        init_partition_pruning(state, node);
+    }
 
     return state;
 }
 
+/* do the quals refer to exec params, whose values may change between scans? */
+static bool pruning_exec_param_walker(Node* node, void* context)
+{
+    if (node == NULL)
+        return false;
+    if (IsA(node, Param) && ((Param*)node)->paramkind == PARAM_EXEC)
+        return true;
+    return expression_tree_walker(node, (bool (*)())pruning_exec_param_walker, context);
+}
+
+/*
+ * @@GaussDB@@
+ * Target		: data partition
+ * Brief		: set up runtime partition pruning
+ * Description	: quals on extern params only are pruned once here, those on exec params
+ *			: (nestloop params, initplan results) before every scan of the partitions
+ * Notes		: the partitions pruned are still opened and locked by the scan node
+ */
+static void init_partition_pruning(PartIteratorState* state, PartIterator* node)
+{
+    switch (nodeTag(node->plan.lefttree)) {
+        case T_SeqScan:
+        case T_IndexScan:
+        case T_IndexOnlyScan:
+        case T_BitmapHeapScan:
+        case T_TidScan:
+            break;
+        default:
+            return;
+    }
+
+    ExecAssignExprContext(state->ps.state, &state->ps);
+    state->activeItrIndexes = (int*)palloc(node->itrs * sizeof(int));
+    state->pruneOnScan = pruning_exec_param_walker((Node*)node->pruningQuals, NULL);
+    state->needPrune = true;
+
+    if (!state->pruneOnScan)
+        prune_partitions(state);
+}
+
+/*
+ * Replace the var-free parts of the pruning quals, the params and what is computed
+ * from them, with consts of their current values, so that the planner's pruning
+ * can work on the quals.
+ */
+static Node* bind_pruning_params_mutator(Node* node, PartIteratorState* state)
+{
+    if (node == NULL)
+        return NULL;
+    if (IsA(node, Const) || IsA(node, Var))
+        return node;
+    if (!IsA(node, List) && !contain_var_clause(node)) {
+        ExprState* exprstate = ExecInitExpr((Expr*)node, &state->ps);
+        Oid type = exprType(node);
+        int16 typlen;
+        bool typbyval = false;
+        bool isnull = false;
+        Datum value;
+
+        value = ExecEvalExpr(exprstate, state->ps.ps_ExprContext, &isnull, NULL);
+        get_typlenbyval(type, &typlen, &typbyval);
+        if (!isnull)
+            value = datumCopy(value, typbyval, typlen);
+
+        return (Node*)makeConst(type, exprTypmod(node), exprCollation(node), typlen, value, isnull, typbyval);
+    }
+
+    return expression_tree_mutator(node, (Node* (*)(Node*, void*))bind_pruning_params_mutator, (void*)state);
+}
+
+/*
+ * @@GaussDB@@
+ * Target		: data partition
+ * Brief		: prune the partitions to scan with the current param values
+ * Description	: keeps the iterations whose partition may hold qualifying tuples
+ * Notes		:
+ */
+static void prune_partitions(PartIteratorState* node)
+{
+    PartIterator* pi_node = (PartIterator*)node->ps.plan;
+    ScanState* scanstate = (ScanState*)node->ps.lefttree;
+    Scan* scan = (Scan*)scanstate->ps.plan;
+    ExprContext* econtext = node->ps.ps_ExprContext;
+    RangeTblEntry* rte = rt_fetch(scan->scanrelid, node->ps.state->es_range_table);
+    MemoryContext oldcontext;
+    PruningResult* result = NULL;
+    List* quals = NIL;
+    Expr* expr = NULL;
+    ListCell* cell = NULL;
+    int itr = 0;
+
+    ResetExprContext(econtext);
+    oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+    quals = (List*)bind_pruning_params_mutator((Node*)pi_node->pruningQuals, node);
+    expr = (list_length(quals) == 1) ? (Expr*)linitial(quals) : makeBoolExpr(AND_EXPR, quals, -1);
+    result = partitionPruningForExpr(NULL, rte, scanstate->ss_currentRelation, expr);
+
+    node->activeItrs = 0;
+    foreach (cell, scan->pruningInfo->ls_rangeSelectedPartitions) {
+        if (PruningResultIsFull(result) ||
+            (!PruningResultIsEmpty(result) && bms_is_member(lfirst_int(cell), result->bm_rangeSelectedPartitions)))
+            node->activeItrIndexes[node->activeItrs++] = itr;
+        itr++;
+    }
+
+    (void)MemoryContextSwitchTo(oldcontext);
+    ResetExprContext(econtext);
+
+    node->nprunedItrs += pi_node->itrs - node->activeItrs;
+    node->needPrune = false;
+}
+
 static void init_scan_partition(PartIteratorState* node)
 {
     int paramno;
@@ -72,7 +200,9 @@ static void init_scan_partition(PartIteratorState* node)
     node->currentItr++;
     itr_idx = node->currentItr;
     if (BackwardScanDirection == pi_node->direction)
-        itr_idx = pi_node->itrs - itr_idx - 1;
+        itr_idx = node->activeItrs - itr_idx - 1;
+    if (node->activeItrIndexes != NULL)
+        itr_idx = node->activeItrIndexes[itr_idx];
 
     paramno = pi_node->param->paramno;
     param = &(node->ps.state->es_param_exec_vals[paramno]);
@@ -106,8 +236,16 @@ TupleTableSlot* ExecPartIterator(PartIteratorState* node)
     }
 
     /* init first scanned partition */
-    if (node->currentItr == -1)
+    if (node->currentItr == -1) {
+        if (node->needPrune)
+            prune_partitions(node);
+
+        /* all partitions pruned at runtime */
+        if (node->activeItrs == 0)
+            return NULL;
+
         init_scan_partition(node);
+    }
 
     /* For partition wise join, can not early free left tree's caching memory */
     state->es_skip_early_free = true;
@@ -119,7 +257,7 @@ TupleTableSlot* ExecPartIterator(PartIteratorState* node)
 
     /* switch to next partition until we get a unempty tuple */
     for (;;) {
-        if (node->currentItr + 1 >= pi_node->itrs) /* have scanned all partitions */
+        if (node->currentItr + 1 >= node->activeItrs) /* have scanned all partitions */
             return NULL;
 
         /* switch to next partiiton */
@@ -145,6 +283,9 @@ TupleTableSlot* ExecPartIterator(PartIteratorState* node)
  */
 void ExecEndPartIterator(PartIteratorState* node)
 {
+    /* free the exprcontext of runtime pruning, if any */
+    ExecFreeExprContext(&node->ps);
+
     /* close down subplans */
     ExecEndNode(node->ps.lefttree);
 }
@@ -172,6 +313,10 @@ void ExecReScanPartIterator(PartIteratorState* node)
 
     node->currentItr = -1;
 
+    /* exec params may have changed, prune again on the next scan */
+    if (node->pruneOnScan)
+        node->needPrune = true;
+
     pi_node = (PartIterator*)node->ps.plan;
     paramno = pi_node->param->paramno;
     param = &(node->ps.state->es_param_exec_vals[paramno]);
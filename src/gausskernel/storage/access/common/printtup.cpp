@@ -22,6 +22,7 @@
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
@@ -39,6 +40,7 @@ extern bool StreamThreadAmI();
 static void printtup_startup(DestReceiver* self, int operation, TupleDesc typeinfo);
 static void printtup_20(TupleTableSlot* slot, DestReceiver* self);
 static void printtup_internal_20(TupleTableSlot* slot, DestReceiver* self);
+static void printColumnBatch(VectorBatch* batch, DestReceiver* self);
 static void printtup_shutdown(DestReceiver* self);
 static void printtup_destroy(DestReceiver* self);
 
@@ -409,6 +411,7 @@ DestReceiver* printtup_create_DR(CommandDest dest)
     self->nattrs = 0;
     self->myinfo = NULL;
     self->formats = NULL;
+    self->batchinfo = NULL;
 
     return (DestReceiver*)self;
 }
@@ -648,6 +651,27 @@ static void SendRowDescriptionCols_2(StringInfo buf, TupleDesc typeinfo, List* t
     }
 }
 
+/*
+ * Pick the inlined text output routine for an output function, if it has one
+ */
+static PrinttupOutKind printtup_out_kind(Oid typoutput)
+{
+    switch (typoutput) {
+        case F_INT2OUT:
+            return PRINTTUP_OUT_INT2;
+        case F_INT4OUT:
+            return PRINTTUP_OUT_INT4;
+        case F_INT8OUT:
+            return PRINTTUP_OUT_INT8;
+        case F_TEXTOUT:
+        case F_VARCHAROUT:
+        case F_BPCHAROUT:
+            return PRINTTUP_OUT_TEXT;
+        default:
+            return PRINTTUP_OUT_GENERIC;
+    }
+}
+
 /*
  * Get the lookup info that printtup() needs
  */
@@ -687,6 +711,10 @@ static void printtup_prepare_info(DR_printtup* my_state, TupleDesc typeinfo, int
         if (format == 0) {
             getTypeOutputInfo(typeinfo->attrs[i]->atttypid, &thisState->typoutput, &thisState->typisvarlena);
             fmgr_info(thisState->typoutput, &thisState->finfo);
+            /* analyze sample tuples truncate wide text values, keep them on the generic path */
+            if (!my_state->pub.forAnalyzeSampleTuple) {
+                thisState->outkind = printtup_out_kind(thisState->typoutput);
+            }
         } else if (format == 1) {
             getTypeBinaryOutputInfo(typeinfo->attrs[i]->atttypid, &thisState->typsend, &thisState->typisvarlena);
             fmgr_info(thisState->typsend, &thisState->finfo);
@@ -901,6 +929,189 @@ void printtupStream(TupleTableSlot* slot, DestReceiver* self)
     pq_endmessage_reuse(buf);
 }
 
+#define MAXINT8LEN 25
+
+/*
+ * Send one not-null attribute in text format without calling its output
+ * function.  Digits are plain ASCII in every client encoding, so integers
+ * skip the conversion pq_sendcountedtext would do.
+ */
+static inline void printtup_send_inlined(StringInfo buf, PrinttupOutKind outkind, Datum attr)
+{
+    char str[MAXINT8LEN + 1];
+    int len;
+
+    switch (outkind) {
+        case PRINTTUP_OUT_INT2:
+            pg_itoa(DatumGetInt16(attr), str);
+            break;
+        case PRINTTUP_OUT_INT4:
+            pg_ltoa(DatumGetInt32(attr), str);
+            break;
+        case PRINTTUP_OUT_INT8:
+            pg_lltoa(DatumGetInt64(attr), str);
+            break;
+        case PRINTTUP_OUT_TEXT: {
+            text* txt = (text*)DatumGetPointer(attr);
+
+            pq_sendcountedtext(buf, VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), false);
+            return;
+        }
+        default:
+            Assert(false);
+            return;
+    }
+
+    len = strlen(str);
+    pq_sendint32(buf, (uint32)len);
+    appendBinaryStringInfo(buf, str, len);
+}
+
+/*
+ * Can every column be sent in a ColumnBatch message?  Only types whose
+ * vector store holds the plain Datum or a varlena pointer qualify.  The
+ * client prints floats the way %g does, so they only qualify when the
+ * text output would not have dropped the leading zero either.
+ */
+static bool column_batch_type(Oid typid)
+{
+    switch (typid) {
+        case FLOAT4OID:
+        case FLOAT8OID:
+            return DISPLAY_LEADING_ZERO;
+        case BOOLOID:
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+        case OIDOID:
+        case TEXTOID:
+        case VARCHAROID:
+        case BPCHAROID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * printtup_use_column_batch
+ *
+ * Decide whether the batches of a vectorized plan may go to the client as
+ * ColumnBatch messages instead of being converted to DataRows, and set up
+ * the receiver for it.  The client asks for this with the
+ * columnar_result_transfer GUC.
+ */
+bool printtup_use_column_batch(DestReceiver* self, TupleDesc typeinfo)
+{
+    DR_printtup* my_state = (DR_printtup*)self;
+    int i;
+
+    if (self->receiveSlot != printtup)
+        return false;
+
+    my_state->batchinfo = NULL;
+    self->sendBatch = printBatch;
+
+    if (!u_sess->attr.attr_sql.columnar_result_transfer || PG_PROTOCOL_MAJOR(FrontendProtocol) < 3 ||
+        IsConnFromCoord() || self->forAnalyzeSampleTuple || typeinfo->natts <= 0)
+        return false;
+
+    for (i = 0; i < typeinfo->natts; i++) {
+        if (typeinfo->attrs[i]->attisdropped || !column_batch_type(typeinfo->attrs[i]->atttypid))
+            return false;
+    }
+
+    my_state->batchinfo = typeinfo;
+    self->sendBatch = printColumnBatch;
+    return true;
+}
+
+/*
+ * Append the values of one column in the binary format of the type's send
+ * function, each preceded by its length (-1 for NULL) as in a DataRow.
+ */
+static void printColumnValues(StringInfo buf, Oid typid, ScalarVector* column, int nrows)
+{
+    ScalarValue* vals = column->m_vals;
+    uint8* flags = column->m_flag;
+    int j;
+
+    for (j = 0; j < nrows; j++) {
+        if (IS_NULL(flags[j])) {
+            pq_sendint32(buf, (uint32)-1);
+            continue;
+        }
+
+        switch (typid) {
+            case BOOLOID:
+                pq_sendint32(buf, 1);
+                pq_sendbyte(buf, DatumGetBool(vals[j]) ? 1 : 0);
+                break;
+            case INT2OID:
+                pq_sendint32(buf, sizeof(int16));
+                pq_sendint16(buf, (uint16)DatumGetInt16(vals[j]));
+                break;
+            case INT4OID:
+                pq_sendint32(buf, sizeof(int32));
+                pq_sendint32(buf, (uint32)DatumGetInt32(vals[j]));
+                break;
+            case OIDOID:
+                pq_sendint32(buf, sizeof(Oid));
+                pq_sendint32(buf, DatumGetObjectId(vals[j]));
+                break;
+            case INT8OID:
+                pq_sendint32(buf, sizeof(int64));
+                pq_sendint64(buf, (uint64)DatumGetInt64(vals[j]));
+                break;
+            case FLOAT4OID:
+                pq_sendint32(buf, sizeof(float4));
+                pq_sendfloat4(buf, DatumGetFloat4(vals[j]));
+                break;
+            case FLOAT8OID:
+                pq_sendint32(buf, sizeof(float8));
+                pq_sendfloat8(buf, DatumGetFloat8(vals[j]));
+                break;
+            default: {
+                /* text, varchar and bpchar all send their text as is */
+                Datum origattr = ScalarVector::Decode(vals[j]);
+                struct varlena* txt = PG_DETOAST_DATUM_PACKED(origattr);
+
+                pq_sendcountedtext(buf, VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), false);
+                if (PointerGetDatum(txt) != origattr)
+                    pfree(txt);
+                break;
+            }
+        }
+    }
+}
+
+/* ----------------
+ *		printColumnBatch --- send a vector batch as a ColumnBatch message
+ *
+ * The message holds the column count, the row count, and then the values
+ * of the batch column by column.
+ * ----------------
+ */
+static void printColumnBatch(VectorBatch* batch, DestReceiver* self)
+{
+    DR_printtup* my_state = (DR_printtup*)self;
+    StringInfo buf = &my_state->buf;
+    TupleDesc typeinfo = my_state->batchinfo;
+    int natts = typeinfo->natts;
+
+    StreamTimeSerilizeStart(t_thrd.pgxc_cxt.GlobalNetInstr);
+
+    pq_beginmessage_reuse(buf, 'J');
+    pq_sendint16(buf, natts);
+    pq_sendint32(buf, batch->m_rows);
+    for (int i = 0; i < natts; i++)
+        printColumnValues(buf, typeinfo->attrs[i]->atttypid, &batch->m_arr[i], batch->m_rows);
+
+    StreamTimeSerilizeEnd(t_thrd.pgxc_cxt.GlobalNetInstr);
+    pq_endmessage_reuse(buf);
+    u_sess->libpq_cxt.column_batches_sent++;
+}
+
 /* ----------------
  *		printtup --- print a tuple in protocol 3.0
  * ----------------
@@ -996,7 +1207,10 @@ void printtup(TupleTableSlot* slot, DestReceiver* self)
             else
                 attr = origattr;
 
-            if (this_state->format == 0) {
+            if (this_state->outkind != PRINTTUP_OUT_GENERIC) {
+                /* Text output of a common type, written straight into the message */
+                printtup_send_inlined(buf, this_state->outkind, attr);
+            } else if (this_state->format == 0) {
                 /* Text output */
                 char* outputstr = NULL;
 
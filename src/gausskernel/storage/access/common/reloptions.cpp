@@ -21,12 +21,14 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/spgist.h"
+#include "access/tuptoaster.h"
 #include "catalog/pg_ts_parser.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
 #include "commands/tablespace.h"
 #include "nodes/makefuncs.h"
 #include "pgxc/redistrib.h"
+#include "storage/page_compression.h"
 #include "tsearch/ts_public.h"
 #include "utils/array.h"
 #include "utils/attoptcache.h"
@@ -56,6 +58,7 @@
 /* value check functions for reloptions */
 static void ValidateStrOptOrientation(const char* val);
 static void ValidateStrOptCompression(const char* val);
+static void ValidateStrOptToastCompression(const char* val);
 static void  ValidateStrOptTTL(const char *val);
 static void  ValidateStrOptPeriod(const char *val);
 static void ValidateStrOptVersion(const char* val);
@@ -177,6 +180,16 @@ static relopt_int intRelOpts[] = {{{"fillfactor", "Packs table pages only to thi
 
     {{"rel_cn_oid", "rel oid on coordinator", RELOPT_KIND_HEAP}, 0, 0, 2000000000},
 
+    /* page compression of row relations and btree indexes */
+    {{"compresstype", "Page compression algorithm: 0 none, 1 pglz, 2 lz4", RELOPT_KIND_HEAP | RELOPT_KIND_BTREE},
+        PAGE_COMPRESS_NONE,
+        PAGE_COMPRESS_NONE,
+        PAGE_COMPRESS_MAX_ALGORITHM},
+    {{"compress_chunk_size", "Size of the chunks compressed pages are stored in", RELOPT_KIND_HEAP | RELOPT_KIND_BTREE},
+        PAGE_COMPRESS_DEFAULT_CHUNK_SIZE,
+        PAGE_COMPRESS_MIN_CHUNK_SIZE,
+        PAGE_COMPRESS_MAX_CHUNK_SIZE},
+
     /* list terminator */
     {{NULL}}};
 
@@ -246,6 +259,11 @@ static relopt_real real_rel_opts[] = {
 
 static relopt_string string_rel_opts[] = {
     {{"split_flag", "split flag for pound text search praser.", RELOPT_KIND_PPARSER}, 2, false, NULL, "#"},
+    {{"toast_compression", "Compression method of the column values, pglz or lz4", RELOPT_KIND_ATTRIBUTE},
+        0,
+        true,
+        ValidateStrOptToastCompression,
+        NULL},
     {{"buffering", "Enables buffering build for this GiST index", RELOPT_KIND_GIST},
         4,
         false,
@@ -1373,7 +1391,9 @@ void ForbidToSetOptionsForColTbl(List* options)
         "autovacuum_freeze_max_age",
         "autovacuum_freeze_table_age",
         "autovacuum_vacuum_scale_factor",
-        "security_barrier"};
+        "security_barrier",
+        "compresstype",
+        "compress_chunk_size"};
 
     ForbidUserToSetUnsupportedOptions(options, unsupported, lengthof(unsupported), "column/timeseries relation");
 }
@@ -1426,7 +1446,9 @@ void ForbidToSetOptionsForPSort(List* options)
         "autovacuum_vacuum_scale_factor",
         "autovacuum_analyze_scale_factor",
         "security_barrier",
-        "compression"};
+        "compression",
+        "compresstype",
+        "compress_chunk_size"};
 
     ForbidUserToSetUnsupportedOptions(options, unsupported, lengthof(unsupported), "psort index");
 }
@@ -1490,7 +1512,9 @@ bytea* default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
         {"start_ctid_internal", RELOPT_TYPE_STRING, offsetof(StdRdOptions, start_ctid_internal)},
         {"end_ctid_internal", RELOPT_TYPE_STRING, offsetof(StdRdOptions, end_ctid_internal)},
         {"user_catalog_table", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, user_catalog_table)},
-        {"hashbucket", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, hashbucket)}};
+        {"hashbucket", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, hashbucket)},
+        {"compresstype", RELOPT_TYPE_INT, offsetof(StdRdOptions, compresstype)},
+        {"compress_chunk_size", RELOPT_TYPE_INT, offsetof(StdRdOptions, compress_chunk_size)}};
 
     options = parseRelOptions(reloptions, validate, kind, &numoptions);
 
@@ -1502,6 +1526,11 @@ bytea* default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 
     fillRelOptions((void*)rdopts, sizeof(StdRdOptions), options, numoptions, validate, tab, lengthof(tab));
 
+    /* chunks must divide a page evenly */
+    if (validate && rdopts->compresstype != PAGE_COMPRESS_NONE) {
+        PageCompressCheckOptions(rdopts->compresstype, rdopts->compress_chunk_size);
+    }
+
     for (int i = 0; i < numoptions; i++) {
         if (options[i].gen->type == RELOPT_TYPE_STRING && options[i].isset)
             pfree(options[i].values.string_val);
@@ -1596,7 +1625,8 @@ bytea* attribute_reloptions(Datum reloptions, bool validate)
     AttributeOpts* aopts = NULL;
     int numoptions;
     static const relopt_parse_elt tab[] = {{"n_distinct", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct)},
-        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)}};
+        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)},
+        {"toast_compression", RELOPT_TYPE_STRING, offsetof(AttributeOpts, toast_compression)}};
 
     options = parseRelOptions(reloptions, validate, RELOPT_KIND_ATTRIBUTE, &numoptions);
 
@@ -1608,6 +1638,10 @@ bytea* attribute_reloptions(Datum reloptions, bool validate)
 
     fillRelOptions((void*)aopts, sizeof(AttributeOpts), options, numoptions, validate, tab, lengthof(tab));
 
+    for (int i = 0; i < numoptions; i++) {
+        if (options[i].gen->type == RELOPT_TYPE_STRING && options[i].isset)
+            pfree(options[i].values.string_val);
+    }
     pfree(options);
 
     return (bytea*)aopts;
@@ -1772,6 +1806,15 @@ static void ValidateStrOptCompression(const char* val)
                           "\"lz4\" for dfs table.")));
 }
 
+static void ValidateStrOptToastCompression(const char* val)
+{
+    if (toast_compression_name_to_id(val) == TOAST_INVALID_COMPRESSION_ID)
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("Invalid string for \"TOAST_COMPRESSION\" option."),
+                errdetail("Valid string are \"pglz\", \"lz4\".")));
+}
+
 /*
  * Brief        : Check the filesystem option for tablespace.
  * Input        : val, the filesystem option value.
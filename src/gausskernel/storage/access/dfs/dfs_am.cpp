@@ -466,6 +466,13 @@ private:
 
     /* Flag indicates whether we need to read system columns. */
     bool skipSysCol;
+
+    /*
+     * Flag indicates whether the SMP workers may share a file and split it by
+     * stripe/row group, only done for the ORC/Parquet files on the local file
+     * system.
+     */
+    bool splitInFile;
 };
 
 ReaderImpl::ReaderImpl(ReaderState *_readerState, bool _skipSysCol, int _transactionLevel)
@@ -487,7 +494,8 @@ ReaderImpl::ReaderImpl(ReaderState *_readerState, bool _skipSysCol, int _transac
       fileOffset(NULL),
       noRequireCol(true),
       isForeignTable(false),
-      skipSysCol(_skipSysCol)
+      skipSysCol(_skipSysCol),
+      splitInFile(false)
 {
 }
 
@@ -543,6 +551,11 @@ void ReaderImpl::begin(dfs::DFSConnector *conn, FileType type)
 {
     setRequired();
     setEncoding();
+    /*
+     * Only the ORC and Parquet readers skip the stripes/row groups of other
+     * SMP workers, text and csv files are always read whole by one worker.
+     */
+    splitInFile = (conn != NULL && conn->getType() == LOCAL_CONNECTOR && (type == ORC || type == PARQUET));
 
     /* notice:  readerState should init ready before create file reader */
     switch (type) {
@@ -865,6 +878,18 @@ void ReaderImpl::dynamicAssignSplits()
     ListCell *lc3 = NULL;
     int count = 0;
 
+    /*
+     * When there are fewer files than SMP workers, the file level split leaves
+     * some workers idle, so every worker keeps all the files and reads only
+     * its share of the stripes/row groups of each one.
+     */
+    bool splitByStripe = splitInFile && u_sess->stream_cxt.producer_dop > 1 &&
+                         list_length(splits) < u_sess->stream_cxt.producer_dop;
+    if (splitByStripe) {
+        readerState->stripeDop = (uint32_t)u_sess->stream_cxt.producer_dop;
+        readerState->stripeSmpId = (uint32_t)u_sess->stream_cxt.smp_id;
+    }
+
     foreach (lc1, splits) {
         bool skip = false;
         SplitInfo *sp = (SplitInfo *)lfirst(lc1);
@@ -882,7 +907,7 @@ void ReaderImpl::dynamicAssignSplits()
 
         if (skip) {
             readerState->splitList = list_delete(readerState->splitList, sp);
-        } else if (u_sess->stream_cxt.producer_dop > 1) {
+        } else if (u_sess->stream_cxt.producer_dop > 1 && !splitByStripe) {
             /* split again for SMP */
             if ((count % u_sess->stream_cxt.producer_dop) != u_sess->stream_cxt.smp_id) {
                 readerState->splitList = list_delete(readerState->splitList, sp);
@@ -24,6 +24,7 @@
 #include <sstream>
 
 #include "orc/OrcObsFile.h"
+#include "orc/OrcLocalFile.h"
 
 #include "access/dfs/dfs_stream_factory.h"
 
@@ -62,6 +63,10 @@ DFS_UNIQUE_PTR<dfs::GSInputStream> InputStreamFactory(dfs::DFSConnector *conn, c
         } else {
             return dfs::readObsFile(static_cast<OBSReadWriteHandler *>(conn->getHandler()), path, readerState);
         }
+    } else if (LOCAL_CONNECTOR == connect_type) {
+        /* The local files are mapped, so the page cache already plays the role of the orc cache. */
+        Assert(FOREIGNTABLEFILEID == readerState->currentFileID);
+        return dfs::readLocalFile(path, readerState);
     } else {
         ereport(ERROR, (errcode(ERRCODE_FDW_UNABLE_TO_ESTABLISH_CONNECTION), errmodule(MOD_ORC),
                         errmsg("unsupport connector type %d", connect_type)));
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * OrcLocalFile.cpp
+ *
+ *
+ * IDENTIFICATION
+ *         src/gausskernel/storage/access/dfs/orc/OrcLocalFile.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Becareful: liborc header file must before  postgres header file */
+#include "orc_rw.h"
+#include "orc/Adaptor.hh"
+#include "orc/Exceptions.hh"
+#include "OrcLocalFile.h"
+#include "pgstat.h"
+
+/* Becareful: using throw exception instead of ereport ERROR in this file */
+namespace dfs {
+/*
+ * The mapping of a local file. It is shared by the copies of the stream
+ * (one per column reader) and unmapped when the last of them goes away.
+ */
+class LocalFileMapping {
+public:
+    LocalFileMapping(const char *addr, uint64_t length) : m_addr(addr), m_length(length)
+    {
+    }
+
+    ~LocalFileMapping()
+    {
+        if (m_addr != NULL) {
+            (void)munmap((void *)m_addr, m_length);
+        }
+    }
+
+    const char *m_addr;
+    uint64_t m_length;
+};
+
+class LocalFileInputStream : public GSInputStream {
+public:
+    explicit LocalFileInputStream(dfs::reader::ReaderState *_readerState)
+        : m_filename(""), m_totalLength(0), m_readCalls(0), readerState(_readerState)
+    {
+    }
+
+    ~LocalFileInputStream()
+    {
+    }
+
+    /*
+     * @Description: copy local file input stream
+     * @Return: copy of this object, the mapping is shared with the copy
+     */
+    DFS_UNIQUE_PTR<GSInputStream> copy()
+    {
+        return DFS_UNIQUE_PTR<GSInputStream>(new LocalFileInputStream(*this));
+    }
+
+    /*
+     * @Description: map the whole file read only. The descriptor is closed as
+     *      soon as the mapping exists, so a scan holds no descriptor per file.
+     * @IN path: the absolute file path
+     */
+    void init(const std::string &path)
+    {
+        struct stat st;
+        int fd = open(path.c_str(), O_RDONLY, 0);
+
+        m_filename = path;
+
+        if (fd < 0) {
+            orc::orclog(orc::ORC_ERROR, orc::PARSEERROR, "could not open file \"%s\": %s", path.c_str(),
+                        strerror(errno));
+        }
+
+        if (fstat(fd, &st) != 0) {
+            int save_errno = errno;
+            (void)close(fd);
+            orc::orclog(orc::ORC_ERROR, orc::PARSEERROR, "could not stat file \"%s\": %s", path.c_str(),
+                        strerror(save_errno));
+        }
+
+        /* mmap refuses empty ranges, and the scheduler never hands out empty files */
+        if (st.st_size == 0) {
+            (void)close(fd);
+            orc::orclog(orc::ORC_ERROR, orc::PARSEERROR, "file size is 0, path = %s", path.c_str());
+        }
+
+        void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        int save_errno = errno;
+        (void)close(fd);
+
+        if (addr == MAP_FAILED) {
+            orc::orclog(orc::ORC_ERROR, orc::PARSEERROR, "could not map file \"%s\": %s", path.c_str(),
+                        strerror(save_errno));
+        }
+
+        m_totalLength = (uint64_t)st.st_size;
+        m_mapping = std::make_shared<LocalFileMapping>(static_cast<const char *>(addr), m_totalLength);
+
+        ereport(DEBUG1, (errmodule(MOD_DFS),
+                         errmsg("initialize local InputStream, path is %s, size is %lu", path.c_str(), m_totalLength)));
+    }
+
+    uint64_t getLength() const
+    {
+        return m_totalLength;
+    }
+
+    uint64_t getNaturalReadSize() const override
+    {
+        return NATURAL_READ_SIZE;
+    }
+
+    /*
+     * @Description: copy a range of the mapping into the buffer, for the
+     *      readers which need their own copy of the data (orc).
+     */
+    void read(void *buf, uint64_t length, uint64_t offset) override
+    {
+        const char *data = static_cast<const char *>(getData(length, offset));
+        errno_t rc = memcpy_s(buf, length, data, length);
+        securec_check(rc, "\0", "\0");
+    }
+
+    /*
+     * @Description: return the range of the mapping in place. The pages are
+     *      faulted in by the reader itself, the advice only lets the kernel
+     *      start the reads ahead of it.
+     */
+    const void *getData(uint64_t length, uint64_t offset) override
+    {
+        if (offset > m_totalLength || length > m_totalLength - offset) {
+            orc::orclog(orc::ORC_ERROR, orc::PARSEERROR,
+                        "read local file \"%s\" out of range, offset = %lu request = %lu, size = %lu",
+                        m_filename.c_str(), offset, length, m_totalLength);
+        }
+
+        const char *data = m_mapping->m_addr + offset;
+        uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+        char *start = (char *)((uintptr_t)data & ~pageMask);
+        (void)madvise(start, (size_t)(data + length - start), MADV_WILLNEED);
+
+        ++m_readCalls;
+        readerState->orcDataLoadBlockCount++;
+        readerState->orcDataLoadBlockSize += length;
+
+        return data;
+    }
+
+    const std::string &getName() const override
+    {
+        return m_filename;
+    }
+
+    /* all the reads of a local file are local reads */
+    void getStat(uint64_t *localBlock, uint64_t *remoteBlock, uint64_t *nnCalls, uint64_t *dnCalls)
+    {
+        *localBlock = m_readCalls;
+        *remoteBlock = 0;
+    }
+
+    void getLocalRemoteReadCnt(uint64_t *localReadCnt, uint64_t *remoteReadCnt)
+    {
+        *localReadCnt = m_readCalls;
+        *remoteReadCnt = 0;
+    }
+
+protected:
+    LocalFileInputStream(const LocalFileInputStream &other) : GSInputStream(other)
+    {
+        m_filename = other.m_filename;
+        m_totalLength = other.m_totalLength;
+        m_mapping = other.m_mapping;
+        readerState = other.readerState;
+
+        /* performance counter set to zero */
+        m_readCalls = 0;
+    }
+
+private:
+    std::string m_filename;
+    uint64_t m_totalLength;
+    std::shared_ptr<LocalFileMapping> m_mapping;
+    const static uint64_t NATURAL_READ_SIZE = 1024 * 1024;
+
+    /* performance counter */
+    uint64_t m_readCalls;
+    dfs::reader::ReaderState *readerState;
+};
+
+DFS_UNIQUE_PTR<GSInputStream> readLocalFile(const std::string &path, dfs::reader::ReaderState *readerState)
+{
+    LocalFileInputStream *inputstream = new LocalFileInputStream(readerState);
+    inputstream->init(path);
+    return DFS_UNIQUE_PTR<GSInputStream>(inputstream);
+}
+}  // namespace dfs
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * OrcLocalFile.h
+ *
+ * IDENTIFICATION
+ *    src/gausskernel/storage/access/dfs/orc/OrcLocalFile.h
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#ifndef ORCLOCALFILE_H
+#define ORCLOCALFILE_H
+
+#include <string>
+
+#include "access/dfs/dfs_am.h"
+#include "access/dfs/dfs_stream.h"
+
+namespace dfs {
+/**
+ * Create a input stream for the given file on the local file system. The
+ * file is mapped into memory, so the readers which support it can use the
+ * column chunks in place through GSInputStream::getData.
+ * @param path: the absolute file path.
+ * @param readerState: the state of reading which includes all the state variables.
+ * @return the input stream
+ */
+DFS_UNIQUE_PTR<GSInputStream> readLocalFile(const std::string &path, dfs::reader::ReaderState *readerState);
+
+}  // namespace dfs
+#endif
@@ -1194,6 +1194,12 @@ bool OrcReaderImpl::tryStripeSkip(uint64_t &rowsSkip, uint64_t &rowsCross)
         numberOfStrides = (rowsInCurrentStripe + (rowsInStride - 1)) / rowsInStride;
         Assert(numberOfStrides > 0);
 
+        /* The stripe belongs to another SMP worker sharing this file. */
+        if (readerState->stripeDop > 1 && currentStripeIdx % readerState->stripeDop != readerState->stripeSmpId) {
+            skipCurrentStripe(rowsSkip, rowsCross);
+            return true;
+        }
+
         if (hasRestriction() && !checkPredicateOnCurrentStripe()) {
             skipCurrentStripe(rowsSkip, rowsCross);
             return true;
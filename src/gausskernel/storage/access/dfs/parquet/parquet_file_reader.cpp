@@ -212,6 +212,13 @@ void ParquetFileReader::createRowGroupReaderWhenNecessary()
 bool ParquetFileReader::tryToSkipCurrentRowGroup(uint64_t &rowsSkip, uint64_t &rowsCross)
 {
     if (isStartOfCurrentRowGroup()) {
+        /* The row group belongs to another SMP worker sharing this file. */
+        if (m_readerState->stripeDop > 1 &&
+            m_currentRowGroupIndex % m_readerState->stripeDop != m_readerState->stripeSmpId) {
+            skipCurrentRowGroup(rowsSkip, rowsCross);
+            return true;
+        }
+
         if (hasRestriction() && !checkPredicateOnCurrentRowGroup()) {
             skipCurrentRowGroup(rowsSkip, rowsCross);
             return true;
@@ -56,6 +56,12 @@ int64_t ParquetInputStreamAdapter::Read(int64_t nBytes, uint8_t *out)
 
 std::shared_ptr<Buffer> ParquetInputStreamAdapter::Read(int64_t nBytes)
 {
+    std::shared_ptr<Buffer> mapped = ReadInPlace(m_offset, nBytes);
+    if (mapped != nullptr) {
+        m_offset += nBytes;
+        return mapped;
+    }
+
     allocateBuffer(nBytes);
     int64_t nBytesRead = Read(nBytes, m_buffer);
     zeroPadding(nBytesRead);
@@ -64,6 +70,12 @@ std::shared_ptr<Buffer> ParquetInputStreamAdapter::Read(int64_t nBytes)
 
 std::shared_ptr<Buffer> ParquetInputStreamAdapter::ReadAt(int64_t position, int64_t nBytes)
 {
+    std::shared_ptr<Buffer> mapped = ReadInPlace(position, nBytes);
+    if (mapped != nullptr) {
+        m_offset = (uint64_t)(position + nBytes);
+        return mapped;
+    }
+
     allocateBuffer(nBytes);
     int64_t nBytesRead = ReadAt(position, nBytes, m_buffer);
     zeroPadding(nBytesRead);
@@ -77,6 +89,21 @@ int64_t ParquetInputStreamAdapter::ReadAt(int64_t position, int64_t nBytes, uint
     return nBytes;
 }
 
+/*
+ * Wrap the data of the stream itself when it can hand it out (a mapped local
+ * file), so the column chunks are decoded without being copied first. The
+ * stream lives as long as the reader, and so does the returned buffer.
+ */
+std::shared_ptr<Buffer> ParquetInputStreamAdapter::ReadInPlace(int64_t position, int64_t nBytes)
+{
+    const void *data = m_gsInputStream->getData((uint64_t)nBytes, (uint64_t)position);
+    if (data == NULL) {
+        return nullptr;
+    }
+
+    return arrow::Buffer::Wrap(static_cast<const uint8_t *>(data), nBytes);
+}
+
 void ParquetInputStreamAdapter::Close()
 {
 }
@@ -54,6 +54,7 @@ public:
     int64_t Tell() override;
 
 private:
+    std::shared_ptr<Buffer> ReadInPlace(int64_t position, int64_t nBytes);
     void allocateBuffer(int64_t nBytes);
     void releaseBuffer();
     void zeroPadding(int64_t nBytes) const;
@@ -135,6 +135,7 @@
 #include "commands/tablespace.h"
 #include "utils/builtins.h"
 #include "storage/procarray.h"
+#include "workload/ioschdl.h"
 
 /* Max tuple number && size of one batch tuples */
 const int DEFAULTBUFFEREDTUPLES = 10000;
@@ -1058,6 +1059,8 @@ void rewrite_page_list_write(RewriteState state)
  */
 static void rewrite_flush_page(RewriteState state, Page page)
 {
+    IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, 1);
+
     /* check aio is ready, for init db in single mode, no aio thread */
     if (AioCompltrIsReady() && g_instance.attr.attr_storage.enable_adio_function) {
         /* pass null buffer to lower levels to use fallocate, systables do not use fallocate,
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * toastcache.cpp
+ *        Shared cache of detoasted values.
+ *
+ * Reading a large out-of-line value means an index scan of the toast
+ * relation and, for a compressed value, a decompression of the whole of
+ * it.  Values read over and over (a large document returned by every
+ * query, a slice of it extracted by each row of a join) are kept here in
+ * their detoasted form, keyed by the relfilenode of the toast relation and
+ * the value OID.
+ *
+ * A toast value never changes once it is written: an update writes a new
+ * value with a new OID.  So an entry only goes stale when its value is
+ * deleted and the OID handed out again, which toast_save_datum and
+ * toast_delete_datum take care of, or when the toast relation loses its
+ * storage, which smgr takes care of.  The raw size recorded in the toast
+ * pointer is checked on every hit as a last line of defence.
+ *
+ * The hash table is split in NUM_TOAST_CACHE_PARTITIONS partitions, each
+ * with its own lock, memory context and LRU list, and each gets an equal
+ * share of toast_cache_size.  Eviction is second-chance: a hit only sets
+ * the referenced flag of the entry under the shared lock, and the insert
+ * which needs room skips the referenced entries once before evicting them.
+ * Each partition also lists its entries by relfilenode, so that dropping
+ * the values of a toast relation does not walk the LRU lists.
+ *
+ * The cache is not used during recovery, the standby does not see the
+ * deletions of the primary and could hand out a stale value for a reused
+ * OID.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/access/heap/toastcache.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/tuptoaster.h"
+#include "access/xlog.h"
+#include "lib/ilist.h"
+#include "storage/lwlock.h"
+#include "utils/atomic.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+typedef struct ToastCacheKey {
+    RelFileNode rnode; /* relfilenode of the toast relation */
+    Oid valueid;       /* OID of the value in the toast relation */
+} ToastCacheKey;
+
+typedef struct ToastCacheEntry {
+    ToastCacheKey key;   /* hash key, must be first */
+    dlist_node lru;      /* position in the LRU list of the partition */
+    dlist_node rel_link; /* position in the list of its ToastCacheRel */
+    struct varlena* value;
+    bool referenced;     /* hit since the last eviction pass */
+} ToastCacheEntry;
+
+/* the entries of one relfilenode in a partition */
+typedef struct ToastCacheRel {
+    RelFileNode rnode; /* hash key, must be first */
+    dlist_head values;
+} ToastCacheRel;
+
+typedef struct ToastCachePartition {
+    MemoryContext context; /* holds the values of the partition */
+    dlist_head lru;        /* least recently inserted first */
+    HTAB* rels;            /* ToastCacheRel of the relfilenodes with entries here */
+    Size used;             /* bytes of the values of the partition */
+} ToastCachePartition;
+
+typedef struct ToastCacheShared {
+    HTAB* hash;
+    pg_atomic_uint32 nentries; /* entries in all partitions */
+    ToastCachePartition partitions[NUM_TOAST_CACHE_PARTITIONS];
+} ToastCacheShared;
+
+#define TOAST_CACHE_INIT_SIZE 1024
+#define TOAST_CACHE_INIT_RELS 64
+
+#define ToastCachePartitionIndex(hashcode) ((hashcode) % NUM_TOAST_CACHE_PARTITIONS)
+#define ToastCachePartitionLock(i) (&t_thrd.shemem_ptr_cxt.mainLWLockArray[FirstToastCacheLock + (i)].lock)
+
+/* budget of one partition, in bytes */
+static inline Size ToastCachePartitionBudget(void)
+{
+    return ((Size)u_sess->attr.attr_storage.toast_cache_size * 1024L) / NUM_TOAST_CACHE_PARTITIONS;
+}
+
+static inline void ToastCacheInitKey(ToastCacheKey* key, const RelFileNode* rnode, Oid valueid)
+{
+    errno_t rc = memset_s(key, sizeof(ToastCacheKey), 0, sizeof(ToastCacheKey));
+    securec_check(rc, "\0", "\0");
+    key->rnode = *rnode;
+    key->valueid = valueid;
+}
+
+/*
+ * Remove the entry from the partition, the caller holds its lock exclusively.
+ * The ToastCacheRel of the entry goes too once it has no entries left,
+ * unless the caller is emptying it and removes it itself.
+ */
+static void ToastCacheRemoveEntry(ToastCacheShared* cache, ToastCachePartition* part, ToastCacheEntry* entry,
+    uint32 hashcode, bool keepRel)
+{
+    part->used -= VARSIZE(entry->value);
+    pfree(entry->value);
+    dlist_delete(&entry->lru);
+    dlist_delete(&entry->rel_link);
+    if (!keepRel) {
+        ToastCacheRel* rel = (ToastCacheRel*)hash_search(part->rels, &entry->key.rnode, HASH_FIND, NULL);
+
+        if (rel != NULL && dlist_is_empty(&rel->values)) {
+            (void)hash_search(part->rels, &entry->key.rnode, HASH_REMOVE, NULL);
+        }
+    }
+    (void)hash_search_with_hash_value(cache->hash, &entry->key, hashcode, HASH_REMOVE, NULL);
+    (void)pg_atomic_fetch_sub_u32(&cache->nentries, 1);
+}
+
+void ToastCacheInit(void)
+{
+    ToastCacheShared* cache = NULL;
+    HASHCTL ctl;
+    errno_t rc;
+
+    cache = (ToastCacheShared*)MemoryContextAllocZero(g_instance.cache_cxt.global_cache_mem,
+                                                      sizeof(ToastCacheShared));
+
+    rc = memset_s(&ctl, sizeof(ctl), 0, sizeof(ctl));
+    securec_check(rc, "\0", "\0");
+    ctl.hcxt = g_instance.cache_cxt.global_cache_mem;
+    ctl.keysize = sizeof(ToastCacheKey);
+    ctl.entrysize = sizeof(ToastCacheEntry);
+    ctl.hash = tag_hash;
+    ctl.num_partitions = NUM_TOAST_CACHE_PARTITIONS;
+    cache->hash = hash_create("Toast Cache", TOAST_CACHE_INIT_SIZE, &ctl,
+                              HASH_ELEM | HASH_FUNCTION | HASH_PARTITION | HASH_SHRCTX);
+    pg_atomic_init_u32(&cache->nentries, 0);
+
+    rc = memset_s(&ctl, sizeof(ctl), 0, sizeof(ctl));
+    securec_check(rc, "\0", "\0");
+    ctl.hcxt = g_instance.cache_cxt.global_cache_mem;
+    ctl.keysize = sizeof(RelFileNode);
+    ctl.entrysize = sizeof(ToastCacheRel);
+    ctl.hash = tag_hash;
+
+    for (int i = 0; i < NUM_TOAST_CACHE_PARTITIONS; i++) {
+        /* one context per partition so that the partitions do not contend for memory */
+        cache->partitions[i].context = AllocSetContextCreate(g_instance.cache_cxt.global_cache_mem,
+                                                             "ToastCachePartition",
+                                                             ALLOCSET_DEFAULT_MINSIZE,
+                                                             ALLOCSET_DEFAULT_INITSIZE,
+                                                             ALLOCSET_DEFAULT_MAXSIZE,
+                                                             SHARED_CONTEXT);
+        dlist_init(&cache->partitions[i].lru);
+        /* protected by the partition lock like the rest of the partition */
+        cache->partitions[i].rels = hash_create("Toast Cache Relations", TOAST_CACHE_INIT_RELS, &ctl,
+                                                HASH_ELEM | HASH_FUNCTION | HASH_SHRCTX);
+        cache->partitions[i].used = 0;
+    }
+
+    g_instance.cache_cxt.toast_cache = cache;
+}
+
+/*
+ * Is a value of this raw size worth caching?  A value larger than a quarter
+ * of a partition would flush most of it.
+ */
+bool ToastCacheEnabled(int32 rawsize)
+{
+    Size budget;
+
+    if (g_instance.cache_cxt.toast_cache == NULL || u_sess->attr.attr_storage.toast_cache_size <= 0) {
+        return false;
+    }
+    if (RecoveryInProgress()) {
+        return false;
+    }
+
+    budget = ToastCachePartitionBudget();
+    return (Size)rawsize <= budget / 4;
+}
+
+/*
+ * Return a palloc'd copy of the cached value, or NULL if the value is not
+ * cached.  rawsize is the va_rawsize of the toast pointer.
+ */
+struct varlena* ToastCacheLookup(const RelFileNode* rnode, Oid valueid, int32 rawsize)
+{
+    ToastCacheShared* cache = g_instance.cache_cxt.toast_cache;
+    ToastCacheEntry* entry = NULL;
+    struct varlena* result = NULL;
+    ToastCacheKey key;
+    uint32 hashcode;
+    int partid;
+
+    ToastCacheInitKey(&key, rnode, valueid);
+    hashcode = get_hash_value(cache->hash, &key);
+    partid = ToastCachePartitionIndex(hashcode);
+
+    (void)LWLockAcquire(ToastCachePartitionLock(partid), LW_SHARED);
+    entry = (ToastCacheEntry*)hash_search_with_hash_value(cache->hash, &key, hashcode, HASH_FIND, NULL);
+    if (entry != NULL && VARSIZE(entry->value) == (Size)rawsize) {
+        Size size = VARSIZE(entry->value);
+
+        result = (struct varlena*)palloc(size);
+        errno_t rc = memcpy_s(result, size, entry->value, size);
+        securec_check(rc, "\0", "\0");
+
+        /* racing readers all set it to true, no need for the exclusive lock */
+        entry->referenced = true;
+    }
+    LWLockRelease(ToastCachePartitionLock(partid));
+
+    return result;
+}
+
+/*
+ * Remember the detoasted value, evicting other values of the partition
+ * until it fits.
+ */
+void ToastCacheInsert(const RelFileNode* rnode, Oid valueid, const struct varlena* value)
+{
+    ToastCacheShared* cache = g_instance.cache_cxt.toast_cache;
+    ToastCachePartition* part = NULL;
+    ToastCacheEntry* entry = NULL;
+    ToastCacheRel* rel = NULL;
+    Size size = VARSIZE(value);
+    Size budget = ToastCachePartitionBudget();
+    ToastCacheKey key;
+    uint32 hashcode;
+    bool found = false;
+    int partid;
+
+    if (size > budget) {
+        return;
+    }
+
+    ToastCacheInitKey(&key, rnode, valueid);
+    hashcode = get_hash_value(cache->hash, &key);
+    partid = ToastCachePartitionIndex(hashcode);
+    part = &cache->partitions[partid];
+
+    (void)LWLockAcquire(ToastCachePartitionLock(partid), LW_EXCLUSIVE);
+
+    /* another backend read the same value meanwhile */
+    entry = (ToastCacheEntry*)hash_search_with_hash_value(cache->hash, &key, hashcode, HASH_FIND, NULL);
+    if (entry != NULL) {
+        LWLockRelease(ToastCachePartitionLock(partid));
+        return;
+    }
+
+    /* second-chance eviction, a referenced entry goes back to the tail once */
+    while (part->used + size > budget && !dlist_is_empty(&part->lru)) {
+        ToastCacheEntry* victim = dlist_head_element(ToastCacheEntry, lru, &part->lru);
+
+        if (victim->referenced) {
+            victim->referenced = false;
+            dlist_delete(&victim->lru);
+            dlist_push_tail(&part->lru, &victim->lru);
+            continue;
+        }
+        ToastCacheRemoveEntry(cache, part, victim, get_hash_value(cache->hash, &victim->key), false);
+    }
+
+    rel = (ToastCacheRel*)hash_search(part->rels, &key.rnode, HASH_ENTER_NULL, &found);
+    if (rel == NULL) {
+        LWLockRelease(ToastCachePartitionLock(partid));
+        return;
+    }
+    if (!found) {
+        dlist_init(&rel->values);
+    }
+
+    entry = (ToastCacheEntry*)hash_search_with_hash_value(cache->hash, &key, hashcode, HASH_ENTER_NULL, &found);
+    if (entry != NULL) {
+        Assert(!found);
+        entry->value = (struct varlena*)MemoryContextAlloc(part->context, size);
+        errno_t rc = memcpy_s(entry->value, size, value, size);
+        securec_check(rc, "\0", "\0");
+        entry->referenced = false;
+        dlist_push_tail(&part->lru, &entry->lru);
+        dlist_push_tail(&rel->values, &entry->rel_link);
+        part->used += size;
+        (void)pg_atomic_fetch_add_u32(&cache->nentries, 1);
+    } else if (dlist_is_empty(&rel->values)) {
+        (void)hash_search(part->rels, &key.rnode, HASH_REMOVE, NULL);
+    }
+
+    LWLockRelease(ToastCachePartitionLock(partid));
+}
+
+/* Drop the cached copy of one value, if any. */
+void ToastCacheForget(const RelFileNode* rnode, Oid valueid)
+{
+    ToastCacheShared* cache = g_instance.cache_cxt.toast_cache;
+    ToastCacheEntry* entry = NULL;
+    ToastCacheKey key;
+    uint32 hashcode;
+    int partid;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    ToastCacheInitKey(&key, rnode, valueid);
+    hashcode = get_hash_value(cache->hash, &key);
+    partid = ToastCachePartitionIndex(hashcode);
+
+    (void)LWLockAcquire(ToastCachePartitionLock(partid), LW_EXCLUSIVE);
+    entry = (ToastCacheEntry*)hash_search_with_hash_value(cache->hash, &key, hashcode, HASH_FIND, NULL);
+    if (entry != NULL) {
+        ToastCacheRemoveEntry(cache, &cache->partitions[partid], entry, hashcode, false);
+    }
+    LWLockRelease(ToastCachePartitionLock(partid));
+}
+
+/*
+ * Drop the cached values of a relfilenode which is unlinked or truncated.
+ * Called for every relation, so it returns at once while the cache is
+ * empty, and otherwise only probes each partition's relfilenode index
+ * under the shared lock until it finds entries to drop.
+ */
+void ToastCacheForgetRelFileNode(const RelFileNode* rnode)
+{
+    ToastCacheShared* cache = g_instance.cache_cxt.toast_cache;
+    RelFileNode key;
+
+    if (cache == NULL || pg_atomic_read_u32(&cache->nentries) == 0) {
+        return;
+    }
+
+    errno_t rc = memset_s(&key, sizeof(key), 0, sizeof(key));
+    securec_check(rc, "\0", "\0");
+    key = *rnode;
+
+    for (int i = 0; i < NUM_TOAST_CACHE_PARTITIONS; i++) {
+        ToastCachePartition* part = &cache->partitions[i];
+        ToastCacheRel* rel = NULL;
+        dlist_mutable_iter iter;
+        bool found = false;
+
+        (void)LWLockAcquire(ToastCachePartitionLock(i), LW_SHARED);
+        found = (hash_search(part->rels, &key, HASH_FIND, NULL) != NULL);
+        LWLockRelease(ToastCachePartitionLock(i));
+        if (!found) {
+            continue;
+        }
+
+        (void)LWLockAcquire(ToastCachePartitionLock(i), LW_EXCLUSIVE);
+        rel = (ToastCacheRel*)hash_search(part->rels, &key, HASH_FIND, NULL);
+        if (rel != NULL) {
+            dlist_foreach_modify(iter, &rel->values)
+            {
+                ToastCacheEntry* entry = dlist_container(ToastCacheEntry, rel_link, iter.cur);
+
+                ToastCacheRemoveEntry(cache, part, entry, get_hash_value(cache->hash, &entry->key), true);
+            }
+            (void)hash_search(part->rels, &key, HASH_REMOVE, NULL);
+        }
+        LWLockRelease(ToastCachePartitionLock(i));
+    }
+}
@@ -23,6 +23,10 @@
  *		heap_tuple_untoast_attr -
  *			Fetch back a given value from the "secondary" relation
  *
+ *		toast_compress_datum -
+ *			Compress a value with pglz or lz4, the method is kept in
+ *			the header of the compressed value
+ *
  * -------------------------------------------------------------------------
  */
 #include "postgres.h"
@@ -35,6 +39,8 @@
 #include "access/tuptoaster.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
+#include "lz4.h"
+#include "utils/attoptcache.h"
 #include "utils/fmgroids.h"
 #include "utils/pg_lzcompress.h"
 #include "utils/rel.h"
@@ -50,6 +56,9 @@ static Datum toast_save_datum(Relation rel, Datum value, struct varlena* oldexte
 static bool toastid_valueid_exists(Oid toastrelid, Oid valueid, int2 bucketid);
 static struct varlena* toast_fetch_datum(struct varlena* attr);
 static struct varlena* toast_fetch_datum_slice(struct varlena* attr, int32 sliceoffset, int32 length);
+static struct varlena* toast_fetch_datum_cached(struct varlena* attr);
+static struct varlena* toast_decompress_datum(const struct varlena* attr);
+static int toast_attribute_compression(Relation rel, int attnum);
 
 /* ----------
  * heap_tuple_fetch_attr -
@@ -116,18 +125,10 @@ struct varlena* heap_tuple_untoast_attr(struct varlena* attr)
 {
     if (VARATT_IS_EXTERNAL_ONDISK_B(attr)) {
         /*
-         * This is an externally stored datum --- fetch it back from there
+         * This is an externally stored datum --- fetch it back from there,
+         * decompressed, unless the shared cache has it already
          */
-        attr = toast_fetch_datum(attr);
-        /* If it's compressed, decompress it */
-        if (VARATT_IS_COMPRESSED(attr)) {
-            PGLZ_Header* tmp = (PGLZ_Header*)attr;
-
-            attr = (struct varlena*)palloc(PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-            SET_VARSIZE(attr, PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-            pglz_decompress(tmp, VARDATA(attr));
-            pfree(tmp);
-        }
+        attr = toast_fetch_datum_cached(attr);
     } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
         struct varatt_indirect redirect;
         VARATT_EXTERNAL_GET_POINTER(redirect, attr);
@@ -141,11 +142,7 @@ struct varlena* heap_tuple_untoast_attr(struct varlena* attr)
         /*
          * This is a compressed value inside of the main tuple
          */
-        PGLZ_Header* tmp = (PGLZ_Header*)attr;
-
-        attr = (struct varlena*)palloc(PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-        SET_VARSIZE(attr, PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-        pglz_decompress(tmp, VARDATA(attr));
+        attr = toast_decompress_datum(attr);
     } else if (VARATT_IS_SHORT(attr)) {
         /*
          * This is a short-header varlena --- convert to 4-byte header format
@@ -189,8 +186,8 @@ struct varlena* heap_tuple_untoast_attr_slice(struct varlena* attr, int32 slice_
         if (!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
             return toast_fetch_datum_slice(attr, slice_offset, slice_length);
 
-        /* fetch it back (compressed marker will get set automatically) */
-        preslice = toast_fetch_datum(attr);
+        /* fetch it back decompressed, possibly from the shared cache */
+        preslice = toast_fetch_datum_cached(attr);
     } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
         struct varatt_indirect redirect;
         VARATT_EXTERNAL_GET_POINTER(redirect, attr);
@@ -203,14 +200,11 @@ struct varlena* heap_tuple_untoast_attr_slice(struct varlena* attr, int32 slice_
         preslice = attr;
 
     if (VARATT_IS_COMPRESSED(preslice)) {
-        PGLZ_Header* tmp = (PGLZ_Header*)preslice;
-        Size size = PGLZ_RAW_SIZE(tmp) + VARHDRSZ;
+        struct varlena* tmp = preslice;
 
-        preslice = (struct varlena*)palloc(size);
-        SET_VARSIZE(preslice, size);
-        pglz_decompress(tmp, VARDATA(preslice));
+        preslice = toast_decompress_datum(tmp);
 
-        if (tmp != (PGLZ_Header*)attr)
+        if (tmp != attr)
             pfree(tmp);
     }
 
@@ -638,7 +632,7 @@ HeapTuple toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtu
         i = biggest_attno;
         if (att[i]->attstorage == 'x') {
             old_value = toast_values[i];
-            new_value = toast_compress_datum(old_value);
+            new_value = toast_compress_datum(old_value, toast_attribute_compression(rel, i + 1));
             if (DatumGetPointer(new_value) != NULL) {
                 /* successful compression */
                 if (toast_free[i]) {
@@ -772,7 +766,7 @@ HeapTuple toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtu
          */
         i = biggest_attno;
         old_value = toast_values[i];
-        new_value = toast_compress_datum(old_value);
+        new_value = toast_compress_datum(old_value, toast_attribute_compression(rel, i + 1));
         if (DatumGetPointer(new_value) != NULL) {
             /* successful compression */
             if (toast_free[i]) {
@@ -1170,12 +1164,17 @@ Datum toast_flatten_tuple_attribute(Datum value, Oid typeId, int32 typeMod)
  *
  *	We use VAR{SIZE,DATA}_ANY so we can handle short varlenas here without
  *	copying them.  But we can't handle external or compressed datums.
+ *
+ *	cmethod is one of the TOAST_*_COMPRESSION_ID, it is recorded in the
+ *	top bits of va_rawsize so that the value can be decompressed whatever
+ *	the column option says later.
  * ----------
  */
-Datum toast_compress_datum(Datum value)
+Datum toast_compress_datum(Datum value, int cmethod)
 {
     struct varlena* tmp = NULL;
     int32 valsize = VARSIZE_ANY_EXHDR(DatumGetPointer(value));
+    bool compressed = false;
 
     Assert(!VARATT_IS_EXTERNAL(DatumGetPointer(value)));
     Assert(!VARATT_IS_COMPRESSED(DatumGetPointer(value)));
@@ -1187,9 +1186,26 @@ Datum toast_compress_datum(Datum value)
     if (valsize < PGLZ_strategy_default->min_input_size || valsize > PGLZ_strategy_default->max_input_size)
         return PointerGetDatum(NULL);
 
-    tmp = (struct varlena*)palloc(PGLZ_MAX_OUTPUT(valsize));
+    if (cmethod == TOAST_LZ4_COMPRESSION_ID) {
+        int32 bound = LZ4_compressBound(valsize);
+        int32 len;
+
+        tmp = (struct varlena*)palloc(offsetof(varattrib_4b, va_compressed.va_data) + bound);
+        len = LZ4_compress_default(VARDATA_ANY(DatumGetPointer(value)), VARDATA_4B_C(tmp), valsize, bound);
+        if (len > 0) {
+            SET_VARSIZE_COMPRESSED(tmp, offsetof(varattrib_4b, va_compressed.va_data) + len);
+            ((varattrib_4b*)tmp)->va_compressed.va_rawsize =
+                (uint32)valsize | ((uint32)TOAST_LZ4_COMPRESSION_ID << VARLENA_RAWSIZE_BITS);
+            compressed = true;
+        }
+    } else {
+        tmp = (struct varlena*)palloc(PGLZ_MAX_OUTPUT(valsize));
+        compressed =
+            pglz_compress(VARDATA_ANY(DatumGetPointer(value)), valsize, (PGLZ_Header*)tmp, PGLZ_strategy_default);
+    }
+
     /*
-     * We recheck the actual size even if pglz_compress() reports success,
+     * We recheck the actual size even if the compressor reports success,
      * because it might be satisfied with having saved as little as one byte
      * in the compressed data --- which could turn into a net loss once you
      * consider header and alignment padding.  Worst case, the compressed
@@ -1198,8 +1214,7 @@ Datum toast_compress_datum(Datum value)
      * only one header byte and no padding if the value is short enough.  So
      * we insist on a savings of more than 2 bytes to ensure we have a gain.
      */
-    if (pglz_compress(VARDATA_ANY(DatumGetPointer(value)), valsize, (PGLZ_Header*)tmp, PGLZ_strategy_default) &&
-        VARSIZE(tmp) < (uint32)(valsize - 2)) {
+    if (compressed && VARSIZE(tmp) < (uint32)(valsize - 2)) {
         /* successful compression */
         return PointerGetDatum(tmp);
     } else {
@@ -1209,6 +1224,135 @@ Datum toast_compress_datum(Datum value)
     }
 }
 
+/* ----------
+ * toast_decompress_datum -
+ *
+ *	Decompress a compressed varlena datum with the method recorded in it
+ * ----------
+ */
+static struct varlena* toast_decompress_datum(const struct varlena* attr)
+{
+    int32 rawsize = VARRAWSIZE_4B_C(attr);
+    struct varlena* result = NULL;
+
+    Assert(VARATT_IS_COMPRESSED(attr));
+
+    result = (struct varlena*)palloc(rawsize + VARHDRSZ);
+    SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+    switch (VARCOMPRESSMETHOD_4B_C(attr)) {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            pglz_decompress((const PGLZ_Header*)attr, VARDATA(result));
+            break;
+        case TOAST_LZ4_COMPRESSION_ID: {
+            int32 srclen = VARSIZE(attr) - offsetof(varattrib_4b, va_compressed.va_data);
+
+            if (LZ4_decompress_safe(VARDATA_4B_C(attr), VARDATA(result), srclen, rawsize) != rawsize) {
+                ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("compressed lz4 data is corrupt")));
+            }
+            break;
+        }
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                    errmsg("invalid compression method id %u", (uint32)VARCOMPRESSMETHOD_4B_C(attr))));
+            break;
+    }
+
+    return result;
+}
+
+/* ----------
+ * toast_get_compression_id -
+ *
+ *	Return the compression method of a varlena datum.  An external value
+ *	has to be fetched to see its header.
+ * ----------
+ */
+int toast_get_compression_id(struct varlena* attr)
+{
+    int cmethod = TOAST_INVALID_COMPRESSION_ID;
+
+    if (VARATT_IS_EXTERNAL_ONDISK_B(attr)) {
+        struct varatt_external toast_pointer;
+
+        VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+        if (VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer)) {
+            struct varlena* fetched = toast_fetch_datum(attr);
+
+            cmethod = (int)VARCOMPRESSMETHOD_4B_C(fetched);
+            pfree(fetched);
+        }
+    } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
+        struct varatt_indirect redirect;
+
+        VARATT_EXTERNAL_GET_POINTER(redirect, attr);
+
+        /* nested indirect Datums aren't allowed */
+        Assert(!VARATT_IS_EXTERNAL_INDIRECT(redirect.pointer));
+
+        cmethod = toast_get_compression_id(redirect.pointer);
+    } else if (VARATT_IS_COMPRESSED(attr)) {
+        cmethod = (int)VARCOMPRESSMETHOD_4B_C(attr);
+    }
+
+    return cmethod;
+}
+
+int toast_compression_name_to_id(const char* name)
+{
+    if (pg_strcasecmp(name, "pglz") == 0)
+        return TOAST_PGLZ_COMPRESSION_ID;
+    if (pg_strcasecmp(name, "lz4") == 0)
+        return TOAST_LZ4_COMPRESSION_ID;
+    return TOAST_INVALID_COMPRESSION_ID;
+}
+
+const char* toast_compression_id_to_name(int cmethod)
+{
+    switch (cmethod) {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            return "pglz";
+        case TOAST_LZ4_COMPRESSION_ID:
+            return "lz4";
+        default:
+            return NULL;
+    }
+}
+
+/* ----------
+ * toast_attribute_compression -
+ *
+ *	Return the compression method for a column: its toast_compression
+ *	option if set, else default_toast_compression.  The options of a
+ *	partition are those of its partitioned table.  System catalogs are not
+ *	looked up, to stay away from the attribute options cache while the
+ *	catalogs themselves are being written.
+ * ----------
+ */
+static int toast_attribute_compression(Relation rel, int attnum)
+{
+    AttributeOpts* aopts = NULL;
+    Oid relid;
+
+    if (IsSystemRelation(rel))
+        return u_sess->attr.attr_storage.default_toast_compression;
+
+    relid = RelationIsPartition(rel) ? rel->parentId : RelationGetRelid(rel);
+    aopts = get_attribute_options(relid, attnum);
+    if (aopts != NULL) {
+        int cmethod = TOAST_INVALID_COMPRESSION_ID;
+
+        if (aopts->toast_compression != 0)
+            cmethod = toast_compression_name_to_id((char*)aopts + aopts->toast_compression);
+        pfree(aopts);
+        if (cmethod != TOAST_INVALID_COMPRESSION_ID)
+            return cmethod;
+    }
+
+    return u_sess->attr.attr_storage.default_toast_compression;
+}
+
 /* ----------
  * toast_save_datum -
  *
@@ -1365,6 +1509,12 @@ static Datum toast_save_datum(Relation rel, Datum value, struct varlena* oldexte
         }
     }
 
+    /*
+     * The OID may have belonged to a value that was deleted and vacuumed
+     * away, don't let the shared cache return that one for it.
+     */
+    ToastCacheForget(&toastrel->rd_node, toast_pointer.va_valueid);
+
     /*
      * Initialize constant parts of the tuple data
      */
@@ -1512,6 +1662,9 @@ static void toast_delete_datum(Relation rel, Datum value)
      */
     systable_endscan_ordered(toastscan);
     index_close(toastidx, RowExclusiveLock);
+
+    /* release the cached copy early, toast_save_datum forgets it anyway */
+    ToastCacheForget(&toastrel->rd_node, toast_pointer.va_valueid);
     heap_close(toastrel, RowExclusiveLock);
 }
 
@@ -1739,6 +1892,59 @@ static struct varlena* toast_fetch_datum(struct varlena* attr)
     return result;
 }
 
+/* ----------
+ * toast_fetch_datum_cached -
+ *
+ *	Fetch back an externally stored datum, decompressed.  The shared cache
+ *	of detoasted values is looked up first and filled on a miss, so that a
+ *	large value read repeatedly, in one query or by several sessions, is
+ *	neither read back from the toast relation nor decompressed again.
+ *
+ *	The cache is keyed by the relfilenode of the toast relation, which we
+ *	open to get it.  The lock we hold on it keeps the relfilenode from being
+ *	truncated or dropped under us; toast_save_datum forgets a value OID
+ *	before reusing it.
+ * ----------
+ */
+static struct varlena* toast_fetch_datum_cached(struct varlena* attr)
+{
+    struct varatt_external toast_pointer;
+    struct varlena* result = NULL;
+    Relation toastrel;
+    int2 bucketid;
+
+    VARATT_EXTERNAL_GET_POINTER_B(toast_pointer, attr, bucketid);
+
+    if (!ToastCacheEnabled(toast_pointer.va_rawsize)) {
+        result = toast_fetch_datum(attr);
+        if (VARATT_IS_COMPRESSED(result)) {
+            struct varlena* tmp = result;
+
+            result = toast_decompress_datum(tmp);
+            pfree(tmp);
+        }
+        return result;
+    }
+
+    toastrel = heap_open(toast_pointer.va_toastrelid, AccessShareLock, bucketid);
+
+    result = ToastCacheLookup(&toastrel->rd_node, toast_pointer.va_valueid, toast_pointer.va_rawsize);
+    if (result == NULL) {
+        result = toast_fetch_datum(attr);
+        if (VARATT_IS_COMPRESSED(result)) {
+            struct varlena* tmp = result;
+
+            result = toast_decompress_datum(tmp);
+            pfree(tmp);
+        }
+        ToastCacheInsert(&toastrel->rd_node, toast_pointer.va_valueid, result);
+    }
+
+    heap_close(toastrel, AccessShareLock);
+
+    return result;
+}
+
 /* ----------
  * toast_fetch_datum_slice -
  *
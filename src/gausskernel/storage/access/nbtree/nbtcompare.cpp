@@ -82,6 +82,10 @@ Datum btint2sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btint2fastcmp;
+    ssup->comparator_threadsafe = true;
+    ssup->radix_width = 2;
+    ssup->radix_mask = 0x8000;
+    ssup->radix_exact = true;
     PG_RETURN_VOID();
 }
 
@@ -114,6 +118,10 @@ Datum btint4sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btint4fastcmp;
+    ssup->comparator_threadsafe = true;
+    ssup->radix_width = 4;
+    ssup->radix_mask = 0x80000000;
+    ssup->radix_exact = true;
     PG_RETURN_VOID();
 }
 
@@ -146,6 +154,10 @@ Datum btint8sortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btint8fastcmp;
+    ssup->comparator_threadsafe = true;
+    ssup->radix_width = 8;
+    ssup->radix_mask = UINT64CONST(0x8000000000000000);
+    ssup->radix_exact = true;
     PG_RETURN_VOID();
 }
 
@@ -250,6 +262,10 @@ Datum btoidsortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btoidfastcmp;
+    ssup->comparator_threadsafe = true;
+    ssup->radix_width = 4;
+    ssup->radix_mask = 0;
+    ssup->radix_exact = true;
     PG_RETURN_VOID();
 }
 
@@ -304,6 +320,7 @@ Datum btnamesortsupport(PG_FUNCTION_ARGS)
     SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
 
     ssup->comparator = btnamefastcmp;
+    ssup->comparator_threadsafe = true;
     PG_RETURN_VOID();
 }
 
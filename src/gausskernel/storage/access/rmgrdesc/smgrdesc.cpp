@@ -32,6 +32,12 @@ void smgr_desc(StringInfo buf, XLogReaderState* record)
         char* path = relpathperm(rnode, xlrec->forkNum);
 
         appendStringInfo(buf, "file create: %s", path);
+        if (XLogRecGetDataLen(record) >= sizeof(xl_smgr_create) + sizeof(uint32)) {
+            uint32 compressOpt;
+            errno_t rc = memcpy_s(&compressOpt, sizeof(uint32), rec + sizeof(xl_smgr_create), sizeof(uint32));
+            securec_check(rc, "", "");
+            appendStringInfo(buf, " compress algorithm %u chunk size %u", compressOpt >> 16, compressOpt & 0xFFFF);
+        }
 #ifdef FRONTEND
         free(path);
         path = NULL;
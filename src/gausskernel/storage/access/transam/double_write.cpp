@@ -103,6 +103,11 @@ Datum dw_get_high_threshold_pages()
     return UInt64GetDatum(g_instance.dw_cxt.stat_info.high_threshold_pages);
 }
 
+Datum dw_get_skipped_pages()
+{
+    return UInt64GetDatum(g_instance.dw_cxt.stat_info.skipped_pages);
+}
+
 /* double write statistic view */
 const dw_view_col_t g_dw_view_col_arr[DW_VIEW_COL_NUM] = {
     {"node_name", TEXTOID, dw_get_node_name},
@@ -115,7 +120,8 @@ const dw_view_col_t g_dw_view_col_arr[DW_VIEW_COL_NUM] = {
     {"high_threshold_writes", INT8OID, dw_get_high_threshold_writes},
     {"total_pages", INT8OID, dw_get_total_pages},
     {"low_threshold_pages", INT8OID, dw_get_low_threshold_pages},
-    {"high_threshold_pages", INT8OID, dw_get_high_threshold_pages}
+    {"high_threshold_pages", INT8OID, dw_get_high_threshold_pages},
+    {"skipped_pages", INT8OID, dw_get_skipped_pages}
 };
 
 void dw_pread_file(int fd, void* buf, int size, int64 offset)
@@ -366,6 +372,7 @@ static void dw_recover_pages(T1* batch, T2* buf_tag, PageHeader data_page, bool
     SMgrRelation relation;
     BlockNumber blk_num;
     RelFileNode relnode;
+    bool data_ok = false;
     for (i = 0; i < GET_REL_PGAENUM(batch->page_num); i++) {
         buf_tag = &batch->buf_tag[i];
         if (is_hashbucket) {
@@ -389,7 +396,8 @@ static void dw_recover_pages(T1* batch, T2* buf_tag, PageHeader data_page, bool
             dw_log_data_page(WARNING, "Data page deleted", buf_tag);
             continue;
         }
-        smgrread(relation, buf_tag->forkNum, buf_tag->blockNum, (char*)data_page);
+        /* a torn compressed image does not decode; that is just a broken page here */
+        data_ok = smgrtryread(relation, buf_tag->forkNum, buf_tag->blockNum, (char*)data_page);
 
         dw_page = (PageHeader)((char*)batch + (i + 1) * BLCKSZ);
         if (!dw_verify_pg_checksum(dw_page, buf_tag->blockNum)) {
@@ -400,7 +408,7 @@ static void dw_recover_pages(T1* batch, T2* buf_tag, PageHeader data_page, bool
 
         dw_log_data_page(DW_LOG_LEVEL, "DW page fine", buf_tag);
         dw_log_page_header(dw_page);
-        if (!dw_verify_pg_checksum(data_page, buf_tag->blockNum) ||
+        if (!data_ok || !dw_verify_pg_checksum(data_page, buf_tag->blockNum) ||
             XLByteLT(PageGetLSN(data_page), PageGetLSN(dw_page))) {
             smgrwrite(relation, buf_tag->forkNum, buf_tag->blockNum, (const char*)dw_page, false);
             dw_log_data_page(LOG, "Date page recovered", buf_tag);
@@ -409,6 +417,21 @@ static void dw_recover_pages(T1* batch, T2* buf_tag, PageHeader data_page, bool
     }
 }
 
+/*
+ * In page_image mode, the batches before the first one of the current image generation can
+ * be discarded. dw_switch_image_gen has waited for the last batch of the previous generation,
+ * so all of them have been written to data file and synced by the checkpoint.
+ * Caller should hold dw flush lock.
+ */
+static uint16 dw_image_trunc_page(dw_context_t* ctx)
+{
+    if (ctx->batch_gen != pg_atomic_read_u32(&ctx->image_gen)) {
+        /* no batch flushed in the current generation yet */
+        return ctx->flush_page;
+    }
+    return ctx->image_switch_page;
+}
+
 /*
  * Basically, dw_reset_if_need calls smgrsync and then reuse dw file to some extent:
  * 1. truncate dw file start position to last flush postition, before which all dirty buffers are garanteed
@@ -441,7 +464,7 @@ static bool dw_reset_if_need(dw_context_t* ctx, uint16 pages_to_write, bool trun
 
     if (trunc_file) {
         /* record last flush position for truncate because flush lock is not held during smgrsync */
-        last_flush_page = ctx->last_flush_page;
+        last_flush_page = dw_page_image_enabled() ? dw_image_trunc_page(ctx) : ctx->last_flush_page;
         LWLockRelease(ctx->flush_lock);
     } else {
         /* no need to reserve last flush position for full recycle */
@@ -487,6 +510,10 @@ static bool dw_reset_if_need(dw_context_t* ctx, uint16 pages_to_write, bool trun
         Assert(AmStartupProcess() || AmPageWriterProcess());
         file_head->start = DW_BATCH_FILE_START;
         ctx->last_flush_page = ctx->flush_page;
+        /* the page images are gone, copy the pages again */
+        if (dw_page_image_enabled()) {
+            (void)pg_atomic_add_fetch_u32(&ctx->image_gen, 1);
+        }
     } else {
         Assert(AmStartupProcess() || AmCheckpointerProcess() || AmBootstrapProcess() || !IsUnderPostmaster);
         /*
@@ -498,7 +525,9 @@ static bool dw_reset_if_need(dw_context_t* ctx, uint16 pages_to_write, bool trun
     }
 
     ctx->flush_page -= last_flush_page;
-    ctx->last_flush_page -= last_flush_page;
+    /* truncate for page_image may go beyond last dw flush */
+    ctx->last_flush_page -= Min(ctx->last_flush_page, last_flush_page);
+    ctx->image_switch_page -= Min(ctx->image_switch_page, last_flush_page);
 
     /*
      * if truncate file and flush_page is not 0, the dwn can not plus,
@@ -740,6 +769,7 @@ static void dw_init_memory(dw_context_t* ctx)
     uint32 buf_size;
     char* buf = NULL;
     MemoryContext old_mem_ctx;
+    errno_t rc;
 
     buf_size = DW_MEM_CTX_MAX_BLOCK_SIZE_FOR_NOHBK;
 
@@ -760,6 +790,21 @@ static void dw_init_memory(dw_context_t* ctx)
     ctx->flush_page = 0;
     ctx->last_flush_page = 0;
 
+    ctx->page_images = NULL;
+    if (dw_page_image_enabled()) {
+        ctx->page_images = (dw_page_image_t*)palloc_huge(
+            ctx->mem_ctx, sizeof(dw_page_image_t) * (Size)g_instance.attr.attr_storage.NBuffers);
+        rc = memset_s(ctx->page_images,
+            sizeof(dw_page_image_t) * (Size)g_instance.attr.attr_storage.NBuffers,
+            0,
+            sizeof(dw_page_image_t) * (Size)g_instance.attr.attr_storage.NBuffers);
+        securec_check(rc, "\0", "\0");
+    }
+    ctx->image_gen = 1;
+    ctx->inflight_gen = 0;
+    ctx->batch_gen = 0;
+    ctx->image_switch_page = 0;
+
     (void)MemoryContextSwitchTo(old_mem_ctx);
 }
 
@@ -774,6 +819,10 @@ static void dw_free_resource(dw_context_t* ctx)
     ctx->unaligned_buf = NULL;
     ctx->file_head = NULL;
     ctx->buf = NULL;
+    if (ctx->page_images != NULL) {
+        pfree(ctx->page_images);
+        ctx->page_images = NULL;
+    }
     MemoryContextDelete(ctx->mem_ctx);
 }
 
@@ -782,6 +831,7 @@ void dw_shmem_init()
     /* LWLock Should be reset when postmaster inits shmem. */
     if (!IsUnderPostmaster) {
         g_instance.dw_cxt.flush_lock = NULL;
+        g_instance.dw_cxt.protection = g_instance.attr.attr_storage.torn_page_protection;
     }
 }
 
@@ -898,6 +948,17 @@ static XLogRecPtr dw_copy_page(dw_context_t* dw_ctx, int buf_desc_id, bool* is_s
         return page_lsn;
     }
 
+    if (dw_ctx->page_images != NULL) {
+        dw_page_image_t* image = &dw_ctx->page_images[buf_desc_id];
+
+        /* recovery restores the copy of this generation and replays WAL from it */
+        if (image->gen == dw_ctx->batch_gen && BUFFERTAGS_EQUAL(image->tag, buf_desc->tag)) {
+            UnlockBufHdr(buf_desc, buf_state);
+            (void)pg_atomic_add_fetch_u64(&dw_ctx->stat_info.skipped_pages, 1);
+            return page_lsn;
+        }
+    }
+
     PinBuffer_Locked(buf_desc);
 
     /* We must use a conditional lock acquisition here to avoid deadlock. If
@@ -940,6 +1001,11 @@ static XLogRecPtr dw_copy_page(dw_context_t* dw_ctx, int buf_desc_id, bool* is_s
     rc = memcpy_s(dest_addr, BLCKSZ, block, BLCKSZ);
     securec_check(rc, "\0", "\0");
 
+    if (dw_ctx->page_images != NULL) {
+        dw_ctx->page_images[buf_desc_id].tag = buf_desc->tag;
+        dw_ctx->page_images[buf_desc_id].gen = dw_ctx->batch_gen;
+    }
+
     LWLockRelease(buf_desc->content_lock);
     UnpinBuffer(buf_desc, true);
 
@@ -1069,6 +1135,35 @@ static void dw_flush(dw_context_t* dw_ctx, XLogRecPtr latest_lsn)
                 pages_to_write)));
 }
 
+/*
+ * Make room and take the image generation for a page_image batch.
+ *
+ * The space is reserved for the whole batch before choosing the pages to copy, since a file reset
+ * discards the page images the others rely on. The generation is published in inflight_gen and
+ * read again, so that a checkpoint starting a new generation either sees this batch and waits for
+ * it, or this batch takes the new generation.
+ */
+static void dw_begin_image_batch(dw_context_t* dw_ctx, uint16 size)
+{
+    uint32 gen;
+
+    (void)LWLockAcquire(dw_ctx->flush_lock, LW_EXCLUSIVE);
+
+    (void)dw_reset_if_need(dw_ctx, dw_batch_add_extra(size), false);
+
+    do {
+        gen = pg_atomic_read_u32(&dw_ctx->image_gen);
+        (void)pg_atomic_exchange_u32(&dw_ctx->inflight_gen, gen);
+    } while (gen != pg_atomic_read_u32(&dw_ctx->image_gen));
+
+    if (gen != dw_ctx->batch_gen) {
+        dw_ctx->batch_gen = gen;
+        dw_ctx->image_switch_page = dw_ctx->flush_page;
+    }
+
+    LWLockRelease(dw_ctx->flush_lock);
+}
+
 void dw_perform(uint32 size)
 {
     uint16 batch_size;
@@ -1102,6 +1197,10 @@ void dw_perform(uint32 size)
     }
     dw_ctx->write_pos = 0;
 
+    if (dw_ctx->page_images != NULL) {
+        dw_begin_image_batch(dw_ctx, batch_size);
+    }
+
     for (uint16 i = 0; i < batch_size; i++) {
         bool is_skipped = false;
         page_lsn = dw_copy_page(dw_ctx, g_instance.ckpt_cxt_ctl->CkptBufferIds[i].buf_id, &is_skipped);
@@ -1126,6 +1225,38 @@ void dw_perform(uint32 size)
     dw_log_perform(dw_ctx, "end", write_id, batch_size);
 }
 
+void dw_perform_end()
+{
+    if (dw_page_image_enabled()) {
+        (void)pg_atomic_exchange_u32(&g_instance.dw_cxt.inflight_gen, 0);
+    }
+}
+
+void dw_switch_image_gen()
+{
+    dw_context_t* ctx = &g_instance.dw_cxt;
+    uint32 gen;
+    uint32 inflight_gen;
+
+    if (!dw_page_image_enabled() || SECUREC_UNLIKELY(!ctx->initialized)) {
+        return;
+    }
+
+    gen = pg_atomic_add_fetch_u32(&ctx->image_gen, 1);
+    for (;;) {
+        inflight_gen = pg_atomic_read_u32(&ctx->inflight_gen);
+        if (inflight_gen == 0 || inflight_gen >= gen ||
+            pg_atomic_read_u32(&g_instance.ckpt_cxt_ctl->current_page_writer_count) < 1) {
+            break;
+        }
+        pg_usleep(DW_SLEEP_US);
+        /* do smgrsync in case dw file recycle of pagewriter is being blocked */
+        smgrsync_with_absorption();
+    }
+
+    ereport(DW_LOG_LEVEL, (errmodule(MOD_DW), errmsg("DW switch image generation: %u", gen)));
+}
+
 void dw_truncate()
 {
     dw_context_t* ctx = &g_instance.dw_cxt;
@@ -48,6 +48,7 @@
 #include "catalog/pg_authid.h"
 #include "catalog/storage.h"
 #include "commands/async.h"
+#include "commands/copy_parallel.h"
 #include "commands/dbcommands.h"
 #include "commands/defrem.h"
 #include "commands/tablecmds.h"
@@ -1336,6 +1337,79 @@ static void AtSubStart_ResourceOwner(void)
  *						CommitTransaction stuff
  * ----------------------------------------------------------------
  */
+/*
+ *	CanDeferCommitAck
+ *
+ * In thread pool mode a synchronous commit of a client session may skip the
+ * wait for WAL flush and sync rep here: the worker holds the reply back and
+ * parks the session in the listener until the commit is durable, and serves
+ * other sessions meanwhile.  Commits that delete files or libraries, or that
+ * force a sync commit, still wait in place.
+ */
+static bool CanDeferCommitAck(int nrels, int nlibrary)
+{
+    return IS_THREAD_POOL_WORKER && IS_SINGLE_NODE && u_sess->attr.attr_storage.thread_pool_defer_commit_ack &&
+           t_thrd.postgres_cxt.whereToSendOutput == DestRemote && !t_thrd.xact_cxt.forceSyncCommit && nrels == 0 &&
+           nlibrary == 0;
+}
+
+/*
+ * Remember that the reply to this commit must wait for commitLSN to be
+ * flushed, and for the sync standbys if synchronous_commit asks for them.
+ */
+static void DeferCommitAck(XLogRecPtr commitLSN)
+{
+    knl_u_xact_context* xact_cxt = &u_sess->xact_cxt;
+
+    if (XLByteLT(xact_cxt->commitAckLsn, commitLSN)) {
+        xact_cxt->commitAckLsn = commitLSN;
+    }
+    if (u_sess->attr.attr_storage.guc_synchronous_commit > SYNCHRONOUS_COMMIT_LOCAL_FLUSH) {
+        xact_cxt->commitAckSyncRepMode = SyncRepGetDeferredWaitMode();
+    }
+
+    /* Have the WAL writer flush it now, together with the other parked commits */
+    if (g_instance.proc_base->walwriterLatch) {
+        SetLatch(g_instance.proc_base->walwriterLatch);
+    }
+}
+
+/*
+ * Has the commit acknowledgement deferred by the given session become
+ * durable?  flushPtr is the current WAL flush position.  This is called by
+ * the thread pool listener as well as by the owning worker.
+ */
+bool CommitAckConfirmed(knl_session_context* session, XLogRecPtr flushPtr)
+{
+    XLogRecPtr commitLSN = session->xact_cxt.commitAckLsn;
+
+    if (XLByteLT(flushPtr, commitLSN)) {
+        return false;
+    }
+    return SyncRepLSNConfirmed(commitLSN, session->xact_cxt.commitAckSyncRepMode);
+}
+
+/*
+ * Wait in place for a deferred commit acknowledgement, before any later
+ * output could overtake the reply that is being held back.
+ */
+void WaitDeferredCommitAck(void)
+{
+    knl_u_xact_context* xact_cxt = &u_sess->xact_cxt;
+
+    if (!CommitAckDeferred()) {
+        return;
+    }
+
+    XLogFlush(xact_cxt->commitAckLsn);
+    if (xact_cxt->commitAckSyncRepMode != SYNC_REP_NO_WAIT) {
+        SyncRepWaitForLSN(xact_cxt->commitAckLsn);
+    }
+
+    xact_cxt->commitAckLsn = InvalidXLogRecPtr;
+    xact_cxt->commitAckSyncRepMode = SYNC_REP_NO_WAIT;
+}
+
 /*
  *	RecordTransactionCommit
  *
@@ -1361,6 +1435,7 @@ static TransactionId RecordTransactionCommit(void)
     bool isExecCN = (IS_PGXC_COORDINATOR && !IsConnFromCoord());
     XLogRecPtr globalDelayDDLLSN = InvalidXLogRecPtr;
     XLogRecPtr commitRecLSN = InvalidXLogRecPtr;
+    bool deferAck = false;
 
     /* Get data needed for commit record */
     nrels = smgrGetPendingDeletes(true, &rels);
@@ -1598,6 +1673,11 @@ static TransactionId RecordTransactionCommit(void)
      * anyway if we crash.)
      */
     if ((wrote_xlog && synchronous_commit > SYNCHRONOUS_COMMIT_OFF) || t_thrd.xact_cxt.forceSyncCommit || nrels > 0) {
+        deferAck = CanDeferCommitAck(nrels, nlibrary);
+    }
+
+    if (((wrote_xlog && synchronous_commit > SYNCHRONOUS_COMMIT_OFF) || t_thrd.xact_cxt.forceSyncCommit || nrels > 0) &&
+        !deferAck) {
         /*
          * Synchronous commit case:
          *
@@ -1642,6 +1722,14 @@ static TransactionId RecordTransactionCommit(void)
          */
         XLogSetAsyncXactLSN(t_thrd.xlog_cxt.XactLastRecEnd);
 
+        /*
+         * A deferred acknowledgement commits the same way, but the client is
+         * only told once the commit is durable, see CanDeferCommitAck.
+         */
+        if (deferAck) {
+            DeferCommitAck(t_thrd.xlog_cxt.XactLastRecEnd);
+        }
+
         /*
          * We must not immediately update the CLOG, since we didn't flush the
          * XLOG. Instead, we store the LSN up to which the XLOG must be
@@ -1672,7 +1760,9 @@ static TransactionId RecordTransactionCommit(void)
      * in the procarray and continue to hold locks.
      */
     if (wrote_xlog && u_sess->attr.attr_storage.guc_synchronous_commit > SYNCHRONOUS_COMMIT_LOCAL_FLUSH) {
-        SyncRepWaitForLSN(t_thrd.xlog_cxt.XactLastRecEnd);
+        if (!deferAck) {
+            SyncRepWaitForLSN(t_thrd.xlog_cxt.XactLastRecEnd);
+        }
         g_instance.comm_cxt.localinfo_cxt.set_term = true;
     }
 
@@ -2852,6 +2942,7 @@ static void CommitTransaction(void)
     AtEOXact_on_commit_actions(true);
     AtEOXact_Namespace(true);
     AtEOXact_SMgr();
+    AtEOXact_CopyParallel(true);
     AtEOXact_Files();
     AtEOXact_ComboCid();
     AtEOXact_HashTables(true);
@@ -3396,6 +3487,7 @@ static void PrepareTransaction(void)
     AtEOXact_on_commit_actions(true);
     AtEOXact_Namespace(true);
     AtEOXact_SMgr();
+    AtEOXact_CopyParallel(true);
     AtEOXact_Files();
     AtEOXact_ComboCid();
     AtEOXact_HashTables(true);
@@ -3791,6 +3883,7 @@ static void AbortTransaction(bool PerfectRollback = false)
         AtEOXact_on_commit_actions(false);
         AtEOXact_Namespace(false);
         AtEOXact_SMgr();
+        AtEOXact_CopyParallel(false);
         AtEOXact_Files();
         AtEOXact_ComboCid();
         AtEOXact_HashTables(false);
@@ -5870,6 +5963,7 @@ static void CommitSubTransaction(void)
     AtEOSubXact_SPI(true, s->subTransactionId);
     AtEOSubXact_on_commit_actions(true, s->subTransactionId, s->parent->subTransactionId);
     AtEOSubXact_Namespace(true, s->subTransactionId, s->parent->subTransactionId);
+    AtEOSubXact_CopyParallel(true, s->subTransactionId, s->parent->subTransactionId);
     AtEOSubXact_Files(true, s->subTransactionId, s->parent->subTransactionId);
     AtEOSubXact_HashTables(true, s->nestingLevel);
     AtEOSubXact_PgStat(true, s->nestingLevel);
@@ -6048,6 +6142,7 @@ static void AbortSubTransaction(void)
         AtEOSubXact_SPI(false, s->subTransactionId);
         AtEOSubXact_on_commit_actions(false, s->subTransactionId, s->parent->subTransactionId);
         AtEOSubXact_Namespace(false, s->subTransactionId, s->parent->subTransactionId);
+        AtEOSubXact_CopyParallel(false, s->subTransactionId, s->parent->subTransactionId);
         AtEOSubXact_Files(false, s->subTransactionId, s->parent->subTransactionId);
         AtEOSubXact_HashTables(false, s->nestingLevel);
         AtEOSubXact_PgStat(false, s->nestingLevel);
@@ -15,6 +15,11 @@
  */
 #include "storage/dfs/dfscache_mgr.h"
 
+#include <sys/mman.h>
+#ifdef __USE_NUMA
+#include <numa.h>
+#endif
+
 #include "postgres.h"
 #include "knl/knl_variable.h"
 
@@ -58,6 +63,224 @@ const int PAGE_QUEUE_SLOT_MULTI_NBUFFERS = 5;
  *		shared refcount isn't increased if a individual backend pins a buffer
  *		multiple times. Check the PrivateRefCount infrastructure in bufmgr.c.
  */
+/*
+ * BufferPoolHasOwnMapping
+ *
+ * The descriptors and pages leave the main shared memory segment and get a
+ * mapping of their own when huge pages are asked for, or when the server
+ * runs NUMA-distributed and the buffer pool is to be partitioned per node.
+ * All threads share the address space, so a private anonymous mapping is
+ * as good as shared memory here.
+ */
+static bool BufferPoolHasOwnMapping(void)
+{
+    if (g_instance.attr.attr_storage.shared_buffers_huge_pages != BUFFER_HUGE_PAGES_OFF)
+        return true;
+#ifdef __USE_NUMA
+    if (g_instance.shmem_cxt.numaNodeNum > 1 && g_instance.shmem_cxt.numaNodeNum <= BUFFER_NUMA_MAX_NODES)
+        return true;
+#endif
+    return false;
+}
+
+/*
+ * GetDefaultHugePageSize
+ *
+ * Read the default huge page size from /proc/meminfo, or fall back to 2MB.
+ */
+static Size GetDefaultHugePageSize(void)
+{
+    Size result = 2 * 1024 * 1024;
+    FILE* fp = fopen("/proc/meminfo", "r");
+    char buf[128];
+    unsigned int sz;
+    char ch;
+
+    if (fp == NULL)
+        return result;
+
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        if (sscanf_s(buf, "Hugepagesize: %u %c", &sz, &ch, 1) == 2) {
+            if (ch == 'k')
+                result = (Size)sz * 1024;
+            break;
+        }
+    }
+    (void)fclose(fp);
+
+    return result;
+}
+
+/*
+ * BufferPoolMap
+ *
+ * Map size bytes for the buffer pool.  When allow_huge is set and huge pages
+ * are enabled, explicit huge pages are tried first; with "try" a failure
+ * falls back to regular pages advised for transparent huge pages, with "on"
+ * it is fatal.  *mapped_size and *page_size report what was really mapped.
+ */
+static char* BufferPoolMap(const char* name, Size size, bool allow_huge, Size* mapped_size, Size* page_size)
+{
+    int huge_pages = g_instance.attr.attr_storage.shared_buffers_huge_pages;
+    void* ptr = MAP_FAILED;
+
+    *mapped_size = size;
+    *page_size = (Size)sysconf(_SC_PAGESIZE);
+
+    if (allow_huge && huge_pages != BUFFER_HUGE_PAGES_OFF) {
+        Size huge_page_size = (Size)g_instance.attr.attr_storage.shared_buffers_huge_page_size * 1024;
+        int flags = MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB;
+
+        if (huge_page_size == 0) {
+            huge_page_size = GetDefaultHugePageSize();
+        } else {
+#ifdef MAP_HUGE_SHIFT
+            /* ask for a page size other than the default explicitly */
+            int shift = 0;
+            while (((Size)1 << shift) < huge_page_size)
+                shift++;
+            flags |= shift << MAP_HUGE_SHIFT;
+#endif
+        }
+
+        Size huge_size = TYPEALIGN(huge_page_size, size);
+        ptr = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (ptr != MAP_FAILED) {
+            *mapped_size = huge_size;
+            *page_size = huge_page_size;
+        } else if (huge_pages == BUFFER_HUGE_PAGES_ON) {
+            ereport(FATAL,
+                (errcode(ERRCODE_OUT_OF_MEMORY),
+                    errmsg("could not map %s (%lu bytes) with %lu kB huge pages: %m",
+                        name,
+                        (unsigned long)huge_size,
+                        (unsigned long)(huge_page_size / 1024)),
+                    errhint("Reserve more huge pages of that size (vm.nr_hugepages), "
+                            "or set shared_buffers_huge_pages to \"try\".")));
+        } else {
+            ereport(LOG,
+                (errmsg("could not map %s with %lu kB huge pages, using regular pages: %m",
+                    name,
+                    (unsigned long)(huge_page_size / 1024))));
+        }
+    }
+
+    if (ptr == MAP_FAILED) {
+        ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            ereport(FATAL,
+                (errcode(ERRCODE_OUT_OF_MEMORY),
+                    errmsg("could not map %s (%lu bytes): %m", name, (unsigned long)size)));
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge_pages == BUFFER_HUGE_PAGES_TRY)
+            (void)madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    return (char*)ptr;
+}
+
+#ifdef __USE_NUMA
+/*
+ * BufferPoolBindNuma
+ *
+ * Bind each partition of the descriptors and pages to its NUMA node.  The
+ * pages of a partition start on a page boundary of their mapping by
+ * construction; for the descriptors the boundaries are rounded to regular
+ * pages, so a partition's first and last descriptors may sit on a neighbour.
+ */
+static void BufferPoolBindNuma(BufferPoolLayout* layout)
+{
+    Size sys_page_size = (Size)sysconf(_SC_PAGESIZE);
+    int nbuffers = g_instance.attr.attr_storage.NBuffers;
+
+    for (int node = 0; node < layout->numaNodes; node++) {
+        int first = node * layout->buffersPerNode;
+        int last = Min(nbuffers, first + layout->buffersPerNode);
+
+        if (first >= last)
+            break;
+
+        numa_tonode_memory(layout->blocksAddr + (Size)first * BLCKSZ, (Size)(last - first) * BLCKSZ, node);
+
+        Size desc_start = TYPEALIGN(sys_page_size, (Size)first * sizeof(BufferDescPadded));
+        Size desc_end = Min(TYPEALIGN(sys_page_size, (Size)last * sizeof(BufferDescPadded)), layout->descsSize);
+        if (desc_start < desc_end)
+            numa_tonode_memory(layout->descsAddr + desc_start, desc_end - desc_start, node);
+    }
+}
+#endif
+
+/*
+ * BufferPoolUnmap
+ *
+ * Release the buffer pool mapping at shmem_exit, like the shared memory
+ * segment itself.
+ */
+static void BufferPoolUnmap(int code, Datum arg)
+{
+    BufferPoolLayout* layout = (BufferPoolLayout*)DatumGetPointer(arg);
+
+    if (layout->blocksAddr != NULL)
+        (void)munmap(layout->blocksAddr, layout->blocksSize);
+    if (layout->descsAddr != NULL)
+        (void)munmap(layout->descsAddr, layout->descsSize);
+    layout->blocksAddr = NULL;
+    layout->descsAddr = NULL;
+}
+
+/*
+ * BufferPoolLayoutInit
+ *
+ * Map the descriptors and pages of the buffer pool by themselves, and work
+ * out the per-node partitions.  Only called once, by the postmaster or a
+ * standalone backend.
+ */
+static void BufferPoolLayoutInit(BufferPoolLayout* layout)
+{
+    int nbuffers = g_instance.attr.attr_storage.NBuffers;
+    Size page_size;
+    Size unused;
+
+    layout->descsAddr = NULL;
+    layout->blocksAddr = NULL;
+    layout->numaNodes = 1;
+    layout->buffersPerNode = nbuffers;
+
+    if (!BufferPoolHasOwnMapping())
+        return;
+
+    /* descriptors stay on regular pages so they can be split at fine grain */
+    layout->descsAddr = BufferPoolMap(
+        "buffer descriptors", (Size)nbuffers * sizeof(BufferDescPadded), false, &layout->descsSize, &unused);
+    layout->blocksAddr =
+        BufferPoolMap("buffer blocks", (Size)nbuffers * BLCKSZ, true, &layout->blocksSize, &layout->blocksPageSize);
+    page_size = layout->blocksPageSize;
+
+    on_shmem_exit(BufferPoolUnmap, PointerGetDatum(layout));
+
+#ifdef __USE_NUMA
+    if (g_instance.shmem_cxt.numaNodeNum > 1 && g_instance.shmem_cxt.numaNodeNum <= BUFFER_NUMA_MAX_NODES) {
+        int nodes = g_instance.shmem_cxt.numaNodeNum;
+        /* a partition must start on a page boundary of the pages mapping */
+        int unit = (int)Max(page_size / BLCKSZ, 1);
+        int per_node = (nbuffers + nodes - 1) / nodes;
+
+        per_node = (int)TYPEALIGN(unit, per_node);
+        layout->numaNodes = nodes;
+        layout->buffersPerNode = per_node;
+        BufferPoolBindNuma(layout);
+    }
+#endif
+
+    ereport(LOG,
+        (errmsg("buffer pool mapped with %lu kB pages in %d NUMA partition(s) of %d buffers",
+            (unsigned long)(page_size / 1024),
+            layout->numaNodes,
+            layout->buffersPerNode)));
+}
+
 /*
  * Initialize shared buffer pool
  *
@@ -69,10 +292,21 @@ void InitBufferPool(void)
     bool found_bufs = false;
     bool found_descs = false;
     bool found_buf_ckpt = false;
+    bool found_layout = false;
+    BufferPoolLayout* layout = NULL;
 
-    t_thrd.storage_cxt.BufferDescriptors = (BufferDescPadded*)CACHELINEALIGN(ShmemInitStruct("Buffer Descriptors",
-        g_instance.attr.attr_storage.NBuffers * sizeof(BufferDescPadded) + PG_CACHE_LINE_SIZE,
-        &found_descs));
+    layout = (BufferPoolLayout*)ShmemInitStruct("Buffer Pool Layout", sizeof(BufferPoolLayout), &found_layout);
+    if (!found_layout)
+        BufferPoolLayoutInit(layout);
+
+    if (layout->descsAddr != NULL) {
+        t_thrd.storage_cxt.BufferDescriptors = (BufferDescPadded*)layout->descsAddr;
+        found_descs = found_layout;
+    } else {
+        t_thrd.storage_cxt.BufferDescriptors = (BufferDescPadded*)CACHELINEALIGN(ShmemInitStruct("Buffer Descriptors",
+            g_instance.attr.attr_storage.NBuffers * sizeof(BufferDescPadded) + PG_CACHE_LINE_SIZE,
+            &found_descs));
+    }
     /* full checkpoint mode only need one free list. */
     if (g_instance.attr.attr_storage.enableIncrementalCheckpoint) {
         InitBufFreeTable(NUM_BUFFER_FREE_LIST);
@@ -80,13 +314,18 @@ void InitBufferPool(void)
         InitBufFreeTable(1);
     }
 
+    if (layout->blocksAddr != NULL) {
+        t_thrd.storage_cxt.BufferBlocks = layout->blocksAddr;
+        found_bufs = found_layout;
+    } else {
 #ifdef __aarch64__
-    t_thrd.storage_cxt.BufferBlocks = (char*)CACHELINEALIGN(ShmemInitStruct(
-        "Buffer Blocks", g_instance.attr.attr_storage.NBuffers * (Size)BLCKSZ + PG_CACHE_LINE_SIZE, &found_bufs));
+        t_thrd.storage_cxt.BufferBlocks = (char*)CACHELINEALIGN(ShmemInitStruct(
+            "Buffer Blocks", g_instance.attr.attr_storage.NBuffers * (Size)BLCKSZ + PG_CACHE_LINE_SIZE, &found_bufs));
 #else
-    t_thrd.storage_cxt.BufferBlocks =
-        (char*)ShmemInitStruct("Buffer Blocks", g_instance.attr.attr_storage.NBuffers * (Size)BLCKSZ, &found_bufs);
+        t_thrd.storage_cxt.BufferBlocks =
+            (char*)ShmemInitStruct("Buffer Blocks", g_instance.attr.attr_storage.NBuffers * (Size)BLCKSZ, &found_bufs);
 #endif
+    }
 
     /*
      * The array used to sort to-be-checkpointed buffer ids is located in
@@ -146,6 +385,8 @@ void InitBufferPool(void)
 
     /* Init other shared buffer-management stuff */
     StrategyInitialize(!found_descs);
+    if (!found_descs)
+        StrategyInitNumaPartitions(layout->numaNodes, layout->buffersPerNode);
 
     /* Init Vector Buffer management stuff */
     DataCacheMgr::NewSingletonInstance();
@@ -167,15 +408,20 @@ Size BufferShmemSize(void)
 {
     Size size = 0;
 
-    /* size of buffer descriptors */
-    size = add_size(size, mul_size(g_instance.attr.attr_storage.NBuffers, sizeof(BufferDescPadded)));
-    size = add_size(size, PG_CACHE_LINE_SIZE);
+    size = add_size(size, MAXALIGN(sizeof(BufferPoolLayout)));
 
-    /* size of data pages */
-    size = add_size(size, mul_size(g_instance.attr.attr_storage.NBuffers, BLCKSZ));
+    /* descriptors and data pages mapped by themselves take no segment space */
+    if (!BufferPoolHasOwnMapping()) {
+        /* size of buffer descriptors */
+        size = add_size(size, mul_size(g_instance.attr.attr_storage.NBuffers, sizeof(BufferDescPadded)));
+        size = add_size(size, PG_CACHE_LINE_SIZE);
+
+        /* size of data pages */
+        size = add_size(size, mul_size(g_instance.attr.attr_storage.NBuffers, BLCKSZ));
 #ifdef __aarch64__
-    size = add_size(size, PG_CACHE_LINE_SIZE);
+        size = add_size(size, PG_CACHE_LINE_SIZE);
 #endif
+    }
     /* size of stuff controlled by freelist.c */
     size = add_size(size, StrategyShmemSize());
 
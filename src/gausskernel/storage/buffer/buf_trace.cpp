@@ -0,0 +1,405 @@
+/* -------------------------------------------------------------------------
+ *
+ * buf_trace.cpp
+ *	  buffer access traces and the replay benchmark of the replacement
+ *	  policies.
+ *
+ * A session can record the shared buffer lookups it makes into a trace
+ * file, one line "spcnode dbnode relnode bucketnode forknum blocknum" per
+ * lookup, the same as COPY ... TO writes for those six columns.  Lines are
+ * buffered in the session and written out a block at a time; a trace not
+ * finished with pg_buffer_trace_stop() misses its last lines.  A trace
+ * can then be replayed against a simulated pool of any size under every
+ * replacement policy, so that policies are compared on the same accesses
+ * without restarting the server.  The simulation uses the ghost table
+ * routines of freelist.cpp; pinning, dirty pages and strategy rings are
+ * not simulated.
+ *
+ * Portions Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ *
+ * IDENTIFICATION
+ *	  src/gausskernel/storage/buffer/buf_trace.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <fcntl.h>
+
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+#define BUFFER_TRACE_BUFSIZE BLCKSZ
+#define BUFFER_TRACE_LINE_MAX 96
+
+/* largest pool the replay benchmark simulates */
+#define BUFFER_REPLAY_MAX_BUFFERS (1 << 24)
+
+#define BUFFER_STATS_NATTS 6
+#define BUFFER_REPLAY_NATTS 7
+
+static const char* const replacement_policy_names[] = {"clock", "2q"};
+
+typedef struct ReplayBufferEnt {
+    BufferTag key;
+    int id;
+} ReplayBufferEnt;
+
+typedef struct ReplayResult {
+    int64 stats[BUFFER_STAT_NUM];
+} ReplayResult;
+
+static void BufferTraceFlush(void)
+{
+    knl_u_storage_context* storage_cxt = &u_sess->storage_cxt;
+    int len = storage_cxt->bufferTraceLen;
+
+    if (len == 0)
+        return;
+
+    storage_cxt->bufferTraceLen = 0;
+    if (FileWrite(storage_cxt->bufferTraceFile, storage_cxt->bufferTraceBuf, len, storage_cxt->bufferTraceOffset) !=
+        len) {
+        /* don't try again on every following lookup */
+        FileClose(storage_cxt->bufferTraceFile);
+        storage_cxt->bufferTraceFile = FILE_INVALID;
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not write buffer access trace: %m")));
+    }
+    storage_cxt->bufferTraceOffset += len;
+}
+
+/*
+ * BufferTraceRecord -- append a shared buffer lookup to the session's trace
+ */
+void BufferTraceRecord(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum)
+{
+    knl_u_storage_context* storage_cxt = &u_sess->storage_cxt;
+    const RelFileNode* rnode = &smgr->smgr_rnode.node;
+    int len;
+
+    if (storage_cxt->bufferTraceLen > BUFFER_TRACE_BUFSIZE - BUFFER_TRACE_LINE_MAX)
+        BufferTraceFlush();
+
+    len = snprintf_s(storage_cxt->bufferTraceBuf + storage_cxt->bufferTraceLen,
+        BUFFER_TRACE_BUFSIZE - storage_cxt->bufferTraceLen,
+        BUFFER_TRACE_LINE_MAX - 1,
+        "%u\t%u\t%u\t%d\t%d\t%u\n",
+        rnode->spcNode,
+        rnode->dbNode,
+        rnode->relNode,
+        rnode->bucketNode,
+        (int)forkNum,
+        blockNum);
+    securec_check_ss(len, "", "");
+    storage_cxt->bufferTraceLen += len;
+    storage_cxt->bufferTraceAccesses++;
+}
+
+/*
+ * pg_buffer_trace_start
+ *	  Record the shared buffer lookups of this session into a file.
+ */
+Datum pg_buffer_trace_start(PG_FUNCTION_ARGS)
+{
+    char* path = text_to_cstring(PG_GETARG_TEXT_PP(0));
+    knl_u_storage_context* storage_cxt = &u_sess->storage_cxt;
+    File file;
+
+    if (!superuser()) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE), errmsg("must be system admin to trace buffer accesses")));
+    }
+    if (storage_cxt->bufferTraceFile != FILE_INVALID) {
+        ereport(ERROR,
+            (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE), errmsg("buffer access trace is already running")));
+    }
+    if (!is_absolute_path(path)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_NAME), errmsg("relative path not allowed for buffer access trace")));
+    }
+
+    file = PathNameOpenFile(path, O_RDWR | O_CREAT | O_TRUNC | PG_BINARY, S_IRUSR | S_IWUSR);
+    if (file < 0) {
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not create file \"%s\": %m", path)));
+    }
+
+    if (storage_cxt->bufferTraceBuf == NULL) {
+        storage_cxt->bufferTraceBuf = (char*)MemoryContextAlloc(u_sess->top_mem_cxt, BUFFER_TRACE_BUFSIZE);
+    }
+    storage_cxt->bufferTraceOffset = 0;
+    storage_cxt->bufferTraceLen = 0;
+    storage_cxt->bufferTraceAccesses = 0;
+    storage_cxt->bufferTraceFile = file;
+
+    PG_RETURN_VOID();
+}
+
+/*
+ * pg_buffer_trace_stop
+ *	  Finish the trace of this session, returning the number of lookups
+ *	  it holds.
+ */
+Datum pg_buffer_trace_stop(PG_FUNCTION_ARGS)
+{
+    knl_u_storage_context* storage_cxt = &u_sess->storage_cxt;
+
+    if (storage_cxt->bufferTraceFile == FILE_INVALID) {
+        ereport(ERROR,
+            (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE), errmsg("buffer access trace is not running")));
+    }
+
+    BufferTraceFlush();
+    FileClose(storage_cxt->bufferTraceFile);
+    storage_cxt->bufferTraceFile = FILE_INVALID;
+
+    PG_RETURN_INT64(storage_cxt->bufferTraceAccesses);
+}
+
+/*
+ * pg_buffer_replacement_stats
+ *	  Report the counters of the replacement policy the server runs.
+ */
+Datum pg_buffer_replacement_stats(PG_FUNCTION_ARGS)
+{
+    TupleDesc tup_desc = CreateTemplateTupleDesc(BUFFER_STATS_NATTS, false);
+    Datum values[BUFFER_STATS_NATTS];
+    bool nulls[BUFFER_STATS_NATTS] = {false};
+    uint64 stats[BUFFER_STAT_NUM];
+    uint64 lookups;
+    int i = 0;
+
+    TupleDescInitEntry(tup_desc, (AttrNumber)1, "policy", TEXTOID, -1, 0);
+    TupleDescInitEntry(tup_desc, (AttrNumber)2, "hits", INT8OID, -1, 0);
+    TupleDescInitEntry(tup_desc, (AttrNumber)3, "misses", INT8OID, -1, 0);
+    TupleDescInitEntry(tup_desc, (AttrNumber)4, "evictions", INT8OID, -1, 0);
+    TupleDescInitEntry(tup_desc, (AttrNumber)5, "ghost_hits", INT8OID, -1, 0);
+    TupleDescInitEntry(tup_desc, (AttrNumber)6, "hit_ratio", FLOAT8OID, -1, 0);
+    tup_desc = BlessTupleDesc(tup_desc);
+
+    StrategyGetStats(stats);
+    lookups = stats[BUFFER_STAT_HITS] + stats[BUFFER_STAT_MISSES];
+
+    values[i++] = CStringGetTextDatum(
+        replacement_policy_names[g_instance.attr.attr_storage.buffer_replacement_policy]);
+    values[i++] = Int64GetDatum((int64)stats[BUFFER_STAT_HITS]);
+    values[i++] = Int64GetDatum((int64)stats[BUFFER_STAT_MISSES]);
+    values[i++] = Int64GetDatum((int64)stats[BUFFER_STAT_EVICTIONS]);
+    values[i++] = Int64GetDatum((int64)stats[BUFFER_STAT_GHOST_HITS]);
+    values[i++] = Float8GetDatum(lookups > 0 ? (double)stats[BUFFER_STAT_HITS] / lookups : 0.0);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tup_desc, values, nulls)));
+}
+
+/*
+ * Replay the trace in fp against a pool of nbuffers buffers run by policy.
+ * The sweep and the admission mirror StrategyGetBuffer() and BufferAlloc().
+ */
+static void ReplayBufferTrace(
+    FILE* fp, const char* path, int nbuffers, BufferReplacementPolicy policy, ReplayResult* result)
+{
+    HASHCTL hash_ctl;
+    HTAB* table = NULL;
+    BufferTag* tags = (BufferTag*)palloc(nbuffers * sizeof(BufferTag));
+    uint8* usage = (uint8*)palloc0(nbuffers * sizeof(uint8));
+    BufferGhostTable* ghost = NULL;
+    char line[BUFFER_TRACE_LINE_MAX];
+    int64 lineno = 0;
+    int nused = 0;
+    uint32 hand = 0;
+    errno_t rc;
+
+    rc = memset_s(&hash_ctl, sizeof(hash_ctl), 0, sizeof(hash_ctl));
+    securec_check(rc, "", "");
+    hash_ctl.keysize = sizeof(BufferTag);
+    hash_ctl.entrysize = sizeof(ReplayBufferEnt);
+    hash_ctl.hash = tag_hash;
+    hash_ctl.hcxt = CurrentMemoryContext;
+    table = hash_create("buffer replay table", nbuffers, &hash_ctl, HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    if (policy == BUFFER_REPLACEMENT_2Q) {
+        ghost = (BufferGhostTable*)palloc(BufferGhostTableSize((uint32)nbuffers));
+        BufferGhostTableInit(ghost, (uint32)nbuffers);
+    }
+
+    rc = memset_s(result, sizeof(ReplayResult), 0, sizeof(ReplayResult));
+    securec_check(rc, "", "");
+
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        RelFileNode rnode;
+        BufferTag tag;
+        int fork;
+        uint32 hashcode;
+        ReplayBufferEnt* entry = NULL;
+        int id;
+
+        lineno++;
+        if (sscanf_s(line, "%u %u %u %d %d %u", &rnode.spcNode, &rnode.dbNode, &rnode.relNode, &rnode.bucketNode,
+            &fork, &tag.blockNum) != 6 || fork < 0 || fork > MAX_FORKNUM) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                    errmsg("invalid buffer access trace line " INT64_FORMAT " in file \"%s\"", lineno, path)));
+        }
+        tag.rnode = rnode;
+        tag.forkNum = (ForkNumber)fork;
+
+        if ((lineno & 0xFFFF) == 0)
+            CHECK_FOR_INTERRUPTS();
+
+        hashcode = get_hash_value(table, &tag);
+        entry = (ReplayBufferEnt*)hash_search_with_hash_value(table, &tag, hashcode, HASH_FIND, NULL);
+        if (entry != NULL) {
+            result->stats[BUFFER_STAT_HITS]++;
+            if (usage[entry->id] < BM_MAX_USAGE_COUNT)
+                usage[entry->id]++;
+            continue;
+        }
+
+        result->stats[BUFFER_STAT_MISSES]++;
+        if (nused < nbuffers) {
+            /* the free list hands out unused buffers first */
+            id = nused++;
+        } else {
+            uint32 old_hashcode;
+
+            for (;;) {
+                id = (int)(hand++ % (uint32)nbuffers);
+                if (policy == BUFFER_REPLACEMENT_2Q && usage[id] != 0) {
+                    usage[id]--;
+                    continue;
+                }
+                break;
+            }
+
+            old_hashcode = get_hash_value(table, &tags[id]);
+            (void)hash_search_with_hash_value(table, &tags[id], old_hashcode, HASH_REMOVE, NULL);
+            result->stats[BUFFER_STAT_EVICTIONS]++;
+            if (ghost != NULL)
+                BufferGhostRemember(ghost, old_hashcode);
+        }
+
+        tags[id] = tag;
+        if (ghost == NULL) {
+            usage[id] = 1;
+        } else if (BufferGhostRefault(ghost, hashcode)) {
+            result->stats[BUFFER_STAT_GHOST_HITS]++;
+            usage[id] = BM_2Q_HOT_USAGE_COUNT;
+        } else {
+            usage[id] = BM_2Q_COLD_USAGE_COUNT;
+        }
+        entry = (ReplayBufferEnt*)hash_search_with_hash_value(table, &tag, hashcode, HASH_ENTER, NULL);
+        entry->id = id;
+    }
+
+    if (ferror(fp)) {
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not read file \"%s\": %m", path)));
+    }
+
+    hash_destroy(table);
+    pfree(tags);
+    pfree(usage);
+    if (ghost != NULL)
+        pfree(ghost);
+}
+
+/*
+ * pg_buffer_replacement_replay
+ *	  Replay a buffer access trace against a simulated pool of the given
+ *	  number of buffers under every replacement policy.
+ */
+Datum pg_buffer_replacement_replay(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    ReplayResult* results = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        char* path = text_to_cstring(PG_GETARG_TEXT_PP(0));
+        int nbuffers = PG_GETARG_INT32(1);
+        TupleDesc tup_desc = NULL;
+        MemoryContext old_context = NULL;
+        FILE* fp = NULL;
+
+        if (!superuser()) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                    errmsg("must be system admin to replay buffer access traces")));
+        }
+        if (nbuffers < 16 || nbuffers > BUFFER_REPLAY_MAX_BUFFERS) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                    errmsg("number of buffers must be between 16 and %d", BUFFER_REPLAY_MAX_BUFFERS)));
+        }
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tup_desc = CreateTemplateTupleDesc(BUFFER_REPLAY_NATTS, false);
+        TupleDescInitEntry(tup_desc, (AttrNumber)1, "policy", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)2, "accesses", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)3, "hits", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)4, "misses", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)5, "evictions", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)6, "ghost_hits", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)7, "hit_ratio", FLOAT8OID, -1, 0);
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+
+        fp = AllocateFile(path, "r");
+        if (fp == NULL) {
+            ereport(ERROR, (errcode_for_file_access(), errmsg("could not open file \"%s\": %m", path)));
+        }
+
+        results = (ReplayResult*)palloc(lengthof(replacement_policy_names) * sizeof(ReplayResult));
+        for (int i = 0; i < (int)lengthof(replacement_policy_names); i++) {
+            MemoryContext replay_context = AllocSetContextCreate(CurrentMemoryContext,
+                "buffer replay",
+                ALLOCSET_DEFAULT_MINSIZE,
+                ALLOCSET_DEFAULT_INITSIZE,
+                ALLOCSET_DEFAULT_MAXSIZE);
+            MemoryContext saved_context = MemoryContextSwitchTo(replay_context);
+
+            ReplayBufferTrace(fp, path, nbuffers, (BufferReplacementPolicy)i, &results[i]);
+            (void)MemoryContextSwitchTo(saved_context);
+            MemoryContextDelete(replay_context);
+        }
+        (void)FreeFile(fp);
+
+        func_ctx->user_fctx = (void*)results;
+        func_ctx->max_calls = lengthof(replacement_policy_names);
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    results = (ReplayResult*)func_ctx->user_fctx;
+
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        ReplayResult* result = &results[func_ctx->call_cntr];
+        int64 accesses = result->stats[BUFFER_STAT_HITS] + result->stats[BUFFER_STAT_MISSES];
+        Datum values[BUFFER_REPLAY_NATTS];
+        bool nulls[BUFFER_REPLAY_NATTS] = {false};
+        HeapTuple tuple = NULL;
+        int i = 0;
+
+        values[i++] = CStringGetTextDatum(replacement_policy_names[func_ctx->call_cntr]);
+        values[i++] = Int64GetDatum(accesses);
+        values[i++] = Int64GetDatum(result->stats[BUFFER_STAT_HITS]);
+        values[i++] = Int64GetDatum(result->stats[BUFFER_STAT_MISSES]);
+        values[i++] = Int64GetDatum(result->stats[BUFFER_STAT_EVICTIONS]);
+        values[i++] = Int64GetDatum(result->stats[BUFFER_STAT_GHOST_HITS]);
+        values[i++] = Float8GetDatum(accesses > 0 ? (double)result->stats[BUFFER_STAT_HITS] / accesses : 0.0);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(func_ctx);
+}
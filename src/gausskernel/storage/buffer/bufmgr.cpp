@@ -2068,6 +2068,8 @@ static Buffer ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumb
          * lookup the buffer.  IO_IN_PROGRESS is set if the requested block is
          * not currently in memory.
          */
+        if (u_sess->storage_cxt.bufferTraceFile != FILE_INVALID)
+            BufferTraceRecord(smgr, fork_num, block_num);
         buf_desc = BufferAlloc(smgr, relpersistence, fork_num, block_num, strategy, &found);
         if (found) {
             u_sess->instr_cxt.pg_buffer_usage->shared_blks_hit++;
@@ -2244,6 +2246,18 @@ static Buffer ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumb
     if (t_thrd.vacuum_cxt.VacuumCostActive)
         t_thrd.vacuum_cxt.VacuumCostBalance += u_sess->attr.attr_storage.VacuumCostPageMiss;
 
+    /*
+     * Charge the block to the IO token bucket of the resource pool.  Only
+     * reads of a bulk strategy may wait, the others must not be held back
+     * behind analytic scans; extension is never delayed since we hold the
+     * relation extension lock.
+     */
+    if (is_extend) {
+        IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_INTERACTIVE, 1);
+    } else if (mode != RBM_ZERO_AND_LOCK && mode != RBM_ZERO_AND_CLEANUP_LOCK) {
+        IOSchedulerConsumeTokens(IO_TYPE_READ, (strategy != NULL) ? IO_CLASS_BULK : IO_CLASS_INTERACTIVE, 1);
+    }
+
     TRACE_POSTGRESQL_BUFFER_READ_DONE(fork_num,
         block_num,
         smgr->smgr_rnode.node.spcNode,
@@ -2314,6 +2328,7 @@ static BufferDesc* BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumbe
         LWLockRelease(new_partition_lock);
 
         *found = TRUE;
+        StrategyRecordHit();
 
         if (!valid) {
             /*
@@ -2340,6 +2355,7 @@ static BufferDesc* BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumbe
      * buffer.	Remember to unlock the mapping lock while doing the work.
      */
     LWLockRelease(new_partition_lock);
+    StrategyRecordMiss();
 
     Dlelem *buf_elt = NULL;
     BufFreeListHash *buf_list_entry = NULL;
@@ -2567,7 +2583,8 @@ static BufferDesc* BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumbe
      * Clearing BM_VALID here is necessary, clearing the dirtybits is just
      * paranoia.  We also reset the usage_count since any recency of use of
      * the old content is no longer relevant.  (The usage_count starts out at
-     * 1 so that the buffer can survive one clock-sweep pass.)
+     * 1 so that the buffer can survive one clock-sweep pass, unless the
+     * replacement policy decides otherwise.)
      *
      * Make sure BM_PERMANENT is set for buffers that must be written at every
      * checkpoint.  Unlogged buffers only need to be written at shutdown
@@ -2579,14 +2596,16 @@ static BufferDesc* BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumbe
                    BUF_USAGECOUNT_MASK);
     if (relpersistence == RELPERSISTENCE_PERMANENT || fork_num == INIT_FORKNUM ||
         ((relpersistence == RELPERSISTENCE_TEMP) && STMT_RETRY_ENABLED)) {
-        buf_state |= BM_TAG_VALID | BM_PERMANENT | BUF_USAGECOUNT_ONE;
+        buf_state |= BM_TAG_VALID | BM_PERMANENT;
     } else {
-        buf_state |= BM_TAG_VALID | BUF_USAGECOUNT_ONE;
+        buf_state |= BM_TAG_VALID;
     }
+    buf_state += StrategyAdmitUsageCount(new_hash, strategy) * BUF_USAGECOUNT_ONE;
 
     UnlockBufHdr(buf, buf_state);
 
     if (old_flags & BM_TAG_VALID) {
+        StrategyRecordEviction(old_hash);
         BufTableDelete(&old_tag, old_hash);
         if (old_partition_lock != new_partition_lock) {
             LWLockRelease(old_partition_lock);
@@ -3959,6 +3978,9 @@ void CheckPointBuffers(int flags, bool doFullCheckpoint)
     }
     g_instance.ckpt_cxt_ctl->flush_all_dirty_page = false;
 
+    /* page images of the previous generation can be truncated after the sync below */
+    dw_switch_image_gen();
+
     /* When finish shutdown checkpoint, pagewriter thread can exit. */
     if (((uint32)flags & CHECKPOINT_IS_SHUTDOWN)) {
         g_instance.ckpt_cxt_ctl->page_writer_can_exit = true;
@@ -4169,6 +4191,9 @@ void FlushBuffer(void* buf, SMgrRelation reln, ReadBufferMethod flushmethod)
 
     u_sess->instr_cxt.pg_buffer_usage->shared_blks_written++;
 
+    /* the buffer is locked, so the write is charged but never delayed */
+    IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_INTERACTIVE, 1);
+
     /*
      * Mark the buffer as clean (unless BM_JUST_DIRTIED has become set) and
      * end the io_in_progress state.
@@ -28,6 +28,11 @@
 
 #define INT_ACCESS_ONCE(var) ((int)(*((volatile int*)&(var))))
 
+#define BUFFER_STAT_SLOTS 32
+
+/* events a thread counts locally before adding them to a shared slot */
+#define BUFFER_STAT_FOLD_EVERY 256
+
 /*
  * The shared freelist control information.
  */
@@ -54,8 +59,40 @@ typedef struct BufferStrategyControl {
      * StrategyNotifyBgWriter.
      */
     int bgwprocno;
+
+    /*
+     * When the buffer pool is partitioned per NUMA node, each node has a
+     * clock sweep hand of its own over its partition, so that a thread
+     * first looks for a victim in memory local to it.
+     */
+    int numaNodes;
+    int buffersPerNode;
+    struct {
+        pg_atomic_uint32 hand;
+        char pad[PG_CACHE_LINE_SIZE - sizeof(pg_atomic_uint32)];
+    } nodeVictimBuffer[BUFFER_NUMA_MAX_NODES];
+
+    /* recently evicted pages, only with the 2Q policy */
+    BufferGhostTable* ghost;
+
+    /*
+     * Hit/miss/eviction counters of the replacement policy.  Threads count
+     * in local memory and add their counts to one of several cache line
+     * sized slots every BUFFER_STAT_FOLD_EVERY events, so that counting
+     * hits costs no shared write on the lookup path.
+     */
+    struct {
+        pg_atomic_uint64 counters[BUFFER_STAT_NUM];
+        char pad[PG_CACHE_LINE_SIZE - BUFFER_STAT_NUM * sizeof(pg_atomic_uint64)];
+    } stats[BUFFER_STAT_SLOTS];
 } BufferStrategyControl;
 
+/* how many buffers of its own partition a thread looks at before the global sweep */
+#define NUMA_LOCAL_SWEEP_LIMIT 1024
+
+#define BufferReplacementIs2Q() \
+    (g_instance.attr.attr_storage.buffer_replacement_policy == BUFFER_REPLACEMENT_2Q)
+
 typedef struct
 {
     int64  retry_times;
@@ -77,6 +114,13 @@ void PageListBackWrite(uint32* bufList, int32 n,
     int32* bufs_reusable = NULL);     /* opt reusable count returned */
 static BufferDesc* getBufferFromFreeList(BufferAccessStrategy strategy, Dlelem **elt, uint32 *buf_state,
     BufFreeListHash **buf_list_entry);
+static BufferDesc* StrategyGetLocalNodeBuffer(BufferAccessStrategy strategy, uint32* buf_state);
+static inline void StrategyCountStat(BufferStrategyStat stat);
+static void StrategyFoldStats(void);
+
+/* counts of this thread not yet added to the shared counters */
+static THR_LOCAL uint32 pendingStats[BUFFER_STAT_NUM] = {0};
+static THR_LOCAL uint32 pendingStatEvents = 0;
 
 static void perform_delay(StrategyDelayStatus *status)
 {
@@ -237,6 +281,15 @@ BufferDesc* StrategyGetBuffer(BufferAccessStrategy strategy, uint32* buf_state,
         return buf;
     }
 
+    /* prefer a victim in the partition of our own NUMA node */
+    if (!am_standby) {
+        buf = StrategyGetLocalNodeBuffer(strategy, buf_state);
+        if (buf != NULL) {
+            gstrace_exit(GS_TRC_ID_StrategyGetBuffer);
+            return buf;
+        }
+    }
+
 retry:
     /* Nothing on the freelist, so run the "clock sweep" algorithm */
     if (am_standby)
@@ -262,7 +315,16 @@ retry:
         }
 
         retry_lock_status.retry_times = 0;
-        if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+        if (BufferReplacementIs2Q() && BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+            BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0) {
+            /*
+             * With the 2Q policy a buffer must have gone cold before it is
+             * recycled.  Age it and go on; since we changed its state, the
+             * sweep is not fruitless yet.
+             */
+            local_buf_state -= BUF_USAGECOUNT_ONE;
+            try_counter = max_buffer_can_use;
+        } else if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
             (!dw_page_writer_running() || !(local_buf_state & BM_DIRTY))) {
             /* Found a usable buffer */
             if (strategy != NULL)
@@ -388,6 +450,10 @@ Size StrategyShmemSize(void)
     /* size of the shared replacement strategy control block */
     size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+    /* the 2Q ghost table remembers as many evicted pages as there are buffers */
+    if (BufferReplacementIs2Q())
+        size = add_size(size, BufferGhostTableSize((uint32)g_instance.attr.attr_storage.NBuffers));
+
     return size;
 }
 
@@ -436,11 +502,243 @@ void StrategyInitialize(bool init)
 
         /* No pending notification */
         t_thrd.storage_cxt.StrategyControl->bgwprocno = -1;
+
+        /* A single partition until told otherwise */
+        t_thrd.storage_cxt.StrategyControl->numaNodes = 1;
+        t_thrd.storage_cxt.StrategyControl->buffersPerNode = g_instance.attr.attr_storage.NBuffers;
+
+        for (int i = 0; i < BUFFER_STAT_SLOTS; i++) {
+            for (int j = 0; j < BUFFER_STAT_NUM; j++)
+                pg_atomic_init_u64(&t_thrd.storage_cxt.StrategyControl->stats[i].counters[j], 0);
+        }
+
+        t_thrd.storage_cxt.StrategyControl->ghost = NULL;
+        if (BufferReplacementIs2Q()) {
+            uint32 nslots = (uint32)g_instance.attr.attr_storage.NBuffers;
+            BufferGhostTable* ghost =
+                (BufferGhostTable*)ShmemInitStruct("Buffer Ghost Table", BufferGhostTableSize(nslots), &found);
+
+            Assert(!found);
+            BufferGhostTableInit(ghost, nslots);
+            t_thrd.storage_cxt.StrategyControl->ghost = ghost;
+        }
     } else {
         Assert(!init);
     }
 }
 
+/*
+ * StrategyInitNumaPartitions -- set up the per-node clock sweep hands
+ *
+ * Buffers [n * buffers_per_node, (n + 1) * buffers_per_node) live on NUMA
+ * node n.  Only called by postmaster and only during initialization.
+ */
+void StrategyInitNumaPartitions(int numa_nodes, int buffers_per_node)
+{
+    BufferStrategyControl* control = t_thrd.storage_cxt.StrategyControl;
+
+    Assert(numa_nodes >= 1 && numa_nodes <= BUFFER_NUMA_MAX_NODES);
+    control->numaNodes = numa_nodes;
+    control->buffersPerNode = buffers_per_node;
+    for (int i = 0; i < BUFFER_NUMA_MAX_NODES; i++) {
+        pg_atomic_init_u32(&control->nodeVictimBuffer[i].hand, 0);
+    }
+}
+
+/*
+ * StrategyGetLocalNodeBuffer -- run a bounded clock sweep over the buffer
+ * partition of the NUMA node the current thread runs on.
+ *
+ * Returns NULL when the pool is not partitioned or nothing usable was found
+ * quickly; the caller then falls back to the global clock sweep.  Like that
+ * sweep, the buffer is returned with its header locked.
+ */
+static BufferDesc* StrategyGetLocalNodeBuffer(BufferAccessStrategy strategy, uint32* buf_state)
+{
+    BufferStrategyControl* control = t_thrd.storage_cxt.StrategyControl;
+    int node;
+    int first;
+    int nbuffers;
+    int tries;
+
+    if (control->numaNodes <= 1 || t_thrd.proc == NULL)
+        return NULL;
+
+    node = t_thrd.proc->nodeno;
+    if (node < 0 || node >= control->numaNodes)
+        return NULL;
+
+    first = node * control->buffersPerNode;
+    nbuffers = Min(g_instance.attr.attr_storage.NBuffers - first, control->buffersPerNode);
+    if (nbuffers <= 0)
+        return NULL;
+
+    tries = Min(nbuffers, NUMA_LOCAL_SWEEP_LIMIT);
+    while (tries-- > 0) {
+        uint32 victim = pg_atomic_fetch_add_u32(&control->nodeVictimBuffer[node].hand, 1);
+        BufferDesc* buf = GetBufferDescriptor(first + (int)(victim % (uint32)nbuffers));
+        uint32 local_buf_state;
+
+        /* don't wait on a busy header here, just move on */
+        if (!retryLockBufHdr(buf, &local_buf_state))
+            continue;
+
+        if (BufferReplacementIs2Q() && BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+            BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0) {
+            local_buf_state -= BUF_USAGECOUNT_ONE;
+        } else if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+            (!dw_page_writer_running() || !(local_buf_state & BM_DIRTY))) {
+            if (strategy != NULL)
+                AddBufferToRing(strategy, buf);
+            *buf_state = local_buf_state;
+            return buf;
+        }
+        UnlockBufHdr(buf, local_buf_state);
+    }
+
+    return NULL;
+}
+
+/*
+ * StrategyAdmitUsageCount -- usage count of a page BufferAlloc() is about
+ * to read into a buffer
+ *
+ * The clock policy starts every page at one.  The 2Q policy lets a page
+ * earn its place: pages not seen recently enter cold and are the next
+ * sweep's first victims unless they are referenced again, while pages
+ * that refault from the ghost table enter hot.  Pages read through a
+ * strategy ring always enter cold, the ring recycles them anyway.
+ */
+uint32 StrategyAdmitUsageCount(uint32 hashcode, BufferAccessStrategy strategy)
+{
+    BufferStrategyControl* control = t_thrd.storage_cxt.StrategyControl;
+
+    if (!BufferReplacementIs2Q())
+        return 1;
+
+    if (strategy == NULL && BufferGhostRefault(control->ghost, hashcode)) {
+        StrategyCountStat(BUFFER_STAT_GHOST_HITS);
+        return BM_2Q_HOT_USAGE_COUNT;
+    }
+
+    return BM_2Q_COLD_USAGE_COUNT;
+}
+
+void StrategyRecordHit(void)
+{
+    StrategyCountStat(BUFFER_STAT_HITS);
+}
+
+void StrategyRecordMiss(void)
+{
+    StrategyCountStat(BUFFER_STAT_MISSES);
+}
+
+/*
+ * StrategyRecordEviction -- BufferAlloc() replaced the page of the given
+ * buffer mapping hash code
+ */
+void StrategyRecordEviction(uint32 hashcode)
+{
+    StrategyCountStat(BUFFER_STAT_EVICTIONS);
+
+    if (BufferReplacementIs2Q())
+        BufferGhostRemember(t_thrd.storage_cxt.StrategyControl->ghost, hashcode);
+}
+
+/*
+ * StrategyGetStats -- sum up the policy counters into stats[BUFFER_STAT_NUM]
+ *
+ * Other threads may still hold up to BUFFER_STAT_FOLD_EVERY events each.
+ */
+void StrategyGetStats(uint64* stats)
+{
+    BufferStrategyControl* control = t_thrd.storage_cxt.StrategyControl;
+
+    StrategyFoldStats();
+
+    for (int j = 0; j < BUFFER_STAT_NUM; j++) {
+        stats[j] = 0;
+        for (int i = 0; i < BUFFER_STAT_SLOTS; i++)
+            stats[j] += pg_atomic_read_u64(&control->stats[i].counters[j]);
+    }
+}
+
+static inline void StrategyCountStat(BufferStrategyStat stat)
+{
+    pendingStats[stat]++;
+    if (++pendingStatEvents >= BUFFER_STAT_FOLD_EVERY)
+        StrategyFoldStats();
+}
+
+/* add the counts of this thread to its shared slot */
+static void StrategyFoldStats(void)
+{
+    int slot = (t_thrd.proc != NULL) ? t_thrd.proc->pgprocno % BUFFER_STAT_SLOTS : 0;
+
+    for (int i = 0; i < BUFFER_STAT_NUM; i++) {
+        if (pendingStats[i] > 0) {
+            (void)pg_atomic_fetch_add_u64(
+                &t_thrd.storage_cxt.StrategyControl->stats[slot].counters[i], pendingStats[i]);
+            pendingStats[i] = 0;
+        }
+    }
+    pendingStatEvents = 0;
+}
+
+/* ----------------------------------------------------------------
+ *				Ghost table of the 2Q policy
+ *
+ * A slot holds the buffer mapping hash code of an evicted page in its high
+ * half and the value of the eviction counter at that time in its low half.
+ * Pages whose hash codes collide in a slot simply overwrite each other, and
+ * a false refault needs two pages with the same 32-bit hash code, so the
+ * table never needs a lock.  The replay benchmark uses the same routines on
+ * a table in local memory.
+ * ----------------------------------------------------------------
+ */
+Size BufferGhostTableSize(uint32 nslots)
+{
+    return add_size(offsetof(BufferGhostTable, slots), mul_size(nslots, sizeof(pg_atomic_uint64)));
+}
+
+void BufferGhostTableInit(BufferGhostTable* ghost, uint32 nslots)
+{
+    Assert(nslots > 0);
+    pg_atomic_init_u64(&ghost->evictions, 0);
+    ghost->nslots = nslots;
+    for (uint32 i = 0; i < nslots; i++)
+        pg_atomic_init_u64(&ghost->slots[i], 0);
+}
+
+void BufferGhostRemember(BufferGhostTable* ghost, uint32 hashcode)
+{
+    uint64 now = pg_atomic_fetch_add_u64(&ghost->evictions, 1);
+
+    pg_atomic_write_u64(&ghost->slots[hashcode % ghost->nslots], ((uint64)hashcode << 32) | (uint32)now);
+}
+
+/*
+ * BufferGhostRefault -- is the page of this hash code one evicted less than
+ * nslots evictions ago?  A refault consumes the ghost entry.
+ */
+bool BufferGhostRefault(BufferGhostTable* ghost, uint32 hashcode)
+{
+    pg_atomic_uint64* slot = &ghost->slots[hashcode % ghost->nslots];
+    uint64 entry = pg_atomic_read_u64(slot);
+    uint32 distance;
+
+    if (entry == 0 || (uint32)(entry >> 32) != hashcode)
+        return false;
+
+    /* the counter wraps in the low half, so does the distance */
+    distance = (uint32)pg_atomic_read_u64(&ghost->evictions) - (uint32)entry;
+    if (distance > ghost->nslots)
+        return false;
+
+    return pg_atomic_compare_exchange_u64(slot, &entry, 0);
+}
+
 /* ----------------------------------------------------------------
  *				Backend-private buffer ring management
  * ----------------------------------------------------------------
@@ -366,6 +366,8 @@ void CUStorage::SaveCU(char* write_buf, _in_ uint64 offset, _in_ int size, bool
         }
         Assert(m_fd != FILE_INVALID);
 
+        IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, (write_size + BLCKSZ - 1) / BLCKSZ);
+
         int writtenBytes = FilePWrite(m_fd, write_buf, write_size, writeOffset);
         if (writtenBytes != write_size) {
             SaveCUReportIOError(tmpFileName, writeOffset, writtenBytes, write_size, size);
@@ -416,6 +418,8 @@ void CUStorage::OverwriteCU(
             ereport(ERROR, (errcode_for_file_access(), errmsg("could not open file \"%s\": %m", tmpFileName)));
         }
 
+        IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, (write_size + BLCKSZ - 1) / BLCKSZ);
+
         int nbytes = 0;
         if ((nbytes = FilePWrite(m_fd, write_buf, write_size, writeOffset)) != write_size) {
             // just warning
@@ -463,6 +467,8 @@ void CUStorage::Load(_in_ uint64 offset, _in_ int size, __inout char* outbuf, bo
             securec_check_c(rc, "\0", "\0");
         }
 
+        IOSchedulerConsumeTokens(IO_TYPE_READ, IO_CLASS_BULK, (read_size + BLCKSZ - 1) / BLCKSZ);
+
         int nbytes = FilePRead(m_fd, read_buf, read_size, readOffset);
         if (nbytes != read_size) {
             LoadCUReportIOError(tmpFileName, readOffset, nbytes, read_size, size);
@@ -525,6 +531,7 @@ int CUStorage::WSLoad(_in_ uint64 offset, _in_ int size, __inout char* outbuf, b
         /* IO collector and IO scheduler for cstore insert */
         if (ENABLE_WORKLOAD_CONTROL)
             IOSchedulerAndUpdate(IO_TYPE_READ, 1, IO_TYPE_COLUMN);
+        IOSchedulerConsumeTokens(IO_TYPE_READ, IO_CLASS_BULK, (read_size + BLCKSZ - 1) / BLCKSZ);
 
         if ((nbytes = FilePRead(m_fd, read_buf, read_size, readOffset)) != read_size) {
             if (0 == nbytes) {
@@ -21,6 +21,7 @@
  * ---------------------------------------------------------------------------------------
  */
 #include "obs/obs_connector.h"
+#include "local/local_connector.h"
 #include "foreign/foreign.h"
 #include "c.h"
 namespace dfs {
@@ -39,6 +40,9 @@ DFSConnector *createConnector(MemoryContext ctx, Oid foreignTableId)
         case T_TXT_CSV_OBS_SERVER: {
             return New(ctx) OBSConnector(ctx, foreignTableId);
         }
+        case T_LOCAL_SERVER: {
+            return New(ctx) LocalConnector(ctx, foreignTableId);
+        }
         case T_HDFS_SERVER: {
             FEATURE_NOT_PUBLIC_ERROR("HDFS is not yet supported.");
             return NULL;
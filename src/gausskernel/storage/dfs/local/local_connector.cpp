@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ *  local_connector.cpp
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/dfs/local/local_connector.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "local_connector.h"
+#include "foreign/foreign.h"
+#include "pgxc/locator.h"
+#include "storage/fd.h"
+#include "utils/memutils.h"
+
+#define LOCAL_NOT_IMPLEMENT                                                                  \
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmodule(MOD_DFS),              \
+                    errmsg("%s not implemented for the local file system", __FUNCTION__)));
+
+namespace dfs {
+/*
+ * @Description: build the path of a directory entry, without doubling the slash
+ *      when the directory path already ends with one.
+ */
+static char *joinLocalPath(const char *dir, const char *name)
+{
+    StringInfoData path;
+    size_t len = strlen(dir);
+
+    initStringInfo(&path);
+    if (len > 0 && dir[len - 1] == '/') {
+        appendStringInfo(&path, "%s%s", dir, name);
+    } else {
+        appendStringInfo(&path, "%s/%s", dir, name);
+    }
+
+    return path.data;
+}
+
+static SplitInfo *makeLocalSplit(const char *filePath, int64 size, int slashNum)
+{
+    SplitInfo *splitinfo = makeNode(SplitInfo);
+    const char *fileName = last_dir_separator(filePath);
+
+    splitinfo->filePath = pstrdup(filePath);
+    splitinfo->fileName = pstrdup(fileName != NULL ? fileName + 1 : filePath);
+    splitinfo->ObjectSize = size;
+    splitinfo->prefixSlashNum = slashNum;
+
+    return splitinfo;
+}
+
+LocalConnector::LocalConnector(MemoryContext ctx, Oid foreignTableId) : m_memcontext(ctx), m_fd(-1)
+{
+}
+
+LocalConnector::~LocalConnector()
+{
+    Destroy();
+}
+
+void LocalConnector::Destroy()
+{
+    closeCurrentFile();
+}
+
+/*
+ * @Description: is file
+ * @IN filePath: file path
+ * @Return: true for file, false for directory
+ * @See also:
+ */
+bool LocalConnector::isDfsFile(const char *filePath)
+{
+    return this->isDfsFile(filePath, true);
+}
+
+bool LocalConnector::isDfsFile(const char *filePath, bool throw_error)
+{
+    struct stat st;
+
+    Assert(filePath);
+
+    if (stat(filePath, &st) != 0) {
+        if (throw_error) {
+            ereport(ERROR, (errcode_for_file_access(), errmodule(MOD_DFS),
+                            errmsg("could not stat file \"%s\": %m", filePath)));
+        }
+        return false;
+    }
+
+    return S_ISREG(st.st_mode);
+}
+
+bool LocalConnector::isDfsEmptyFile(const char *filePath)
+{
+    struct stat st;
+
+    Assert(filePath);
+
+    if (stat(filePath, &st) != 0) {
+        ereport(ERROR, (errcode_for_file_access(), errmodule(MOD_DFS),
+                        errmsg("could not stat file \"%s\": %m", filePath)));
+    }
+
+    return S_ISREG(st.st_mode) && st.st_size == 0;
+}
+
+int64_t LocalConnector::getFileSize(const char *filePath)
+{
+    struct stat st;
+
+    if (stat(filePath, &st) != 0) {
+        return -1;
+    }
+
+    return (int64_t)st.st_size;
+}
+
+void *LocalConnector::getHandler() const
+{
+    return NULL;
+}
+
+List *LocalConnector::listDirectory(char *folderPath)
+{
+    return this->listDirectory(folderPath, true);
+}
+
+List *LocalConnector::listDirectory(char *folderPath, bool throw_error)
+{
+    List *entryList = NIL;
+    struct dirent *de = NULL;
+
+    AutoContextSwitch memGuard(m_memcontext);
+
+    DIR *dir = AllocateDir(folderPath);
+    if (dir == NULL) {
+        if (throw_error) {
+            ereport(ERROR, (errcode_for_file_access(), errmodule(MOD_DFS),
+                            errmsg("could not open directory \"%s\": %m", folderPath)));
+        }
+        return NIL;
+    }
+
+    while ((de = ReadDir(dir, folderPath)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+            continue;
+        }
+        entryList = lappend(entryList, joinLocalPath(folderPath, de->d_name));
+    }
+    FreeDir(dir);
+
+    return entryList;
+}
+
+/*
+ * @Description: walk the directory and append the splits of the non-empty regular files.
+ *     Symbolic links to directories are not followed.
+ * @IN path: the directory to walk
+ * @IN slashNum: the number of slashes of the folder defined by the foreign table
+ * @IN/OUT objectList: the list of splits
+ */
+void LocalConnector::listFilesRecursively(const char *path, int slashNum, List **objectList)
+{
+    struct dirent *de = NULL;
+    DIR *dir = AllocateDir(path);
+
+    if (dir == NULL) {
+        ereport(ERROR, (errcode_for_file_access(), errmodule(MOD_DFS),
+                        errmsg("could not open directory \"%s\": %m", path)));
+    }
+
+    while ((de = ReadDir(dir, path)) != NULL) {
+        struct stat st;
+
+        CHECK_FOR_INTERRUPTS();
+
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0 || checkFileShouldSkip(de->d_name)) {
+            continue;
+        }
+
+        char *entryPath = joinLocalPath(path, de->d_name);
+        if (lstat(entryPath, &st) != 0) {
+            ereport(ERROR, (errcode_for_file_access(), errmodule(MOD_DFS),
+                            errmsg("could not stat file \"%s\": %m", entryPath)));
+        }
+
+        /*
+         * Follow links to files only: a link to a directory may lead back
+         * to one of its parents, and the walk would never end.
+         */
+        if (S_ISLNK(st.st_mode) && (stat(entryPath, &st) != 0 || S_ISDIR(st.st_mode))) {
+            ereport(DEBUG1, (errmodule(MOD_DFS),
+                             errmsg("list local file, skipped symbolic link, path is %s", entryPath)));
+            pfree(entryPath);
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            listFilesRecursively(entryPath, slashNum, objectList);
+        } else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            *objectList = lappend(*objectList, makeLocalSplit(entryPath, (int64)st.st_size, slashNum));
+        } else {
+            ereport(DEBUG1, (errmodule(MOD_DFS), errmsg("list local file, skipped, path is %s, size is %ld",
+                                                        entryPath, (long)st.st_size)));
+        }
+        pfree(entryPath);
+    }
+    FreeDir(dir);
+}
+
+List *LocalConnector::listObjectsStat(char *searchPath, const char *primitivePrefix)
+{
+    Assert(searchPath != NULL);
+
+    struct stat st;
+    List *objectList = NIL;
+    const char *prefix = (primitivePrefix != NULL) ? primitivePrefix : searchPath;
+    size_t prefixLen = strlen(prefix);
+
+    /*
+     * The partition values are taken from the directories after the
+     * prefixSlashNum-th slash, so count the slash ending the prefix even
+     * if the user did not write it.
+     */
+    int slashNum = getSpecialCharCnt(prefix, '/');
+    if (prefixLen > 0 && prefix[prefixLen - 1] != '/') {
+        slashNum++;
+    }
+
+    AutoContextSwitch memGuard(m_memcontext);
+
+    /* The partition directory built by the pruning may not exist at all. */
+    if (stat(searchPath, &st) != 0) {
+        ereport(LOG, (errmodule(MOD_DFS), errmsg("Do not find any file for \"%s\".", searchPath)));
+        return NIL;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        listFilesRecursively(searchPath, slashNum, &objectList);
+    } else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        objectList = lappend(objectList, makeLocalSplit(searchPath, (int64)st.st_size, slashNum));
+    }
+
+    ereport(DEBUG1, (errmodule(MOD_DFS),
+                     errmsg("listObjectsStat \"%s\", objectListSize = %d", searchPath, list_length(objectList))));
+
+    return objectList;
+}
+
+DFSBlockInfo *LocalConnector::getBlockLocations(char *filePath)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return NULL;
+}
+
+int LocalConnector::dropDirectory(const char *path, int recursive)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return 0;
+}
+
+int LocalConnector::createDirectory(const char *path)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return 0;
+}
+
+int LocalConnector::openFile(const char *path, int flag)
+{
+    /* The local foreign tables are read only. */
+    if (flag != O_RDONLY) {
+        LOCAL_NOT_IMPLEMENT;
+    }
+
+    closeCurrentFile();
+    m_fd = OpenTransientFile((FileName)path, O_RDONLY | PG_BINARY, 0);
+
+    return (m_fd < 0) ? -1 : 0;
+}
+
+int LocalConnector::deleteFile(const char *path, int recursive)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return -1;
+}
+
+bool LocalConnector::pathExists(const char *filePath)
+{
+    struct stat st;
+
+    return stat(filePath, &st) == 0;
+}
+
+bool LocalConnector::existsFile(const char *path)
+{
+    struct stat st;
+
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool LocalConnector::hasValidFile() const
+{
+    return m_fd >= 0;
+}
+
+int LocalConnector::writeCurrentFile(const char *buffer, int length)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return -1;
+}
+
+int LocalConnector::readCurrentFileFully(char *buffer, int length, int64 offset)
+{
+    int total = 0;
+
+    if (m_fd < 0) {
+        return -1;
+    }
+
+    while (total < length) {
+        ssize_t nread = pread(m_fd, buffer + total, (size_t)(length - total), (off_t)(offset + total));
+        if (nread < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nread <= 0) {
+            return -1;
+        }
+        total += (int)nread;
+    }
+
+    return 0;
+}
+
+int LocalConnector::flushCurrentFile()
+{
+    return 0;
+}
+
+void LocalConnector::closeCurrentFile()
+{
+    if (m_fd >= 0) {
+        (void)CloseTransientFile(m_fd);
+        m_fd = -1;
+    }
+}
+
+int LocalConnector::chmod(const char *filePath, short mode)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return 1;
+}
+
+int LocalConnector::setLabelExpression(const char *filePath, const char *expression)
+{
+    LOCAL_NOT_IMPLEMENT;
+    return 1;
+}
+
+/*
+ * @Description: get file modify time
+ * @IN filePath:file path
+ * @Return: file modify time in seconds, 0 if the file does not exist
+ * @See also:
+ */
+int64 LocalConnector::getLastModifyTime(const char *filePath)
+{
+    struct stat st;
+
+    if (stat(filePath, &st) != 0) {
+        return 0;
+    }
+
+    return (int64)st.st_mtime;
+}
+
+const char *LocalConnector::getValue(const char *key, const char *defValue) const
+{
+    return defValue;
+}
+
+/*
+ * @Description: get connector type
+ * @Return:connector type
+ * @See also:
+ */
+int LocalConnector::getType()
+{
+    return (int)LOCAL_CONNECTOR;
+}
+}  // namespace dfs
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * local_connector.h
+ *        Connector for the foreign tables whose files are on the local file system.
+ *
+ * The data files are read through dfs::InputStreamFactory, which maps them
+ * into memory, so the connector only has to answer the questions of the
+ * scheduler about paths, sizes and directory contents.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/dfs/local/local_connector.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#ifndef LOCAL_CONNECTOR_H
+#define LOCAL_CONNECTOR_H
+
+#include "storage/dfs/dfs_connector.h"
+
+namespace dfs {
+class LocalConnector : public DFSConnector {
+public:
+    LocalConnector(MemoryContext ctx, Oid foreignTableId);
+    virtual ~LocalConnector();
+    void Destroy();
+
+private:
+    /*
+     * Check if the path is a regular file, log error if the path does not
+     * exist.
+     * @_in param filePath: the path of the file/directory.
+     * @return Return true: the path is a file; false: the path is not a file but a directory.
+     */
+    virtual bool isDfsFile(const char *filePath);
+    virtual bool isDfsFile(const char *filePath, bool throw_error);
+
+    /* Check if the path is a empty file, log error if the path does not exist. */
+    virtual bool isDfsEmptyFile(const char *filePath);
+
+    /*
+     * Get the file size of the path. Return -1 if the path does not exist.
+     * @_in_param filePath: the path of the file/directory
+     * @return Return the size.
+     */
+    virtual int64_t getFileSize(const char *filePath);
+
+    /* There is no handler for the local file system. */
+    virtual void *getHandler() const;
+
+    /*
+     * Get list of files/directories for a given directory-path.
+     * @_in_param folderPath: The path of the directory.
+     * @return Return a list of filepath. Return NULL on error.
+     */
+    virtual List *listDirectory(char *folderPath);
+    virtual List *listDirectory(char *folderPath, bool throw_error);
+
+    /*
+     * Get the splits of all the non-empty files under searchPath, or of
+     * searchPath itself if it is a file. The directories are walked
+     * recursively and the names starting with '.', '_', '#' or ending
+     * with '~' are skipped.
+     * @_in_param searchPath: The file or directory to list.
+     * @_in_param primitivePrefix: The folder defined by the foreign table, the
+     *      partition directories start after it.
+     * @return Return a list of SplitInfo.
+     */
+    virtual List *listObjectsStat(char *searchPath, const char *primitivePrefix = NULL);
+
+    virtual DFSBlockInfo *getBlockLocations(char *filePath);
+    virtual int dropDirectory(const char *path, int recursive);
+    virtual int createDirectory(const char *path);
+
+    /*
+     * Open the file using the given path, only O_RDONLY is supported.
+     * return Returns 0 on success, -1 on error.
+     */
+    virtual int openFile(const char *path, int flag);
+
+    virtual int deleteFile(const char *path, int recursive);
+
+    /*
+     * pathExists - Checks if a given path exsits on the filesystem
+     * @param path The path to look for
+     * @return Returns true if the path exists.
+     */
+    virtual bool pathExists(const char *filePath);
+
+    virtual bool existsFile(const char *path);
+
+    /*
+     * check if the current connector has a opened file.
+     * @return true if the file handler is valid, false on invalid.
+     */
+    virtual bool hasValidFile() const;
+
+    virtual int writeCurrentFile(const char *buffer, int length);
+
+    /*
+     * Read fixed size from the offset of the file into the buffer.
+     * @_out_param buffer: The buffer to be filled.
+     * @_in_param length: The size of bytes expected.
+     * @_in_param offset: The offset at which the reading starts.
+     * @return 0 on success, -1 on error.
+     */
+    virtual int readCurrentFileFully(char *buffer, int length, int64 offset);
+
+    virtual int flushCurrentFile();
+    virtual void closeCurrentFile();
+    virtual int chmod(const char *filePath, short mode);
+    virtual int setLabelExpression(const char *filePath, const char *expression);
+
+    /*
+     * Get the timestamp of the last modification.
+     */
+    virtual int64 getLastModifyTime(const char *filePath);
+
+    virtual const char *getValue(const char *key, const char *defValue) const;
+
+    /*
+     * Get connection type
+     */
+    virtual int getType();
+
+    void listFilesRecursively(const char *path, int slashNum, List **objectList);
+
+private:
+    MemoryContext m_memcontext;
+
+    /* The file opened by openFile. */
+    int m_fd;
+};
+}  // namespace dfs
+#endif
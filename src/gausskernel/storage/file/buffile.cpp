@@ -44,6 +44,7 @@
 #include "storage/buf_internals.h"
 #include "utils/aiomem.h"
 #include "utils/resowner.h"
+#include "workload/workload.h"
 
 /*
  * We break BufFiles into gigabyte-sized segments, regardless of RELSEG_SIZE.
@@ -290,6 +291,9 @@ static void BufFileLoadBuffer(BufFile* file)
     file->offsets[file->curFile] += file->nbytes;
     /* we choose not to advance curOffset here */
     u_sess->instr_cxt.pg_buffer_usage->temp_blks_read++;
+
+    /* temp files belong to sorts and hashes of analytic queries */
+    IOSchedulerConsumeTokens(IO_TYPE_READ, IO_CLASS_BULK, 1);
 }
 
 /*
@@ -353,6 +357,8 @@ static void BufFileDumpBuffer(BufFile* file)
     }
     file->dirty = false;
 
+    IOSchedulerConsumeTokens(IO_TYPE_WRITE, IO_CLASS_BULK, 1);
+
     /*
      * At this point, curOffset has been advanced to the end of the buffer,
      * ie, its original value + nbytes.  We need to make it point to the
@@ -70,6 +70,9 @@ extern void pq_close(int code, Datum arg);
 extern void AtProcExit_Files(int code, Datum arg);
 extern void audit_processlogout(int code, Datum arg);
 extern void CancelAutoAnalyze();
+#ifdef ENABLE_LLVM_COMPILE
+extern void plpgsql_codegen_cleanup_session(int code, Datum arg);
+#endif
 
 static const pg_on_exit_callback on_sess_exit_list[] = {
     ShutdownPostgres,
@@ -77,6 +80,9 @@ static const pg_on_exit_callback on_sess_exit_list[] = {
     // must come after ShutdownPostgres(), in case there is abort/rollback callback
     // must come after PGXCNodeCleanAndRelease(), due to prepared statement cleanup (which cleans also all session JIT context objects)
     MOTCleanupSession, 
+#ifdef ENABLE_LLVM_COMPILE
+    plpgsql_codegen_cleanup_session,
+#endif
     pq_close,
     AtProcExit_Files,
     audit_processlogout
@@ -3614,13 +3614,14 @@ typedef struct _ref_cnt {
 #ifdef __aarch64__
 
 /* the offset of ref_cnt in the struct _snapxid. */
-#define REF_CNT_OFFSET 36
+#define REF_CNT_OFFSET 44
 
 typedef struct _snapxid {
     TransactionId xmin;
     TransactionId xmax;
     CommitSeqNo snapshotcsn;
     TransactionId localxmin; /* the latest xmin in local node, update at transaction end. */
+    uint64 version;          /* number of snapshots computed before this one, 0 while being filled */
     bool takenDuringRecovery;
     char padding[PG_CACHE_LINE_SIZE - REF_CNT_OFFSET];
 } snapxid_t;
@@ -3632,6 +3633,7 @@ typedef struct _snapxid {
     TransactionId xmax;
     CommitSeqNo snapshotcsn;
     TransactionId localxmin; /* the latest xmin in local node, update at transaction end. */
+    uint64 version;          /* number of snapshots computed before this one, 0 while being filled */
     bool takenDuringRecovery;
     ref_cnt_t ref_cnt[NREFCNT];
 } snapxid_t;
@@ -3645,9 +3647,11 @@ static snapxid_t* g_snap_buffer = NULL;       /* the ring buffer for snapxids */
 static snapxid_t* g_snap_buffer_copy = NULL;  /* the ring buffer for AtProcExit */
 static size_t g_bufsz = 0;
 static bool g_snap_assigned = false;  /* true if current snap valid */
+static uint64 g_snap_version = 0;     /* bumped under ProcArrayLock for every new snapshot */
 
 #define SNAP_SZ sizeof(snapxid_t)  /* size of snapxid_t */
 #define MaxNumSnapVersion 64       /* max version number */
+#define SNAPXID_COPY_RETRIES 2     /* lock-free copies tried before taking a reference */
 
 /*
  * get pointer to snapxid_t entry in specified index in ring buffer
@@ -3843,25 +3847,85 @@ static void ReleaseSnapXid(snapxid_t* snapshot)
     DecrRefCount(snapshot);
 }
 
+/*
+ * Copy the current snapxid without taking a reference on it, so that taking
+ * a snapshot only reads shared memory.  A slot is rewritten only once it is no
+ * longer the current one and every rewrite gives it a new version, so the copy
+ * is good if the slot is still current with the same version afterwards.
+ *
+ * Our xmin must be advertised before that check: a snapshot computed later
+ * finds it in the proc array, and one being computed concurrently starts from
+ * the xmin of the current slot, so the horizon never passes the copied xmin.
+ */
+static bool CopyCurrentSnapXid(snapxid_t* copy)
+{
+    snapxid_t* snapxid = (snapxid_t*)g_snap_current;
+    bool xminSet = false;
+
+    copy->version = snapxid->version;
+    pg_read_barrier();
+    copy->xmin = snapxid->xmin;
+    copy->xmax = snapxid->xmax;
+    copy->snapshotcsn = snapxid->snapshotcsn;
+    copy->localxmin = snapxid->localxmin;
+    copy->takenDuringRecovery = snapxid->takenDuringRecovery;
+
+    /* the slot is being filled for the next snapshot */
+    if (copy->version == 0) {
+        return false;
+    }
+
+    if (!TransactionIdIsValid(t_thrd.pgxact->xmin)) {
+        t_thrd.pgxact->xmin = copy->xmin;
+        xminSet = true;
+    }
+    pg_memory_barrier();
+
+    if (g_snap_current == snapxid && snapxid->version == copy->version) {
+        return true;
+    }
+
+    if (xminSet) {
+        t_thrd.pgxact->xmin = InvalidTransactionId;
+    }
+    return false;
+}
+
 Snapshot GetLocalSnapshotData(Snapshot snapshot)
 {
+    snapxid_t copy;
+    snapxid_t* snapxid = NULL;
+
     /* if first here, fallback to original code */
     if (!g_snap_assigned || (g_snap_buffer == NULL)) {
         ereport(DEBUG1, (errmsg("Falling back to origin GetSnapshotData: not assigned yet or during shutdown\n")));
         return NULL;
     }
     pg_read_barrier();
-    /* 1. increase ref-count of current snapshot in ring buffer */
-    snapxid_t* snapxid = GetCurrentSnapXid();
-    /* save use_data for release */
-    snapshot->user_data = snapxid;
+
+    /*
+     * 1. copy the current snapshot in ring buffer, if it keeps changing under
+     * us because of the commits, increase its ref-count instead.
+     */
+    bool hadXmin = TransactionIdIsValid(t_thrd.pgxact->xmin);
+    for (int i = 0; i < SNAPXID_COPY_RETRIES; i++) {
+        if (CopyCurrentSnapXid(&copy)) {
+            snapxid = &copy;
+            break;
+        }
+    }
+    if (snapxid == NULL) {
+        snapxid = GetCurrentSnapXid();
+        /* save use_data for release */
+        snapshot->user_data = snapxid;
+    }
 
     /* 2. copy from pre-computed snapshot arrays into return param snapshot */
     snapshot->takenDuringRecovery = snapxid->takenDuringRecovery;
 
     TransactionId replication_slot_xmin = g_instance.proc_array_idx->replication_slot_xmin;
 
-    if (!TransactionIdIsValid(t_thrd.pgxact->xmin)) {
+    if (!hadXmin) {
         t_thrd.pgxact->xmin = u_sess->utils_cxt.TransactionXmin = snapxid->xmin;
         t_thrd.pgxact->handle = GetCurrentTransactionHandleIfAny();
     }
@@ -4125,11 +4189,17 @@ void CalculateLocalLatestSnapshot(bool forceCalc)
         }
     }
 
+    /* readers copying this slot without a reference must notice the rewrite */
+    snapxid->version = 0;
+    pg_write_barrier();
     snapxid->xmin = t_thrd.xact_cxt.ShmemVariableCache->xmin;
     snapxid->xmax = xmax;
     snapxid->localxmin = t_thrd.xact_cxt.ShmemVariableCache->recentLocalXmin;
     snapxid->snapshotcsn = t_thrd.xact_cxt.ShmemVariableCache->nextCommitSeqNo;
     snapxid->takenDuringRecovery = RecoveryInProgress();
+    pg_write_barrier();
+    snapxid->version = ++g_snap_version;
+    pg_write_barrier();
 
     ereport(DEBUG1, (errmsg("Generated snapshot in ring buffer slot %lu\n", SNAPXID_INDEX(snapxid))));
     SetNextSnapXid();
@@ -21,14 +21,15 @@
 
 #include "miscadmin.h"
 #include "storage/backendid.h"
+#include "storage/barrier.h"
 #include "storage/ipc.h"
 #include "storage/proc.h"
 #include "storage/procsignal.h"
 #include "storage/shmem.h"
 #include "storage/sinvaladt.h"
-#include "storage/spin.h"
 #include "gs_thread.h"
 #include "threadpool/threadpool.h"
+#include "utils/globalplancache.h"
 
 /*
  * Conceptually, the shared cache invalidation messages are stored in an
@@ -90,19 +91,29 @@
  * has no need to touch anyone's ProcState, except in the infrequent cases
  * when SICleanupQueue is needed.  The only point of overlap is that
  * the writer wants to change maxMsgNum while readers need to read it.
- * We deal with that by having a spinlock that readers must take for just
- * long enough to read maxMsgNum, while writers take it for just long enough
- * to write maxMsgNum.	(The exact rule is that you need the spinlock to
- * read maxMsgNum if you are not holding SInvalWriteLock, and you need the
- * spinlock to write maxMsgNum unless you are holding both locks.)
+ * maxMsgNum is an int and hence atomically readable/writable, so readers
+ * fetch it without any lock.  What we need is a memory barrier: a writer
+ * issues a write barrier between storing the messages into the array and
+ * advancing maxMsgNum, and a reader issues a read barrier between fetching
+ * maxMsgNum and reading the messages.  (You need to hold both locks to
+ * change maxMsgNum in any other way, as SICleanupQueue does.)
  *
- * Note: since maxMsgNum is an int and hence presumably atomically readable/
- * writable, the spinlock might seem unnecessary.  The reason it is needed
- * is to provide a memory barrier: we need to be sure that messages written
- * to the array are actually there before maxMsgNum is increased, and that
- * readers will see that data after fetching maxMsgNum.  Multiprocessors
- * that have weak memory-ordering guarantees can fail without the memory
- * barrier instructions that are included in the spinlock sequences.
+ * Most messages concern the catalogs of a single database, and a backend
+ * ignores the ones of the other databases anyway.  Each backend advertises
+ * its database in its ProcState, and writers only set hasMessages for the
+ * backends that may be interested in what they add; readers skip the
+ * messages of the other databases.  A backend whose hasMessages flag is
+ * clear therefore has nothing to read up to maxMsgNum, and SICleanupQueue
+ * simply moves it forward instead of letting it fall behind until it gets
+ * a catchup interrupt or a reset.  With many databases and frequent DDL,
+ * this keeps the idle sessions of the other databases out of the catchup
+ * chain altogether.  The filtering is off when the global plan cache is
+ * enabled, because it looks at the messages of every database.
+ *
+ * Finally, writers coalesce the identical messages of a batch, keeping only
+ * the last occurrence of each.  Invalidations are idempotent, and keeping
+ * the last one preserves the order of each message relative to the ones
+ * sent after it, so the receivers end up in the same state.
  */
 /*
  * Configurable parameters.
@@ -144,6 +155,8 @@ typedef struct ProcState {
     bool resetState;  /* backend needs to reset its state */
     bool signaled;    /* backend has been sent catchup signal */
     bool hasMessages; /* backend has unread messages */
+    /* dbOid is InvalidOid until the backend reads messages in a database. */
+    Oid dbOid;        /* database of the backend, for filtering */
 
     /*
      * Backend only sends invalidations, never receives them. This only makes
@@ -174,7 +187,6 @@ typedef struct SISeg {
     int lastreserveBackend;
     int maxBackends; /* size of procState array */
     int maxreserveBackends;
-    slock_t msgnumLock; /* spinlock protecting maxMsgNum */
 
     /*
      * Circular buffer holding shared-inval messages
@@ -232,7 +244,7 @@ void CreateSharedInvalidationState(void)
         return;
     }
 
-    /* Clear message counters, save size of procState array, init spinlock */
+    /* Clear message counters, save size of procState array */
     t_thrd.shemem_ptr_cxt.shmInvalBuffer->minMsgNum = 0;
     t_thrd.shemem_ptr_cxt.shmInvalBuffer->maxMsgNum = 0;
     t_thrd.shemem_ptr_cxt.shmInvalBuffer->nextThreshold = CLEANUP_MIN;
@@ -246,7 +258,6 @@ void CreateSharedInvalidationState(void)
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->maxBackends = g_instance.shmem_cxt.MaxBackends;
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->maxreserveBackends = g_instance.shmem_cxt.MaxBackends;
     }
-    SpinLockInit(&t_thrd.shemem_ptr_cxt.shmInvalBuffer->msgnumLock);
 
     /* The buffer[] array is initially all unused, so we need not fill it */
     /* Mark all backends inactive, and initialize nextLXID */
@@ -257,6 +268,7 @@ void CreateSharedInvalidationState(void)
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->procState[i].resetState = false;
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->procState[i].signaled = false;
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->procState[i].hasMessages = false;
+        t_thrd.shemem_ptr_cxt.shmInvalBuffer->procState[i].dbOid = InvalidOid;
         t_thrd.shemem_ptr_cxt.shmInvalBuffer->procState[i].nextLXID = InvalidLocalTransactionId;
     }
 }
@@ -322,6 +334,7 @@ static void SharedInvalReserveBackendInit(bool sendOnly)
     stateP->resetState = false;
     stateP->signaled = false;
     stateP->hasMessages = false;
+    stateP->dbOid = InvalidOid;
     stateP->sendOnly = sendOnly;
 
     LWLockRelease(SInvalWriteLock);
@@ -389,6 +402,7 @@ static void SharedInvalWorkSessionInit(bool sendOnly)
     stateP->resetState = false;
     stateP->signaled = false;
     stateP->hasMessages = false;
+    stateP->dbOid = InvalidOid;
     stateP->sendOnly = sendOnly;
 
     LWLockRelease(SInvalWriteLock);
@@ -443,6 +457,7 @@ static void CleanupInvalidationState(int status, Datum arg)
     stateP->nextMsgNum = 0;
     stateP->resetState = false;
     stateP->signaled = false;
+    stateP->dbOid = InvalidOid;
 
     /* Recompute index of last active backend */
     for (i = segP->lastBackend; i > 0; i--) {
@@ -484,6 +499,7 @@ void CleanupWorkSessionInvalidation(void)
     stateP->nextMsgNum = 0;
     stateP->resetState = false;
     stateP->signaled = false;
+    stateP->dbOid = InvalidOid;
 
     /* Recompute index of last active backend */
     for (i = segP->lastBackend; i > 0; i--) {
@@ -522,6 +538,101 @@ PGPROC* BackendIdGetProc(int backendID)
     return result;
 }
 
+/*
+ * SIMessageDatabase
+ *		Return the database a message is meant for, or InvalidOid if every
+ *		backend has to read it.
+ */
+static Oid SIMessageDatabase(const SharedInvalidationMessage* msg)
+{
+    /* the global plan cache looks at the messages of every database */
+    if (ENABLE_DN_GPC) {
+        return InvalidOid;
+    }
+
+    if (msg->id >= 0) {
+        return msg->cc.dbId;
+    }
+
+    switch (msg->id) {
+        case SHAREDINVALCATALOG_ID:
+            return msg->cat.dbId;
+        case SHAREDINVALRELCACHE_ID:
+            return msg->rc.dbId;
+        case SHAREDINVALRELMAP_ID:
+            return msg->rm.dbId;
+        case SHAREDINVALPARTCACHE_ID:
+            return msg->pc.dbId;
+        default:
+            /* backends may have smgr entries for relations of any database */
+            return InvalidOid;
+    }
+}
+
+/*
+ * SIMessagesEqual
+ *		Check whether two messages have the same effect.
+ *
+ * The messages are built field by field, so we can't compare their bytes.
+ */
+static bool SIMessagesEqual(const SharedInvalidationMessage* a, const SharedInvalidationMessage* b)
+{
+    if (a->id != b->id) {
+        return false;
+    }
+
+    if (a->id >= 0) {
+        return a->cc.dbId == b->cc.dbId && a->cc.hashValue == b->cc.hashValue;
+    }
+
+    switch (a->id) {
+        case SHAREDINVALCATALOG_ID:
+            return a->cat.dbId == b->cat.dbId && a->cat.catId == b->cat.catId;
+        case SHAREDINVALRELCACHE_ID:
+            return a->rc.dbId == b->rc.dbId && a->rc.relId == b->rc.relId;
+        case SHAREDINVALSMGR_ID:
+            return a->sm.backend_hi == b->sm.backend_hi && a->sm.backend_lo == b->sm.backend_lo &&
+                   a->sm.rnode.spcNode == b->sm.rnode.spcNode && a->sm.rnode.dbNode == b->sm.rnode.dbNode &&
+                   a->sm.rnode.relNode == b->sm.rnode.relNode;
+        case SHAREDINVALRELMAP_ID:
+            return a->rm.dbId == b->rm.dbId;
+        case SHAREDINVALPARTCACHE_ID:
+            return a->pc.dbId == b->pc.dbId && a->pc.partId == b->pc.partId;
+        case SHAREDINVALHBKTSMGR_ID:
+            return a->hbksm.bucketId == b->hbksm.bucketId && a->hbksm.rnode.spcNode == b->hbksm.rnode.spcNode &&
+                   a->hbksm.rnode.dbNode == b->hbksm.rnode.dbNode && a->hbksm.rnode.relNode == b->hbksm.rnode.relNode;
+        default:
+            return false;
+    }
+}
+
+/*
+ * SICoalesceMessages
+ *		Copy the n messages of data into result, dropping each message that
+ *		appears again later in data.  Returns the number of messages copied.
+ */
+static int SICoalesceMessages(const SharedInvalidationMessage* data, int n, SharedInvalidationMessage* result)
+{
+    int count = 0;
+
+    for (int i = 0; i < n; i++) {
+        bool later = false;
+
+        for (int j = i + 1; j < n; j++) {
+            if (SIMessagesEqual(&data[i], &data[j])) {
+                later = true;
+                break;
+            }
+        }
+
+        if (!later) {
+            result[count++] = data[i];
+        }
+    }
+
+    return count;
+}
+
 /*
  * SIInsertDataEntries
  *		Add new invalidation message(s) to the buffer.
@@ -529,6 +640,7 @@ PGPROC* BackendIdGetProc(int backendID)
 void SIInsertDataEntries(const SharedInvalidationMessage* data, int n)
 {
     SISeg* segP = t_thrd.shemem_ptr_cxt.shmInvalBuffer;
+    SharedInvalidationMessage batch[WRITE_QUANTUM];
 
     /*
      * N can be arbitrarily large.	We divide the work into groups of no more
@@ -540,12 +652,25 @@ void SIInsertDataEntries(const SharedInvalidationMessage* data, int n)
      * SICleanupQueue every so often.
      */
     while (n > 0) {
-        int nthistime = Min(n, WRITE_QUANTUM);
+        int ntaken = Min(n, WRITE_QUANTUM);
+        int nthistime;
         int numMsgs;
         int max;
         int i;
+        Oid dbOid;
+
+        n -= ntaken;
 
-        n -= nthistime;
+        /* Drop the duplicates of the group, and see whom it concerns */
+        nthistime = SICoalesceMessages(data, ntaken, batch);
+        data += ntaken;
+
+        dbOid = SIMessageDatabase(&batch[0]);
+        for (i = 1; i < nthistime && OidIsValid(dbOid); i++) {
+            if (SIMessageDatabase(&batch[i]) != dbOid) {
+                dbOid = InvalidOid;
+            }
+        }
 
         LWLockAcquire(SInvalWriteLock, LW_EXCLUSIVE);
 
@@ -571,32 +696,27 @@ void SIInsertDataEntries(const SharedInvalidationMessage* data, int n)
          */
         max = segP->maxMsgNum;
 
-        while (nthistime-- > 0) {
-            segP->buffer[max % MAXNUMMESSAGES] = *data++;
+        for (i = 0; i < nthistime; i++) {
+            segP->buffer[max % MAXNUMMESSAGES] = batch[i];
             max++;
         }
 
-        /* Update current value of maxMsgNum using spinlock */
-        {
-            /* use volatile pointer to prevent code rearrangement */
-            volatile SISeg* vsegP = segP;
-
-            SpinLockAcquire(&vsegP->msgnumLock);
-            vsegP->maxMsgNum = max;
-            SpinLockRelease(&vsegP->msgnumLock);
-        }
+        /* Make the messages visible to the readers before maxMsgNum moves */
+        pg_write_barrier();
+        ((volatile SISeg*)segP)->maxMsgNum = max;
 
         /*
          * Now that the maxMsgNum change is globally visible, we give everyone
-         * a swift kick to make sure they read the newly added messages.
-         * Releasing SInvalWriteLock will enforce a full memory barrier, so
-         * these (unlocked) changes will be committed to memory before we exit
-         * the function.
+         * interested a swift kick to make sure they read the newly added
+         * messages.  Releasing SInvalWriteLock will enforce a full memory
+         * barrier, so these (unlocked) changes will be committed to memory
+         * before we exit the function.
          */
         for (i = 0; i < segP->lastBackend; i++) {
             ProcState* stateP = &segP->procState[i];
 
-            if (stateP->procPid != 0) {
+            if (stateP->procPid != 0 &&
+                (!OidIsValid(dbOid) || !OidIsValid(stateP->dbOid) || stateP->dbOid == dbOid)) {
                 stateP->hasMessages = true;
             }
         }
@@ -630,6 +750,9 @@ void SIInsertDataEntries(const SharedInvalidationMessage* data, int n)
  * guaranteed that we will return any messages added after the routine is
  * entered.
  *
+ * The messages of other databases are consumed but not returned, so the
+ * result may be 0 even though our counter has moved.
+ *
  * Note: we assume that "datasize" is not so large that it might be important
  * to break our hold on SInvalReadLock into segments.
  */
@@ -639,6 +762,7 @@ int SIGetDataEntries(SharedInvalidationMessage* data, int datasize)
     ProcState* stateP = NULL;
     int max;
     int n;
+    Oid dbOid;
 
     segP = t_thrd.shemem_ptr_cxt.shmInvalBuffer;
     if (IS_THREAD_POOL_WORKER) {
@@ -647,6 +771,21 @@ int SIGetDataEntries(SharedInvalidationMessage* data, int datasize)
         stateP = &segP->procState[t_thrd.proc_cxt.MyBackendId - 1];
     }
 
+    /*
+     * Advertise our database so that writers and SICleanupQueue can leave us
+     * alone for the messages of the others.  If we had advertised another
+     * one, we may have missed messages of the new one, so we must reset.
+     */
+    if (stateP->dbOid != u_sess->proc_cxt.MyDatabaseId) {
+        LWLockAcquire(SInvalReadLock, LW_SHARED);
+        if (OidIsValid(stateP->dbOid)) {
+            stateP->resetState = true;
+        }
+        stateP->dbOid = u_sess->proc_cxt.MyDatabaseId;
+        stateP->hasMessages = true;
+        LWLockRelease(SInvalReadLock);
+    }
+
     /*
      * Before starting to take locks, do a quick, unlocked test to see whether
      * there can possibly be anything to read.	On a multiprocessor system,
@@ -675,15 +814,9 @@ int SIGetDataEntries(SharedInvalidationMessage* data, int datasize)
      */
     stateP->hasMessages = false;
 
-    /* Fetch current value of maxMsgNum using spinlock */
-    {
-        /* use volatile pointer to prevent code rearrangement */
-        volatile SISeg* vsegP = segP;
-
-        SpinLockAcquire(&vsegP->msgnumLock);
-        max = vsegP->maxMsgNum;
-        SpinLockRelease(&vsegP->msgnumLock);
-    }
+    /* Fetch current value of maxMsgNum before reading the messages it covers */
+    max = ((volatile SISeg*)segP)->maxMsgNum;
+    pg_read_barrier();
 
     if (stateP->resetState) {
         /*
@@ -707,10 +840,19 @@ int SIGetDataEntries(SharedInvalidationMessage* data, int datasize)
      * from the queue.
      */
     n = 0;
+    dbOid = stateP->dbOid;
 
     while (n < datasize && stateP->nextMsgNum < max) {
-        data[n++] = segP->buffer[stateP->nextMsgNum % MAXNUMMESSAGES];
+        SharedInvalidationMessage* msg = &segP->buffer[stateP->nextMsgNum % MAXNUMMESSAGES];
+        Oid msgDbOid = SIMessageDatabase(msg);
+
         stateP->nextMsgNum++;
+
+        /* skip the messages of other databases */
+        if (OidIsValid(dbOid) && OidIsValid(msgDbOid) && msgDbOid != dbOid) {
+            continue;
+        }
+        data[n++] = *msg;
     }
 
     /*
@@ -779,6 +921,17 @@ void SICleanupQueue(bool callerHasWriteLock, int minFree)
             continue;
         }
 
+        /*
+         * Nobody is reading now, so a backend without hasMessages has nothing
+         * of interest up to maxMsgNum: all its pending messages are for other
+         * databases.  Move it forward rather than signal or reset it.
+         */
+        if (!stateP->hasMessages) {
+            stateP->nextMsgNum = segP->maxMsgNum;
+            stateP->signaled = false;
+            continue;
+        }
+
         /*
          * If we must free some space and this backend is preventing it, force
          * him into reset state and then ignore until he catches up.
@@ -64,6 +64,17 @@
  *
  * This protects us against the problem from above as nobody can release too
  *    quick, before we're queued, since after Phase 2 we're already queued.
+ *
+ *
+ * On a server spread over several NUMA nodes, a few very hot locks are also
+ * cohort locks.  An exclusive holder of one of them that releases it while an
+ * exclusive locker of its own node sleeps in the wait queue passes the lock
+ * on, still held, to that waiter and wakes it, at most
+ * LWLOCK_COHORT_MAX_HANDOFFS times in a row so that the other nodes and the
+ * shared lockers get their turn.  The lock and the data it protects thus
+ * stay in the caches of one node for a while instead of moving between
+ * sockets at every acquisition.  Lockers wait in the wait queue as usual, so
+ * a deadlock victim leaves it as for any other lock.
  * -------------------------------------------------------------------------
  */
 #include "storage/dfs/dfscache_mgr.h"
@@ -90,6 +101,7 @@
 #include "storage/spin.h"
 #include "storage/cucache_mgr.h"
 #include "utils/atomic.h"
+#include "utils/timestamp.h"
 #include "instruments/instr_event.h"
 #include "tsan_annotation.h"
 
@@ -111,6 +123,35 @@
 const char **LWLockTrancheArray = NULL;
 int LWLockTranchesAllocated = 0;
 
+/* ProcArrayLock and the buffer mapping partitions */
+#define NUM_COHORT_LWLOCKS (1 + NUM_BUFFER_PARTITIONS)
+
+/* handoffs in a row within a node before the lock is really released */
+#define LWLOCK_COHORT_MAX_HANDOFFS 64
+
+typedef struct LWLockCohort {
+    uint32 handoffs; /* handoffs in a row, changed by the lock holder only */
+} LWLockCohort;
+
+typedef union LWLockCohortPadded {
+    LWLockCohort cohort;
+    char pad[PG_CACHE_LINE_SIZE];
+} LWLockCohortPadded;
+
+/*
+ * Allocated after the main LWLock array.  The statistics have one entry per
+ * native tranche and NUMA node, every thread updates the entries of its node.
+ * The cohorts have one entry per cohort lock, there are none when the server
+ * runs on a single node.
+ */
+typedef struct LWLockContentionCtl {
+    int numaNodes;
+    LWLockTrancheStat *stats;
+    LWLockCohortPadded *cohorts;
+} LWLockContentionCtl;
+
+static LWLockContentionCtl *LWLockContention = NULL;
+
 /*
  * The array MainLWLockNames represents the name of individual locks
  * for LWLock in src/include/storage/lwlocknames.h.
@@ -137,6 +178,7 @@ static const char *BuiltinTrancheNames[] = {
     "InstrUserLockId",
     "GPCMappingLock",
     "GPCPrepareMappingLock",
+    "ToastCacheLock",
     "BufferIOLock",
     "BufferContentLock",
     "DataCacheLock",
@@ -158,6 +200,8 @@ static const char *BuiltinTrancheNames[] = {
 
 static void RegisterLWLockTranches(void);
 static void InitializeLWLocks(int numLocks);
+static Size LWLockContentionShmemSize(void);
+static void InitializeLWLockContention(char *ptr);
 extern void LWLockReportWaitStart(LWLock *);
 extern void LWLockReportWaitEnd(void);
 
@@ -403,6 +447,9 @@ Size LWLockShmemSize(void)
     /* Space for dynamic allocation counter, plus room for alignment. */
     size = add_size(size, 3 * sizeof(int) + LWLOCK_PADDED_SIZE);
 
+    /* Space for the NUMA cohorts and the contention statistics. */
+    size = add_size(size, LWLockContentionShmemSize());
+
     return size;
 }
 
@@ -437,6 +484,62 @@ void CreateLWLocks(void)
 
     InitializeLWLocks(numLocks);
     RegisterLWLockTranches();
+    InitializeLWLockContention((char *)(t_thrd.shemem_ptr_cxt.mainLWLockArray + numLocks));
+}
+
+static int LWLockNumaNodes(void)
+{
+    return Max(g_instance.shmem_cxt.numaNodeNum, 1);
+}
+
+static Size LWLockContentionShmemSize(void)
+{
+    int nodes = LWLockNumaNodes();
+    Size size = MAXALIGN(sizeof(LWLockContentionCtl));
+
+    size = add_size(size, mul_size(mul_size(nodes, LWTRANCHE_NATIVE_TRANCHE_NUM), sizeof(LWLockTrancheStat)));
+    if (nodes > 1) {
+        /* plus room to align the cohorts on a cache line */
+        size = add_size(size, mul_size(NUM_COHORT_LWLOCKS, sizeof(LWLockCohortPadded)));
+        size = add_size(size, PG_CACHE_LINE_SIZE);
+    }
+
+    return size;
+}
+
+/*
+ * Set up the contention statistics and, on several NUMA nodes, the cohorts
+ * of the hottest locks.
+ */
+static void InitializeLWLockContention(char *ptr)
+{
+    LWLockContentionCtl *ctl = (LWLockContentionCtl *)ptr;
+    int nodes = LWLockNumaNodes();
+    Size statSize = mul_size(mul_size(nodes, LWTRANCHE_NATIVE_TRANCHE_NUM), sizeof(LWLockTrancheStat));
+    errno_t rc;
+
+    ptr += MAXALIGN(sizeof(LWLockContentionCtl));
+    ctl->numaNodes = nodes;
+    ctl->stats = (LWLockTrancheStat *)ptr;
+    rc = memset_s(ctl->stats, statSize, 0, statSize);
+    securec_check(rc, "\0", "\0");
+    ptr += statSize;
+    ctl->cohorts = NULL;
+
+    if (nodes > 1) {
+        Size cohortSize = mul_size(NUM_COHORT_LWLOCKS, sizeof(LWLockCohortPadded));
+
+        ctl->cohorts = (LWLockCohortPadded *)TYPEALIGN(PG_CACHE_LINE_SIZE, ptr);
+        rc = memset_s(ctl->cohorts, cohortSize, 0, cohortSize);
+        securec_check(rc, "\0", "\0");
+
+        ProcArrayLock->cohort = 1;
+        for (int i = 0; i < NUM_BUFFER_PARTITIONS; i++) {
+            GetMainLWLockByIndex(FirstBufMappingLock + i)->cohort = (uint16)(2 + i);
+        }
+    }
+
+    LWLockContention = ctl;
 }
 
 /*
@@ -514,6 +617,10 @@ static void InitializeLWLocks(int numLocks)
         LWLockInitialize(&lock->lock, LWTRANCHE_GPC_PREPARE_MAPPING);
     }
 
+    for (id = 0; id < NUM_TOAST_CACHE_PARTITIONS; id++, lock++) {
+        LWLockInitialize(&lock->lock, LWTRANCHE_TOAST_CACHE);
+    }
+
     Assert((lock - t_thrd.shemem_ptr_cxt.mainLWLockArray) == NumFixedLWLocks);
 
     for (id = NumFixedLWLocks; id < numLocks; id++, lock++) {
@@ -663,9 +770,197 @@ void LWLockInitialize(LWLock *lock, int tranche_id)
     pg_atomic_init_u32(&lock->nwaiters, 0);
 #endif
     lock->tranche = tranche_id;
+    lock->cohort = 0;
     dlist_init(&lock->waiters);
 }
 
+/*
+ * Statistics of the lock's tranche for the NUMA node we run on, NULL if the
+ * tranche has none.
+ */
+static LWLockTrancheStat *LWLockGetStat(const LWLock *lock)
+{
+    int node = 0;
+
+    if (LWLockContention == NULL || lock->tranche >= LWTRANCHE_NATIVE_TRANCHE_NUM) {
+        return NULL;
+    }
+    if (t_thrd.proc != NULL && t_thrd.proc->nodeno > 0 && t_thrd.proc->nodeno < LWLockContention->numaNodes) {
+        node = t_thrd.proc->nodeno;
+    }
+    return &LWLockContention->stats[node * LWTRANCHE_NATIVE_TRANCHE_NUM + lock->tranche];
+}
+
+static void LWLockCountTime(pg_atomic_uint64 *count, pg_atomic_uint64 *total, pg_atomic_uint64 *hist, int64 usecs)
+{
+    int bucket = 0;
+
+    /* the clock may have been set back */
+    if (usecs < 0) {
+        usecs = 0;
+    }
+    for (uint64 left = (uint64)usecs; left > 0 && bucket < LWLOCK_TIMING_BUCKETS - 1; left >>= 1) {
+        bucket++;
+    }
+
+    (void)pg_atomic_fetch_add_u64(count, 1);
+    (void)pg_atomic_fetch_add_u64(total, (uint64)usecs);
+    (void)pg_atomic_fetch_add_u64(&hist[bucket], 1);
+}
+
+/* Start of a wait, 0 if track_lwlock_timing is off. */
+static TimestampTz LWLockWaitStart(void)
+{
+    if (u_sess == NULL || !u_sess->attr.attr_common.track_lwlock_timing) {
+        return 0;
+    }
+    return GetCurrentTimestamp();
+}
+
+/*
+ * Count the wait started at wait_start, if any, that ends now.  Returns the
+ * current time, to be kept as the acquisition time, or 0 if
+ * track_lwlock_timing is off.
+ */
+static TimestampTz LWLockTimeAcquire(const LWLock *lock, TimestampTz wait_start)
+{
+    LWLockTrancheStat *stat = NULL;
+    TimestampTz now;
+
+    if (u_sess == NULL || !u_sess->attr.attr_common.track_lwlock_timing) {
+        return 0;
+    }
+
+    now = GetCurrentTimestamp();
+    if (wait_start != 0 && (stat = LWLockGetStat(lock)) != NULL) {
+        LWLockCountTime(&stat->wait_count, &stat->wait_time, stat->wait_hist, now - wait_start);
+    }
+    return now;
+}
+
+static void LWLockTimeRelease(const LWLock *lock, TimestampTz acquire_time)
+{
+    LWLockTrancheStat *stat = LWLockGetStat(lock);
+
+    if (stat != NULL) {
+        LWLockCountTime(&stat->hold_count, &stat->hold_time, stat->hold_hist, GetCurrentTimestamp() - acquire_time);
+    }
+}
+
+/*
+ * Sum the statistics of a native tranche over all NUMA nodes.  The counters
+ * are read one by one while they move, the sums are not a snapshot.
+ */
+void LWLockGetTrancheStat(int trancheId, LWLockTrancheStat *stat)
+{
+    errno_t rc = memset_s(stat, sizeof(LWLockTrancheStat), 0, sizeof(LWLockTrancheStat));
+    securec_check(rc, "\0", "\0");
+
+    if (LWLockContention == NULL || trancheId < 0 || trancheId >= LWTRANCHE_NATIVE_TRANCHE_NUM) {
+        return;
+    }
+
+    for (int node = 0; node < LWLockContention->numaNodes; node++) {
+        LWLockTrancheStat *src = &LWLockContention->stats[node * LWTRANCHE_NATIVE_TRANCHE_NUM + trancheId];
+
+        stat->wait_count += pg_atomic_read_u64(&src->wait_count);
+        stat->wait_time += pg_atomic_read_u64(&src->wait_time);
+        stat->hold_count += pg_atomic_read_u64(&src->hold_count);
+        stat->hold_time += pg_atomic_read_u64(&src->hold_time);
+        stat->handoff_count += pg_atomic_read_u64(&src->handoff_count);
+        for (int i = 0; i < LWLOCK_TIMING_BUCKETS; i++) {
+            stat->wait_hist[i] += pg_atomic_read_u64(&src->wait_hist[i]);
+            stat->hold_hist[i] += pg_atomic_read_u64(&src->hold_hist[i]);
+        }
+    }
+}
+
+static inline LWLockCohort *LWLockGetCohort(const LWLock *lock)
+{
+    return &LWLockContention->cohorts[lock->cohort - 1].cohort;
+}
+
+/* NUMA node an exclusive acquisition may pass the lock on within, -1 if none */
+static inline int LWLockCohortNode(const LWLock *lock, LWLockMode mode)
+{
+    if (lock->cohort == 0 || mode != LW_EXCLUSIVE || t_thrd.proc == NULL) {
+        return -1;
+    }
+    if (t_thrd.proc->nodeno < 0 || t_thrd.proc->nodeno >= LWLockContention->numaNodes) {
+        return -1;
+    }
+    return t_thrd.proc->nodeno;
+}
+
+/*
+ * Pass the exclusively held lock on to the first exclusive waiter of our
+ * node, unless there is none or the node has kept the lock long enough.  The
+ * waiter is taken off the wait queue under the wait list lock, so that
+ * wakeup_victim can not choose it any more, and learns from lwHandoff that
+ * it holds the lock when it wakes up.
+ */
+static bool LWLockCohortHandoff(LWLock *lock, int node)
+{
+    LWLockCohort *cohort = LWLockGetCohort(lock);
+    PGPROC *next = NULL;
+    LWLockTrancheStat *stat = NULL;
+    dlist_iter iter;
+
+    if (cohort->handoffs >= LWLOCK_COHORT_MAX_HANDOFFS ||
+        (pg_atomic_read_u32(&lock->state) & LW_FLAG_HAS_WAITERS) == 0) {
+        return false;
+    }
+
+    LWLockWaitListLock(lock);
+
+    dlist_foreach(iter, &lock->waiters)
+    {
+        PGPROC *waiter = dlist_container(PGPROC, lwWaitLink, iter.cur);
+        if (waiter->lwWaitMode == LW_EXCLUSIVE && waiter->nodeno == node) {
+            next = waiter;
+            break;
+        }
+    }
+
+    if (next != NULL) {
+        dlist_delete(&next->lwWaitLink);
+        if (dlist_is_empty(&lock->waiters)) {
+            pg_atomic_fetch_and_u32(&lock->state, ~LW_FLAG_HAS_WAITERS);
+        }
+    }
+
+    LWLockWaitListUnlock(lock);
+
+    if (next == NULL) {
+        return false;
+    }
+
+    if ((stat = LWLockGetStat(lock)) != NULL) {
+        (void)pg_atomic_fetch_add_u64(&stat->handoff_count, 1);
+    }
+
+    /* ENABLE_THREAD_CHECK only, Must release vector clock info to other
+     * threads before unlock */
+    TsAnnotateRWLockReleased(&lock->rwlock, 1);
+    cohort->handoffs++;
+    next->lwHandoff = true;
+    pg_write_barrier();
+    next->lwWaiting = false;
+    PGSemaphoreUnlock(&next->sem);
+    return true;
+}
+
+/* Add lock to list of locks held by this backend */
+static inline void LWLockRememberHeld(LWLock *lock, LWLockMode mode, int cohort_node, TimestampTz acquire_time)
+{
+    LWLockHandle *handle = &t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++];
+
+    handle->lock = lock;
+    handle->mode = mode;
+    handle->cohort_node = cohort_node;
+    handle->acquire_time = acquire_time;
+}
+
 static void LWThreadSuicide(PGPROC *proc, int extraWaits, LWLock *lock, LWLockMode mode)
 {
     if (!proc->lwIsVictim) {
@@ -1134,6 +1429,9 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
     PGPROC *proc = t_thrd.proc;
     bool result = true;
     int extraWaits = 0;
+    int cohort_node = LWLockCohortNode(lock, mode);
+    bool handed_off = false;
+    TimestampTz wait_start = 0;
 #ifdef LWLOCK_STATS
     lwlock_stats *lwstats = NULL;
 
@@ -1250,6 +1548,9 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
         lwstats->block_count++;
 #endif
 
+        if (wait_start == 0) {
+            wait_start = LWLockWaitStart();
+        }
         LWLockReportWaitStart(lock);
         TRACE_POSTGRESQL_LWLOCK_WAIT_START(T_NAME(lock), mode);
         for (;;) {
@@ -1282,17 +1583,36 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
 
         LOG_LWDEBUG("LWLockAcquire", lock, "awakened");
 
-        /* Now loop back and try to acquire lock again. */
         result = false;
+
+        /* The holder of a cohort lock may have passed it on to us. */
+        pg_read_barrier();
+        if (proc->lwHandoff) {
+            proc->lwHandoff = false;
+            LOG_LWDEBUG("LWLockAcquire", lock, "handed off within the node");
+            /* ENABLE_THREAD_CHECK only, Must acquire vector clock info from other
+             * thread after got the lock */
+            TsAnnotateRWLockAcquired(&lock->rwlock, 1);
+#ifdef LOCK_DEBUG
+            lock->owner = proc;
+#endif
+            handed_off = true;
+            break;
+        }
+
+        /* Now loop back and try to acquire lock again. */
+    }
+
+    /* A new run of handoffs within the node starts with a lock we took ourselves. */
+    if (cohort_node >= 0 && !handed_off) {
+        LWLockGetCohort(lock)->handoffs = 0;
     }
 
     TRACE_POSTGRESQL_LWLOCK_ACQUIRE(T_NAME(lock), mode);
 
     forget_lwlock_acquire();
 
-    /* Add lock to list of locks held by this backend */
-    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+    LWLockRememberHeld(lock, mode, cohort_node, LWLockTimeAcquire(lock, wait_start));
 
     /*
      * Fix the process wait semaphore's count for any absorbed wakeups.
@@ -1340,9 +1660,7 @@ bool LWLockConditionalAcquire(LWLock *lock, LWLockMode mode)
         LOG_LWDEBUG("LWLockConditionalAcquire", lock, "failed");
         TRACE_POSTGRESQL_LWLOCK_CONDACQUIRE_FAIL(T_NAME(lock), mode);
     } else {
-        /* Add lock to list of locks held by this backend */
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+        LWLockRememberHeld(lock, mode, -1, LWLockTimeAcquire(lock, 0));
         TRACE_POSTGRESQL_LWLOCK_CONDACQUIRE(T_NAME(lock), mode);
     }
     return !mustwait;
@@ -1367,6 +1685,8 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
     PGPROC *proc = t_thrd.proc;
     bool mustwait = false;
     int extraWaits = 0;
+    TimestampTz wait_start = 0;
+    TimestampTz acquire_time;
 #ifdef LWLOCK_STATS
     lwlock_stats *lwstats = NULL;
     lwstats = get_lwlock_stats_entry(lock);
@@ -1404,6 +1724,7 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
             lwstats->block_count++;
 #endif
 
+            wait_start = LWLockWaitStart();
             LWLockReportWaitStart(lock);
             TRACE_POSTGRESQL_LWLOCK_WAIT_START(T_NAME(lock), mode);
 
@@ -1454,6 +1775,9 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
         PGSemaphoreUnlock(&proc->sem);
     }
 
+    /* the wait counts even if it ended without the lock */
+    acquire_time = LWLockTimeAcquire(lock, wait_start);
+
     if (mustwait) {
         /* Failed to get lock, so release interrupt holdoff */
         RESUME_INTERRUPTS();
@@ -1461,9 +1785,7 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
         TRACE_POSTGRESQL_LWLOCK_WAIT_UNTIL_FREE_FAIL(T_NAME(lock), mode);
     } else {
         LOG_LWDEBUG("LWLockAcquireOrWait", lock, "succeeded");
-        /* Add lock to list of locks held by this backend */
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+        LWLockRememberHeld(lock, mode, -1, acquire_time);
         TRACE_POSTGRESQL_LWLOCK_WAIT_UNTIL_FREE(T_NAME(lock), mode);
     }
 
@@ -1672,6 +1994,8 @@ void LWLockUpdateVar(LWLock *lock, uint64 *valptr, uint64 val)
 void LWLockRelease(LWLock *lock)
 {
     LWLockMode mode = LW_EXCLUSIVE;
+    int cohort_node = -1;
+    TimestampTz acquire_time = 0;
     uint32 oldstate;
     bool check_waiters = false;
     int i;
@@ -1681,6 +2005,8 @@ void LWLockRelease(LWLock *lock)
     for (i = t_thrd.storage_cxt.num_held_lwlocks; --i >= 0;) {
         if (lock == t_thrd.storage_cxt.held_lwlocks[i].lock) {
             mode = t_thrd.storage_cxt.held_lwlocks[i].mode;
+            cohort_node = t_thrd.storage_cxt.held_lwlocks[i].cohort_node;
+            acquire_time = t_thrd.storage_cxt.held_lwlocks[i].acquire_time;
             break;
         }
     }
@@ -1694,6 +2020,18 @@ void LWLockRelease(LWLock *lock)
 
     PRINT_LWDEBUG("LWLockRelease", lock, mode);
 
+    if (acquire_time != 0) {
+        LWLockTimeRelease(lock, acquire_time);
+    }
+
+    /* A cohort lock goes to the next locker of our node without being released. */
+    if (cohort_node >= 0 && LWLockCohortHandoff(lock, cohort_node)) {
+        LOG_LWDEBUG("LWLockRelease", lock, "handing off within the node");
+        TRACE_POSTGRESQL_LWLOCK_RELEASE(T_NAME(lock));
+        RESUME_INTERRUPTS();
+        return;
+    }
+
     /*
      * Release my hold on lock, after that it can immediately be acquired by
      * others, even if we still have to wakeup other waiters. */
@@ -1837,6 +2175,8 @@ void LWLockOwn(LWLock *lock)
         ereport(ERROR, (errcode(ERRCODE_LOCK_NOT_AVAILABLE), errmsg("lock %s is not held", T_NAME(lock))));
     }
 
+    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].cohort_node = -1;
+    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].acquire_time = 0;
     t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].lock = lock;
 
     HOLD_INTERRUPTS();
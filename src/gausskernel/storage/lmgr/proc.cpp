@@ -586,6 +586,7 @@ void InitProcess(void)
     t_thrd.proc->lwWaiting = false;
     t_thrd.proc->lwWaitMode = 0;
     t_thrd.proc->lwIsVictim = false;
+    t_thrd.proc->lwHandoff = false;
     t_thrd.proc->waitLock = NULL;
     t_thrd.proc->waitProcLock = NULL;
 #ifdef USE_ASSERT_CHECKING
@@ -791,6 +792,7 @@ void InitAuxiliaryProcess(void)
     t_thrd.proc->lwWaiting = false;
     t_thrd.proc->lwWaitMode = 0;
     t_thrd.proc->lwIsVictim = false;
+    t_thrd.proc->lwHandoff = false;
     t_thrd.proc->waitLock = NULL;
     t_thrd.proc->waitProcLock = NULL;
     t_thrd.proc->workingVersionNum = pg_atomic_read_u32(&WorkingGrandVersionNum);
@@ -54,6 +54,7 @@
 
 #include "miscadmin.h"
 
+#include "access/csnlog.h"
 #include "access/rewriteheap.h"
 #include "access/transam.h"
 #include "access/tuptoaster.h"
@@ -71,6 +72,7 @@
 
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
+#include "storage/procarray.h"
 #include "storage/sinval.h"
 
 #include "utils/lsyscache.h"
@@ -112,6 +114,7 @@ typedef struct ReorderBufferIterTXNEntry {
 typedef struct ReorderBufferIterTXNState {
     binaryheap* heap;
     Size nr_txns;
+    ReorderBufferTXN* last_txn; /* (sub)transaction of the last returned change */
     dlist_head old_change;
     ReorderBufferIterTXNEntry entries[FLEXIBLE_ARRAY_MEMBER];
 } ReorderBufferIterTXNState;
@@ -136,13 +139,12 @@ typedef struct ReorderBufferDiskChange {
 } ReorderBufferDiskChange;
 
 /*
- * We use a very simple form of a slab allocator for frequently allocated
- * objects, simply keeping a fixed number in a linked list when unused,
- * instead pfree()ing them. Without that in many workloads aset.c becomes a
- * major bottleneck, especially when spilling to disk while decoding batch
- * workloads.
+ * ReorderBufferChanges and ReorderBufferTXNs are allocated from slab
+ * contexts, one per object type.  Without that in many workloads aset.c
+ * becomes a major bottleneck, especially when spilling to disk while
+ * decoding batch workloads; a slab also hands its blocks back once a burst
+ * of changes has been replayed, which a freelist-based cache never did.
  */
-static const Size g_max_cached_transactions = 512;
 
 /* ---------------------------------------
  * primary reorderbuffer support routines
@@ -168,6 +170,16 @@ static ReorderBufferIterTXNState* ReorderBufferIterTXNInit(ReorderBuffer* rb, Re
 static ReorderBufferChange* ReorderBufferIterTXNNext(ReorderBuffer* rb, ReorderBufferIterTXNState* state);
 static void ReorderBufferIterTXNFinish(ReorderBuffer* rb, ReorderBufferIterTXNState* state);
 static void ReorderBufferExecuteInvalidations(ReorderBuffer* rb, ReorderBufferTXN* txn);
+static void ReorderBufferProcessTXN(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr commit_lsn, bool streaming);
+
+/* ---------------------------------------
+ * Streaming of in-progress transactions
+ * ---------------------------------------
+ */
+static bool ReorderBufferAdoptSubxacts(ReorderBuffer* rb, ReorderBufferTXN* txn);
+static bool ReorderBufferCanStreamTXN(ReorderBuffer* rb, ReorderBufferTXN* txn);
+static void ReorderBufferStreamTXN(ReorderBuffer* rb, ReorderBufferTXN* txn);
+static void ReorderBufferReleaseStreamedChanges(ReorderBuffer* rb, ReorderBufferTXN* txn);
 
 /*
  * ---------------------------------------
@@ -218,6 +230,11 @@ ReorderBuffer* ReorderBufferAllocate(void)
 
     buffer->context = new_ctx;
 
+    buffer->change_context =
+        SlabContextCreate(new_ctx, "Change", SLAB_DEFAULT_BLOCK_SIZE, sizeof(ReorderBufferChange));
+
+    buffer->txn_context = SlabContextCreate(new_ctx, "TXN", SLAB_DEFAULT_BLOCK_SIZE, sizeof(ReorderBufferTXN));
+
     hash_ctl.keysize = sizeof(TransactionId);
     hash_ctl.entrysize = sizeof(ReorderBufferTXNByIdEnt);
     hash_ctl.hash = tag_hash;
@@ -228,8 +245,6 @@ ReorderBuffer* ReorderBufferAllocate(void)
     buffer->by_txn_last_xid = InvalidTransactionId;
     buffer->by_txn_last_txn = NULL;
 
-    buffer->nr_cached_transactions = 0;
-    buffer->nr_cached_changes = 0;
     buffer->nr_cached_tuplebufs = 0;
 
     buffer->outbuf = NULL;
@@ -239,8 +254,6 @@ ReorderBuffer* ReorderBufferAllocate(void)
 
     dlist_init(&buffer->toplevel_by_lsn);
     dlist_init(&buffer->txns_by_base_snapshot_lsn);
-    dlist_init(&buffer->cached_transactions);
-    dlist_init(&buffer->cached_changes);
     slist_init(&buffer->cached_tuplebufs);
 
     return buffer;
@@ -261,19 +274,14 @@ void ReorderBufferFree(ReorderBuffer* rb)
 }
 
 /*
- * Get a unused, possibly preallocated, ReorderBufferTXN.
+ * Get an unused ReorderBufferTXN.
  */
 static ReorderBufferTXN* ReorderBufferGetTXN(ReorderBuffer* rb)
 {
     ReorderBufferTXN* txn = NULL;
     int rc = 0;
-    /* check the slab cache */
-    if (rb->nr_cached_transactions > 0) {
-        rb->nr_cached_transactions--;
-        txn = (ReorderBufferTXN*)dlist_container(ReorderBufferTXN, node, dlist_pop_head_node(&rb->cached_transactions));
-    } else {
-        txn = (ReorderBufferTXN*)MemoryContextAlloc(rb->context, sizeof(ReorderBufferTXN));
-    }
+
+    txn = (ReorderBufferTXN*)MemoryContextAlloc(rb->txn_context, sizeof(ReorderBufferTXN));
 
     rc = memset_s(txn, sizeof(ReorderBufferTXN), 0, sizeof(ReorderBufferTXN));
     securec_check(rc, "", "");
@@ -287,9 +295,6 @@ static ReorderBufferTXN* ReorderBufferGetTXN(ReorderBuffer* rb)
 
 /*
  * Free a ReorderBufferTXN.
- *
- * Deallocation might be delayed for efficiency purposes, for details check
- * the comments above max_cached_changes's definition.
  */
 void ReorderBufferReturnTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
 {
@@ -310,31 +315,19 @@ void ReorderBufferReturnTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
         txn->invalidations = NULL;
     }
 
-    /* check whether to put into the slab cache */
-    if (rb->nr_cached_transactions < g_max_cached_transactions) {
-        rb->nr_cached_transactions++;
-        dlist_push_head(&rb->cached_transactions, &txn->node);
-    } else {
-        pfree(txn);
-        txn = NULL;
-    }
+    pfree(txn);
+    txn = NULL;
 }
 
 /*
- * Get a unused, possibly preallocated, ReorderBufferChange.
+ * Get an unused ReorderBufferChange.
  */
 ReorderBufferChange* ReorderBufferGetChange(ReorderBuffer* rb)
 {
     ReorderBufferChange* change = NULL;
     int rc = 0;
-    /* check the slab cache */
-    if (rb->nr_cached_changes) {
-        rb->nr_cached_changes--;
-        change =
-            (ReorderBufferChange*)dlist_container(ReorderBufferChange, node, dlist_pop_head_node(&rb->cached_changes));
-    } else {
-        change = (ReorderBufferChange*)MemoryContextAlloc(rb->context, sizeof(ReorderBufferChange));
-    }
+
+    change = (ReorderBufferChange*)MemoryContextAlloc(rb->change_context, sizeof(ReorderBufferChange));
 
     rc = memset_s(change, sizeof(ReorderBufferChange), 0, sizeof(ReorderBufferChange));
     securec_check(rc, "", "");
@@ -344,9 +337,6 @@ ReorderBufferChange* ReorderBufferGetChange(ReorderBuffer* rb)
 
 /*
  * Free an ReorderBufferChange.
- *
- * Deallocation might be delayed for efficiency purposes, for details check
- * the comments above max_cached_changes's definition.
  */
 void ReorderBufferReturnChange(ReorderBuffer* rb, ReorderBufferChange* change)
 {
@@ -926,6 +916,7 @@ static ReorderBufferChange* ReorderBufferIterTXNNext(ReorderBuffer* rb, ReorderB
     }
 
     change = entry->change;
+    state->last_txn = entry->txn;
 
     /*
      * update heap with information about which transaction has the next
@@ -1064,6 +1055,12 @@ static void ReorderBufferCleanupTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
         dlist_delete(&txn->base_snapshot_node);
     }
 
+    /* and the snapshot streaming would have continued with */
+    if (txn->stream_snapshot != NULL) {
+        ReorderBufferFreeSnap(rb, txn->stream_snapshot);
+        txn->stream_snapshot = NULL;
+    }
+
     /*
      * Remove TXN from its containing list.
      *
@@ -1226,22 +1223,18 @@ static void ReorderBufferFreeSnap(ReorderBuffer* rb, Snapshot snap)
 }
 
 /*
- * Perform the replay of a transaction and its non-aborted subtransactions.
+ * Replay the changes of a transaction and its non-aborted subtransactions
+ * that are currently queued, in lsn order.
  *
- * Subtransactions previously have to be processed by
- * ReorderBufferCommitChild(), even if previously assigned to the toplevel
- * transaction with ReorderBufferAssignChild.
- *
- * We currently can only decode a transaction's contents when its commit
- * record is read because that's the only place where we know about cache
- * invalidations. Thus, once a toplevel commit is read, we iterate over the top
- * and subtransactions (using a k-way merge) and replay the changes in lsn
- * order.
+ * With "streaming" the transaction is still in progress: the queued changes
+ * are sent as one streamed block and released afterwards, and the snapshot
+ * reached is remembered so the next block, or the commit, continues from it.
+ * Otherwise the transaction has committed and is cleaned up afterwards; if
+ * parts of it were streamed before, the rest is streamed too and closed with
+ * a stream commit.
  */
-void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit_lsn, XLogRecPtr end_lsn,
-    RepOriginId origin_id, CommitSeqNo csn, TimestampTz commit_time)
+static void ReorderBufferProcessTXN(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr commit_lsn, bool streaming)
 {
-    ReorderBufferTXN* txn = NULL;
     ReorderBufferIterTXNState* volatile iterstate = NULL;
     ReorderBufferChange* change = NULL;
 
@@ -1250,31 +1243,14 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
     volatile bool txn_started = false;
     volatile bool subtxn_started = false;
 
-    txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr, false);
-    /* unknown transaction, nothing to replay */
-    if (txn == NULL)
-        return;
-
-    txn->final_lsn = commit_lsn;
-    txn->end_lsn = end_lsn;
-    txn->origin_id = origin_id;
-    txn->csn = csn;
-    txn->commit_time = commit_time;
-
-    /*
-     * If this transaction has no snapshot, it didn't make any changes to the
-     * database, so there's nothing to decode.  Note that
-     * ReorderBufferCommitChild will have transferred any snapshots from
-     * subtransactions if there were any.
-     */
-    if (txn->base_snapshot == NULL) {
-        Assert(txn->ninvalidations == 0);
-        ReorderBufferCleanupTXN(rb, txn);
-        return;
+    /* continue with the snapshot the last streamed block ended with */
+    if (txn->stream_snapshot != NULL) {
+        snapshot_now = txn->stream_snapshot;
+        txn->stream_snapshot = NULL;
+    } else {
+        snapshot_now = txn->base_snapshot;
     }
 
-    snapshot_now = txn->base_snapshot;
-
     /* build data to be able to lookup the CommandIds of catalog tuples */
     ReorderBufferBuildTupleCidHash(rb, txn);
 
@@ -1303,7 +1279,13 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
             txn_started = true;
         }
 
-        rb->begin(rb, txn);
+        if (streaming)
+            txn->streamed = true;
+
+        if (txn->streamed)
+            rb->stream_start(rb, txn);
+        else
+            rb->begin(rb, txn);
 
         iterstate = ReorderBufferIterTXNInit(rb, txn);
         while ((change = ReorderBufferIterTXNNext(rb, iterstate))) {
@@ -1363,7 +1345,10 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
                         if (relation->rd_rel->relkind == RELKIND_SEQUENCE) {
                         } else if (!IsToastRelation(relation)) { /* user-triggered change */
                             ReorderBufferToastReplace(rb, txn, relation, change, partitionReltoastrelid);
-                            rb->apply_change(rb, txn, relation, change);
+                            if (txn->streamed)
+                                rb->stream_change(rb, iterstate->last_txn, relation, change);
+                            else
+                                rb->apply_change(rb, txn, relation, change);
                             /*
                              * Only clear reassembled toast chunks if we're
                              * sure they're not required anymore. The creator
@@ -1444,8 +1429,14 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
         ReorderBufferIterTXNFinish(rb, iterstate);
         iterstate = NULL;
 
-        /* call commit callback */
-        rb->commit(rb, txn, commit_lsn);
+        /* call commit callback, or close the streamed block */
+        if (txn->streamed) {
+            rb->stream_stop(rb, txn);
+            if (!streaming)
+                rb->stream_commit(rb, txn, commit_lsn);
+        } else {
+            rb->commit(rb, txn, commit_lsn);
+        }
 
         /* this is just a sanity check against bad output plugin behaviour */
         if (GetCurrentTransactionIdIfAny() != InvalidTransactionId)
@@ -1470,11 +1461,25 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
         else if (txn_started)
             AbortCurrentTransaction();
 
-        if (snapshot_now->copied)
-            ReorderBufferFreeSnap(rb, snapshot_now);
+        if (streaming) {
+            /*
+             * Keep the snapshot for the next block. The one in use may belong
+             * to a change that is released below, so take a private copy.
+             */
+            if (snapshot_now->copied)
+                txn->stream_snapshot = snapshot_now;
+            else
+                txn->stream_snapshot = ReorderBufferCopySnap(rb, snapshot_now, txn, command_id);
 
-        /* remove potential on-disk data, and deallocate */
-        ReorderBufferCleanupTXN(rb, txn);
+            /* the streamed changes are not needed anymore */
+            ReorderBufferReleaseStreamedChanges(rb, txn);
+        } else {
+            if (snapshot_now->copied)
+                ReorderBufferFreeSnap(rb, snapshot_now);
+
+            /* remove potential on-disk data, and deallocate */
+            ReorderBufferCleanupTXN(rb, txn);
+        }
     }
     PG_CATCH();
     {
@@ -1506,6 +1511,52 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
     PG_END_TRY();
 }
 
+/*
+ * Perform the replay of a transaction and its non-aborted subtransactions.
+ *
+ * Subtransactions previously have to be processed by
+ * ReorderBufferCommitChild(), even if previously assigned to the toplevel
+ * transaction with ReorderBufferAssignChild.
+ *
+ * We currently can only decode a transaction's contents when its commit
+ * record is read because that's the only place where we know about cache
+ * invalidations. Thus, once a toplevel commit is read, we iterate over the top
+ * and subtransactions (using a k-way merge) and replay the changes in lsn
+ * order. Large transactions without catalog changes may have been streamed
+ * in part already, see ReorderBufferStreamTXN().
+ */
+void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit_lsn, XLogRecPtr end_lsn,
+    RepOriginId origin_id, CommitSeqNo csn, TimestampTz commit_time)
+{
+    ReorderBufferTXN* txn = NULL;
+
+    txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr, false);
+    /* unknown transaction, nothing to replay */
+    if (txn == NULL)
+        return;
+
+    txn->final_lsn = commit_lsn;
+    txn->end_lsn = end_lsn;
+    txn->origin_id = origin_id;
+    txn->csn = csn;
+    txn->commit_time = commit_time;
+
+    /*
+     * If this transaction has no snapshot, it didn't make any changes to the
+     * database, so there's nothing to decode.  Note that
+     * ReorderBufferCommitChild will have transferred any snapshots from
+     * subtransactions if there were any.
+     */
+    if (txn->base_snapshot == NULL) {
+        Assert(txn->ninvalidations == 0);
+        Assert(!txn->streamed);
+        ReorderBufferCleanupTXN(rb, txn);
+        return;
+    }
+
+    ReorderBufferProcessTXN(rb, txn, commit_lsn, false);
+}
+
 /*
  * Abort a transaction that possibly has previous changes. Needs to be first
  * called for subtransactions and then for the toplevel xid.
@@ -1530,6 +1581,10 @@ void ReorderBufferAbort(ReorderBuffer* rb, TransactionId xid, XLogRecPtr lsn)
     /* cosmetic... */
     txn->final_lsn = lsn;
 
+    /* changes streamed already have to be thrown away downstream */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /* remove potential on-disk data, and deallocate */
     ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1561,6 +1616,10 @@ void ReorderBufferAbortOld(ReorderBuffer* rb, TransactionId oldestRunningXid)
             if (!RecoveryInProgress())
                 ereport(DEBUG2, (errmsg("aborting old transaction %lu", txn->xid)));
 
+            /* there is no abort record, so no abort lsn either */
+            if (txn->streamed)
+                rb->stream_abort(rb, txn, InvalidXLogRecPtr);
+
             /* remove potential on-disk data, and deallocate this tx */
             ReorderBufferCleanupTXN(rb, txn);
         } else
@@ -1616,6 +1675,10 @@ void ReorderBufferForget(ReorderBuffer* rb, TransactionId xid, XLogRecPtr lsn)
     } else
         Assert(txn->ninvalidations == 0);
 
+    /* nothing of it is going to be committed downstream */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /* remove potential on-disk data, and deallocate */
     ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1839,11 +1902,167 @@ static void ReorderBufferCheckSerializeTXN(ReorderBuffer* rb, ReorderBufferTXN*
      * account here.
      */
     if (txn->nentries_mem >= (unsigned)g_instance.attr.attr_common.max_changes_in_memory) {
+        /*
+         * Send the transaction downstream right away if the output plugin
+         * can take it, instead of spooling it until commit.
+         */
+        ReorderBufferTXN* toptxn = txn;
+
+        if (txn->is_known_as_subxact)
+            toptxn = ReorderBufferTXNByXid(rb, txn->toplevel_xid, false, NULL, InvalidXLogRecPtr, false);
+
+        if (toptxn != NULL && ReorderBufferCanStreamTXN(rb, toptxn)) {
+            ReorderBufferStreamTXN(rb, toptxn);
+            return;
+        }
+
         ReorderBufferSerializeTXN(rb, txn);
         Assert(txn->nentries_mem == 0);
     }
 }
 
+/*
+ * Make sure txn is a running toplevel transaction and assign all of its
+ * subtransactions we have seen changes for, but don't know as such yet.
+ *
+ * Subtransactions are only linked to their parent in WAL at commit or by
+ * xact_assignment records, which come too late for streaming: the changes of
+ * a subtransaction have to be streamed in lsn order with the parent's. While
+ * the toplevel transaction is running the csnlog still knows the parents, so
+ * look them up there. Returns false if that is not possible anymore.
+ */
+static bool ReorderBufferAdoptSubxacts(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    dlist_mutable_iter iter;
+
+    /* the csnlog of long finished transactions may be truncated already */
+    if (TransactionIdPrecedes(txn->xid, GetOldestXmin(NULL)))
+        return false;
+
+    /* a subtransaction, or a transaction that's already committing */
+    if (CSNLogGetCommitSeqNo(txn->xid) != COMMITSEQNO_INPROGRESS)
+        return false;
+
+    /* subtransactions have been assigned later xids than their parent */
+    dlist_foreach_modify(iter, &rb->toplevel_by_lsn)
+    {
+        ReorderBufferTXN* cur_txn = dlist_container(ReorderBufferTXN, node, iter.cur);
+        TransactionId parent = cur_txn->xid;
+
+        while (TransactionIdFollows(parent, txn->xid)) {
+            CommitSeqNo csn = CSNLogGetCommitSeqNo(parent);
+
+            if (!COMMITSEQNO_IS_SUBTRANS(csn))
+                break;
+            parent = GET_PARENTXID(csn);
+        }
+
+        if (parent == txn->xid && cur_txn != txn)
+            ReorderBufferAssignChild(rb, txn->xid, cur_txn->xid, InvalidXLogRecPtr);
+    }
+
+    /*
+     * The parent links of subtransactions get overwritten when the toplevel
+     * transaction commits; if it still hasn't started to, all links read above
+     * were intact.
+     */
+    return CSNLogGetCommitSeqNo(txn->xid) == COMMITSEQNO_INPROGRESS;
+}
+
+/*
+ * Can the queued changes of the toplevel transaction txn be streamed before
+ * it commits?
+ */
+static bool ReorderBufferCanStreamTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    LogicalDecodingContext* ctx = (LogicalDecodingContext*)rb->private_data;
+    dlist_iter iter;
+
+    if (!ctx->streaming)
+        return false;
+
+    /* nothing before the consistent point or the requested start is sent */
+    if (SnapBuildCurrentState(ctx->snapshot_builder) < SNAPBUILD_CONSISTENT ||
+        SnapBuildXactNeedsSkip(ctx->snapshot_builder, ctx->reader->EndRecPtr))
+        return false;
+
+    if (txn->base_snapshot == NULL || !ReorderBufferAdoptSubxacts(rb, txn))
+        return false;
+
+    /*
+     * Catalog changes can only be decoded with the invalidations that come
+     * with the commit record, and spooled changes stay on the serialization
+     * path until commit.
+     */
+    if (txn->has_catalog_changes || txn->serialized)
+        return false;
+
+    dlist_foreach(iter, &txn->subtxns)
+    {
+        ReorderBufferTXN* subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+        if (subtxn->has_catalog_changes || subtxn->serialized)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Stream the changes of a large, still running transaction queued so far.
+ */
+static void ReorderBufferStreamTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    if (!RecoveryInProgress())
+        ereport(DEBUG2,
+            (errmsg("streaming %lu changes of in-progress transaction %lu", txn->nentries_mem, txn->xid)));
+
+    ReorderBufferProcessTXN(rb, txn, InvalidXLogRecPtr, true);
+}
+
+/*
+ * Release the changes of txn and its subtransactions after they have been
+ * streamed. Toast chunks of a row whose main tuple is still to come have been
+ * moved to the toast hash by then and survive until the next block.
+ */
+static void ReorderBufferReleaseStreamedChanges(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    dlist_mutable_iter iter;
+    dlist_iter subtxn_i;
+
+    Assert(!txn->serialized);
+
+    dlist_foreach_modify(iter, &txn->changes)
+    {
+        ReorderBufferChange* change = dlist_container(ReorderBufferChange, node, iter.cur);
+
+        dlist_delete(&change->node);
+        ReorderBufferReturnChange(rb, change);
+    }
+    txn->nentries = 0;
+    txn->nentries_mem = 0;
+
+    dlist_foreach(subtxn_i, &txn->subtxns)
+    {
+        ReorderBufferTXN* subtxn = dlist_container(ReorderBufferTXN, node, subtxn_i.cur);
+
+        Assert(!subtxn->serialized);
+
+        dlist_foreach_modify(iter, &subtxn->changes)
+        {
+            ReorderBufferChange* change = dlist_container(ReorderBufferChange, node, iter.cur);
+
+            dlist_delete(&change->node);
+            ReorderBufferReturnChange(rb, change);
+        }
+        subtxn->nentries = 0;
+        subtxn->nentries_mem = 0;
+
+        /* an abort of this subtransaction has to reach the plugin, too */
+        subtxn->streamed = true;
+    }
+}
+
 /*
  * Spill data of a large transaction (and its subtransactions) to disk.
  */
@@ -317,6 +317,43 @@ void SyncRepWaitForLSN(XLogRecPtr XactCommitLSN)
     RESUME_INTERRUPTS();
 }
 
+/*
+ * Return the mode SyncRepWaitForLSN would wait in right now, or
+ * SYNC_REP_NO_WAIT if it would return at once.  Used by commits whose
+ * acknowledgement is deferred to the thread pool listener.
+ */
+int SyncRepGetDeferredWaitMode(void)
+{
+    if (!u_sess->attr.attr_storage.enable_stream_replication || !SyncRepRequested() || !SyncStandbysDefined() ||
+        (t_thrd.postmaster_cxt.HaShmData->current_mode == NORMAL_MODE))
+        return SYNC_REP_NO_WAIT;
+
+    return SyncRepWaitMode;
+}
+
+/*
+ * Check without waiting whether XactCommitLSN is confirmed by the sync
+ * standbys in the given mode.  As in SyncRepWaitForLSN, a commit is also
+ * released when no sync standbys are defined or the master runs standalone.
+ */
+bool SyncRepLSNConfirmed(XLogRecPtr XactCommitLSN, int mode)
+{
+    bool confirmed = false;
+
+    if (mode == SYNC_REP_NO_WAIT)
+        return true;
+
+    Assert(mode >= 0 && mode < NUM_SYNC_REP_WAIT_MODE);
+
+    (void)LWLockAcquire(SyncRepLock, LW_SHARED);
+    confirmed = !t_thrd.walsender_cxt.WalSndCtl->sync_standbys_defined ||
+                XLByteLE(XactCommitLSN, t_thrd.walsender_cxt.WalSndCtl->lsn[mode]) ||
+                t_thrd.walsender_cxt.WalSndCtl->sync_master_standalone;
+    LWLockRelease(SyncRepLock);
+
+    return confirmed;
+}
+
 /*
  * Insert t_thrd.proc into the specified SyncRepQueue, maintaining sorted invariant.
  *
@@ -28,6 +28,7 @@
 #include "postmaster/bgwriter.h"
 #include "storage/fd.h"
 #include "storage/bufmgr.h"
+#include "storage/page_compression.h"
 #include "storage/relfilenode.h"
 #include "storage/smgr.h"
 #include "utils/aiomem.h"
@@ -103,13 +104,23 @@
  *  segment, we assume that any subsequent segments are inactive.
  *
  *  All MdfdVec objects are palloc'd in the MdCxt memory context.
+ *
+ *  Segments of a main fork created with page compression have a chunk
+ *  address file next to them (see page_compression.cpp); mdfd_pcmap maps
+ *  it, and all block I/O on the segment goes through it.  Whether a fork
+ *  is compressed is decided by segment 0, later segments follow it.
  */
 typedef struct _MdfdVec {
     File mdfd_vfd;               /* fd number in fd.c's pool */
     BlockNumber mdfd_segno;      /* segment number, from 0 */
     struct _MdfdVec* mdfd_chain; /* next segment, or NULL */
+    PageCompressMap* mdfd_pcmap; /* address map of a compressed segment, or NULL */
 } MdfdVec;
 
+/* Only main forks of user relations can be compressed */
+#define MdForkMayBeCompressed(reln, forknum) \
+    ((forknum) == MAIN_FORKNUM && (reln)->smgr_rnode.node.relNode >= FirstNormalObjectId)
+
 /*
  * In some contexts (currently, standalone backends and the checkpointer)
  * we keep track of pending fsync operations: we need to remember all relation
@@ -155,6 +166,7 @@ typedef enum {             /* behavior for mdopen & _mdfd_getseg */
 
 /* local routines */
 static void mdunlinkfork(const RelFileNodeBackend& rnode, ForkNumber forkNum, bool isRedo);
+static bool mdread_internal(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer, bool tryRead);
 static MdfdVec* mdopen(SMgrRelation reln, ForkNumber forknum, ExtensionBehavior behavior);
 static void register_dirty_segment(SMgrRelation reln, ForkNumber forknum, const MdfdVec* seg);
 static void register_unlink(const RelFileNodeBackend& rnode);
@@ -164,6 +176,8 @@ static MdfdVec* _mdfd_openseg(SMgrRelation reln, ForkNumber forkno, BlockNumber
 static MdfdVec* _mdfd_getseg(
     SMgrRelation reln, ForkNumber forkno, BlockNumber blkno, bool skipFsync, ExtensionBehavior behavior);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum, const MdfdVec* seg);
+static int _mdfd_sync(const MdfdVec* seg, uint32 wait_event_info);
+static void _mdfd_close(MdfdVec* seg);
 
 /*
  *  mdinit() -- Initialize private state for magnetic disk storage manager.
@@ -297,13 +311,23 @@ void mdcreate(SMgrRelation reln, ForkNumber forkNum, bool isRedo)
         }
     }
 
-    pfree(path);
-
     reln->md_fd[forkNum] = _fdvec_alloc();
 
     reln->md_fd[forkNum]->mdfd_vfd = fd;
     reln->md_fd[forkNum]->mdfd_segno = 0;
     reln->md_fd[forkNum]->mdfd_chain = NULL;
+    reln->md_fd[forkNum]->mdfd_pcmap = NULL;
+
+    /*
+     * A compressed fork gets its address file right away; in redo the file
+     * may exist already and is picked up even if the record did not ask for
+     * compression.
+     */
+    if (MdForkMayBeCompressed(reln, forkNum)) {
+        reln->md_fd[forkNum]->mdfd_pcmap = PageCompressOpenMap(path, reln->smgr_compress);
+    }
+
+    pfree(path);
 }
 
 /*
@@ -414,6 +438,11 @@ static void mdunlinkfork(const RelFileNodeBackend& rnode, ForkNumber forkNum, bo
         register_unlink(rnode);
     }
 
+    /* The address file of a compressed segment goes right away */
+    if (forkNum == MAIN_FORKNUM) {
+        PageCompressUnlinkMap(path);
+    }
+
     /*
      * Delete any additional segments.
      */
@@ -436,6 +465,9 @@ static void mdunlinkfork(const RelFileNodeBackend& rnode, ForkNumber forkNum, bo
                 }
                 break;
             }
+            if (forkNum == MAIN_FORKNUM) {
+                PageCompressUnlinkMap(segpath);
+            }
         }
         pfree(segpath);
     }
@@ -489,7 +521,13 @@ void mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const
      * if bufmgr.c had to dump another buffer of the same file to make room
      * for the new page's buffer.
      */
-    if ((nbytes = FilePWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_EXTEND)) != BLCKSZ) {
+    if (v->mdfd_pcmap != NULL) {
+        nbytes = PageCompressWriteBlock(v->mdfd_pcmap,
+            v->mdfd_vfd, blocknum % ((BlockNumber)RELSEG_SIZE), buffer, WAIT_EVENT_DATA_FILE_EXTEND);
+    } else {
+        nbytes = FilePWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_EXTEND);
+    }
+    if (nbytes != BLCKSZ) {
         if (nbytes < 0) {
             ereport(ERROR,
                 (errcode_for_file_access(),
@@ -573,13 +611,16 @@ static MdfdVec* mdopen(SMgrRelation reln, ForkNumber forknum, ExtensionBehavior
         }
     }
 
-    pfree(path);
-
     reln->md_fd[forknum] = mdfd = _fdvec_alloc();
 
     mdfd->mdfd_vfd = fd;
     mdfd->mdfd_segno = 0;
     mdfd->mdfd_chain = NULL;
+    mdfd->mdfd_pcmap = NULL;
+    if (MdForkMayBeCompressed(reln, forknum)) {
+        mdfd->mdfd_pcmap = PageCompressOpenMap(path, 0);
+    }
+    pfree(path);
     Assert(_mdnblocks(reln, forknum, mdfd) <= ((BlockNumber)RELSEG_SIZE));
 
     return mdfd;
@@ -602,14 +643,9 @@ void mdclose(SMgrRelation reln, ForkNumber forknum)
     while (v != NULL) {
         MdfdVec* ov = v;
 
-        /* if not closed already */
-        if (v->mdfd_vfd >= 0) {
-            FileClose(v->mdfd_vfd);
-        }
-        
-        /* Now free vector */
+        /* Now close and free vector */
         v = v->mdfd_chain;
-        pfree(ov);
+        _mdfd_close(ov);
     }
 }
 
@@ -624,6 +660,11 @@ void mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
 
     v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
 
+    /* blocks of a compressed segment are not where the kernel could guess */
+    if (v->mdfd_pcmap != NULL) {
+        return;
+    }
+
     seekpos = (off_t)BLCKSZ * (blocknum % ((BlockNumber)RELSEG_SIZE));
 
     Assert(seekpos < (off_t)BLCKSZ * RELSEG_SIZE);
@@ -673,7 +714,10 @@ void mdwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, Bl
 
         seekpos = (off_t)BLCKSZ * (blocknum % ((BlockNumber)RELSEG_SIZE));
 
-        FileWriteback(v->mdfd_vfd, seekpos, (off_t)BLCKSZ * nflush);
+        /* chunks of a compressed segment are left to the checkpoint's fsync */
+        if (v->mdfd_pcmap == NULL) {
+            FileWriteback(v->mdfd_vfd, seekpos, (off_t)BLCKSZ * nflush);
+        }
 
         nblocks -= nflush;
         blocknum += nflush;
@@ -711,6 +755,11 @@ void mdasyncread(SMgrRelation reln, ForkNumber forkNum, AioDispatchDesc_t** dLis
          * and calculate the I/O offset into the segment.
          */
         v = _mdfd_getseg(dList[i]->blockDesc.smgrReln, dList[i]->blockDesc.forkNum, block_num, false, EXTENSION_FAIL);
+        if (v->mdfd_pcmap != NULL) {
+            ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                    errmsg("asynchronous I/O is not supported for compressed file \"%s\"", FilePathName(v->mdfd_vfd))));
+        }
 
         offset = (off_t)BLCKSZ * (block_num % ((BlockNumber)RELSEG_SIZE));
 
@@ -813,6 +862,11 @@ void mdasyncwrite(SMgrRelation reln, ForkNumber forkNumber, AioDispatchDesc_t**
          * and calculate the I/O offset into the segment.
          */
         v = _mdfd_getseg(smgr_rel, fork_num, block_num, false, EXTENSION_FAIL);
+        if (v->mdfd_pcmap != NULL) {
+            ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                    errmsg("asynchronous I/O is not supported for compressed file \"%s\"", FilePathName(v->mdfd_vfd))));
+        }
 
         offset = (off_t)BLCKSZ * (block_num % ((BlockNumber)RELSEG_SIZE));
 
@@ -965,10 +1019,27 @@ do {\
  *  mdread() -- Read the specified block from a relation.
  */
 void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer)
+{
+    (void)mdread_internal(reln, forknum, blocknum, buffer, false);
+}
+
+/*
+ *  mdtryread() -- Read the specified block, reporting a bad one.
+ *
+ *		Returns false for a block that cannot be read in full, or whose
+ *		compressed image does not decode, instead of raising ERROR.
+ */
+bool mdtryread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer)
+{
+    return mdread_internal(reln, forknum, blocknum, buffer, true);
+}
+
+static bool mdread_internal(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer, bool tryRead)
 {
     off_t seekpos;
     int nbytes;
     MdfdVec* v = NULL;
+    bool badBlock = false;
 
     instr_time start_time;
     instr_time end_time;
@@ -1000,7 +1071,12 @@ void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* b
         ereport(ERROR, (errmsg("seekpos is too large")));
     }
 
-    nbytes = FilePRead(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_READ);
+    if (v->mdfd_pcmap != NULL) {
+        nbytes = PageCompressReadBlock(
+            v->mdfd_pcmap, v->mdfd_vfd, blocknum % ((BlockNumber)RELSEG_SIZE), buffer, tryRead ? &badBlock : NULL);
+    } else {
+        nbytes = FilePRead(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_READ);
+    }
 
     TRACE_POSTGRESQL_SMGR_MD_READ_DONE(forknum, blocknum, reln->smgr_rnode.node.spcNode,
         reln->smgr_rnode.node.dbNode, reln->smgr_rnode.node.relNode, reln->smgr_rnode.backend,
@@ -1053,12 +1129,19 @@ void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* b
         max_time = time_diff;
     }
 
+    if (badBlock) {
+        return false;
+    }
     if (nbytes != BLCKSZ) {
         if (nbytes < 0) {
             ereport(ERROR,
                 (errcode_for_file_access(),
                     errmsg("could not read block %u in file \"%s\": %m", blocknum, FilePathName(v->mdfd_vfd))));
         }
+        if (tryRead) {
+            MemSet(buffer, 0, BLCKSZ);
+            return false;
+        }
         /*
          * Short read: we are at or past EOF, or we read a partial block at
          * EOF.  Normally this is an error; upper levels should never try to
@@ -1081,6 +1164,7 @@ void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* b
                         BLCKSZ)));
         }
     }
+    return true;
 }
 
 /*
@@ -1129,7 +1213,12 @@ void mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const
 
     Assert(seekpos < (off_t)BLCKSZ * RELSEG_SIZE);
 
-    nbytes = FilePWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_WRITE);
+    if (v->mdfd_pcmap != NULL) {
+        nbytes = PageCompressWriteBlock(v->mdfd_pcmap,
+            v->mdfd_vfd, blocknum % ((BlockNumber)RELSEG_SIZE), buffer, WAIT_EVENT_DATA_FILE_WRITE);
+    } else {
+        nbytes = FilePWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_WRITE);
+    }
 
     TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum, 
         reln->smgr_rnode.node.spcNode, reln->smgr_rnode.node.dbNode, reln->smgr_rnode.node.relNode, 
@@ -1310,7 +1399,9 @@ void mdtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
              * from the mdfd_chain). We truncate the file, but do not delete
              * it, for reasons explained in the header comments.
              */
-            if (FileTruncate(v->mdfd_vfd, 0, WAIT_EVENT_DATA_FILE_TRUNCATE) < 0) {
+            int ret = (v->mdfd_pcmap != NULL) ? PageCompressTruncate(v->mdfd_pcmap, v->mdfd_vfd, 0)
+                                              : FileTruncate(v->mdfd_vfd, 0, WAIT_EVENT_DATA_FILE_TRUNCATE);
+            if (ret < 0) {
                 ereport(ERROR,
                     (errcode_for_file_access(),
                         errmsg("could not truncate file \"%s\": %m", FilePathName(v->mdfd_vfd))));
@@ -1322,8 +1413,7 @@ void mdtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
             
             v = v->mdfd_chain;
             Assert(ov != reln->md_fd[forknum]); /* we never drop the 1st segment */
-            FileClose(ov->mdfd_vfd);
-            pfree(ov);
+            _mdfd_close(ov);
         } else if (prior_blocks + ((BlockNumber)RELSEG_SIZE) > nblocks) {
             /*
              * This is the last segment we want to keep. Truncate the file to
@@ -1334,8 +1424,11 @@ void mdtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
              * given in the header comments.
              */
             BlockNumber last_seg_blocks = nblocks - prior_blocks;
+            int ret = (v->mdfd_pcmap != NULL)
+                          ? PageCompressTruncate(v->mdfd_pcmap, v->mdfd_vfd, last_seg_blocks)
+                          : FileTruncate(v->mdfd_vfd, (off_t)last_seg_blocks * BLCKSZ, WAIT_EVENT_DATA_FILE_TRUNCATE);
 
-            if (FileTruncate(v->mdfd_vfd, (off_t)last_seg_blocks * BLCKSZ, WAIT_EVENT_DATA_FILE_TRUNCATE) < 0) {
+            if (ret < 0) {
                 ereport(ERROR,
                     (errcode_for_file_access(),
                         errmsg("could not truncate file \"%s\" to %u blocks: %m",
@@ -1377,7 +1470,7 @@ void mdimmedsync(SMgrRelation reln, ForkNumber forknum)
     v = mdopen(reln, forknum, EXTENSION_FAIL);
 
     while (v != NULL) {
-        if (FileSync(v->mdfd_vfd, WAIT_EVENT_DATA_FILE_IMMEDIATE_SYNC) < 0) {
+        if (_mdfd_sync(v, WAIT_EVENT_DATA_FILE_IMMEDIATE_SYNC) < 0) {
             ereport(data_sync_elevel(ERROR),
                 (errcode_for_file_access(), errmsg("could not fsync file \"%s\": %m", FilePathName(v->mdfd_vfd))));
         }
@@ -1561,7 +1654,7 @@ void mdsync(void)
 
                     INSTR_TIME_SET_CURRENT(sync_start);
 
-                    if (seg != NULL && FileSync(seg->mdfd_vfd, WAIT_EVENT_DATA_FILE_SYNC) >= 0) {
+                    if (seg != NULL && _mdfd_sync(seg, WAIT_EVENT_DATA_FILE_SYNC) >= 0) {
                         /* Success; update statistics about sync timing */
                         INSTR_TIME_SET_CURRENT(sync_end);
                         sync_diff = sync_end;
@@ -1766,7 +1859,7 @@ static void register_dirty_segment(SMgrRelation reln, ForkNumber forknum, const
         
         ereport(DEBUG1, (errmsg("could not forward fsync request because request queue is full")));
 
-        if (FileSync(seg->mdfd_vfd, WAIT_EVENT_DATA_FILE_SYNC) < 0) {
+        if (_mdfd_sync(seg, WAIT_EVENT_DATA_FILE_SYNC) < 0) {
             ereport(data_sync_elevel(ERROR),
                 (errcode_for_file_access(), errmsg("could not fsync file \"%s\": %m", FilePathName(seg->mdfd_vfd))));
         }
@@ -2108,6 +2201,17 @@ static MdfdVec* _mdfd_openseg(SMgrRelation reln, ForkNumber forknum, BlockNumber
     v->mdfd_vfd = fd;
     v->mdfd_segno = segno;
     v->mdfd_chain = NULL;
+    v->mdfd_pcmap = NULL;
+
+    /*
+     * Segments of a compressed fork are compressed the same way; create the
+     * address file if a crash left the segment without one.
+     */
+    if (reln->md_fd[forknum] != NULL && reln->md_fd[forknum]->mdfd_pcmap != NULL) {
+        fullpath = _mdfd_segpath(reln, forknum, segno);
+        v->mdfd_pcmap = PageCompressOpenMap(fullpath, PageCompressGetOpt(reln->md_fd[forknum]->mdfd_pcmap));
+        pfree(fullpath);
+    }
     Assert(_mdnblocks(reln, forknum, v) <= ((BlockNumber)RELSEG_SIZE));
 
     /* all done */
@@ -2218,6 +2322,11 @@ static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum, const MdfdV
 {
     off_t len;
 
+    /* the segment file of a compressed segment only holds chunks */
+    if (seg->mdfd_pcmap != NULL) {
+        return PageCompressGetNBlocks(seg->mdfd_pcmap);
+    }
+
     len = FileSeek(seg->mdfd_vfd, 0L, SEEK_END);
     if (len < 0) {
         ereport(ERROR,
@@ -2228,3 +2337,29 @@ static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum, const MdfdV
     /* note that this calculation will ignore any partial block at EOF */
     return (BlockNumber)(len / BLCKSZ);
 }
+
+/*
+ * Fsync a segment, including the address file of a compressed one.
+ */
+static int _mdfd_sync(const MdfdVec* seg, uint32 wait_event_info)
+{
+    if (seg->mdfd_pcmap != NULL) {
+        return PageCompressSyncMap(seg->mdfd_pcmap, seg->mdfd_vfd, wait_event_info);
+    }
+    return FileSync(seg->mdfd_vfd, wait_event_info);
+}
+
+/*
+ * Close a segment and free its MdfdVec.
+ */
+static void _mdfd_close(MdfdVec* seg)
+{
+    /* if not closed already */
+    if (seg->mdfd_vfd >= 0) {
+        FileClose(seg->mdfd_vfd);
+    }
+    if (seg->mdfd_pcmap != NULL) {
+        PageCompressCloseMap(seg->mdfd_pcmap);
+    }
+    pfree(seg);
+}
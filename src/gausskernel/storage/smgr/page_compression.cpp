@@ -0,0 +1,758 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * page_compression.cpp
+ *        Chunk address files and block codecs for compressed segments.
+ *
+ * md.cpp hands every block of a compressed segment to this module instead
+ * of reading or writing it at BLCKSZ * blkno.  A block is compressed into
+ * as few chunks as possible; a block that does not shrink by at least one
+ * chunk is stored as is.
+ *
+ * Chunks holding the current image of a block are never overwritten.  A
+ * write puts the new image into free chunks, or chunks freshly taken from
+ * the end of the segment file, and only then switches the block's entry to
+ * them.  The old chunks are released, but they become free only after a
+ * sync has made the segment and the switched entry durable: until then a
+ * crash may bring back the old entry, which must still find its image.
+ * A torn new image is what a crash during the write leaves, and it is
+ * repaired like any torn page, from the double write file or a full page
+ * image in the WAL; the double write recovery reads with badBlock set so
+ * that an image that does not decompress is reported instead of raising
+ * ERROR.
+ *
+ * The address file is written through a shared mapping.  A crash can leave
+ * its header and bitmaps behind the entries, so they are rebuilt from the
+ * entries when recovery first opens the segment.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/smgr/page_compression.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "catalog/pg_am.h"
+#include "lz4.h"
+#include "pgstat.h"
+#include "storage/barrier.h"
+#include "storage/page_compression.h"
+#include "utils/atomic.h"
+#include "utils/memutils.h"
+#include "utils/pg_lzcompress.h"
+#include "utils/rel.h"
+#include "utils/rel_gs.h"
+
+/* bytes in front of the codec output in the first chunk of a compressed block */
+#define COMPRESSED_SIZE_LEN ((int)sizeof(uint32))
+
+static Size PageCompressMapSize(uint16 chunkSize)
+{
+    return TYPEALIGN(BLCKSZ, PageCompressBitmapOffset(chunkSize, PAGE_COMPRESS_NUM_BITMAPS));
+}
+
+static bool PageCompressChunkSizeIsValid(int chunkSize)
+{
+    return chunkSize == BLCKSZ / 2 || chunkSize == BLCKSZ / 4 || chunkSize == BLCKSZ / 8 || chunkSize == BLCKSZ / 16;
+}
+
+/*
+ * PageCompressCheckOptions
+ *		Reject reloption values that mdcreate() could not honour.
+ */
+void PageCompressCheckOptions(int algorithm, int chunkSize)
+{
+    if (algorithm < PAGE_COMPRESS_NONE || algorithm > PAGE_COMPRESS_MAX_ALGORITHM) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("invalid value %d for option \"compresstype\"", algorithm),
+                errdetail("Valid values are 0 (none), 1 (pglz) and 2 (lz4).")));
+    }
+    if (!PageCompressChunkSizeIsValid(chunkSize)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("invalid value %d for option \"compress_chunk_size\"", chunkSize),
+                errdetail("Valid values are %d, %d, %d and %d.", BLCKSZ / 16, BLCKSZ / 8, BLCKSZ / 4, BLCKSZ / 2)));
+    }
+}
+
+/*
+ * PageCompressOptFromReloptions
+ *		Pack the page compression settings of parsed StdRdOptions.
+ */
+uint32 PageCompressOptFromReloptions(const bytea* options)
+{
+    const StdRdOptions* stdopts = (const StdRdOptions*)options;
+
+    if (stdopts == NULL || stdopts->compresstype == PAGE_COMPRESS_NONE) {
+        return 0;
+    }
+    PageCompressCheckOptions(stdopts->compresstype, stdopts->compress_chunk_size);
+    return PAGE_COMPRESS_OPT(stdopts->compresstype, stdopts->compress_chunk_size);
+}
+
+/*
+ * RelationGetPageCompressOpt
+ *		Compression to use for new main-fork storage of the relation.
+ *
+ * Only heaps and btree indexes parse their options into StdRdOptions with
+ * the compression fields; everything else is stored uncompressed.
+ */
+uint32 RelationGetPageCompressOpt(Relation relation)
+{
+    if (relation->rd_rel->relkind == RELKIND_RELATION && RelationIsRowFormat(relation)) {
+        return PageCompressOptFromReloptions(relation->rd_options);
+    }
+    if (relation->rd_rel->relkind == RELKIND_INDEX && relation->rd_rel->relam == BTREE_AM_OID) {
+        return PageCompressOptFromReloptions(relation->rd_options);
+    }
+    return 0;
+}
+
+static char* PageCompressAddrPath(const char* segpath)
+{
+    size_t len = strlen(segpath) + sizeof(PCA_SUFFIX);
+    char* pcapath = (char*)palloc(len);
+    int rc = snprintf_s(pcapath, len, len - 1, "%s%s", segpath, PCA_SUFFIX);
+    securec_check_ss(rc, "", "");
+    return pcapath;
+}
+
+static void PageCompressAtomicMax(volatile uint32* ptr, uint32 val)
+{
+    uint32 old = pg_atomic_read_u32(ptr);
+
+    while (old < val) {
+        if (pg_atomic_compare_exchange_u32(ptr, &old, val)) {
+            break;
+        }
+    }
+}
+
+#define CHUNK_BIT(chunkno) ((uint64)1 << (((chunkno) - 1) % 64))
+#define CHUNK_WORD(chunkno) (((chunkno) - 1) / 64)
+
+/*
+ * Bring the header and bitmaps of a map written before a crash up to date
+ * with its entries: nblocks and allocated_chunks may not have reached the
+ * disk although entries relying on them did, and the bitmaps may be from
+ * any point in time.  Every allocated chunk no entry points at is free.
+ */
+static void PageCompressRepairMap(PageCompressHeader* header)
+{
+    volatile uint64* freemap = GetPageCompressBitmap(header, PAGE_COMPRESS_FREE_BITMAP);
+    Size nwords = PageCompressBitmapWords(header->chunk_size);
+    uint32 maxChunks = PageCompressMaxChunks(header->chunk_size);
+    int blockChunks = BLCKSZ / header->chunk_size;
+    uint32 allocated = pg_atomic_read_u32(&header->allocated_chunks);
+    uint32 nblocks = 0;
+    uint32 nfree = 0;
+    errno_t rc;
+
+    for (BlockNumber blkno = 0; blkno < RELSEG_SIZE; blkno++) {
+        PageCompressAddr* addr = GetPageCompressAddr(header, blkno);
+
+        if (addr->nchunks == 0 || addr->nchunks > blockChunks) {
+            continue;
+        }
+        for (int i = 0; i < addr->nchunks; i++) {
+            if (addr->chunknos[i] <= maxChunks) {
+                allocated = Max(allocated, addr->chunknos[i]);
+            }
+        }
+        nblocks = blkno + 1;
+    }
+    allocated = Min(allocated, maxChunks);
+
+    rc = memset_s((void*)freemap,
+        PAGE_COMPRESS_NUM_BITMAPS * nwords * sizeof(uint64),
+        0,
+        PAGE_COMPRESS_NUM_BITMAPS * nwords * sizeof(uint64));
+    securec_check(rc, "", "");
+    for (uint32 chunkno = 1; chunkno <= allocated; chunkno++) {
+        freemap[CHUNK_WORD(chunkno)] |= CHUNK_BIT(chunkno);
+    }
+    for (BlockNumber blkno = 0; blkno < RELSEG_SIZE; blkno++) {
+        PageCompressAddr* addr = GetPageCompressAddr(header, blkno);
+
+        if (addr->nchunks > blockChunks) {
+            continue;
+        }
+        for (int i = 0; i < addr->nchunks; i++) {
+            if (addr->chunknos[i] >= 1 && addr->chunknos[i] <= allocated) {
+                freemap[CHUNK_WORD(addr->chunknos[i])] &= ~CHUNK_BIT(addr->chunknos[i]);
+            }
+        }
+    }
+    for (Size i = 0; i < nwords; i++) {
+        nfree += (uint32)__builtin_popcountll(freemap[i]);
+    }
+
+    pg_atomic_write_u32(&header->allocated_chunks, allocated);
+    pg_atomic_write_u32(&header->free_chunks, nfree);
+    pg_atomic_write_u32(&header->free_hint, 0);
+    pg_atomic_write_u32(&header->syncing, 0);
+    PageCompressAtomicMax(&header->nblocks, nblocks);
+}
+
+/*
+ * PageCompressOpenMap
+ *		Map the address file of a segment.
+ *
+ * With createOpt zero only an existing address file is opened and NULL
+ * means the segment is not compressed.  Otherwise the file is created and
+ * initialized from createOpt if needed; an existing header always wins.
+ * The map is allocated in MdCxt, next to the MdfdVec that owns it.
+ */
+PageCompressMap* PageCompressOpenMap(const char* segpath, uint32 createOpt)
+{
+    char* pcapath = PageCompressAddrPath(segpath);
+    PageCompressHeader probe;
+    PageCompressHeader* header = NULL;
+    PageCompressMap* map = NULL;
+    struct stat st;
+    uint16 chunkSize;
+    Size size;
+    int flags = O_RDWR | PG_BINARY | (createOpt != 0 ? O_CREAT : 0);
+    int fd;
+
+    fd = BasicOpenFile(pcapath, flags, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        if (createOpt == 0 && errno == ENOENT) {
+            pfree(pcapath);
+            return NULL;
+        }
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not open file \"%s\": %m", pcapath)));
+    }
+
+    if (fstat(fd, &st) < 0) {
+        int save_errno = errno;
+        (void)close(fd);
+        errno = save_errno;
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not stat file \"%s\": %m", pcapath)));
+    }
+
+    if (st.st_size < (off_t)sizeof(PageCompressHeader)) {
+        probe.magic = 0;
+    } else if (pread(fd, &probe, sizeof(probe), 0) != (ssize_t)sizeof(probe)) {
+        int save_errno = errno;
+        (void)close(fd);
+        errno = save_errno;
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not read file \"%s\": %m", pcapath)));
+    }
+
+    /*
+     * An uninitialized file is what a crash right after creating it leaves
+     * behind; nothing can have been written to the segment through it yet.
+     */
+    if (probe.magic == 0 && createOpt == 0) {
+        (void)close(fd);
+        pfree(pcapath);
+        return NULL;
+    }
+    chunkSize = (probe.magic == PAGE_COMPRESS_MAGIC) ? probe.chunk_size : PAGE_COMPRESS_OPT_CHUNK_SIZE(createOpt);
+
+    if (!PageCompressChunkSizeIsValid(chunkSize)) {
+        (void)close(fd);
+        ereport(ERROR,
+            (errcode(ERRCODE_DATA_CORRUPTED),
+                errmsg("invalid chunk size %u in page compression address file \"%s\"", chunkSize, pcapath)));
+    }
+
+    size = PageCompressMapSize(chunkSize);
+    if (st.st_size < (off_t)size) {
+        if (createOpt == 0) {
+            (void)close(fd);
+            ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                    errmsg("page compression address file \"%s\" is truncated", pcapath)));
+        }
+        if (ftruncate(fd, (off_t)size) < 0) {
+            int save_errno = errno;
+            (void)close(fd);
+            errno = save_errno;
+            ereport(ERROR,
+                (errcode_for_file_access(),
+                    errmsg("could not extend file \"%s\": %m", pcapath),
+                    errhint("Check free disk space.")));
+        }
+    }
+
+    header = (PageCompressHeader*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        int save_errno = errno;
+        (void)close(fd);
+        errno = save_errno;
+        ereport(ERROR, (errcode_for_file_access(), errmsg("could not map file \"%s\": %m", pcapath)));
+    }
+    /* the mapping keeps the file alive, no need to hold a descriptor */
+    (void)close(fd);
+
+    if (header->magic != PAGE_COMPRESS_MAGIC) {
+        if (createOpt == 0) {
+            (void)munmap(header, size);
+            ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                    errmsg("invalid magic number in page compression address file \"%s\"", pcapath)));
+        }
+        header->algorithm = PAGE_COMPRESS_OPT_ALGORITHM(createOpt);
+        header->chunk_size = chunkSize;
+        pg_write_barrier();
+        header->magic = PAGE_COMPRESS_MAGIC;
+    } else if (t_thrd.xlog_cxt.InRecovery) {
+        PageCompressRepairMap(header);
+    }
+
+    if (header->algorithm == PAGE_COMPRESS_NONE || header->algorithm > PAGE_COMPRESS_MAX_ALGORITHM) {
+        (void)munmap(header, size);
+        ereport(ERROR,
+            (errcode(ERRCODE_DATA_CORRUPTED),
+                errmsg("invalid algorithm %u in page compression address file \"%s\"", header->algorithm, pcapath)));
+    }
+
+    pfree(pcapath);
+
+    map = (PageCompressMap*)MemoryContextAlloc(u_sess->storage_cxt.MdCxt, sizeof(PageCompressMap));
+    map->header = header;
+    map->size = size;
+    return map;
+}
+
+void PageCompressCloseMap(PageCompressMap* map)
+{
+    (void)munmap(map->header, map->size);
+    pfree(map);
+}
+
+/*
+ * PageCompressUnlinkMap
+ *		Remove the address file of a segment, if there is one.
+ *
+ * Like mdunlink, complain with WARNING only.
+ */
+void PageCompressUnlinkMap(const char* segpath)
+{
+    char* pcapath = PageCompressAddrPath(segpath);
+
+    if (unlink(pcapath) < 0 && errno != ENOENT) {
+        ereport(WARNING, (errcode_for_file_access(), errmsg("could not remove file \"%s\": %m", pcapath)));
+    }
+    pfree(pcapath);
+}
+
+/*
+ * PageCompressSyncMap
+ *		Fsync a compressed segment and its address file.
+ *
+ * The chunks released before the sync started become free once both are
+ * on disk.  Releases switch to the other release bitmap first, so that
+ * those made during the sync wait for the next one; only one sync at a
+ * time folds a bitmap, the others just sync.  Returns -1 with errno set if
+ * either sync fails.
+ */
+int PageCompressSyncMap(const PageCompressMap* map, File file, uint32 wait_event_info)
+{
+    PageCompressHeader* header = map->header;
+    uint32 expected = 0;
+    bool fold = pg_atomic_compare_exchange_u32(&header->syncing, &expected, 1);
+    uint32 gen = fold ? pg_atomic_fetch_add_u32(&header->release_gen, 1) : 0;
+    int ret;
+
+    ret = FileSync(file, wait_event_info);
+    if (ret >= 0) {
+        ret = msync(header, map->size, MS_SYNC);
+    }
+
+    if (fold) {
+        if (ret >= 0) {
+            volatile uint64* released = GetPageCompressBitmap(header, PAGE_COMPRESS_RELEASE_BITMAP(gen));
+            volatile uint64* freemap = GetPageCompressBitmap(header, PAGE_COMPRESS_FREE_BITMAP);
+            Size nwords = PageCompressBitmapWords(header->chunk_size);
+
+            for (Size i = 0; i < nwords; i++) {
+                uint64 bits = (released[i] != 0) ? pg_atomic_exchange_u64(&released[i], 0) : 0;
+
+                if (bits != 0) {
+                    (void)pg_atomic_fetch_or_u64(&freemap[i], bits);
+                    (void)pg_atomic_fetch_add_u32(&header->free_chunks, (uint32)__builtin_popcountll(bits));
+                }
+            }
+        }
+        pg_atomic_write_u32(&header->syncing, 0);
+    }
+    return ret;
+}
+
+uint32 PageCompressGetOpt(const PageCompressMap* map)
+{
+    return PAGE_COMPRESS_OPT(map->header->algorithm, map->header->chunk_size);
+}
+
+BlockNumber PageCompressGetNBlocks(const PageCompressMap* map)
+{
+    return pg_atomic_read_u32(&map->header->nblocks);
+}
+
+/*
+ * Compress a page into dst, returning the compressed length or -1 if the
+ * codec could not make it smaller than dstlen.
+ */
+static int PageCompressCompress(uint16 algorithm, const char* src, char* dst, int dstlen)
+{
+    switch (algorithm) {
+        case PAGE_COMPRESS_PGLZ:
+            if (dstlen < (int)PGLZ_MAX_OUTPUT(BLCKSZ) ||
+                !pglz_compress(src, BLCKSZ, (PGLZ_Header*)dst, PGLZ_strategy_always)) {
+                return -1;
+            }
+            return (int)VARSIZE(dst);
+        case PAGE_COMPRESS_LZ4: {
+            int len = LZ4_compress_default(src, dst, BLCKSZ, dstlen);
+            return len > 0 ? len : -1;
+        }
+        default:
+            return -1;
+    }
+}
+
+static bool PageCompressDecompress(uint16 algorithm, const char* src, int srclen, char* dst)
+{
+    switch (algorithm) {
+        case PAGE_COMPRESS_PGLZ:
+            if (srclen < (int)sizeof(PGLZ_Header) || (int)VARSIZE(src) != srclen ||
+                PGLZ_RAW_SIZE((const PGLZ_Header*)src) != BLCKSZ) {
+                return false;
+            }
+            pglz_decompress((const PGLZ_Header*)src, dst);
+            return true;
+        case PAGE_COMPRESS_LZ4:
+            return LZ4_decompress_safe(src, dst, srclen, BLCKSZ) == BLCKSZ;
+        default:
+            return false;
+    }
+}
+
+/*
+ * An image that cannot be decoded is reported with *badBlock when the
+ * caller asked for that, and raises ERROR otherwise.
+ */
+static int PageCompressBadBlock(File file, BlockNumber blkno, char* buffer, bool* badBlock, const char* what)
+{
+    errno_t rc;
+
+    if (badBlock == NULL) {
+        ereport(ERROR,
+            (errcode(ERRCODE_DATA_CORRUPTED),
+                errmsg("could not %s block %u in file \"%s\"", what, blkno, FilePathName(file))));
+    }
+    *badBlock = true;
+    rc = memset_s(buffer, BLCKSZ, 0, BLCKSZ);
+    securec_check(rc, "", "");
+    return BLCKSZ;
+}
+
+/*
+ * PageCompressReadBlock
+ *		Read block blkno of a compressed segment into buffer.
+ *
+ * Returns BLCKSZ on success, or the result of the failing read so that the
+ * caller can report it like a short read of an ordinary segment; a block
+ * beyond the end of the segment reads as 0 bytes.  Blocks that were never
+ * written (holes left by extending discontiguously) read as zeroes.  With
+ * badBlock given, an image that does not decode sets it and reads as
+ * zeroes, as the double write recovery needs to repair a torn image.
+ */
+int PageCompressReadBlock(const PageCompressMap* map, File file, BlockNumber blkno, char* buffer, bool* badBlock)
+{
+    PageCompressHeader* header = map->header;
+    PageCompressAddr* addr = NULL;
+    int chunkSize = header->chunk_size;
+    int maxChunks = BLCKSZ / chunkSize;
+    uint32 maxChunkno = PageCompressMaxChunks(chunkSize);
+    char work[BLCKSZ];
+    char* dst = NULL;
+    uint32 compressedLen;
+    int nchunks;
+
+    Assert(blkno < RELSEG_SIZE);
+
+    if (badBlock != NULL) {
+        *badBlock = false;
+    }
+    if (blkno >= pg_atomic_read_u32(&header->nblocks)) {
+        return 0;
+    }
+
+    addr = GetPageCompressAddr(header, blkno);
+    nchunks = addr->nchunks;
+    if (nchunks == 0) {
+        errno_t rc = memset_s(buffer, BLCKSZ, 0, BLCKSZ);
+        securec_check(rc, "", "");
+        return BLCKSZ;
+    }
+    if (nchunks > maxChunks) {
+        return PageCompressBadBlock(file, blkno, buffer, badBlock, "find the chunks of");
+    }
+    for (int i = 0; i < nchunks; i++) {
+        if (addr->chunknos[i] == 0 || addr->chunknos[i] > maxChunkno) {
+            return PageCompressBadBlock(file, blkno, buffer, badBlock, "find the chunks of");
+        }
+    }
+
+    dst = (nchunks == maxChunks) ? buffer : work;
+
+    /* read runs of consecutive chunks with one call each */
+    for (int i = 0; i < nchunks;) {
+        int run = 1;
+        int nbytes;
+
+        while (i + run < nchunks && addr->chunknos[i + run] == addr->chunknos[i] + (uint32)run) {
+            run++;
+        }
+        nbytes = FilePRead(file,
+            dst + i * chunkSize,
+            run * chunkSize,
+            (off_t)(addr->chunknos[i] - 1) * chunkSize,
+            WAIT_EVENT_DATA_FILE_READ);
+        if (nbytes != run * chunkSize) {
+            return nbytes < 0 ? nbytes : i * chunkSize + nbytes;
+        }
+        i += run;
+    }
+
+    if (dst == buffer) {
+        return BLCKSZ;
+    }
+
+    compressedLen = *(uint32*)work;
+    if (compressedLen > (uint32)(nchunks * chunkSize - COMPRESSED_SIZE_LEN) ||
+        !PageCompressDecompress(header->algorithm, work + COMPRESSED_SIZE_LEN, (int)compressedLen, buffer)) {
+        return PageCompressBadBlock(file, blkno, buffer, badBlock, "decompress");
+    }
+    return BLCKSZ;
+}
+
+/*
+ * Take a free chunk for a new image, or failing that one from the end of
+ * the segment file.  Returns 0 if the segment has run out of chunks.
+ */
+static uint32 PageCompressAllocChunk(PageCompressHeader* header)
+{
+    volatile uint64* freemap = GetPageCompressBitmap(header, PAGE_COMPRESS_FREE_BITMAP);
+    Size nwords = PageCompressBitmapWords(header->chunk_size);
+    uint32 maxChunks = PageCompressMaxChunks(header->chunk_size);
+    uint32 chunkno;
+
+    if (pg_atomic_read_u32(&header->free_chunks) > 0) {
+        Size start = pg_atomic_read_u32(&header->free_hint) % nwords;
+
+        for (Size n = 0; n < nwords; n++) {
+            Size w = (start + n) % nwords;
+            uint64 bits = freemap[w];
+
+            while (bits != 0) {
+                uint64 bit = (uint64)1 << __builtin_ctzll(bits);
+
+                if (pg_atomic_fetch_and_u64(&freemap[w], ~bit) & bit) {
+                    (void)pg_atomic_fetch_sub_u32(&header->free_chunks, 1);
+                    pg_atomic_write_u32(&header->free_hint, (uint32)w);
+                    return (uint32)(w * 64 + __builtin_ctzll(bit) + 1);
+                }
+                bits = freemap[w];
+            }
+        }
+    }
+
+    chunkno = pg_atomic_add_fetch_u32(&header->allocated_chunks, 1);
+    if (chunkno > maxChunks) {
+        (void)pg_atomic_fetch_sub_u32(&header->allocated_chunks, 1);
+        return 0;
+    }
+    return chunkno;
+}
+
+/*
+ * Hand chunks that no entry points at any more to the next sync, which
+ * frees them once that is on disk.
+ */
+static void PageCompressReleaseChunks(PageCompressHeader* header, const uint32* chunknos, int nchunks)
+{
+    volatile uint64* released = NULL;
+    uint32 maxChunks = PageCompressMaxChunks(header->chunk_size);
+
+    if (nchunks == 0) {
+        return;
+    }
+    /* the entry must no longer point at them when the sync reads the generation */
+    pg_memory_barrier();
+    released = GetPageCompressBitmap(header, PAGE_COMPRESS_RELEASE_BITMAP(pg_atomic_read_u32(&header->release_gen)));
+    for (int i = 0; i < nchunks; i++) {
+        if (chunknos[i] >= 1 && chunknos[i] <= maxChunks) {
+            (void)pg_atomic_fetch_or_u64(&released[CHUNK_WORD(chunknos[i])], CHUNK_BIT(chunknos[i]));
+        }
+    }
+}
+
+/*
+ * PageCompressWriteBlock
+ *		Write buffer as block blkno of a compressed segment.
+ *
+ * The caller holds the buffer's I/O lock, so nobody else reads or writes
+ * this block meanwhile; other blocks of the segment may be written
+ * concurrently, which is why chunks are allocated with atomics.  The image
+ * goes to new chunks, and the entry is switched to them once they are
+ * written.  Should the segment run out of chunks because its blocks were
+ * rewritten many times since the last checkpoint, it is synced here to
+ * free the released ones.  Returns BLCKSZ on success or the result of the
+ * failing write.
+ */
+int PageCompressWriteBlock(
+    const PageCompressMap* map, File file, BlockNumber blkno, const char* buffer, uint32 wait_event_info)
+{
+    PageCompressHeader* header = map->header;
+    PageCompressAddr* addr = NULL;
+    int chunkSize = header->chunk_size;
+    int maxChunks = BLCKSZ / chunkSize;
+    char work[PGLZ_MAX_OUTPUT(BLCKSZ) + COMPRESSED_SIZE_LEN];
+    uint32 newChunks[PAGE_COMPRESS_MAX_CHUNKS];
+    uint32 oldChunks[PAGE_COMPRESS_MAX_CHUNKS];
+    const char* src = buffer;
+    int nchunks = maxChunks;
+    int oldNChunks;
+    int compressedLen;
+    bool synced = false;
+
+    Assert(blkno < RELSEG_SIZE);
+
+    compressedLen = PageCompressCompress(
+        header->algorithm, buffer, work + COMPRESSED_SIZE_LEN, (int)sizeof(work) - COMPRESSED_SIZE_LEN);
+    if (compressedLen > 0) {
+        int needed = (compressedLen + COMPRESSED_SIZE_LEN + chunkSize - 1) / chunkSize;
+
+        /* keep it only if it saves at least one chunk */
+        if (needed < maxChunks) {
+            int used = compressedLen + COMPRESSED_SIZE_LEN;
+            errno_t rc;
+
+            *(uint32*)work = (uint32)compressedLen;
+            rc = memset_s(work + used, sizeof(work) - used, 0, needed * chunkSize - used);
+            securec_check(rc, "", "");
+            src = work;
+            nchunks = needed;
+        }
+    }
+
+    for (int i = 0; i < nchunks; i++) {
+        newChunks[i] = PageCompressAllocChunk(header);
+        if (newChunks[i] == 0 && !synced) {
+            if (PageCompressSyncMap(map, file, WAIT_EVENT_DATA_FILE_SYNC) < 0) {
+                ereport(data_sync_elevel(ERROR),
+                    (errcode_for_file_access(), errmsg("could not fsync file \"%s\": %m", FilePathName(file))));
+            }
+            synced = true;
+            newChunks[i] = PageCompressAllocChunk(header);
+        }
+        if (newChunks[i] == 0) {
+            PageCompressReleaseChunks(header, newChunks, i);
+            ereport(ERROR,
+                (errcode(ERRCODE_DISK_FULL),
+                    errmsg("could not find a free chunk for block %u in file \"%s\"", blkno, FilePathName(file)),
+                    errhint("A checkpoint returns the chunks of rewritten blocks.")));
+        }
+    }
+
+    for (int i = 0; i < nchunks;) {
+        int run = 1;
+        int nbytes;
+
+        while (i + run < nchunks && newChunks[i + run] == newChunks[i] + (uint32)run) {
+            run++;
+        }
+        nbytes = FilePWrite(
+            file, src + i * chunkSize, run * chunkSize, (off_t)(newChunks[i] - 1) * chunkSize, wait_event_info);
+        if (nbytes != run * chunkSize) {
+            /* the entry still points at the old image, give the new chunks back */
+            PageCompressReleaseChunks(header, newChunks, nchunks);
+            return nbytes < 0 ? nbytes : i * chunkSize + nbytes;
+        }
+        i += run;
+    }
+
+    /* switch the entry to the new image only after its chunks are written */
+    addr = GetPageCompressAddr(header, blkno);
+    oldNChunks = (addr->nchunks <= maxChunks) ? addr->nchunks : 0;
+    for (int i = 0; i < oldNChunks; i++) {
+        oldChunks[i] = addr->chunknos[i];
+    }
+    pg_write_barrier();
+    for (int i = 0; i < nchunks; i++) {
+        addr->chunknos[i] = newChunks[i];
+    }
+    pg_write_barrier();
+    addr->nchunks = (uint8)nchunks;
+    PageCompressAtomicMax(&header->nblocks, blkno + 1);
+
+    PageCompressReleaseChunks(header, oldChunks, oldNChunks);
+
+    return BLCKSZ;
+}
+
+/*
+ * PageCompressTruncate
+ *		Cut a compressed segment down to nblocks blocks.
+ *
+ * The chunks of the blocks past the new end are released for reuse by the
+ * remaining blocks; only truncating to zero shrinks the segment file.
+ * Returns the result of FileTruncate, or 0.
+ */
+int PageCompressTruncate(const PageCompressMap* map, File file, BlockNumber nblocks)
+{
+    PageCompressHeader* header = map->header;
+    BlockNumber oldNBlocks = pg_atomic_read_u32(&header->nblocks);
+    int maxChunks = BLCKSZ / header->chunk_size;
+    Size entries = PageCompressAddrOffset(header->chunk_size, 0);
+
+    Assert(nblocks <= RELSEG_SIZE);
+
+    pg_atomic_write_u32(&header->nblocks, Min(nblocks, oldNBlocks));
+
+    if (nblocks > 0) {
+        for (BlockNumber blkno = nblocks; blkno < oldNBlocks; blkno++) {
+            PageCompressAddr* addr = GetPageCompressAddr(header, blkno);
+            int nchunks = addr->nchunks;
+
+            addr->nchunks = 0;
+            if (nchunks <= maxChunks) {
+                PageCompressReleaseChunks(header, addr->chunknos, nchunks);
+            }
+        }
+        return 0;
+    }
+
+    /* nothing is left to point at any chunk, so there is nothing to wait for */
+    errno_t rc = memset_s((char*)header + entries, map->size - entries, 0, map->size - entries);
+    securec_check(rc, "", "");
+    pg_atomic_write_u32(&header->free_chunks, 0);
+    pg_atomic_write_u32(&header->free_hint, 0);
+    pg_atomic_write_u32(&header->allocated_chunks, 0);
+
+    return FileTruncate(file, 0, WAIT_EVENT_DATA_FILE_TRUNCATE);
+}
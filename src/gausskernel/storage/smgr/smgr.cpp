@@ -18,12 +18,14 @@
  */
 #include "postgres.h"
 #include "knl/knl_variable.h"
+#include "access/tuptoaster.h"
 #include "catalog/storage.h"
 #include "commands/tablespace.h"
 #include "lib/ilist.h"
 #include "replication/dataqueue.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
+#include "storage/page_compression.h"
 #include "storage/smgr.h"
 #include "threadpool/threadpool.h"
 #include "utils/hsearch.h"
@@ -51,6 +53,7 @@ typedef struct f_smgr {
         SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
     void (*smgr_prefetch)(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
     void (*smgr_read)(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
+    bool (*smgr_try_read)(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
     void (*smgr_write)(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
     void (*smgr_writeback)(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, BlockNumber nblocks);
     BlockNumber (*smgr_nblocks)(SMgrRelation reln, ForkNumber forknum);
@@ -74,6 +77,7 @@ static const f_smgr g_smgrsw[] = {
         mdextend,
         mdprefetch,
         mdread,
+        mdtryread,
         mdwrite,
         mdwriteback,
         mdnblocks,
@@ -184,6 +188,7 @@ SMgrRelation smgropen(const RelFileNode& rnode, BackendId backend, int col)
             for (colnum = 0; colnum < reln->smgr_bcmarry_size; colnum++) {
                 reln->smgr_bcm_nblocks[colnum] = InvalidBlockNumber;
             }
+            reln->smgr_compress = 0;
             
             reln->smgr_which = 0; /* we only have md.c at present */
 
@@ -430,6 +435,9 @@ void smgrdounlink(SMgrRelation reln, bool isRedo)
      */
     DropRelFileNodeAllBuffers(rnode);
 
+    /* and of the detoasted values cached for it, if it is a toast relation */
+    ToastCacheForgetRelFileNode(&rnode.node);
+
     /*
      * It'd be nice to tell the stats collector to forget it immediately, too.
      * But we can't because we don't know the OID (and in cases involving
@@ -558,6 +566,19 @@ void smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char*
     (*(g_smgrsw[reln->smgr_which].smgr_read))(reln, forknum, blocknum, buffer);
 }
 
+/*
+ * smgrtryread() -- read a block that may be damaged.
+ *
+ * Like smgrread, but a block that cannot be read in full or decoded is
+ * reported by returning false, with zeroes in the buffer, instead of
+ * raising ERROR.  The double write recovery uses this to find the pages
+ * it has to restore.
+ */
+bool smgrtryread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer)
+{
+    return (*(g_smgrsw[reln->smgr_which].smgr_try_read))(reln, forknum, blocknum, buffer);
+}
+
 /*
  *  smgrwrite() -- Write the supplied buffer out.
  *
@@ -624,6 +645,10 @@ void smgrtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
     if (forknum == BCM_FORKNUM)
         BCMArrayDropAllBlocks(reln->smgr_rnode.node);
 
+    /* The values of a truncated toast relation are gone for good. */
+    if (forknum == MAIN_FORKNUM)
+        ToastCacheForgetRelFileNode(&reln->smgr_rnode.node);
+
     /*
      * Send a shared-inval message to force other backends to close any smgr
      * references they may have for this rel.  This is useful because they
@@ -709,7 +734,11 @@ void smgrpostckpt(void)
 
 void partition_create_new_storage(Relation rel, Partition part, const RelFileNodeBackend& filenode)
 {
-    RelationCreateStorage(filenode.node, rel->rd_rel->relpersistence, rel->rd_rel->relowner, rel->rd_bucketoid);
+    RelationCreateStorage(filenode.node,
+        rel->rd_rel->relpersistence,
+        rel->rd_rel->relowner,
+        rel->rd_bucketoid,
+        RelationGetPageCompressOpt(rel));
     smgrclosenode(filenode);
 
     /*
@@ -323,6 +323,14 @@ typedef struct ReaderState {
 
     /* special case for obs scan time */
     instr_time obsScanTime;
+
+    /*
+     * When it is larger than 1, the SMP workers share the files and this one
+     * reads the stripes (orc) or row groups (parquet) whose index modulo
+     * stripeDop is stripeSmpId.
+     */
+    uint32_t stripeDop;
+    uint32_t stripeSmpId;
 } ReaderState;
 
 /*
@@ -57,6 +57,16 @@ public:
      */
     virtual void read(void *buf, uint64_t length, uint64_t offset) = 0;
 
+    /*
+     * Get length bytes of the file starting at offset without copying them,
+     * the memory stays valid as long as the stream or one of its copies lives.
+     * @return NULL if the stream can not do it, the caller must use read().
+     */
+    virtual const void *getData(uint64_t length, uint64_t offset)
+    {
+        return NULL;
+    }
+
     /*
      * Get the name of the stream for error messages.
      */
@@ -43,6 +43,11 @@ typedef struct st_dw_batch_nohbkt {
     BufferTagNoHBkt buf_tag[0]; /* to locate the data pages in batch */
 } dw_batch_nohbkt_t;
 
+typedef struct st_dw_page_image {
+    BufferTag tag; /* page copied from the buffer */
+    uint32 gen;    /* image generation of the copy, 0 if none */
+} dw_page_image_t;
+
 /* Used by double_write to mark the buffers which are not flushed in the given buf_id array. */
 static const int DW_INVALID_BUFFER_ID = -1;
 /* steal high bit from pagenum as the flag of hashbucket */
@@ -221,6 +226,14 @@ inline bool dw_enabled()
         g_instance.attr.attr_storage.enableIncrementalCheckpoint && g_instance.attr.attr_storage.enable_double_write);
 }
 
+/**
+ * in page_image mode, only the first flush of a page in each image generation is copied to double write file
+ */
+inline bool dw_page_image_enabled()
+{
+    return (dw_enabled() && g_instance.dw_cxt.protection == TORN_PAGE_PAGE_IMAGE);
+}
+
 /**
  * flush the buffers identified by the buf_id in buf_id_arr to double write file
  * a token_id is returned, thus double write wish the caller to return it after the
@@ -230,6 +243,19 @@ inline bool dw_enabled()
  */
 void dw_perform(uint32 size);
 
+/**
+ * called by pagewriter after the pages of the batch given to dw_perform are written to data file
+ * and their fsync requests forwarded.
+ */
+void dw_perform_end();
+
+/**
+ * start a new image generation for checkpoint, before the data files are synced
+ * wait for the batch of the previous generation being flushed, if any, since the pages it does not
+ * copy rely on page images which will be truncated after the sync.
+ */
+void dw_switch_image_gen();
+
 /**
  * truncate the pages in double write file after ckpt or before exit
  * wait for tokens, thus all the relative data file flush and fsync request forwarded
@@ -92,7 +92,7 @@ const static uint64 DW_SLEEP_US = 1000L;
 
 const static uint16 DW_WRITE_STAT_LOWER_LIMIT = 16;
 
-const static int DW_VIEW_COL_NUM = 11;
+const static int DW_VIEW_COL_NUM = 12;
 
 const static uint32 DW_VIEW_COL_NAME_LEN = 32;
 
@@ -106,6 +106,12 @@ const static uint32 DW_VIEW_COL_NAME_LEN = 32;
 #define DW_LOG_LEVEL DEBUG1
 #endif
 
+/* Possible values of torn_page_protection */
+typedef enum TornPageProtection {
+    TORN_PAGE_DOUBLE_WRITE, /* copy every flushed page to the dw file */
+    TORN_PAGE_PAGE_IMAGE    /* copy a page at its first flush in each image generation */
+} TornPageProtection;
+
 typedef Datum (*dw_view_get_data_func)();
 
 typedef struct st_dw_view_col {
@@ -133,6 +139,7 @@ typedef struct st_dw_stat_info {
     volatile uint64 total_pages;           /* pages total */
     volatile uint64 low_threshold_pages;   /* less than 16 pages total */
     volatile uint64 high_threshold_pages;  /* more than one full batch (409 pages) total */
+    volatile uint64 skipped_pages;         /* not copied, the page image of this generation is in file */
 } dw_stat_info;
 
 typedef struct knl_g_dw_context {
@@ -156,6 +163,20 @@ typedef struct knl_g_dw_context {
     char* unaligned_buf;
     dw_stat_info stat_info;
     MemoryContext mem_ctx;
+
+    int protection; /* torn_page_protection in effect, fixed at startup */
+
+    /*
+     * For page_image only. A page copied in an image generation is not copied again in the
+     * same generation, checkpoints and file resets start a new one. image_switch_page is the
+     * number of flushed pages before the first batch of batch_gen, the older batches may be
+     * truncated once a checkpoint has synced the data files.
+     */
+    struct st_dw_page_image* page_images; /* last page copied from each buffer, NBuffers entries */
+    volatile uint32 image_gen;            /* current image generation, starts from 1 */
+    volatile uint32 inflight_gen;         /* image generation of the batch being flushed, 0 if none */
+    uint32 batch_gen;                     /* image generation of the last batch, under flush_lock */
+    uint16 image_switch_page;
 } dw_context_t;
 
 extern const dw_view_col_t g_dw_view_col_arr[DW_VIEW_COL_NUM];
@@ -21,6 +21,7 @@ extern DestReceiver* printtup_create_DR(CommandDest dest);
 extern DestReceiver* createStreamDestReceiver(CommandDest dest);
 extern void SetStreamReceiverParams(DestReceiver* self, StreamProducer* arg, Portal portal);
 extern void SetRemoteDestReceiverParams(DestReceiver* self, Portal portal);
+extern bool printtup_use_column_batch(DestReceiver* self, TupleDesc typeinfo);
 
 extern void SendRowDescriptionMessage(StringInfo buf, TupleDesc typeinfo, List* targetlist, int16* formats);
 
@@ -38,11 +39,24 @@ extern void printtupStream(TupleTableSlot* slot, DestReceiver* self);
 extern void assembleStreamMessage(TupleTableSlot* slot, DestReceiver* self, StringInfo buf);
 extern void assembleStreamBatchMessage(BatchCompressType ctype, VectorBatch* batch, StringInfo buf);
 
+/*
+ * Text output routines printtup() inlines instead of calling through fmgr,
+ * which saves the call and the palloc'd output string per attribute.
+ */
+typedef enum {
+    PRINTTUP_OUT_GENERIC = 0, /* call the type's output function */
+    PRINTTUP_OUT_INT2,
+    PRINTTUP_OUT_INT4,
+    PRINTTUP_OUT_INT8,
+    PRINTTUP_OUT_TEXT /* text, varchar and bpchar */
+} PrinttupOutKind;
+
 typedef struct {       /* Per-attribute information */
     Oid typoutput;     /* Oid for the type's text output fn */
     Oid typsend;       /* Oid for the type's binary output fn */
     bool typisvarlena; /* is it varlena (ie possibly toastable)? */
     int16 format;      /* format code for this column */
+    PrinttupOutKind outkind; /* inlined text output, if any */
     FmgrInfo finfo;    /* Precomputed call info for output fn */
 } PrinttupAttrInfo;
 
@@ -55,6 +69,7 @@ typedef struct {
     int nattrs;
     PrinttupAttrInfo* myinfo; /* Cached info about each attr */
     int16* formats;     /* format code for each column */
+    TupleDesc batchinfo; /* columns of the ColumnBatch messages we send */
 } DR_printtup;
 
 typedef struct {
@@ -14,6 +14,7 @@
 #define TUPTOASTER_H
 
 #include "access/htup.h"
+#include "storage/relfilenode.h"
 #include "utils/relcache.h"
 
 /*
@@ -92,6 +93,16 @@
 
 /* Size of an indirect datum that contains a standard TOAST pointer */
 #define INDIRECT_POINTER_SIZE (VARHDRSZ_EXTERNAL + sizeof(struct varatt_indirect))
+/*
+ * Compression methods of compressed datums, kept in the top bits of
+ * va_rawsize (see VARCOMPRESSMETHOD_4B_C).  The column option
+ * toast_compression and default_toast_compression choose among them.
+ */
+#define TOAST_PGLZ_COMPRESSION_ID 0
+#define TOAST_LZ4_COMPRESSION_ID 1
+
+#define TOAST_INVALID_COMPRESSION_ID (-1)
+
 /*
  * Testing whether an externally-stored value is compressed now requires
  * comparing extsize (the actual length of the external data) to rawsize
@@ -218,10 +229,22 @@ extern Datum toast_flatten_tuple_attribute(Datum value, Oid typeId, int32 typeMo
 /* ----------
  * toast_compress_datum -
  *
- *	Create a compressed version of a varlena datum, if possible
+ *	Create a compressed version of a varlena datum, if possible, with the
+ *	given TOAST_*_COMPRESSION_ID method
+ * ----------
+ */
+extern Datum toast_compress_datum(Datum value, int cmethod);
+
+/* ----------
+ * toast_get_compression_id -
+ *
+ *	Return the compression method of a varlena datum, or
+ *	TOAST_INVALID_COMPRESSION_ID if it is not compressed
  * ----------
  */
-extern Datum toast_compress_datum(Datum value);
+extern int toast_get_compression_id(struct varlena* attr);
+extern int toast_compression_name_to_id(const char* name);
+extern const char* toast_compression_id_to_name(int cmethod);
 
 /* ----------
  * toast_raw_datum_size -
@@ -241,5 +264,16 @@ extern Size toast_datum_size(Datum value);
 
 extern bool toastrel_valueid_exists(Relation toastrel, Oid valueid);
 
+/*
+ * Shared cache of detoasted values, in toastcache.cpp.  Entries are keyed by
+ * the relfilenode of the toast relation and the value OID.
+ */
+extern void ToastCacheInit(void);
+extern bool ToastCacheEnabled(int32 rawsize);
+extern struct varlena* ToastCacheLookup(const RelFileNode* rnode, Oid valueid, int32 rawsize);
+extern void ToastCacheInsert(const RelFileNode* rnode, Oid valueid, const struct varlena* value);
+extern void ToastCacheForget(const RelFileNode* rnode, Oid valueid);
+extern void ToastCacheForgetRelFileNode(const RelFileNode* rnode);
+
 #endif /* TUPTOASTER_H */
 
@@ -262,6 +262,11 @@ extern bool IsTransactionState(void);
 extern bool IsAbortedTransactionBlockState(void);
 extern void RemoveFromDnHashTable(void);
 extern bool WorkerThreadCanSeekAnotherMission(ThreadStayReason* reason);
+extern bool CommitAckConfirmed(knl_session_context* session, XLogRecPtr flushPtr);
+extern void WaitDeferredCommitAck(void);
+
+/* Is the reply to a commit being held back until the commit is durable? */
+#define CommitAckDeferred() (!XLogRecPtrIsInvalid(u_sess->xact_cxt.commitAckLsn))
 extern TransactionId GetTopTransactionId(void);
 extern TransactionId GetTopTransactionIdIfAny(void);
 extern TransactionId GetCurrentTransactionId(void);
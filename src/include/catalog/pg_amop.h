@@ -723,6 +723,14 @@ DATA(insert (	3655   3614 3615 1 s	3636 783 0 ));
 DATA(insert (	3659   3614 3615 1 s	3636 2742 0 ));
 DATA(insert (	3659   3614 3615 2 s	3660 2742 0 ));
 
+/*
+ * GIN jsonb_ops
+ */
+DATA(insert (	4776   4726 4726 7 s	4769 2742 0 ));
+DATA(insert (	4776   4726 25 9 s	4766 2742 0 ));
+DATA(insert (	4776   4726 1009 10 s	4767 2742 0 ));
+DATA(insert (	4776   4726 1009 11 s	4768 2742 0 ));
+
 /*
  * CGIN tsvector_ops
  */
@@ -384,6 +384,11 @@ DATA(insert (	3659   3614 3614 3 3657 ));
 DATA(insert (	3659   3614 3614 4 3658 ));
 DATA(insert (	3659   3614 3614 5 2700 ));
 DATA(insert (	3659   3614 3614 6 3921 ));
+DATA(insert (	4776   4726 4726 1 4743 ));
+DATA(insert (	4776   4726 4726 2 4744 ));
+DATA(insert (	4776   4726 4726 3 4745 ));
+DATA(insert (	4776   4726 4726 4 4746 ));
+DATA(insert (	4776   4726 4726 6 4747 ));
 DATA(insert (	3626   3614 3614 1 3622 ));
 DATA(insert (	3683   3615 3615 1 3668 ));
 DATA(insert (	3901   3831 3831 1 3870 ));
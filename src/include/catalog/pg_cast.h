@@ -483,4 +483,8 @@ DATA(insert (700 1042 4070 i f ));
 DATA(insert (701 1042 4071 i f ));
 DATA(insert (1700 1042 4072 i f ));
 
+/* json <-> jsonb, through the I/O functions */
+DATA(insert ( 114 4726 0 a i ));
+DATA(insert ( 4726 114 0 a i ));
+
 #endif   /* PG_CAST_H */
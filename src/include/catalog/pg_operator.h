@@ -225,11 +225,13 @@ DESCR("greater than or equal");
 #define INT84GEOID    430
 DATA(insert OID = 439 ("%"       PGNSP PGUID b f f    20    20    20     0     0 int8mod - -));
 DESCR("modulus");
+#define INT8MODOID 439
 DATA(insert OID = 473 ("@"       PGNSP PGUID l f f     0    20    20     0     0 int8abs - -));
 DESCR("absolute value");
 
 DATA(insert OID = 484 ("-"       PGNSP PGUID l f f     0    20    20     0     0 int8um - -));
 DESCR("negate");
+#define INT8UMOID 484
 DATA(insert OID = 485 ("<<"      PGNSP PGUID b f f 604 604    16     0     0 poly_left positionsel positionjoinsel));
 DESCR("is left of");
 DATA(insert OID = 486 ("&<"      PGNSP PGUID b f f 604 604    16     0     0 poly_overleft positionsel positionjoinsel));
@@ -332,6 +334,7 @@ DATA(insert OID = 529 ("%"       PGNSP PGUID b f f    21    21    21     0     0
 DESCR("modulus");
 DATA(insert OID = 530 ("%"       PGNSP PGUID b f f    23    23    23     0     0 int4mod - -));
 DESCR("modulus");
+#define INT4MODOID 530
 DATA(insert OID = 531 ("<>"      PGNSP PGUID b f f    25    25    16 531    98 textne neqsel neqjoinsel));
 DESCR("not equal");
 DATA(insert OID = 532 ("="       PGNSP PGUID b t t    21    23    16 533 538 int24eq eqsel eqjoinsel));
@@ -408,6 +411,7 @@ DESCR("subtract");
 #define INT42MIOID 557
 DATA(insert OID = 558 ("-"       PGNSP PGUID l f f     0    23    23     0     0 int4um - -));
 DESCR("negate");
+#define INT4UMOID 558
 DATA(insert OID = 559 ("-"       PGNSP PGUID l f f     0    21    21     0     0 int2um - -));
 DESCR("negate");
 DATA(insert OID = 560 ("="       PGNSP PGUID b t t 702 702    16 560 561 abstimeeq eqsel eqjoinsel));
@@ -462,6 +466,7 @@ DATA(insert OID = 584 ("-"       PGNSP PGUID l f f     0 700 700     0     0 flo
 DESCR("negate");
 DATA(insert OID = 585 ("-"       PGNSP PGUID l f f     0 701 701     0     0 float8um - -));
 DESCR("negate");
+#define FLOAT8UMOID 585
 DATA(insert OID = 586 ("+"       PGNSP PGUID b f f 700 700 700 586     0 float4pl - -));
 DESCR("add");
 DATA(insert OID = 587 ("-"       PGNSP PGUID b f f 700 700 700     0     0 float4mi - -));
@@ -474,12 +479,16 @@ DATA(insert OID = 590 ("@"       PGNSP PGUID l f f     0 700 700     0     0 flo
 DESCR("absolute value");
 DATA(insert OID = 591 ("+"       PGNSP PGUID b f f 701 701 701 591     0 float8pl - -));
 DESCR("add");
+#define FLOAT8PLOID 591
 DATA(insert OID = 592 ("-"       PGNSP PGUID b f f 701 701 701     0     0 float8mi - -));
 DESCR("subtract");
+#define FLOAT8MIOID 592
 DATA(insert OID = 593 ("/"       PGNSP PGUID b f f 701 701 701     0     0 float8div - -));
 DESCR("divide");
+#define FLOAT8DIVOID 593
 DATA(insert OID = 594 ("*"       PGNSP PGUID b f f 701 701 701 594     0 float8mul - -));
 DESCR("multiply");
+#define FLOAT8MULOID 594
 DATA(insert OID = 595 ("@"       PGNSP PGUID l f f     0 701 701     0     0 float8abs - -));
 DESCR("absolute value");
 DATA(insert OID = 596 ("|/"      PGNSP PGUID l f f     0 701 701     0     0 dsqrt - -));
@@ -1900,6 +1909,30 @@ DATA(insert OID = 3899 ("-"       PGNSP PGUID b f f 3831 3831 3831 0 0 range_min
 DESCR("range difference");
 DATA(insert OID = 3900 ("*"       PGNSP PGUID b f f 3831 3831 3831 3900 0 range_intersect - -));
 DESCR("range intersection");
+
+/* jsonb operators */
+DATA(insert OID = 4760 ("->"       PGNSP PGUID b f f 4726 25 4726 0 0 jsonb_object_field - -));
+DESCR("get jsonb object field");
+DATA(insert OID = 4761 ("->>"      PGNSP PGUID b f f 4726 25 25 0 0 jsonb_object_field_text - -));
+DESCR("get jsonb object field as text");
+DATA(insert OID = 4762 ("->"       PGNSP PGUID b f f 4726 23 4726 0 0 jsonb_array_element - -));
+DESCR("get jsonb array element");
+DATA(insert OID = 4763 ("->>"      PGNSP PGUID b f f 4726 23 25 0 0 jsonb_array_element_text - -));
+DESCR("get jsonb array element as text");
+DATA(insert OID = 4764 ("#>"       PGNSP PGUID b f f 4726 1009 4726 0 0 jsonb_extract_path - -));
+DESCR("get value from jsonb with path elements");
+DATA(insert OID = 4765 ("#>>"      PGNSP PGUID b f f 4726 1009 25 0 0 jsonb_extract_path_text - -));
+DESCR("get value from jsonb as text with path elements");
+DATA(insert OID = 4766 ("?"        PGNSP PGUID b f f 4726 25 16 0 0 jsonb_exists contsel contjoinsel));
+DESCR("key exists");
+DATA(insert OID = 4767 ("?|"       PGNSP PGUID b f f 4726 1009 16 0 0 jsonb_exists_any contsel contjoinsel));
+DESCR("any key exists");
+DATA(insert OID = 4768 ("?&"       PGNSP PGUID b f f 4726 1009 16 0 0 jsonb_exists_all contsel contjoinsel));
+DESCR("all keys exist");
+DATA(insert OID = 4769 ("@>"       PGNSP PGUID b f f 4726 4726 16 4770 0 jsonb_contains contsel contjoinsel));
+DESCR("contains");
+DATA(insert OID = 4770 ("<@"       PGNSP PGUID b f f 4726 4726 16 4769 0 jsonb_contained contsel contjoinsel));
+DESCR("is contained by");
 DATA(insert OID = 5550 ("="       PGNSP PGUID b t t 9003 9003     16 5550 5551 smalldatetime_eq eqsel eqjoinsel));
 DESCR("equal");
 DATA(insert OID = 5551 ("<>"       PGNSP PGUID b f f 9003 9003     16 5551 5550 smalldatetime_ne neqsel neqjoinsel));
@@ -138,6 +138,7 @@ DATA(insert OID = 3523 (405        enum_ops        PGNSP PGUID));
 DATA(insert OID = 3626 (403        tsvector_ops    PGNSP PGUID));
 DATA(insert OID = 3655 (783        tsvector_ops    PGNSP PGUID));
 DATA(insert OID = 3659 (2742    tsvector_ops    PGNSP PGUID));
+DATA(insert OID = 4776 (2742    jsonb_ops       PGNSP PGUID));
 DATA(insert OID = 4446 (4444    tsvector_ops    PGNSP PGUID));
 DATA(insert OID = 3683 (403        tsquery_ops        PGNSP PGUID));
 DATA(insert OID = 3702 (783        tsquery_ops        PGNSP PGUID));
@@ -170,6 +170,9 @@ typedef FormData_pg_proc *Form_pg_proc;
 #define BTINT4CMP_OID 351
 #define RTRIM1FUNCOID 401
 #define HASHINT4OID 450
+#define INT8TOINT4FUNCOID 480
+#define INT4TOINT8FUNCOID 481
+#define INT8TOFLOAT8FUNCOID 482
 #define HASHINT8OID 949
 #define HASHTEXTOID 400
 #define GETPGUSERNAMEFUNCOID 710
@@ -25,7 +25,8 @@
 
 #define DFS_STOR_FLAG  -1
 
-extern void RelationCreateStorage(RelFileNode rnode, char relpersistence, Oid ownerid, Oid bucketOid = InvalidOid);
+extern void RelationCreateStorage(
+    RelFileNode rnode, char relpersistence, Oid ownerid, Oid bucketOid = InvalidOid, uint32 compressOpt = 0);
 extern void RelationDropStorage(Relation rel, bool isDfsTruncate = false);
 extern void RelationPreserveStorage(RelFileNode rnode, bool atCommit);
 extern void RelationTruncate(Relation rel, BlockNumber nblocks);
@@ -40,11 +40,11 @@ typedef struct xl_smgr_truncate {
 	RelFileNodeOld rnode;
 } xl_smgr_truncate;
 
-extern void log_smgrcreate(RelFileNode *rnode, ForkNumber forkNum);
+extern void log_smgrcreate(RelFileNode *rnode, ForkNumber forkNum, uint32 compressOpt = 0);
 
 extern void smgr_redo(XLogReaderState *record);
 extern void smgr_desc(StringInfo buf, XLogReaderState *record);
-extern void smgr_redo_create(RelFileNode rnode, ForkNumber forkNum);
+extern void smgr_redo_create(RelFileNode rnode, ForkNumber forkNum, uint32 compressOpt = 0);
 extern void XLogBlockSmgrRedoTruncate(RelFileNode rnode, BlockNumber blkno, XLogRecPtr lsn);
 
 #endif   /* STORAGE_XLOG_H */
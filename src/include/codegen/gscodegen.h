@@ -510,6 +510,14 @@ public:
      */
     void releaseResource();
 
+    /*
+     * @Description : Release the execution engine and the module only.
+     *                Used by the objects that never load the IR file and
+     *                live longer than a query, like the compiled PL/pgSQL
+     *                functions.
+     */
+    void releaseEngine();
+
     /*
      * @Description	: Get the pointer to the current module.
      * @return		: Current module in use.
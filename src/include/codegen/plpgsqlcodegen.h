@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * plpgsqlcodegen.h
+ *        Native compilation of PL/pgSQL functions.
+ *
+ * IDENTIFICATION
+ *        src/include/codegen/plpgsqlcodegen.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#ifndef LLVM_PLPGSQL_H
+#define LLVM_PLPGSQL_H
+
+#include "codegen/gscodegen.h"
+#include "utils/plpgsql.h"
+
+namespace dorado {
+
+/*
+ * PLpgSQLCodeGen compiles a whole PL/pgSQL function into one native function
+ * of type PLpgSQL_native_fn.  Only a scalar subset of the language is
+ * handled: variables of type int4, int8, float8 and bool, simple expressions
+ * made of constants, variables, the arithmetic and comparison operators of
+ * these types, the casts between them and AND/OR/NOT, and the statement
+ * blocks without EXCEPTION, assignments, IF, LOOP, WHILE, FOR over integers,
+ * EXIT, CONTINUE, RETURN and NULL.
+ */
+class PLpgSQLCodeGen : public BaseObject {
+public:
+    /*
+     * Brief        : Check whether the function can be compiled.
+     * Input        : func, the function, already run by the interpreter.
+     * Output       : retry, set when the function may become compilable,
+     *                because some expressions have not been planned yet.
+     * Return Value : NULL if the function can be compiled, else the reason
+     *                why not, allocated in the context of the function.
+     */
+    static const char* CheckFunction(PLpgSQL_function* func, bool* retry);
+
+    /*
+     * Brief        : Generate the IR of a function accepted by CheckFunction
+     *                and compile it.
+     * Input        : func, the function.
+     *                llvmCodeGen, a GsCodeGen object used for this function
+     *                only, it owns the native code.
+     * Return Value : The native function.
+     * Notes        : Raises an ERROR when LLVM fails.
+     */
+    static PLpgSQL_native_fn CompileFunction(PLpgSQL_function* func, GsCodeGen* llvmCodeGen);
+};
+}  // namespace dorado
+#endif
@@ -316,6 +316,10 @@ typedef struct CopyStateData {
 
     /* adaptive memory assigned for the stmt */
     AdaptMem memUsage;
+
+    /* parallel parsing of COPY FROM file, see copy_parallel.cpp */
+    int parallel_workers;               /* PARALLEL option, 0 means serial */
+    struct CopyParallelState* parallel; /* running pipeline, or NULL */
 } CopyStateData;
 
 #define IS_CSV(cstate) ((cstate)->fileformat == FORMAT_CSV)
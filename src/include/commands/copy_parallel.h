@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * copy_parallel.h
+ *        Multi-threaded line splitting and field parsing for COPY FROM file.
+ *
+ *
+ * IDENTIFICATION
+ *        src/include/commands/copy_parallel.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#ifndef COPY_PARALLEL_H
+#define COPY_PARALLEL_H
+
+#include "commands/copy.h"
+
+/* upper bound of the PARALLEL option of COPY FROM */
+#define COPY_PARALLEL_MAX_WORKERS 32
+
+struct CopyParallelState;
+
+extern bool CopyParallelIsSupported(CopyState cstate);
+extern void CopyParallelBegin(CopyState cstate);
+extern void CopyParallelEnd(CopyState cstate);
+extern bool CopyParallelNextRawFields(CopyState cstate, char*** fields, int* nfields);
+
+extern void AtEOXact_CopyParallel(bool isCommit);
+extern void AtEOSubXact_CopyParallel(bool isCommit, SubTransactionId mySubid, SubTransactionId parentSubid);
+
+#endif /* COPY_PARALLEL_H */
@@ -117,6 +117,8 @@ typedef struct HashMemoryChunkData* HashMemoryChunk;
 
 #define HASH_CHUNK_SIZE (32 * 1024L)
 #define HASH_CHUNK_THRESHOLD (HASH_CHUNK_SIZE / 4)
+/* slab block holding eight standard chunks, see chunkCxt */
+#define HASH_CHUNK_SLAB_BLOCK_SIZE (8 * (HASH_CHUNK_SIZE + 1024L))
 
 typedef struct HashJoinTableData {
     int nbuckets;      /* # buckets in the in-memory hash table */
@@ -171,6 +173,7 @@ typedef struct HashJoinTableData {
 
     MemoryContext hashCxt;  /* context for whole-hash-join storage */
     MemoryContext batchCxt; /* context for this-batch-only storage */
+    MemoryContext chunkCxt; /* slab of standard-size chunks, child of batchCxt */
 
     /* used for dense allocation of tuples (into linked chunks) */
     HashMemoryChunk chunks; /*  one list for the whole batch */
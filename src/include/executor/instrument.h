@@ -87,6 +87,7 @@ enum sortMethodId {
     /* sort Method */
     HEAPSORT,
     QUICKSORT,
+    PARALLELQUICKSORT,
     EXTERNALSORT,
     EXTERNALMERGE,
     STILLINPROGRESS
@@ -320,6 +321,22 @@ typedef struct Instrumentation {
     RecursiveInfo recursiveInfo;
 } Instrumentation;
 
+/*
+ * Row counter feeding the planner's cardinality feedback.  Unlike
+ * Instrumentation it only counts tuples and loops, so it is cheap enough to
+ * stay enabled outside EXPLAIN ANALYZE.
+ */
+typedef struct CardCounter {
+    /* Info about current plan cycle: */
+    bool running;      /* TRUE if this cycle has been entered */
+    bool finished;     /* TRUE if this cycle reached the end of its input */
+    double tuplecount; /* Tuples emitted so far this cycle */
+    /* Accumulated statistics across all completed cycles: */
+    double ntuples;    /* Total tuples produced by finished cycles */
+    double nloops;     /* # of cycles run to the end */
+    double nabandoned; /* # of cycles stopped early, e.g. under a LIMIT */
+} CardCounter;
+
 /* instrumentation data */
 typedef struct InstrStreamPlanData {
     /* whether the plannode is valid */
@@ -1003,6 +1020,9 @@ extern Instrumentation* InstrAlloc(int n, int instrument_options);
 extern void InstrStartNode(Instrumentation* instr);
 extern void InstrStopNode(Instrumentation* instr, double nTuples);
 extern void InstrEndLoop(Instrumentation* instr);
+extern CardCounter* CardCounterAlloc(void);
+extern void CardCounterCount(CardCounter* counter, bool done);
+extern void CardCounterEndLoop(CardCounter* counter);
 extern void StreamEndLoop(StreamTime* instr);
 extern void AddControlMemoryContext(Instrumentation* instr, MemoryContext context);
 extern void CalculateContextSize(MemoryContext ctx, int64* memorySize);
@@ -45,6 +45,14 @@
 #define HASH_MIN_FILENUMBER 48
 #define HASH_MAX_FILENUMBER 512
 
+/*
+ * When at least this fraction of the rows seen before the hash table filled
+ * up started a new group, the input is taken to be nearly unique and the
+ * spill fan-out is sized from the input rows rather than the planner's
+ * group estimate.
+ */
+#define HASHAGG_HIGH_CARDINALITY_RATIO 0.9
+
 typedef struct AggWriteFileControl {
     bool spillToDisk; /*whether data write to temp file*/
     bool finishwrite;
@@ -59,6 +67,11 @@ typedef struct AggWriteFileControl {
     int curfile;
     int64 maxMem;  /* mem spread memory, in bytes */
     int spreadNum; /* dynamic spread time */
+    int64 inputRownum;              /* rows looked up in the hash table in this pass */
+    bool respill;                   /* hash table of the spilled file being read is full */
+    int spillLevel;                 /* times spilled rows have been partitioned again */
+    hashFileSource* overflowsource; /* temp files receiving the respilled rows */
+    int overflowFileNum;
 } AggWriteFileControl;
 
 /*
@@ -265,6 +278,21 @@ typedef struct AggHashEntryData {
     AggStatePerGroupData pergroup[FLEXIBLE_ARRAY_MEMBER]; /* VARIABLE LENGTH ARRAY */
 } AggHashEntryData;                                       /* VARIABLE LENGTH STRUCT */
 
+/*
+ * The entries are found through an open-addressing array of slots probed
+ * linearly.  Each slot keeps the hash value of its group, so a probe only
+ * compares tuples on a hash match and growing the array rehashes no tuple.
+ */
+typedef struct AggHashSlotData {
+    uint32 hash;        /* hash value of the group */
+    AggHashEntry entry; /* the group, or NULL if the slot is free */
+} AggHashSlotData;
+
+/* the slot array starts between these sizes and doubles when 3/4 full */
+#define AGG_HASH_MIN_SLOTS 256
+#define AGG_HASH_MAX_INIT_SLOTS (1 << 16)
+#define AGG_HASH_FULL(nused, nslots) ((uint64)(nused)*4 >= (uint64)(nslots)*3)
+
 extern AggState* ExecInitAgg(Agg* node, EState* estate, int eflags);
 extern TupleTableSlot* ExecAgg(AggState* node);
 extern void ExecEndAgg(AggState* node);
@@ -23,6 +23,9 @@
 #ifndef HDFS_SERVER
 #define HDFS_SERVER "hdfs"
 #endif
+#ifndef LOCAL_SERVER
+#define LOCAL_SERVER "local"
+#endif
 
 #define OBS_BUCKET_URL_FORMAT_FLAG ".obs."
 #define OBS_PREFIX "obs://"
@@ -137,7 +140,8 @@ typedef enum ServerTypeOption {
     T_MOT_SERVER,
     T_DUMMY_SERVER,
     T_TXT_CSV_OBS_SERVER, /* mark the txt/csv foramt OBS foreign server. the fdw is dist_fdw. */
-    T_PGFDW_SERVER
+    T_PGFDW_SERVER,
+    T_LOCAL_SERVER /* ORC/Parquet/text/csv files on the local file system, read by hdfs_fdw. */
 } ServerTypeOption;
 
 /*
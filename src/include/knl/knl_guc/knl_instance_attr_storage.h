@@ -57,6 +57,9 @@ typedef struct knl_instance_attr_storage {
     int WalReceiverBufSize;
     int DataQueueBufSize;
     int NBuffers;
+    int shared_buffers_huge_pages;
+    int shared_buffers_huge_page_size;
+    int buffer_replacement_policy;
     int cstore_buffers;
     int MaxSendSize;
     int max_prepared_xacts;
@@ -75,6 +78,7 @@ typedef struct knl_instance_attr_storage {
     int recovery_parse_workers;
     int recovery_redo_workers_per_paser_worker;
     int pagewriter_thread_num;
+    int torn_page_protection;
     int real_recovery_parallelism;
 	int batch_redo_num;
     int remote_read_mode;
@@ -55,6 +55,7 @@ typedef struct knl_session_attr_resource {
     bool enable_user_metric_persistent;
     bool enable_instance_metric_persistent;
     bool enable_logical_io_statistics;
+    bool enable_io_token_bucket;
     bool enable_reaper_backend;
     bool enable_transaction_parctl;
     int max_active_statements;
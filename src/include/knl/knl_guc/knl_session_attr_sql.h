@@ -63,6 +63,8 @@ typedef struct knl_session_attr_sql {
     bool enable_parallel_ddl;
     bool enable_tidscan;
     bool enable_sort;
+    bool enable_radix_sort;
+    bool enable_cardinality_feedback;
     bool enable_compress_spill;
     bool enable_hashagg;
     bool enable_material;
@@ -99,6 +101,7 @@ typedef struct knl_session_attr_sql {
     bool SQL_inheritance;
     bool Transform_null_equals;
     bool check_function_bodies;
+    bool columnar_result_transfer;
     bool Array_nulls;
     bool default_with_oids;
 #ifdef DEBUG_BOUNDED_SORT
@@ -150,7 +153,9 @@ typedef struct knl_session_attr_sql {
     int query_dop_tmp;
     int plan_mode_seed;
     int codegen_cost_threshold;
+    int plpgsql_codegen_threshold;
     int acce_min_datasize_per_thread;
+    int sort_parallel_workers;
     int max_cn_temp_file_size;
     int default_statistics_target;
     /* Memory Limit user could set in session */
@@ -73,6 +73,7 @@ typedef struct knl_session_attr_storage {
     bool gds_debug_mod;
     bool log_pagewriter;
     bool enable_incremental_catchup;
+    bool thread_pool_defer_commit_ack;
     int wait_dummy_time;
     int DeadlockTimeout;
     int LockWaitTimeout;
@@ -90,11 +91,14 @@ typedef struct knl_session_attr_storage {
     int bulk_read_ring_size;
     int partition_mem_batch;
     int partition_max_cache_size;
+    int toast_cache_size;
+    int default_toast_compression;
     int VacuumCostPageHit;
     int VacuumCostPageMiss;
     int VacuumCostPageDirty;
     int VacuumCostLimit;
     int VacuumCostDelay;
+    int vacuum_index_parallel_workers;
     int autovacuum_vac_cost_delay;
     int autovacuum_vac_cost_limit;
     int gs_clean_timeout;
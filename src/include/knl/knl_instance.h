@@ -92,6 +92,7 @@ typedef struct knl_instance_attr {
 
 typedef struct knl_g_cache_context{
     MemoryContext global_cache_mem;
+    struct ToastCacheShared* toast_cache; /* shared cache of detoasted values */
 } knl_g_cache_context;
 
 typedef struct knl_g_cost_context {
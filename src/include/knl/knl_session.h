@@ -562,6 +562,8 @@ typedef struct knl_u_commands_context {
      * our modification to PGXC copy procejure.
      */
     struct CopyStateData* bulkload_copy_state;
+    /* running parallel COPY FROM pipelines, stopped at transaction abort */
+    struct CopyParallelState* copy_parallel_states;
     int dest_encoding_for_copytofile;
     bool need_transcoding_for_copytofile;
     MemoryContext OBSParserContext;
@@ -1108,6 +1110,15 @@ typedef struct knl_u_xact_context {
     char* savePrepareGID;
 
     bool pbe_execute_complete;
+
+    /*
+     * Commit acknowledgement deferred to the thread pool listener: the commit
+     * record end (an XLogRecPtr), the sync rep wait mode it still needs, and
+     * the client output held back until it is durable.
+     */
+    uint64 commitAckLsn;
+    int commitAckSyncRepMode;
+    StringInfo commitAckOutput;
 } knl_u_xact_context;
 
 typedef struct knl_u_plpgsql_context {
@@ -1387,6 +1398,13 @@ typedef struct knl_u_storage_context {
     bool twoPhaseCommitInProgress;
     int32 dumpHashbucketIdNum;
     int2 *dumpHashbucketIds;
+
+    /* buffer access trace started by pg_buffer_trace_start(), see buf_trace.cpp */
+    int bufferTraceFile;
+    off_t bufferTraceOffset;
+    char* bufferTraceBuf;
+    int bufferTraceLen;
+    int64 bufferTraceAccesses;
 } knl_u_storage_context;
 
 
@@ -1418,6 +1436,9 @@ typedef struct knl_u_libpq_context {
     List* ident_line_nums;
     MemoryContext ident_context;
     bool IsConnFromCmAgent;
+
+    /* number of ColumnBatch messages sent to the client */
+    int64 column_batches_sent;
 #ifdef USE_SSL
     bool ssl_loaded_verify_locations;
     SSL_CTX* SSL_server_context;
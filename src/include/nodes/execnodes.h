@@ -1179,6 +1179,7 @@ typedef struct PlanState {
                     * top-level plan */
 
     Instrumentation* instrument; /* Optional runtime stats for this node */
+    CardCounter* cardcounter;    /* Optional row counter for cardinality feedback */
 
     /*
      * Common structural data for all Plan types.  These links to subsidiary
@@ -2124,6 +2125,7 @@ typedef struct GroupState {
 typedef struct AggStatePerAggData* AggStatePerAgg;
 typedef struct AggStatePerGroupData* AggStatePerGroup;
 typedef struct AggStatePerPhaseData* AggStatePerPhase;
+typedef struct AggHashSlotData* AggHashSlot;
 
 typedef struct AggState {
     ScanState ss;               /* its first field is NodeTag */
@@ -2157,7 +2159,10 @@ typedef struct AggState {
     TupleTableSlot* hashslot;   /* slot for loading hash table */
     List* hash_needed;          /* list of columns needed in hash table */
     bool table_filled;          /* hash table filled yet? */
-    TupleHashIterator hashiter; /* for iterating through hash table */
+    AggHashSlot hash_slots;     /* open-addressing array of the groups */
+    uint32 hash_nslots;         /* size of hash_slots, a power of 2 */
+    uint32 hash_nused;          /* number of groups in hash_slots */
+    uint32 hash_scanpos;        /* next slot to return a group from */
 #ifdef PGXC
     bool is_final; /* apply the final step for aggregates */
 #endif             /* PGXC */
@@ -2353,8 +2358,13 @@ typedef struct LimitState {
  * Brief	: structure definition about partition iteration
  */
 typedef struct PartIteratorState {
-    PlanState ps;   /* its first field is NodeTag */
-    int currentItr; /* the sequence number for processing partition */
+    PlanState ps;          /* its first field is NodeTag */
+    int currentItr;        /* the sequence number for processing partition */
+    int activeItrs;        /* number of partitions left to scan by runtime pruning */
+    int* activeItrIndexes; /* their iteration numbers, NULL if no runtime pruning */
+    bool pruneOnScan;      /* prune before each scan, as quals depend on exec params */
+    bool needPrune;        /* pruning of this scan is still to do */
+    double nprunedItrs;    /* partitions pruned at runtime, summed over scans */
 } PartIteratorState;
 
 struct VecLimitState : public LimitState {
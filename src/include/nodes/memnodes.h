@@ -233,6 +233,38 @@ typedef struct StackSetContext {
     MemoryTrack track; /* used to track the memory allocation information */
 } StackSetContext;
 
+typedef struct SlabBlockData* SlabBlock;
+
+/*
+ * SlabSetContext is the memory context for objects of a single fixed size.
+ *
+ * Its leading fields must be consistent with AllocSetContext, because the
+ * memory accounting code reads totalSpace, freeSpace, maxSpaceSize and track
+ * through an AllocSet pointer.  initBlockSize and maxBlockSize both hold the
+ * slab block size and allocChunkLimit holds the chunk size.
+ */
+typedef struct SlabSetContext {
+    MemoryContextData header;              /* Standard memory-context fields */
+    SlabBlock blocks;                      /* head of list of all blocks */
+    char* reserve[ALLOCSET_NUM_FREELISTS]; /* unused, keeps the AllocSetContext layout */
+    Size initBlockSize;                    /* slab block size */
+    Size maxBlockSize;                     /* slab block size */
+    Size nextBlockSize;                    /* slab block size */
+    Size allocChunkLimit;                  /* requested chunk size */
+    SlabBlock keeper;                      /* always NULL, slab blocks are never kept */
+    Size totalSpace;                       /* all bytes allocated by this context */
+    Size freeSpace;                        /* all bytes freed by this context */
+    Size maxSpaceSize;                     /* see @StackSetContext */
+    MemoryTrack track;                     /* used to track the memory allocation information */
+
+    /* slab-specific fields */
+    Size fullChunkSize;   /* chunk size including the chunk header */
+    Size blockHeaderSize; /* block header size including the free bitmap */
+    int chunksPerBlock;   /* number of chunks carved out of one block */
+    int nblocks;          /* number of blocks currently allocated */
+    SlabBlock freeBlocks; /* head of list of blocks having free chunks */
+} SlabSetContext;
+
 typedef struct MemoryProtectFuncDef {
     void* (*malloc)(Size sz);
     void (*free)(void* ptr, Size sz);
@@ -254,7 +286,7 @@ extern MemoryProtectFuncDef SharedFunctions;
     ((context) != NULL &&                                                                                             \
         (IsA((context), AllocSetContext) || IsA((context), AsanSetContext) || IsA((context), StackAllocSetContext) || \
             IsA((context), SharedAllocSetContext) || IsA((context), MemalignAllocSetContext) ||                       \
-            IsA((context), MemalignSharedAllocSetContext)))
+            IsA((context), MemalignSharedAllocSetContext) || IsA((context), SlabAllocSetContext)))
 
 #define AllocSetContextUsedSpace(aset) ((aset)->totalSpace - (aset)->freeSpace)
 
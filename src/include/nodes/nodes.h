@@ -313,6 +313,7 @@ typedef enum NodeTag {
     T_SharedAllocSetContext,
     T_MemalignAllocSetContext,
     T_MemalignSharedAllocSetContext,
+    T_SlabAllocSetContext,
 
     T_MemoryTracking,
 
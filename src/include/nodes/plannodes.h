@@ -523,6 +523,10 @@ typedef struct Scan {
 
     /*  Memory info for scan node, now it just used on indexscan, indexonlyscan, bitmapscan, dfsindexscan */
     OpMemInfo mem_info;
+
+    /* cardinality feedback: signature of the scan's restrictions (0 if untracked) and uncorrected rows */
+    uint32 feedbackSignature;
+    double feedbackRows;
 } Scan;
 
 /* ----------------
@@ -1310,6 +1314,7 @@ typedef struct PartIterator {
     int itrs;               /* the number of the partitions */
     ScanDirection direction;
     PartIteratorParam* param;
+    List* pruningQuals;     /* partition key quals with params, to prune again at execution */
     /*
      * Below three variables are used to record starting partition id, ending partition id and number of
      * partitions.
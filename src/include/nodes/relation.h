@@ -546,6 +546,10 @@ typedef struct RelOptInfo {
     int encodedwidth;      /* estimated avg width of encoded columns in result tuples */
     AttrNumber encodednum; /* number of encoded column */
 
+    /* cardinality feedback: signature of baserestrictinfo (0 if untracked) and uncorrected rows */
+    uint32 feedbackSignature;
+    double feedbackRows;
+
     /* materialization information */
     List* reltargetlist;   /* Vars to be output by scan of relation */
     List* distribute_keys; /* distribute key */
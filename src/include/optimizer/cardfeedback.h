@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * cardfeedback.h
+ *        Cardinality feedback between the executor and the planner.
+ *
+ *
+ * IDENTIFICATION
+ *        src/include/optimizer/cardfeedback.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef CARDFEEDBACK_H
+#define CARDFEEDBACK_H
+
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "nodes/relation.h"
+
+/* Largest number of corrections kept in shared memory */
+#define CARD_FEEDBACK_MAX_ENTRIES 4096
+
+extern Selectivity cardinality_feedback_adjust(PlannerInfo* root, RelOptInfo* rel, Selectivity selec);
+extern void cardinality_feedback_mark_scan(RelOptInfo* rel, Plan* plan);
+extern bool cardinality_feedback_tracked(Plan* plan, EState* estate);
+extern void cardinality_feedback_record(PlanState* planstate);
+extern void cardinality_feedback_expire(Oid relid);
+
+extern Datum pg_cardinality_feedback(PG_FUNCTION_ARGS);
+extern Datum pg_cardinality_feedback_reset(PG_FUNCTION_ARGS);
+
+#endif /* CARDFEEDBACK_H */
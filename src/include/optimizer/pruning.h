@@ -68,6 +68,7 @@ PruningResult* partitionPruningForExpr(PlannerInfo* root, RangeTblEntry* rte, Re
 PruningResult* partitionPruningForRestrictInfo(
     PlannerInfo* root, RangeTblEntry* rte, Relation rel, List* restrictInfoList);
 PruningResult* singlePartitionPruningForRestrictInfo(Oid partitionOid, Relation rel);
+extern List* getPartitionPruningParamQuals(PlannerInfo* root, Index relid, List* clauses);
 extern PruningResult* copyPruningResult(PruningResult* srcPruningResult);
 extern Oid getPartitionOidFromSequence(Relation relation, int partSeq);
 extern int varIsInPartitionKey(int attrNo, int2vector* partKeyAttrs, int partKeyNum);
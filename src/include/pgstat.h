@@ -1158,6 +1158,10 @@ typedef struct PgBackendStatus {
     WorkloadManagerStmtTag st_stmttag;  /* 0: none 1: read: 2: write */
 
     uint64 st_queryid;                  /* debug query id of current query */
+    int64 st_io_throttle_count;         /* times the current query waited for IO tokens */
+    int64 st_io_throttle_time;          /* microseconds the current query waited for IO tokens */
+    int64 st_last_io_throttle_count;    /* st_io_throttle_count of the previous query */
+    int64 st_last_io_throttle_time;     /* st_io_throttle_time of the previous query */
     pid_t st_tid;                       /* thread ID */
     uint64 st_parent_sessionid;         /* parent session ID, equals parent pid under non thread pool mode */
     int st_thread_level;                /* thread level, mark with plan node id of Stream node */
@@ -1336,6 +1340,7 @@ extern void pgstat_report_conninfo(const char* conninfo);
 extern void pgstat_report_xact_timestamp(TimestampTz tstamp);
 extern void pgstat_report_waiting_on_resource(WorkloadManagerEnqueueState waiting);
 extern void pgstat_report_queryid(uint64 queryid);
+extern void pgstat_report_io_throttle(int64 usecs);
 extern void pgstat_report_jobid(uint64 jobid);
 extern void pgstat_report_parent_sessionid(uint64 sessionid, uint32 level = 0);
 extern void pgstat_report_smpid(uint32 smpid);
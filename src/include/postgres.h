@@ -318,7 +318,17 @@ typedef enum {
 #define VARDATA_1B(PTR) (((varattrib_1b*)(PTR))->va_data)
 #define VARDATA_1B_E(PTR) (((varattrib_1b_e*)(PTR))->va_data)
 
-#define VARRAWSIZE_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize)
+/*
+ * The raw size of a compressed datum fits in 30 bits, the top two bits of
+ * va_rawsize hold the compression method, see TOAST_*_COMPRESSION_ID.
+ * Values compressed before there was a choice of method carry zero there,
+ * which is pglz.
+ */
+#define VARLENA_RAWSIZE_BITS 30
+#define VARLENA_RAWSIZE_MASK ((1U << VARLENA_RAWSIZE_BITS) - 1)
+
+#define VARRAWSIZE_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize & VARLENA_RAWSIZE_MASK)
+#define VARCOMPRESSMETHOD_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize >> VARLENA_RAWSIZE_BITS)
 
 /* Externally visible macros */
 
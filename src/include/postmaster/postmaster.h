@@ -235,6 +235,7 @@ extern bool IsHASocketAddr(struct sockaddr* sock_addr);
 extern bool IsHAPort(Port* port);
 extern const char* get_explicit_host_addr(void);
 extern ThreadId initialize_util_thread(knl_thread_role role, void* payload = NULL);
+extern void InitProcessAndShareMemory();
 extern ThreadId initialize_worker_thread(knl_thread_role role, Port* port, void* payload = NULL);
 extern void startup_die(SIGNAL_ARGS);
 extern void PortInitialize(Port* port, knl_thread_arg* arg);
@@ -43,6 +43,13 @@ typedef struct LogicalDecodingContext {
      */
     bool fast_forward;
 
+    /*
+     * Stream large in-progress transactions to the output plugin instead of
+     * spilling them to disk until commit. Set if the plugin registers the
+     * stream callbacks; the plugin may clear it in its startup callback.
+     */
+    bool streaming;
+
     OutputPluginCallbacks callbacks;
     OutputPluginOptions options;
 
@@ -73,6 +73,40 @@ typedef void (*LogicalDecodeShutdownCB)(struct LogicalDecodingContext* ctx);
  */
 typedef bool (*LogicalDecodeFilterByOriginCB)(struct LogicalDecodingContext* ctx, RepOriginId origin_id);
 
+/*
+ * Called before a block of changes of a large, still running transaction is
+ * streamed. A transaction may be streamed in any number of blocks before its
+ * commit or abort is seen.
+ */
+typedef void (*LogicalDecodeStreamStartCB)(struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+
+/*
+ * Called after a block of changes of a streamed transaction has been sent.
+ */
+typedef void (*LogicalDecodeStreamStopCB)(struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+
+/*
+ * Callback for every individual change of a streamed transaction. "txn" is
+ * the (sub)transaction the change belongs to, its toplevel_xid is set when it
+ * is a subtransaction.
+ */
+typedef void (*LogicalDecodeStreamChangeCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation relation, ReorderBufferChange* change);
+
+/*
+ * Called when a streamed transaction or subtransaction aborts; the changes
+ * already streamed for it have to be discarded.
+ */
+typedef void (*LogicalDecodeStreamAbortCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr abort_lsn);
+
+/*
+ * Called when a streamed transaction commits, in commit order with the
+ * transactions passed to the commit callback.
+ */
+typedef void (*LogicalDecodeStreamCommitCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr commit_lsn);
+
 /*
  * Output plugin callbacks
  */
@@ -83,6 +117,13 @@ typedef struct OutputPluginCallbacks {
     LogicalDecodeCommitCB commit_cb;
     LogicalDecodeShutdownCB shutdown_cb;
     LogicalDecodeFilterByOriginCB filter_by_origin_cb;
+
+    /* streaming of in-progress transactions, optional */
+    LogicalDecodeStreamStartCB stream_start_cb;
+    LogicalDecodeStreamStopCB stream_stop_cb;
+    LogicalDecodeStreamChangeCB stream_change_cb;
+    LogicalDecodeStreamAbortCB stream_abort_cb;
+    LogicalDecodeStreamCommitCB stream_commit_cb;
 } OutputPluginCallbacks;
 
 extern void OutputPluginPrepareWrite(struct LogicalDecodingContext* ctx, bool last_write);
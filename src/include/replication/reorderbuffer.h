@@ -205,6 +205,19 @@ typedef struct ReorderBufferTXN {
      */
     bool serialized;
 
+    /*
+     * Have changes of this transaction already been streamed to the output
+     * plugin before its commit? Once set, the rest of the transaction is
+     * streamed as well and it ends with a stream commit or abort.
+     */
+    bool streamed;
+
+    /*
+     * Snapshot to continue streaming with, a private copy owned by the
+     * transaction. NULL until the first block has been streamed.
+     */
+    Snapshot stream_snapshot;
+
     /*
      * List of ReorderBufferChange structs, including new Snapshots and new
      * CommandIds
@@ -267,6 +280,13 @@ typedef void (*ReorderBufferBeginCB)(ReorderBuffer* rb, ReorderBufferTXN* txn);
 /* commit callback signature */
 typedef void (*ReorderBufferCommitCB)(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr commit_lsn);
 
+/* stream start/stop callback signature */
+typedef void (*ReorderBufferStreamStartCB)(ReorderBuffer* rb, ReorderBufferTXN* txn);
+typedef void (*ReorderBufferStreamStopCB)(ReorderBuffer* rb, ReorderBufferTXN* txn);
+
+/* stream abort callback signature */
+typedef void (*ReorderBufferStreamAbortCB)(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr abort_lsn);
+
 struct ReorderBuffer {
     /*
      * xid => ReorderBufferTXN lookup table
@@ -302,6 +322,16 @@ struct ReorderBuffer {
     ReorderBufferApplyChangeCB apply_change;
     ReorderBufferCommitCB commit;
 
+    /*
+     * Callbacks to stream large transactions before they commit, only set
+     * if the output plugin supports streaming.
+     */
+    ReorderBufferStreamStartCB stream_start;
+    ReorderBufferStreamStopCB stream_stop;
+    ReorderBufferApplyChangeCB stream_change;
+    ReorderBufferStreamAbortCB stream_abort;
+    ReorderBufferCommitCB stream_commit;
+
     /*
      * Pointer that will be passed untouched to the callbacks.
      */
@@ -312,24 +342,21 @@ struct ReorderBuffer {
      */
     MemoryContext context;
 
+    /*
+     * Slab contexts for the fixed-size structures we allocate/deallocate
+     * very frequently.
+     */
+    MemoryContext change_context;
+    MemoryContext txn_context;
+
     /*
      * Data structure slab cache.
      *
-     * We allocate/deallocate some structures very frequently, to avoid bigger
-     * overhead we cache some unused ones here.
-     *
-     * The maximum number of cached entries is controlled by const variables
-     * ontop of reorderbuffer.c
+     * Tuple buffers vary in size, so unused ones are cached here instead.
+     * The maximum number of cached entries is controlled by the
+     * max_cached_tuplebufs parameter.
      */
 
-    /* cached ReorderBufferTXNs */
-    dlist_head cached_transactions;
-    Size nr_cached_transactions;
-
-    /* cached ReorderBufferChanges */
-    dlist_head cached_changes;
-    Size nr_cached_changes;
-
     /* cached ReorderBufferTupleBufs */
     slist_head cached_tuplebufs;
     Size nr_cached_tuplebufs;
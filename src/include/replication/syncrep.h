@@ -60,6 +60,10 @@ typedef struct SyncRepConfigData {
 
 /* called by user backend */
 extern void SyncRepWaitForLSN(XLogRecPtr XactCommitLSN);
+extern int SyncRepGetDeferredWaitMode(void);
+
+/* called by thread pool listener */
+extern bool SyncRepLSNConfirmed(XLogRecPtr XactCommitLSN, int mode);
 
 /* called at backend exit */
 extern void SyncRepCleanupAtProcExit(void);
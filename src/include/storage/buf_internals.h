@@ -227,8 +227,51 @@ typedef union BufferDescPadded {
 } BufferDescPadded;
 
 #define GetBufferDescriptor(id) (&t_thrd.storage_cxt.BufferDescriptors[(id)].bufferdesc)
+
+/*
+ * When the buffer pool is mapped by itself (huge pages or NUMA placement),
+ * its descriptors and pages are split into one contiguous range of buffer
+ * ids per NUMA node, each range bound to its node's memory.
+ */
+#define BUFFER_NUMA_MAX_NODES 16
+
+typedef struct BufferPoolLayout {
+    char* descsAddr;     /* own mapping of the descriptors, NULL if in shmem */
+    Size descsSize;      /* mapped size of the descriptors */
+    char* blocksAddr;    /* own mapping of the pages, NULL if in shmem */
+    Size blocksSize;     /* mapped size of the pages */
+    Size blocksPageSize; /* OS page size backing the pages */
+    int numaNodes;       /* number of NUMA partitions, 1 if not partitioned */
+    int buffersPerNode;  /* buffer ids per partition, the last may be short */
+} BufferPoolLayout;
 #define BufferDescriptorGetBuffer(bdesc) ((bdesc)->buf_id + 1)
 
+/*
+ * Ghost table of the 2Q replacement policy.  It remembers the tags of
+ * recently evicted pages by their buffer mapping hash code, one per slot,
+ * together with the eviction count at the time.  A page read again before
+ * nslots further evictions happened is a refault: with a larger pool it
+ * would still be cached, so it is admitted hot.
+ */
+typedef struct BufferGhostTable {
+    pg_atomic_uint64 evictions; /* pages remembered so far */
+    uint32 nslots;
+    pg_atomic_uint64 slots[FLEXIBLE_ARRAY_MEMBER]; /* hash code << 32 | eviction count */
+} BufferGhostTable;
+
+/* usage counts the 2Q policy gives to newly read pages */
+#define BM_2Q_COLD_USAGE_COUNT 0
+#define BM_2Q_HOT_USAGE_COUNT 2
+
+/* counters of the replacement policy, see pg_buffer_replacement_stats() */
+typedef enum BufferStrategyStat {
+    BUFFER_STAT_HITS,       /* lookups that found the page cached */
+    BUFFER_STAT_MISSES,     /* lookups that had to read the page */
+    BUFFER_STAT_EVICTIONS,  /* valid pages replaced by another */
+    BUFFER_STAT_GHOST_HITS, /* misses on pages found in the ghost table */
+    BUFFER_STAT_NUM
+} BufferStrategyStat;
+
 /*
  * Functions for acquiring/releasing a shared buffer header's spinlock.  Do
  * not apply these to local buffers!
@@ -331,6 +374,21 @@ extern void StrategyNotifyBgWriter(int bgwprocno);
 
 extern Size StrategyShmemSize(void);
 extern void StrategyInitialize(bool init);
+extern void StrategyInitNumaPartitions(int numa_nodes, int buffers_per_node);
+
+extern uint32 StrategyAdmitUsageCount(uint32 hashcode, BufferAccessStrategy strategy);
+extern void StrategyRecordHit(void);
+extern void StrategyRecordMiss(void);
+extern void StrategyRecordEviction(uint32 hashcode);
+extern void StrategyGetStats(uint64* stats);
+
+extern Size BufferGhostTableSize(uint32 nslots);
+extern void BufferGhostTableInit(BufferGhostTable* ghost, uint32 nslots);
+extern void BufferGhostRemember(BufferGhostTable* ghost, uint32 hashcode);
+extern bool BufferGhostRefault(BufferGhostTable* ghost, uint32 hashcode);
+
+/* buf_trace.c */
+extern void BufferTraceRecord(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum);
 
 /* buf_table.c */
 extern Size BufTableShmemSize(int size);
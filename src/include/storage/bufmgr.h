@@ -53,6 +53,19 @@ typedef enum {
     RBM_FOR_REMOTE             /* Like RBM_NORMAL, but not remote read again when PageIsVerified failed. */
 } ReadBufferMode;
 
+/* Possible values of shared_buffers_huge_pages */
+typedef enum {
+    BUFFER_HUGE_PAGES_OFF, /* regular pages, buffer pool lives in the main shared memory segment */
+    BUFFER_HUGE_PAGES_TRY, /* explicit huge pages if available, else transparent huge pages */
+    BUFFER_HUGE_PAGES_ON   /* explicit huge pages or fail at startup */
+} BufferHugePagesMode;
+
+/* Possible values of buffer_replacement_policy */
+typedef enum {
+    BUFFER_REPLACEMENT_CLOCK, /* recycle unpinned buffers in clock order */
+    BUFFER_REPLACEMENT_2Q     /* first-touch pages enter cold, refaults from the ghost table enter hot */
+} BufferReplacementPolicy;
+
 typedef enum
 {
 	WITH_NORMAL_CACHE = 0,		/* Normal read */
@@ -52,6 +52,7 @@ typedef struct DfsSrvOptions {
 enum ConnectorType {
     HDFS_CONNECTOR = 0,
     OBS_CONNECTOR = 1,
+    LOCAL_CONNECTOR = 2,
     UNKNOWN_CONNECTOR
 };
 
@@ -73,6 +73,9 @@ extern const char *const MainLWLockNames[];
 /* Number of partions the global plan cache hashtable */
 #define NUM_GPC_PARTITIONS 128
 
+/* Number of partitions of the shared cache of detoasted values */
+#define NUM_TOAST_CACHE_PARTITIONS 16
+
 /*
  * WARNING---Please keep the order of LWLockTrunkOffset and BuiltinTrancheIds consistent!!!
  */
@@ -96,9 +99,11 @@ enum LWLockTrunkOffset {
     /* global plan cache */
     FirstGPCMappingLock = FirstInstrUserLock + NUM_INSTR_USER_PARTITIONS,
     FirstGPCPrepareMappingLock = FirstGPCMappingLock + NUM_GPC_PARTITIONS,
+    /* shared cache of detoasted values */
+    FirstToastCacheLock = FirstGPCPrepareMappingLock + NUM_GPC_PARTITIONS,
 
     /* must be last: */
-    NumFixedLWLocks = FirstGPCPrepareMappingLock + NUM_GPC_PARTITIONS,
+    NumFixedLWLocks = FirstToastCacheLock + NUM_TOAST_CACHE_PARTITIONS,
 };
 
 /*
@@ -125,6 +130,7 @@ enum BuiltinTrancheIds {
     LWTRANCHE_INSTR_USER,
     LWTRANCHE_GPC_MAPPING,
     LWTRANCHE_GPC_PREPARE_MAPPING,
+    LWTRANCHE_TOAST_CACHE,
     LWTRANCHE_BUFFER_IO_IN_PROGRESS,
     LWTRANCHE_BUFFER_CONTENT,
     LWTRANCHE_DATA_CACHE,
@@ -182,6 +188,7 @@ struct PGPROC;
 
 typedef struct LWLock {
     uint16 tranche;         /* tranche ID */
+    uint16 cohort;          /* 1 + index of its NUMA cohort, 0 if none */
     pg_atomic_uint32 state; /* state of exlusive/nonexclusive lockers */
     dlist_head waiters;     /* list of waiting PGPROCs */
 #ifdef LOCK_DEBUG
@@ -239,8 +246,28 @@ typedef union LWLockPadded {
 typedef struct LWLockHandle {
     LWLock *lock;
     LWLockMode mode;
+    int cohort_node;     /* NUMA node the lock may be passed on within, or -1 */
+    int64 acquire_time;  /* when the lock was acquired, 0 if not timed */
 } LWLockHandle;
 
+/*
+ * Contention statistics of one tranche.  The waits and holds are only timed
+ * while track_lwlock_timing is on, the handoffs are always counted.
+ * Element i of a histogram counts the durations of at least 2^(i-1) and
+ * less than 2^i microseconds, the last one also counts all longer ones.
+ */
+#define LWLOCK_TIMING_BUCKETS 16
+
+typedef struct LWLockTrancheStat {
+    pg_atomic_uint64 wait_count;
+    pg_atomic_uint64 wait_time; /* in microseconds */
+    pg_atomic_uint64 wait_hist[LWLOCK_TIMING_BUCKETS];
+    pg_atomic_uint64 hold_count;
+    pg_atomic_uint64 hold_time; /* in microseconds */
+    pg_atomic_uint64 hold_hist[LWLOCK_TIMING_BUCKETS];
+    pg_atomic_uint64 handoff_count; /* lock passed on within a NUMA node */
+} LWLockTrancheStat;
+
 #define GetMainLWLockByIndex(i) (&t_thrd.shemem_ptr_cxt.mainLWLockArray[i].lock)
 
 extern void DumpLWLockInfo();
@@ -268,6 +295,7 @@ extern void CreateLWLocks(void);
 
 extern void RequestAddinLWLocks(int n);
 extern const char *GetBuiltInTrancheName(int trancheId);
+extern void LWLockGetTrancheStat(int trancheId, LWLockTrancheStat *stat);
 
 extern void wakeup_victim(LWLock *lock, ThreadId victim_tid);
 extern int *get_held_lwlocks_num(void);
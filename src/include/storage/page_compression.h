@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * page_compression.h
+ *        Transparent block compression of relation segments.
+ *
+ * A compressed segment keeps its pages in fixed-size chunks of the ordinary
+ * segment file, and an address file named "<segment>_pca" tells which
+ * chunks hold each block.  The address file is mapped shared by every
+ * process that opens the segment, so chunk allocation and the segment size
+ * are maintained with atomics on the mapping.
+ *
+ * Behind the block entries the address file keeps three chunk bitmaps: the
+ * chunks free for reuse and two lists of chunks released since the map was
+ * last synced, which only become free once the map no longer pointing at
+ * them is on disk.
+ *
+ * IDENTIFICATION
+ *        src/include/storage/page_compression.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef PAGE_COMPRESSION_H
+#define PAGE_COMPRESSION_H
+
+#include "storage/block.h"
+#include "storage/fd.h"
+#include "utils/relcache.h"
+
+#define PCA_SUFFIX "_pca"
+#define PAGE_COMPRESS_MAGIC 0x50434131 /* "PCA1" */
+
+/* values of the "compresstype" reloption */
+typedef enum PageCompressAlgorithm {
+    PAGE_COMPRESS_NONE = 0,
+    PAGE_COMPRESS_PGLZ,
+    PAGE_COMPRESS_LZ4,
+    PAGE_COMPRESS_MAX_ALGORITHM = PAGE_COMPRESS_LZ4
+} PageCompressAlgorithm;
+
+/* legal values of the "compress_chunk_size" reloption */
+#define PAGE_COMPRESS_MIN_CHUNK_SIZE (BLCKSZ / 16)
+#define PAGE_COMPRESS_MAX_CHUNK_SIZE (BLCKSZ / 2)
+#define PAGE_COMPRESS_DEFAULT_CHUNK_SIZE PAGE_COMPRESS_MAX_CHUNK_SIZE
+#define PAGE_COMPRESS_MAX_CHUNKS (BLCKSZ / PAGE_COMPRESS_MIN_CHUNK_SIZE)
+
+/*
+ * Compression settings travel from the reloptions to mdcreate() and the
+ * XLOG_SMGR_CREATE record packed in one word; zero means uncompressed.
+ */
+#define PAGE_COMPRESS_OPT(algorithm, chunkSize) ((((uint32)(algorithm)) << 16) | ((uint32)(chunkSize)))
+#define PAGE_COMPRESS_OPT_ALGORITHM(opt) ((uint16)((opt) >> 16))
+#define PAGE_COMPRESS_OPT_CHUNK_SIZE(opt) ((uint16)((opt) & 0xFFFF))
+
+typedef struct PageCompressHeader {
+    uint32 magic;                     /* PAGE_COMPRESS_MAGIC once initialized */
+    uint16 algorithm;                 /* PageCompressAlgorithm */
+    uint16 chunk_size;                /* bytes per chunk */
+    volatile uint32 nblocks;          /* logical length of the segment */
+    volatile uint32 allocated_chunks; /* chunks handed out in the segment file */
+    volatile uint32 free_chunks;      /* bits set in the free bitmap, roughly */
+    volatile uint32 free_hint;        /* bitmap word to look for free chunks first */
+    volatile uint32 release_gen;      /* its low bit selects the release bitmap in use */
+    volatile uint32 syncing;          /* a sync is folding a release bitmap */
+} PageCompressHeader;
+
+/*
+ * Per-block entry.  chunknos[] are 1-based chunk numbers in the segment
+ * file; the first nchunks of them hold the current image of the block.  A
+ * block stored with BLCKSZ / chunk_size chunks is not compressed.
+ */
+typedef struct PageCompressAddr {
+    volatile uint8 nchunks;
+    uint32 chunknos[FLEXIBLE_ARRAY_MEMBER];
+} PageCompressAddr;
+
+/*
+ * A segment may use twice the chunks its blocks can fill: every block may
+ * have been rewritten to new chunks since the map was last synced.
+ */
+#define PageCompressMaxChunks(chunkSize) ((uint32)(2 * RELSEG_SIZE * (BLCKSZ / (chunkSize))))
+#define PageCompressBitmapWords(chunkSize) ((Size)(PageCompressMaxChunks(chunkSize) + 63) / 64)
+
+/* bitmaps behind the block entries */
+#define PAGE_COMPRESS_FREE_BITMAP 0
+#define PAGE_COMPRESS_RELEASE_BITMAP(gen) (1 + ((gen) & 1))
+#define PAGE_COMPRESS_NUM_BITMAPS 3
+
+#define SizeOfPageCompressAddr(chunkSize) \
+    (offsetof(PageCompressAddr, chunknos) + sizeof(uint32) * (BLCKSZ / (chunkSize)))
+#define PageCompressAddrOffset(chunkSize, blkno) \
+    (MAXALIGN(sizeof(PageCompressHeader)) + (Size)(blkno) * SizeOfPageCompressAddr(chunkSize))
+#define PageCompressBitmapOffset(chunkSize, which) \
+    (TYPEALIGN(sizeof(uint64), PageCompressAddrOffset(chunkSize, RELSEG_SIZE)) + \
+        (Size)(which) * PageCompressBitmapWords(chunkSize) * sizeof(uint64))
+#define GetPageCompressAddr(header, blkno) \
+    ((PageCompressAddr*)((char*)(header) + PageCompressAddrOffset((header)->chunk_size, (blkno))))
+#define GetPageCompressBitmap(header, which) \
+    ((volatile uint64*)((char*)(header) + PageCompressBitmapOffset((header)->chunk_size, (which))))
+
+/* An open address file; the segment's blocks are numbered from zero */
+typedef struct PageCompressMap {
+    PageCompressHeader* header;
+    Size size;
+} PageCompressMap;
+
+extern void PageCompressCheckOptions(int algorithm, int chunkSize);
+extern uint32 PageCompressOptFromReloptions(const bytea* options);
+extern uint32 RelationGetPageCompressOpt(Relation relation);
+
+extern PageCompressMap* PageCompressOpenMap(const char* segpath, uint32 createOpt);
+extern void PageCompressCloseMap(PageCompressMap* map);
+extern void PageCompressUnlinkMap(const char* segpath);
+extern int PageCompressSyncMap(const PageCompressMap* map, File file, uint32 wait_event_info);
+extern uint32 PageCompressGetOpt(const PageCompressMap* map);
+extern BlockNumber PageCompressGetNBlocks(const PageCompressMap* map);
+
+extern int PageCompressReadBlock(
+    const PageCompressMap* map, File file, BlockNumber blkno, char* buffer, bool* badBlock);
+extern int PageCompressWriteBlock(
+    const PageCompressMap* map, File file, BlockNumber blkno, const char* buffer, uint32 wait_event_info);
+extern int PageCompressTruncate(const PageCompressMap* map, File file, BlockNumber nblocks);
+
+#endif /* PAGE_COMPRESSION_H */
@@ -151,6 +151,7 @@ struct PGPROC {
     bool lwWaiting;        /* true if waiting for an LW lock */
     uint8 lwWaitMode;      /* lwlock mode being waited for */
     bool lwIsVictim;       /* force to give up LWLock acquire */
+    bool lwHandoff;        /* LW lock passed on to us still held */
     dlist_node lwWaitLink; /* next waiter for same LW lock */
 
     /* Info about lock the process is currently waiting for, if any. */
@@ -62,6 +62,12 @@ typedef struct SMgrRelationData {
     int smgr_bcmarry_size;
     BlockNumber* smgr_bcm_nblocks; /* last known size of bcm fork */
 
+    /*
+     * Page compression for the main fork, packed by PAGE_COMPRESS_OPT; set
+     * by the caller of smgrcreate() only for the duration of the call.
+     */
+    uint32 smgr_compress;
+
     /* additional public fields may someday exist here */
 
     /*
@@ -96,6 +102,7 @@ extern void smgrdounlinkfork(SMgrRelation reln, ForkNumber forknum, bool isRedo)
 extern void smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
 extern void smgrprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
 extern void smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
+extern bool smgrtryread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
 extern void smgrwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
 extern void smgrwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber smgrnblocks(SMgrRelation reln, ForkNumber forknum);
@@ -118,6 +125,7 @@ extern void mdunlink(const RelFileNodeBackend& rnode, ForkNumber forknum, bool i
 extern void mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
 extern void mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
 extern void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
+extern bool mdtryread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
 extern void mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
 extern void mdwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber mdnblocks(SMgrRelation reln, ForkNumber forknum);
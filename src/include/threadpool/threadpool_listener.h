@@ -47,6 +47,7 @@ public:
     void DelSessionFromEpoll(knl_session_context* session);
     void RemoveWorkerFromList(ThreadPoolWorker* worker);
     void AddEpoll(knl_session_context* session);
+    void AddCommitAckWait(knl_session_context* session);
     void SendShutDown();
     void ReaperAllSession();
 
@@ -59,6 +60,7 @@ private:
     void HandleConnEvent(int nevets);
     knl_session_context* GetSessionBaseOnEvent(struct epoll_event* ev);
     void DispatchSession(knl_session_context* session);
+    void ReleaseCommitAckSessions();
 
 private:
     ThreadId m_tid;
@@ -68,6 +70,10 @@ private:
     DllistWithLock* m_freeWorkerList;
     DllistWithLock* m_readySessionList;
     DllistWithLock* m_idleSessionList;
+
+    /* sessions parked until their deferred commit acknowledgement is durable */
+    DllistWithLock* m_commitAckSessionList;
+    int m_wakeupFd;
 };
 
 #endif /* THREAD_POOL_LISTENER_H */
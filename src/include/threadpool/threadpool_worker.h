@@ -130,6 +130,8 @@ private:
     void RestoreThreadVariable();
     void RestoreLocaleInfo();
     void SetSessionInfo();
+    void HoldDeferredCommitAck();
+    void SendDeferredCommitAck();
 
 private:
     ThreadId m_tid;
@@ -208,6 +208,50 @@ private:
     static void AllocSetMethodDefinition(MemoryContextMethods* method);
 };
 
+// a slab memory allocator for objects of one fixed size which
+// 1) carves equal-sized chunks out of equal-sized blocks
+// 2) tracks free chunks with a per-block bitmap instead of freelists
+// 3) gives a block back to the system as soon as all its chunks are freed.
+class SlabMemoryAllocator {
+public:
+    static MemoryContext SlabContextCreate(
+        _in_ MemoryContext parent, _in_ const char* name, _in_ Size blockSize, _in_ Size chunkSize);
+
+    template <bool memoryprotect_enable, bool is_tracked>
+    static void* AllocSetAlloc(
+        _in_ MemoryContext context, _in_ Size align, _in_ Size size, _in_ const char* file, _in_ int line);
+
+    template <bool memoryprotect_enable, bool is_tracked>
+    static void AllocSetFree(_in_ MemoryContext context, _in_ void* pointer);
+
+    static void* AllocSetRealloc(_in_ MemoryContext context, _in_ void* pointer, _in_ Size align, _in_ Size size,
+        _in_ const char* file, _in_ int line);
+
+    static void AllocSetInit(_in_ MemoryContext context);
+
+    template <bool memoryprotect_enable, bool is_tracked>
+    static void AllocSetReset(_in_ MemoryContext context);
+
+    template <bool memoryprotect_enable, bool is_tracked>
+    static void AllocSetDelete(_in_ MemoryContext context);
+
+    static Size AllocSetGetChunkSpace(_in_ MemoryContext context, _in_ void* pointer);
+
+    static bool AllocSetIsEmpty(_in_ MemoryContext context);
+
+    static void AllocSetStats(_in_ MemoryContext context, _in_ int level);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+    static void AllocSetCheck(_in_ MemoryContext context);
+#endif
+
+private:
+    static void AllocSetContextSetMethods(_in_ unsigned long value, MemoryContextMethods* method);
+
+    template <bool memoryprotect_enable, bool is_tracked>
+    static void AllocSetMethodDefinition(MemoryContextMethods* method);
+};
+
 class MemoryProtectFunctions {
 public:
     template <MemType mem_type>
@@ -20,6 +20,7 @@ typedef struct AttributeOpts {
     int32 vl_len_; /* varlena header (do not touch directly!) */
     float8 n_distinct;
     float8 n_distinct_inherited;
+    int toast_compression; /* offset of the compression method name, 0 if not set */
 } AttributeOpts;
 
 AttributeOpts* get_attribute_options(Oid spcid, int attnum);
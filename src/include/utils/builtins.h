@@ -937,6 +937,7 @@ extern Datum unknownrecv(PG_FUNCTION_ARGS);
 extern Datum unknownsend(PG_FUNCTION_ARGS);
 
 extern Datum pg_column_size(PG_FUNCTION_ARGS);
+extern Datum pg_column_compression(PG_FUNCTION_ARGS);
 extern Datum datalength(PG_FUNCTION_ARGS);
 
 extern Datum bytea_string_agg_transfn(PG_FUNCTION_ARGS);
@@ -1385,9 +1386,21 @@ extern Datum pg_extension_config_dump(PG_FUNCTION_ARGS);
 /* commands/prepare.c */
 extern Datum pg_prepared_statement(PG_FUNCTION_ARGS);
 
+/* pl/plpgsql/src/pl_comp.c */
+extern Datum pg_plpgsql_compiled_functions(PG_FUNCTION_ARGS);
+
 /* utils/mmgr/portalmem.c */
 extern Datum pg_cursor(PG_FUNCTION_ARGS);
 
+/* storage/buffer/buf_trace.cpp */
+extern Datum pg_buffer_replacement_stats(PG_FUNCTION_ARGS);
+extern Datum pg_buffer_trace_start(PG_FUNCTION_ARGS);
+extern Datum pg_buffer_trace_stop(PG_FUNCTION_ARGS);
+extern Datum pg_buffer_replacement_replay(PG_FUNCTION_ARGS);
+
+/* postmaster/lwlockmonitor.cpp */
+extern Datum pg_lwlock_tranche_stats(PG_FUNCTION_ARGS);
+
 /* utils/adt/pgstatfuncs.c */
 extern Datum pg_stat_get_dead_tuples(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_tuples_changed(PG_FUNCTION_ARGS);
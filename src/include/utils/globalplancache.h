@@ -117,6 +117,54 @@ typedef struct GPCEntry
     int magic;
 } GPCEntry;
 
+/*
+ * A parameter compared with "=" to a column of a base relation, its value
+ * decides which plan variant a binding uses.
+ */
+typedef struct GPCDecidingParam
+{
+    int paramid;
+    Oid relid;
+    AttrNumber attnum;
+    Oid vartype;
+    int32 vartypmod;
+    Oid collid;         /* collation of the column */
+    Oid opfuncid;
+    bool varonleft;
+    int num_mcvs;       /* most common values beyond the lowest bucket */
+    Datum *mcv_values;
+    uint8 *mcv_buckets; /* selectivity bucket of each of them */
+} GPCDecidingParam;
+
+#define GPC_MAX_DECIDING_PARAMS (4)
+#define GPC_MAX_PLAN_VARIANTS (8)
+#define GPC_SELEC_BUCKET_BITS (2)
+
+typedef struct GPCPlanVariant
+{
+    uint32 signature;   /* selectivity buckets of the deciding params */
+    CachedPlan *plan;
+    int64 hits;
+} GPCPlanVariant;
+
+/*
+ * Plan variants of a shared CachedPlanSource.  The generic plan serves the
+ * bindings whose deciding params all fall in the lowest selectivity bucket,
+ * the other signatures get a plan estimated with their own values.  Variants
+ * are only appended, under CAS_flag, and never change once published.
+ */
+typedef struct GPCPlanVariants
+{
+    int32 CAS_flag;
+    bool resolved;      /* the deciding params have been looked for */
+    int num_params;
+    GPCDecidingParam params[GPC_MAX_DECIDING_PARAMS];
+    MemoryContext stats_context; /* holds the most common values of the params */
+    int64 generic_hits;
+    int num_variants;
+    GPCPlanVariant variants[GPC_MAX_PLAN_VARIANTS];
+} GPCPlanVariants;
+
 typedef struct GPCEnv
 {
     GPCEntry *globalplancacheentry;
@@ -187,6 +235,14 @@ typedef struct GPCStatus
     int params_num;
 } GPCStatus;
 
+typedef struct GPCVariantStatus
+{
+    char *query;
+    int variant;
+    uint32 signature;
+    int64 hits;
+} GPCVariantStatus;
+
 typedef struct GPCPrepareStatus
 {
     char *statement_name;
@@ -237,9 +293,16 @@ public:
     void PrepareClean(uint32 cn_id);
     void CheckTimeline(uint32 timeline);
 
+    /* plan variants */
+    void VariantsInit(CachedPlanSource *plansource);
+    uint32 VariantSignature(CachedPlanSource *plansource, ParamListInfo boundParams);
+    CachedPlan* VariantFetch(CachedPlanSource *plansource, uint32 signature);
+    CachedPlan* VariantStore(CachedPlanSource *plansource, uint32 signature, CachedPlan *plan);
+
     /* system function */
     void* GetStatus(uint32 *num);
     void* GetPrepareStatus(uint32 *num);
+    void* GetVariantStatus(uint32 *num);
     void SendPrepareDestoryMsg();
 
 private:
@@ -26,5 +26,6 @@ extern Datum array_to_json_pretty(PG_FUNCTION_ARGS);
 extern Datum row_to_json(PG_FUNCTION_ARGS);
 extern Datum row_to_json_pretty(PG_FUNCTION_ARGS);
 extern void escape_json(StringInfo buf, const char* str);
+extern void json_validate_cstring(char* input);
 
 #endif /* JSON_H */
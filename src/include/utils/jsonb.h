@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * jsonb.h
+ *        Declarations for the binary JSON data type.
+ *
+ * A jsonb datum is a tree of containers.  Each container starts with a
+ * uint32 header holding the number of children and the JB_F* flags, then
+ * one JEntry per child, then the data of the children.  An object stores
+ * the JEntries of all its keys first and the JEntries of the values after
+ * them, keys sorted by (length, bytes), so a key is found by a binary
+ * search over the key entries and the keys data, both at the head of the
+ * container.  A JEntry holds the type of the child and the end offset of
+ * its data, counted from the start of the data area of the container; a
+ * child starts where the previous one ends, INTALIGN'd for numerics and
+ * nested containers.  A scalar at the top level is stored as a one
+ * element array flagged JB_FSCALAR.
+ *
+ * IDENTIFICATION
+ *        src/include/utils/jsonb.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#ifndef JSONB_H
+#define JSONB_H
+
+#include "fmgr.h"
+#include "lib/stringinfo.h"
+#include "utils/numeric.h"
+
+/* strategy numbers of the GIN jsonb_ops opclass */
+#define JsonbContainsStrategyNumber 7
+#define JsonbExistsStrategyNumber 9
+#define JsonbExistsAnyStrategyNumber 10
+#define JsonbExistsAllStrategyNumber 11
+
+/* flag bytes of the GIN keys, the key bytes follow */
+#define JGINFLAG_KEY 0x01  /* object key, or string element of an array */
+#define JGINFLAG_NULL 0x02 /* null value */
+#define JGINFLAG_BOOL 0x03 /* boolean value, "t" or "f" */
+#define JGINFLAG_NUM 0x04  /* numeric value, hash of the normalized numeric */
+#define JGINFLAG_STR 0x05  /* string value of an object member */
+#define JGINFLAG_HASHED 0x10 /* OR'd in when a long string is replaced by its hash */
+#define JGIN_MAXLENGTH 125   /* strings longer than this are hashed */
+
+typedef uint32 JEntry;
+
+#define JENTRY_ENDPOSMASK 0x0FFFFFFF
+#define JENTRY_TYPEMASK 0x70000000
+
+#define JENTRY_ISSTRING 0x00000000
+#define JENTRY_ISNUMERIC 0x10000000
+#define JENTRY_ISBOOL_FALSE 0x20000000
+#define JENTRY_ISBOOL_TRUE 0x30000000
+#define JENTRY_ISNULL 0x40000000
+#define JENTRY_ISCONTAINER 0x50000000
+
+#define JBE_ENDPOS(je) ((je) & JENTRY_ENDPOSMASK)
+#define JBE_TYPE(je) ((je) & JENTRY_TYPEMASK)
+
+/* flags of the container header, the low bits hold the number of children */
+#define JB_CMASK 0x0FFFFFFF
+#define JB_FSCALAR 0x10000000
+#define JB_FOBJECT 0x20000000
+#define JB_FARRAY 0x40000000
+
+typedef struct {
+    int32 vl_len_; /* varlena header (do not touch directly!) */
+    uint32 header; /* header of the root container */
+    /* the JEntries and the data of the root container follow */
+} Jsonb;
+
+#define DatumGetJsonb(d) ((Jsonb*)PG_DETOAST_DATUM(d))
+#define JsonbGetDatum(p) PointerGetDatum(p)
+#define PG_GETARG_JSONB(x) DatumGetJsonb(PG_GETARG_DATUM(x))
+#define PG_RETURN_JSONB(x) PG_RETURN_POINTER(x)
+
+#define JBC_HEADER(c) (*(const uint32*)(c))
+#define JBC_COUNT(c) (JBC_HEADER(c) & JB_CMASK)
+#define JBC_IS_OBJECT(c) ((JBC_HEADER(c) & JB_FOBJECT) != 0)
+
+#define JB_ROOT(jb) ((char*)&(jb)->header)
+#define JB_ROOT_COUNT(jb) ((jb)->header & JB_CMASK)
+#define JB_ROOT_IS_SCALAR(jb) (((jb)->header & JB_FSCALAR) != 0)
+#define JB_ROOT_IS_OBJECT(jb) (((jb)->header & JB_FOBJECT) != 0)
+#define JB_ROOT_IS_ARRAY(jb) (((jb)->header & JB_FARRAY) != 0)
+
+typedef enum {
+    jbvNull,
+    jbvString,
+    jbvNumeric,
+    jbvBool,
+    jbvArray,
+    jbvObject,
+    jbvBinary /* a container still in its serialized form */
+} JsonbValueType;
+
+typedef struct JsonbPair JsonbPair;
+typedef struct JsonbValue JsonbValue;
+
+struct JsonbValue {
+    JsonbValueType type;
+    union {
+        Numeric numeric;
+        bool boolean;
+        struct {
+            int len;
+            char* val; /* not NUL-terminated */
+        } string;
+        struct {
+            int nElems;
+            JsonbValue* elems;
+            bool rawScalar; /* top level scalar wrapped into an array */
+        } array;
+        struct {
+            int nPairs;
+            JsonbPair* pairs;
+        } object;
+        struct {
+            int len;
+            char* data; /* points to a container header */
+        } binary;
+    } val;
+};
+
+struct JsonbPair {
+    JsonbValue key;
+    JsonbValue value;
+    uint32 order; /* position in the input, the last duplicate wins */
+};
+
+/* container access, shared by the operators and the GIN support */
+extern void JsonbContainerChild(const char* container, uint32 index, JsonbValue* result);
+extern bool JsonbFindKey(const char* container, const char* key, int keylen, JsonbValue* result);
+extern bool JsonbDeepContains(const char* container, const char* contained);
+extern Jsonb* JsonbValueToJsonb(JsonbValue* val);
+extern char* JsonbToCString(StringInfo out, const char* container, int estimatedLen);
+
+/* I/O routines */
+extern Datum jsonb_in(PG_FUNCTION_ARGS);
+extern Datum jsonb_out(PG_FUNCTION_ARGS);
+extern Datum jsonb_recv(PG_FUNCTION_ARGS);
+extern Datum jsonb_send(PG_FUNCTION_ARGS);
+
+/* operators */
+extern Datum jsonb_object_field(PG_FUNCTION_ARGS);
+extern Datum jsonb_object_field_text(PG_FUNCTION_ARGS);
+extern Datum jsonb_array_element(PG_FUNCTION_ARGS);
+extern Datum jsonb_array_element_text(PG_FUNCTION_ARGS);
+extern Datum jsonb_extract_path(PG_FUNCTION_ARGS);
+extern Datum jsonb_extract_path_text(PG_FUNCTION_ARGS);
+extern Datum jsonb_exists(PG_FUNCTION_ARGS);
+extern Datum jsonb_exists_any(PG_FUNCTION_ARGS);
+extern Datum jsonb_exists_all(PG_FUNCTION_ARGS);
+extern Datum jsonb_contains(PG_FUNCTION_ARGS);
+extern Datum jsonb_contained(PG_FUNCTION_ARGS);
+
+/* GIN support */
+extern Datum gin_compare_jsonb(PG_FUNCTION_ARGS);
+extern Datum gin_extract_jsonb(PG_FUNCTION_ARGS);
+extern Datum gin_extract_jsonb_query(PG_FUNCTION_ARGS);
+extern Datum gin_consistent_jsonb(PG_FUNCTION_ARGS);
+extern Datum gin_triconsistent_jsonb(PG_FUNCTION_ARGS);
+
+#endif /* JSONB_H */
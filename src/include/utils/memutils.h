@@ -135,6 +135,16 @@ extern MemoryContext AllocSetContextCreate(MemoryContext parent, const char* nam
     Size initBlockSize, Size maxBlockSize, MemoryContextType type = STANDARD_CONTEXT,
     Size maxSize = DEFAULT_MEMORY_CONTEXT_MAX_SIZE, bool isSession = false);
 
+/* asetslab.cpp */
+extern MemoryContext SlabContextCreate(MemoryContext parent, const char* name, Size blockSize, Size chunkSize);
+
+/*
+ * Recommended block sizes for slab contexts: the default one suits small
+ * objects, the large one suits objects of several kilobytes.
+ */
+#define SLAB_DEFAULT_BLOCK_SIZE (8 * 1024)
+#define SLAB_LARGE_BLOCK_SIZE (8 * 1024 * 1024)
+
 /*
  * Recommended default alloc parameters, suitable for "ordinary" contexts
  * that might hold quite a lot of data.
@@ -61,6 +61,7 @@ typedef struct GPCSource
 
     struct GPCEntry *entry;
     struct GPCEnv *env;
+    struct GPCPlanVariants *variants;
 
     int refcount;
 
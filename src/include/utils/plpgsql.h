@@ -673,6 +673,21 @@ typedef struct PLpgSQL_func_hashkey { /* Hash lookup key for functions */
     Oid argtypes[FUNC_MAX_ARGS];
 } PLpgSQL_func_hashkey;
 
+/* state of the native code of a function, see plpgsqlcodegen.cpp */
+typedef enum {
+    PLPGSQL_CODEGEN_NONE,        /* not compiled (yet) */
+    PLPGSQL_CODEGEN_COMPILED,    /* fn_native is set */
+    PLPGSQL_CODEGEN_UNSUPPORTED, /* uses something the compiler cannot handle */
+    PLPGSQL_CODEGEN_FAILED       /* LLVM raised an error */
+} PLpgSQL_codegen_status;
+
+/*
+ * Compiled body of a function.  Returns 0 and sets *result on success,
+ * anything else when the call must be run again by the interpreter, which
+ * then raises the error or handles the case the native code does not.
+ */
+typedef int32 (*PLpgSQL_native_fn)(Datum* args, Datum* result, volatile bool* interrupt);
+
 typedef struct PLpgSQL_function { /* Complete compiled function	  */
     char* fn_signature;
     Oid fn_oid;
@@ -734,6 +749,15 @@ typedef struct PLpgSQL_function { /* Complete compiled function	  */
     /* these fields are used during trigger pre-parsing */
     bool pre_parse_trig;
     Relation tg_relation;
+
+    /* these fields are used by the native compilation of the function */
+    uint64 fn_calls;            /* calls run by the interpreter */
+    uint64 fn_native_calls;     /* calls run by the native code */
+    uint64 fn_native_fallbacks; /* native calls handed back to the interpreter */
+    PLpgSQL_codegen_status fn_codegen_status;
+    const char* fn_codegen_reason; /* why the function is not compiled */
+    void* fn_codegen;              /* GsCodeGen owning the native code */
+    PLpgSQL_native_fn fn_native;
 } PLpgSQL_function;
 
 typedef struct PLpgSQL_execstate { /* Runtime execution data	*/
@@ -954,6 +978,15 @@ extern void plpgsql_free_function_memory(PLpgSQL_function* func);
 extern void plpgsql_dumptree(PLpgSQL_function* func);
 extern bool plpgsql_is_trigger_shippable(PLpgSQL_function* func);
 
+/* ----------
+ * Native compilation in plpgsqlcodegen.cpp
+ * ----------
+ */
+#ifdef ENABLE_LLVM_COMPILE
+extern void PLpgSQLFunctionCodeGen(PLpgSQL_function* func);
+extern void PLpgSQLFunctionCodeGenRelease(PLpgSQL_function* func);
+#endif
+
 /* ----------
  * Scanner functions in pl_scanner.c
  * ----------
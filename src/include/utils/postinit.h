@@ -72,6 +72,8 @@ public:
 
     void InitAutoVacWorker();
 
+    void InitVacuumIndexWorker();
+
     void InitCatchupWorker();
 
     void InitStreamWorker();
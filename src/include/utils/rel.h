@@ -282,6 +282,8 @@ typedef struct StdRdOptions {
     bool ignore_enable_hadoop_env; /* ignore enable_hadoop_env */
     bool user_catalog_table;       /* use as an additional catalog relation */
     bool hashbucket;        /* enable hash bucket for this relation */
+    int compresstype;        /* page compression algorithm, see storage/page_compression.h */
+    int compress_chunk_size; /* size of the chunks compressed pages are stored in */
 
     /* info for redistribution */
     Oid rel_cn_oid;
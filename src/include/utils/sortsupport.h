@@ -99,6 +99,27 @@ typedef struct SortSupportData {
      */
     int (*comparator)(Datum x, Datum y, SortSupport ssup);
 
+    /*
+     * Set by the BTSORTSUPPORT function when "comparator" looks at nothing
+     * but the two Datums it is given: no palloc, no detoasting, no ereport
+     * and no catalog access.  tuplesort.c may then call it from the helper
+     * threads of a parallel in-memory sort.
+     */
+    bool comparator_threadsafe;
+
+    /*
+     * Radix sort support.  If "comparator" orders Datums exactly as the
+     * unsigned integers obtained by XOR'ing their low radix_width bytes with
+     * radix_mask, the BTSORTSUPPORT function sets radix_width to that number
+     * of bytes; it stays 0 otherwise.  radix_exact says that Datums that
+     * compare equal this way are also equal for the authoritative comparator.
+     * When abbreviation is in play this describes the abbreviated keys, and
+     * core code clears radix_width if it gives up on abbreviation.
+     */
+    int radix_width;
+    Datum radix_mask;
+    bool radix_exact;
+
     /*
      * "Abbreviated key" infrastructure follows.
      *
@@ -33,6 +33,10 @@
 #define IO_TYPE_COLUMN 0  // IO type for column
 #define IO_TYPE_ROW 1     // IO type for row
 
+/* IO classes for the token buckets */
+#define IO_CLASS_INTERACTIVE 0  // charged to the bucket, never delayed
+#define IO_CLASS_BULK 1         // delayed while the bucket is empty
+
 /* iostat */
 #define MAX_DEVICE_DIR 256
 #define UTIL_COUNT_LEN 3
@@ -80,6 +84,11 @@
 
 #define AVERAGE_DISK_VALUE(m, n, p, u) (((double)((n) - (m))) / (p)*u)
 
+/* count of IO token buckets, one for each resource pool with iops_limits */
+#define WLM_IO_BUCKET_NUM 64
+/* longest sleep in microseconds before checking interrupts and the bucket again */
+#define WLM_IO_BUCKET_MAX_SLEEP 100000
+
 typedef struct IORequestEntry {
     int amount;     // IO amount
     int rqst_type;  // IO type
@@ -89,6 +98,19 @@ typedef struct IORequestEntry {
     pthread_cond_t io_proceed_cond;
 } IORequestEntry;
 
+/*
+ * Token bucket of a resource pool.  It is refilled with iops_limits tokens
+ * per second, up to one second of tokens, and every block IO takes one.
+ * Interactive IO may leave it in debt, down to minus one second of tokens,
+ * which bulk IO has to wait for.
+ */
+typedef struct WLMIoBucket {
+    Oid rpoid;                  /* resource pool, InvalidOid if the bucket is free */
+    slock_t mutex;              /* protects the fields below */
+    int64 tokens;               /* block IOs allowed right now */
+    TimestampTz refill_time;    /* time the tokens were last refilled */
+} WLMIoBucket;
+
 struct blkio_info {
     int used;
     uint64 rd_ios;     /* Read I/O operations */
@@ -162,10 +184,14 @@ typedef struct WLMIOContext {
 
     /* device init */
     bool device_init;
+
+    /* token buckets of the resource pools */
+    WLMIoBucket io_buckets[WLM_IO_BUCKET_NUM];
 } WLMIOContext;
 
 extern void IOStatistics(int type, int count, int size);
 extern void IOSchedulerAndUpdate(int type, int count, int store_type);
+extern void IOSchedulerConsumeTokens(int type, int ioclass, int count);
 extern void WLMmonitor_check_and_update_IOCost(PlannerInfo* root, NodeTag node, Cost IOcost);
 
 /* monitoring thread use  */
@@ -0,0 +1,75 @@
+#!/bin/sh
+#the shell is to test that compressed tables survive a crash while their pages are rewritten,
+#and that the chunks of rewritten pages are reused
+
+source ./standby_env.sh
+
+function query_value()
+{
+gsql -d $db -p $dn1_primary_port -t -A -c "$1"
+}
+
+function check_table()
+{
+if [ "$(query_value "select count(*), sum(a), sum(length(b)) from pc_crash;")" = "$1" ]; then
+	echo "pc_crash is intact after $2"
+else
+	echo "pc_crash $failed_keyword after $2"
+	exit 1
+fi
+
+if [ "$(query_value "set enable_seqscan = off; select count(*) from pc_crash where a > 0;")" = "20000" ]; then
+	echo "pc_crash_a is intact after $2"
+else
+	echo "pc_crash_a $failed_keyword after $2"
+	exit 1
+fi
+}
+
+function test_1()
+{
+check_instance
+
+gsql -d $db -p $dn1_primary_port -c "drop table if exists pc_crash;
+							create table pc_crash (a int, b text) with (compresstype = 2, compress_chunk_size = 1024);
+							create index pc_crash_a on pc_crash (a) with (compresstype = 1, compress_chunk_size = 512);
+							insert into pc_crash select i, repeat('x', 100) || i from generate_series(1, 20000) i;
+							checkpoint;"
+size_loaded=$(query_value "select pg_relation_size('pc_crash');")
+
+#rewrite every page a few times; the chunks they leave behind come back at each checkpoint
+for i in 1 2 3 4 5
+do
+	gsql -d $db -p $dn1_primary_port -c "update pc_crash set b = b; vacuum pc_crash; checkpoint;"
+done
+size_rewritten=$(query_value "select pg_relation_size('pc_crash');")
+if [ $size_rewritten -le `expr 3 \* $size_loaded` ]; then
+	echo "chunks of rewritten pages are reused"
+else
+	echo "chunks of rewritten pages leak $failed_keyword: $size_loaded -> $size_rewritten"
+	exit 1
+fi
+
+#crash while the pages are being rewritten, recovery must read every one of them
+gsql -d $db -p $dn1_primary_port -c "update pc_crash set b = b where a % 2 = 0; checkpoint; update pc_crash set b = b where a % 3 = 0;" &
+sleep 1
+kill_primary
+start_primary
+check_primary_startup
+check_table "20000|200010000|2088894" "a crash during rewrites"
+
+#crash right after commit, before a checkpoint
+gsql -d $db -p $dn1_primary_port -c "update pc_crash set b = b || 'y' where a % 5 = 0;"
+kill_primary
+start_primary
+check_primary_startup
+check_table "20000|200010000|2092894" "a crash after commit"
+}
+
+function tear_down()
+{
+gsql -d $db -p $dn1_primary_port -c "drop table if exists pc_crash;"
+}
+
+test_1
+tear_down
@@ -0,0 +1,66 @@
+#!/bin/sh
+#the shell is to test that torn_page_protection = page_image copies only the first flush of a page
+#after each checkpoint, and that the pages survive a crash
+
+source ./standby_env.sh
+
+function query_value()
+{
+gsql -d $db -p $dn1_primary_port -t -A -c "$1"
+}
+
+function set_protection()
+{
+gs_guc set -D $data_dir/datanode1 -c "torn_page_protection=$1"
+stop_primary
+start_primary
+check_primary_startup
+}
+
+function test_1()
+{
+check_instance
+set_protection page_image
+
+gsql -d $db -p $dn1_primary_port -c "drop table if exists tp_image;
+							create table tp_image (a int, b int);
+							insert into tp_image select i, 0 from generate_series(1, 20000) i;
+							checkpoint;"
+skipped_before=$(query_value "select sum(skipped_pages) from dbe_perf.global_double_write_status;")
+
+#dirty the same pages again and again between checkpoints, only their first flush is copied
+for i in 1 2 3 4 5 6 7 8
+do
+	gsql -d $db -p $dn1_primary_port -c "update tp_image set b = b + 1;"
+	sleep 3
+done
+skipped_after=$(query_value "select sum(skipped_pages) from dbe_perf.global_double_write_status;")
+if [ $skipped_after -gt $skipped_before ]; then
+	echo "page_image skips the repeated flushes of a page"
+else
+	echo "page_image copies every flush of a page $failed_keyword: $skipped_before -> $skipped_after"
+	exit 1
+fi
+
+#crash while the pages are being flushed, recovery restores the page images and replays from them
+gsql -d $db -p $dn1_primary_port -c "update tp_image set b = b + 1;" &
+sleep 1
+kill_primary
+start_primary
+check_primary_startup
+if [ "$(query_value "select count(*), count(distinct b) from tp_image;")" = "20000|1" ]; then
+	echo "tp_image is intact after a crash"
+else
+	echo "tp_image $failed_keyword after a crash"
+	exit 1
+fi
+}
+
+function tear_down()
+{
+gsql -d $db -p $dn1_primary_port -c "drop table if exists tp_image;"
+set_protection double_write
+}
+
+test_1
+tear_down
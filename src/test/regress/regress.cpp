@@ -26,11 +26,13 @@
 #include "commands/trigger.h"
 #include "executor/executor.h"
 #include "executor/spi.h"
+#include "funcapi.h"
 #include "utils/atomic.h"
 #include "utils/builtins.h"
 #include "utils/geo_decls.h"
 #include "utils/rel.h"
 #include "utils/rel_gs.h"
+#include "utils/timestamp.h"
 #include "utils/typcache.h"
 #include "utils/memutils.h"
 
@@ -61,6 +63,8 @@ extern "C" Datum vec_int4add_9(PG_FUNCTION_ARGS);
 extern "C" Datum vec_int4add_10(PG_FUNCTION_ARGS);
 extern "C" Datum vec_int4add_11(PG_FUNCTION_ARGS);
 extern Datum make_tuple_indirect(PG_FUNCTION_ARGS);
+extern "C" Datum test_slab_context(PG_FUNCTION_ARGS);
+extern "C" Datum alloc_benchmark(PG_FUNCTION_ARGS);
 
 /************c function overload and v0&v1 support***********/
 extern "C" Datum funcA(PG_FUNCTION_ARGS);
@@ -2918,3 +2922,141 @@ Datum complex_send(PG_FUNCTION_ARGS)
     pq_sendfloat8(&buf, complex->y);
     PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
+
+/***************************memory contexts**************************/
+
+#define SLAB_TEST_CHUNKS 10000
+#define SLAB_TEST_CHUNK_SIZE 48
+
+/* number of blocks of a slab context, -1 if it fell back to an ordinary context */
+static int slab_test_nblocks(MemoryContext cxt)
+{
+    return IsA(cxt, SlabAllocSetContext) ? ((SlabSetContext*)cxt)->nblocks : -1;
+}
+
+static void slab_test_fill(char* chunk, int i)
+{
+    errno_t rc = memset_s(chunk, SLAB_TEST_CHUNK_SIZE, i % 251, SLAB_TEST_CHUNK_SIZE);
+    securec_check(rc, "\0", "\0");
+}
+
+/*
+ * Allocate, free, reset and delete on a slab context: every chunk keeps its
+ * contents, freed chunks are reused, and a block goes back to the system as
+ * soon as all its chunks are free.
+ */
+Datum test_slab_context(PG_FUNCTION_ARGS)
+{
+    MemoryContext slab =
+        SlabContextCreate(CurrentMemoryContext, "SlabTestContext", SLAB_DEFAULT_BLOCK_SIZE, SLAB_TEST_CHUNK_SIZE);
+    char** chunks = (char**)palloc(SLAB_TEST_CHUNKS * sizeof(char*));
+    int nblocks;
+    int i;
+
+    for (i = 0; i < SLAB_TEST_CHUNKS; i++) {
+        chunks[i] = (char*)MemoryContextAlloc(slab, SLAB_TEST_CHUNK_SIZE);
+        slab_test_fill(chunks[i], i);
+        if (GetMemoryChunkContext(chunks[i]) != slab || GetMemoryChunkSpace(chunks[i]) < SLAB_TEST_CHUNK_SIZE)
+            ereport(ERROR, (errmsg("slab chunk %d has a wrong header", i)));
+    }
+
+    /* free every other chunk, the holes are filled again without new blocks */
+    for (i = 0; i < SLAB_TEST_CHUNKS; i += 2)
+        pfree(chunks[i]);
+    nblocks = slab_test_nblocks(slab);
+    for (i = 0; i < SLAB_TEST_CHUNKS; i += 2) {
+        chunks[i] = (char*)MemoryContextAlloc(slab, SLAB_TEST_CHUNK_SIZE);
+        slab_test_fill(chunks[i], i);
+    }
+    if (slab_test_nblocks(slab) != nblocks)
+        ereport(ERROR, (errmsg("freed slab chunks were not reused")));
+
+    for (i = 0; i < SLAB_TEST_CHUNKS; i++) {
+        if (chunks[i][0] != (char)(i % 251) || chunks[i][SLAB_TEST_CHUNK_SIZE - 1] != (char)(i % 251))
+            ereport(ERROR, (errmsg("slab chunk %d was overwritten", i)));
+    }
+
+    /* all the blocks go back once every chunk is free */
+    for (i = 0; i < SLAB_TEST_CHUNKS; i++)
+        pfree(chunks[i]);
+    if (slab_test_nblocks(slab) > 0 || !MemoryContextIsEmpty(slab))
+        ereport(ERROR, (errmsg("empty slab blocks were kept")));
+
+    /* reset drops the blocks of live chunks too, and the slab stays usable */
+    for (i = 0; i < SLAB_TEST_CHUNKS / 10; i++)
+        chunks[i] = (char*)MemoryContextAlloc(slab, SLAB_TEST_CHUNK_SIZE);
+    MemoryContextReset(slab);
+    if (slab_test_nblocks(slab) > 0 || !MemoryContextIsEmpty(slab))
+        ereport(ERROR, (errmsg("slab blocks were kept by reset")));
+    chunks[0] = (char*)MemoryContextAlloc(slab, SLAB_TEST_CHUNK_SIZE);
+    slab_test_fill(chunks[0], 0);
+
+    MemoryContextDelete(slab);
+    pfree(chunks);
+
+    PG_RETURN_BOOL(true);
+}
+
+/*
+ * Allocation micro-benchmark.  Allocates nchunks chunks of chunksize bytes in
+ * a new context of the given kind (generic, slab or stack), then frees the
+ * first nine tenths of them, as a wave of objects going away.  Returns the
+ * time the allocations took and the bytes the context held from the system
+ * at its peak and after the frees.  Stack chunks can't be freed one by one,
+ * they are left in place.
+ */
+Datum alloc_benchmark(PG_FUNCTION_ARGS)
+{
+    char* kind = text_to_cstring(PG_GETARG_TEXT_PP(0));
+    int nchunks = PG_GETARG_INT32(1);
+    int chunksize = PG_GETARG_INT32(2);
+    MemoryContext cxt = NULL;
+    void** chunks = NULL;
+    bool isStack = false;
+    TimestampTz start;
+    int64 usec;
+    Size peak;
+    Size retained;
+    TupleDesc tupdesc;
+    Datum values[3];
+    bool nulls[3] = {false, false, false};
+    int i;
+
+    if (nchunks <= 0 || chunksize <= 0)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("chunk count and size must be positive")));
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("return type must be a row type")));
+
+    if (strcmp(kind, "generic") == 0) {
+        cxt = AllocSetContextCreate(CurrentMemoryContext, "AllocBenchmarkContext", ALLOCSET_DEFAULT_SIZES);
+    } else if (strcmp(kind, "slab") == 0) {
+        cxt = SlabContextCreate(CurrentMemoryContext, "AllocBenchmarkContext", SLAB_DEFAULT_BLOCK_SIZE, chunksize);
+    } else if (strcmp(kind, "stack") == 0) {
+        cxt = AllocSetContextCreate(
+            CurrentMemoryContext, "AllocBenchmarkContext", ALLOCSET_DEFAULT_SIZES, STACK_CONTEXT);
+        isStack = true;
+    } else {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("unknown context kind \"%s\"", kind)));
+    }
+
+    chunks = (void**)palloc(nchunks * sizeof(void*));
+    start = GetCurrentTimestamp();
+    for (i = 0; i < nchunks; i++)
+        chunks[i] = MemoryContextAlloc(cxt, chunksize);
+    usec = GetCurrentTimestamp() - start;
+
+    peak = isStack ? ((StackSetContext*)cxt)->totalSpace : ((AllocSet)cxt)->totalSpace;
+    if (!isStack) {
+        for (i = 0; i < nchunks / 10 * 9; i++)
+            pfree(chunks[i]);
+    }
+    retained = isStack ? ((StackSetContext*)cxt)->totalSpace : ((AllocSet)cxt)->totalSpace;
+
+    MemoryContextDelete(cxt);
+    pfree(chunks);
+
+    values[0] = Int64GetDatum(usec);
+    values[1] = Int64GetDatum((int64)(peak / 1024));
+    values[2] = Int64GetDatum((int64)(retained / 1024));
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls)));
+}
@@ -0,0 +1,18 @@
+--
+-- parameter sensitive plan variants of the global plan cache
+--
+create table gpc_variant (a int, b int) distribute by hash(b);
+insert into gpc_variant select case when i <= 5000 then 1 else i end, i from generate_series(1, 10000) i;
+create index gpc_variant_a on gpc_variant (a);
+analyze gpc_variant;
+prepare gpc_variant_q(int) as select count(*) from gpc_variant where a = $1;
+-- the plan source is shared at the commit of its first execution
+execute gpc_variant_q(7000);
+-- a value in half of the rows gets a plan of its own, built once and then reused
+execute gpc_variant_q(1);
+execute gpc_variant_q(1);
+-- a rare value keeps the generic plan
+execute gpc_variant_q(8000);
+execute direct on (datanode1) 'select variant, signature, hits from plancache_variant_status() where query like ''%gpc_variant%'' order by variant';
+deallocate gpc_variant_q;
+drop table gpc_variant;
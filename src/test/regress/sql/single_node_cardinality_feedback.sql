@@ -0,0 +1,43 @@
+--
+-- cardinality feedback: scans report the rows they returned to the planner
+--
+create table cardfb_t(a int, b int);
+insert into cardfb_t select i % 10, i % 10 from generate_series(1, 10000) i;
+analyze cardfb_t;
+
+create function cardfb_rows(query text) returns text language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain ' || query loop
+        if ln like '%Scan on cardfb_t%' then
+            return substring(ln from 'rows=[0-9]+');
+        end if;
+    end loop;
+    return null;
+end $$;
+
+set enable_cardinality_feedback = on;
+
+-- a and b are correlated, so the estimate is ten times too low
+select cardfb_rows('select * from cardfb_t where a = 1 and b = 1');
+select count(*) from cardfb_t where a = 1 and b = 1;
+select estimated_rows, actual_rows, round(correction::numeric, 2) as correction, samples
+    from pg_cardinality_feedback where relname = 'cardfb_t';
+select cardfb_rows('select * from cardfb_t where a = 1 and b = 1');
+-- the order of the clauses does not matter, their constants do
+select cardfb_rows('select * from cardfb_t where b = 1 and a = 1');
+select cardfb_rows('select * from cardfb_t where a = 2 and b = 2');
+
+-- scans stopped early are not fed back
+select * from cardfb_t where a = 2 and b = 2 limit 1;
+select count(*) from pg_cardinality_feedback where relname = 'cardfb_t';
+
+-- analyze drops the corrections of the table
+analyze cardfb_t;
+select count(*) from pg_cardinality_feedback where relname = 'cardfb_t';
+select cardfb_rows('select * from cardfb_t where a = 1 and b = 1');
+
+reset enable_cardinality_feedback;
+drop function cardfb_rows(text);
+drop table cardfb_t;
@@ -0,0 +1,36 @@
+--
+-- columnar result transfer: vectorized results sent as ColumnBatch messages
+--
+create table colres_t(a int2, b int4, c int8, d bool, e text, f varchar(10), g numeric, h float8) with (orientation = column);
+insert into colres_t values (1, 10, 100, true, 'one', 'uno', 1.5, 0.1);
+insert into colres_t values (-2, -20, -200, false, 'two', 'dos', 2.5, -2.25);
+insert into colres_t values (null, null, null, null, null, null, null, null);
+
+-- not requested by the client: only DataRow messages
+select a, b, c, d, e, f from colres_t order by b;
+select pg_stat_get_column_batches();
+-- only the startup packet may ask for it
+set columnar_result_transfer = on;
+
+\c "dbname=regression columnar_result=1"
+show columnar_result_transfer;
+-- every column has a type ColumnBatch can carry
+select a, b, c, d, e, f from colres_t order by b;
+select count(*), sum(b) from colres_t;
+select pg_stat_get_column_batches() > 0 as sent;
+create temp table colres_sent as select pg_stat_get_column_batches() as n;
+-- numeric falls back to DataRow messages
+select b, g from colres_t order by b;
+-- and so do floats while their text output drops the leading zero
+select b, h from colres_t order by b;
+select pg_stat_get_column_batches() = n as unchanged from colres_sent;
+set behavior_compat_options = 'display_leading_zero';
+select b, h from colres_t order by b;
+set extra_float_digits = 3;
+select b, h from colres_t order by b;
+select pg_stat_get_column_batches() > n as sent from colres_sent;
+reset extra_float_digits;
+reset behavior_compat_options;
+
+\c regression
+drop table colres_t;
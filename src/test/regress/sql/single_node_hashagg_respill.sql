@@ -0,0 +1,52 @@
+--
+-- hash aggregation keeps memory bounded by partitioning spilled rows again
+--
+create table hagg_t(a int, b int);
+insert into hagg_t select i, i % 7 from generate_series(1, 100000) i;
+analyze hagg_t;
+create function hagg_plan(query text) returns text language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain ' || query loop
+        if ln like '%HashAggregate%' then
+            return 'HashAggregate';
+        end if;
+    end loop;
+    return 'other';
+end $$;
+create function hagg_spill(query text) returns text language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain analyze ' || query loop
+        if ln like '%Temp File Num%' then
+            if ln like '%Spill Time%' then
+                return 'respilled';
+            end if;
+            return 'spilled';
+        end if;
+    end loop;
+    return 'in memory';
+end $$;
+set enable_sort = off;
+set work_mem = '64kB';
+select hagg_plan('select a, count(*) from hagg_t group by a');
+-- every row is its own group
+select count(*), sum(c), max(c) from (select a, count(*) c from hagg_t group by a) s;
+-- groups of three or four rows spread over all spill files
+select count(*), sum(c), max(c), min(c) from (select a % 30000 k, count(*) c from hagg_t group by 1) s;
+select sum(k), sum(s) from (select a % 30000 k, sum(b) s from hagg_t group by 1) s;
+-- few groups stay in memory
+select b, count(*) from hagg_t group by b order by b;
+-- wide keys spill, and the spilled files overflow memory again
+select hagg_spill('select k, count(*) from (select lpad(a::text, 600, ''0'') k from hagg_t) s group by k');
+select count(*), max(c) from (select k, count(*) c from (select lpad(a::text, 600, '0') k from hagg_t) s group by k) s;
+select hagg_spill('select b, count(*) from hagg_t group by b');
+reset work_mem;
+select count(*), sum(c), max(c), min(c) from (select a % 30000 k, count(*) c from hagg_t group by 1) s;
+select sum(k), sum(s) from (select a % 30000 k, sum(b) s from hagg_t group by 1) s;
+reset enable_sort;
+drop function hagg_plan(text);
+drop function hagg_spill(text);
+drop table hagg_t;
@@ -0,0 +1,53 @@
+--
+-- JSONB
+--
+-- the keys are sorted, the last of the duplicate keys wins
+select '{"bb": 1, "a": [1, 2.50, "x"], "bb": {"c": null}}'::jsonb;
+select '"scalar"'::jsonb, ' 1.0 '::jsonb, '[]'::jsonb, '{}'::jsonb;
+select '{"a":1:2}'::jsonb;
+
+create table jsonb_t(id int, doc jsonb);
+insert into jsonb_t values
+    (1, '{"name": "a", "tags": ["x", "y"], "size": 10, "info": {"color": "red", "dims": [1, 2]}}'),
+    (2, '{"name": "b", "tags": ["y"], "size": 10.0, "info": {"color": "blue"}}'),
+    (3, '{"name": "c", "tags": [], "size": null}'),
+    (4, '["x", 1, {"name": "d"}]'),
+    (5, '"x"');
+
+-- field, element and path access
+select id, doc -> 'name' as name, doc ->> 'name' as name_text, doc -> 'info' -> 'dims' -> -1 as dim
+    from jsonb_t order by id;
+select id, doc #> '{info,dims,0}' as path, doc #>> '{info,color}' as color, doc ->> 'size' as size
+    from jsonb_t where id <= 2 order by id;
+
+-- existence and containment
+select id, doc ? 'tags' as has_tags, doc ? 'x' as has_x, doc ?| '{size,nope}' as any_key,
+    doc ?& '{name,size}' as all_keys
+    from jsonb_t order by id;
+select id from jsonb_t where doc @> '{"size": 10}' order by id;
+select id from jsonb_t where doc @> '{"info": {"dims": [2]}}' order by id;
+select id from jsonb_t where doc @> '["x"]' order by id;
+select id from jsonb_t where doc @> '"x"' order by id;
+select '{"a": 1}'::jsonb <@ '{"a": 1, "b": 2}'::jsonb;
+
+-- the GIN index gives the same answers
+create index jsonb_t_idx on jsonb_t using gin (doc);
+set enable_seqscan = off;
+select id from jsonb_t where doc @> '{"size": 10}' order by id;
+select id from jsonb_t where doc ? 'x' order by id;
+select id from jsonb_t where doc ?| '{tags,name}' order by id;
+select id from jsonb_t where doc ?& '{}' order by id;
+select id from jsonb_t where doc @> '{}' order by id;
+reset enable_seqscan;
+
+-- casts
+select '{"b": [1, 2], "a": true}'::json::jsonb, '{"b":2, "a":1}'::jsonb::json;
+
+-- a key is read from an uncompressed toasted document without fetching it all
+create table jsonb_big(doc jsonb);
+alter table jsonb_big alter column doc set storage external;
+insert into jsonb_big select ('{"pad": "' || repeat('x', 10000) || '", "k": {"v": [1, "two"]}}')::jsonb;
+select doc -> 'k' as k, doc #>> '{k,v,1}' as v, doc ? 'pad' as pad, length(doc ->> 'pad') as len from jsonb_big;
+
+drop table jsonb_big;
+drop table jsonb_t;
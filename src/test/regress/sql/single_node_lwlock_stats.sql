@@ -0,0 +1,17 @@
+--
+-- LWLOCK_TRANCHE_STATS
+--
+-- every tranche has a row with its wait and hold time histograms
+select count(*) > 0 as tranches,
+       bool_and(array_length(wait_histogram, 1) = 16 and array_length(hold_histogram, 1) = 16) as buckets
+from pg_lwlock_tranche_stats;
+
+-- the buffer mapping locks taken by the scan are timed
+set track_lwlock_timing = on;
+create table lwlock_stats_t (a int);
+insert into lwlock_stats_t select generate_series(1, 1000);
+select count(*) from lwlock_stats_t;
+select hold_count > 0 as held, hold_time >= 0 as hold_time
+from pg_lwlock_tranche_stats where tranche = 'BufMappingLock';
+reset track_lwlock_timing;
+drop table lwlock_stats_t;
@@ -0,0 +1,42 @@
+--
+-- transparent page compression of row tables and btree indexes
+--
+create table pc_plain (a int, b text);
+create table pc_pglz (a int, b text) with (compresstype = 1, compress_chunk_size = 1024);
+create table pc_lz4 (a int, b text) with (compresstype = 2);
+create index pc_lz4_a on pc_lz4 (a) with (compresstype = 2, compress_chunk_size = 512);
+
+insert into pc_plain select i, repeat('x', 100) || i from generate_series(1, 20000) i;
+insert into pc_pglz select * from pc_plain;
+insert into pc_lz4 select * from pc_plain;
+checkpoint;
+
+-- compressed segments take fewer chunks than the plain table takes pages
+select pg_relation_size('pc_pglz') < pg_relation_size('pc_plain') as pglz_smaller,
+       pg_relation_size('pc_lz4') < pg_relation_size('pc_plain') as lz4_smaller;
+
+select count(*), sum(a), sum(length(b)) from pc_lz4;
+select count(*), sum(length(b)) from pc_pglz where a % 1000 = 0;
+set enable_seqscan = off;
+select length(b), right(b, 5) from pc_lz4 where a = 12345;
+reset enable_seqscan;
+
+-- truncation of the tail, a new relfilenode and a rewrite stay compressed
+delete from pc_lz4 where a > 10000;
+vacuum pc_lz4;
+select count(*), max(a) from pc_lz4;
+truncate pc_pglz;
+insert into pc_pglz values (1, 'one');
+checkpoint;
+select * from pc_pglz;
+vacuum full pc_lz4;
+select count(*), max(a) from pc_lz4;
+
+-- settings the storage manager cannot honour
+create table pc_bad (a int) with (compresstype = 3);
+create table pc_bad (a int) with (compresstype = 1, compress_chunk_size = 1000);
+create table pc_bad (a int) with (orientation = column, compresstype = 2);
+
+drop table pc_plain;
+drop table pc_pglz;
+drop table pc_lz4;
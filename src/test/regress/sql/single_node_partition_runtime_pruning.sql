@@ -0,0 +1,39 @@
+--
+-- partition pruning at execution, with params of generic plans and nestloops
+--
+create table rtprune_t(a int, b int)
+partition by range(a)
+(
+    partition rtprune_p1 values less than(100),
+    partition rtprune_p2 values less than(200),
+    partition rtprune_p3 values less than(300),
+    partition rtprune_p4 values less than(400)
+);
+create index rtprune_t_a on rtprune_t(a) local;
+insert into rtprune_t select i, i % 10 from generate_series(0, 399) i;
+create table rtprune_o(x int);
+insert into rtprune_o values (50), (150), (350), (1000);
+analyze rtprune_t;
+analyze rtprune_o;
+-- generic plan, pruned at executor start
+set plan_cache_mode = force_generic_plan;
+set enable_indexscan = off;
+set enable_bitmapscan = off;
+prepare rtprune_q (int) as select count(*) from rtprune_t where a < $1;
+explain (costs off) execute rtprune_q(150);
+execute rtprune_q(150);
+execute rtprune_q(0);
+execute rtprune_q(1000);
+deallocate rtprune_q;
+reset enable_indexscan;
+reset enable_bitmapscan;
+reset plan_cache_mode;
+-- nestloop params, pruned for each outer row
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+select o.x, count(t.a) from rtprune_o o left join rtprune_t t on t.a = o.x group by o.x order by o.x;
+select o.x, count(*) from rtprune_o o, rtprune_t t where t.a between o.x - 10 and o.x + 10 group by o.x order by o.x;
+reset enable_hashjoin;
+reset enable_mergejoin;
+drop table rtprune_t;
+drop table rtprune_o;
@@ -0,0 +1,109 @@
+--
+-- PLPGSQL_CODEGEN
+--
+-- compile the functions after their first call, the results must not change
+set plpgsql_codegen_threshold = 0;
+
+create function plcg_sum(n int) returns bigint as $$
+declare
+    s bigint := 0;
+begin
+    for i in 1 .. n loop
+        if i % 3 = 0 then
+            continue;
+        end if;
+        s := s + i;
+    end loop;
+    return s;
+end;
+$$ language plpgsql;
+select plcg_sum(10) as s1, plcg_sum(10) as s2, plcg_sum(0) as s3, plcg_sum(100000) as s4;
+
+-- an overflow is raised by the interpreter
+create function plcg_fact(n int) returns int as $$
+declare
+    r int := 1;
+begin
+    while n > 1 loop
+        r := r * n;
+        n := n - 1;
+    end loop;
+    return r;
+end;
+$$ language plpgsql;
+select plcg_fact(5) as f1, plcg_fact(12) as f2;
+select plcg_fact(13);
+
+create function plcg_div(a bigint, b bigint) returns float8 as $$
+begin
+    return a / b;
+end;
+$$ language plpgsql;
+select plcg_div(7, 2) as d1, plcg_div(0, -3) as d2, plcg_div(-9, 3) as d3;
+select plcg_div(1, 0);
+
+create function plcg_poly(x float8) returns float8 as $$
+declare
+    r float8 := 0;
+begin
+    for i in 1 .. 4 loop
+        r := r * x + i;
+    end loop;
+    return r;
+end;
+$$ language plpgsql;
+select plcg_poly(2) as p1, plcg_poly(-0.5) as p2;
+select plcg_poly(1e300);
+
+-- labeled EXIT, and a NULL result left to the interpreter
+create function plcg_first_multiple(a int, b int) returns int as $$
+declare
+    r int;
+begin
+    <<outer>>
+    for i in a .. a + 100 loop
+        for j in 1 .. 2 loop
+            if i % b = 0 and j = 2 then
+                r := i;
+                exit outer;
+            end if;
+        end loop;
+    end loop;
+    return r;
+end;
+$$ language plpgsql;
+select plcg_first_multiple(10, 7) as m1, plcg_first_multiple(10, 7) as m2, plcg_first_multiple(10, 1000) as m3;
+
+create function plcg_found(n int) returns boolean as $$
+begin
+    for i in 1 .. n loop
+        null;
+    end loop;
+    return found;
+end;
+$$ language plpgsql;
+select plcg_found(3) as f1, plcg_found(0) as f2, plcg_found(3) as f3;
+
+-- not compiled, still interpreted
+create function plcg_label(n int) returns text as $$
+begin
+    return 'n = ' || n;
+end;
+$$ language plpgsql;
+select plcg_label(1) as l1, plcg_label(2) as l2;
+
+-- every supported function runs natively after its first call; calls the
+-- native code cannot finish are counted as fallbacks
+select signature, status, calls, native_calls, fallbacks from pg_plpgsql_compiled_functions
+    where signature like 'plcg%' and calls > 0 order by signature;
+
+reset plpgsql_codegen_threshold;
+show plpgsql_codegen_threshold;
+
+drop function plcg_sum(int);
+drop function plcg_fact(int);
+drop function plcg_div(bigint, bigint);
+drop function plcg_poly(float8);
+drop function plcg_first_multiple(int, int);
+drop function plcg_found(int);
+drop function plcg_label(int);
@@ -0,0 +1,45 @@
+--
+-- in-memory sort using several threads (sort_parallel_workers)
+--
+create table sort_parallel_t(a int, b int8, c float8, d date, e text);
+-- a is a permutation of 0 .. 199999
+insert into sort_parallel_t select (i * 7919) % 200000, i % 100, (i % 1000) * 0.125, date '2000-01-01' + i % 3000, 'row ' || i from generate_series(1, 200000) i;
+set work_mem = '256MB';
+-- EXPLAIN ANALYZE tells which sort ran
+create function sort_parallel_method(query text) returns text language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain analyze ' || query loop
+        if ln like '%Sort Method%' then
+            return substring(ln from 'Sort Method: ([a-z -]*[a-z])');
+        end if;
+    end loop;
+    return null;
+end;
+$$;
+select sort_parallel_method('select a from sort_parallel_t order by a');
+set sort_parallel_workers = 4;
+select sort_parallel_method('select a from sort_parallel_t order by a');
+select sort_parallel_method('select e from sort_parallel_t order by e');
+-- single key
+select count(*) from (select a, row_number() over () rn from (select a from sort_parallel_t order by a) s) v where a <> rn - 1;
+select count(*) from (select a, row_number() over () rn from (select a from sort_parallel_t order by a desc) s) v where a <> 200000 - rn;
+-- several keys
+select count(*) from (select a, b, lag(a) over () pa, lag(b) over () pb from (select a, b from sort_parallel_t order by b desc, a) s) v
+where pb < b or (pb = b and pa > a);
+select count(*) from (select c, d, lag(c) over () pc, lag(d) over () pd from (select c, d from sort_parallel_t order by c, d desc) s) v
+where pc > c or (pc = c and pd < d);
+-- text keys are sorted by the session thread alone
+select count(*) from (select e, lag(e) over () pe from (select e from sort_parallel_t order by e) s) v where pe > e;
+-- index build
+create index sort_parallel_t_a on sort_parallel_t(a);
+set enable_seqscan = off;
+select count(*) from sort_parallel_t where a between 1000 and 1999;
+select a from sort_parallel_t where a < 5 order by a;
+reset enable_seqscan;
+set sort_parallel_workers = 33;
+reset sort_parallel_workers;
+reset work_mem;
+drop function sort_parallel_method(text);
+drop table sort_parallel_t;
@@ -0,0 +1,31 @@
+--
+-- radix sort of in-memory sorts (enable_radix_sort)
+--
+create table sort_radix_t(a int, b int8, c numeric, d date, e timestamp, f text);
+insert into sort_radix_t select case when i % 50 = 0 then null else (i * 7919) % 5000 - 2500 end, i % 7 - 3,
+    (i * 31) % 1000 * 0.25 - 100, date '2000-01-01' + (i * 13) % 4000 - 2000,
+    timestamp '2000-01-01 00:00:00' + (i * 17) % 5000 * interval '1 hour', md5(i::text)
+from generate_series(1, 5000) i;
+set enable_radix_sort = on;
+-- int4, with NULLs at either end
+select count(*) from (select a, lag(a) over () pa, row_number() over () rn from (select a from sort_radix_t order by a) s) v
+where pa > a or (a is null) <> (rn > 4900);
+select count(*) from (select a, lag(a) over () pa, row_number() over () rn from (select a from sort_radix_t order by a desc) s) v
+where pa < a or (a is null) <> (rn <= 100);
+select count(*) from (select a, lag(a) over () pa, row_number() over () rn from (select a from sort_radix_t order by a nulls first) s) v
+where pa > a or (a is null) <> (rn <= 100);
+-- int8 leading key with ties broken by the next key
+select count(*) from (select a, b, lag(a) over () pa, lag(b) over () pb from (select a, b from sort_radix_t order by b, a desc) s) v
+where pb > b or (pb = b and pa < a);
+-- numeric and text use abbreviated keys
+select count(*) from (select c, lag(c) over () pc from (select c from sort_radix_t order by c) s) v where pc > c;
+select count(*) from (select f, lag(f) over () pf from (select f from sort_radix_t order by f) s) v where pf > f;
+-- date and timestamp
+select count(*) from (select d, lag(d) over () pd from (select d from sort_radix_t order by d) s) v where pd > d;
+select count(*) from (select e, lag(e) over () pe from (select e from sort_radix_t order by e desc) s) v where pe < e;
+-- same result as qsort
+select sum(rn * a) from (select a, row_number() over () rn from (select a from sort_radix_t order by a) s) v;
+set enable_radix_sort = off;
+select sum(rn * a) from (select a, row_number() over () rn from (select a from sort_radix_t order by a) s) v;
+reset enable_radix_sort;
+drop table sort_radix_t;
@@ -0,0 +1,34 @@
+--
+-- TOAST_COMPRESSION
+--
+create table toast_cmp(id int, p text, l text);
+alter table toast_cmp alter column l set (toast_compression = lz4);
+
+-- compressed inline, compressed out of line and too short to be compressed
+insert into toast_cmp values (1, repeat('openGauss toast ', 1000), repeat('openGauss toast ', 1000));
+insert into toast_cmp select 2, v, v from (select string_agg(repeat(md5(i::text), 4), '') as v from generate_series(1, 500) i) s;
+insert into toast_cmp values (3, 'short', 'short');
+select id, pg_column_compression(p) as p, pg_column_compression(l) as l from toast_cmp order by id;
+select id, length(p) as len, md5(p) = md5(l) as same from toast_cmp order by id;
+
+-- read again, and by slices
+select md5(l) = md5(p) as same from toast_cmp where id = 2;
+select substr(l, 31990, 20) = substr(p, 31990, 20) as same from toast_cmp where id = 2;
+select pg_column_compression(id) from toast_cmp where id = 1;
+
+-- the session default, and the column option over it
+set default_toast_compression = lz4;
+create table toast_cmp_default(id int, v text);
+insert into toast_cmp_default values (1, repeat('0123456789', 1000));
+alter table toast_cmp_default alter column v set (toast_compression = pglz);
+insert into toast_cmp_default values (2, repeat('0123456789', 1000));
+select id, pg_column_compression(v) from toast_cmp_default order by id;
+reset default_toast_compression;
+show default_toast_compression;
+
+-- invalid methods
+alter table toast_cmp alter column p set (toast_compression = zstd);
+set default_toast_compression = zstd;
+
+drop table toast_cmp;
+drop table toast_cmp_default;
@@ -0,0 +1,26 @@
+--
+-- VACUUM with index worker threads
+--
+create table vacuum_parallel_t (a int, b int, c int) with (autovacuum_enabled = off);
+insert into vacuum_parallel_t select i, i % 10, -i from generate_series(1, 100) i;
+create index vacuum_parallel_a on vacuum_parallel_t(a);
+create index vacuum_parallel_b on vacuum_parallel_t(b);
+create index vacuum_parallel_c on vacuum_parallel_t(c);
+delete from vacuum_parallel_t where a % 2 = 0;
+
+-- the indexes go to worker threads, and are reported in index order
+set vacuum_index_parallel_workers = 2;
+\set VERBOSITY terse
+vacuum verbose vacuum_parallel_t;
+\set VERBOSITY default
+reset vacuum_index_parallel_workers;
+
+-- the results of the workers make it into the index statistics
+select relname, reltuples from pg_class where relname like 'vacuum_parallel_%' order by relname;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*) from vacuum_parallel_t where a > 0;
+select count(*) from vacuum_parallel_t where c < 0;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table vacuum_parallel_t;